@@ -96,14 +96,29 @@ namespace remidy {
             uint32_t refCount;
             std::filesystem::path moduleBundlePath;
             void* module;
+            // Size of the bundle on disk, taken as an estimate of what keeping
+            // it loaded costs.
+            uintmax_t sizeInBytes{0};
+            // Orders unreferenced entries for RetainWithinBudget; larger is
+            // more recently released.
+            uint64_t releaseSerial{0};
         };
         enum RetentionPolicy {
             Retain,
             UnloadImmediately,
+            // Keeps unreferenced bundles loaded until their total size exceeds
+            // the retention budget, then unloads the least recently released.
+            RetainWithinBudget,
         };
 
+        static constexpr uintmax_t kDefaultRetentionBudgetBytes = 512 * 1024 * 1024;
+
         RetentionPolicy getRetentionPolicy();
         void setRetentionPolicy(RetentionPolicy value);
+        uintmax_t getRetentionBudget();
+        void setRetentionBudget(uintmax_t bytes);
+        // Total size of the bundles that are loaded but not referenced.
+        uintmax_t retainedSizeInBytes();
         // Returns either HMODULE, CFBundle*, or dlopen-ed library.
         void* loadOrAddReference(std::filesystem::path& moduleBundlePath, bool* loadedAsNew);
         StatusCode removeReference(std::filesystem::path& moduleBundlePath);
@@ -112,7 +127,11 @@ namespace remidy {
         std::function<StatusCode(std::filesystem::path& moduleBundlePath, void** module)> load;
         std::function<StatusCode(std::filesystem::path& moduleBundlePath, void* module)> unload;
         RetentionPolicy retentionPolicy{UnloadImmediately};
+        uintmax_t retentionBudget{kDefaultRetentionBudgetBytes};
+        uint64_t releaseSerial{0};
         std::map<std::filesystem::path, ModuleEntry> entries{};
+
+        void unloadOverBudget();
     };
 
 }
@@ -73,6 +73,19 @@ namespace remidy {
 
         virtual StatusCode configure(ConfigurationRequest& configuration) = 0;
 
+        // Whether configure() may be called again while process() keeps being
+        // called. Such an instance prepares the new configuration on the
+        // calling thread, keeps its state, and switches over between two
+        // process() calls. Otherwise the host stops processing, and keeps
+        // process() from running, across a repeated configure().
+        virtual bool supportsLiveReconfiguration() const { return false; }
+
+        // Whether process() may be called from a thread other than the host's
+        // audio callback thread, e.g. to render a track in the background, as
+        // long as calls never overlap. Off for formats that tie processing to
+        // the thread the plugin sees as its audio thread.
+        virtual bool supportsProcessingOffAudioThread() const { return false; }
+
         virtual StatusCode startProcessing() = 0;
 
         virtual StatusCode stopProcessing() = 0;
@@ -173,7 +173,9 @@ namespace remidy {
         // Sets a plain parameter value by index.
         // It can be invoked by any thread. The plugin format implementation is supposed to appropriately handle it in each way.
         virtual StatusCode setParameter(uint32_t index, double plainValue) = 0;
-        // Schedules a plain parameter value by index in realtime thread.
+        // Schedules a plain parameter value by index in realtime thread, `timestamp` frames
+        // into the next processed block. Formats that cannot time parameter changes apply
+        // them at the block start.
         // on: audio-thread
         virtual StatusCode enqueueParameterRT(uint32_t index, double plainValue, uint64_t timestamp) = 0;
         // Retrieves current plain parameter, if possible.
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <type_traits>
 #include <vector>
 #include "remidy/detail/common.hpp"
 #include "remidy/detail/audio-bus-configuration.hpp"
@@ -12,6 +13,14 @@ namespace remidy {
         Float64
     };
 
+    // Converts the first `frames` samples of `channels` channels from one
+    // format to the other in place. Channel `ch` starts `ch * channelStride`
+    // samples into `samples`, counted in the format at hand, as in the bus
+    // buffers of AudioProcessContext; the storage must have room for the
+    // channels as doubles.
+    void convertSamplesInPlace(void* samples, uint32_t channels, size_t channelStride, size_t frames,
+                               AudioContentType from, AudioContentType to);
+
     // Represents a sample-accurate sequence of UMPs and/or alike.
     // It is part of `AudioProcessingContext`.
     class EventSequence {
@@ -108,6 +117,7 @@ namespace remidy {
             void* data_view{nullptr};
             bool aliasing{false};
             AudioBusRole bus_role{AudioBusRole::Main};
+            uint64_t silence_flags{0};
 
             void clear() {
                 if (!data_view || aliasing)
@@ -161,6 +171,8 @@ namespace remidy {
             };
             uint32_t channelCount() const { return channel_count; }
             uint32_t bufferCapacityInFrames() const { return frame_capacity; }
+            uint64_t silenceFlags() const { return silence_flags; }
+            void silenceFlags(uint64_t flags) { silence_flags = flags; }
         };
 
         MasterContext& master_context;
@@ -274,6 +286,68 @@ namespace remidy {
             return channel >= b->channelCount() ? nullptr : b->getDoubleBufferForChannel(channel);
         }
 
+        // Bit `n` set means channel `n` of the bus holds only zeros in this
+        // block; zero means unknown. These are hints for a single process()
+        // call: the host records the input flags right before it (see
+        // detectInputSilence()), and plugins that report silent outputs set
+        // the output flags. Nothing else keeps them up to date.
+        uint64_t inputSilenceFlags(int32_t bus) const {
+            return (bus < 0 || bus >= audioInBusCount()) ? 0 : audio_in[bus]->silenceFlags();
+        }
+        void inputSilenceFlags(int32_t bus, uint64_t flags) {
+            if (bus >= 0 && bus < audioInBusCount())
+                audio_in[bus]->silenceFlags(flags);
+        }
+        uint64_t outputSilenceFlags(int32_t bus) const {
+            return (bus < 0 || bus >= audioOutBusCount()) ? 0 : audio_out[bus]->silenceFlags();
+        }
+        void outputSilenceFlags(int32_t bus, uint64_t flags) {
+            if (bus >= 0 && bus < audioOutBusCount())
+                audio_out[bus]->silenceFlags(flags);
+        }
+
+        // Records the input channels that hold only zeros in the input
+        // silence flags, and tells whether no input sample of this block
+        // exceeds `threshold` in magnitude.
+        bool detectInputSilence(double threshold);
+        // Whether no output sample of this block exceeds `threshold` in
+        // magnitude. Channels flagged silent are not scanned.
+        bool detectOutputSilence(double threshold) const;
+
+        // The sample format the buses hold, as the master context says.
+        AudioContentType audioDataType() const { return master_context.audioDataType(); }
+
+        // float or double; only the one matching audioDataType() is meaningful.
+        template<typename SampleType>
+        SampleType* getInBuffer(int32_t bus, uint32_t channel) const {
+            if constexpr (std::is_same_v<SampleType, double>)
+                return getDoubleInBuffer(bus, channel);
+            else
+                return getFloatInBuffer(bus, channel);
+        }
+        template<typename SampleType>
+        SampleType* getOutBuffer(int32_t bus, uint32_t channel) const {
+            if constexpr (std::is_same_v<SampleType, double>)
+                return getDoubleOutBuffer(bus, channel);
+            else
+                return getFloatOutBuffer(bus, channel);
+        }
+
+        // Calls `fn` with a null `float*` or `double*`, after audioDataType(),
+        // so that sample code can be written once for both formats.
+        template<typename Fn>
+        decltype(auto) withSampleType(Fn&& fn) const {
+            if (audioDataType() == AudioContentType::Float64)
+                return fn(static_cast<double*>(nullptr));
+            return fn(static_cast<float*>(nullptr));
+        }
+
+        // Convert the first frameCount() samples of every input or output
+        // channel in place, for a processor that takes another sample format
+        // than audioDataType().
+        void convertAudioInputs(AudioContentType from, AudioContentType to);
+        void convertAudioOutputs(AudioContentType from, AudioContentType to);
+
         void copyInputsToOutputs();
         void enableReplacingIO();
         void disableReplacingIO();
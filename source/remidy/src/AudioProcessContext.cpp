@@ -1,7 +1,70 @@
 
 #include "remidy/detail/processing-context.hpp"
+#include <cmath>
 
 namespace remidy {
+    namespace {
+        struct ChannelLevel {
+            bool zero{true};
+            bool belowThreshold{true};
+        };
+
+        // Stops at the first sample above the threshold; only silent
+        // channels are read to the end.
+        template<typename SampleType>
+        ChannelLevel scanChannel(const SampleType* samples, size_t frames, double threshold) {
+            ChannelLevel level{};
+            if (!samples)
+                return level;
+            for (size_t i = 0; i < frames; ++i) {
+                const auto sample = samples[i];
+                if (sample == SampleType{0})
+                    continue;
+                level.zero = false;
+                // NaN counts as loud.
+                if (!(std::abs(static_cast<double>(sample)) <= threshold)) {
+                    level.belowThreshold = false;
+                    break;
+                }
+            }
+            return level;
+        }
+
+        uint64_t channelMask(uint32_t channels) {
+            return channels >= 64 ? ~uint64_t{0} : (uint64_t{1} << channels) - 1;
+        }
+    }
+
+    void convertSamplesInPlace(void* samples, uint32_t channels, size_t channelStride, size_t frames,
+                               AudioContentType from, AudioContentType to) {
+        if (!samples || from == to)
+            return;
+        frames = std::min(frames, channelStride > 0 ? channelStride : frames);
+        // Sample k of the flat buffer is at byte k * sizeof(sample) in both
+        // formats, so narrowing front to back and widening back to front
+        // never overwrite a sample that has not been read yet.
+        auto* bytes = static_cast<unsigned char*>(samples);
+        if (to == AudioContentType::Float32) {
+            for (uint32_t ch = 0; ch < channels; ++ch)
+                for (size_t i = 0; i < frames; ++i) {
+                    const size_t k = ch * channelStride + i;
+                    double value;
+                    std::memcpy(&value, bytes + k * sizeof(double), sizeof(double));
+                    const auto narrowed = static_cast<float>(value);
+                    std::memcpy(bytes + k * sizeof(float), &narrowed, sizeof(float));
+                }
+        } else {
+            for (uint32_t ch = channels; ch-- > 0;)
+                for (size_t i = frames; i-- > 0;) {
+                    const size_t k = ch * channelStride + i;
+                    float value;
+                    std::memcpy(&value, bytes + k * sizeof(float), sizeof(float));
+                    const auto widened = static_cast<double>(value);
+                    std::memcpy(bytes + k * sizeof(double), &widened, sizeof(double));
+                }
+        }
+    }
+
     void AudioProcessContext::rebuildBuses(std::vector<AudioBusBufferList*>& buses, std::vector<AudioBusSpec>& specsStorage, const std::vector<AudioBusSpec>& requestedSpecs) {
         for (auto* bus : buses)
             delete bus;
@@ -105,4 +168,58 @@ namespace remidy {
 
         event_out.position(0);
     }
-}
\ No newline at end of file
+
+    void AudioProcessContext::convertAudioInputs(AudioContentType from, AudioContentType to) {
+        const size_t frames = static_cast<size_t>(std::max(frame_count, 0));
+        for (auto* bus : audio_in)
+            if (bus)
+                convertSamplesInPlace(bus->data_view, bus->channel_count, bus->frame_capacity, frames, from, to);
+    }
+
+    void AudioProcessContext::convertAudioOutputs(AudioContentType from, AudioContentType to) {
+        const size_t frames = static_cast<size_t>(std::max(frame_count, 0));
+        for (auto* bus : audio_out)
+            if (bus)
+                convertSamplesInPlace(bus->data_view, bus->channel_count, bus->frame_capacity, frames, from, to);
+    }
+
+    bool AudioProcessContext::detectInputSilence(double threshold) {
+        const size_t frames = static_cast<size_t>(std::max(frame_count, 0));
+        return withSampleType([&](auto* tag) {
+            using SampleType = std::remove_pointer_t<decltype(tag)>;
+            bool silent = true;
+            for (int32_t bus = 0; bus < audioInBusCount(); ++bus) {
+                const auto channels = static_cast<uint32_t>(inputChannelCount(bus));
+                const auto busFrames = std::min(frames, inputBusBufferCapacityInFrames(bus));
+                uint64_t flags = 0;
+                for (uint32_t ch = 0; ch < channels; ++ch) {
+                    const auto level = scanChannel(getInBuffer<SampleType>(bus, ch), busFrames, threshold);
+                    if (level.zero && ch < 64)
+                        flags |= uint64_t{1} << ch;
+                    silent = silent && level.belowThreshold;
+                }
+                inputSilenceFlags(bus, flags);
+            }
+            return silent;
+        });
+    }
+
+    bool AudioProcessContext::detectOutputSilence(double threshold) const {
+        const size_t frames = static_cast<size_t>(std::max(frame_count, 0));
+        return withSampleType([&](auto* tag) {
+            using SampleType = std::remove_pointer_t<decltype(tag)>;
+            for (int32_t bus = 0; bus < audioOutBusCount(); ++bus) {
+                const auto channels = static_cast<uint32_t>(outputChannelCount(bus));
+                const auto busFrames = std::min(frames, outputBusBufferCapacityInFrames(bus));
+                const auto flags = outputSilenceFlags(bus) & channelMask(channels);
+                for (uint32_t ch = 0; ch < channels; ++ch) {
+                    if (ch < 64 && (flags & (uint64_t{1} << ch)))
+                        continue;
+                    if (!scanChannel(getOutBuffer<SampleType>(bus, ch), busFrames, threshold).belowThreshold)
+                        return false;
+                }
+            }
+            return true;
+        });
+    }
+}
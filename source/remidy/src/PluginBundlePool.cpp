@@ -3,6 +3,27 @@
 
 #include <iostream>
 
+namespace {
+    uintmax_t bundleSizeInBytes(const std::filesystem::path& path) {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(path, ec)) {
+            const auto size = std::filesystem::file_size(path, ec);
+            return ec ? 0 : size;
+        }
+        uintmax_t total{0};
+        for (auto it = std::filesystem::recursive_directory_iterator(path, ec);
+             !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            std::error_code sizeError;
+            if (it->is_regular_file(sizeError)) {
+                const auto size = it->file_size(sizeError);
+                if (!sizeError)
+                    total += size;
+            }
+        }
+        return total;
+    }
+}
+
 remidy::PluginBundlePool::PluginBundlePool(
     std::function<StatusCode(std::filesystem::path& moduleBundlePath, void** module)>& load,
     std::function<StatusCode(std::filesystem::path& moduleBundlePath, void* module)>& unload
@@ -20,6 +41,43 @@ remidy::PluginBundlePool::RetentionPolicy remidy::PluginBundlePool::getRetention
 
 void remidy::PluginBundlePool::setRetentionPolicy(RetentionPolicy value) {
     retentionPolicy = value;
+    unloadOverBudget();
+}
+
+uintmax_t remidy::PluginBundlePool::getRetentionBudget() {
+    return retentionBudget;
+}
+
+void remidy::PluginBundlePool::setRetentionBudget(uintmax_t bytes) {
+    retentionBudget = bytes;
+    unloadOverBudget();
+}
+
+uintmax_t remidy::PluginBundlePool::retainedSizeInBytes() {
+    uintmax_t total{0};
+    for (auto& entry : entries)
+        if (entry.second.refCount == 0)
+            total += entry.second.sizeInBytes;
+    return total;
+}
+
+void remidy::PluginBundlePool::unloadOverBudget() {
+    if (retentionPolicy != RetentionPolicy::RetainWithinBudget)
+        return;
+    while (retainedSizeInBytes() > retentionBudget) {
+        auto oldest = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+            if (it->second.refCount == 0 &&
+                (oldest == entries.end() || it->second.releaseSerial < oldest->second.releaseSerial))
+                oldest = it;
+        if (oldest == entries.end())
+            return;
+        // Keep the entry when the module refuses to unload, rather than
+        // retrying it forever.
+        if (unload(oldest->second.moduleBundlePath, oldest->second.module) != StatusCode::OK)
+            return;
+        entries.erase(oldest);
+    }
 }
 
 void* remidy::PluginBundlePool::loadOrAddReference(std::filesystem::path &moduleBundlePath, bool* loadedAsNew) {
@@ -38,7 +96,7 @@ void* remidy::PluginBundlePool::loadOrAddReference(std::filesystem::path &module
         auto result = load(moduleBundlePath, &module);
         if (result != StatusCode::OK)
             return;
-        entries.emplace(moduleBundlePath, ModuleEntry{1, moduleBundlePath, module});
+        entries.emplace(moduleBundlePath, ModuleEntry{1, moduleBundlePath, module, bundleSizeInBytes(moduleBundlePath)});
         *loadedAsNew = true;
     });
     return module;
@@ -55,6 +113,9 @@ remidy::StatusCode remidy::PluginBundlePool::removeReference(std::filesystem::pa
         if (result != StatusCode::OK)
             return result;
         entries.erase(entry);
+    } else if (entry->second.refCount == 0 && retentionPolicy == RetentionPolicy::RetainWithinBudget) {
+        entry->second.releaseSerial = ++releaseSerial;
+        unloadOverBudget();
     }
     return StatusCode::OK;
 }
@@ -318,6 +318,8 @@ namespace remidy {
         uint32_t latencyInSamples() const override;
         double tailLengthInSeconds() const override;
         bool requiresReplacingProcess() const override { return false; }
+        // AudioUnitRender() may be called from any one thread at a time.
+        bool supportsProcessingOffAudioThread() const override { return true; }
     };
 
     // AUv2
@@ -610,6 +612,8 @@ namespace remidy {
         uint32_t latencyInSamples() const override;
         double tailLengthInSeconds() const override;
         bool requiresReplacingProcess() const override { return false; }
+        // AudioUnitRender() may be called from any one thread at a time.
+        bool supportsProcessingOffAudioThread() const override { return true; }
     };
 
 }
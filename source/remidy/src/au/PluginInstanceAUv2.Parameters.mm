@@ -311,7 +311,8 @@ remidy::StatusCode remidy::PluginInstanceAUv2::ParameterSupport::enqueueParamete
     event.element = 0;
     event.parameter = au_param_id_list[index];
     event.eventType = kParameterEvent_Immediate;
-    event.eventValues.immediate.bufferOffset = static_cast<UInt32>(timestamp * owner->host_transport_info.sampleRate / 1000000000.0);
+    // `timestamp` is the sample offset in the block, as UMP input dispatchers pass it.
+    event.eventValues.immediate.bufferOffset = static_cast<UInt32>(timestamp);
     event.eventValues.immediate.value = static_cast<AudioUnitParameterValue>(value);
     return AudioUnitScheduleParameters(owner->instance, &event, 1) == noErr ? StatusCode::OK : StatusCode::INVALID_PARAMETER_OPERATION;
 }
@@ -347,7 +348,8 @@ remidy::StatusCode remidy::PluginInstanceAUv2::ParameterSupport::enqueuePerNoteC
     event.element = context.note;
     event.parameter = au_param_id_list[index];
     event.eventType = kParameterEvent_Immediate;
-    event.eventValues.immediate.bufferOffset = static_cast<UInt32>(timestamp * owner->host_transport_info.sampleRate / 1000000000.0);
+    // `timestamp` is the sample offset in the block, as UMP input dispatchers pass it.
+    event.eventValues.immediate.bufferOffset = static_cast<UInt32>(timestamp);
     event.eventValues.immediate.value = static_cast<AudioUnitParameterValue>(value);
     return AudioUnitScheduleParameters(owner->instance, &event, 1) == noErr ? StatusCode::OK : StatusCode::INVALID_PARAMETER_OPERATION;
 }
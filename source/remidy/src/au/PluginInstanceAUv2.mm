@@ -227,6 +227,16 @@ remidy::StatusCode remidy::PluginInstanceAUv2::configure(ConfigurationRequest& c
     OSStatus result;
     UInt32 size = 0;
 
+    // A repeated configure() (e.g. for a new sample rate) has to go back to
+    // the uninitialized state before the formats can change.
+    AudioUnitUninitialize(instance);
+    for (auto auDataIn : auDataIns)
+        free(auDataIn);
+    auDataIns.clear();
+    for (auto auDataOut : auDataOuts)
+        free(auDataOut);
+    auDataOuts.clear();
+
     result = AudioUnitReset(instance, kAudioUnitScope_Global, 0);
     if (result) {
         logger()->logError("%s PluginInstanceAUv2::configure failed to reset instance!?: OSStatus %d", name.c_str(), result);
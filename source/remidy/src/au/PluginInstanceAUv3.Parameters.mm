@@ -246,7 +246,8 @@ remidy::StatusCode remidy::PluginInstanceAUv3::ParameterSupport::enqueueParamete
     if (scheduleParameterBlock == nil)
         return StatusCode::INVALID_PARAMETER_OPERATION;
 
-    auto sampleOffset = static_cast<AUEventSampleTime>(timestamp * owner->host_transport_info.sampleRate / 1000000000.0);
+    // `timestamp` is the sample offset in the block, as UMP input dispatchers pass it.
+    auto sampleOffset = static_cast<AUEventSampleTime>(timestamp);
     scheduleParameterBlock(AUEventSampleTimeImmediate + sampleOffset, 0, parameter_addresses[index], static_cast<AUValue>(value));
     return StatusCode::OK;
 }
@@ -264,7 +264,9 @@ remidy::StatusCode remidy::PluginInstanceAUv3::configure(ConfigurationRequest& c
         // Set maximum frames per slice
         audioUnit.maximumFramesToRender = configuration.bufferSizeInSamples;
 
-        // Allocate render resources
+        // Allocate render resources; a repeated configure() reallocates them.
+        if (audioUnit.renderResourcesAllocated)
+            [audioUnit deallocateRenderResources];
         if (![audioUnit allocateRenderResourcesAndReturnError:&error]) {
             logger()->logError("%s: PluginInstanceAUv3::configure failed to allocate render resources: %s",
                              name.c_str(), [[error localizedDescription] UTF8String]);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace remidy {
+    // Delivery order of the input events of one block. Events are appended as they are
+    // translated, which is not always time order: parameter values come from their own queue,
+    // and UMP can carry an earlier timestamp after a later one. CLAP wants input events sorted
+    // by time, so instead of moving an event later this keeps the append indices sorted by
+    // time; equal times keep their append order. Appending never grows past the capacity.
+    class InputEventOrder {
+        struct Entry {
+            uint32_t time;
+            uint32_t index;
+        };
+        std::vector<Entry> entries_{};
+
+    public:
+        explicit InputEventOrder(size_t capacity) { entries_.reserve(capacity); }
+
+        size_t size() const { return entries_.size(); }
+
+        // Records that the event appended at `index` is due at `time`. Returns false when full.
+        bool append(uint32_t index, uint32_t time) {
+            if (entries_.size() == entries_.capacity())
+                return false;
+            const auto position = std::upper_bound(entries_.begin(), entries_.end(), time,
+                [](uint32_t t, const Entry& e) { return t < e.time; });
+            entries_.insert(position, Entry{time, index});
+            return true;
+        }
+
+        // Append index of the event delivered at `position`.
+        uint32_t indexAt(size_t position) const { return entries_[position].index; }
+
+        void clear() { entries_.clear(); }
+    };
+}
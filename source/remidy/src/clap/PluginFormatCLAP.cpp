@@ -250,6 +250,10 @@ std::vector<PluginCatalogEntry> PluginScannerCLAP::getAllFastScannablePlugins()
         return StatusCode::OK;
     }
 
+    void PluginFormatCLAPImpl::unrefLibrary(PluginCatalogEntry* info) {
+        library_pool.removeReference(info->bundlePath());
+    }
+
     PluginExtensibility<PluginFormat> *PluginFormatCLAPImpl::getExtensibility() {
         return &extensibility;
     }
@@ -354,7 +358,9 @@ std::vector<PluginCatalogEntry> PluginScannerCLAP::getAllFastScannablePlugins()
             else
                 instantiateMatchingPlugin(module, factory, presetDiscoveryFactory, desc);
         }, [&](void *module) {
-            // do not unload library here.
+            // The instance owns the reference from here; see unrefLibrary().
+            if (!ret)
+                library_pool.removeReference(bundle);
         });
         if (ret)
             callback(std::move(ret), error);
@@ -5,11 +5,15 @@
 #include "clap/helpers/event-list.hh"
 #include "clap/helpers/plugin-proxy.hh"
 #include "clap/helpers/plugin-proxy.hxx"
+#include <array>
+#include <initializer_list>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 #include <functional>
 #include <memory>
 #include "CLAPHelper.hpp"
+#include "InputEventOrder.hpp"
 
 #include "clap/ext/render.h"
 #include "remidy/remidy.hpp"
@@ -82,6 +86,9 @@ namespace remidy {
             loadFunc([&](std::filesystem::path &clapDir, void** module)->StatusCode { return doLoad(clapDir, module); }),
             unloadFunc([&](std::filesystem::path &clapDir, void* module)->StatusCode { return doUnload(clapDir, module); }),
             library_pool(loadFunc,unloadFunc) {
+            // Keep recently used bundles loaded so that inserting a plugin
+            // again skips loading the library and clap_entry.init().
+            library_pool.setRetentionPolicy(PluginBundlePool::RetainWithinBudget);
         }
         ~PluginFormatCLAPImpl() override = default;
 
@@ -160,9 +167,10 @@ namespace remidy {
             explicit ParameterSupport(PluginInstanceCLAP* owner);
             ~ParameterSupport();
 
-            uint32_t clapParameterFlags(clap_id paramId) {
-                auto index = getParameterIndex(paramId);
-                return index < parameter_flags.size() ? parameter_flags[index] : 0;
+            // Looks the id up without inserting, so the audio thread can use it.
+            uint32_t clapParameterFlags(clap_id paramId) const {
+                auto index = indexForParamId(paramId);
+                return index.has_value() && *index < parameter_flags.size() ? parameter_flags[*index] : 0;
             }
 
             void refreshAllParameterMetadata() override;
@@ -182,20 +190,40 @@ namespace remidy {
             void notifyParameterValue(clap_id id, double plainValue);
             void notifyPerNoteControllerValue(PerNoteControllerContextTypes contextType, uint32_t contextValue, clap_id id, double plainValue);
             clap_id getParameterId(uint32_t index) const { return index < parameter_ids.size() ? parameter_ids[index] : 0; }
-            int32_t getParameterIndex(const clap_id id) {
-                auto index = param_id_to_index[id];
-                return index < parameter_flags.size() ? static_cast<int32_t>(parameter_flags[index]) : -1;
-            }
         private:
             bool parameterSupportsContext(uint32_t flags, PerNoteControllerContextTypes types) const;
         };
 
+        // Translates UMP into CLAP input events. Each event goes out in the richest form the
+        // target note port accepts: native note and note expression events for the CLAP dialect,
+        // raw UMP for the MIDI 2.0 dialect, and MIDI 1.0 bytes otherwise. Channel messages that
+        // have no CLAP core event (CC, controllers, channel pressure and pitch bend, program
+        // change) therefore reach plugins through their MIDI dialects.
         class CLAPUmpInputDispatcher : public TypedUmpInputDispatcher {
             PluginInstanceCLAP* owner;
             int32_t note_serial{1};
+            // Per-note pitch bend range of each group and channel, in semitones, as last set by
+            // registered controller #7 (Per-Note Pitch Bend Sensitivity).
+            std::array<std::array<double, 16>, 16> per_note_pitch_bend_ranges_{};
+
+            uint32_t dialectsFor(uint4_t group) const;
+            void pushNote(uint16_t type, uint4_t group, uint4_t channel, uint7_t note, uint16_t velocity);
+            void pushNoteExpression(uint4_t group, uint4_t channel, uint7_t note, clap_note_expression expressionId, double value);
+            void pushMidi1(uint4_t group, uint8_t status, uint8_t data1, uint8_t data2);
+            void pushMidi2(uint4_t group, uint32_t word0, uint32_t word1);
+            void pushMidi2(uint4_t group, uint64_t ump) { pushMidi2(group, static_cast<uint32_t>(ump >> 32), static_cast<uint32_t>(ump)); }
+            // Sends a MIDI 2.0 channel message, or its MIDI 1.0 form when that is all the port takes
+            // (none when it has no MIDI 1.0 equivalent). Returns false when nothing was sent.
+            bool pushChannelMessage(uint4_t group, uint64_t midi2Ump, std::initializer_list<std::array<uint8_t, 3>> midi1Messages);
 
         public:
-            explicit CLAPUmpInputDispatcher(PluginInstanceCLAP* owner) : owner(owner) {}
+            // The MPE default, used until the sender sets a range.
+            static constexpr double kDefaultPerNotePitchBendRange{48.0};
+
+            explicit CLAPUmpInputDispatcher(PluginInstanceCLAP* owner) : owner(owner) {
+                for (auto& group : per_note_pitch_bend_ranges_)
+                    group.fill(kDefaultPerNotePitchBendRange);
+            }
 
             void onAC(remidy::uint4_t group, remidy::uint4_t channel, remidy::uint7_t bank, remidy::uint7_t index, uint32_t data, bool relative) override;
             void onCC(remidy::uint4_t group, remidy::uint4_t channel, remidy::uint7_t index, uint32_t data) override;
@@ -298,8 +326,24 @@ namespace remidy {
             bool tryCreateWith(const char* api, bool floating);
         };
 
+        // Sized for dense per-note expression so that appending never has to grow them on the
+        // audio thread; input events that do not fit are dropped for the block.
+        static constexpr uint32_t kEventListHeapBytes = 64 * 1024;
+        static constexpr uint32_t kEventListCapacity = 1024;
         std::unique_ptr<clap::helpers::EventList> events_in{};
         std::unique_ptr<clap::helpers::EventList> events_out{};
+        // Empty input list for parameter flushes, kept so that flushing does not allocate.
+        std::unique_ptr<clap::helpers::EventList> events_flush_in{};
+        // events_in as the plugin sees it: sorted by time, whatever order events were added in.
+        InputEventOrder input_event_order_{kEventListCapacity};
+        clap_input_events_t ordered_events_in_{};
+        // Parameter values enqueued ahead of the block, ordered by time. They are merged into
+        // events_in while the UMP input is dispatched, so that a value due late in the block
+        // does not hold back the notes before it.
+        std::vector<clap_event_param_value_t> scheduled_param_events_{};
+        size_t scheduled_param_events_read_{0};
+        // supported_dialects of each input note port, indexed by UMP group.
+        std::array<uint32_t, 16> note_input_dialects_{};
         AudioBuses* audio_buses{};
         ParameterSupport* _parameters{};
         PluginStateSupport* _states{};
@@ -325,6 +369,8 @@ namespace remidy {
         std::shared_ptr<std::atomic<bool>> callbacks_alive_{std::make_shared<std::atomic<bool>>(true)};
 
         void remidyProcessContextToClapProcess(clap_process_t& dst, AudioProcessContext& src);
+        // Records the output channels the plugin marked as constant zero.
+        void reportOutputSilence(AudioProcessContext& process);
         void clapProcessToRemidyProcessContext(AudioProcessContext& dst, clap_process_t& src);
         void resizeAudioPortBuffers(size_t newSize, bool isDouble);
         void resetAudioPortBuffers();
@@ -335,6 +381,17 @@ namespace remidy {
         void refreshTimingInfoOnMainThread();
         void restartForTimingChangeOnMainThread();
         void processParamsFlush();
+        // Appends an input event for this block with its header filled in, delivered in time
+        // order among the others. Returns nullptr when the preallocated list is full.
+        clap_event_header_t* allocateInputEvent(uint32_t size, uint16_t type, uint64_t sampleOffset, uint32_t flags = 0);
+        // Queues a parameter event for the block at `sampleOffset`. Returns false when the
+        // preallocated queue is full.
+        bool scheduleParamValueEvent(const clap_event_param_value_t& event, uint64_t sampleOffset);
+        // Moves scheduled parameter events due no later than `time` into events_in.
+        void flushScheduledParamEvents(uint32_t time);
+        // Reserves an input event of `size` bytes due at `time`.
+        clap_event_header_t* tryAllocateInputEvent(uint32_t size, uint32_t time);
+        void clearInputEvents();
 
     public:
         explicit PluginInstanceCLAP(
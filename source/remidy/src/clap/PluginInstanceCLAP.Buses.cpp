@@ -251,9 +251,19 @@ namespace remidy {
         }
 
         // FIXME: we need decent support for event buses
+        // Without note port info, assume the plugin takes native CLAP events.
+        owner->note_input_dialects_.fill(CLAP_NOTE_DIALECT_CLAP);
         if (plugin && plugin->canUseNotePorts()) {
             ret.numEventIn = plugin->notePortsCount(true);
             ret.numEventOut = plugin->notePortsCount(false);
+            // UMP groups past the last note port share its dialects.
+            uint32_t dialects = CLAP_NOTE_DIALECT_CLAP;
+            for (uint32_t i = 0; i < owner->note_input_dialects_.size(); ++i) {
+                clap_note_port_info_t info{};
+                if (i < ret.numEventIn && plugin->notePortsGet(i, true, &info))
+                    dialects = info.supported_dialects;
+                owner->note_input_dialects_[i] = dialects;
+            }
         }
         busesInfo = ret;
     }
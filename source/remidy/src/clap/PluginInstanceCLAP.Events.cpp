@@ -1,81 +1,235 @@
 #include "PluginFormatCLAP.hpp"
+#include <umppi/umppi.hpp>
+#include <algorithm>
 
 namespace remidy {
+    namespace {
+        constexpr uint7_t kPerNotePitchBendSensitivityIndex = 7;
+
+        // Semitones in 7.25 fixed point, the format of registered per-note controller #3 and of
+        // the MIDI 2.0 pitch bend sensitivities.
+        double semitones(uint32_t data) { return static_cast<double>(data) / (1u << 25); }
+
+        double normalized(uint32_t data) { return static_cast<double>(data) / UINT32_MAX; }
+
+        uint7_t midi1Data(uint32_t data) { return static_cast<uint7_t>(data >> 25); }
+
+        uint64_t midi2ControllerUmp(uint8_t status, uint4_t group, uint4_t channel, uint8_t byte3, uint8_t byte4, uint32_t data) {
+            const uint32_t word0 = (0x4u << 28) | (static_cast<uint32_t>(group) << 24) |
+                (static_cast<uint32_t>(status | channel) << 16) | (static_cast<uint32_t>(byte3) << 8) | byte4;
+            return (static_cast<uint64_t>(word0) << 32) | data;
+        }
+    }
+
+    uint32_t PluginInstanceCLAP::CLAPUmpInputDispatcher::dialectsFor(remidy::uint4_t group) const {
+        return owner->note_input_dialects_[group & 0xF];
+    }
+
+    void PluginInstanceCLAP::CLAPUmpInputDispatcher::pushNote(uint16_t type, remidy::uint4_t group, remidy::uint4_t channel, remidy::uint7_t note, uint16_t velocity) {
+        auto evt = reinterpret_cast<clap_event_note_t *>(owner->allocateInputEvent(sizeof(clap_event_note_t), type, timestamp()));
+        if (!evt)
+            return;
+        evt->note_id = -1;
+        evt->port_index = group;
+        evt->channel = channel;
+        evt->key = note;
+        evt->velocity = (double) velocity / UINT16_MAX;
+    }
+
+    void PluginInstanceCLAP::CLAPUmpInputDispatcher::pushNoteExpression(remidy::uint4_t group, remidy::uint4_t channel, remidy::uint7_t note, clap_note_expression expressionId, double value) {
+        auto evt = reinterpret_cast<clap_event_note_expression_t *>(owner->allocateInputEvent(
+            sizeof(clap_event_note_expression_t), CLAP_EVENT_NOTE_EXPRESSION, timestamp()));
+        if (!evt)
+            return;
+        evt->expression_id = expressionId;
+        evt->note_id = -1;
+        evt->port_index = group;
+        evt->channel = channel;
+        evt->key = note;
+        evt->value = value;
+    }
+
+    void PluginInstanceCLAP::CLAPUmpInputDispatcher::pushMidi1(remidy::uint4_t group, uint8_t status, uint8_t data1, uint8_t data2) {
+        auto evt = reinterpret_cast<clap_event_midi_t *>(owner->allocateInputEvent(sizeof(clap_event_midi_t), CLAP_EVENT_MIDI, timestamp()));
+        if (!evt)
+            return;
+        evt->port_index = group;
+        evt->data[0] = status;
+        evt->data[1] = data1;
+        evt->data[2] = data2;
+    }
+
+    void PluginInstanceCLAP::CLAPUmpInputDispatcher::pushMidi2(remidy::uint4_t group, uint32_t word0, uint32_t word1) {
+        auto evt = reinterpret_cast<clap_event_midi2_t *>(owner->allocateInputEvent(sizeof(clap_event_midi2_t), CLAP_EVENT_MIDI2, timestamp()));
+        if (!evt)
+            return;
+        evt->port_index = group;
+        evt->data[0] = word0;
+        evt->data[1] = word1;
+    }
+
+    bool PluginInstanceCLAP::CLAPUmpInputDispatcher::pushChannelMessage(remidy::uint4_t group, uint64_t midi2Ump,
+                                                                        std::initializer_list<std::array<uint8_t, 3>> midi1Messages) {
+        const auto dialects = dialectsFor(group);
+        if (dialects & CLAP_NOTE_DIALECT_MIDI2) {
+            pushMidi2(group, midi2Ump);
+            return true;
+        }
+        if ((dialects & CLAP_NOTE_DIALECT_MIDI) && midi1Messages.size() > 0) {
+            for (auto& m : midi1Messages)
+                pushMidi1(group, m[0], m[1], m[2]);
+            return true;
+        }
+        return false;
+    }
+
     void PluginInstanceCLAP::CLAPUmpInputDispatcher::onAC(remidy::uint4_t group, remidy::uint4_t channel, remidy::uint7_t bank, remidy::uint7_t index, uint32_t data, bool relative) {
-        // not in CLAP_CORE_EVENT_SPACE_ID
+        // UAPMD itself maps assignable controllers to parameters; this only forwards them to
+        // plugins that read MIDI. Relative controllers cannot be expressed in MIDI 1.0.
+        const auto status = relative ? umppi::MidiChannelStatus::RELATIVE_NRPN : umppi::MidiChannelStatus::NRPN;
+        const uint8_t cc = umppi::MidiChannelStatus::CC + channel;
+        if (relative)
+            pushChannelMessage(group, midi2ControllerUmp(status, group, channel, bank, index, data), {});
+        else
+            pushChannelMessage(group, midi2ControllerUmp(status, group, channel, bank, index, data), {
+                {cc, umppi::MidiCC::NRPN_MSB, bank},
+                {cc, umppi::MidiCC::NRPN_LSB, index},
+                {cc, umppi::MidiCC::DTE_MSB, midi1Data(data)},
+                {cc, umppi::MidiCC::DTE_LSB, static_cast<uint8_t>(data >> 18 & 0x7F)}});
     }
+
+    void PluginInstanceCLAP::CLAPUmpInputDispatcher::onRC(remidy::uint4_t group, remidy::uint4_t channel, remidy::uint7_t bank, remidy::uint7_t index, uint32_t data, bool relative) {
+        // Per-note bends are sent as note expressions, so the range they scale by is kept here.
+        if (!relative && bank == 0 && index == kPerNotePitchBendSensitivityIndex)
+            per_note_pitch_bend_ranges_[group & 0xF][channel & 0xF] = semitones(data);
+        const auto status = relative ? umppi::MidiChannelStatus::RELATIVE_RPN : umppi::MidiChannelStatus::RPN;
+        const uint8_t cc = umppi::MidiChannelStatus::CC + channel;
+        if (relative)
+            pushChannelMessage(group, midi2ControllerUmp(status, group, channel, bank, index, data), {});
+        else
+            pushChannelMessage(group, midi2ControllerUmp(status, group, channel, bank, index, data), {
+                {cc, umppi::MidiCC::RPN_MSB, bank},
+                {cc, umppi::MidiCC::RPN_LSB, index},
+                {cc, umppi::MidiCC::DTE_MSB, midi1Data(data)},
+                {cc, umppi::MidiCC::DTE_LSB, static_cast<uint8_t>(data >> 18 & 0x7F)}});
+    }
+
     void PluginInstanceCLAP::CLAPUmpInputDispatcher::onCC(remidy::uint4_t group, remidy::uint4_t channel, remidy::uint7_t index, uint32_t data) {
-        // not in CLAP_CORE_EVENT_SPACE_ID
+        // CLAP has no core event for controllers; plugins take them through their MIDI dialects.
+        pushChannelMessage(group, umppi::UmpFactory::midi2CC(group, channel, index, data), {
+            {static_cast<uint8_t>(umppi::MidiChannelStatus::CC + channel), index, midi1Data(data)}});
     }
+
     void PluginInstanceCLAP::CLAPUmpInputDispatcher::onPNAC(remidy::uint4_t group, remidy::uint4_t channel, remidy::uint7_t note, uint8_t index, uint32_t data) {
-        // not in CLAP_CORE_EVENT_SPACE_ID
+        // UAPMD maps per-note assignable controllers to per-note parameters itself, so only
+        // plugins that read MIDI 2.0 get them as they are.
+        if (dialectsFor(group) & CLAP_NOTE_DIALECT_MIDI2)
+            pushMidi2(group, umppi::UmpFactory::midi2PerNoteACC(group, channel, note, index, data));
     }
+
     void PluginInstanceCLAP::CLAPUmpInputDispatcher::onPNRC(remidy::uint4_t group, remidy::uint4_t channel, remidy::uint7_t note, uint8_t index, uint32_t data) {
-        // not in CLAP_CORE_EVENT_SPACE_ID
+        const auto dialects = dialectsFor(group);
+        if (dialects & CLAP_NOTE_DIALECT_CLAP) {
+            // Registered per-note controllers share their numbers with the corresponding CCs,
+            // except #3 which is an absolute pitch in 7.25 fixed point.
+            switch (index) {
+                case 1:
+                    pushNoteExpression(group, channel, note, CLAP_NOTE_EXPRESSION_VIBRATO, normalized(data));
+                    return;
+                case 3:
+                    pushNoteExpression(group, channel, note, CLAP_NOTE_EXPRESSION_TUNING,
+                                       semitones(data) - note);
+                    return;
+                case 7:
+                    // Linear gain, so the full range only attenuates.
+                    pushNoteExpression(group, channel, note, CLAP_NOTE_EXPRESSION_VOLUME, normalized(data));
+                    return;
+                case 10:
+                    pushNoteExpression(group, channel, note, CLAP_NOTE_EXPRESSION_PAN, normalized(data));
+                    return;
+                case 11:
+                    pushNoteExpression(group, channel, note, CLAP_NOTE_EXPRESSION_EXPRESSION, normalized(data));
+                    return;
+                case 74:
+                    pushNoteExpression(group, channel, note, CLAP_NOTE_EXPRESSION_BRIGHTNESS, normalized(data));
+                    return;
+                default:
+                    break;
+            }
+        }
+        if (dialects & CLAP_NOTE_DIALECT_MIDI2)
+            pushMidi2(group, umppi::UmpFactory::midi2PerNoteRCC(group, channel, note, index, data));
     }
+
     void PluginInstanceCLAP::CLAPUmpInputDispatcher::onPitchBend(remidy::uint4_t group, remidy::uint4_t channel, int8_t perNoteOrMinus, uint32_t data) {
-        // FIXME: implement using CLAP_NOTE_EXPRESSION_TUNING https://github.com/free-audio/clap/discussions/203
+        const auto dialects = dialectsFor(group);
         if (perNoteOrMinus >= 0) {
-            auto evt = reinterpret_cast<clap_event_note_expression_t *>(owner->events_in->tryAllocate(alignof(void *),
-                                                                                           sizeof(clap_event_note_expression_t)));
-            if (!evt)
-                return;
-            evt->header.size = sizeof(clap_event_note_expression_t);
-            evt->header.time = timestamp();
-            evt->header.space_id = CLAP_CORE_EVENT_SPACE_ID;
-            evt->header.type = CLAP_EVENT_NOTE_ON;
-            evt->header.flags = 0;
-            evt->note_id = -1;
-            evt->port_index = group;
-            evt->channel = channel;
-            evt->expression_id = CLAP_NOTE_EXPRESSION_TUNING;
-            evt->key = static_cast<uint8_t>(perNoteOrMinus);
-            evt->value = static_cast<double>(data) / UINT32_MAX;
-        } else {
-            // not in CLAP_CORE_EVENT_SPACE_ID
+            const auto note = static_cast<uint7_t>(perNoteOrMinus);
+            if (dialects & CLAP_NOTE_DIALECT_CLAP) {
+                // CLAP tuning is in semitones relative to the key; MIDI 2.0 centers at 0x80000000.
+                const double bend = (static_cast<double>(data) - 0x80000000u) / 0x80000000u;
+                pushNoteExpression(group, channel, note, CLAP_NOTE_EXPRESSION_TUNING,
+                                   bend * per_note_pitch_bend_ranges_[group & 0xF][channel & 0xF]);
+            } else if (dialects & CLAP_NOTE_DIALECT_MIDI2)
+                pushMidi2(group, umppi::UmpFactory::midi2PerNotePitchBendDirect(group, channel, note, data));
+            return;
         }
+        const auto value14 = data >> 18;
+        pushChannelMessage(group, umppi::UmpFactory::midi2PitchBendDirect(group, channel, data), {
+            {static_cast<uint8_t>(umppi::MidiChannelStatus::PITCH_BEND + channel),
+             static_cast<uint8_t>(value14 & 0x7F), static_cast<uint8_t>(value14 >> 7)}});
     }
 
     void PluginInstanceCLAP::CLAPUmpInputDispatcher::onPressure(remidy::uint4_t group, remidy::uint4_t channel, int8_t perNoteOrMinus, uint32_t data) {
-        // FIXME: implement using CLAP_NOTE_EXPRESSION_PRESSURE for PAf., but how about CAf?
+        if (perNoteOrMinus < 0) {
+            // CLAP has no channel-wide pressure event.
+            pushChannelMessage(group, umppi::UmpFactory::midi2CAf(group, channel, data), {
+                {static_cast<uint8_t>(umppi::MidiChannelStatus::CAF + channel), midi1Data(data), 0}});
+            return;
+        }
+        const auto note = static_cast<uint7_t>(perNoteOrMinus);
+        if (dialectsFor(group) & CLAP_NOTE_DIALECT_CLAP)
+            pushNoteExpression(group, channel, note, CLAP_NOTE_EXPRESSION_PRESSURE, normalized(data));
+        else
+            pushChannelMessage(group, umppi::UmpFactory::midi2PAf(group, channel, note, data), {
+                {static_cast<uint8_t>(umppi::MidiChannelStatus::PAF + channel), note, midi1Data(data)}});
     }
+
     void PluginInstanceCLAP::CLAPUmpInputDispatcher::onProgramChange(remidy::uint4_t group, remidy::uint4_t channel, remidy::uint7_t flags, remidy::uint7_t program, remidy::uint7_t bankMSB, remidy::uint7_t bankLSB) {
-        // not in CLAP_CORE_EVENT_SPACE_ID
-    }
-    void PluginInstanceCLAP::CLAPUmpInputDispatcher::onRC(remidy::uint4_t group, remidy::uint4_t channel, remidy::uint7_t bank, remidy::uint7_t index, uint32_t data, bool relative) {
-        // not in CLAP_CORE_EVENT_SPACE_ID
+        const auto midi2 = umppi::UmpFactory::midi2Program(group, channel, flags, program, bankMSB, bankLSB);
+        const uint8_t cc = umppi::MidiChannelStatus::CC + channel;
+        const uint8_t pc = umppi::MidiChannelStatus::PROGRAM + channel;
+        if (flags & umppi::MidiProgramChangeOptions::BANK_VALID)
+            pushChannelMessage(group, midi2, {
+                {cc, umppi::MidiCC::BANK_SELECT, bankMSB},
+                {cc, umppi::MidiCC::BANK_SELECT_LSB, bankLSB},
+                {pc, program, 0}});
+        else
+            pushChannelMessage(group, midi2, {{pc, program, 0}});
     }
+
     void PluginInstanceCLAP::CLAPUmpInputDispatcher::onNoteOn(remidy::uint4_t group, remidy::uint4_t channel, remidy::uint7_t note, uint8_t attributeType, uint16_t velocity, uint16_t attribute) {
-        auto evt = reinterpret_cast<clap_event_note_t *>(owner->events_in->tryAllocate(alignof(void *),
-                                                                                       sizeof(clap_event_note_t)));
-        if (!evt)
+        if (dialectsFor(group) & CLAP_NOTE_DIALECT_CLAP) {
+            pushNote(CLAP_EVENT_NOTE_ON, group, channel, note, velocity);
+            // A 7.9 pitch attribute is the note's initial tuning, in semitones.
+            if (attributeType == umppi::MidiNoteAttributeType::Pitch7_9)
+                pushNoteExpression(group, channel, note, CLAP_NOTE_EXPRESSION_TUNING,
+                                   (attribute >> 9) + (attribute & 0x1FF) / 512.0 - note);
             return;
-        evt->header.size = sizeof(clap_event_note_t);
-        evt->header.time = timestamp();
-        evt->header.space_id = CLAP_CORE_EVENT_SPACE_ID;
-        evt->header.type = CLAP_EVENT_NOTE_ON;
-        evt->header.flags = 0;
-        evt->note_id = -1;
-        evt->port_index = group;
-        evt->channel = channel;
-        evt->key = note;
-        evt->velocity = (double) velocity / UINT16_MAX;
+        }
+        // MIDI 1.0 reads velocity 0 as a note-off.
+        pushChannelMessage(group, umppi::UmpFactory::midi2NoteOn(group, channel, note, attributeType, velocity, attribute), {
+            {static_cast<uint8_t>(umppi::MidiChannelStatus::NOTE_ON + channel), note,
+             static_cast<uint8_t>(std::max(1, velocity >> 9))}});
     }
+
     void PluginInstanceCLAP::CLAPUmpInputDispatcher::onNoteOff(remidy::uint4_t group, remidy::uint4_t channel, remidy::uint7_t note, uint8_t attributeType, uint16_t velocity, uint16_t attribute) {
-        auto evt = reinterpret_cast<clap_event_note_t *>(owner->events_in->tryAllocate(alignof(void *),
-                                                                                       sizeof(clap_event_note_t)));
-        if (!evt)
+        if (dialectsFor(group) & CLAP_NOTE_DIALECT_CLAP) {
+            pushNote(CLAP_EVENT_NOTE_OFF, group, channel, note, velocity);
             return;
-        evt->header.size = sizeof(clap_event_note_t);
-        evt->header.time = timestamp();
-        evt->header.space_id = CLAP_CORE_EVENT_SPACE_ID;
-        evt->header.type = CLAP_EVENT_NOTE_OFF;
-        evt->header.flags = 0;
-        evt->note_id = -1;
-        evt->port_index = group;
-        evt->channel = channel;
-        evt->key = note;
-        evt->velocity = (double) velocity / UINT16_MAX;
+        }
+        pushChannelMessage(group, umppi::UmpFactory::midi2NoteOff(group, channel, note, attributeType, velocity, attribute), {
+            {static_cast<uint8_t>(umppi::MidiChannelStatus::NOTE_OFF + channel), note, static_cast<uint8_t>(velocity >> 9)}});
     }
 
 }
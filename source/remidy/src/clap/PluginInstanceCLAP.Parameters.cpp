@@ -172,24 +172,18 @@ namespace remidy {
     StatusCode PluginInstanceCLAP::ParameterSupport::enqueueParameterRT(uint32_t index, double value, uint64_t timestamp) {
         if (index >= parameter_ids.size() || index >= parameter_cookies.size())
             return StatusCode::INVALID_PARAMETER_OPERATION;
-        auto a = owner->events_in->tryAllocate(alignof(void *), sizeof(clap_event_param_value_t));
-        if (!a)
-            return StatusCode::INSUFFICIENT_MEMORY;
-        const auto evt = reinterpret_cast<clap_event_param_value_t *>(a);
-        *evt = {};
-        evt->header.type = CLAP_EVENT_PARAM_VALUE;
-        evt->header.space_id = CLAP_CORE_EVENT_SPACE_ID;
-        evt->header.size = sizeof(clap_event_param_value_t);
-        evt->header.flags = CLAP_EVENT_IS_LIVE;
-        // Convert timestamp from nanoseconds to samples
-        evt->header.time = static_cast<uint32_t>((timestamp * owner->sample_rate_) / 1000000000.0);
-        evt->cookie = parameter_cookies[index];
-        evt->port_index = 0;
-        evt->channel = 0;
-        evt->param_id = parameter_ids[index];
-        evt->value = value;
-
-        return StatusCode::OK;
+        clap_event_param_value_t evt{};
+        evt.header.flags = CLAP_EVENT_IS_LIVE;
+        evt.cookie = parameter_cookies[index];
+        // -1 is the wildcard: the change applies to every voice, not only to key 0.
+        evt.note_id = -1;
+        evt.port_index = -1;
+        evt.channel = -1;
+        evt.key = -1;
+        evt.param_id = parameter_ids[index];
+        evt.value = value;
+        // `timestamp` is the sample offset in the block, as UMP input dispatchers pass it.
+        return owner->scheduleParamValueEvent(evt, timestamp) ? StatusCode::OK : StatusCode::INSUFFICIENT_MEMORY;
     }
 
     StatusCode PluginInstanceCLAP::ParameterSupport::setPerNoteController(PerNoteControllerContext context, uint32_t index, double value) {
@@ -232,18 +226,12 @@ namespace remidy {
     StatusCode PluginInstanceCLAP::ParameterSupport::enqueuePerNoteControllerRT(PerNoteControllerContext context, uint32_t index, double value, uint64_t timestamp) {
         if (index >= parameter_ids.size() || index >= parameter_cookies.size())
             return StatusCode::INVALID_PARAMETER_OPERATION;
-        auto evt = reinterpret_cast<clap_event_param_value_t *>(owner->events_in->tryAllocate(alignof(void *),
-                                                                                              sizeof(clap_event_param_value_t)));
+        auto evt = reinterpret_cast<clap_event_param_value_t *>(owner->allocateInputEvent(
+            sizeof(clap_event_param_value_t), CLAP_EVENT_PARAM_VALUE, timestamp, CLAP_EVENT_IS_LIVE));
         if (!evt)
             return StatusCode::INSUFFICIENT_MEMORY;
-        *evt = {};
-        evt->header.type = CLAP_EVENT_PARAM_VALUE;
-        evt->header.space_id = CLAP_CORE_EVENT_SPACE_ID;
-        evt->header.size = sizeof(clap_event_param_value_t);
-        evt->header.flags = CLAP_EVENT_IS_LIVE;
-        // Convert timestamp from nanoseconds to samples
-        evt->header.time = static_cast<uint32_t>((timestamp * owner->sample_rate_) / 1000000000.0);
         evt->cookie = parameter_cookies[index];
+        evt->note_id = -1;
         evt->port_index = context.group;
         evt->channel = context.channel;
         evt->param_id = parameter_ids[index];
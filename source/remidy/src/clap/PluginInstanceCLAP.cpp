@@ -4,6 +4,7 @@
 #undef max
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <thread>
 
@@ -20,8 +21,20 @@ namespace remidy {
             this->host->attachInstance(this);
 
         audio_buses = new AudioBuses(this);
-        events_in = std::make_unique<clap::helpers::EventList>();
-        events_out = std::make_unique<clap::helpers::EventList>();
+        events_in = std::make_unique<clap::helpers::EventList>(kEventListHeapBytes, kEventListCapacity);
+        events_out = std::make_unique<clap::helpers::EventList>(kEventListHeapBytes, kEventListCapacity);
+        events_flush_in = std::make_unique<clap::helpers::EventList>();
+        scheduled_param_events_.reserve(kEventListCapacity);
+        ordered_events_in_.ctx = this;
+        ordered_events_in_.size = [](const clap_input_events_t* list) -> uint32_t {
+            return static_cast<uint32_t>(static_cast<PluginInstanceCLAP*>(list->ctx)->input_event_order_.size());
+        };
+        ordered_events_in_.get = [](const clap_input_events_t* list, uint32_t index) -> const clap_event_header_t* {
+            auto* self = static_cast<PluginInstanceCLAP*>(list->ctx);
+            if (index >= self->input_event_order_.size())
+                return nullptr;
+            return self->events_in->get(self->input_event_order_.indexAt(index));
+        };
     }
 
     PluginInstanceCLAP::~PluginInstanceCLAP() {
@@ -68,6 +81,8 @@ namespace remidy {
         delete _parameters;
         delete _states;
         delete _presets;
+
+        owner->unrefLibrary(info());
     }
 
     void resetCLAPAudioBuffers(clap_audio_buffer_t& a) {
@@ -204,29 +219,23 @@ namespace remidy {
     }
 
     StatusCode PluginInstanceCLAP::configure(ConfigurationRequest &configuration) {
+        // If host requests 64-bit, every port has to support it; otherwise the
+        // plugin runs in 32-bit, and the request tells the host which one it got.
+        if (configuration.dataType == AudioContentType::Float64) {
+            const auto supports64 = [](const clap_audio_port_info_t& portInfo) {
+                return (portInfo.flags & CLAP_AUDIO_PORT_SUPPORTS_64BITS) != 0;
+            };
+            if (!std::ranges::all_of(inputPortInfos, supports64) || !std::ranges::all_of(outputPortInfos, supports64)) {
+                owner->getLogger()->logInfo("%s: Plugin does not support 64-bit processing, using 32-bit",
+                                            info()->displayName().c_str());
+                configuration.dataType = AudioContentType::Float32;
+            }
+        }
         bool useDouble = configuration.dataType == AudioContentType::Float64;
         is_offline_ = configuration.offlineMode;
         use_double_precision_ = useDouble;
         sample_rate_ = configuration.sampleRate;
 
-        // If host requests 64-bit, verify every port supports it; disable the plugin if not.
-        if (useDouble) {
-            for (const auto& portInfo : inputPortInfos) {
-                if (!(portInfo.flags & CLAP_AUDIO_PORT_SUPPORTS_64BITS)) {
-                    owner->getLogger()->logWarning("%s: Plugin does not support 64-bit processing, disabling plugin",
-                                                  info()->displayName().c_str());
-                    return StatusCode::FAILED_TO_CONFIGURE;
-                }
-            }
-            for (const auto& portInfo : outputPortInfos) {
-                if (!(portInfo.flags & CLAP_AUDIO_PORT_SUPPORTS_64BITS)) {
-                    owner->getLogger()->logWarning("%s: Plugin does not support 64-bit processing, disabling plugin",
-                                                  info()->displayName().c_str());
-                    return StatusCode::FAILED_TO_CONFIGURE;
-                }
-            }
-        }
-
         // ensure to clean up old buffer. Note that buses in old configuration may be different,
         // so handle cleanup and allocation in different steps.
         cleanupBuffers();
@@ -241,6 +250,10 @@ namespace remidy {
         // It seems we have to activate plugin buses first.
         buffer_size_ = configuration.bufferSizeInSamples;
         EventLoop::runTaskOnMainThread([&] {
+            // A repeated configure() (e.g. for a new sample rate) must not
+            // activate an already active plugin.
+            if (activated_)
+                plugin->deactivate();
             activated_ = plugin->activate(configuration.sampleRate, 1, configuration.bufferSizeInSamples);
             refreshTimingInfoOnMainThread();
         });
@@ -417,7 +430,13 @@ namespace remidy {
             auto& audioIn = dst.audio_inputs[bus];
             const bool hostHasBus = static_cast<int32_t>(bus) < hostInputBuses;
             const int32_t hostChannels = hostHasBus ? src.inputChannelCount(static_cast<int32_t>(bus)) : 0;
+            // Silent host channels are constant zero; so are the fallbacks.
+            const auto silenceFlags = hostHasBus ? src.inputSilenceFlags(static_cast<int32_t>(bus)) : 0;
+            audioIn.constant_mask = 0;
             for (size_t ch = 0; ch < audioIn.channel_count; ++ch) {
+                const size_t hostChannel = ch < static_cast<size_t>(hostChannels) ? ch : 0;
+                if (ch < 64 && (hostChannels == 0 || (hostChannel < 64 && (silenceFlags & (uint64_t{1} << hostChannel)))))
+                    audioIn.constant_mask |= uint64_t{1} << ch;
                 if (!useDouble) {
                     float* ptr = nullptr;
                     if (hostHasBus && ch < static_cast<size_t>(hostChannels))
@@ -445,6 +464,8 @@ namespace remidy {
             auto& audioOut = dst.audio_outputs[bus];
             const bool hostHasBus = static_cast<int32_t>(bus) < hostOutputBuses;
             const int32_t hostChannels = hostHasBus ? src.outputChannelCount(static_cast<int32_t>(bus)) : 0;
+            // Set by the plugin for the channels it leaves constant.
+            audioOut.constant_mask = 0;
             for (size_t ch = 0; ch < audioOut.channel_count; ++ch) {
                 if (!useDouble) {
                     float* ptr = nullptr;
@@ -465,10 +486,30 @@ namespace remidy {
         }
 
         // set event buffers
-        clap_process.in_events = events_in->clapInputEvents();
+        clap_process.in_events = &ordered_events_in_;
         clap_process.out_events = events_out->clapOutputEvents();
     }
 
+    void PluginInstanceCLAP::reportOutputSilence(AudioProcessContext& process) {
+        // A constant channel is silent when its constant is zero.
+        const auto hostOutputBuses = static_cast<size_t>(process.audioOutBusCount());
+        for (size_t bus = 0; bus < clap_process.audio_outputs_count && bus < hostOutputBuses; ++bus) {
+            const auto& audioOut = clap_process.audio_outputs[bus];
+            const auto hostChannels = static_cast<size_t>(process.outputChannelCount(static_cast<int32_t>(bus)));
+            uint64_t flags = 0;
+            for (size_t ch = 0; ch < audioOut.channel_count && ch < hostChannels && ch < 64; ++ch) {
+                if (!(audioOut.constant_mask & (uint64_t{1} << ch)) || clap_process.frames_count == 0)
+                    continue;
+                const bool zero = use_double_precision_
+                    ? audioOut.data64 && audioOut.data64[ch] && audioOut.data64[ch][0] == 0.0
+                    : audioOut.data32 && audioOut.data32[ch] && audioOut.data32[ch][0] == 0.0f;
+                if (zero)
+                    flags |= uint64_t{1} << ch;
+            }
+            process.outputSilenceFlags(static_cast<int32_t>(bus), flags);
+        }
+    }
+
     StatusCode PluginInstanceCLAP::process(AudioProcessContext &process) {
         auto expectedState = ProcessingState::Idle;
         if (!processing_state_.compare_exchange_strong(
@@ -500,6 +541,8 @@ namespace remidy {
 
         auto shouldProcess = is_processing.load(std::memory_order_seq_cst);
         if (!shouldProcess) {
+            // Whatever was enqueued for this block is stale by the time processing resumes.
+            clearInputEvents();
             bool expected = true;
             if (processing_active_.compare_exchange_strong(expected, false, std::memory_order_acq_rel)) {
                 plugin->stopProcessing();
@@ -524,10 +567,22 @@ namespace remidy {
         events_out->clear();
 
         ump_input_dispatcher.process(process);
+        flushScheduledParamEvents(std::numeric_limits<uint32_t>::max());
+        // Pulling the stragglers back to the last frame keeps the delivery order sorted.
+        if (clap_process.frames_count > 0) {
+            const auto lastFrame = clap_process.frames_count - 1;
+            for (uint32_t i = 0, n = events_in->size(); i < n; ++i) {
+                auto* hdr = events_in->get(i);
+                if (hdr && hdr->time > lastFrame)
+                    hdr->time = lastFrame;
+            }
+        }
 
         // FIXME: we should report process result somehow
         auto result = plugin->process(&clap_process);
         auto ret = result == CLAP_PROCESS_ERROR ? StatusCode::FAILED_TO_PROCESS : StatusCode::OK;
+        if (ret == StatusCode::OK)
+            reportOutputSilence(process);
 
         // Convert CLAP output events to UMP
         auto& eventOut = process.eventOut();
@@ -606,6 +661,7 @@ namespace remidy {
                             }
                         }
                     }
+                    break;
                 }
                 case CLAP_EVENT_MIDI: {
                     // Convert MIDI1 to MIDI2 UMP
@@ -705,11 +761,75 @@ namespace remidy {
         // Update eventOut position
         eventOut.position(umpPosition * sizeof(uint32_t));
         events_out->clear();
-        events_in->clear();
+        clearInputEvents();
 
         return ret;
     }
 
+    clap_event_header_t* PluginInstanceCLAP::allocateInputEvent(uint32_t size, uint16_t type, uint64_t sampleOffset, uint32_t flags) {
+        flushScheduledParamEvents(static_cast<uint32_t>(
+            std::min<uint64_t>(sampleOffset, std::numeric_limits<uint32_t>::max())));
+        const auto time = static_cast<uint32_t>(std::min<uint64_t>(sampleOffset, std::numeric_limits<uint32_t>::max()));
+        auto* hdr = tryAllocateInputEvent(size, time);
+        if (!hdr)
+            return nullptr;
+        std::memset(hdr, 0, size);
+        hdr->size = size;
+        hdr->time = time;
+        hdr->space_id = CLAP_CORE_EVENT_SPACE_ID;
+        hdr->type = type;
+        hdr->flags = flags;
+        return hdr;
+    }
+
+    clap_event_header_t* PluginInstanceCLAP::tryAllocateInputEvent(uint32_t size, uint32_t time) {
+        if (input_event_order_.size() >= kEventListCapacity)
+            return nullptr;
+        const auto index = events_in->size();
+        auto* hdr = reinterpret_cast<clap_event_header_t*>(events_in->tryAllocate(alignof(void*), size));
+        if (hdr)
+            input_event_order_.append(index, time);
+        return hdr;
+    }
+
+    bool PluginInstanceCLAP::scheduleParamValueEvent(const clap_event_param_value_t& event, uint64_t sampleOffset) {
+        if (scheduled_param_events_.size() == scheduled_param_events_.capacity())
+            return false;
+        auto scheduled = event;
+        scheduled.header.size = sizeof(clap_event_param_value_t);
+        scheduled.header.time = static_cast<uint32_t>(std::min<uint64_t>(sampleOffset, std::numeric_limits<uint32_t>::max()));
+        scheduled.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+        scheduled.header.type = CLAP_EVENT_PARAM_VALUE;
+        // Equal times keep their enqueue order; nothing goes before what was already flushed.
+        const auto position = std::upper_bound(
+            scheduled_param_events_.begin() + static_cast<std::ptrdiff_t>(scheduled_param_events_read_),
+            scheduled_param_events_.end(), scheduled.header.time,
+            [](uint32_t time, const clap_event_param_value_t& e) { return time < e.header.time; });
+        scheduled_param_events_.insert(position, scheduled);
+        return true;
+    }
+
+    void PluginInstanceCLAP::flushScheduledParamEvents(uint32_t time) {
+        while (scheduled_param_events_read_ < scheduled_param_events_.size()) {
+            const auto& scheduled = scheduled_param_events_[scheduled_param_events_read_];
+            if (scheduled.header.time > time)
+                break;
+            auto* evt = reinterpret_cast<clap_event_param_value_t*>(
+                tryAllocateInputEvent(sizeof(clap_event_param_value_t), scheduled.header.time));
+            if (!evt)
+                break;
+            *evt = scheduled;
+            ++scheduled_param_events_read_;
+        }
+    }
+
+    void PluginInstanceCLAP::clearInputEvents() {
+        events_in->clear();
+        input_event_order_.clear();
+        scheduled_param_events_.clear();
+        scheduled_param_events_read_ = 0;
+    }
+
     PluginParameterSupport* PluginInstanceCLAP::parameters() {
         if (!_parameters)
             _parameters = new ParameterSupport(this);
@@ -766,9 +886,8 @@ namespace remidy {
 
         // Use dedicated event lists for parameter flush exchanges
         events_out->clear();
-        clap::helpers::EventList flushInputEvents;
         plugin->paramsFlush(
-                flushInputEvents.clapInputEvents(),
+                events_flush_in->clapInputEvents(),
                 events_out->clapOutputEvents()
         );
 
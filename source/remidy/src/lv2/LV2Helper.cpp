@@ -450,6 +450,23 @@ jalv_worker_destroy(JalvWorker* worker);
 void
 jalv_worker_finish(JalvWorker* worker);
 
+static void apply_offline_mode(LV2ImplPluginContext* ctx, LilvInstance* instance, bool offlineMode) {
+    if (!offlineMode)
+        return;
+    auto iface = (LV2_Options_Interface*) lilv_instance_get_extension_data(instance, LV2_OPTIONS__options);
+    if (!iface) {
+        ctx->statics->logger->logWarning("Failed to set offlineMode (no options interface)");
+        return;
+    }
+    LV2_Options_Option opts[] = {
+        {LV2_OPTIONS_INSTANCE, 0, ctx->statics->urids.urid_core_free_wheeling, sizeof(bool), ctx->statics->urids.urid_atom_bool_type, &offlineMode},
+        {LV2_OPTIONS_INSTANCE, 0, 0, 0, 0}
+    };
+    auto result = iface->set(lilv_instance_get_handle(instance), opts);
+    if (result != LV2_OPTIONS_SUCCESS)
+        ctx->statics->logger->logWarning("Failed to set offlineMode (most likely ignored)");
+}
+
 LilvInstance* instantiate_plugin(
         LV2ImplWorldContext* worldContext,
         LV2ImplPluginContext* pluginContext,
@@ -499,22 +516,32 @@ LilvInstance* instantiate_plugin(
         jalv_worker_init(worldContext, &ctx->state_worker, iface, false);
     }
 
-    // set offline mode
-    if (offlineMode) {
-        auto iface = (LV2_Options_Interface*) lilv_instance_get_extension_data(ctx->instance, LV2_OPTIONS__options);
-        LV2_Options_Option opts[] = {
-            {LV2_OPTIONS_INSTANCE, 0, ctx->statics->urids.urid_core_free_wheeling, sizeof(bool), ctx->statics->urids.urid_atom_bool_type, &offlineMode},
-            {LV2_OPTIONS_INSTANCE, 0, 0, 0, 0}
-        };
-        auto result = iface->set(ctx->instance, opts);
-        if (result != LV2_OPTIONS_SUCCESS)
-            ctx->statics->logger->logWarning("Failed to set offlineMode (most likely ignored)");
-    }
-
+    apply_offline_mode(ctx, ctx->instance, offlineMode);
 
     return ctx->instance;
 }
 
+LilvInstance* reinstantiate_plugin(
+        LV2ImplWorldContext* worldContext,
+        LV2ImplPluginContext* pluginContext,
+        const LilvPlugin* plugin,
+        int sampleRate,
+        bool offlineMode) {
+    auto ctx = pluginContext;
+
+    auto& features = worldContext->features;
+    features.worker_schedule_data.handle = &ctx->worker;
+    features.state_worker_schedule_data.handle = &ctx->state_worker;
+
+    auto instance = lilv_plugin_instantiate(plugin, sampleRate, worldContext->features.features);
+    if (!instance) {
+        worldContext->logger->logError("Failed to re-instantiate LV2 plugin.");
+        return nullptr;
+    }
+    apply_offline_mode(ctx, instance, offlineMode);
+    return instance;
+}
+
 void on_terminate_plugin(LV2ImplPluginContext* l) {
 
     l->exit = true;
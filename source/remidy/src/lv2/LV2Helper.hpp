@@ -556,4 +556,15 @@ public:
         const LilvPlugin* plugin,
         int sampleRate,
         bool offlineMode);
+
+    // Instantiates the plugin once more for a context that already went
+    // through instantiate_plugin(), e.g. at a new sample rate. The context,
+    // its workers and ctx->instance are left untouched; the caller switches
+    // ctx->instance over once the new instance is ready.
+    LilvInstance* reinstantiate_plugin(
+        LV2ImplWorldContext* worldContext,
+        LV2ImplPluginContext* pluginContext,
+        const LilvPlugin* plugin,
+        int sampleRate,
+        bool offlineMode);
 }
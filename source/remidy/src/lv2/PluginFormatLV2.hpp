@@ -286,6 +286,8 @@ namespace remidy {
             // Notify UI of parameter changes
             void notifyParameterChange(LV2_URID propertyUrid, double value);
 
+            bool isCreated() const { return created; }
+
         private:
             PluginInstanceLV2* owner;
 
@@ -388,6 +390,25 @@ namespace remidy {
         std::vector<std::vector<float>> audio_in_fallback_buffers{};
         std::vector<std::vector<float>> audio_out_fallback_buffers{};
 
+        // Everything bound to one LilvInstance: its port buffers and where
+        // the remidy audio buses go among its ports.
+        struct PortSetup {
+            std::vector<LV2PortInfo> ports{};
+            int32_t control_atom_port_index{-1};
+            std::vector<RemidyToLV2PortMapping> audio_in_port_mapping{};
+            std::vector<RemidyToLV2PortMapping> audio_out_port_mapping{};
+            std::vector<std::vector<float>> audio_in_fallback_buffers{};
+            std::vector<std::vector<float>> audio_out_fallback_buffers{};
+        };
+        PortSetup createPortSetup(LilvInstance* target, uint32_t bufferSizeInSamples);
+        // Swaps the instance's current port setup with `setup`. Never allocates.
+        void swapPortSetup(PortSetup& setup) noexcept;
+        static void freePortBuffers(std::vector<LV2PortInfo>& ports);
+        StatusCode reconfigureLive(ConfigurationRequest& configuration);
+        // Held by process() for a block, and by reconfigureLive() while it
+        // switches instances. process() never waits for it.
+        std::atomic_flag instance_swap_lock_{};
+
         AudioBuses* audio_buses{};
 
         ParameterSupport *_parameters{};
@@ -430,6 +451,10 @@ namespace remidy {
         // audio processing core functions.
         StatusCode configure(ConfigurationRequest &configuration) override;
 
+        // A repeated configure() instantiates the plugin again in the calling
+        // thread, restores its state and switches over at a block boundary.
+        bool supportsLiveReconfiguration() const override { return true; }
+
         StatusCode startProcessing() override;
 
         StatusCode stopProcessing() override;
@@ -455,6 +480,8 @@ namespace remidy {
         // https://github.com/lv2/lv2/issues/68
         double tailLengthInSeconds() const override { return 0.0; }
         bool requiresReplacingProcess() const override { return false; }
+        // run() is in the audio threading class: any thread, never concurrently.
+        bool supportsProcessingOffAudioThread() const override { return true; }
     };
 
     // FIXME: this should handle both RT and non-RT cases
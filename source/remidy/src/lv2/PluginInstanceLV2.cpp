@@ -2,6 +2,8 @@
 #include <umppi/umppi.hpp>
 #include <algorithm>
 #include <chrono>
+#include <thread>
+#include <utility>
 #include <vector>
 #include <cstring>
 #include <lv2/atom/util.h>
@@ -38,11 +40,8 @@ remidy::PluginInstanceLV2::~PluginInstanceLV2() {
     }
     instance = nullptr;
 
-    if (plugin) {
-        for (auto p : lv2_ports)
-            if (p.port_buffer)
-                free(p.port_buffer);
-    }
+    if (plugin)
+        freePortBuffers(lv2_ports);
 
     delete audio_buses;
 
@@ -67,11 +66,11 @@ bool getNextAudioPortIndex(remidy_lv2::LV2ImplPluginContext& ctx, const LilvPlug
 remidy::StatusCode remidy::PluginInstanceLV2::configure(ConfigurationRequest& configuration) {
     // Do we have to deal with offlineMode? LV2 only mentions hardRT*Capable*.
 
+    // Audio ports are float-only.
+    configuration.dataType = AudioContentType::Float32;
+
     if (instance)
-        // we need to save state delete instance, recreate instance with the
-        // new configuration, and restore the state.
-        // FIXME: implement
-        throw std::runtime_error("PluginInstanceLV2::configure() re-configuration is not implemented");
+        return reconfigureLive(configuration);
 
     audio_buses->configure(configuration);
     sample_rate = configuration.sampleRate;
@@ -80,19 +79,78 @@ remidy::StatusCode remidy::PluginInstanceLV2::configure(ConfigurationRequest& co
     if (!instance)
         return StatusCode::FAILED_TO_INSTANTIATE;
 
-    for (const auto p : lv2_ports)
-        if (p.port_buffer)
-            free(p.port_buffer);
-    lv2_ports.clear();
-    control_atom_port_index = -1;
+    auto setup = createPortSetup(instance, configuration.bufferSizeInSamples);
+    swapPortSetup(setup);
+    freePortBuffers(setup.ports);
     cached_latency_samples_.store(0, std::memory_order_release);
 
+    updateLatencyFromPort(false);
+
+    return StatusCode::OK;
+}
+
+remidy::StatusCode remidy::PluginInstanceLV2::reconfigureLive(ConfigurationRequest& configuration) {
+    // instance-access hands the running instance to the UI, which cannot
+    // follow it to a new one.
+    if (auto* lv2UI = dynamic_cast<UISupport*>(_ui); lv2UI && lv2UI->isCreated()) {
+        formatImpl->getLogger()->logWarning("LV2 plugin %s cannot be reconfigured while its UI is open", info()->displayName().c_str());
+        return StatusCode::FAILED_TO_CONFIGURE;
+    }
+
+    // Everything up to the switch happens here while process() keeps
+    // running the current instance. The bus layout is kept as it is.
+    auto next = remidy_lv2::reinstantiate_plugin(formatImpl->worldContext, &implContext, plugin,
+                                                 configuration.sampleRate, configuration.offlineMode);
+    if (!next)
+        return StatusCode::FAILED_TO_INSTANTIATE;
+    auto setup = createPortSetup(next, configuration.bufferSizeInSamples);
+
+    // The plugin's internal state goes through the state interface. Control
+    // port values are copied at the switch, so changes made meanwhile stay.
+    const auto flags = static_cast<uint32_t>(LV2_STATE_IS_POD | LV2_STATE_IS_NATIVE);
+    if (auto state = lilv_state_new_from_instance(plugin, instance, getLV2UridMapData(),
+                                                  nullptr, nullptr, nullptr, nullptr,
+                                                  nullptr, nullptr, flags, formatImpl->features.data())) {
+        lilv_state_restore(state, next, nullptr, nullptr, flags, formatImpl->features.data());
+        lilv_state_free(state);
+    }
+
+    while (instance_swap_lock_.test_and_set(std::memory_order_acquire))
+        std::this_thread::yield();
+    for (size_t i = 0, n = std::min(lv2_ports.size(), setup.ports.size()); i < n; i++) {
+        const auto& from = lv2_ports[i];
+        const auto& to = setup.ports[i];
+        if (from.atom_in_index < 0 && from.atom_out_index < 0 && from.port_buffer && to.port_buffer)
+            std::memcpy(to.port_buffer, from.port_buffer, std::min(from.buffer_size, to.buffer_size));
+    }
+    swapPortSetup(setup);
+    auto previous = std::exchange(instance, next);
+    // The worker thread calls work() on implContext.instance under work_lock,
+    // so the switch waits for a running job. Jobs still queued are answered
+    // by the new instance, and none can reach the previous one once it is
+    // freed below.
+    zix_sem_wait(&implContext.work_lock);
+    implContext.instance = next;
+    zix_sem_post(&implContext.work_lock);
+    sample_rate = static_cast<int32_t>(configuration.sampleRate);
+    // process() activates the new instance on its next block.
+    const bool wasActive = processing_active_.exchange(false, std::memory_order_acq_rel);
+    instance_swap_lock_.clear(std::memory_order_release);
+
+    if (wasActive)
+        lilv_instance_deactivate(previous);
+    lilv_instance_free(previous);
+    freePortBuffers(setup.ports);
+    return StatusCode::OK;
+}
+
+remidy::PluginInstanceLV2::PortSetup remidy::PluginInstanceLV2::createPortSetup(LilvInstance* target, uint32_t bufferSizeInSamples) {
+    PortSetup setup{};
+
     // create port mappings between Remidy and LV2
     uint32_t numPorts = lilv_plugin_get_num_ports(plugin);
     int32_t portToScan = 0;
     auto audioIns = audio_buses->audioInputBuses();
-    audio_in_port_mapping.clear();
-    audio_in_fallback_buffers.clear();
     int32_t lv2AudioInIdx = 0;
     for (size_t i = 0, n = audioIns.size(); i < n; i++) {
         auto bus = audioIns[i];
@@ -101,13 +159,11 @@ remidy::StatusCode remidy::PluginInstanceLV2::configure(ConfigurationRequest& co
                 formatImpl->getLogger()->logWarning("LV2 plugin %s has fewer input ports than expected", info()->displayName().c_str());
                 continue;
             }
-            audio_in_port_mapping.emplace_back(RemidyToLV2PortMapping{.bus = i, .channel = ch, .lv2Port = lv2AudioInIdx});
+            setup.audio_in_port_mapping.emplace_back(RemidyToLV2PortMapping{.bus = i, .channel = ch, .lv2Port = lv2AudioInIdx});
         }
     }
     portToScan = 0;
     const auto audioOuts = audio_buses->audioOutputBuses();
-    audio_out_port_mapping.clear();
-    audio_out_fallback_buffers.clear();
     int32_t lv2AudioOutIdx = 0;
     for (size_t i = 0, n = audioOuts.size(); i < n; i++) {
         const auto bus = audioOuts[i];
@@ -116,7 +172,7 @@ remidy::StatusCode remidy::PluginInstanceLV2::configure(ConfigurationRequest& co
                 formatImpl->getLogger()->logWarning("LV2 plugin %s has fewer output ports than expected", info()->displayName().c_str());
                 continue;
             }
-            audio_out_port_mapping.emplace_back(RemidyToLV2PortMapping{.bus = i, .channel = ch, .lv2Port = lv2AudioOutIdx});
+            setup.audio_out_port_mapping.emplace_back(RemidyToLV2PortMapping{.bus = i, .channel = ch, .lv2Port = lv2AudioOutIdx});
         }
     }
 
@@ -131,7 +187,7 @@ remidy::StatusCode remidy::PluginInstanceLV2::configure(ConfigurationRequest& co
             auto designationNode = lilv_port_get(plugin, port, implContext.statics->designation_uri_node);
             if (designationNode && implContext.statics->control_designation_uri_node &&
                 lilv_node_equals(designationNode, implContext.statics->control_designation_uri_node))
-                control_atom_port_index = i;
+                setup.control_atom_port_index = i;
         }
 
         if (!implContext.IS_AUDIO_PORT(plugin, port)) {
@@ -143,7 +199,7 @@ remidy::StatusCode remidy::PluginInstanceLV2::configure(ConfigurationRequest& co
             lv2Port.buffer_size = minSize ? static_cast<size_t>(minSize) : defaultSize;
             auto buffer = calloc(lv2Port.buffer_size, 1);
             lv2Port.port_buffer = buffer;
-            lilv_instance_connect_port(instance, i, buffer);
+            lilv_instance_connect_port(target, i, buffer);
 
             if (implContext.IS_ATOM_PORT(plugin, port)) {
                 lv2_atom_forge_init(&lv2Port.forge, getLV2UridMapData());
@@ -156,22 +212,36 @@ remidy::StatusCode remidy::PluginInstanceLV2::configure(ConfigurationRequest& co
             }
         }
         else
-            lv2Port.buffer_size = configuration.bufferSizeInSamples * sizeof(float);
+            lv2Port.buffer_size = bufferSizeInSamples * sizeof(float);
 
-        lv2_ports.emplace_back(lv2Port);
+        setup.ports.emplace_back(lv2Port);
     }
 
-    updateLatencyFromPort(false);
-
     auto ensureFallbackSize = [&](std::vector<std::vector<float>>& buffers, size_t count) {
         buffers.resize(count);
         for (auto& buf : buffers)
-            buf.assign(configuration.bufferSizeInSamples, 0.0f);
+            buf.assign(bufferSizeInSamples, 0.0f);
     };
-    ensureFallbackSize(audio_in_fallback_buffers, audio_in_port_mapping.size());
-    ensureFallbackSize(audio_out_fallback_buffers, audio_out_port_mapping.size());
+    ensureFallbackSize(setup.audio_in_fallback_buffers, setup.audio_in_port_mapping.size());
+    ensureFallbackSize(setup.audio_out_fallback_buffers, setup.audio_out_port_mapping.size());
 
-    return StatusCode::OK;
+    return setup;
+}
+
+void remidy::PluginInstanceLV2::swapPortSetup(PortSetup& setup) noexcept {
+    lv2_ports.swap(setup.ports);
+    std::swap(control_atom_port_index, setup.control_atom_port_index);
+    audio_in_port_mapping.swap(setup.audio_in_port_mapping);
+    audio_out_port_mapping.swap(setup.audio_out_port_mapping);
+    audio_in_fallback_buffers.swap(setup.audio_in_fallback_buffers);
+    audio_out_fallback_buffers.swap(setup.audio_out_fallback_buffers);
+}
+
+void remidy::PluginInstanceLV2::freePortBuffers(std::vector<LV2PortInfo>& ports) {
+    for (auto& p : ports)
+        if (p.port_buffer)
+            free(p.port_buffer);
+    ports.clear();
 }
 
 void remidy::PluginInstanceLV2::updateLatencyFromPort(bool notifyChange) {
@@ -213,6 +283,15 @@ remidy::StatusCode remidy::PluginInstanceLV2::stopProcessing() {
 }
 
 remidy::StatusCode remidy::PluginInstanceLV2::process(AudioProcessContext &process) {
+    // A reconfiguration is switching instances right now; skip this block
+    // rather than wait for it.
+    if (instance_swap_lock_.test_and_set(std::memory_order_acquire))
+        return StatusCode::OK;
+    struct SwapLockRelease {
+        std::atomic_flag& lock;
+        ~SwapLockRelease() { lock.clear(std::memory_order_release); }
+    } swapLockRelease{instance_swap_lock_};
+
     if (!instance)
         return StatusCode::ALREADY_INVALID_STATE;
 
@@ -236,7 +315,8 @@ remidy::StatusCode remidy::PluginInstanceLV2::process(AudioProcessContext &proce
         return StatusCode::OK;
     }
 
-    // FIXME: is there 64-bit float audio support?
+    // Buses hold floats here; see configure(). A 64-bit host converts them
+    // around process().
 
     for (size_t i = 0; i < audio_in_port_mapping.size(); ++i) {
         auto& m = audio_in_port_mapping[i];
@@ -520,6 +520,8 @@ namespace remidy {
         PluginUISupport* ui() override;
 
         bool requiresReplacingProcess() const override { return false; }
+        // IAudioProcessor::process() is only required not to overlap.
+        bool supportsProcessingOffAudioThread() const override { return true; }
 
     private:
         void handleRestartComponent(int32 flags);
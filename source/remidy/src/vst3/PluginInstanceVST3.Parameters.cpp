@@ -1,6 +1,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <optional>
 
@@ -171,7 +172,8 @@ remidy::StatusCode remidy::PluginInstanceVST3::ParameterSupport::setParameter(ui
 
 remidy::StatusCode remidy::PluginInstanceVST3::ParameterSupport::enqueueParameterRT(uint32_t index, double value, uint64_t timestamp) {
     // use IParameterChanges.
-    int32_t sampleOffset = 0; // FIXME: calculate from timestamp
+    // `timestamp` is the sample offset in the block, as UMP input dispatchers pass it.
+    const auto sampleOffset = static_cast<int32_t>(std::min<uint64_t>(timestamp, std::numeric_limits<int32_t>::max()));
     auto pvc = owner->processDataInputParameterChanges.asInterface();
     if (index >= parameter_ids.size())
         return StatusCode::INVALID_PARAMETER_OPERATION;
@@ -183,14 +185,17 @@ remidy::StatusCode remidy::PluginInstanceVST3::ParameterSupport::enqueueParamete
     int32_t i = 0;
     IParamValueQueue* q{nullptr};
     for (int32_t n = pvc->getParameterCount(); i < n; i++) {
-        q = pvc->getParameterData(i);
-        if (q->getParameterId() == id)
+        auto candidate = pvc->getParameterData(i);
+        if (candidate && candidate->getParameterId() == id) {
+            q = candidate;
             break;
+        }
     }
     if (!q)
         // It is an RT-safe operation, right?
         q = pvc->addParameterData(id, i);
-    if (q && q->addPoint(sampleOffset, normalized, i) == kResultOk) {
+    int32_t pointIndex = 0;
+    if (q && q->addPoint(sampleOffset, normalized, pointIndex) == kResultOk) {
         // Notify parameter change event listeners (e.g., UMP output mapper)
         parameterChangeEvent().notify(index, value);
         return StatusCode::OK;
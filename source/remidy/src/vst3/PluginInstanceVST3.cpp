@@ -249,6 +249,14 @@ remidy::PluginInstanceVST3::~PluginInstanceVST3() {
 }
 
 remidy::StatusCode remidy::PluginInstanceVST3::configure(ConfigurationRequest &configuration) {
+    // A plugin without 64-bit processing runs in 32-bit; the request tells
+    // the host which one it got.
+    if (configuration.dataType == AudioContentType::Float64 &&
+        processor->canProcessSampleSize(kSample64) != kResultOk) {
+        owner->getLogger()->logInfo("%s: 64-bit processing is not supported, using 32-bit", pluginName.c_str());
+        configuration.dataType = AudioContentType::Float32;
+    }
+
     // setupProcessing.
     ProcessSetup setup{};
     setup.sampleRate = configuration.sampleRate;
@@ -256,6 +264,11 @@ remidy::StatusCode remidy::PluginInstanceVST3::configure(ConfigurationRequest &c
     setup.symbolicSampleSize = configuration.dataType == AudioContentType::Float64 ? kSample64 : kSample32;
     setup.processMode = configuration.offlineMode ? kOffline : kRealtime;
 
+    // A repeated configure() (e.g. for a new sample rate) replaces the
+    // buffer lists of the previous one.
+    if (has_process_setup)
+        audio_buses->deallocateBuffers();
+
     // setup audio buses
     audio_buses->configure(configuration);
 
@@ -396,7 +409,13 @@ remidy::StatusCode remidy::PluginInstanceVST3::process(AudioProcessContext &proc
     for (int32_t bus = 0; bus < numInputBus; bus++) {
         auto available = bus < hostInputBusCount ? process.inputChannelCount(bus) : 0;
         auto pluginChannels = processData.inputs[bus].numChannels;
+        // Channels fed from a silent host channel, or from the zeroed fallback, are silent.
+        const auto hostSilenceFlags = bus < hostInputBusCount ? process.inputSilenceFlags(bus) : 0;
+        processData.inputs[bus].silenceFlags = 0;
         for (int32_t ch = 0; ch < pluginChannels; ch++) {
+            const int32_t hostChannel = ch < static_cast<int32_t>(available) ? ch : 0;
+            if (ch < 64 && (available == 0 || (hostChannel < 64 && (hostSilenceFlags & (uint64_t{1} << hostChannel)))))
+                processData.inputs[bus].silenceFlags |= uint64_t{1} << ch;
             if (processData.symbolicSampleSize == kSample32) {
                 float* ptr = nullptr;
                 if (bus < hostInputBusCount && ch < static_cast<int32_t>(available))
@@ -422,6 +441,8 @@ remidy::StatusCode remidy::PluginInstanceVST3::process(AudioProcessContext &proc
     for (int32_t bus = 0; bus < numOutputBus; bus++) {
         auto available = bus < hostOutputBusCount ? process.outputChannelCount(bus) : 0;
         auto pluginChannels = processData.outputs[bus].numChannels;
+        // Set by the plugin for the channels it leaves silent.
+        processData.outputs[bus].silenceFlags = 0;
         for (int32_t ch = 0; ch < pluginChannels; ch++) {
             if (processData.symbolicSampleSize == kSample32) {
                 float* ptr = nullptr;
@@ -490,6 +511,12 @@ remidy::StatusCode remidy::PluginInstanceVST3::process(AudioProcessContext &proc
     // post-processing
     ctx->continousTimeSamples += numFrames;
 
+    for (int32_t bus = 0; bus < numOutputBus && bus < hostOutputBusCount; bus++) {
+        const auto channels = std::min(processData.outputs[bus].numChannels, process.outputChannelCount(bus));
+        const auto mask = channels >= 64 ? ~uint64_t{0} : (uint64_t{1} << channels) - 1;
+        process.outputSilenceFlags(bus, processData.outputs[bus].silenceFlags & mask);
+    }
+
     // Convert VST3 output events to UMP
     auto& eventOut = process.eventOut();
     auto* umpBuffer = static_cast<uint32_t*>(eventOut.getMessages());
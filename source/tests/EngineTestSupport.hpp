@@ -0,0 +1,825 @@
+#pragma once
+
+// Deterministic stand-ins for the platform pieces the engine depends on: a
+// manually pumped event loop, a synthetic audio source and an in-process plug-in
+// host. Shared by the engine tests and uapmd-bench.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numbers>
+#include <optional>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "uapmd-engine/uapmd-engine.hpp"
+
+namespace uapmd_test {
+
+// Per-block behaviour of MutableTimingPlugin beyond passing audio through, so
+// benchmarks can model plug-ins of a given weight.
+struct SyntheticProcessingProfile {
+    // Busy-waited on the processing thread after the audio is copied.
+    std::chrono::nanoseconds costPerBlock{0};
+    uint32_t latencyInSamples{0};
+    // MIDI 2.0 note messages written to the event output per block.
+    uint32_t eventsPerBlock{0};
+};
+
+class TestEventLoop final : public remidy::EventLoop {
+protected:
+    void initializeOnUIThreadImpl() override {}
+
+    bool runningOnMainThreadImpl() override {
+        return std::this_thread::get_id() == main_thread_id_;
+    }
+
+    void enqueueTaskOnMainThreadImpl(std::function<void()>&& task) override {
+        std::lock_guard lock(mutex_);
+        tasks_.push(std::move(task));
+    }
+
+    void startImpl() override {}
+    void stopImpl() override {}
+
+    void processQueuedTasksImpl() override {
+        std::queue<std::function<void()>> tasks;
+        {
+            std::lock_guard lock(mutex_);
+            std::swap(tasks, tasks_);
+        }
+        while (!tasks.empty()) {
+            auto task = std::move(tasks.front());
+            tasks.pop();
+            task();
+        }
+    }
+
+private:
+    std::thread::id main_thread_id_{std::this_thread::get_id()};
+    std::mutex mutex_;
+    std::queue<std::function<void()>> tasks_;
+};
+
+class ScopedTestEventLoop final {
+public:
+    ScopedTestEventLoop() {
+        remidy::EventLoop::initializeOnUIThread();
+        previous_ = remidy::getEventLoop();
+        remidy::setEventLoop(&event_loop_);
+    }
+
+    ~ScopedTestEventLoop() {
+        remidy::setEventLoop(previous_);
+    }
+
+private:
+    remidy::EventLoop* previous_;
+    TestEventLoop event_loop_;
+};
+
+class SineAudioFileReader final : public uapmd::AudioFileReader {
+public:
+    SineAudioFileReader(uint64_t numFrames, uint32_t numChannels, uint32_t sampleRate, double frequency, float amplitude)
+        : properties_{numFrames, numChannels, sampleRate}
+        , frequency_(frequency)
+        , amplitude_(amplitude) {
+    }
+
+    Properties getProperties() const override {
+        return properties_;
+    }
+
+    void readFrames(uint64_t startFrame,
+                    uint64_t framesToRead,
+                    float* const* dest,
+                    uint32_t numChannels) override {
+        const auto channels = std::min(numChannels, properties_.numChannels);
+        for (uint64_t frame = 0; frame < framesToRead; ++frame) {
+            const auto phase =
+                2.0 * std::numbers::pi * frequency_ *
+                static_cast<double>(startFrame + frame) / static_cast<double>(properties_.sampleRate);
+            const auto sample = amplitude_ * static_cast<float>(std::sin(phase));
+            for (uint32_t ch = 0; ch < channels; ++ch)
+                dest[ch][frame] = sample;
+        }
+        for (uint32_t ch = channels; ch < numChannels; ++ch)
+            std::fill_n(dest[ch], framesToRead, 0.0f);
+    }
+
+private:
+    Properties properties_{};
+    double frequency_{440.0};
+    float amplitude_{0.25f};
+};
+
+class TestAudioBuses final : public remidy::PluginAudioBuses {
+public:
+    TestAudioBuses()
+        : input_definition_("Input", remidy::AudioBusRole::Main, {remidy::AudioChannelLayout::stereo()})
+        , output_definition_("Output", remidy::AudioBusRole::Main, {remidy::AudioChannelLayout::stereo()})
+        , input_configuration_(input_definition_)
+        , output_configuration_(output_definition_) {
+        input_buses_.push_back(&input_configuration_);
+        output_buses_.push_back(&output_configuration_);
+    }
+
+    bool hasEventInputs() override { return false; }
+    bool hasEventOutputs() override { return false; }
+    const std::vector<remidy::AudioBusConfiguration*>& audioInputBuses() const override {
+        return input_buses_;
+    }
+    const std::vector<remidy::AudioBusConfiguration*>& audioOutputBuses() const override {
+        return output_buses_;
+    }
+
+private:
+    remidy::AudioBusDefinition input_definition_;
+    remidy::AudioBusDefinition output_definition_;
+    remidy::AudioBusConfiguration input_configuration_;
+    remidy::AudioBusConfiguration output_configuration_;
+    std::vector<remidy::AudioBusConfiguration*> input_buses_;
+    std::vector<remidy::AudioBusConfiguration*> output_buses_;
+};
+
+class TestPluginParameterSupport final : public remidy::PluginParameterSupport {
+public:
+    std::vector<remidy::PluginParameter*>& parameters() override { return parameters_; }
+
+    std::vector<remidy::PluginParameter*>& perNoteControllers(
+        remidy::PerNoteControllerContextTypes,
+        remidy::PerNoteControllerContext) override {
+        return parameters_;
+    }
+
+    remidy::StatusCode setParameter(uint32_t index, double value) override {
+        parameter_values_[static_cast<int32_t>(index)] = value;
+        return remidy::StatusCode::OK;
+    }
+
+    remidy::StatusCode enqueueParameterRT(uint32_t index, double value, uint64_t) override {
+        return setParameter(index, value);
+    }
+
+    remidy::StatusCode getParameter(uint32_t index, double* value) override {
+        if (!value)
+            return remidy::StatusCode::INVALID_PARAMETER_OPERATION;
+        *value = parameter_values_[static_cast<int32_t>(index)];
+        return remidy::StatusCode::OK;
+    }
+
+    remidy::StatusCode setPerNoteController(
+        remidy::PerNoteControllerContext context,
+        uint32_t index,
+        double value) override {
+        per_note_values_[{static_cast<uint8_t>(context.note), static_cast<uint8_t>(index)}] = value;
+        return remidy::StatusCode::OK;
+    }
+
+    remidy::StatusCode enqueuePerNoteControllerRT(
+        remidy::PerNoteControllerContext context,
+        uint32_t index,
+        double value,
+        uint64_t) override {
+        return setPerNoteController(context, index, value);
+    }
+
+    remidy::StatusCode getPerNoteController(
+        remidy::PerNoteControllerContext context,
+        uint32_t index,
+        double* value) override {
+        if (!value)
+            return remidy::StatusCode::INVALID_PARAMETER_OPERATION;
+        *value = per_note_values_[{
+            static_cast<uint8_t>(context.note), static_cast<uint8_t>(index)}];
+        return remidy::StatusCode::OK;
+    }
+
+    std::string valueToString(uint32_t, double value) override {
+        return std::to_string(value);
+    }
+
+    std::string valueToStringPerNote(
+        remidy::PerNoteControllerContext,
+        uint32_t,
+        double value) override {
+        return std::to_string(value);
+    }
+
+private:
+    std::vector<remidy::PluginParameter*> parameters_{};
+    std::map<int32_t, double> parameter_values_{};
+    std::map<std::pair<uint8_t, uint8_t>, double> per_note_values_{};
+};
+
+class MutableTimingPlugin final : public uapmd_plugin_hosting::AudioPluginInstanceAPI {
+public:
+    explicit MutableTimingPlugin(bool deferStateLoad = false)
+        : defer_state_load_(deferStateLoad) {
+    }
+
+    uint32_t latencyInSamples() const override {
+        return latency_in_samples_.load(std::memory_order_acquire);
+    }
+
+    void latencyInSamples(uint32_t value) {
+        latency_in_samples_.store(value, std::memory_order_release);
+    }
+
+    std::string& displayName() const override { return display_name_; }
+    std::string& formatName() const override { return format_name_; }
+    std::string& pluginId() const override { return plugin_id_; }
+    bool bypassed() const override { return bypassed_; }
+    void bypassed(bool value) override { bypassed_ = value; }
+    uapmd_status_t startProcessing() override { return 0; }
+    uapmd_status_t stopProcessing() override { return 0; }
+    uapmd_status_t processAudio(remidy::AudioProcessContext& process) override {
+        process.copyInputsToOutputs();
+        if (profile_.costPerBlock.count() > 0) {
+            const auto until = std::chrono::steady_clock::now() + profile_.costPerBlock;
+            while (std::chrono::steady_clock::now() < until) {
+            }
+        }
+        if (profile_.eventsPerBlock > 0)
+            writeSyntheticEvents(process.eventOut(), process.frameCount());
+        return 0;
+    }
+
+    void processingProfile(const SyntheticProcessingProfile& profile) {
+        profile_ = profile;
+        latencyInSamples(profile.latencyInSamples);
+    }
+    double tailLengthInSeconds() const override { return 0.0; }
+    bool requiresReplacingProcess() const override { return false; }
+    bool supportsProcessingOffAudioThread() const override { return processes_off_audio_thread_; }
+    void supportsProcessingOffAudioThread(bool value) { processes_off_audio_thread_ = value; }
+    bool sleepsWhenSilent() const override { return sleeps_when_silent_; }
+    void sleepsWhenSilent(bool value) override { sleeps_when_silent_ = value; }
+    std::vector<uapmd_plugin_hosting::ParameterMetadata> parameterMetadataList() override {
+        parameter_metadata_list_calls_.fetch_add(1, std::memory_order_acq_rel);
+        return {};
+    }
+    uint32_t parameterMetadataListCalls() const {
+        return parameter_metadata_list_calls_.load(std::memory_order_acquire);
+    }
+    void notifyParameterMetadataChanged() {
+        parameter_support_.parameterMetadataChangeEvent().notify();
+    }
+    std::vector<uapmd_plugin_hosting::ParameterMetadata> perNoteControllerMetadataList(
+        remidy::PerNoteControllerContextTypes,
+        uint32_t) override {
+        return {};
+    }
+    std::vector<uapmd_plugin_hosting::PresetsMetadata> presetMetadataList() override { return {}; }
+    void loadPreset(int32_t presetIndex) override {
+        state_ = {static_cast<uint8_t>(presetIndex)};
+        externallySetParameter(2, static_cast<double>(presetIndex) / 10.0);
+    }
+    void loadPreset(
+        int32_t presetIndex,
+        std::function<void(std::string, void*)> completed) override {
+        loadPreset(presetIndex);
+        if (completed)
+            completed({}, nullptr);
+    }
+    void setStateFromHost(std::vector<uint8_t> state) {
+        state_ = std::move(state);
+    }
+    std::vector<uint8_t> saveStateSync() override { return state_; }
+    void loadStateSync(std::vector<uint8_t>& state) override { state_ = state; }
+    void requestState(
+        uapmd_plugin_hosting::StateContextType,
+        bool,
+        void* callbackContext,
+        std::function<void(std::vector<uint8_t>, std::string, void*)> receiver) override {
+        receiver(state_, {}, callbackContext);
+    }
+    void loadState(
+        std::vector<uint8_t> state,
+        uapmd_plugin_hosting::StateContextType,
+        bool,
+        void* callbackContext,
+        std::function<void(std::string, void*)> completed) override {
+        if (defer_state_load_) {
+            pending_state_ = std::move(state);
+            pending_state_context_ = callbackContext;
+            pending_state_callback_ = std::move(completed);
+            return;
+        }
+        state_ = std::move(state);
+        if (emit_parameter_during_state_load_ && !state_.empty())
+            externallySetParameter(2, static_cast<double>(state_.front()) / 10.0);
+        completed({}, callbackContext);
+        if (notify_parameter_after_state_completion_)
+            scheduleStateCompletionParameterNotification(
+                parameter_notification_delay_turns_);
+    }
+
+    bool stateLoadPending() const { return static_cast<bool>(pending_state_callback_); }
+
+    void completeStateLoad(std::string error = {}) {
+        if (!pending_state_callback_)
+            return;
+        auto completed = std::move(pending_state_callback_);
+        auto* context = pending_state_context_;
+        pending_state_context_ = nullptr;
+        if (error.empty()) {
+            state_ = std::move(pending_state_);
+            if (emit_parameter_during_state_load_ && !state_.empty())
+                externallySetParameter(2, static_cast<double>(state_.front()) / 10.0);
+        } else
+            pending_state_.clear();
+        const bool succeeded = error.empty();
+        completed(std::move(error), context);
+        if (succeeded && notify_parameter_after_state_completion_)
+            scheduleStateCompletionParameterNotification(
+                parameter_notification_delay_turns_);
+    }
+
+    void notifyParameterAfterStateCompletion(bool value) {
+        notify_parameter_after_state_completion_ = value;
+    }
+    void parameterAfterStateCompletionValue(std::optional<double> value) {
+        parameter_after_state_completion_value_ = value;
+    }
+    void parameterNotificationDelayTurns(uint32_t value) {
+        parameter_notification_delay_turns_ = value;
+    }
+    void parameterNotificationFromWorker(bool value) {
+        parameter_notification_from_worker_ = value;
+    }
+    void emitParameterDuringStateLoad(bool value) {
+        emit_parameter_during_state_load_ = value;
+    }
+    double getParameterValue(int32_t index) override {
+        double value = 0.0;
+        parameter_support_.getParameter(static_cast<uint32_t>(index), &value);
+        return value;
+    }
+    void setParameterValue(int32_t index, double value) override {
+        parameter_support_.setParameter(static_cast<uint32_t>(index), value);
+    }
+    uapmd_status_t reconfigure(uint32_t sampleRate, uint32_t bufferSizeInFrames) override {
+        reconfigured_sample_rate_ = sampleRate;
+        reconfigured_buffer_size_ = bufferSizeInFrames;
+        return 0;
+    }
+    std::optional<uint32_t> reconfiguredSampleRate() const { return reconfigured_sample_rate_; }
+    std::optional<uint32_t> reconfiguredBufferSize() const { return reconfigured_buffer_size_; }
+    void enqueueParameterValueRT(int32_t index, double value, uapmd_timestamp_t timestamp) override {
+        rt_parameter_changes_.push_back({index, value, timestamp});
+    }
+    struct RtParameterChange {
+        int32_t index{-1};
+        double value{0.0};
+        uapmd_timestamp_t timestamp{0};
+    };
+    const std::vector<RtParameterChange>& rtParameterChanges() const { return rt_parameter_changes_; }
+    std::string getParameterValueString(int32_t, double) override { return {}; }
+    void setPerNoteControllerValue(uint8_t note, uint8_t index, double value) override {
+        parameter_support_.setPerNoteController(
+            {.note = note, .channel = 0, .group = 0, .extra = 0}, index, value);
+    }
+    bool getPerNoteControllerValue(uint8_t note, uint8_t index, double* value) override {
+        return parameter_support_.getPerNoteController(
+                   {.note = note, .channel = 0, .group = 0, .extra = 0}, index, value)
+            == remidy::StatusCode::OK;
+    }
+    void enqueuePerNoteControllerValueRT(uint8_t, uint8_t, double, uapmd_timestamp_t) override {}
+    std::string getPerNoteControllerValueString(uint8_t, uint8_t, double) override { return {}; }
+    bool hasUISupport() override { return false; }
+    bool createUI(bool, void*, std::function<bool(uint32_t, uint32_t)>) override { return false; }
+    void destroyUI() override {}
+    bool showUI() override { return false; }
+    void hideUI() override {}
+    bool isUIVisible() const override { return false; }
+    bool setUISize(uint32_t, uint32_t) override { return false; }
+    bool getUISize(uint32_t&, uint32_t&) override { return false; }
+    bool canUIResize() override { return false; }
+    remidy::PluginParameterSupport* parameterSupport() override { return &parameter_support_; }
+    remidy::PluginAudioBuses* audioBuses() override { return &audio_buses_; }
+    remidy::EventListenerId addTimingInfoChangeListener(
+        std::function<void(remidy::PluginTimingInfoChange)>) override {
+        return 0;
+    }
+    void removeTimingInfoChangeListener(remidy::EventListenerId) override {}
+
+    void externallySetParameter(int32_t index, double value) {
+        parameter_support_.setParameter(static_cast<uint32_t>(index), value);
+        parameter_support_.parameterChangeEvent().notify(
+            static_cast<uint32_t>(index), value);
+    }
+
+private:
+    void writeSyntheticEvents(remidy::EventSequence& events, int32_t frameCount) {
+        // Each event is a JR timestamp delta followed by a MIDI 2.0 note
+        // message; notes alternate between on and off across the block.
+        constexpr size_t kEventBytes = sizeof(uint32_t) * 3;
+        auto* words = static_cast<uint32_t*>(events.getMessages());
+        auto position = events.position();
+        const auto spacing = profile_.eventsPerBlock > 0
+            ? std::max(1, frameCount / static_cast<int32_t>(profile_.eventsPerBlock))
+            : 1;
+        for (uint32_t i = 0; i < profile_.eventsPerBlock; ++i) {
+            if (position + kEventBytes > events.maxMessagesInBytes())
+                break;
+            const auto note = static_cast<uint32_t>(60 + (synthetic_event_counter_ % 12));
+            const bool noteOn = (synthetic_event_counter_++ % 2) == 0;
+            auto* out = words + position / sizeof(uint32_t);
+            out[0] = 0x00200000u | static_cast<uint32_t>(i == 0 ? 0 : spacing);
+            out[1] = 0x40000000u | ((noteOn ? 0x9u : 0x8u) << 20) | (note << 8);
+            out[2] = noteOn ? 0xC0000000u : 0u;
+            position += kEventBytes;
+        }
+        events.position(position);
+    }
+
+    void scheduleStateCompletionParameterNotification(uint32_t remainingTurns) {
+        if (remainingTurns != 0) {
+            remidy::EventLoop::enqueueTaskOnMainThread(
+                [this, remainingTurns] {
+                    scheduleStateCompletionParameterNotification(
+                        remainingTurns - 1);
+                });
+            return;
+        }
+        const auto notify = [this] {
+            externallySetParameter(
+                2,
+                parameter_after_state_completion_value_.value_or(
+                    getParameterValue(2)));
+        };
+        if (!parameter_notification_from_worker_) {
+            notify();
+            return;
+        }
+        std::thread worker(notify);
+        worker.join();
+    }
+
+    mutable std::string display_name_{"Test Plugin"};
+    mutable std::string format_name_{"Test"};
+    mutable std::string plugin_id_{"test.plugin"};
+    bool bypassed_{false};
+    bool sleeps_when_silent_{false};
+    bool processes_off_audio_thread_{false};
+    std::atomic<uint32_t> latency_in_samples_{0};
+    std::atomic<uint32_t> parameter_metadata_list_calls_{0};
+    std::vector<uint8_t> state_{};
+    TestPluginParameterSupport parameter_support_{};
+    TestAudioBuses audio_buses_{};
+    bool defer_state_load_{false};
+    std::vector<uint8_t> pending_state_{};
+    void* pending_state_context_{nullptr};
+    std::function<void(std::string, void*)> pending_state_callback_{};
+    bool notify_parameter_after_state_completion_{false};
+    std::optional<double> parameter_after_state_completion_value_{};
+    uint32_t parameter_notification_delay_turns_{1};
+    bool parameter_notification_from_worker_{false};
+    bool emit_parameter_during_state_load_{true};
+    SyntheticProcessingProfile profile_{};
+    uint32_t synthetic_event_counter_{0};
+    std::vector<RtParameterChange> rt_parameter_changes_{};
+    std::optional<uint32_t> reconfigured_sample_rate_{};
+    std::optional<uint32_t> reconfigured_buffer_size_{};
+};
+
+class TestPluginHostingAPI final : public uapmd_plugin_hosting::AudioPluginHostingAPI {
+public:
+    explicit TestPluginHostingAPI(
+        bool deferCreation = false,
+        bool deferStateLoad = false)
+        : defer_creation_(deferCreation),
+          defer_state_load_(deferStateLoad) {
+    }
+
+    std::vector<remidy::PluginCatalogEntry> pluginCatalogEntries() override { return catalog_entries_; }
+    void savePluginCatalogToFile(std::filesystem::path) override {}
+    void performPluginScanning(bool) override {}
+    void reloadPluginCatalogFromCache() override {}
+
+    void createPluginInstance(
+        uint32_t,
+        uint32_t,
+        std::optional<uint32_t>,
+        std::optional<uint32_t>,
+        bool,
+        std::string&,
+        std::string&,
+        std::function<void(int32_t, std::string)>&& callback) override {
+        const auto instanceId = next_instance_id_++;
+        auto plugin = std::make_unique<MutableTimingPlugin>(defer_state_load_);
+        plugin->notifyParameterAfterStateCompletion(
+            notify_parameter_after_state_completion_);
+        plugin->parameterAfterStateCompletionValue(
+            parameter_after_state_completion_value_);
+        plugin->parameterNotificationDelayTurns(
+            parameter_notification_delay_turns_);
+        plugin->parameterNotificationFromWorker(
+            parameter_notification_from_worker_);
+        plugin->processingProfile(processing_profile_);
+        instances_[instanceId] = std::move(plugin);
+        if (defer_creation_) {
+            pending_creations_.push_back({instanceId, std::move(callback)});
+            return;
+        }
+        callback(instanceId, {});
+    }
+
+    void deletePluginInstance(int32_t instanceId) override {
+        instances_.erase(instanceId);
+    }
+
+    uapmd_plugin_hosting::AudioPluginInstanceAPI* getInstance(int32_t instanceId) override {
+        const auto it = instances_.find(instanceId);
+        return it == instances_.end() ? nullptr : it->second.get();
+    }
+
+    remidy::EventListenerId addPluginStateChangeListener(
+        std::function<void(int32_t)> listener) override {
+        plugin_state_change_listener_ = std::move(listener);
+        return 1;
+    }
+
+    void removePluginStateChangeListener(remidy::EventListenerId) override {
+        plugin_state_change_listener_ = {};
+    }
+
+    void notifyPluginStateChanged(int32_t instanceId) {
+        if (plugin_state_change_listener_)
+            plugin_state_change_listener_(instanceId);
+    }
+
+    std::vector<int32_t> instanceIds() override {
+        std::vector<int32_t> result;
+        result.reserve(instances_.size());
+        for (const auto& [instanceId, instance] : instances_)
+            if (instance)
+                result.push_back(instanceId);
+        return result;
+    }
+
+    bool creationPending() const { return !pending_creations_.empty(); }
+
+    void completeNextCreation(std::string error = {}) {
+        if (pending_creations_.empty())
+            return;
+        auto pending = std::move(pending_creations_.front());
+        pending_creations_.erase(pending_creations_.begin());
+        if (!error.empty()) {
+            instances_.erase(pending.instanceId);
+            pending.callback(-1, std::move(error));
+            return;
+        }
+        pending.callback(pending.instanceId, {});
+    }
+
+    MutableTimingPlugin* mutableInstance(int32_t instanceId) {
+        const auto it = instances_.find(instanceId);
+        return it == instances_.end()
+            ? nullptr
+            : dynamic_cast<MutableTimingPlugin*>(it->second.get());
+    }
+
+    void configureStateCompletionParameterNotification(
+        bool notify,
+        std::optional<double> value,
+        uint32_t delayTurns = 1,
+        bool fromWorker = false) {
+        notify_parameter_after_state_completion_ = notify;
+        parameter_after_state_completion_value_ = value;
+        parameter_notification_delay_turns_ = delayTurns;
+        parameter_notification_from_worker_ = fromWorker;
+        for (auto& [instanceId, instance] : instances_)
+            if (auto* plugin = dynamic_cast<MutableTimingPlugin*>(instance.get())) {
+                plugin->notifyParameterAfterStateCompletion(notify);
+                plugin->parameterAfterStateCompletionValue(value);
+                plugin->parameterNotificationDelayTurns(delayTurns);
+                plugin->parameterNotificationFromWorker(fromWorker);
+            }
+    }
+
+    // Project loading only restores plug-ins that are in the catalog.
+    void addCatalogEntry(std::string format, std::string pluginId, const std::string& displayName) {
+        remidy::PluginCatalogEntry entry{};
+        entry.format(format);
+        entry.pluginId(pluginId);
+        entry.displayName(displayName);
+        catalog_entries_.push_back(std::move(entry));
+    }
+
+    // Applies to existing instances and to instances created afterwards.
+    void processingProfile(const SyntheticProcessingProfile& profile) {
+        processing_profile_ = profile;
+        for (auto& [instanceId, instance] : instances_)
+            if (instance)
+                instance->processingProfile(profile);
+    }
+
+private:
+    struct PendingCreation {
+        int32_t instanceId{-1};
+        std::function<void(int32_t, std::string)> callback;
+    };
+
+    int32_t next_instance_id_{100};
+    std::map<int32_t, std::unique_ptr<MutableTimingPlugin>> instances_{};
+    bool defer_creation_{false};
+    bool defer_state_load_{false};
+    bool notify_parameter_after_state_completion_{false};
+    std::optional<double> parameter_after_state_completion_value_{};
+    uint32_t parameter_notification_delay_turns_{1};
+    bool parameter_notification_from_worker_{false};
+    SyntheticProcessingProfile processing_profile_{};
+    std::vector<remidy::PluginCatalogEntry> catalog_entries_{};
+    std::vector<PendingCreation> pending_creations_{};
+    std::function<void(int32_t)> plugin_state_change_listener_{};
+};
+
+// A remidy plug-in for driving the real plug-in host and its instance wrapper
+// rather than TestPluginHostingAPI. Counts lifecycle calls and records whether
+// configure(), startProcessing() or stopProcessing() ever ran while process()
+// did.
+class FakeRemidyPlugin final : public remidy::PluginInstance, public remidy::PluginStateSupport {
+public:
+    FakeRemidyPlugin(remidy::PluginCatalogEntry* entry, bool liveReconfiguration)
+        : remidy::PluginInstance(entry),
+          live_reconfiguration_(liveReconfiguration) {
+    }
+    ~FakeRemidyPlugin() override {
+        if (on_destroyed_)
+            on_destroyed_();
+    }
+
+    void onDestroyed(std::function<void()> callback) { on_destroyed_ = std::move(callback); }
+
+    remidy::PluginUIThreadRequirement requiresUIThreadOn() override { return remidy::PluginUIThreadRequirement::None; }
+
+    remidy::StatusCode configure(ConfigurationRequest& configuration) override {
+        enterControl();
+        // A live reconfiguration is prepared while process() keeps running;
+        // wait for a couple of blocks to show that it does.
+        if (live_reconfiguration_ && configure_count_ > 0) {
+            const auto blocks = processed_blocks_.load(std::memory_order_acquire);
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+            while (processed_blocks_.load(std::memory_order_acquire) < blocks + 2 &&
+                   std::chrono::steady_clock::now() < deadline)
+                std::this_thread::yield();
+            if (processed_blocks_.load(std::memory_order_acquire) >= blocks + 2)
+                processed_during_configure_.store(true, std::memory_order_release);
+        }
+        sample_rate_.store(configuration.sampleRate, std::memory_order_release);
+        buffer_size_.store(configuration.bufferSizeInSamples, std::memory_order_release);
+        configure_count_++;
+        leaveControl();
+        return remidy::StatusCode::OK;
+    }
+    bool supportsLiveReconfiguration() const override { return live_reconfiguration_; }
+
+    remidy::StatusCode startProcessing() override {
+        enterControl();
+        processing_.store(true, std::memory_order_release);
+        start_count_++;
+        leaveControl();
+        return remidy::StatusCode::OK;
+    }
+    remidy::StatusCode stopProcessing() override {
+        enterControl();
+        processing_.store(false, std::memory_order_release);
+        stop_count_++;
+        leaveControl();
+        return remidy::StatusCode::OK;
+    }
+
+    remidy::StatusCode process(remidy::AudioProcessContext& process) override {
+        in_process_.store(true, std::memory_order_seq_cst);
+        if (in_control_.load(std::memory_order_seq_cst) ||
+            (!live_reconfiguration_ && !processing_.load(std::memory_order_acquire)))
+            overlapped_.store(true, std::memory_order_release);
+        process.copyInputsToOutputs();
+        processed_blocks_.fetch_add(1, std::memory_order_acq_rel);
+        in_process_.store(false, std::memory_order_seq_cst);
+        return remidy::StatusCode::OK;
+    }
+
+    uint32_t latencyInSamples() const override { return 0; }
+    double tailLengthInSeconds() const override { return 0.0; }
+    remidy::PluginAudioBuses* audioBuses() override { return &buses_; }
+    remidy::PluginParameterSupport* parameters() override { return &parameters_; }
+    remidy::PluginStateSupport* states() override { return this; }
+    remidy::PluginPresetsSupport* presets() override { return nullptr; }
+    remidy::PluginUISupport* ui() override { return nullptr; }
+    bool requiresReplacingProcess() const override { return false; }
+
+    bool requiresMainThread() override { return false; }
+    std::vector<uint8_t> getState(StateContextType, bool) override { return state_; }
+    void setState(std::vector<uint8_t>& state, StateContextType, bool) override { state_ = state; }
+    void requestState(
+        StateContextType,
+        bool,
+        void* callbackContext,
+        std::function<void(std::vector<uint8_t>, std::string, void*)> receiver) override {
+        receiver(state_, {}, callbackContext);
+    }
+    void loadState(
+        std::vector<uint8_t> state,
+        StateContextType,
+        bool,
+        void* callbackContext,
+        std::function<void(std::string, void*)> completed) override {
+        state_ = std::move(state);
+        completed({}, callbackContext);
+    }
+
+    const std::vector<uint8_t>& state() const { return state_; }
+    bool processing() const { return processing_.load(std::memory_order_acquire); }
+    uint32_t sampleRate() const { return sample_rate_.load(std::memory_order_acquire); }
+    uint32_t bufferSize() const { return buffer_size_.load(std::memory_order_acquire); }
+    uint32_t configureCount() const { return configure_count_; }
+    uint32_t startCount() const { return start_count_; }
+    uint32_t stopCount() const { return stop_count_; }
+    uint64_t processedBlocks() const { return processed_blocks_.load(std::memory_order_acquire); }
+    bool controlOverlappedProcess() const { return overlapped_.load(std::memory_order_acquire); }
+    bool processedDuringConfigure() const { return processed_during_configure_.load(std::memory_order_acquire); }
+
+private:
+    void enterControl() {
+        in_control_.store(true, std::memory_order_seq_cst);
+        if (in_process_.load(std::memory_order_seq_cst) && !live_reconfiguration_)
+            overlapped_.store(true, std::memory_order_release);
+    }
+    void leaveControl() { in_control_.store(false, std::memory_order_seq_cst); }
+
+    bool live_reconfiguration_;
+    std::function<void()> on_destroyed_;
+    TestAudioBuses buses_{};
+    TestPluginParameterSupport parameters_{};
+    std::vector<uint8_t> state_{0};
+    std::atomic<bool> in_process_{false};
+    std::atomic<bool> in_control_{false};
+    std::atomic<bool> processing_{false};
+    std::atomic<bool> overlapped_{false};
+    std::atomic<bool> processed_during_configure_{false};
+    std::atomic<uint32_t> sample_rate_{0};
+    std::atomic<uint32_t> buffer_size_{0};
+    std::atomic<uint64_t> processed_blocks_{0};
+    uint32_t configure_count_{0};
+    uint32_t start_count_{0};
+    uint32_t stop_count_{0};
+};
+
+// Instantiates FakeRemidyPlugin for any of its catalog entries, synchronously.
+// Register it with AudioPluginHostingAPI::registerPluginFormat().
+class FakeRemidyPluginFormat final : public remidy::PluginFormat {
+public:
+    explicit FakeRemidyPluginFormat(bool liveReconfiguration = false)
+        : live_reconfiguration_(liveReconfiguration) {
+    }
+    ~FakeRemidyPluginFormat() override = default;
+
+    std::string name() override { return "Fake"; }
+    remidy::PluginUIThreadRequirement requiresUIThreadOn(remidy::PluginCatalogEntry*) override {
+        return remidy::PluginUIThreadRequirement::None;
+    }
+    bool canOmitUiState() override { return true; }
+    bool isStateStructured() override { return false; }
+    remidy::PluginScanning* scanning() override { return nullptr; }
+
+    void createInstance(remidy::PluginCatalogEntry* info,
+                        PluginInstantiationOptions,
+                        std::function<void(std::unique_ptr<remidy::PluginInstance>, std::string)> callback) override {
+        created_count_++;
+        auto plugin = std::make_unique<FakeRemidyPlugin>(info, live_reconfiguration_);
+        plugin->onDestroyed([this, raw = plugin.get()] { std::erase(live_, raw); });
+        live_.push_back(plugin.get());
+        callback(std::move(plugin), {});
+    }
+
+    remidy::PluginCatalogEntry catalogEntry(std::string pluginId) {
+        auto formatName = name();
+        remidy::PluginCatalogEntry entry{};
+        entry.format(formatName);
+        entry.pluginId(pluginId);
+        entry.displayName(pluginId);
+        return entry;
+    }
+
+    // Instances not destroyed yet, oldest first.
+    const std::vector<FakeRemidyPlugin*>& liveInstances() const { return live_; }
+    uint32_t createdCount() const { return created_count_; }
+
+private:
+    bool live_reconfiguration_;
+    std::vector<FakeRemidyPlugin*> live_{};
+    uint32_t created_count_{0};
+};
+
+
+} // namespace uapmd_test
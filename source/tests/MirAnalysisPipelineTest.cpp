@@ -0,0 +1,237 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <gtest/gtest.h>
+#include "../uapmd-mir/src/MirAnalysisPipeline.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    // Serves every audio source as two channels whose mono downmix is the frame
+    // index plus contentOffset, so analysers can tell where a window starts.
+    class SampleIndexView : public uapmd::ProjectDocumentView {
+    public:
+        mutable std::atomic<int> reads{0};
+        float contentOffset{0.0f};
+
+        uapmd::ProjectRevision currentRevision() const override { return {}; }
+        std::optional<uapmd::ProjectObjectId> masterTrackId() const override { return std::nullopt; }
+        std::vector<uapmd::ProjectObjectId> trackIds() const override { return {}; }
+        std::vector<uapmd::ProjectObjectId> clipIds(uapmd::ProjectObjectId) const override { return {}; }
+        std::vector<uapmd::ProjectObjectId> audioSourceIds() const override { return {}; }
+        std::optional<uapmd::ProjectTrackSnapshot> getTrack(uapmd::ProjectObjectId) const override { return std::nullopt; }
+        std::optional<uapmd::ProjectClipSnapshot> getClip(uapmd::ProjectObjectId) const override { return std::nullopt; }
+        std::optional<uapmd::ProjectAudioSourceSnapshot> getAudioSource(uapmd::ProjectObjectId) const override {
+            return std::nullopt;
+        }
+        bool readClipUmpContent(uapmd::ProjectObjectId, std::vector<uapmd_ump_t>&, std::vector<uint64_t>&,
+                                uint32_t&) const override {
+            return false;
+        }
+
+        bool readAudioSourceSamples(uapmd::ProjectObjectId, int64_t startFrame, int64_t frameCount,
+                                    float** destination, uint32_t destinationChannels) const override {
+            reads.fetch_add(1);
+            for (uint32_t channel = 0; channel < destinationChannels; ++channel)
+                for (int64_t frame = 0; frame < frameCount; ++frame)
+                    destination[channel][frame] = static_cast<float>(startFrame + frame) + contentOffset;
+            return true;
+        }
+    };
+
+    constexpr int kSampleRate = 100;
+
+    // Analysers that derive their output from the samples alone: one tempo
+    // point per second holding that second's position in the source, and one
+    // chord at the start of whatever they are given.
+    struct CountingKinds {
+        std::mutex mutex;
+        std::vector<size_t> windowFrames;
+        std::atomic<int> harmonyCalls{0};
+
+        uapmd_mir::MirAnalysisKinds kinds() {
+            uapmd_mir::MirAnalysisKinds result;
+            result.rhythm = [this](std::span<const float> samples, int sampleRate, uapmd_mir::MirFeatures& features) {
+                {
+                    std::lock_guard lock(mutex);
+                    windowFrames.push_back(samples.size());
+                }
+                for (size_t frame = 0; frame < samples.size(); frame += static_cast<size_t>(sampleRate)) {
+                    const auto time = static_cast<double>(frame) / sampleRate;
+                    features.tempo_points.emplace_back(time, std::floor(samples[frame] / sampleRate));
+                }
+                features.bpm = features.tempo_points.front().second;
+            };
+            result.harmony = [this](std::span<const float>, int, uapmd_mir::MirFeatures& features) {
+                harmonyCalls.fetch_add(1);
+                features.chords.emplace_back(0.0, "Am");
+            };
+            return result;
+        }
+    };
+
+    uapmd::ProjectAudioSourceSnapshot makeSource(double seconds, std::string filepath = {}) {
+        uapmd::ProjectAudioSourceSnapshot source;
+        source.filepath = std::move(filepath);
+        source.channelCount = 2;
+        source.sampleRate = kSampleRate;
+        source.frameCount = static_cast<int64_t>(seconds * kSampleRate);
+        return source;
+    }
+
+}
+
+class MirAnalysisPipelineTest : public ::testing::Test {
+protected:
+    fs::path test_dir;
+    SampleIndexView view;
+    std::atomic<bool> stop_requested{false};
+    std::atomic<int> processed{0};
+
+    void SetUp() override {
+        test_dir = fs::temp_directory_path() / "uapmd_mir_pipeline_test";
+        fs::remove_all(test_dir);
+        fs::create_directories(test_dir);
+    }
+
+    void TearDown() override {
+        fs::remove_all(test_dir);
+    }
+
+    fs::path cacheDirectory() const { return test_dir / "cache"; }
+
+    std::optional<uapmd_mir::MirFeatures> analyze(const uapmd::ProjectAudioSourceSnapshot& source,
+                                                  CountingKinds& kinds,
+                                                  const uapmd_mir::MirAnalysisWindowing& windowing = {}) {
+        const uapmd_mir::MirAnalysisCache cache{"test", 1, cacheDirectory()};
+        return uapmd_mir::analyzeSources(view, {source}, cache, kinds.kinds(), stop_requested, processed,
+                                         windowing).front();
+    }
+
+    fs::path writeSourceFile(const std::string& contents) {
+        const auto path = test_dir / "take.raw";
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+        return path;
+    }
+};
+
+TEST_F(MirAnalysisPipelineTest, SourceShorterThanOneWindowIsAnalysedWhole) {
+    CountingKinds kinds;
+    const auto features = analyze(makeSource(30.0), kinds);
+
+    ASSERT_TRUE(features.has_value());
+    ASSERT_EQ(kinds.windowFrames.size(), 1u);
+    EXPECT_EQ(kinds.windowFrames.front(), 30u * kSampleRate);
+    EXPECT_EQ(features->tempo_points.size(), 30u);
+    EXPECT_EQ(features->chords.size(), 1u);
+    EXPECT_EQ(processed.load(), 1);
+}
+
+TEST_F(MirAnalysisPipelineTest, LongSourceIsStreamedInOverlappingWindowsAndMergedAtTheSeams) {
+    CountingKinds kinds;
+    const uapmd_mir::MirAnalysisWindowing windowing{20.0, 4.0};
+    const auto features = analyze(makeSource(97.0), kinds, windowing);
+
+    ASSERT_TRUE(features.has_value());
+    // Hops of 16s; the last 1.7s would be too short alone and joins the sixth window.
+    ASSERT_EQ(kinds.windowFrames.size(), 6u);
+    for (size_t index = 0; index + 1 < kinds.windowFrames.size(); ++index)
+        EXPECT_EQ(kinds.windowFrames[index], 20u * kSampleRate);
+    EXPECT_EQ(kinds.windowFrames.back(), 17u * kSampleRate);
+
+    // Every second of the source is reported once, at its own time, whichever
+    // window it came from.
+    ASSERT_EQ(features->tempo_points.size(), 97u);
+    for (size_t second = 0; second < features->tempo_points.size(); ++second) {
+        EXPECT_DOUBLE_EQ(features->tempo_points[second].first, static_cast<double>(second));
+        EXPECT_DOUBLE_EQ(features->tempo_points[second].second, static_cast<double>(second));
+    }
+    EXPECT_DOUBLE_EQ(features->bpm, 0.0);
+    // The chord each window opens with continues the previous one.
+    ASSERT_EQ(features->chords.size(), 1u);
+    EXPECT_DOUBLE_EQ(features->chords.front().first, 0.0);
+}
+
+TEST_F(MirAnalysisPipelineTest, MergeOpensTheOwnedRangeWithTheValueInEffect) {
+    uapmd_mir::MirFeatures merged;
+    merged.chords = {{0.0, "C"}};
+    uapmd_mir::MirFeatures window;
+    window.chords = {{1.0, "F"}, {5.0, "G"}, {12.0, "C"}};
+
+    uapmd_mir::mergeWindowFeatures(merged, window, 100.0, 103.0, 110.0, false);
+
+    ASSERT_EQ(merged.chords.size(), 3u);
+    EXPECT_EQ(merged.chords[1], std::make_pair(103.0, std::string("F")));
+    EXPECT_EQ(merged.chords[2], std::make_pair(105.0, std::string("G")));
+}
+
+TEST_F(MirAnalysisPipelineTest, UnchangedSourceFileIsAnsweredFromTheCacheWithoutReadingIt) {
+    const auto source = makeSource(30.0, writeSourceFile("take").string());
+    CountingKinds first;
+    const auto analysed = analyze(source, first);
+    ASSERT_TRUE(analysed.has_value());
+    EXPECT_GT(view.reads.load(), 0);
+
+    view.reads = 0;
+    CountingKinds second;
+    const auto cached = analyze(source, second);
+
+    ASSERT_TRUE(cached.has_value());
+    EXPECT_EQ(view.reads.load(), 0);
+    EXPECT_TRUE(second.windowFrames.empty());
+    EXPECT_EQ(second.harmonyCalls.load(), 0);
+    EXPECT_EQ(cached->tempo_points, analysed->tempo_points);
+    EXPECT_EQ(cached->chords, analysed->chords);
+}
+
+TEST_F(MirAnalysisPipelineTest, RewrittenSourceFileIsHashedAgainAndAnalysedOnlyIfItsAudioChanged) {
+    auto source = makeSource(30.0, writeSourceFile("take").string());
+    CountingKinds first;
+    ASSERT_TRUE(analyze(source, first).has_value());
+
+    // Same audio under a new size: read to hash it, but not analysed again.
+    writeSourceFile("take two");
+    view.reads = 0;
+    CountingKinds sameAudio;
+    ASSERT_TRUE(analyze(source, sameAudio).has_value());
+    EXPECT_GT(view.reads.load(), 0);
+    EXPECT_TRUE(sameAudio.windowFrames.empty());
+
+    // Different audio under a new modification time: analysed again.
+    view.contentOffset = 0.5f;
+    fs::last_write_time(source.filepath, fs::last_write_time(source.filepath) + std::chrono::hours(1));
+    CountingKinds changedAudio;
+    ASSERT_TRUE(analyze(source, changedAudio).has_value());
+    EXPECT_EQ(changedAudio.windowFrames.size(), 1u);
+}
+
+TEST_F(MirAnalysisPipelineTest, CacheEvictsLeastRecentlyUsedEntriesBeyondItsSizeLimit) {
+    uapmd_mir::MirFeatures features;
+    features.tempo_points = {{0.0, 120.0}};
+    const auto entry = [this](uint64_t hash) {
+        for (const auto& file : fs::directory_iterator(cacheDirectory()))
+            if (file.path().filename().string().find(std::format("{:016x}", hash)) != std::string::npos)
+                return file.path();
+        return fs::path{};
+    };
+
+    const uapmd_mir::MirAnalysisCache unlimited{"test", 1, cacheDirectory()};
+    unlimited.store(1, kSampleRate, features);
+    unlimited.store(2, kSampleRate, features);
+    const auto now = fs::file_time_type::clock::now();
+    fs::last_write_time(entry(1), now - std::chrono::hours(2));
+    fs::last_write_time(entry(2), now - std::chrono::hours(1));
+
+    const uapmd_mir::MirAnalysisCache cache{"test", 1, cacheDirectory(), 2 * fs::file_size(entry(1))};
+    ASSERT_TRUE(cache.load(1, kSampleRate).has_value());
+    cache.store(3, kSampleRate, features);
+
+    EXPECT_TRUE(cache.load(1, kSampleRate).has_value());
+    EXPECT_FALSE(cache.load(2, kSampleRate).has_value());
+    EXPECT_TRUE(cache.load(3, kSampleRate).has_value());
+}
@@ -3,8 +3,11 @@
 #include <chrono>
 #include <cmath>
 #include <filesystem>
+#include <format>
 #include <fstream>
 #include <future>
+#include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -14,701 +17,683 @@
 #include <vector>
 
 #include <gtest/gtest.h>
+#include <choc/audio/choc_AudioFileFormat_FLAC.h>
 #include <choc/audio/choc_AudioFileFormat_WAV.h>
 
 #include "uapmd-engine/uapmd-engine.hpp"
 #include "uapmd-graph/uapmd-graph.hpp"
+#include "uapmd-midi-service/uapmd-midi-service.hpp"
+#include "EngineTestSupport.hpp"
+#include "../uapmd-engine/src/sequencer/FrozenTrackAudioCache.hpp"
+#include "../remidy/src/clap/InputEventOrder.hpp"
+#include "../uapmd-midi-service/src/midi/MidiServiceWorker.hpp"
 
 using namespace uapmd_graph;
+using namespace uapmd_test;
 
 namespace fs = std::filesystem;
 
 namespace {
 
-class TestEventLoop final : public remidy::EventLoop {
-protected:
-    void initializeOnUIThreadImpl() override {}
+struct RenderedAudio {
+    choc::audio::AudioFileProperties properties{};
+    std::vector<std::vector<float>> channels{};
+};
 
-    bool runningOnMainThreadImpl() override {
-        return std::this_thread::get_id() == main_thread_id_;
-    }
+RenderedAudio readRenderedAudioFile(const fs::path& outputPath) {
+    auto stream = std::make_shared<std::ifstream>(outputPath, std::ios::binary);
+    EXPECT_TRUE(*stream);
+    if (!*stream)
+        return {};
+    auto reader = outputPath.extension() == ".flac"
+        ? choc::audio::FLACAudioFileFormat<false>().createReader(stream)
+        : choc::audio::WAVAudioFileFormat<false>().createReader(stream);
+    EXPECT_NE(reader, nullptr);
+    if (!reader)
+        return {};
 
-    void enqueueTaskOnMainThreadImpl(std::function<void()>&& task) override {
-        std::lock_guard lock(mutex_);
-        tasks_.push(std::move(task));
-    }
+    RenderedAudio rendered{};
+    rendered.properties = reader->getProperties();
+    rendered.channels.assign(
+        rendered.properties.numChannels,
+        std::vector<float>(rendered.properties.numFrames, 0.0f));
 
-    void startImpl() override {}
-    void stopImpl() override {}
+    std::vector<float*> channelPointers;
+    channelPointers.reserve(rendered.channels.size());
+    for (auto& channel : rendered.channels)
+        channelPointers.push_back(channel.data());
 
-    void processQueuedTasksImpl() override {
-        std::queue<std::function<void()>> tasks;
-        {
-            std::lock_guard lock(mutex_);
-            std::swap(tasks, tasks_);
-        }
-        while (!tasks.empty()) {
-            auto task = std::move(tasks.front());
-            tasks.pop();
-            task();
-        }
-    }
+    const bool readSuccess = reader->readFrames(
+        0,
+        choc::buffer::createChannelArrayView(
+            channelPointers.data(),
+            rendered.properties.numChannels,
+            rendered.properties.numFrames));
+    EXPECT_TRUE(readSuccess);
+    return rendered;
+}
 
-private:
-    std::thread::id main_thread_id_{std::this_thread::get_id()};
-    std::mutex mutex_;
-    std::queue<std::function<void()>> tasks_;
-};
+float peakInFrameRange(const RenderedAudio& rendered, uint64_t startFrame, uint64_t endFrame) {
+    float peak = 0.0f;
+    const uint64_t clampedEnd = std::min<uint64_t>(endFrame, rendered.properties.numFrames);
+    for (const auto& channel : rendered.channels)
+        for (uint64_t frame = startFrame; frame < clampedEnd; ++frame)
+            peak = std::max(peak, std::fabs(channel[frame]));
+    return peak;
+}
 
-class ScopedTestEventLoop final {
+class RecordingMidiIO final : public uapmd_midi_service::MidiIOFeature {
 public:
-    ScopedTestEventLoop() {
-        remidy::EventLoop::initializeOnUIThread();
-        previous_ = remidy::getEventLoop();
-        remidy::setEventLoop(&event_loop_);
+    struct Sent {
+        std::vector<uint32_t> words{};
+        std::thread::id thread{};
+    };
+
+    void addInputHandler(uapmd::ump_receiver_t receiver, void* userData) override {
+        receiver_ = receiver;
+        receiver_context_ = userData;
+    }
+    void removeInputHandler(uapmd::ump_receiver_t) override {
+        receiver_ = nullptr;
+        receiver_context_ = nullptr;
+    }
+    void send(uapmd_ump_t* messages, size_t length, uapmd_timestamp_t) override {
+        std::lock_guard lock(mutex_);
+        sent_.push_back({{messages, messages + length / sizeof(uapmd_ump_t)}, std::this_thread::get_id()});
     }
 
-    ~ScopedTestEventLoop() {
-        remidy::setEventLoop(previous_);
+    void receive(std::vector<uint32_t> words) {
+        if (receiver_)
+            receiver_(receiver_context_, words.data(), words.size() * sizeof(uint32_t), 0);
+    }
+    std::vector<Sent> sent() {
+        std::lock_guard lock(mutex_);
+        return sent_;
     }
 
 private:
-    remidy::EventLoop* previous_;
-    TestEventLoop event_loop_;
-};
-
-struct RenderedAudio {
-    choc::audio::AudioFileProperties properties{};
-    std::vector<std::vector<float>> channels{};
+    uapmd::ump_receiver_t receiver_{};
+    void* receiver_context_{};
+    std::mutex mutex_{};
+    std::vector<Sent> sent_{};
 };
 
-class SineAudioFileReader final : public uapmd::AudioFileReader {
+class TestPluginNode final : public uapmd::AudioPluginNodeFeature {
 public:
-    SineAudioFileReader(uint64_t numFrames, uint32_t numChannels, uint32_t sampleRate, double frequency, float amplitude)
-        : properties_{numFrames, numChannels, sampleRate}
-        , frequency_(frequency)
-        , amplitude_(amplitude) {
-    }
-
-    Properties getProperties() const override {
-        return properties_;
-    }
+    explicit TestPluginNode(uapmd_plugin_hosting::AudioPluginInstanceAPI* instance) : instance_(instance) {}
 
-    void readFrames(uint64_t startFrame,
-                    uint64_t framesToRead,
-                    float* const* dest,
-                    uint32_t numChannels) override {
-        const auto channels = std::min(numChannels, properties_.numChannels);
-        for (uint64_t frame = 0; frame < framesToRead; ++frame) {
-            const auto phase =
-                2.0 * std::numbers::pi * frequency_ *
-                static_cast<double>(startFrame + frame) / static_cast<double>(properties_.sampleRate);
-            const auto sample = amplitude_ * static_cast<float>(std::sin(phase));
-            for (uint32_t ch = 0; ch < channels; ++ch)
-                dest[ch][frame] = sample;
-        }
-        for (uint32_t ch = channels; ch < numChannels; ++ch)
-            std::fill_n(dest[ch], framesToRead, 0.0f);
+    uapmd_plugin_hosting::AudioPluginInstanceAPI* instance() override { return instance_; }
+    bool scheduleEvents(uapmd_timestamp_t, void*, size_t size) override {
+        scheduled_bytes_ += size;
+        return true;
     }
+    size_t scheduledBytes() const { return scheduled_bytes_; }
 
 private:
-    Properties properties_{};
-    double frequency_{440.0};
-    float amplitude_{0.25f};
+    uapmd_plugin_hosting::AudioPluginInstanceAPI* instance_{};
+    size_t scheduled_bytes_{0};
 };
 
-class TestAudioBuses final : public remidy::PluginAudioBuses {
+// Holds the shared MIDI service worker in a task of its own until release(), so that the work posted
+// meanwhile piles up behind it.
+class MidiServiceWorkerHold {
+    std::promise<void> release_{};
+    bool released_{false};
+
 public:
-    TestAudioBuses()
-        : input_definition_("Input", remidy::AudioBusRole::Main, {remidy::AudioChannelLayout::stereo()})
-        , output_definition_("Output", remidy::AudioBusRole::Main, {remidy::AudioChannelLayout::stereo()})
-        , input_configuration_(input_definition_)
-        , output_configuration_(output_definition_) {
-        input_buses_.push_back(&input_configuration_);
-        output_buses_.push_back(&output_configuration_);
+    MidiServiceWorkerHold() {
+        auto released = release_.get_future().share();
+        std::promise<void> held{};
+        auto heldFuture = held.get_future();
+        uapmd_midi_service::MidiServiceWorker::instance().post(this, [released, &held] {
+            held.set_value();
+            released.wait();
+        });
+        heldFuture.wait();
     }
+    ~MidiServiceWorkerHold() { release(); }
 
-    bool hasEventInputs() override { return false; }
-    bool hasEventOutputs() override { return false; }
-    const std::vector<remidy::AudioBusConfiguration*>& audioInputBuses() const override {
-        return input_buses_;
+    void release() {
+        if (!std::exchange(released_, true))
+            release_.set_value();
     }
-    const std::vector<remidy::AudioBusConfiguration*>& audioOutputBuses() const override {
-        return output_buses_;
-    }
-
-private:
-    remidy::AudioBusDefinition input_definition_;
-    remidy::AudioBusDefinition output_definition_;
-    remidy::AudioBusConfiguration input_configuration_;
-    remidy::AudioBusConfiguration output_configuration_;
-    std::vector<remidy::AudioBusConfiguration*> input_buses_;
-    std::vector<remidy::AudioBusConfiguration*> output_buses_;
 };
 
-class TestPluginParameterSupport final : public remidy::PluginParameterSupport {
+// Returns once everything posted to the shared MIDI service worker so far has run.
+void drainMidiServiceWorker() {
+    std::promise<void> done{};
+    auto doneFuture = done.get_future();
+    uapmd_midi_service::MidiServiceWorker::instance().post(&done, [&done] { done.set_value(); });
+    doneFuture.wait();
+}
+
+#if UAPMD_RT_SAFETY_CHECKS
+// With UAPMD_ENABLE_RT_SAFETY_CHECKS every processAudio() walk in this binary is
+// observed, and any allocation or lock on the audio thread fails the run, naming
+// the tests that made them. Run with UAPMD_RT_SAFETY_ABORT=1 to get a stack
+// trace at the first offending call instead.
+class RealtimeSafetyListener final : public ::testing::EmptyTestEventListener {
 public:
-    std::vector<remidy::PluginParameter*>& parameters() override { return parameters_; }
+    std::vector<std::string> offenders;
 
-    std::vector<remidy::PluginParameter*>& perNoteControllers(
-        remidy::PerNoteControllerContextTypes,
-        remidy::PerNoteControllerContext) override {
-        return parameters_;
+    void OnTestStart(const ::testing::TestInfo&) override {
+        uapmd::RealtimeSafetyMonitor::resetCounters();
     }
 
-    remidy::StatusCode setParameter(uint32_t index, double value) override {
-        parameter_values_[static_cast<int32_t>(index)] = value;
-        return remidy::StatusCode::OK;
+    void OnTestEnd(const ::testing::TestInfo& test) override {
+        const auto counters = uapmd::RealtimeSafetyMonitor::counters();
+        if (counters.total() == 0)
+            return;
+        offenders.push_back(std::format(
+            "{}.{}: {} allocations, {} deallocations, {} mutex locks",
+            test.test_suite_name(), test.name(),
+            counters.allocations, counters.deallocations, counters.lockAcquisitions));
     }
+};
 
-    remidy::StatusCode enqueueParameterRT(uint32_t index, double value, uint64_t) override {
-        return setParameter(index, value);
-    }
+class RealtimeSafetyReportEnvironment final : public ::testing::Environment {
+    RealtimeSafetyListener* listener_{new RealtimeSafetyListener()};
 
-    remidy::StatusCode getParameter(uint32_t index, double* value) override {
-        if (!value)
-            return remidy::StatusCode::INVALID_PARAMETER_OPERATION;
-        *value = parameter_values_[static_cast<int32_t>(index)];
-        return remidy::StatusCode::OK;
+public:
+    RealtimeSafetyReportEnvironment() {
+        // The listener list owns it.
+        ::testing::UnitTest::GetInstance()->listeners().Append(listener_);
     }
 
-    remidy::StatusCode setPerNoteController(
-        remidy::PerNoteControllerContext context,
-        uint32_t index,
-        double value) override {
-        per_note_values_[{static_cast<uint8_t>(context.note), static_cast<uint8_t>(index)}] = value;
-        return remidy::StatusCode::OK;
+    void TearDown() override {
+        for (const auto& offender : listener_->offenders)
+            ADD_FAILURE() << "[rt-safety] audio thread " << offender;
     }
+};
 
-    remidy::StatusCode enqueuePerNoteControllerRT(
-        remidy::PerNoteControllerContext context,
-        uint32_t index,
-        double value,
-        uint64_t) override {
-        return setPerNoteController(context, index, value);
-    }
+const auto* const realtime_safety_report_environment =
+    ::testing::AddGlobalTestEnvironment(new RealtimeSafetyReportEnvironment());
+#endif
 
-    remidy::StatusCode getPerNoteController(
-        remidy::PerNoteControllerContext context,
-        uint32_t index,
-        double* value) override {
-        if (!value)
-            return remidy::StatusCode::INVALID_PARAMETER_OPERATION;
-        *value = per_note_values_[{
-            static_cast<uint8_t>(context.note), static_cast<uint8_t>(index)}];
-        return remidy::StatusCode::OK;
-    }
+class SequencerEngineOutputTest : public ::testing::Test {
+protected:
+    fs::path test_dir_;
 
-    std::string valueToString(uint32_t, double value) override {
-        return std::to_string(value);
+    void SetUp() override {
+        test_dir_ = fs::temp_directory_path() / "uapmd_engine_output_test";
+        fs::create_directories(test_dir_);
     }
 
-    std::string valueToStringPerNote(
-        remidy::PerNoteControllerContext,
-        uint32_t,
-        double value) override {
-        return std::to_string(value);
+    void TearDown() override {
+        if (fs::exists(test_dir_))
+            fs::remove_all(test_dir_);
     }
-
-private:
-    std::vector<remidy::PluginParameter*> parameters_{};
-    std::map<int32_t, double> parameter_values_{};
-    std::map<std::pair<uint8_t, uint8_t>, double> per_note_values_{};
 };
 
-class MutableTimingPlugin final : public uapmd_plugin_hosting::AudioPluginInstanceAPI {
-public:
-    explicit MutableTimingPlugin(bool deferStateLoad = false)
-        : defer_state_load_(deferStateLoad) {
-    }
+TEST_F(
+    SequencerEngineOutputTest,
+    FreezePolicyCanChangeDuringPlaybackWithoutStartingRender) {
+    constexpr int32_t sampleRate = 48000;
+    constexpr uint32_t bufferSize = 256;
+    constexpr uint32_t umpBufferSize = 65536;
 
-    uint32_t latencyInSamples() const override {
-        return latency_in_samples_.load(std::memory_order_acquire);
-    }
+    ScopedTestEventLoop eventLoop;
+    auto engine = uapmd::SequencerEngine::create(
+        sampleRate, bufferSize, umpBufferSize);
+    ASSERT_NE(engine, nullptr);
+    engine->setEngineActive(true);
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
 
-    void latencyInSamples(uint32_t value) {
-        latency_in_samples_.store(value, std::memory_order_release);
-    }
+    engine->startPlayback();
+    auto& manager = engine->frozenTrackManager();
+    EXPECT_TRUE(manager.setFreezePolicyForTrack(
+        trackIndex, uapmd::FrozenTrackManager::FreezePolicy::On));
+    EXPECT_EQ(
+        manager.freezePolicyForTrack(trackIndex),
+        uapmd::FrozenTrackManager::FreezePolicy::On);
+    EXPECT_EQ(
+        manager.runtimeStateForTrack(trackIndex),
+        uapmd::FrozenTrackManager::RuntimeState::Live);
 
-    std::string& displayName() const override { return display_name_; }
-    std::string& formatName() const override { return format_name_; }
-    std::string& pluginId() const override { return plugin_id_; }
-    bool bypassed() const override { return bypassed_; }
-    void bypassed(bool value) override { bypassed_ = value; }
-    uapmd_status_t startProcessing() override { return 0; }
-    uapmd_status_t stopProcessing() override { return 0; }
-    uapmd_status_t processAudio(remidy::AudioProcessContext& process) override {
-        process.copyInputsToOutputs();
-        return 0;
-    }
-    double tailLengthInSeconds() const override { return 0.0; }
-    bool requiresReplacingProcess() const override { return false; }
-    std::vector<uapmd_plugin_hosting::ParameterMetadata> parameterMetadataList() override { return {}; }
-    std::vector<uapmd_plugin_hosting::ParameterMetadata> perNoteControllerMetadataList(
-        remidy::PerNoteControllerContextTypes,
-        uint32_t) override {
-        return {};
-    }
-    std::vector<uapmd_plugin_hosting::PresetsMetadata> presetMetadataList() override { return {}; }
-    void loadPreset(int32_t presetIndex) override {
-        state_ = {static_cast<uint8_t>(presetIndex)};
-        externallySetParameter(2, static_cast<double>(presetIndex) / 10.0);
-    }
-    void loadPreset(
-        int32_t presetIndex,
-        std::function<void(std::string, void*)> completed) override {
-        loadPreset(presetIndex);
-        if (completed)
-            completed({}, nullptr);
-    }
-    void setStateFromHost(std::vector<uint8_t> state) {
-        state_ = std::move(state);
-    }
-    std::vector<uint8_t> saveStateSync() override { return state_; }
-    void loadStateSync(std::vector<uint8_t>& state) override { state_ = state; }
-    void requestState(
-        uapmd_plugin_hosting::StateContextType,
-        bool,
-        void* callbackContext,
-        std::function<void(std::vector<uint8_t>, std::string, void*)> receiver) override {
-        receiver(state_, {}, callbackContext);
-    }
-    void loadState(
-        std::vector<uint8_t> state,
-        uapmd_plugin_hosting::StateContextType,
-        bool,
-        void* callbackContext,
-        std::function<void(std::string, void*)> completed) override {
-        if (defer_state_load_) {
-            pending_state_ = std::move(state);
-            pending_state_context_ = callbackContext;
-            pending_state_callback_ = std::move(completed);
-            return;
-        }
-        state_ = std::move(state);
-        if (emit_parameter_during_state_load_ && !state_.empty())
-            externallySetParameter(2, static_cast<double>(state_.front()) / 10.0);
-        completed({}, callbackContext);
-        if (notify_parameter_after_state_completion_)
-            scheduleStateCompletionParameterNotification(
-                parameter_notification_delay_turns_);
-    }
+    EXPECT_TRUE(manager.setFreezePolicyForTrack(
+        trackIndex, uapmd::FrozenTrackManager::FreezePolicy::Off));
+    EXPECT_EQ(
+        manager.freezePolicyForTrack(trackIndex),
+        uapmd::FrozenTrackManager::FreezePolicy::Off);
+    EXPECT_EQ(
+        manager.runtimeStateForTrack(trackIndex),
+        uapmd::FrozenTrackManager::RuntimeState::Live);
 
-    bool stateLoadPending() const { return static_cast<bool>(pending_state_callback_); }
+    EXPECT_TRUE(manager.setFreezePolicyForTrack(
+        trackIndex, uapmd::FrozenTrackManager::FreezePolicy::On));
+    EXPECT_EQ(
+        manager.runtimeStateForTrack(trackIndex),
+        uapmd::FrozenTrackManager::RuntimeState::Live);
+    engine->stopPlayback();
 
-    void completeStateLoad(std::string error = {}) {
-        if (!pending_state_callback_)
-            return;
-        auto completed = std::move(pending_state_callback_);
-        auto* context = pending_state_context_;
-        pending_state_context_ = nullptr;
-        if (error.empty()) {
-            state_ = std::move(pending_state_);
-            if (emit_parameter_during_state_load_ && !state_.empty())
-                externallySetParameter(2, static_cast<double>(state_.front()) / 10.0);
-        } else
-            pending_state_.clear();
-        const bool succeeded = error.empty();
-        completed(std::move(error), context);
-        if (succeeded && notify_parameter_after_state_completion_)
-            scheduleStateCompletionParameterNotification(
-                parameter_notification_delay_turns_);
-    }
+    remidy::AudioProcessContext process(
+        engine->data().masterContext(), umpBufferSize);
+    process.configureMainBus(2, 2, bufferSize);
+    process.frameCount(bufferSize);
+    constexpr auto kSilenceBlocks = sampleRate / 4 / bufferSize + 1;
+    for (int block = 0; block < kSilenceBlocks; ++block)
+        engine->processAudio(process);
 
-    void notifyParameterAfterStateCompletion(bool value) {
-        notify_parameter_after_state_completion_ = value;
-    }
-    void parameterAfterStateCompletionValue(std::optional<double> value) {
-        parameter_after_state_completion_value_ = value;
-    }
-    void parameterNotificationDelayTurns(uint32_t value) {
-        parameter_notification_delay_turns_ = value;
-    }
-    void parameterNotificationFromWorker(bool value) {
-        parameter_notification_from_worker_ = value;
-    }
-    void emitParameterDuringStateLoad(bool value) {
-        emit_parameter_during_state_load_ = value;
-    }
-    double getParameterValue(int32_t index) override {
-        double value = 0.0;
-        parameter_support_.getParameter(static_cast<uint32_t>(index), &value);
-        return value;
-    }
-    void setParameterValue(int32_t index, double value) override {
-        parameter_support_.setParameter(static_cast<uint32_t>(index), value);
-    }
-    void enqueueParameterValueRT(int32_t, double, uapmd_timestamp_t) override {}
-    std::string getParameterValueString(int32_t, double) override { return {}; }
-    void setPerNoteControllerValue(uint8_t note, uint8_t index, double value) override {
-        parameter_support_.setPerNoteController(
-            {.note = note, .channel = 0, .group = 0, .extra = 0}, index, value);
-    }
-    bool getPerNoteControllerValue(uint8_t note, uint8_t index, double* value) override {
-        return parameter_support_.getPerNoteController(
-                   {.note = note, .channel = 0, .group = 0, .extra = 0}, index, value)
-            == remidy::StatusCode::OK;
-    }
-    void enqueuePerNoteControllerValueRT(uint8_t, uint8_t, double, uapmd_timestamp_t) override {}
-    std::string getPerNoteControllerValueString(uint8_t, uint8_t, double) override { return {}; }
-    bool hasUISupport() override { return false; }
-    bool createUI(bool, void*, std::function<bool(uint32_t, uint32_t)>) override { return false; }
-    void destroyUI() override {}
-    bool showUI() override { return false; }
-    void hideUI() override {}
-    bool isUIVisible() const override { return false; }
-    bool setUISize(uint32_t, uint32_t) override { return false; }
-    bool getUISize(uint32_t&, uint32_t&) override { return false; }
-    bool canUIResize() override { return false; }
-    remidy::PluginParameterSupport* parameterSupport() override { return &parameter_support_; }
-    remidy::PluginAudioBuses* audioBuses() override { return &audio_buses_; }
-    remidy::EventListenerId addTimingInfoChangeListener(
-        std::function<void(remidy::PluginTimingInfoChange)>) override {
-        return 0;
+    // The quiet notification crosses the tail-manager dispatch thread before
+    // it is posted to the main event loop, where it begins the deferred render.
+    for (int attempt = 0;
+         attempt < 100 &&
+         manager.runtimeStateForTrack(trackIndex) !=
+             uapmd::FrozenTrackManager::RuntimeState::Rendering;
+         ++attempt) {
+        remidy::EventLoop::processQueuedTasks();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
-    void removeTimingInfoChangeListener(remidy::EventListenerId) override {}
+    EXPECT_EQ(
+        manager.runtimeStateForTrack(trackIndex),
+        uapmd::FrozenTrackManager::RuntimeState::Rendering);
+}
 
-    void externallySetParameter(int32_t index, double value) {
-        parameter_support_.setParameter(static_cast<uint32_t>(index), value);
-        parameter_support_.parameterChangeEvent().notify(
-            static_cast<uint32_t>(index), value);
-    }
+TEST_F(SequencerEngineOutputTest, BackgroundFreezeNeverTakesATrackOutOfPlayback) {
+    constexpr int32_t sampleRate = 48000;
+    constexpr uint32_t bufferSize = 256;
+    constexpr uint32_t umpBufferSize = 65536;
+    using RuntimeState = uapmd::FrozenTrackManager::RuntimeState;
 
-private:
-    void scheduleStateCompletionParameterNotification(uint32_t remainingTurns) {
-        if (remainingTurns != 0) {
-            remidy::EventLoop::enqueueTaskOnMainThread(
-                [this, remainingTurns] {
-                    scheduleStateCompletionParameterNotification(
-                        remainingTurns - 1);
-                });
-            return;
-        }
-        const auto notify = [this] {
-            externallySetParameter(
-                2,
-                parameter_after_state_completion_value_.value_or(
-                    getParameterValue(2)));
-        };
-        if (!parameter_notification_from_worker_) {
-            notify();
-            return;
+    ScopedTestEventLoop eventLoop;
+    auto engine = uapmd::SequencerEngine::create(sampleRate, bufferSize, umpBufferSize);
+    ASSERT_NE(engine, nullptr);
+    engine->setEngineActive(true);
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
+    // Long enough that the render is still running when playback starts.
+    ASSERT_TRUE(engine->timeline().addAudioClipToTrack(
+                    trackIndex,
+                    uapmd::TimelinePosition::fromSamples(0, sampleRate),
+                    std::make_unique<SineAudioFileReader>(sampleRate * 60, 2, sampleRate, 440.0, 0.25f),
+                    "synthetic://long-sine")
+                    .success);
+    ASSERT_TRUE(engine->canRenderTrackInBackground(trackIndex));
+    auto& frozen = engine->frozenTrackManager();
+    frozen.setBackgroundRenderingEnabled(true);
+
+    remidy::AudioProcessContext process(
+        engine->data().masterContext(), umpBufferSize);
+    process.configureMainBus(2, 2, bufferSize);
+    process.frameCount(bufferSize);
+    const auto waitForQuietTransport = [&] {
+        constexpr auto kSilenceBlocks = sampleRate / 4 / bufferSize + 1;
+        for (int block = 0; block < kSilenceBlocks; ++block)
+            engine->processAudio(process);
+    };
+    const auto pumpUntil = [](auto&& done) {
+        for (int attempt = 0; attempt < 10000 && !done(); ++attempt) {
+            remidy::EventLoop::processQueuedTasks();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
-        std::thread worker(notify);
-        worker.join();
-    }
+        return done();
+    };
 
-    mutable std::string display_name_{"Test Plugin"};
-    mutable std::string format_name_{"Test"};
-    mutable std::string plugin_id_{"test.plugin"};
-    bool bypassed_{false};
-    std::atomic<uint32_t> latency_in_samples_{0};
-    std::vector<uint8_t> state_{};
-    TestPluginParameterSupport parameter_support_{};
-    TestAudioBuses audio_buses_{};
-    bool defer_state_load_{false};
-    std::vector<uint8_t> pending_state_{};
-    void* pending_state_context_{nullptr};
-    std::function<void(std::string, void*)> pending_state_callback_{};
-    bool notify_parameter_after_state_completion_{false};
-    std::optional<double> parameter_after_state_completion_value_{};
-    uint32_t parameter_notification_delay_turns_{1};
-    bool parameter_notification_from_worker_{false};
-    bool emit_parameter_during_state_load_{true};
-};
+    // A freeze requested during playback waits, like an exclusive one.
+    engine->startPlayback();
+    ASSERT_TRUE(frozen.setFreezePolicyForTrack(trackIndex, uapmd::FrozenTrackManager::FreezePolicy::On));
+    EXPECT_EQ(frozen.runtimeStateForTrack(trackIndex), RuntimeState::Live);
+    engine->stopPlayback();
+    waitForQuietTransport();
+    ASSERT_TRUE(pumpUntil([&] { return frozen.runtimeStateForTrack(trackIndex) != RuntimeState::Live; }));
+    ASSERT_EQ(frozen.runtimeStateForTrack(trackIndex), RuntimeState::Rendering);
 
-class TestPluginHostingAPI final : public uapmd_plugin_hosting::AudioPluginHostingAPI {
-public:
-    explicit TestPluginHostingAPI(
-        bool deferCreation = false,
-        bool deferStateLoad = false)
-        : defer_creation_(deferCreation),
-          defer_state_load_(deferStateLoad) {
-    }
+    // Play hands the track back before the transport runs, without waiting
+    // for the render thread.
+    engine->startPlayback();
+    EXPECT_TRUE(engine->isPlaybackActive());
+    EXPECT_EQ(frozen.runtimeStateForTrack(trackIndex), RuntimeState::Live);
+    EXPECT_EQ(frozen.freezePolicyForTrack(trackIndex), uapmd::FrozenTrackManager::FreezePolicy::On);
+    remidy::EventLoop::processQueuedTasks();
+    EXPECT_EQ(frozen.runtimeStateForTrack(trackIndex), RuntimeState::Live);
 
-    std::vector<remidy::PluginCatalogEntry> pluginCatalogEntries() override { return {}; }
-    void savePluginCatalogToFile(std::filesystem::path) override {}
-    void performPluginScanning(bool) override {}
-    void reloadPluginCatalogFromCache() override {}
-
-    void createPluginInstance(
-        uint32_t,
-        uint32_t,
-        std::optional<uint32_t>,
-        std::optional<uint32_t>,
-        bool,
-        std::string&,
-        std::string&,
-        std::function<void(int32_t, std::string)>&& callback) override {
-        const auto instanceId = next_instance_id_++;
-        auto plugin = std::make_unique<MutableTimingPlugin>(defer_state_load_);
-        plugin->notifyParameterAfterStateCompletion(
-            notify_parameter_after_state_completion_);
-        plugin->parameterAfterStateCompletionValue(
-            parameter_after_state_completion_value_);
-        plugin->parameterNotificationDelayTurns(
-            parameter_notification_delay_turns_);
-        plugin->parameterNotificationFromWorker(
-            parameter_notification_from_worker_);
-        instances_[instanceId] = std::move(plugin);
-        if (defer_creation_) {
-            pending_creations_.push_back({instanceId, std::move(callback)});
-            return;
-        }
-        callback(instanceId, {});
-    }
+    // The withdrawn render starts again once the transport is quiet.
+    engine->stopPlayback();
+    waitForQuietTransport();
+    EXPECT_TRUE(pumpUntil([&] { return frozen.runtimeStateForTrack(trackIndex) == RuntimeState::Frozen; }))
+        << frozen.errorMessageForTrack(trackIndex);
+}
 
-    void deletePluginInstance(int32_t instanceId) override {
-        instances_.erase(instanceId);
-    }
+TEST_F(SequencerEngineOutputTest, OfflineRenderProducesAudibleSamples) {
+    constexpr int32_t sampleRate = 48000;
+    constexpr uint32_t bufferSize = 256;
+    constexpr uint32_t outputChannels = 2;
+    constexpr uint32_t umpBufferSize = 65536;
+    constexpr uint64_t clipFrames = sampleRate / 10; // 100 ms
 
-    uapmd_plugin_hosting::AudioPluginInstanceAPI* getInstance(int32_t instanceId) override {
-        const auto it = instances_.find(instanceId);
-        return it == instances_.end() ? nullptr : it->second.get();
-    }
+    auto engine = uapmd::SequencerEngine::create(sampleRate, bufferSize, umpBufferSize);
+    ASSERT_NE(engine, nullptr);
+    engine->setEngineActive(true);
 
-    remidy::EventListenerId addPluginStateChangeListener(
-        std::function<void(int32_t)> listener) override {
-        plugin_state_change_listener_ = std::move(listener);
-        return 1;
-    }
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
 
-    void removePluginStateChangeListener(remidy::EventListenerId) override {
-        plugin_state_change_listener_ = {};
-    }
+    auto addResult = engine->timeline().addAudioClipToTrack(
+        trackIndex,
+        uapmd::TimelinePosition::fromSamples(0, sampleRate),
+        std::make_unique<SineAudioFileReader>(clipFrames, outputChannels, sampleRate, 440.0, 0.25f),
+        "synthetic://sine");
+    ASSERT_TRUE(addResult.success) << addResult.error;
 
-    void notifyPluginStateChanged(int32_t instanceId) {
-        if (plugin_state_change_listener_)
-            plugin_state_change_listener_(instanceId);
-    }
+    const auto outputPath = test_dir_ / "render.wav";
+    uapmd::OfflineRenderSettings settings;
+    settings.outputPath = outputPath;
+    settings.startSeconds = 0.0;
+    settings.endSeconds = 0.1;
+    settings.sampleRate = sampleRate;
+    settings.bufferSize = bufferSize;
+    settings.outputChannels = outputChannels;
+    settings.umpBufferSize = umpBufferSize;
+    settings.infiniteTailPolicy = uapmd::OfflineInfiniteTailPolicy::LATENCY_FALLBACK;
 
-    std::vector<int32_t> instanceIds() override {
-        std::vector<int32_t> result;
-        result.reserve(instances_.size());
-        for (const auto& [instanceId, instance] : instances_)
-            if (instance)
-                result.push_back(instanceId);
-        return result;
-    }
+    const auto result = uapmd::renderOfflineProject(*engine, settings);
+    ASSERT_TRUE(result.success) << result.errorMessage;
+    ASSERT_TRUE(fs::exists(outputPath));
 
-    bool creationPending() const { return !pending_creations_.empty(); }
+    const auto rendered = readRenderedAudioFile(outputPath);
+    ASSERT_EQ(rendered.properties.numChannels, outputChannels);
+    ASSERT_GT(rendered.properties.numFrames, 0u);
+    EXPECT_GT(peakInFrameRange(rendered, 0, rendered.properties.numFrames), 0.01f);
+}
 
-    void completeNextCreation(std::string error = {}) {
-        if (pending_creations_.empty())
-            return;
-        auto pending = std::move(pending_creations_.front());
-        pending_creations_.erase(pending_creations_.begin());
-        if (!error.empty()) {
-            instances_.erase(pending.instanceId);
-            pending.callback(-1, std::move(error));
-            return;
-        }
-        pending.callback(pending.instanceId, {});
-    }
+TEST_F(SequencerEngineOutputTest, Float64ProcessingRendersLikeFloat32) {
+    constexpr int32_t sampleRate = 48000;
+    constexpr uint32_t bufferSize = 256;
+    constexpr uint32_t outputChannels = 2;
+    constexpr uint32_t umpBufferSize = 65536;
+    constexpr uint64_t clipFrames = sampleRate / 10; // 100 ms
 
-    MutableTimingPlugin* mutableInstance(int32_t instanceId) {
-        const auto it = instances_.find(instanceId);
-        return it == instances_.end()
-            ? nullptr
-            : dynamic_cast<MutableTimingPlugin*>(it->second.get());
-    }
+    auto engine = uapmd::SequencerEngine::create(sampleRate, bufferSize, umpBufferSize);
+    ASSERT_NE(engine, nullptr);
+    engine->setEngineActive(true);
+    ASSERT_EQ(engine->audioDataType(), uapmd::AudioContentType::Float32);
 
-    void configureStateCompletionParameterNotification(
-        bool notify,
-        std::optional<double> value,
-        uint32_t delayTurns = 1,
-        bool fromWorker = false) {
-        notify_parameter_after_state_completion_ = notify;
-        parameter_after_state_completion_value_ = value;
-        parameter_notification_delay_turns_ = delayTurns;
-        parameter_notification_from_worker_ = fromWorker;
-        for (auto& [instanceId, instance] : instances_)
-            if (auto* plugin = dynamic_cast<MutableTimingPlugin*>(instance.get())) {
-                plugin->notifyParameterAfterStateCompletion(notify);
-                plugin->parameterAfterStateCompletionValue(value);
-                plugin->parameterNotificationDelayTurns(delayTurns);
-                plugin->parameterNotificationFromWorker(fromWorker);
-            }
-    }
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
+    auto addResult = engine->timeline().addAudioClipToTrack(
+        trackIndex,
+        uapmd::TimelinePosition::fromSamples(0, sampleRate),
+        std::make_unique<SineAudioFileReader>(clipFrames, outputChannels, sampleRate, 440.0, 0.25f),
+        "synthetic://sine");
+    ASSERT_TRUE(addResult.success) << addResult.error;
 
-private:
-    struct PendingCreation {
-        int32_t instanceId{-1};
-        std::function<void(int32_t, std::string)> callback;
+    const auto render = [&](const char* fileName) {
+        uapmd::OfflineRenderSettings settings;
+        settings.outputPath = test_dir_ / fileName;
+        settings.startSeconds = 0.0;
+        settings.endSeconds = 0.1;
+        settings.sampleRate = sampleRate;
+        settings.bufferSize = bufferSize;
+        settings.outputChannels = outputChannels;
+        settings.umpBufferSize = umpBufferSize;
+        settings.infiniteTailPolicy = uapmd::OfflineInfiniteTailPolicy::LATENCY_FALLBACK;
+        const auto result = uapmd::renderOfflineProject(*engine, settings);
+        EXPECT_TRUE(result.success) << result.errorMessage;
+        return readRenderedAudioFile(settings.outputPath);
     };
 
-    int32_t next_instance_id_{100};
-    std::map<int32_t, std::unique_ptr<MutableTimingPlugin>> instances_{};
-    bool defer_creation_{false};
-    bool defer_state_load_{false};
-    bool notify_parameter_after_state_completion_{false};
-    std::optional<double> parameter_after_state_completion_value_{};
-    uint32_t parameter_notification_delay_turns_{1};
-    bool parameter_notification_from_worker_{false};
-    std::vector<PendingCreation> pending_creations_{};
-    std::function<void(int32_t)> plugin_state_change_listener_{};
-};
+    const auto single = render("float32.wav");
+    engine->audioDataType(uapmd::AudioContentType::Float64);
+    EXPECT_EQ(engine->audioDataType(), uapmd::AudioContentType::Float64);
+    const auto dual = render("float64.wav");
+    engine->audioDataType(uapmd::AudioContentType::Float32);
+
+    ASSERT_EQ(dual.channels.size(), single.channels.size());
+    ASSERT_GT(peakInFrameRange(dual, 0, dual.properties.numFrames), 0.01f);
+    for (size_t channel = 0; channel < dual.channels.size(); ++channel) {
+        ASSERT_EQ(dual.channels[channel].size(), single.channels[channel].size());
+        for (size_t frame = 0; frame < dual.channels[channel].size(); ++frame)
+            ASSERT_NEAR(dual.channels[channel][frame], single.channels[channel][frame], 1e-6f)
+                << "channel " << channel << ", frame " << frame;
+    }
+}
 
-RenderedAudio readRenderedAudioFile(const fs::path& outputPath) {
-    auto stream = std::make_shared<std::ifstream>(outputPath, std::ios::binary);
-    EXPECT_TRUE(*stream);
-    if (!*stream)
-        return {};
-    auto reader = choc::audio::WAVAudioFileFormat<false>().createReader(stream);
-    EXPECT_NE(reader, nullptr);
-    if (!reader)
-        return {};
+TEST_F(SequencerEngineOutputTest, NullAudioDeviceDrivesTheEngineAndCapturesItsOutput) {
+    constexpr int32_t sampleRate = 48000;
+    constexpr uint32_t bufferSize = 256;
+    constexpr uint32_t outputChannels = 2;
+    constexpr uint32_t umpBufferSize = 65536;
+    constexpr uint64_t clipFrames = sampleRate / 10; // 100 ms
 
-    RenderedAudio rendered{};
-    rendered.properties = reader->getProperties();
-    rendered.channels.assign(
-        rendered.properties.numChannels,
-        std::vector<float>(rendered.properties.numFrames, 0.0f));
+    ScopedTestEventLoop eventLoop;
+    auto engine = uapmd::SequencerEngine::create(sampleRate, bufferSize, umpBufferSize);
+    ASSERT_NE(engine, nullptr);
+    engine->setEngineActive(true);
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
+    auto addResult = engine->timeline().addAudioClipToTrack(
+        trackIndex,
+        uapmd::TimelinePosition::fromSamples(0, sampleRate),
+        std::make_unique<SineAudioFileReader>(clipFrames, outputChannels, sampleRate, 440.0, 0.25f),
+        "synthetic://sine");
+    ASSERT_TRUE(addResult.success) << addResult.error;
 
-    std::vector<float*> channelPointers;
-    channelPointers.reserve(rendered.channels.size());
-    for (auto& channel : rendered.channels)
-        channelPointers.push_back(channel.data());
+    auto* manager = dynamic_cast<uapmd::NullAudioIODeviceManager*>(
+        uapmd::AudioIODeviceManager::instance("null"));
+    ASSERT_NE(manager, nullptr);
+    uapmd::AudioIODeviceManager::Configuration audioConfig{};
+    manager->initialize(audioConfig);
+    uapmd::NullAudioIOSimulation simulation;
+    simulation.outputChannels = outputChannels;
+    simulation.periodSchedule = {128, 256, 64};
+    simulation.realtime = false;
+    simulation.outputFile = test_dir_ / "null-device.wav";
+    manager->simulation(simulation);
+    auto* device = manager->open(-1, -1, sampleRate, bufferSize);
+    ASSERT_NE(device, nullptr);
+    EXPECT_EQ(device->sampleRate(), sampleRate);
+
+    auto* dispatcher = uapmd::defaultDeviceIODispatcher();
+    ASSERT_EQ(dispatcher->configure(umpBufferSize, device, nullptr, nullptr, bufferSize), 0);
+    const auto callbackId = dispatcher->addCallback([&engine](uapmd::AudioProcessContext& process) {
+        return engine->processAudio(process);
+    });
+    engine->startPlayback();
+    ASSERT_EQ(dispatcher->start(), 0);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (manager->statistics().frames < clipFrames * 2 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    dispatcher->stop();
+    engine->stopPlayback();
+    dispatcher->removeCallback(callbackId);
+    dispatcher->configure(umpBufferSize, nullptr, nullptr, nullptr, bufferSize);
 
-    const bool readSuccess = reader->readFrames(
-        0,
-        choc::buffer::createChannelArrayView(
-            channelPointers.data(),
-            rendered.properties.numChannels,
-            rendered.properties.numFrames));
-    EXPECT_TRUE(readSuccess);
-    return rendered;
-}
+    const auto statistics = manager->statistics();
+    EXPECT_GE(statistics.frames, clipFrames * 2);
+    EXPECT_EQ(statistics.deadlineMisses, 0u);
+    EXPECT_EQ(statistics.droppedOutputFrames, 0u);
 
-float peakInFrameRange(const RenderedAudio& rendered, uint64_t startFrame, uint64_t endFrame) {
-    float peak = 0.0f;
-    const uint64_t clampedEnd = std::min<uint64_t>(endFrame, rendered.properties.numFrames);
-    for (const auto& channel : rendered.channels)
-        for (uint64_t frame = startFrame; frame < clampedEnd; ++frame)
-            peak = std::max(peak, std::fabs(channel[frame]));
-    return peak;
+    const auto rendered = readRenderedAudioFile(simulation.outputFile);
+    ASSERT_EQ(rendered.properties.numChannels, outputChannels);
+    EXPECT_EQ(rendered.properties.numFrames, statistics.frames);
+    EXPECT_GT(peakInFrameRange(rendered, 0, clipFrames), 0.01f);
 }
 
-class SequencerEngineOutputTest : public ::testing::Test {
-protected:
-    fs::path test_dir_;
+TEST_F(SequencerEngineOutputTest, OfflineTrackRenderStreamsToBlockSinkWithoutBuffering) {
+    constexpr int32_t sampleRate = 48000;
+    constexpr uint32_t bufferSize = 256;
+    constexpr uint32_t outputChannels = 2;
+    constexpr uint32_t umpBufferSize = 65536;
+    constexpr uint64_t clipFrames = sampleRate / 10; // 100 ms
 
-    void SetUp() override {
-        test_dir_ = fs::temp_directory_path() / "uapmd_engine_output_test";
-        fs::create_directories(test_dir_);
-    }
+    ScopedTestEventLoop eventLoop;
+    auto engine = uapmd::SequencerEngine::create(sampleRate, bufferSize, umpBufferSize);
+    ASSERT_NE(engine, nullptr);
+    engine->setEngineActive(true);
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
+    auto addResult = engine->timeline().addAudioClipToTrack(
+        trackIndex,
+        uapmd::TimelinePosition::fromSamples(0, sampleRate),
+        std::make_unique<SineAudioFileReader>(clipFrames, outputChannels, sampleRate, 440.0, 0.25f),
+        "synthetic://sine");
+    ASSERT_TRUE(addResult.success) << addResult.error;
 
-    void TearDown() override {
-        if (fs::exists(test_dir_))
-            fs::remove_all(test_dir_);
-    }
-};
+    uapmd::OfflineTrackRenderSettings settings;
+    settings.trackIndex = trackIndex;
+    settings.endSample = static_cast<int64_t>(clipFrames);
+    settings.sampleRate = sampleRate;
+    settings.bufferSize = bufferSize;
+    settings.umpBufferSize = umpBufferSize;
+    const auto buffered = engine->renderOfflineTrack(settings);
+    ASSERT_TRUE(buffered.success) << buffered.errorMessage;
+    ASSERT_FALSE(buffered.channels.empty());
+
+    std::vector<std::vector<float>> streamed;
+    settings.maximumBytes = 0; // must not apply to streamed renders
+    settings.blockSink = [&streamed](const float* const* channels,
+                                     uint32_t channelCount,
+                                     int32_t frameCount,
+                                     std::string&) {
+        streamed.resize(channelCount);
+        for (uint32_t channel = 0; channel < channelCount; ++channel)
+            streamed[channel].insert(
+                streamed[channel].end(), channels[channel], channels[channel] + frameCount);
+        return true;
+    };
+    const auto result = engine->renderOfflineTrack(settings);
+    ASSERT_TRUE(result.success) << result.errorMessage;
+    EXPECT_TRUE(result.channels.empty());
+    ASSERT_EQ(streamed.size(), buffered.channels.size());
+    for (size_t channel = 0; channel < streamed.size(); ++channel)
+        EXPECT_EQ(streamed[channel], buffered.channels[channel]) << "channel " << channel;
+}
 
-TEST_F(
-    SequencerEngineOutputTest,
-    FreezePolicyCanChangeDuringPlaybackWithoutStartingRender) {
+TEST_F(SequencerEngineOutputTest, StemAndFlacRendersMatchBufferedRenders) {
     constexpr int32_t sampleRate = 48000;
     constexpr uint32_t bufferSize = 256;
+    constexpr uint32_t outputChannels = 2;
     constexpr uint32_t umpBufferSize = 65536;
+    constexpr uint64_t clipFrames = sampleRate / 10; // 100 ms
+    // One step of 24-bit FLAC, with room for rounding.
+    constexpr float flacTolerance = 2.0f / 8388608.0f;
 
     ScopedTestEventLoop eventLoop;
-    auto engine = uapmd::SequencerEngine::create(
-        sampleRate, bufferSize, umpBufferSize);
+    auto engine = uapmd::SequencerEngine::create(sampleRate, bufferSize, umpBufferSize);
     ASSERT_NE(engine, nullptr);
     engine->setEngineActive(true);
-    const auto trackIndex = engine->addEmptyTrack();
-    ASSERT_GE(trackIndex, 0);
-
-    engine->startPlayback();
-    auto& manager = engine->frozenTrackManager();
-    EXPECT_TRUE(manager.setFreezePolicyForTrack(
-        trackIndex, uapmd::FrozenTrackManager::FreezePolicy::On));
-    EXPECT_EQ(
-        manager.freezePolicyForTrack(trackIndex),
-        uapmd::FrozenTrackManager::FreezePolicy::On);
-    EXPECT_EQ(
-        manager.runtimeStateForTrack(trackIndex),
-        uapmd::FrozenTrackManager::RuntimeState::Live);
-
-    EXPECT_TRUE(manager.setFreezePolicyForTrack(
-        trackIndex, uapmd::FrozenTrackManager::FreezePolicy::Off));
-    EXPECT_EQ(
-        manager.freezePolicyForTrack(trackIndex),
-        uapmd::FrozenTrackManager::FreezePolicy::Off);
-    EXPECT_EQ(
-        manager.runtimeStateForTrack(trackIndex),
-        uapmd::FrozenTrackManager::RuntimeState::Live);
-
-    EXPECT_TRUE(manager.setFreezePolicyForTrack(
-        trackIndex, uapmd::FrozenTrackManager::FreezePolicy::On));
-    EXPECT_EQ(
-        manager.runtimeStateForTrack(trackIndex),
-        uapmd::FrozenTrackManager::RuntimeState::Live);
-    engine->stopPlayback();
+    std::vector<int32_t> trackIndices;
+    for (const double frequency : {440.0, 660.0, 880.0}) {
+        const auto trackIndex = engine->addEmptyTrack();
+        ASSERT_GE(trackIndex, 0);
+        auto addResult = engine->timeline().addAudioClipToTrack(
+            trackIndex,
+            uapmd::TimelinePosition::fromSamples(0, sampleRate),
+            std::make_unique<SineAudioFileReader>(clipFrames, outputChannels, sampleRate, frequency, 0.25f),
+            "synthetic://sine");
+        ASSERT_TRUE(addResult.success) << addResult.error;
+        trackIndices.push_back(trackIndex);
+    }
 
-    remidy::AudioProcessContext process(
-        engine->data().masterContext(), umpBufferSize);
-    process.configureMainBus(2, 2, bufferSize);
-    process.frameCount(bufferSize);
-    constexpr auto kSilenceBlocks = sampleRate / 4 / bufferSize + 1;
-    for (int block = 0; block < kSilenceBlocks; ++block)
-        engine->processAudio(process);
+    uapmd::OfflineStemRenderSettings stemSettings;
+    stemSettings.endSample = static_cast<int64_t>(clipFrames);
+    stemSettings.sampleRate = sampleRate;
+    stemSettings.bufferSize = bufferSize;
+    stemSettings.umpBufferSize = umpBufferSize;
+    stemSettings.encoderThreads = 2;
+    for (const auto trackIndex : trackIndices)
+        stemSettings.stems.push_back({trackIndex, test_dir_ / "stems" / ("track-" + std::to_string(trackIndex) + ".flac")});
+    double lastProgress = 0.0;
+    uapmd::OfflineRenderCallbacks callbacks;
+    callbacks.onProgress = [&lastProgress](const uapmd::OfflineRenderProgress& progress) {
+        EXPECT_GE(progress.progress, lastProgress);
+        lastProgress = progress.progress;
+    };
+    const auto stems = uapmd::renderOfflineStems(*engine, stemSettings, callbacks);
+    ASSERT_TRUE(stems.success) << stems.errorMessage;
+    ASSERT_EQ(stems.outputPaths.size(), trackIndices.size());
+    EXPECT_DOUBLE_EQ(lastProgress, 1.0);
+
+    for (size_t i = 0; i < trackIndices.size(); ++i) {
+        uapmd::OfflineTrackRenderSettings settings;
+        settings.trackIndex = trackIndices[i];
+        settings.endSample = stemSettings.endSample;
+        settings.sampleRate = sampleRate;
+        settings.bufferSize = bufferSize;
+        settings.umpBufferSize = umpBufferSize;
+        const auto buffered = engine->renderOfflineTrack(settings);
+        ASSERT_TRUE(buffered.success) << buffered.errorMessage;
+
+        const auto stem = readRenderedAudioFile(stems.outputPaths[i]);
+        ASSERT_EQ(stem.channels.size(), buffered.channels.size());
+        ASSERT_GT(peakInFrameRange(stem, 0, stem.properties.numFrames), 0.01f);
+        for (size_t channel = 0; channel < stem.channels.size(); ++channel) {
+            ASSERT_EQ(stem.channels[channel].size(), buffered.channels[channel].size());
+            for (size_t frame = 0; frame < stem.channels[channel].size(); ++frame)
+                ASSERT_NEAR(stem.channels[channel][frame], buffered.channels[channel][frame], flacTolerance)
+                    << "track " << trackIndices[i] << ", channel " << channel << ", frame " << frame;
+        }
+    }
 
-    // The quiet notification crosses the tail-manager dispatch thread before
-    // it is posted to the main event loop, where it begins the deferred render.
-    for (int attempt = 0;
-         attempt < 100 &&
-         manager.runtimeStateForTrack(trackIndex) !=
-             uapmd::FrozenTrackManager::RuntimeState::Rendering;
-         ++attempt) {
-        remidy::EventLoop::processQueuedTasks();
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    const auto renderProject = [&](const char* fileName) {
+        uapmd::OfflineRenderSettings settings;
+        settings.outputPath = test_dir_ / fileName;
+        settings.endSeconds = 0.1;
+        settings.sampleRate = sampleRate;
+        settings.bufferSize = bufferSize;
+        settings.outputChannels = outputChannels;
+        settings.umpBufferSize = umpBufferSize;
+        settings.infiniteTailPolicy = uapmd::OfflineInfiniteTailPolicy::LATENCY_FALLBACK;
+        const auto result = uapmd::renderOfflineProject(*engine, settings);
+        EXPECT_TRUE(result.success) << result.errorMessage;
+        return readRenderedAudioFile(settings.outputPath);
+    };
+    const auto wav = renderProject("render.wav");
+    const auto flac = renderProject("render.flac");
+    ASSERT_EQ(flac.channels.size(), wav.channels.size());
+    ASSERT_GT(peakInFrameRange(flac, 0, flac.properties.numFrames), 0.01f);
+    for (size_t channel = 0; channel < flac.channels.size(); ++channel) {
+        ASSERT_EQ(flac.channels[channel].size(), wav.channels[channel].size());
+        for (size_t frame = 0; frame < flac.channels[channel].size(); ++frame)
+            ASSERT_NEAR(flac.channels[channel][frame], wav.channels[channel][frame], flacTolerance)
+                << "channel " << channel << ", frame " << frame;
     }
-    EXPECT_EQ(
-        manager.runtimeStateForTrack(trackIndex),
-        uapmd::FrozenTrackManager::RuntimeState::Rendering);
 }
 
-TEST_F(SequencerEngineOutputTest, OfflineRenderProducesAudibleSamples) {
+TEST_F(SequencerEngineOutputTest, BackgroundTrackRenderMatchesExclusiveRenderDuringPlayback) {
     constexpr int32_t sampleRate = 48000;
     constexpr uint32_t bufferSize = 256;
     constexpr uint32_t outputChannels = 2;
     constexpr uint32_t umpBufferSize = 65536;
     constexpr uint64_t clipFrames = sampleRate / 10; // 100 ms
 
+    ScopedTestEventLoop eventLoop;
     auto engine = uapmd::SequencerEngine::create(sampleRate, bufferSize, umpBufferSize);
     ASSERT_NE(engine, nullptr);
     engine->setEngineActive(true);
-
     const auto trackIndex = engine->addEmptyTrack();
     ASSERT_GE(trackIndex, 0);
-
     auto addResult = engine->timeline().addAudioClipToTrack(
         trackIndex,
         uapmd::TimelinePosition::fromSamples(0, sampleRate),
         std::make_unique<SineAudioFileReader>(clipFrames, outputChannels, sampleRate, 440.0, 0.25f),
         "synthetic://sine");
     ASSERT_TRUE(addResult.success) << addResult.error;
+    ASSERT_TRUE(engine->canRenderTrackInBackground(trackIndex));
 
-    const auto outputPath = test_dir_ / "render.wav";
-    uapmd::OfflineRenderSettings settings;
-    settings.outputPath = outputPath;
-    settings.startSeconds = 0.0;
-    settings.endSeconds = 0.1;
+    uapmd::OfflineTrackRenderSettings settings;
+    settings.trackIndex = trackIndex;
+    settings.endSample = static_cast<int64_t>(clipFrames);
     settings.sampleRate = sampleRate;
     settings.bufferSize = bufferSize;
-    settings.outputChannels = outputChannels;
     settings.umpBufferSize = umpBufferSize;
-    settings.infiniteTailPolicy = uapmd::OfflineInfiniteTailPolicy::LATENCY_FALLBACK;
+    const auto exclusive = engine->renderOfflineTrack(settings);
+    ASSERT_TRUE(exclusive.success) << exclusive.errorMessage;
 
-    const auto result = uapmd::renderOfflineProject(*engine, settings);
-    ASSERT_TRUE(result.success) << result.errorMessage;
-    ASSERT_TRUE(fs::exists(outputPath));
+    // Exclusive renders are refused while the transport runs; background ones
+    // render the track from their own transport regardless of the playhead.
+    engine->startPlayback();
+    auto failed = engine->renderOfflineTrack(settings);
+    EXPECT_FALSE(failed.success);
 
-    const auto rendered = readRenderedAudioFile(outputPath);
-    ASSERT_EQ(rendered.properties.numChannels, outputChannels);
-    ASSERT_GT(rendered.properties.numFrames, 0u);
-    EXPECT_GT(peakInFrameRange(rendered, 0, rendered.properties.numFrames), 0.01f);
+    settings.background = true;
+    const auto background = engine->renderOfflineTrack(settings);
+    engine->stopPlayback();
+    ASSERT_TRUE(background.success) << background.errorMessage;
+    ASSERT_EQ(background.channels.size(), exclusive.channels.size());
+    for (size_t channel = 0; channel < background.channels.size(); ++channel)
+        EXPECT_EQ(background.channels[channel], exclusive.channels[channel]) << "channel " << channel;
 }
 
 TEST_F(SequencerEngineOutputTest, OfflineRenderIsIdenticalBeforeAndAfterTrackDAGMigration) {
@@ -1085,6 +1070,92 @@ TEST_F(SequencerEngineOutputTest, OfflineRenderKeepsWarpedTailAudible) {
     EXPECT_GT(peakInFrameRange(rendered, stretchedTailStart, stretchedTailEnd), 0.01f);
 }
 
+TEST_F(SequencerEngineOutputTest, WarpedClipStreamsFromSeekPosition) {
+    constexpr int32_t sampleRate = 48000;
+    constexpr uint32_t channels = 2;
+    constexpr int64_t clipFrames = sampleRate / 10; // 100 ms
+    constexpr int32_t blockFrames = 256;
+
+    const std::vector<uapmd::AudioWarpPoint> warps{
+        uapmd::AudioWarpPoint{0.0, 1.0, uapmd::AudioWarpReferenceType::ClipStart, {}, {}},
+        uapmd::AudioWarpPoint{0.05, 0.5, uapmd::AudioWarpReferenceType::ClipStart, {}, {}},
+    };
+    uapmd::AudioFileSourceNode node(
+        1001,
+        std::make_unique<SineAudioFileReader>(clipFrames, channels, sampleRate, 440.0, 0.25f),
+        static_cast<double>(sampleRate),
+        warps);
+    // 50 ms as is, then the remaining 50 ms at half speed.
+    EXPECT_EQ(node.totalLength(), clipFrames / 2 + clipFrames);
+    EXPECT_EQ(node.numFrames(), clipFrames);
+
+    std::vector<std::vector<float>> output(channels, std::vector<float>(blockFrames));
+    std::vector<float*> outputPtrs{output[0].data(), output[1].data()};
+    node.setPlaying(true);
+    // Straight into the stretched tail: the seek pre-roll makes the first
+    // block audible.
+    node.seek(clipFrames);
+    node.processAudio(outputPtrs.data(), channels, blockFrames);
+    EXPECT_EQ(node.currentPosition(), clipFrames + blockFrames);
+    float peak = 0.0f;
+    for (const auto& channel : output)
+        for (const auto sample : channel)
+            peak = std::max(peak, std::fabs(sample));
+    EXPECT_GT(peak, 0.01f);
+
+    // Re-warping shares the decoded audio rather than reading the file again.
+    uapmd::AudioFileSourceNode unwarped(1002, node, {});
+    EXPECT_EQ(unwarped.totalLength(), clipFrames);
+    unwarped.setPlaying(true);
+    unwarped.seek(clipFrames - blockFrames);
+    unwarped.processAudio(outputPtrs.data(), channels, blockFrames);
+    EXPECT_EQ(unwarped.currentPosition(), clipFrames);
+}
+
+#if UAPMD_RT_SAFETY_CHECKS
+TEST(RealtimeSafetyMonitorTest, CountsAllocationsAndLocksOnlyOnMarkedThreads) {
+    std::mutex mutex;
+    uapmd::RealtimeSafetyMonitor::resetCounters();
+    {
+        // Not an audio thread: nothing is counted.
+        std::vector<float> buffer(64);
+        std::lock_guard lock(mutex);
+    }
+    EXPECT_EQ(uapmd::RealtimeSafetyMonitor::counters().total(), 0u);
+
+    {
+        uapmd::RealtimeSafetyMonitor::AudioThreadScope audioThread;
+        EXPECT_TRUE(uapmd::RealtimeSafetyMonitor::isAudioThread());
+        auto buffer = std::make_unique<float[]>(64);
+        buffer.reset();
+        std::lock_guard lock(mutex);
+    }
+    EXPECT_FALSE(uapmd::RealtimeSafetyMonitor::isAudioThread());
+    const auto counters = uapmd::RealtimeSafetyMonitor::counters();
+    EXPECT_GE(counters.allocations, 1u);
+    EXPECT_GE(counters.deallocations, 1u);
+#if defined(__linux__) && defined(__GLIBC__)
+    EXPECT_GE(counters.lockAcquisitions, 1u);
+#endif
+    // These were deliberate; the run-wide check is for the engine's.
+    uapmd::RealtimeSafetyMonitor::resetCounters();
+}
+
+TEST(RealtimeSafetyMonitorTest, SuppressionScopeExemptsDiagnosticsOnTheAudioThread) {
+    uapmd::RealtimeSafetyMonitor::resetCounters();
+    {
+        uapmd::RealtimeSafetyMonitor::AudioThreadScope audioThread;
+        {
+            uapmd::RealtimeSafetyMonitor::SuppressionScope diagnostics;
+            EXPECT_FALSE(uapmd::RealtimeSafetyMonitor::isAudioThread());
+            std::vector<float> buffer(64);
+        }
+        EXPECT_TRUE(uapmd::RealtimeSafetyMonitor::isAudioThread());
+    }
+    EXPECT_EQ(uapmd::RealtimeSafetyMonitor::counters().total(), 0u);
+}
+#endif
+
 // ── Clip fragments ────────────────────────────────────────────────────────────
 
 namespace {
@@ -1125,9 +1196,13 @@ namespace {
 
     class SizedUndoOperation final : public uapmd::ProjectUndoableOperation {
     public:
-        SizedUndoOperation(std::string description, size_t sizeInBytes)
+        SizedUndoOperation(
+            std::string description,
+            size_t sizeInBytes,
+            uapmd::ProjectHistorySharedPayload shared = {})
             : description_(std::move(description))
-            , size_in_bytes_(sizeInBytes) {
+            , size_in_bytes_(sizeInBytes)
+            , shared_(std::move(shared)) {
         }
 
         std::string description() const override {
@@ -1138,6 +1213,11 @@ namespace {
             return size_in_bytes_;
         }
 
+        void collectSharedPayloads(std::vector<uapmd::ProjectHistorySharedPayload>& payloads) const override {
+            if (shared_.payload)
+                payloads.push_back(shared_);
+        }
+
         void perform(
             const uapmd::ProjectUndoExecutionContext&,
             uapmd::ProjectUndoCompletion completion) override {
@@ -1164,6 +1244,7 @@ namespace {
 
         std::string description_;
         size_t size_in_bytes_;
+        uapmd::ProjectHistorySharedPayload shared_;
     };
 }
 
@@ -1194,6 +1275,24 @@ TEST(ProjectUndoEngineTest, EvictsOldestCompleteStepsWithinMemoryBudget) {
     EXPECT_EQ(state.redoDescription, "Second");
 }
 
+TEST(ProjectUndoEngineTest, ChargesSharedPayloadsOncePerHistory) {
+    uapmd::ProjectUndoEngine undoEngine({
+        .maximumHistorySizeInBytes = 1000
+    });
+    const uapmd::ProjectHistorySharedPayload state{std::make_shared<int>(0), 100};
+
+    undoEngine.perform(std::make_shared<SizedUndoOperation>("First", 6, state));
+    EXPECT_EQ(undoEngine.state().historySizeInBytes, 106u);
+    undoEngine.perform(std::make_shared<SizedUndoOperation>("Second", 6, state));
+    EXPECT_EQ(undoEngine.state().historySizeInBytes, 112u);
+
+    // Evicting one holder keeps the payload charged for the other.
+    ASSERT_TRUE(undoEngine.setMaximumHistorySizeInBytes(110));
+    EXPECT_EQ(undoEngine.state().historySizeInBytes, 106u);
+    ASSERT_TRUE(undoEngine.clear());
+    EXPECT_EQ(undoEngine.state().historySizeInBytes, 0u);
+}
+
 TEST(ProjectUndoEngineTest, RetainsCompoundStepsAsAtomicBudgetUnits) {
     uapmd::ProjectUndoEngine undoEngine({
         .maximumHistorySizeInBytes = 10
@@ -1771,6 +1870,368 @@ TEST_F(SequencerEngineOutputTest, DeviceInputCreationChangeAndRemovalUndoAndRedo
     EXPECT_EQ(track->getSourceNode(sourceNodeId), nullptr);
 }
 
+TEST_F(SequencerEngineOutputTest, AudioRecorderCapturesThePunchRangeAndAddsAClip) {
+    constexpr int32_t sampleRate = 48000;
+    constexpr uint32_t bufferSize = 256;
+    constexpr uint32_t umpBufferSize = 65536;
+    constexpr int64_t punchIn = 300;
+    constexpr int64_t punchOut = 1300;
+
+    ScopedTestEventLoop eventLoop;
+    auto engine = uapmd::SequencerEngine::create(sampleRate, bufferSize, umpBufferSize);
+    ASSERT_NE(engine, nullptr);
+    engine->setEngineActive(true);
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
+    auto* track = engine->timeline().tracks()[static_cast<size_t>(trackIndex)];
+    auto* recorder = dynamic_cast<uapmd::AudioRecorder*>(
+        engine->findPlaybackEngineExtension("audio-recorder"));
+    ASSERT_NE(recorder, nullptr);
+    // Device channel 1 only, so the take is mono.
+    ASSERT_TRUE(recorder->arm({track->referenceId(), {1}}));
+
+    uapmd::AudioRecorder::Options options;
+    options.directory = test_dir_ / "takes";
+    options.punchIn = punchIn;
+    options.punchOut = punchOut;
+    std::string error;
+    ASSERT_TRUE(recorder->start(options, error)) << error;
+    EXPECT_TRUE(recorder->isRecording());
+
+    remidy::AudioProcessContext process(engine->data().masterContext(), umpBufferSize);
+    process.configureMainBus(2, 2, bufferSize);
+    process.frameCount(bufferSize);
+    engine->startPlayback();
+    for (int64_t block = 0; block < 8; ++block) {
+        for (uint32_t frame = 0; frame < bufferSize; ++frame) {
+            const auto sample = static_cast<float>(block * bufferSize + frame);
+            process.getFloatInBuffer(0, 0)[frame] = -1.0f;
+            process.getFloatInBuffer(0, 1)[frame] = sample / sampleRate;
+        }
+        engine->processAudio(process);
+    }
+    engine->stopPlayback();
+    EXPECT_FALSE(recorder->isRecording());
+
+    const auto takes = recorder->lastTakes();
+    ASSERT_EQ(takes.size(), 1u);
+    EXPECT_EQ(takes[0].startSample, punchIn);
+    EXPECT_EQ(takes[0].frameCount, punchOut - punchIn);
+    EXPECT_FALSE(takes[0].truncated);
+    const auto* clip = track->clipManager().getClip(takes[0].clipId);
+    ASSERT_NE(clip, nullptr);
+    EXPECT_EQ(clip->position.samples, punchIn);
+    EXPECT_EQ(clip->durationSamples, punchOut - punchIn);
+
+    const auto recorded = readRenderedAudioFile(takes[0].path);
+    ASSERT_EQ(recorded.properties.numChannels, 1u);
+    ASSERT_EQ(recorded.properties.numFrames, static_cast<uint64_t>(punchOut - punchIn));
+    for (int64_t frame = 0; frame < punchOut - punchIn; ++frame)
+        ASSERT_EQ(recorded.channels[0][static_cast<size_t>(frame)],
+                  static_cast<float>(punchIn + frame) / sampleRate) << frame;
+}
+
+TEST_F(SequencerEngineOutputTest, AuxSendsFeedTheReturnTrackBeforeOrAfterTheFader) {
+    constexpr uint32_t bufferSize = 256;
+    constexpr uint32_t umpBufferSize = 65536;
+
+    ScopedTestEventLoop eventLoop;
+    auto engine = uapmd::SequencerEngine::create(48000, bufferSize, umpBufferSize);
+    ASSERT_NE(engine, nullptr);
+    engine->setEngineActive(true);
+    const auto sourceIndex = engine->addEmptyTrack();
+    const auto returnIndex = engine->addEmptyTrack();
+    ASSERT_GE(returnIndex, 0);
+    ASSERT_TRUE(engine->timeline().commands().addDeviceInputToTrack(sourceIndex, 7124, {0, 1}));
+
+    EXPECT_FALSE(engine->setTrackSends(sourceIndex, {{returnIndex, 0.5, true}}));
+    ASSERT_TRUE(engine->setTrackIsReturn(returnIndex, true));
+    EXPECT_FALSE(engine->setTrackSends(returnIndex, {{sourceIndex, 0.5, false}}));
+    ASSERT_TRUE(engine->setTrackSends(sourceIndex, {{returnIndex, 0.5, true}}));
+    // The dry path is silent, so everything heard comes through the return.
+    ASSERT_TRUE(engine->tracks()[static_cast<size_t>(sourceIndex)]->trackGain(0.0));
+
+    remidy::AudioProcessContext process(engine->data().masterContext(), umpBufferSize);
+    process.configureMainBus(2, 2, bufferSize);
+    process.frameCount(bufferSize);
+    auto renderBlocks = [&](int blocks) {
+        for (int block = 0; block < blocks; ++block) {
+            for (uint32_t frame = 0; frame < bufferSize; ++frame) {
+                process.getFloatInBuffer(0, 0)[frame] = 0.25f;
+                process.getFloatInBuffer(0, 1)[frame] = 0.25f;
+            }
+            engine->processAudio(process);
+        }
+    };
+    engine->startPlayback();
+    renderBlocks(8);
+    for (uint32_t frame = 0; frame < bufferSize; ++frame)
+        ASSERT_NEAR(process.getFloatOutBuffer(0, 0)[frame], 0.125f, 1e-6f) << frame;
+
+    // After the fader, the send follows the track down to silence.
+    ASSERT_TRUE(engine->setTrackSends(sourceIndex, {{returnIndex, 0.5, false}}));
+    renderBlocks(8);
+    for (uint32_t frame = 0; frame < bufferSize; ++frame)
+        ASSERT_EQ(process.getFloatOutBuffer(0, 0)[frame], 0.0f) << frame;
+
+    // Clearing the return drops the sends that targeted it.
+    ASSERT_TRUE(engine->setTrackIsReturn(returnIndex, false));
+    EXPECT_TRUE(engine->trackSends(sourceIndex).empty());
+    engine->stopPlayback();
+}
+
+TEST_F(SequencerEngineOutputTest, OutputAlignmentFollowsLatencyChangesWhilePlaying) {
+    constexpr uint32_t bufferSize = 256;
+    constexpr uint32_t umpBufferSize = 65536;
+
+    ScopedTestEventLoop eventLoop;
+    auto pluginHost = std::make_unique<TestPluginHostingAPI>();
+    auto* pluginHostObserver = pluginHost.get();
+    pluginHostObserver->processingProfile({{}, 100, 0});
+    auto engine = uapmd::SequencerEngine::createWithPluginHost(48000, bufferSize, umpBufferSize, std::move(pluginHost));
+    ASSERT_NE(engine, nullptr);
+    engine->setEngineActive(true);
+    const auto sourceIndex = engine->addEmptyTrack();
+    const auto returnIndex = engine->addEmptyTrack();
+    ASSERT_GE(returnIndex, 0);
+    ASSERT_TRUE(engine->timeline().commands().addDeviceInputToTrack(sourceIndex, 7124, {0, 1}));
+    ASSERT_TRUE(engine->setTrackIsReturn(returnIndex, true));
+    std::string format = "Test";
+    std::string pluginId = "test.plugin";
+    std::optional<int32_t> instanceId;
+    engine->addPluginToTrack(returnIndex, format, pluginId,
+        [&](int32_t id, int32_t, std::string) { instanceId = id; });
+    ASSERT_TRUE(instanceId.has_value());
+    // The send reaches the master through the return's 100 samples of
+    // latency; the dry path is held back to meet it.
+    const std::vector<uapmd::TrackSend> sends{{returnIndex, 0.5, true}};
+    ASSERT_TRUE(engine->setTrackSends(sourceIndex, sends));
+    EXPECT_TRUE(engine->isOutputAlignmentActive());
+
+    remidy::AudioProcessContext process(engine->data().masterContext(), umpBufferSize);
+    process.configureMainBus(2, 2, bufferSize);
+    process.frameCount(bufferSize);
+    // An impulse in the fifth block; returns the output frames that are not
+    // silent, relative to the first of them, with their values.
+    auto renderImpulse = [&] {
+        std::vector<std::pair<size_t, float>> heard;
+        std::optional<size_t> first;
+        for (uint32_t block = 0; block < 12; ++block) {
+            for (uint32_t frame = 0; frame < bufferSize; ++frame) {
+                const float sample = block == 4 && frame == 10 ? 1.0f : 0.0f;
+                process.getFloatInBuffer(0, 0)[frame] = sample;
+                process.getFloatInBuffer(0, 1)[frame] = sample;
+            }
+            engine->processAudio(process);
+            for (uint32_t frame = 0; frame < bufferSize; ++frame) {
+                const auto sample = process.getFloatOutBuffer(0, 0)[frame];
+                if (sample == 0.0f)
+                    continue;
+                const size_t position = block * bufferSize + frame;
+                if (!first)
+                    first = position;
+                heard.emplace_back(position - *first, sample);
+            }
+        }
+        return heard;
+    };
+    auto expectHeard = [](const std::vector<std::pair<size_t, float>>& heard,
+                          const std::vector<std::pair<size_t, float>>& expected) {
+        ASSERT_EQ(heard.size(), expected.size());
+        for (size_t i = 0; i < heard.size(); ++i) {
+            EXPECT_EQ(heard[i].first, expected[i].first) << i;
+            EXPECT_NEAR(heard[i].second, expected[i].second, 1e-6f) << i;
+        }
+    };
+    engine->startPlayback();
+    expectHeard(renderImpulse(), {{0, 0.5f}, {100, 1.0f}});
+
+    // A longer latency outgrows the delay lines; the new ones take over at
+    // a block boundary. A slightly longer one still fits them.
+    auto changeLatency = [&](uint32_t latency) {
+        pluginHostObserver->processingProfile({{}, latency, 0});
+        engine->tracks()[static_cast<size_t>(returnIndex)]->graph().refreshTimingInfo();
+        ASSERT_TRUE(engine->setTrackSends(sourceIndex, sends));
+    };
+    changeLatency(300);
+    expectHeard(renderImpulse(), {{0, 0.5f}, {300, 1.0f}});
+    changeLatency(320);
+    expectHeard(renderImpulse(), {{0, 0.5f}, {320, 1.0f}});
+
+    // Without latency nothing is held back, and the paths arrive together.
+    changeLatency(0);
+    EXPECT_FALSE(engine->isOutputAlignmentActive());
+    expectHeard(renderImpulse(), {{0, 1.5f}});
+    engine->stopPlayback();
+}
+
+TEST_F(SequencerEngineOutputTest, BackgroundTrackRenderRequiresPluginsThatProcessOffAudioThread) {
+    ScopedTestEventLoop eventLoop;
+    auto engine = uapmd::SequencerEngine::createWithPluginHost(
+        48000, 256, 65536, std::make_unique<TestPluginHostingAPI>());
+    ASSERT_NE(engine, nullptr);
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
+    EXPECT_TRUE(engine->canRenderTrackInBackground(trackIndex));
+
+    std::string format = "Test";
+    std::string pluginId = "test.plugin";
+    std::optional<int32_t> instanceId;
+    std::string addError;
+    engine->addPluginToTrack(
+        trackIndex,
+        format,
+        pluginId,
+        [&](int32_t id, int32_t, std::string error) {
+            instanceId = id;
+            addError = std::move(error);
+        });
+    ASSERT_TRUE(instanceId.has_value()) << addError;
+    auto* plugin = dynamic_cast<MutableTimingPlugin*>(engine->getPluginInstance(*instanceId));
+    ASSERT_NE(plugin, nullptr);
+
+    EXPECT_FALSE(engine->canRenderTrackInBackground(trackIndex));
+    uapmd::OfflineTrackRenderSettings settings;
+    settings.trackIndex = trackIndex;
+    settings.endSample = 4800;
+    settings.background = true;
+    std::string error;
+    EXPECT_FALSE(engine->beginOfflineTrackRender(settings, error));
+    EXPECT_FALSE(error.empty());
+
+    plugin->supportsProcessingOffAudioThread(true);
+    EXPECT_TRUE(engine->canRenderTrackInBackground(trackIndex));
+}
+
+TEST_F(SequencerEngineOutputTest, PluginStateFilesAreComparedAndPrunedOnSave) {
+    ScopedTestEventLoop eventLoop;
+    auto engine = uapmd::SequencerEngine::createWithPluginHost(
+        48000, 256, 65536, std::make_unique<TestPluginHostingAPI>());
+    ASSERT_NE(engine, nullptr);
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
+    std::string format = "Test";
+    std::string pluginId = "test.plugin";
+    std::optional<int32_t> instanceId;
+    engine->addPluginToTrack(trackIndex, format, pluginId, [&](int32_t id, int32_t, std::string) {
+        instanceId = id;
+    });
+    ASSERT_TRUE(instanceId.has_value());
+    auto* plugin = dynamic_cast<MutableTimingPlugin*>(engine->getPluginInstance(*instanceId));
+    ASSERT_NE(plugin, nullptr);
+
+    const auto projectFile = test_dir_ / "states" / "project.uapmd";
+    const auto stateDir = projectFile.parent_path() / "plugin_states" / "project.uapmd";
+    auto save = [&] {
+        std::optional<uapmd::TimelineFacade::ProjectResult> saved;
+        uapmd::TimelineFacade::ProjectSaveOptions options;
+        options.emitDocumentEvent = false;
+        engine->timeline().saveProject(projectFile, std::move(options), [&](auto result) {
+            saved = std::move(result);
+        });
+        for (int attempt = 0; attempt < 1000 && !saved.has_value(); ++attempt) {
+            remidy::EventLoop::processQueuedTasks();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return saved;
+    };
+    auto blobName = [](const std::vector<uint8_t>& state, const std::string& variant = {}) {
+        const auto id = uapmd::ProjectChunkId::of(state);
+        return std::format("{:016x}-{}{}.state", id.hash, id.size, variant);
+    };
+    auto readFile = [](const fs::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    };
+
+    const std::vector<uint8_t> firstState{1, 2, 3};
+    plugin->setStateFromHost(firstState);
+    auto saved = save();
+    ASSERT_TRUE(saved.has_value());
+    ASSERT_TRUE(saved->success) << saved->error;
+    EXPECT_EQ(firstState, readFile(stateDir / blobName(firstState)));
+
+    // A file already holding the next state's name but other bytes -- a hash
+    // collision -- is not mistaken for that state.
+    const std::vector<uint8_t> secondState{4, 5};
+    {
+        std::ofstream planted(stateDir / blobName(secondState), std::ios::binary);
+        planted.put(0).put(0);
+    }
+    {
+        std::ofstream foreign(stateDir / "kept.state", std::ios::binary);
+        foreign.put(1);
+    }
+    plugin->setStateFromHost(secondState);
+    saved = save();
+    ASSERT_TRUE(saved.has_value());
+    ASSERT_TRUE(saved->success) << saved->error;
+    EXPECT_EQ(secondState, readFile(stateDir / blobName(secondState, "-1")));
+
+    // Once the manifest refers to the new state, the superseded and colliding
+    // files go; files this scheme did not name stay.
+    EXPECT_FALSE(fs::exists(stateDir / blobName(firstState)));
+    EXPECT_FALSE(fs::exists(stateDir / blobName(secondState)));
+    EXPECT_TRUE(fs::exists(stateDir / "kept.state"));
+}
+
+TEST_F(SequencerEngineOutputTest, SavingOneProjectNeverPrunesTheStatesOfAnotherInTheSameDirectory) {
+    ScopedTestEventLoop eventLoop;
+    auto engine = uapmd::SequencerEngine::createWithPluginHost(
+        48000, 256, 65536, std::make_unique<TestPluginHostingAPI>());
+    ASSERT_NE(engine, nullptr);
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
+    std::string format = "Test";
+    std::string pluginId = "test.plugin";
+    std::optional<int32_t> instanceId;
+    engine->addPluginToTrack(trackIndex, format, pluginId, [&](int32_t id, int32_t, std::string) {
+        instanceId = id;
+    });
+    ASSERT_TRUE(instanceId.has_value());
+    auto* plugin = dynamic_cast<MutableTimingPlugin*>(engine->getPluginInstance(*instanceId));
+    ASSERT_NE(plugin, nullptr);
+
+    const auto directory = test_dir_ / "siblings";
+    auto save = [&](const fs::path& projectFile, bool chunkContainer) {
+        std::optional<uapmd::TimelineFacade::ProjectResult> saved;
+        uapmd::TimelineFacade::ProjectSaveOptions options;
+        options.emitDocumentEvent = false;
+        options.chunkContainer = chunkContainer;
+        engine->timeline().saveProject(projectFile, std::move(options), [&](auto result) {
+            saved = std::move(result);
+        });
+        for (int attempt = 0; attempt < 1000 && !saved.has_value(); ++attempt) {
+            remidy::EventLoop::processQueuedTasks();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return saved.has_value() && saved->success;
+    };
+    auto blobPath = [&directory](const std::string& project, const std::vector<uint8_t>& state) {
+        const auto id = uapmd::ProjectChunkId::of(state);
+        return directory / "plugin_states" / project / std::format("{:016x}-{}.state", id.hash, id.size);
+    };
+
+    const std::vector<uint8_t> songState{1, 2, 3};
+    const std::vector<uint8_t> copyState{4, 5};
+    const std::vector<uint8_t> laterState{6};
+    plugin->setStateFromHost(songState);
+    ASSERT_TRUE(save(directory / "song.uapmd", false));
+    // "Save As" next to it, then edited.
+    ASSERT_TRUE(save(directory / "song-v2.uapmd", false));
+    plugin->setStateFromHost(copyState);
+    ASSERT_TRUE(save(directory / "song-v2.uapmd", false));
+    EXPECT_TRUE(fs::exists(blobPath("song.uapmd", songState)));
+    EXPECT_FALSE(fs::exists(blobPath("song-v2.uapmd", songState)));
+    EXPECT_TRUE(fs::exists(blobPath("song-v2.uapmd", copyState)));
+
+    // A chunk container save writes no state files and prunes none.
+    plugin->setStateFromHost(laterState);
+    ASSERT_TRUE(save(directory / "song-v2.uapmd", true));
+    EXPECT_TRUE(fs::exists(blobPath("song-v2.uapmd", copyState)));
+    EXPECT_TRUE(fs::exists(blobPath("song.uapmd", songState)));
+}
+
 TEST_F(SequencerEngineOutputTest, PluginPropertiesStateAndLifecycleUndoAndRedo) {
     ScopedTestEventLoop eventLoop;
     auto pluginHost = std::make_unique<TestPluginHostingAPI>();
@@ -1835,6 +2296,17 @@ TEST_F(SequencerEngineOutputTest, PluginPropertiesStateAndLifecycleUndoAndRedo)
     ASSERT_TRUE(result->succeeded()) << result->error;
     EXPECT_TRUE(plugin->bypassed());
 
+    ASSERT_TRUE(timeline.commands().setPluginSleepsWhenSilent(*instanceId, true));
+    EXPECT_TRUE(plugin->sleepsWhenSilent());
+    result = moveAndDrain(false);
+    ASSERT_TRUE(result.has_value());
+    ASSERT_TRUE(result->succeeded()) << result->error;
+    EXPECT_FALSE(plugin->sleepsWhenSilent());
+    result = moveAndDrain(true);
+    ASSERT_TRUE(result.has_value());
+    ASSERT_TRUE(result->succeeded()) << result->error;
+    EXPECT_TRUE(plugin->sleepsWhenSilent());
+
     ASSERT_TRUE(timeline.commands().setPluginParameterValue(*instanceId, 4, 0.75));
     EXPECT_DOUBLE_EQ(plugin->getParameterValue(4), 0.75);
     result = moveAndDrain(false);
@@ -2253,6 +2725,8 @@ TEST_F(SequencerEngineOutputTest, PluginUndoableActionsResolveRestoredInstanceBy
         engine->getPluginInstance(*originalInstanceId));
     ASSERT_NE(original, nullptr);
     original->setStateFromHost({1});
+    // Not through a command, so that the undo steps below stay as they are.
+    original->sleepsWhenSilent(true);
 
     auto drain = [] {
         for (int i = 0; i < 100; ++i) {
@@ -2330,6 +2804,7 @@ TEST_F(SequencerEngineOutputTest, PluginUndoableActionsResolveRestoredInstanceBy
         engine->getPluginInstance(restoredInstanceId));
     ASSERT_NE(restored, nullptr);
     EXPECT_TRUE(restored->bypassed());
+    EXPECT_TRUE(restored->sleepsWhenSilent());
     EXPECT_EQ(timeline.commands().history().state().undoDescription, "Load plug-in preset");
 
     result = undoAndDrain();
@@ -3175,6 +3650,333 @@ TEST_F(SequencerEngineOutputTest, ClipMutationsRevokeTheTracksFrozenRender) {
         generationBeforeGraphChange);
 }
 
+TEST_F(SequencerEngineOutputTest, FrozenTrackCacheFileRoundTripsSampleFormats) {
+    using SampleFormat = uapmd::FrozenTrackManager::CacheSampleFormat;
+    constexpr int64_t kBlock = uapmd::FrozenTrackCacheFile::kFramesPerBlock;
+    constexpr int64_t frameCount = kBlock * 2 + kBlock / 2;
+    constexpr int64_t chunk = 300;
+    // Above 0 dBFS, as a track ahead of the master can be.
+    const auto sampleAt = [](uint32_t channel, int64_t frame) {
+        return static_cast<float>(channel + 1) * 0.75f * std::sin(0.01f * static_cast<float>(frame));
+    };
+    const std::vector<std::pair<SampleFormat, float>> formats{
+        {SampleFormat::Float32, 0.0f},
+        // The 24-bit step is near float precision at this level.
+        {SampleFormat::PCM24, 1.0e-6f},
+        {SampleFormat::PCM16, 1.5f / 32767.0f},
+    };
+    for (const auto& [format, tolerance] : formats) {
+        SCOPED_TRACE(static_cast<int>(format));
+        const auto path = test_dir_ / std::format("cache-{}.ufz", static_cast<int>(format));
+        std::string error;
+        {
+            uapmd::FrozenTrackCacheFileWriter writer;
+            ASSERT_TRUE(writer.open(path, format, 48000, 100, frameCount, error)) << error;
+            // Chunks that straddle the block boundaries.
+            std::vector<float> left(chunk), right(chunk);
+            for (int64_t frame = 0; frame < frameCount; frame += chunk) {
+                const auto count = std::min(chunk, frameCount - frame);
+                for (int64_t i = 0; i < count; ++i) {
+                    left[static_cast<size_t>(i)] = sampleAt(0, frame + i);
+                    right[static_cast<size_t>(i)] = sampleAt(1, frame + i);
+                }
+                const float* channels[]{left.data(), right.data()};
+                ASSERT_TRUE(writer.append(channels, 2, static_cast<int32_t>(count), error)) << error;
+            }
+            ASSERT_TRUE(writer.finish({2}, error)) << error;
+        }
+        EXPECT_FALSE(fs::exists(fs::path(path.string() + ".part")));
+
+        auto file = uapmd::FrozenTrackCacheFile::open(path, error);
+        ASSERT_NE(file, nullptr) << error;
+        EXPECT_EQ(file->sampleFormat(), format);
+        EXPECT_EQ(file->sampleRate(), 48000);
+        EXPECT_EQ(file->startSample(), 100);
+        EXPECT_EQ(file->frameCount(), frameCount);
+        EXPECT_EQ(file->channelCount(), 2u);
+        EXPECT_EQ(file->busChannelCounts(), std::vector<uint32_t>{2});
+
+        const auto verify = [&](const char* when) {
+            SCOPED_TRACE(when);
+            // From before the start to past the end.
+            std::vector<float> read(static_cast<size_t>(frameCount + 64), 1.0f);
+            for (uint32_t channel = 0; channel < 2; ++channel) {
+                file->read(channel, -32, read.data(), static_cast<int32_t>(read.size()));
+                for (int64_t frame = -32; frame < frameCount + 32; ++frame) {
+                    const auto value = read[static_cast<size_t>(frame + 32)];
+                    if (frame < 0 || frame >= frameCount)
+                        ASSERT_EQ(value, 0.0f) << "frame=" << frame;
+                    else
+                        ASSERT_NEAR(value, sampleAt(channel, frame), tolerance)
+                            << "channel=" << channel << " frame=" << frame;
+                }
+            }
+        };
+        verify("mapped");
+        // Residency hints never change what is read.
+        file->evict(0, frameCount);
+        verify("evicted");
+        file->prefetch(kBlock / 2, kBlock);
+        file->evict(kBlock + 1, 1);
+        verify("prefetched");
+    }
+}
+
+TEST_F(SequencerEngineOutputTest, FrozenTrackRenderIsRestoredFromTheSavedProject) {
+    constexpr int32_t sampleRate = 48000;
+    constexpr uint32_t bufferSize = 256;
+    constexpr uint32_t umpBufferSize = 65536;
+    using RuntimeState = uapmd::FrozenTrackManager::RuntimeState;
+
+    ScopedTestEventLoop eventLoop;
+    const auto pumpUntil = [](auto&& done) {
+        for (int attempt = 0; attempt < 10000 && !done(); ++attempt) {
+            remidy::EventLoop::processQueuedTasks();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return done();
+    };
+    const auto save = [&](uapmd::SequencerEngine& engine, const fs::path& projectFile) {
+        std::optional<uapmd::TimelineFacade::ProjectResult> saved;
+        uapmd::TimelineFacade::ProjectSaveOptions options;
+        options.emitDocumentEvent = false;
+        engine.timeline().saveProject(projectFile, std::move(options), [&](auto result) {
+            saved = std::move(result);
+        });
+        pumpUntil([&] { return saved.has_value(); });
+        return saved.has_value() && saved->success;
+    };
+    const auto findRender = [](const fs::path& directory) {
+        for (const auto& entry : fs::recursive_directory_iterator(directory))
+            if (entry.path().extension() == ".ufz")
+                return entry.path();
+        return fs::path{};
+    };
+
+    auto engine = uapmd::SequencerEngine::create(sampleRate, bufferSize, umpBufferSize);
+    ASSERT_NE(engine, nullptr);
+    engine->setEngineActive(true);
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
+    ASSERT_TRUE(addFragmentTestClip(*engine, trackIndex, sampleRate).success);
+    auto& frozen = engine->frozenTrackManager();
+    ASSERT_TRUE(frozen.setFreezePolicyForTrack(trackIndex, uapmd::FrozenTrackManager::FreezePolicy::On));
+    ASSERT_TRUE(pumpUntil([&] { return frozen.runtimeStateForTrack(trackIndex) == RuntimeState::Frozen; }))
+        << frozen.errorMessageForTrack(trackIndex);
+
+    const auto firstProject = test_dir_ / "frozen-first" / "project.uapmd";
+    ASSERT_TRUE(save(*engine, firstProject));
+    const auto savedRender = findRender(firstProject.parent_path());
+    ASSERT_FALSE(savedRender.empty());
+
+    // Replace the saved render with one the track could not have produced (it
+    // has no instrument, so it renders silence), in the integer format.
+    std::string error;
+    auto original = uapmd::FrozenTrackCacheFile::open(savedRender, error);
+    ASSERT_NE(original, nullptr) << error;
+    const auto frameCount = original->frameCount();
+    const auto channelCount = original->channelCount();
+    const auto startSample = original->startSample();
+    const auto busChannelCounts = original->busChannelCounts();
+    original.reset();
+    {
+        uapmd::FrozenTrackCacheFileWriter writer;
+        ASSERT_TRUE(writer.open(savedRender, uapmd::FrozenTrackManager::CacheSampleFormat::PCM16,
+                                sampleRate, startSample, frameCount, error)) << error;
+        std::vector<float> constant(static_cast<size_t>(frameCount), 0.25f);
+        std::vector<const float*> channels(channelCount, constant.data());
+        ASSERT_TRUE(writer.append(channels.data(), channelCount, static_cast<int32_t>(frameCount), error)) << error;
+        ASSERT_TRUE(writer.finish(busChannelCounts, error)) << error;
+    }
+    engine.reset();
+
+    auto restored = uapmd::SequencerEngine::create(sampleRate, bufferSize, umpBufferSize);
+    ASSERT_NE(restored, nullptr);
+    restored->setEngineActive(true);
+    std::optional<uapmd::TimelineFacade::ProjectResult> loaded;
+    restored->timeline().loadProject(firstProject, [&](auto result) { loaded = std::move(result); });
+    ASSERT_TRUE(pumpUntil([&] { return loaded.has_value(); }));
+    ASSERT_TRUE(loaded->success) << loaded->error;
+    ASSERT_EQ(restored->tracks().size(), 1u);
+    auto& restoredFrozen = restored->frozenTrackManager();
+    ASSERT_TRUE(pumpUntil([&] { return restoredFrozen.runtimeStateForTrack(0) == RuntimeState::Frozen; }))
+        << restoredFrozen.errorMessageForTrack(0);
+
+    // Saving again copies the render in use: the one from disk, not a new one.
+    const auto secondProject = test_dir_ / "frozen-second" / "project.uapmd";
+    ASSERT_TRUE(save(*restored, secondProject));
+    const auto copiedRender = findRender(secondProject.parent_path());
+    ASSERT_FALSE(copiedRender.empty());
+    auto copy = uapmd::FrozenTrackCacheFile::open(copiedRender, error);
+    ASSERT_NE(copy, nullptr) << error;
+    EXPECT_EQ(copy->sampleFormat(), uapmd::FrozenTrackManager::CacheSampleFormat::PCM16);
+    ASSERT_EQ(copy->frameCount(), frameCount);
+    std::vector<float> read(static_cast<size_t>(frameCount));
+    copy->read(0, 0, read.data(), static_cast<int32_t>(read.size()));
+    for (const auto value : read)
+        ASSERT_FLOAT_EQ(value, 0.25f);
+}
+
+TEST_F(SequencerEngineOutputTest, SavingAgainLeavesAnUnchangedFrozenRenderInPlace) {
+    constexpr int32_t sampleRate = 48000;
+    using RuntimeState = uapmd::FrozenTrackManager::RuntimeState;
+
+    ScopedTestEventLoop eventLoop;
+    const auto pumpUntil = [](auto&& done) {
+        for (int attempt = 0; attempt < 10000 && !done(); ++attempt) {
+            remidy::EventLoop::processQueuedTasks();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return done();
+    };
+    auto engine = uapmd::SequencerEngine::create(sampleRate, 256, 65536);
+    ASSERT_NE(engine, nullptr);
+    engine->setEngineActive(true);
+    const auto save = [&](const fs::path& projectFile) {
+        std::optional<uapmd::TimelineFacade::ProjectResult> saved;
+        uapmd::TimelineFacade::ProjectSaveOptions options;
+        options.emitDocumentEvent = false;
+        engine->timeline().saveProject(projectFile, std::move(options), [&](auto result) {
+            saved = std::move(result);
+        });
+        pumpUntil([&] { return saved.has_value(); });
+        return saved.has_value() && saved->success;
+    };
+    const auto findRender = [](const fs::path& directory) {
+        for (const auto& entry : fs::recursive_directory_iterator(directory))
+            if (entry.path().extension() == ".ufz")
+                return entry.path();
+        return fs::path{};
+    };
+
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
+    ASSERT_TRUE(addFragmentTestClip(*engine, trackIndex, sampleRate).success);
+    auto& frozen = engine->frozenTrackManager();
+    ASSERT_TRUE(frozen.setFreezePolicyForTrack(trackIndex, uapmd::FrozenTrackManager::FreezePolicy::On));
+    ASSERT_TRUE(pumpUntil([&] { return frozen.runtimeStateForTrack(trackIndex) == RuntimeState::Frozen; }))
+        << frozen.errorMessageForTrack(trackIndex);
+
+    const auto projectFile = test_dir_ / "frozen-resave" / "project.uapmd";
+    ASSERT_TRUE(save(projectFile));
+    const auto savedRender = findRender(projectFile.parent_path());
+    ASSERT_FALSE(savedRender.empty());
+    // A copy replaces the file under a new inode, which the witness would no
+    // longer share.
+    const auto witness = test_dir_ / "witness.ufz";
+    fs::create_hard_link(savedRender, witness);
+
+    ASSERT_TRUE(save(projectFile));
+    EXPECT_EQ(fs::hard_link_count(witness), 2u);
+
+    // A new render is copied over the old one.
+    const auto generation = frozen.invalidationGenerationForTrack(trackIndex);
+    engine->markTrackDirty(trackIndex);
+    ASSERT_TRUE(pumpUntil([&] {
+        return frozen.invalidationGenerationForTrack(trackIndex) != generation &&
+            frozen.runtimeStateForTrack(trackIndex) == RuntimeState::Frozen;
+    })) << frozen.errorMessageForTrack(trackIndex);
+    ASSERT_TRUE(save(projectFile));
+    EXPECT_EQ(fs::hard_link_count(witness), 1u);
+}
+
+TEST_F(SequencerEngineOutputTest, AutoFreezeSchedulerFreezesOverBudgetTracksUntilEdited) {
+    constexpr int32_t sampleRate = 48000;
+    constexpr uint32_t bufferSize = 256;
+    constexpr uint32_t umpBufferSize = 65536;
+
+    ScopedTestEventLoop eventLoop;
+    auto engine = uapmd::SequencerEngine::create(sampleRate, bufferSize, umpBufferSize);
+    ASSERT_NE(engine, nullptr);
+    engine->setEngineActive(true);
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
+    ASSERT_TRUE(addFragmentTestClip(*engine, trackIndex, sampleRate).success);
+    auto& frozen = engine->frozenTrackManager();
+    auto& scheduler = engine->autoFreezeScheduler();
+
+    remidy::AudioProcessContext process(
+        engine->data().masterContext(), umpBufferSize);
+    process.configureMainBus(2, 2, bufferSize);
+    process.frameCount(bufferSize);
+    const auto processBlocks = [&] {
+        for (int block = 0; block < 8; ++block)
+            engine->processAudio(process);
+    };
+
+    // Any measurable cost exceeds a zero budget.
+    scheduler.setCpuBudget(0.0);
+    scheduler.setEnabled(true);
+    scheduler.evaluate(); // first window only learns the track layout
+    processBlocks();
+    scheduler.evaluate();
+    EXPECT_GT(scheduler.totalLoad(), 0.0);
+    EXPECT_TRUE(scheduler.isAutoFrozen(trackIndex));
+    EXPECT_EQ(frozen.freezePolicyForTrack(trackIndex), uapmd::FrozenTrackManager::FreezePolicy::On);
+
+    // Editing brings the track back and keeps it live while the edit hold lasts.
+    engine->markTrackDirty(trackIndex);
+    EXPECT_FALSE(scheduler.isAutoFrozen(trackIndex));
+    EXPECT_EQ(frozen.freezePolicyForTrack(trackIndex), uapmd::FrozenTrackManager::FreezePolicy::Off);
+    processBlocks();
+    scheduler.evaluate();
+    EXPECT_FALSE(scheduler.isAutoFrozen(trackIndex));
+    EXPECT_EQ(frozen.freezePolicyForTrack(trackIndex), uapmd::FrozenTrackManager::FreezePolicy::Off);
+
+    // A track the user froze is not the scheduler's to release.
+    scheduler.setEditHoldDuration(std::chrono::milliseconds{0});
+    ASSERT_TRUE(frozen.setFreezePolicyForTrack(trackIndex, uapmd::FrozenTrackManager::FreezePolicy::On));
+    scheduler.setEnabled(false);
+    EXPECT_EQ(frozen.freezePolicyForTrack(trackIndex), uapmd::FrozenTrackManager::FreezePolicy::On);
+}
+
+TEST_F(SequencerEngineOutputTest, AutoFreezeSchedulerSkipsTracksThatCannotBeFrozen) {
+    constexpr int32_t sampleRate = 48000;
+    constexpr uint32_t bufferSize = 256;
+    constexpr uint32_t umpBufferSize = 65536;
+
+    ScopedTestEventLoop eventLoop;
+    auto engine = uapmd::SequencerEngine::create(sampleRate, bufferSize, umpBufferSize);
+    ASSERT_NE(engine, nullptr);
+    engine->setEngineActive(true);
+    const auto returnTrack = engine->addEmptyTrack();
+    const auto emptyTrack = engine->addEmptyTrack();
+    const auto playedTrack = engine->addEmptyTrack();
+    ASSERT_GE(returnTrack, 0);
+    ASSERT_GE(emptyTrack, 0);
+    ASSERT_GE(playedTrack, 0);
+    ASSERT_TRUE(addFragmentTestClip(*engine, returnTrack, sampleRate).success);
+    ASSERT_TRUE(addFragmentTestClip(*engine, playedTrack, sampleRate).success);
+    ASSERT_TRUE(engine->setTrackIsReturn(returnTrack, true));
+    auto& frozen = engine->frozenTrackManager();
+    auto& scheduler = engine->autoFreezeScheduler();
+    EXPECT_FALSE(frozen.canFreezeTrack(returnTrack));
+    EXPECT_FALSE(frozen.canFreezeTrack(emptyTrack));
+    EXPECT_TRUE(frozen.canFreezeTrack(playedTrack));
+
+    remidy::AudioProcessContext process(
+        engine->data().masterContext(), umpBufferSize);
+    process.configureMainBus(2, 2, bufferSize);
+    process.frameCount(bufferSize);
+
+    scheduler.setCpuBudget(0.0);
+    scheduler.setEnabled(true);
+    scheduler.evaluate();
+    for (int block = 0; block < 8; ++block)
+        engine->processAudio(process);
+    scheduler.evaluate();
+
+    // Only the track a render accepts is frozen; the others keep their Off
+    // policy instead of ending in an error.
+    for (const auto trackIndex : {returnTrack, emptyTrack}) {
+        EXPECT_FALSE(scheduler.isAutoFrozen(trackIndex));
+        EXPECT_EQ(frozen.freezePolicyForTrack(trackIndex), uapmd::FrozenTrackManager::FreezePolicy::Off);
+        EXPECT_NE(frozen.runtimeStateForTrack(trackIndex), uapmd::FrozenTrackManager::RuntimeState::Error);
+    }
+    EXPECT_TRUE(scheduler.isAutoFrozen(playedTrack));
+    scheduler.setEnabled(false);
+}
+
 TEST_F(SequencerEngineOutputTest, PluginRemovalNotifiesListenersWithoutHoldingInstanceMapLock) {
     auto engine = uapmd::SequencerEngine::create(48000, 256, 65536);
     ASSERT_NE(engine, nullptr);
@@ -3205,4 +4007,706 @@ TEST_F(SequencerEngineOutputTest, PluginRemovalNotifiesListenersWithoutHoldingIn
     EXPECT_EQ(listener.observedInstance_, nullptr);
 }
 
+TEST_F(SequencerEngineOutputTest, AutomationCurveEmitsPointsAndSteppedRamps) {
+    const uapmd::AutomationCurve curve({
+        {100, 1.0, uapmd::AutomationInterpolation::Hold},
+        {0, 0.0},
+        {64, 0.5},
+    });
+    EXPECT_DOUBLE_EQ(curve.valueAt(-10), 0.0);
+    EXPECT_DOUBLE_EQ(curve.valueAt(32), 0.25);
+    EXPECT_DOUBLE_EQ(curve.valueAt(80), 0.5 + 0.5 * 16.0 / 36.0);
+    EXPECT_DOUBLE_EQ(curve.valueAt(1000), 1.0);
+
+    std::vector<std::pair<int32_t, double>> changes;
+    curve.forEachChange(48, 64, 32, [&](int32_t frame, double value) {
+        changes.emplace_back(frame, value);
+    });
+    // Ramp from 48, the point at 64, a ramp step at 96, the point at 100.
+    ASSERT_EQ(changes.size(), 4u);
+    EXPECT_EQ(changes[0].first, 0);
+    EXPECT_DOUBLE_EQ(changes[0].second, 0.375);
+    EXPECT_EQ(changes[1].first, 16);
+    EXPECT_DOUBLE_EQ(changes[1].second, 0.5);
+    EXPECT_EQ(changes[2].first, 48);
+    EXPECT_EQ(changes[3].first, 52);
+    EXPECT_DOUBLE_EQ(changes[3].second, 1.0);
+}
+
+TEST_F(SequencerEngineOutputTest, ParameterAutomationReachesThePluginAtItsFrameOffsets) {
+    ScopedTestEventLoop eventLoop;
+    auto engine = uapmd::SequencerEngine::createWithPluginHost(
+        48000, 256, 65536, std::make_unique<TestPluginHostingAPI>());
+    ASSERT_NE(engine, nullptr);
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
+    std::string format = "Test";
+    std::string pluginId = "test.plugin";
+    std::optional<int32_t> instanceId;
+    engine->addPluginToTrack(trackIndex, format, pluginId,
+        [&](int32_t id, int32_t, std::string) { instanceId = id; });
+    ASSERT_TRUE(instanceId.has_value());
+    auto* plugin = dynamic_cast<MutableTimingPlugin*>(engine->getPluginInstance(*instanceId));
+    ASSERT_NE(plugin, nullptr);
+
+    auto* automation = engine->parameterAutomationManager();
+    ASSERT_NE(automation, nullptr);
+    EXPECT_FALSE(automation->setLane(*instanceId + 1000, 2, {{0, 0.0}}));
+    ASSERT_TRUE(automation->setLane(*instanceId, 2, {
+        {0, 0.2, uapmd::AutomationInterpolation::Hold},
+        {1000, 0.9, uapmd::AutomationInterpolation::Hold},
+    }));
+    ASSERT_EQ(automation->lanes(trackIndex).size(), 1u);
+
+    std::vector<uapmd::ParameterAutomationEvent> events;
+    events.reserve(uapmd::ParameterAutomationManager::kEventCapacityPerBlock);
+    // Two segments of one block, as a loop wrap renders them.
+    automation->render(trackIndex, 900, 0, 128, events);
+    automation->render(trackIndex, 0, 128, 128, events);
+    automation->apply(trackIndex, events);
+    EXPECT_TRUE(events.empty());
+
+    const auto& changes = plugin->rtParameterChanges();
+    ASSERT_EQ(changes.size(), 3u);
+    EXPECT_EQ(changes[0].timestamp, 0);
+    EXPECT_DOUBLE_EQ(changes[0].value, 0.2);
+    EXPECT_EQ(changes[1].timestamp, 100);
+    EXPECT_DOUBLE_EQ(changes[1].value, 0.9);
+    EXPECT_EQ(changes[2].timestamp, 128);
+    EXPECT_DOUBLE_EQ(changes[2].value, 0.2);
+    for (const auto& change : changes)
+        EXPECT_EQ(change.index, 2);
+
+    EXPECT_TRUE(engine->removePluginInstance(*instanceId));
+    EXPECT_TRUE(automation->lanes(trackIndex).empty());
+}
+
+TEST_F(SequencerEngineOutputTest, ParameterAutomationSendsOnlyChangesBetweenRestates) {
+    ScopedTestEventLoop eventLoop;
+    auto engine = uapmd::SequencerEngine::createWithPluginHost(
+        48000, 256, 65536, std::make_unique<TestPluginHostingAPI>());
+    ASSERT_NE(engine, nullptr);
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
+    std::string format = "Test";
+    std::string pluginId = "test.plugin";
+    std::optional<int32_t> instanceId;
+    engine->addPluginToTrack(trackIndex, format, pluginId,
+        [&](int32_t id, int32_t, std::string) { instanceId = id; });
+    ASSERT_TRUE(instanceId.has_value());
+
+    auto* automation = engine->parameterAutomationManager();
+    ASSERT_NE(automation, nullptr);
+    ASSERT_TRUE(automation->setLane(*instanceId, 2, {
+        {0, 0.2, uapmd::AutomationInterpolation::Hold},
+        {1000, 0.9, uapmd::AutomationInterpolation::Hold},
+    }));
+
+    std::vector<uapmd::ParameterAutomationEvent> events;
+    events.reserve(uapmd::ParameterAutomationManager::kEventCapacityPerBlock);
+    const auto renderBlock = [&](int64_t start) {
+        events.clear();
+        automation->render(trackIndex, start, 0, 256, events);
+        return events.size();
+    };
+
+    // The first block states the value, the following ones only changes.
+    EXPECT_EQ(renderBlock(0), 1u);
+    EXPECT_EQ(renderBlock(256), 0u);
+    EXPECT_EQ(renderBlock(512), 0u);
+    ASSERT_EQ(renderBlock(768), 1u);
+    EXPECT_EQ(events[0].frameOffset, 232);
+    EXPECT_DOUBLE_EQ(events[0].value, 0.9);
+    EXPECT_EQ(renderBlock(1024), 0u);
+
+    // A jump, as a loop wrap renders it.
+    ASSERT_EQ(renderBlock(0), 1u);
+    EXPECT_DOUBLE_EQ(events[0].value, 0.2);
+    // A transport transition.
+    engine->playbackPosition(256);
+    EXPECT_EQ(renderBlock(256), 1u);
+    EXPECT_EQ(renderBlock(512), 0u);
+    // Blocks of the previous transport generation were discarded.
+    automation->liveTransportGeneration(1000);
+    EXPECT_EQ(renderBlock(768), 2u);
+    EXPECT_EQ(renderBlock(1024), 0u);
+
+    // A full buffer drops and counts the event; the lane restates next time.
+    std::vector<uapmd::ParameterAutomationEvent> full;
+    automation->render(trackIndex, 1280, 0, 256, full);
+    EXPECT_TRUE(full.empty());
+    EXPECT_EQ(automation->droppedEventCount(), 0u);
+    automation->restateAll();
+    ASSERT_EQ(full.capacity(), 0u);
+    automation->render(trackIndex, 1536, 0, 256, full);
+    EXPECT_EQ(automation->droppedEventCount(), 1u);
+    EXPECT_EQ(renderBlock(1792), 1u);
+    EXPECT_DOUBLE_EQ(events[0].value, 0.9);
+
+    // The offline render reader keeps its own position.
+    events.clear();
+    automation->render(trackIndex, 2048, 0, 256, events, uapmd::ParameterAutomationManager::kRenderReader);
+    EXPECT_EQ(events.size(), 1u);
+    EXPECT_EQ(renderBlock(2048), 0u);
+
+    EXPECT_TRUE(engine->removePluginInstance(*instanceId));
+}
+
+TEST_F(SequencerEngineOutputTest, SampleRateChangeReconfiguresPluginsInPlace) {
+    ScopedTestEventLoop eventLoop;
+    auto engine = uapmd::SequencerEngine::createWithPluginHost(
+        48000, 256, 65536, std::make_unique<TestPluginHostingAPI>());
+    ASSERT_NE(engine, nullptr);
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
+    std::string format = "Test";
+    std::string pluginId = "test.plugin";
+    std::optional<int32_t> instanceId;
+    engine->addPluginToTrack(trackIndex, format, pluginId,
+        [&](int32_t id, int32_t, std::string) { instanceId = id; });
+    ASSERT_TRUE(instanceId.has_value());
+    auto* plugin = dynamic_cast<MutableTimingPlugin*>(engine->getPluginInstance(*instanceId));
+    ASSERT_NE(plugin, nullptr);
+
+    engine->setSampleRate(48000);
+    EXPECT_FALSE(plugin->reconfiguredSampleRate().has_value());
+
+    engine->setSampleRate(96000);
+    // The same instance keeps running at the new rate.
+    EXPECT_EQ(engine->getPluginInstance(*instanceId), plugin);
+    EXPECT_EQ(plugin->reconfiguredSampleRate(), 96000u);
+    EXPECT_EQ(plugin->reconfiguredBufferSize(), 256u);
+}
+
+TEST_F(SequencerEngineOutputTest, PluginReconfigurationWhileProcessingAudio) {
+    ScopedTestEventLoop eventLoop;
+    for (const bool live : {false, true}) {
+        SCOPED_TRACE(live ? "live reconfiguration" : "stop and restart");
+        FakeRemidyPluginFormat format{live};
+        auto host = uapmd_plugin_hosting::AudioPluginHostingAPI::create();
+        host->registerPluginFormat(&format, {format.catalogEntry("fake.plugin")});
+        std::string formatName = format.name();
+        std::string pluginId = "fake.plugin";
+        int32_t instanceId{-1};
+        host->createPluginInstance(48000, 256, 2, 2, false, formatName, pluginId,
+            [&](int32_t id, std::string error) {
+                EXPECT_TRUE(error.empty()) << error;
+                instanceId = id;
+            });
+        ASSERT_GE(instanceId, 0);
+        auto* instance = host->getInstance(instanceId);
+        ASSERT_NE(instance, nullptr);
+        ASSERT_EQ(format.liveInstances().size(), 1u);
+        auto* plugin = format.liveInstances().front();
+        // It has an audio input, so it sleeps by default; silent input would
+        // then stop the blocks counted below.
+        EXPECT_TRUE(instance->sleepsWhenSilent());
+        instance->sleepsWhenSilent(false);
+
+        remidy::MasterContext master{};
+        remidy::AudioProcessContext process{master, 4096};
+        process.configureMainBus(2, 2, 256);
+        process.frameCount(256);
+        std::atomic<bool> stop{false};
+        std::thread audioThread([&] {
+            while (!stop.load(std::memory_order_acquire)) {
+                instance->processAudio(process);
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        });
+
+        const auto blocksBefore = plugin->processedBlocks();
+        for (uint32_t i = 0; i < 20; ++i)
+            EXPECT_EQ(instance->reconfigure(i % 2 ? 96000 : 44100, 256), 0);
+        while (plugin->processedBlocks() < blocksBefore + 10)
+            std::this_thread::yield();
+        stop.store(true, std::memory_order_release);
+        audioThread.join();
+
+        EXPECT_EQ(plugin->sampleRate(), 96000u);
+        EXPECT_TRUE(plugin->processing());
+        if (live) {
+            // configure() alone, with process() carrying on meanwhile.
+            EXPECT_EQ(plugin->stopCount(), 0u);
+            EXPECT_TRUE(plugin->processedDuringConfigure());
+        } else {
+            EXPECT_EQ(plugin->stopCount(), 20u);
+            EXPECT_EQ(plugin->startCount(), 21u);
+            EXPECT_FALSE(plugin->controlOverlappedProcess());
+        }
+        host->deletePluginInstance(instanceId);
+    }
+}
+
+TEST_F(SequencerEngineOutputTest, InstancePoolParksStoppedInstancesAndReusesThem) {
+    ScopedTestEventLoop eventLoop;
+    FakeRemidyPluginFormat format{};
+    auto host = uapmd_plugin_hosting::AudioPluginHostingAPI::create();
+    host->registerPluginFormat(&format, {format.catalogEntry("fake.plugin")});
+    host->instancePoolCapacity(2);
+    std::string formatName = format.name();
+    std::string pluginId = "fake.plugin";
+    const auto create = [&](uint32_t sampleRate, uint32_t bufferSize) {
+        int32_t instanceId{-1};
+        host->createPluginInstance(sampleRate, bufferSize, 2, 2, false, formatName, pluginId,
+            [&](int32_t id, std::string error) {
+                EXPECT_TRUE(error.empty()) << error;
+                instanceId = id;
+            });
+        return instanceId;
+    };
+
+    const auto first = create(48000, 256);
+    ASSERT_GE(first, 0);
+    ASSERT_EQ(format.liveInstances().size(), 1u);
+    auto* plugin = format.liveInstances().front();
+    const auto defaultState = plugin->state();
+    std::vector<uint8_t> changed{1, 2, 3};
+    plugin->setState(changed, remidy::PluginStateSupport::StateContextType::Project, false);
+
+    // Parked: stopped and back to the state it was created with.
+    host->deletePluginInstance(first);
+    EXPECT_EQ(host->getInstance(first), nullptr);
+    ASSERT_EQ(format.liveInstances().size(), 1u);
+    EXPECT_FALSE(plugin->processing());
+    EXPECT_EQ(plugin->stopCount(), 1u);
+    EXPECT_EQ(plugin->startCount(), 1u);
+    EXPECT_EQ(plugin->state(), defaultState);
+
+    // Taken back at another rate: configured while stopped, then started.
+    const auto second = create(96000, 512);
+    ASSERT_GE(second, 0);
+    EXPECT_EQ(format.createdCount(), 1u);
+    EXPECT_EQ(host->getInstance(second)->pluginId(), pluginId);
+    EXPECT_TRUE(plugin->processing());
+    EXPECT_EQ(plugin->configureCount(), 2u);
+    EXPECT_EQ(plugin->sampleRate(), 96000u);
+    EXPECT_EQ(plugin->bufferSize(), 512u);
+    EXPECT_EQ(plugin->stopCount(), 1u);
+    EXPECT_EQ(plugin->startCount(), 2u);
+    EXPECT_FALSE(plugin->controlOverlappedProcess());
+
+    // Another channel layout does not match.
+    int32_t mono{-1};
+    host->createPluginInstance(96000, 512, 1, 1, false, formatName, pluginId,
+        [&](int32_t id, std::string) { mono = id; });
+    ASSERT_GE(mono, 0);
+    EXPECT_EQ(format.createdCount(), 2u);
+
+    host->deletePluginInstance(second);
+    host->deletePluginInstance(mono);
+    EXPECT_EQ(format.liveInstances().size(), 2u);
+    host->clearInstancePool();
+    EXPECT_TRUE(format.liveInstances().empty());
+
+    // Without a capacity, deleting destroys.
+    host->instancePoolCapacity(0);
+    const auto third = create(48000, 256);
+    host->deletePluginInstance(third);
+    EXPECT_TRUE(format.liveInstances().empty());
+}
+
+TEST_F(SequencerEngineOutputTest, InstancePoolPrewarmsStoppedInstances) {
+    ScopedTestEventLoop eventLoop;
+    FakeRemidyPluginFormat format{};
+    auto host = uapmd_plugin_hosting::AudioPluginHostingAPI::create();
+    host->registerPluginFormat(&format, {format.catalogEntry("fake.plugin")});
+    std::string formatName = format.name();
+    std::string pluginId = "fake.plugin";
+
+    // Nothing to keep them in.
+    host->prewarmPluginInstances(48000, 256, 2, 2, false, formatName, pluginId, 2);
+    remidy::EventLoop::processQueuedTasks();
+    EXPECT_EQ(format.createdCount(), 0u);
+
+    host->instancePoolCapacity(4);
+    host->prewarmPluginInstances(48000, 256, 2, 2, false, formatName, pluginId, 2);
+    // One main thread task per instance.
+    EXPECT_EQ(format.createdCount(), 0u);
+    remidy::EventLoop::processQueuedTasks();
+    ASSERT_EQ(format.createdCount(), 2u);
+    for (auto* plugin : format.liveInstances()) {
+        EXPECT_FALSE(plugin->processing());
+        EXPECT_EQ(plugin->stopCount(), 1u);
+    }
+
+    // Already warm.
+    host->prewarmPluginInstances(48000, 256, 2, 2, false, formatName, pluginId, 2);
+    remidy::EventLoop::processQueuedTasks();
+    EXPECT_EQ(format.createdCount(), 2u);
+
+    int32_t instanceId{-1};
+    host->createPluginInstance(48000, 256, 2, 2, false, formatName, pluginId,
+        [&](int32_t id, std::string) { instanceId = id; });
+    ASSERT_GE(instanceId, 0);
+    EXPECT_EQ(format.createdCount(), 2u);
+    const auto processing = std::ranges::count_if(format.liveInstances(),
+        [](FakeRemidyPlugin* plugin) { return plugin->processing(); });
+    EXPECT_EQ(processing, 1);
+    // Same rate and buffer size: no reconfiguration.
+    for (auto* plugin : format.liveInstances())
+        EXPECT_EQ(plugin->configureCount(), 1u);
+    host->deletePluginInstance(instanceId);
+}
+
+TEST_F(SequencerEngineOutputTest, BundlePoolUnloadsLeastRecentlyReleasedBundlesOverBudget) {
+    ScopedTestEventLoop eventLoop;
+    const auto makeBundle = [this](const char* name, size_t size) {
+        auto path = test_dir_ / name;
+        std::ofstream(path, std::ios::binary) << std::string(size, '\0');
+        return path;
+    };
+    auto a = makeBundle("a.clap", 100);
+    auto b = makeBundle("b.clap", 100);
+    auto c = makeBundle("c.clap", 100);
+
+    int module{0};
+    std::vector<fs::path> unloaded;
+    std::function<remidy::StatusCode(fs::path&, void**)> load = [&module](fs::path&, void** result) {
+        *result = &module;
+        return remidy::StatusCode::OK;
+    };
+    std::function<remidy::StatusCode(fs::path&, void*)> unload = [&unloaded](fs::path& path, void*) {
+        unloaded.push_back(path);
+        return remidy::StatusCode::OK;
+    };
+    remidy::PluginBundlePool pool{load, unload};
+    pool.setRetentionPolicy(remidy::PluginBundlePool::RetainWithinBudget);
+    pool.setRetentionBudget(250);
+
+    bool loadedAsNew{false};
+    for (auto* path : {&a, &b, &c}) {
+        ASSERT_NE(pool.loadOrAddReference(*path, &loadedAsNew), nullptr);
+        EXPECT_TRUE(loadedAsNew);
+    }
+    pool.removeReference(a);
+    pool.removeReference(b);
+    EXPECT_TRUE(unloaded.empty());
+    EXPECT_EQ(pool.retainedSizeInBytes(), 200u);
+
+    // A retained bundle comes back without loading, and counts as recently used.
+    pool.loadOrAddReference(a, &loadedAsNew);
+    EXPECT_FALSE(loadedAsNew);
+    pool.removeReference(a);
+
+    pool.removeReference(c);
+    ASSERT_EQ(unloaded.size(), 1u);
+    EXPECT_EQ(unloaded[0], b);
+    EXPECT_EQ(pool.retainedSizeInBytes(), 200u);
+}
+
+TEST_F(SequencerEngineOutputTest, SilentPluginSleepsAfterItsTailAndWakesOnInput) {
+    constexpr int32_t sampleRate = 48000;
+    constexpr int32_t bufferSize = 512;
+    remidy::MasterContext master;
+    master.sampleRate(sampleRate);
+    remidy::AudioProcessContext process(master, 1024);
+    process.configureMainBus(2, 2, bufferSize);
+    process.frameCount(bufferSize);
+
+    // Stands in for a reverb: the output level halves every block and input
+    // brings it back up.
+    uapmd_plugin_hosting::SilenceSleepTracker tracker;
+    EXPECT_FALSE(tracker.enabled());
+    tracker.enabled(true);
+    double tail = 0.5;
+    double level = 0.0;
+    int processedBlocks = 0;
+    const auto runBlock = [&](float input) {
+        for (uint32_t ch = 0; ch < 2; ++ch)
+            std::fill_n(process.getFloatInBuffer(0, ch), bufferSize, input);
+        if (tracker.beginBlock(process)) {
+            uapmd_plugin_hosting::SilenceSleepTracker::skipBlock(process);
+            return false;
+        }
+        ++processedBlocks;
+        level = std::max(level * 0.5, static_cast<double>(std::abs(input)));
+        for (uint32_t ch = 0; ch < 2; ++ch)
+            std::fill_n(process.getFloatOutBuffer(0, ch), bufferSize, static_cast<float>(level));
+        tracker.endBlock(process, tail);
+        return true;
+    };
+    const auto blocksUntilSleep = [&] {
+        int blocks = 0;
+        while (!tracker.sleeping() && blocks < 1000) {
+            runBlock(0.0f);
+            ++blocks;
+        }
+        return blocks;
+    };
+
+    for (int i = 0; i < 4; ++i)
+        EXPECT_TRUE(runBlock(0.5f));
+    EXPECT_FALSE(tracker.sleeping());
+    EXPECT_EQ(process.inputSilenceFlags(0), 0u);
+
+    // The reported tail is the longer wait here: 0.5 s is 47 blocks.
+    EXPECT_EQ(blocksUntilSleep(), 47);
+    EXPECT_EQ(process.inputSilenceFlags(0), 0b11u);
+    processedBlocks = 0;
+    EXPECT_FALSE(runBlock(0.0f));
+    EXPECT_EQ(processedBlocks, 0);
+    EXPECT_EQ(process.outputSilenceFlags(0), 0b11u);
+    EXPECT_TRUE(std::all_of(process.getFloatOutBuffer(0, 0), process.getFloatOutBuffer(0, 0) + bufferSize,
+                            [](float sample) { return sample == 0.0f; }));
+
+    // Input events wake it.
+    process.eventIn().position(16);
+    EXPECT_TRUE(runBlock(0.0f));
+    process.eventIn().position(0);
+    EXPECT_FALSE(tracker.sleeping());
+    blocksUntilSleep();
+
+    // So do parameter or state changes, and input above -120 dB.
+    tracker.requestWake();
+    EXPECT_TRUE(runBlock(0.0f));
+    blocksUntilSleep();
+    EXPECT_FALSE(runBlock(1.0e-7f));
+    EXPECT_TRUE(runBlock(1.0e-5f));
+
+    // A plugin that reports no tail still sleeps only once its output has
+    // stayed below the threshold: 18 blocks of decay and 10 of hold.
+    tail = 0.0;
+    runBlock(0.5f);
+    EXPECT_EQ(blocksUntilSleep(), 28);
+
+    // An infinite tail never sleeps, and neither does a disabled tracker.
+    tail = std::numeric_limits<double>::infinity();
+    runBlock(0.5f);
+    EXPECT_EQ(blocksUntilSleep(), 1000);
+    tail = 0.0;
+    tracker.enabled(false);
+    runBlock(0.5f);
+    EXPECT_EQ(blocksUntilSleep(), 1000);
+    // Nor does it scan the input; the flags say unknown.
+    EXPECT_EQ(process.inputSilenceFlags(0), 0u);
+}
+
+TEST_F(SequencerEngineOutputTest, LoopedClipsShareContentAndReleaseNotesAtTheWrap) {
+    constexpr int32_t sampleRate = 48000;
+    constexpr int64_t beat = sampleRate / 2; // 120 BPM
+    constexpr int32_t blockFrames = 256;
+
+    // One note held for two beats; the loop below cuts it off after one.
+    uapmd::MidiClipSourceNode node(
+        2001, kFragmentUmp, {0, 0, 960, 960}, 480, 120.0, sampleRate, {}, {});
+    uapmd::MidiClipSourceNode linked(2002, node);
+    EXPECT_TRUE(linked.sharesEventsWith(node));
+    EXPECT_EQ(linked.totalLength(), node.totalLength());
+    // Same tempo map, same schedule: still shared afterwards.
+    node.setPlaybackTempoMap({});
+    linked.setPlaybackTempoMap({});
+    EXPECT_TRUE(linked.sharesEventsWith(node));
+
+    const uapmd::ClipRegion region{0, beat};
+    EXPECT_TRUE(region.loops());
+    EXPECT_EQ(region.sourcePositionAt(beat - 1), beat - 1);
+    EXPECT_EQ(region.sourcePositionAt(beat), 0);
+    EXPECT_EQ(region.sourcePositionAt(2 * beat + 5), 5);
+    EXPECT_EQ((uapmd::ClipRegion{100, 0}).sourcePositionAt(beat), beat + 100);
+
+    remidy::EventSequence events(4096);
+    auto words = [&events] {
+        const auto* data = static_cast<const uint32_t*>(events.getMessages());
+        return std::vector<uint32_t>(data, data + events.position() / sizeof(uint32_t));
+    };
+    linked.setPlaying(true);
+    linked.seek(0);
+    linked.processEvents(events, blockFrames, sampleRate, 120.0);
+    EXPECT_EQ(words(), (std::vector<uint32_t>{0x40903C00u, 0x7FFF0000u}));
+
+    // At the loop end the held note is ended before the source jumps back.
+    events.position(0);
+    linked.processEvents(events, beat - blockFrames, sampleRate, 120.0);
+    linked.releaseHeldNotes(events, blockFrames - 1);
+    EXPECT_EQ(words(), (std::vector<uint32_t>{0x000000FFu | (0x20u << 16), 0x40803C00u, 0x00000000u}));
+    events.position(0);
+    linked.releaseHeldNotes(events);
+    EXPECT_EQ(events.position(), 0u);
+
+    // On the timeline: a linked clip, looped four times, undone as one edit each.
+    auto engine = uapmd::SequencerEngine::create(sampleRate, blockFrames, 65536);
+    ASSERT_NE(engine, nullptr);
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
+    const auto added = addFragmentTestClip(*engine, trackIndex, sampleRate);
+    ASSERT_TRUE(added.success) << added.error;
+    auto& timeline = engine->timeline();
+    const auto copy = timeline.addLinkedClip(
+        trackIndex, uapmd::TimelinePosition::fromSamples(4 * beat, sampleRate), trackIndex, added.clipId);
+    ASSERT_TRUE(copy.success) << copy.error;
+    auto* track = timeline.tracks()[static_cast<size_t>(trackIndex)];
+    auto sourceOf = [track](int32_t clipId) {
+        return std::dynamic_pointer_cast<uapmd::MidiClipSourceNode>(
+            track->getSourceNode(track->clipManager().getClip(clipId)->sourceNodeInstanceId));
+    };
+    ASSERT_NE(sourceOf(copy.clipId), nullptr);
+    EXPECT_TRUE(sourceOf(copy.clipId)->sharesEventsWith(*sourceOf(added.clipId)));
+
+    ASSERT_TRUE(timeline.commands().setClipRegion(trackIndex, copy.clipId, region));
+    ASSERT_TRUE(timeline.commands().resizeClip(trackIndex, copy.clipId, 4 * beat));
+    const auto* looped = track->clipManager().getClip(copy.clipId);
+    EXPECT_EQ(looped->region, region);
+    EXPECT_EQ(looped->durationSamples, 4 * beat);
+    EXPECT_EQ(looped->getSourcePosition(uapmd::TimelinePosition::fromSamples(7 * beat + 3, sampleRate)), 3);
+    EXPECT_FALSE(timeline.commands().setClipRegion(trackIndex, copy.clipId, uapmd::ClipRegion{-1, 0}));
+
+    auto undone = moveHistory(timeline, false);
+    ASSERT_TRUE(undone.has_value() && undone->succeeded());
+    undone = moveHistory(timeline, false);
+    ASSERT_TRUE(undone.has_value() && undone->succeeded());
+    EXPECT_FALSE(track->clipManager().getClip(copy.clipId)->region.loops());
+}
+
+TEST_F(SequencerEngineOutputTest, LinkedClipsAreSavedAsLinksAndShareTheirSourceAfterReload) {
+    constexpr int32_t sampleRate = 48000;
+    constexpr int64_t beat = sampleRate / 2;
+
+    ScopedTestEventLoop eventLoop;
+    const auto pumpUntil = [](auto&& done) {
+        for (int attempt = 0; attempt < 10000 && !done(); ++attempt) {
+            remidy::EventLoop::processQueuedTasks();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return done();
+    };
+
+    auto engine = uapmd::SequencerEngine::create(sampleRate, 256, 65536);
+    ASSERT_NE(engine, nullptr);
+    const auto trackIndex = engine->addEmptyTrack();
+    ASSERT_GE(trackIndex, 0);
+    const auto added = addFragmentTestClip(*engine, trackIndex, sampleRate);
+    ASSERT_TRUE(added.success) << added.error;
+    auto& timeline = engine->timeline();
+    const auto copy = timeline.addLinkedClip(
+        trackIndex, uapmd::TimelinePosition::fromSamples(4 * beat, sampleRate), trackIndex, added.clipId);
+    ASSERT_TRUE(copy.success) << copy.error;
+    ASSERT_TRUE(timeline.commands().resizeClip(trackIndex, copy.clipId, 2 * beat));
+
+    const auto projectFile = test_dir_ / "linked" / "project.uapmd";
+    std::optional<uapmd::TimelineFacade::ProjectResult> saved;
+    uapmd::TimelineFacade::ProjectSaveOptions options;
+    options.emitDocumentEvent = false;
+    timeline.saveProject(projectFile, std::move(options), [&](auto result) { saved = std::move(result); });
+    ASSERT_TRUE(pumpUntil([&] { return saved.has_value(); }));
+    ASSERT_TRUE(saved->success) << saved->error;
+    engine.reset();
+
+    // The copy is written as a link to the original rather than as a second file.
+    auto project = uapmd::UapmdProjectDataReader::read(projectFile);
+    ASSERT_NE(project, nullptr);
+    ASSERT_EQ(project->tracks().size(), 1u);
+    const auto& savedClips = project->tracks()[0]->clips();
+    ASSERT_EQ(savedClips.size(), 2u);
+    EXPECT_TRUE(savedClips[0]->linkedReferenceId().empty());
+    EXPECT_EQ(savedClips[1]->linkedReferenceId(), savedClips[0]->referenceId());
+
+    auto restored = uapmd::SequencerEngine::create(sampleRate, 256, 65536);
+    ASSERT_NE(restored, nullptr);
+    std::optional<uapmd::TimelineFacade::ProjectResult> loaded;
+    restored->timeline().loadProject(projectFile, [&](auto result) { loaded = std::move(result); });
+    ASSERT_TRUE(pumpUntil([&] { return loaded.has_value(); }));
+    ASSERT_TRUE(loaded->success) << loaded->error;
+
+    auto* track = restored->timeline().tracks()[0];
+    auto clips = track->clipManager().getAllClips();
+    ASSERT_EQ(clips.size(), 2u);
+    std::ranges::sort(clips, {}, [](const auto& clip) { return clip.position.samples; });
+    auto sourceOf = [track](const uapmd::ClipData& clip) {
+        return std::dynamic_pointer_cast<uapmd::MidiClipSourceNode>(track->getSourceNode(clip.sourceNodeInstanceId));
+    };
+    ASSERT_NE(sourceOf(clips[0]), nullptr);
+    ASSERT_NE(sourceOf(clips[1]), nullptr);
+    EXPECT_TRUE(sourceOf(clips[1])->sharesEventsWith(*sourceOf(clips[0])));
+    EXPECT_EQ(clips[1].position.samples, 4 * beat);
+    EXPECT_EQ(clips[1].durationSamples, 2 * beat);
+}
+
 } // namespace
+
+TEST_F(SequencerEngineOutputTest, ClapInputEventsAreDeliveredInTimeOrderAtTheirOwnTimes) {
+    // Append order: a note at 100, a parameter value at 20 from the scheduled queue, UMP at 50
+    // after it, then two events at 100 that have to stay behind the first one.
+    const std::vector<uint32_t> times{100, 20, 50, 100, 100, 0};
+    remidy::InputEventOrder order{times.size()};
+    for (uint32_t i = 0; i < times.size(); ++i)
+        ASSERT_TRUE(order.append(i, times[i]));
+    EXPECT_FALSE(order.append(static_cast<uint32_t>(times.size()), 10)) << "appending past the capacity";
+
+    ASSERT_EQ(order.size(), times.size());
+    const std::vector<uint32_t> expected{5, 1, 2, 0, 3, 4};
+    for (size_t position = 0; position < expected.size(); ++position) {
+        EXPECT_EQ(order.indexAt(position), expected[position]) << "position " << position;
+        if (position > 0)
+            EXPECT_LE(times[order.indexAt(position - 1)], times[order.indexAt(position)]);
+    }
+
+    order.clear();
+    EXPECT_EQ(order.size(), 0u);
+    EXPECT_TRUE(order.append(0, 7));
+}
+
+TEST_F(SequencerEngineOutputTest, ParameterChangesReachMidiControllersInOneBatchFromTheWorker) {
+    MutableTimingPlugin plugin;
+    TestPluginNode node{&plugin};
+    auto io = std::make_shared<RecordingMidiIO>();
+    uapmd_midi_service::UapmdFunctionBlock block{io, &node, "Test", "Test", "1.0"};
+
+    MidiServiceWorkerHold hold;
+    plugin.externallySetParameter(1, 0.25);
+    plugin.externallySetParameter(2, 0.5);
+    plugin.externallySetParameter(1, 0.75);
+    EXPECT_TRUE(io->sent().empty()) << "the plugin's parameter callback sent on its own thread";
+    hold.release();
+    drainMidiServiceWorker();
+
+    const auto sent = io->sent();
+    ASSERT_EQ(sent.size(), 1u);
+    EXPECT_NE(sent[0].thread, std::this_thread::get_id());
+    const auto data = [](double value) {
+        return static_cast<uint32_t>(value * static_cast<double>(std::numeric_limits<uint32_t>::max()));
+    };
+    // MIDI 2.0 assignable controllers (NRPN) on group 0, channel 0, bank 0. Parameter 1 keeps its place
+    // of first change, with its latest value.
+    const std::vector<uint32_t> expected{0x40300001u, data(0.75), 0x40300002u, data(0.5)};
+    EXPECT_EQ(sent[0].words, expected);
+
+    block.detachOutputMapper();
+    plugin.externallySetParameter(1, 0.5);
+    drainMidiServiceWorker();
+    EXPECT_EQ(io->sent().size(), 1u);
+}
+
+TEST_F(SequencerEngineOutputTest, MidiCIControlListsAreRebuiltOnlyOnMetadataChanges) {
+    MutableTimingPlugin plugin;
+    TestPluginNode node{&plugin};
+    auto io = std::make_shared<RecordingMidiIO>();
+    uapmd_midi_service::UapmdFunctionBlock block{io, &node, "Test", "Test", "1.0"};
+    block.initialize();
+    drainMidiServiceWorker();
+    ASSERT_EQ(plugin.parameterMetadataListCalls(), 1u);
+
+    {
+        // SysEx reaches the plugin even while the worker is busy with MIDI-CI.
+        MidiServiceWorkerHold hold;
+        const std::vector<uint32_t> identityRequest{0x30047E7Fu, 0x06010000u};
+        io->receive(identityRequest);
+        EXPECT_EQ(node.scheduledBytes(), identityRequest.size() * sizeof(uint32_t));
+
+        plugin.notifyParameterMetadataChanged();
+        plugin.notifyParameterMetadataChanged();
+        plugin.notifyParameterMetadataChanged();
+        EXPECT_EQ(plugin.parameterMetadataListCalls(), 1u);
+    }
+    drainMidiServiceWorker();
+    EXPECT_EQ(plugin.parameterMetadataListCalls(), 2u) << "a burst of changes is one rebuild";
+
+    plugin.notifyParameterMetadataChanged();
+    drainMidiServiceWorker();
+    EXPECT_EQ(plugin.parameterMetadataListCalls(), 3u);
+
+    block.detachOutputMapper();
+    plugin.notifyParameterMetadataChanged();
+    drainMidiServiceWorker();
+    EXPECT_EQ(plugin.parameterMetadataListCalls(), 3u);
+}
@@ -0,0 +1,568 @@
+// uapmd-bench: measures the engine on synthetic sessions built from the
+// in-process test plug-in host, so results do not depend on installed plug-ins
+// or audio devices. Reports audio callback times, offline render throughput and
+// project save/load cost as JSON.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <choc/text/choc_JSON.h>
+#include <cxxopts.hpp>
+#include <umppi/umppi.hpp>
+
+#include "EngineTestSupport.hpp"
+
+namespace fs = std::filesystem;
+using namespace uapmd_test;
+
+namespace {
+
+constexpr uint32_t kUmpBufferSize = 65536;
+constexpr uint32_t kOutputChannels = 2;
+constexpr uint32_t kTicksPerQuarterNote = 480;
+constexpr double kSessionTempo = 120.0;
+constexpr const char* kDagGraphType = "urn:uapmd-graph:common/graph/dag/v1";
+
+enum class GraphShape {
+    // The default linear plug-in list.
+    Chain,
+    // Full DAG whose plug-ins are wired in series.
+    DagSerial,
+    // Full DAG with every plug-in fed by the track input and summed to its output.
+    DagParallel,
+};
+
+struct BenchConfig {
+    int32_t tracks{8};
+    int32_t pluginsPerTrack{2};
+    int32_t clipsPerTrack{4};
+    double clipSeconds{4.0};
+    GraphShape graphShape{GraphShape::Chain};
+    std::string graphShapeName{"chain"};
+    // NRPN parameter changes per second in every clip.
+    double automationPerSecond{0.0};
+    SyntheticProcessingProfile pluginProfile{};
+    int32_t sampleRate{48000};
+    uint32_t bufferSize{256};
+    int32_t callbackBlocks{2000};
+    double renderSeconds{10.0};
+    uint32_t seed{1};
+};
+
+struct Session {
+    std::unique_ptr<uapmd::SequencerEngine> engine;
+    TestPluginHostingAPI* host{nullptr};
+};
+
+std::unique_ptr<uapmd::SequencerEngine> createEngine(
+    const BenchConfig& config, TestPluginHostingAPI*& hostOut) {
+    auto host = std::make_unique<TestPluginHostingAPI>();
+    host->addCatalogEntry("Test", "test.plugin", "Test Plugin");
+    host->processingProfile(config.pluginProfile);
+    hostOut = host.get();
+    auto engine = uapmd::SequencerEngine::createWithPluginHost(
+        config.sampleRate, config.bufferSize, kUmpBufferSize, std::move(host));
+    if (engine)
+        engine->setEngineActive(true);
+    return engine;
+}
+
+void pumpEventLoopUntil(const std::function<bool()>& done) {
+    for (int attempt = 0; attempt < 100000 && !done(); ++attempt) {
+        remidy::EventLoop::processQueuedTasks();
+        if (!done())
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+// Notes on every beat plus evenly spread NRPN changes to the first few
+// parameters, all on group 0 channel 0.
+void buildClipEvents(
+    const BenchConfig& config,
+    std::mt19937& random,
+    std::vector<uapmd_ump_t>& words,
+    std::vector<uint64_t>& ticks) {
+    const auto ticksPerSecond = kTicksPerQuarterNote * kSessionTempo / 60.0;
+    const auto clipTicks = static_cast<uint64_t>(config.clipSeconds * ticksPerSecond);
+    struct Event {
+        uint64_t tick;
+        uint64_t ump;
+    };
+    std::vector<Event> events;
+    std::uniform_int_distribution<int> pitch(36, 84);
+    for (uint64_t tick = 0; tick + kTicksPerQuarterNote / 2 <= clipTicks; tick += kTicksPerQuarterNote) {
+        const auto note = static_cast<uint8_t>(pitch(random));
+        events.push_back({tick, umppi::UmpFactory::midi2NoteOn(0, 0, note, 0, 0xC000, 0)});
+        events.push_back({tick + kTicksPerQuarterNote / 2,
+                          umppi::UmpFactory::midi2NoteOff(0, 0, note, 0, 0, 0)});
+    }
+    const auto automationEvents = static_cast<uint64_t>(config.automationPerSecond * config.clipSeconds);
+    std::uniform_int_distribution<uint32_t> value;
+    for (uint64_t i = 0; i < automationEvents; ++i) {
+        const auto tick = i * clipTicks / automationEvents;
+        const auto index = static_cast<uint8_t>(i % 4);
+        events.push_back({tick, umppi::UmpFactory::midi2NRPN(0, 0, 0, index, value(random))});
+    }
+    std::stable_sort(events.begin(), events.end(),
+                     [](const Event& a, const Event& b) { return a.tick < b.tick; });
+    words.reserve(events.size() * 2);
+    ticks.reserve(events.size() * 2);
+    for (const auto& event : events) {
+        words.push_back(static_cast<uapmd_ump_t>(event.ump >> 32));
+        words.push_back(static_cast<uapmd_ump_t>(event.ump & 0xFFFFFFFFu));
+        ticks.push_back(event.tick);
+        ticks.push_back(event.tick);
+    }
+}
+
+bool wireParallelGraph(
+    uapmd::SequencerEngine& engine,
+    int32_t trackIndex,
+    const std::vector<int32_t>& instanceIds,
+    std::string& error) {
+    auto& timeline = engine.timeline();
+    auto* graph = engine.tracks()[static_cast<size_t>(trackIndex)]
+        ->graph().getExtension<uapmd_graph::GraphConnectionExtension>();
+    if (!graph) {
+        error = "track graph does not support connection editing";
+        return false;
+    }
+    graph->clearConnections();
+    for (const auto instanceId : instanceIds) {
+        const auto address = timeline.addresses().pluginAddress(instanceId);
+        if (!address) {
+            error = "plug-in address not found";
+            return false;
+        }
+        uapmd_graph::AudioPluginGraphConnection input;
+        input.source.type = uapmd_graph::AudioPluginGraphEndpointType::GraphInput;
+        input.target.type = uapmd_graph::AudioPluginGraphEndpointType::Plugin;
+        input.target.instance_id = instanceId;
+        input.target.node_id = address->nodeId;
+        uapmd_graph::AudioPluginGraphConnection output;
+        output.source = input.target;
+        output.target.type = uapmd_graph::AudioPluginGraphEndpointType::GraphOutput;
+        if (!timeline.commands().connectTrackGraph(trackIndex, input, error) ||
+            !timeline.commands().connectTrackGraph(trackIndex, output, error))
+            return false;
+    }
+    return true;
+}
+
+std::optional<Session> buildSession(const BenchConfig& config, std::string& error) {
+    Session session;
+    session.engine = createEngine(config, session.host);
+    if (!session.engine) {
+        error = "failed to create the engine";
+        return std::nullopt;
+    }
+    auto& engine = *session.engine;
+    auto& timeline = engine.timeline();
+    std::mt19937 random(config.seed);
+
+    for (int32_t t = 0; t < config.tracks; ++t) {
+        const auto trackIndex = engine.addEmptyTrack();
+        if (trackIndex < 0) {
+            error = "failed to add a track";
+            return std::nullopt;
+        }
+        if (config.graphShape != GraphShape::Chain &&
+            !timeline.commands().replaceTrackGraphType(
+                trackIndex, kDagGraphType, engine.umpBufferSizeInBytes())) {
+            error = "failed to switch a track to the DAG graph";
+            return std::nullopt;
+        }
+
+        std::vector<int32_t> instanceIds;
+        for (int32_t p = 0; p < config.pluginsPerTrack; ++p) {
+            std::optional<int32_t> instanceId;
+            std::string format = "Test";
+            std::string pluginId = "test.plugin";
+            engine.addPluginToTrack(
+                trackIndex, format, pluginId,
+                [&instanceId, &error](int32_t id, int32_t, std::string addError) {
+                    instanceId = id;
+                    if (!addError.empty())
+                        error = std::move(addError);
+                });
+            pumpEventLoopUntil([&] { return instanceId.has_value(); });
+            if (!instanceId || *instanceId < 0) {
+                if (error.empty())
+                    error = "failed to add a plug-in";
+                return std::nullopt;
+            }
+            instanceIds.push_back(*instanceId);
+        }
+        if (config.graphShape == GraphShape::DagParallel &&
+            !wireParallelGraph(engine, trackIndex, instanceIds, error))
+            return std::nullopt;
+
+        for (int32_t c = 0; c < config.clipsPerTrack; ++c) {
+            std::vector<uapmd_ump_t> words;
+            std::vector<uint64_t> ticks;
+            buildClipEvents(config, random, words, ticks);
+            const auto startSample = static_cast<int64_t>(
+                c * config.clipSeconds * config.sampleRate);
+            auto added = timeline.addMidiClipToTrack(
+                trackIndex,
+                uapmd::TimelinePosition::fromSamples(startSample, config.sampleRate),
+                std::move(words),
+                std::move(ticks),
+                kTicksPerQuarterNote,
+                kSessionTempo,
+                {},
+                {},
+                "Bench Clip " + std::to_string(c),
+                config.automationPerSecond > 0.0,
+                true);
+            if (!added.success) {
+                error = added.error;
+                return std::nullopt;
+            }
+        }
+    }
+    return session;
+}
+
+struct MemoryUsage {
+    std::optional<uint64_t> residentBytes;
+    std::optional<uint64_t> peakResidentBytes;
+};
+
+MemoryUsage currentMemoryUsage() {
+    MemoryUsage usage;
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    const auto readKilobytes = [&line](std::string_view key) -> std::optional<uint64_t> {
+        if (!line.starts_with(key))
+            return std::nullopt;
+        return std::strtoull(line.c_str() + key.size(), nullptr, 10) * 1024;
+    };
+    while (std::getline(status, line)) {
+        if (auto value = readKilobytes("VmRSS:"))
+            usage.residentBytes = value;
+        else if (auto peak = readKilobytes("VmHWM:"))
+            usage.peakResidentBytes = peak;
+    }
+#endif
+    return usage;
+}
+
+choc::value::Value optionalBytes(const std::optional<uint64_t>& bytes) {
+    return bytes ? choc::value::createInt64(static_cast<int64_t>(*bytes)) : choc::value::Value{};
+}
+
+double percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty())
+        return 0.0;
+    const auto index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+choc::value::Value measureCallbacks(uapmd::SequencerEngine& engine, const BenchConfig& config) {
+    remidy::AudioProcessContext process(engine.data().masterContext(), kUmpBufferSize);
+    process.configureMainBus(kOutputChannels, kOutputChannels, config.bufferSize);
+    process.frameCount(static_cast<int32_t>(config.bufferSize));
+
+    engine.startPlayback();
+    // Let the first blocks settle lazily allocated state before measuring.
+    for (int32_t block = 0; block < 16; ++block)
+        engine.processAudio(process);
+
+    std::vector<double> durationsUs;
+    durationsUs.reserve(static_cast<size_t>(config.callbackBlocks));
+    for (int32_t block = 0; block < config.callbackBlocks; ++block) {
+        const auto started = std::chrono::steady_clock::now();
+        engine.processAudio(process);
+        const auto elapsed = std::chrono::steady_clock::now() - started;
+        durationsUs.push_back(std::chrono::duration<double, std::micro>(elapsed).count());
+        if (block % 64 == 0)
+            remidy::EventLoop::processQueuedTasks();
+    }
+    engine.stopPlayback();
+
+    const auto periodUs = 1e6 * config.bufferSize / config.sampleRate;
+    const auto overruns = std::count_if(durationsUs.begin(), durationsUs.end(),
+                                        [periodUs](double us) { return us > periodUs; });
+    double totalUs = 0.0;
+    for (const auto us : durationsUs)
+        totalUs += us;
+    std::sort(durationsUs.begin(), durationsUs.end());
+
+    auto result = choc::value::createObject("callback");
+    result.addMember("blocks", static_cast<int64_t>(durationsUs.size()));
+    result.addMember("periodUs", periodUs);
+    result.addMember("meanUs", durationsUs.empty() ? 0.0 : totalUs / durationsUs.size());
+    result.addMember("p50Us", percentile(durationsUs, 0.50));
+    result.addMember("p90Us", percentile(durationsUs, 0.90));
+    result.addMember("p99Us", percentile(durationsUs, 0.99));
+    result.addMember("p999Us", percentile(durationsUs, 0.999));
+    result.addMember("maxUs", durationsUs.empty() ? 0.0 : durationsUs.back());
+    result.addMember("overruns", static_cast<int64_t>(overruns));
+    return result;
+}
+
+choc::value::Value measureOfflineRender(
+    uapmd::SequencerEngine& engine, const BenchConfig& config, const fs::path& workDir) {
+    uapmd::OfflineRenderSettings settings;
+    settings.outputPath = workDir / "render.wav";
+    settings.startSeconds = 0.0;
+    settings.endSeconds = config.renderSeconds;
+    settings.sampleRate = config.sampleRate;
+    settings.bufferSize = config.bufferSize;
+    settings.outputChannels = kOutputChannels;
+    settings.umpBufferSize = kUmpBufferSize;
+    settings.infiniteTailPolicy = uapmd::OfflineInfiniteTailPolicy::LATENCY_FALLBACK;
+
+    const auto started = std::chrono::steady_clock::now();
+    std::promise<uapmd::OfflineRenderResult> promise;
+    auto future = promise.get_future();
+    std::thread renderThread([&engine, settings, promise = std::move(promise)]() mutable {
+        promise.set_value(uapmd::renderOfflineProject(engine, settings));
+    });
+    while (future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready)
+        remidy::EventLoop::processQueuedTasks();
+    renderThread.join();
+    const auto wallSeconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - started).count();
+    const auto rendered = future.get();
+
+    auto result = choc::value::createObject("offlineRender");
+    result.addMember("success", rendered.success);
+    if (!rendered.success)
+        result.addMember("error", rendered.errorMessage);
+    result.addMember("renderedSeconds", config.renderSeconds);
+    result.addMember("wallSeconds", wallSeconds);
+    result.addMember("realtimeFactor", wallSeconds > 0.0 ? config.renderSeconds / wallSeconds : 0.0);
+    return result;
+}
+
+std::optional<uapmd::TimelineFacade::ProjectResult> waitForProjectResult(
+    const std::function<void(uapmd::TimelineFacade::ProjectLoadCallback)>& start) {
+    std::optional<uapmd::TimelineFacade::ProjectResult> result;
+    start([&result](uapmd::TimelineFacade::ProjectResult completed) {
+        result = std::move(completed);
+    });
+    pumpEventLoopUntil([&] { return result.has_value(); });
+    return result;
+}
+
+uint64_t directorySize(const fs::path& directory) {
+    uint64_t total = 0;
+    std::error_code ec;
+    for (const auto& entry : fs::recursive_directory_iterator(directory, ec))
+        if (entry.is_regular_file(ec))
+            total += entry.file_size(ec);
+    return total;
+}
+
+choc::value::Value measureProjectRoundTrip(
+    uapmd::SequencerEngine& engine, const BenchConfig& config, const fs::path& workDir) {
+    auto result = choc::value::createObject("project");
+    const auto projectDir = workDir / "project";
+    fs::create_directories(projectDir);
+    const auto projectFile = projectDir / "project.uapmd";
+
+    auto started = std::chrono::steady_clock::now();
+    auto saved = waitForProjectResult([&](auto callback) {
+        uapmd::TimelineFacade::ProjectSaveOptions options;
+        options.emitDocumentEvent = false;
+        engine.timeline().saveProject(projectFile, std::move(options), std::move(callback));
+    });
+    result.addMember("saveSeconds", std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - started).count());
+    if (!saved || !saved->success) {
+        result.addMember("error", saved ? saved->error : std::string{"save did not complete"});
+        return result;
+    }
+    result.addMember("sizeBytes", static_cast<int64_t>(directorySize(projectDir)));
+
+    const auto before = currentMemoryUsage();
+    TestPluginHostingAPI* host = nullptr;
+    auto loadingEngine = createEngine(config, host);
+    started = std::chrono::steady_clock::now();
+    auto loaded = waitForProjectResult([&](auto callback) {
+        loadingEngine->timeline().loadProject(projectFile, std::move(callback));
+    });
+    result.addMember("loadSeconds", std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - started).count());
+    const auto after = currentMemoryUsage();
+    if (!loaded || !loaded->success) {
+        result.addMember("error", loaded ? loaded->error : std::string{"load did not complete"});
+        return result;
+    }
+    result.addMember("loadedTracks", static_cast<int64_t>(loadingEngine->tracks().size()));
+    result.addMember("loadedPlugins", static_cast<int64_t>(host->instanceIds().size()));
+    result.addMember("loadResidentDeltaBytes",
+                     before.residentBytes && after.residentBytes
+                         ? choc::value::createInt64(static_cast<int64_t>(*after.residentBytes) -
+                                                    static_cast<int64_t>(*before.residentBytes))
+                         : choc::value::Value{});
+    return result;
+}
+
+choc::value::Value configToValue(const BenchConfig& config) {
+    auto result = choc::value::createObject("config");
+    result.addMember("tracks", config.tracks);
+    result.addMember("pluginsPerTrack", config.pluginsPerTrack);
+    result.addMember("clipsPerTrack", config.clipsPerTrack);
+    result.addMember("clipSeconds", config.clipSeconds);
+    result.addMember("graph", config.graphShapeName);
+    result.addMember("automationPerSecond", config.automationPerSecond);
+    result.addMember("pluginCostUs", static_cast<double>(config.pluginProfile.costPerBlock.count()) / 1000.0);
+    result.addMember("pluginLatency", static_cast<int64_t>(config.pluginProfile.latencyInSamples));
+    result.addMember("pluginEventsPerBlock", static_cast<int64_t>(config.pluginProfile.eventsPerBlock));
+    result.addMember("sampleRate", config.sampleRate);
+    result.addMember("bufferSize", static_cast<int64_t>(config.bufferSize));
+    result.addMember("callbackBlocks", config.callbackBlocks);
+    result.addMember("renderSeconds", config.renderSeconds);
+    result.addMember("seed", static_cast<int64_t>(config.seed));
+    return result;
+}
+
+int run(int argc, const char* argv[]) {
+    cxxopts::Options options("uapmd-bench", "Benchmark the uapmd engine on a synthetic session.");
+    options.add_options()
+        ("h,help",          "Print this help message")
+        ("tracks",          "Number of tracks", cxxopts::value<int32_t>()->default_value("8"))
+        ("plugins",         "Plug-ins per track", cxxopts::value<int32_t>()->default_value("2"))
+        ("clips",           "MIDI clips per track", cxxopts::value<int32_t>()->default_value("4"))
+        ("clip-seconds",    "Length of each clip in seconds", cxxopts::value<double>()->default_value("4"))
+        ("graph",           "Track graph shape: chain, dag-serial or dag-parallel",
+                            cxxopts::value<std::string>()->default_value("chain"))
+        ("automation",      "NRPN parameter changes per second in every clip",
+                            cxxopts::value<double>()->default_value("0"))
+        ("plugin-cost-us",  "Busy time per processed block of every plug-in, in microseconds",
+                            cxxopts::value<double>()->default_value("0"))
+        ("plugin-latency",  "Reported latency of every plug-in, in samples",
+                            cxxopts::value<uint32_t>()->default_value("0"))
+        ("plugin-events",   "MIDI events every plug-in outputs per block",
+                            cxxopts::value<uint32_t>()->default_value("0"))
+        ("r,sample-rate",   "Sample rate in Hz", cxxopts::value<int32_t>()->default_value("48000"))
+        ("b,buffer-size",   "Audio buffer size in frames", cxxopts::value<uint32_t>()->default_value("256"))
+        ("blocks",          "Audio callbacks to time", cxxopts::value<int32_t>()->default_value("2000"))
+        ("render-seconds",  "Length of the offline render in seconds",
+                            cxxopts::value<double>()->default_value("10"))
+        ("seed",            "Seed for the generated note content", cxxopts::value<uint32_t>()->default_value("1"))
+        ("o,output",        "Write the JSON report to this file instead of stdout",
+                            cxxopts::value<std::string>())
+    ;
+    auto opts = options.parse(argc, argv);
+    if (opts.contains("h")) {
+        std::cerr << options.help();
+        return EXIT_SUCCESS;
+    }
+
+    BenchConfig config;
+    config.tracks = opts["tracks"].as<int32_t>();
+    config.pluginsPerTrack = opts["plugins"].as<int32_t>();
+    config.clipsPerTrack = opts["clips"].as<int32_t>();
+    config.clipSeconds = opts["clip-seconds"].as<double>();
+    config.graphShapeName = opts["graph"].as<std::string>();
+    config.automationPerSecond = opts["automation"].as<double>();
+    config.pluginProfile.costPerBlock = std::chrono::nanoseconds(
+        static_cast<int64_t>(opts["plugin-cost-us"].as<double>() * 1000.0));
+    config.pluginProfile.latencyInSamples = opts["plugin-latency"].as<uint32_t>();
+    config.pluginProfile.eventsPerBlock = opts["plugin-events"].as<uint32_t>();
+    config.sampleRate = opts["sample-rate"].as<int32_t>();
+    config.bufferSize = opts["buffer-size"].as<uint32_t>();
+    config.callbackBlocks = opts["blocks"].as<int32_t>();
+    config.renderSeconds = opts["render-seconds"].as<double>();
+    config.seed = opts["seed"].as<uint32_t>();
+
+    if (config.graphShapeName == "chain")
+        config.graphShape = GraphShape::Chain;
+    else if (config.graphShapeName == "dag-serial")
+        config.graphShape = GraphShape::DagSerial;
+    else if (config.graphShapeName == "dag-parallel")
+        config.graphShape = GraphShape::DagParallel;
+    else {
+        std::cerr << "Unknown graph shape: " << config.graphShapeName << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (config.tracks < 0 || config.pluginsPerTrack < 0 || config.clipsPerTrack < 0 ||
+        config.clipSeconds <= 0.0 || config.sampleRate <= 0 || config.bufferSize == 0 ||
+        config.callbackBlocks <= 0 || config.renderSeconds <= 0.0) {
+        std::cerr << "Invalid benchmark parameters" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    ScopedTestEventLoop eventLoop;
+    const auto workDir = fs::temp_directory_path() /
+        ("uapmd-bench-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    fs::create_directories(workDir);
+
+    auto report = choc::value::createObject("uapmd-bench");
+    report.addMember("config", configToValue(config));
+
+    const auto beforeBuild = currentMemoryUsage();
+    std::string error;
+    const auto buildStarted = std::chrono::steady_clock::now();
+    auto session = buildSession(config, error);
+    if (!session) {
+        std::cerr << "Failed to build the session: " << error << std::endl;
+        fs::remove_all(workDir);
+        return EXIT_FAILURE;
+    }
+    const auto afterBuild = currentMemoryUsage();
+    auto build = choc::value::createObject("build");
+    build.addMember("seconds", std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - buildStarted).count());
+    build.addMember("residentDeltaBytes",
+                    beforeBuild.residentBytes && afterBuild.residentBytes
+                        ? choc::value::createInt64(static_cast<int64_t>(*afterBuild.residentBytes) -
+                                                   static_cast<int64_t>(*beforeBuild.residentBytes))
+                        : choc::value::Value{});
+    report.addMember("build", build);
+
+    report.addMember("callback", measureCallbacks(*session->engine, config));
+    report.addMember("offlineRender", measureOfflineRender(*session->engine, config, workDir));
+    report.addMember("project", measureProjectRoundTrip(*session->engine, config, workDir));
+
+    const auto memory = currentMemoryUsage();
+    auto memoryReport = choc::value::createObject("memory");
+    memoryReport.addMember("residentBytes", optionalBytes(memory.residentBytes));
+    memoryReport.addMember("peakResidentBytes", optionalBytes(memory.peakResidentBytes));
+    report.addMember("memory", memoryReport);
+
+    session.reset();
+    std::error_code ec;
+    fs::remove_all(workDir, ec);
+
+    const auto json = choc::json::toString(report, true);
+    if (opts.contains("output")) {
+        std::ofstream out(opts["output"].as<std::string>());
+        if (!out) {
+            std::cerr << "Cannot write " << opts["output"].as<std::string>() << std::endl;
+            return EXIT_FAILURE;
+        }
+        out << json << std::endl;
+    } else
+        std::cout << json << std::endl;
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        return run(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "uapmd-bench: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
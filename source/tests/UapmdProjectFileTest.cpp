@@ -456,6 +456,38 @@ TEST_F(UapmdProjectFileTest, EmbeddedDagGraphParsesNodeIdEndpoints) {
     EXPECT_EQ(connections[1].target.type, AudioPluginGraphEndpointType::GraphOutput);
 }
 
+TEST_F(UapmdProjectFileTest, PluginSleepSettingIsReadOnlyWhenPresent) {
+    std::string json = R"({
+  "tracks": [
+    {
+      "graph": {
+        "graph_type": "urn:uapmd-graph:common/graph/dag/v1",
+        "plugins": [
+          { "plugin_id": "com.example.reverb", "format": "CLAP", "sleeps_when_silent": true },
+          { "plugin_id": "com.example.delay", "format": "CLAP", "sleeps_when_silent": false },
+          { "plugin_id": "com.example.synth", "format": "CLAP" }
+        ],
+        "connections": []
+      },
+      "clips": []
+    }
+  ]
+})";
+
+    auto file_path = createTestFile("plugin_sleep_project.json", json);
+    auto project = uapmd::UapmdProjectDataReader::read(file_path);
+    ASSERT_NE(project, nullptr);
+    ASSERT_EQ(project->tracks().size(), 1);
+    auto* graph = dynamic_cast<UapmdAudioPluginFullDAGraphData*>(project->tracks()[0]->graph());
+    ASSERT_NE(graph, nullptr);
+    auto plugins = graph->plugins();
+    ASSERT_EQ(plugins.size(), 3u);
+    EXPECT_EQ(plugins[0].sleeps_when_silent, std::optional<bool>{true});
+    EXPECT_EQ(plugins[1].sleeps_when_silent, std::optional<bool>{false});
+    // Absent keeps the instance's own default.
+    EXPECT_FALSE(plugins[2].sleeps_when_silent.has_value());
+}
+
 TEST_F(UapmdProjectFileTest, EmbeddedDagGraphParsesLegacyPluginIndexEndpoints) {
     std::string json = R"({
   "tracks": [
@@ -881,3 +913,186 @@ TEST_F(UapmdProjectFileTest, PersistentIdentitySurvivesRoundTrip) {
     EXPECT_NE(contents.find(R"("anchor": "track_0_clip_0")"), std::string::npos) << contents;
     EXPECT_NE(contents.find(R"("id": "clip_authored_42")"), std::string::npos) << contents;
 }
+
+TEST_F(UapmdProjectFileTest, ChunkContainerWritesOnlyChangedChunks) {
+    const auto containerPath = uapmd::ProjectChunkContainer::containerPathFor(test_dir / "chunked.uapmd");
+    const std::vector<uint8_t> stateA{1, 2, 3};
+    const std::vector<uint8_t> stateB(100, 7);
+
+    std::string referenceA;
+    {
+        uapmd::ProjectChunkContainerWriter writer(containerPath);
+        referenceA = writer.add(stateA);
+        writer.add(stateB);
+        std::string error;
+        ASSERT_TRUE(writer.commit(error)) << error;
+        EXPECT_EQ(2u, writer.writtenChunkCount());
+    }
+    const auto firstSize = fs::file_size(containerPath);
+
+    // An unchanged save leaves the file alone.
+    {
+        uapmd::ProjectChunkContainerWriter writer(containerPath);
+        EXPECT_EQ(referenceA, writer.add(stateA));
+        writer.add(stateB);
+        std::string error;
+        ASSERT_TRUE(writer.commit(error)) << error;
+        EXPECT_EQ(0u, writer.writtenChunkCount());
+        EXPECT_EQ(2u, writer.reusedChunkCount());
+    }
+    EXPECT_EQ(firstSize, fs::file_size(containerPath));
+
+    // One changed state is appended; the unchanged one is only re-indexed.
+    const std::vector<uint8_t> stateC{9, 9, 9, 9};
+    std::string referenceC;
+    {
+        uapmd::ProjectChunkContainerWriter writer(containerPath);
+        writer.add(stateA);
+        writer.add(stateB);
+        referenceC = writer.add(stateC);
+        std::string error;
+        ASSERT_TRUE(writer.commit(error)) << error;
+        EXPECT_EQ(1u, writer.writtenChunkCount());
+    }
+    EXPECT_GT(fs::file_size(containerPath), firstSize);
+
+    std::string error;
+    auto container = uapmd::ProjectChunkContainer::open(containerPath, error);
+    ASSERT_NE(nullptr, container) << error;
+    EXPECT_EQ(3u, container->chunkCount());
+    auto idA = uapmd::ProjectChunkContainer::parseReference(referenceA);
+    auto idC = uapmd::ProjectChunkContainer::parseReference(referenceC);
+    ASSERT_TRUE(idA && idC);
+    EXPECT_EQ(stateA, container->readChunk(*idA));
+    EXPECT_EQ(stateC, container->readChunk(*idC));
+    EXPECT_FALSE(uapmd::ProjectChunkContainer::parseReference("plugin_states/a.state"));
+}
+
+TEST_F(UapmdProjectFileTest, ChunkContainerKeepsPreviousSaveUntilNextCommit) {
+    const auto containerPath = uapmd::ProjectChunkContainer::containerPathFor(test_dir / "interrupted.uapmd");
+    const std::vector<uint8_t> stateA{1, 2, 3};
+    const std::vector<uint8_t> stateB(100, 7);
+    const std::vector<uint8_t> stateC{9, 9, 9, 9};
+    const std::vector<uint8_t> stateD{4, 4};
+    auto save = [&](std::initializer_list<const std::vector<uint8_t>*> states) {
+        uapmd::ProjectChunkContainerWriter writer(containerPath);
+        for (auto* state : states)
+            writer.add(*state);
+        std::string error;
+        EXPECT_TRUE(writer.commit(error)) << error;
+    };
+
+    save({&stateA, &stateB});
+    // The container is committed but the manifest write fails: the manifest
+    // still on disk refers to stateB, which has to resolve.
+    save({&stateA, &stateC});
+    std::string error;
+    auto container = uapmd::ProjectChunkContainer::open(containerPath, error);
+    ASSERT_NE(nullptr, container) << error;
+    EXPECT_EQ(2u, container->liveChunkCount());
+    EXPECT_EQ(stateB, container->readChunk(uapmd::ProjectChunkId::of(stateB)));
+    container.reset();
+
+    // One save later nothing refers to stateB any more.
+    save({&stateA, &stateD});
+    container = uapmd::ProjectChunkContainer::open(containerPath, error);
+    ASSERT_NE(nullptr, container) << error;
+    EXPECT_FALSE(container->contains(uapmd::ProjectChunkId::of(stateB)));
+    EXPECT_EQ(stateC, container->readChunk(uapmd::ProjectChunkId::of(stateC)));
+    EXPECT_EQ(stateD, container->readChunk(uapmd::ProjectChunkId::of(stateD)));
+}
+
+TEST_F(UapmdProjectFileTest, ChunkContainerFallsBackToThePreviousSaveAfterAnInterruptedAppend) {
+    const auto containerPath = uapmd::ProjectChunkContainer::containerPathFor(test_dir / "torn.uapmd");
+    const std::vector<uint8_t> stateA{1, 2, 3};
+    const std::vector<uint8_t> stateB(100, 7);
+    const std::vector<uint8_t> stateC{9, 9, 9, 9};
+    const std::vector<uint8_t> stateD{4, 4};
+    auto save = [&](std::initializer_list<const std::vector<uint8_t>*> states) {
+        uapmd::ProjectChunkContainerWriter writer(containerPath);
+        for (auto* state : states)
+            writer.add(*state);
+        std::string error;
+        EXPECT_TRUE(writer.commit(error)) << error;
+    };
+
+    save({&stateA, &stateB});
+    save({&stateA, &stateB, &stateC});
+    const auto completeSize = fs::file_size(containerPath);
+    // A crash partway through the next append: a payload and part of an index.
+    {
+        std::ofstream torn(containerPath, std::ios::binary | std::ios::app);
+        const std::vector<char> junk(400, 0x5A);
+        torn.write(junk.data(), static_cast<std::streamsize>(junk.size()));
+        torn.write("UCHKIDX3", 8);
+    }
+
+    std::string error;
+    auto container = uapmd::ProjectChunkContainer::open(containerPath, error);
+    ASSERT_NE(nullptr, container) << error;
+    EXPECT_TRUE(container->recoveredFromInterruptedSave());
+    EXPECT_EQ(3u, container->liveChunkCount());
+    EXPECT_EQ(stateB, container->readChunk(uapmd::ProjectChunkId::of(stateB)));
+    EXPECT_EQ(stateC, container->readChunk(uapmd::ProjectChunkId::of(stateC)));
+    container.reset();
+
+    // The next save appends in place of the torn tail.
+    save({&stateA, &stateB, &stateD});
+    EXPECT_GT(fs::file_size(containerPath), completeSize);
+    EXPECT_LT(fs::file_size(containerPath), completeSize + 400);
+    container = uapmd::ProjectChunkContainer::open(containerPath, error);
+    ASSERT_NE(nullptr, container) << error;
+    EXPECT_FALSE(container->recoveredFromInterruptedSave());
+    EXPECT_EQ(stateC, container->readChunk(uapmd::ProjectChunkId::of(stateC)));
+    EXPECT_EQ(stateD, container->readChunk(uapmd::ProjectChunkId::of(stateD)));
+}
+
+TEST_F(UapmdProjectFileTest, Smf2ClipSurvivesInMemoryRoundTrip) {
+    uapmd::Smf2Clip clip;
+    clip.emplace_back(umppi::Ump(umppi::UmpFactory::deltaClockstamp(0)));
+    clip.emplace_back(umppi::Ump(umppi::UmpFactory::dctpq(480)));
+    clip.emplace_back(umppi::Ump(umppi::UmpFactory::deltaClockstamp(0)));
+    clip.push_back(umppi::UmpFactory::startOfClip());
+    clip.emplace_back(umppi::Ump(umppi::UmpFactory::deltaClockstamp(0)));
+    clip.push_back(umppi::UmpFactory::endOfClip());
+
+    auto bytes = uapmd::Smf2ClipReaderWriter::encode(clip);
+    ASSERT_TRUE(bytes);
+    auto info = uapmd::MidiClipReader::readSmf2Clip(*bytes);
+    ASSERT_TRUE(info.success) << info.error;
+    EXPECT_EQ(480u, info.tick_resolution);
+}
+
+TEST(PluginStateStoreTest, IdenticalStatesShareOneBlobUntilReleased) {
+    auto& store = uapmd::PluginStateStore::instance();
+    std::vector<uint8_t> large(64 * 1024, 0x5A);
+    large[17] = 1;
+
+    auto first = store.intern(large);
+    auto second = store.intern(large);
+    ASSERT_NE(nullptr, first);
+    EXPECT_EQ(first.get(), second.get());
+    // Highly repetitive state is kept compressed but reads back unchanged.
+    EXPECT_TRUE(first->compressed());
+    EXPECT_LT(first->retainedSizeInBytes(), large.size());
+    EXPECT_EQ(large, first->bytes());
+
+    auto other = store.intern({1, 2, 3});
+    EXPECT_NE(first.get(), other.get());
+    EXPECT_FALSE(other->compressed());
+
+    std::weak_ptr<const uapmd::PluginStateBlob> released = first;
+    const auto held = store.statistics();
+    first.reset();
+    second.reset();
+    EXPECT_TRUE(released.expired());
+    const auto afterRelease = store.statistics();
+    EXPECT_EQ(held.blobCount - 1, afterRelease.blobCount);
+    EXPECT_EQ(held.logicalSizeInBytes - large.size(), afterRelease.logicalSizeInBytes);
+
+    // The released blob is not found again: interning the same bytes builds
+    // a new one rather than counting a shared hit.
+    auto again = store.intern(large);
+    EXPECT_EQ(afterRelease.sharedHits, store.statistics().sharedHits);
+    EXPECT_EQ(large, again->bytes());
+}
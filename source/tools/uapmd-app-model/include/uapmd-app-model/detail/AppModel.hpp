@@ -145,6 +145,7 @@ namespace uapmd_app {
         int32_t sample_rate_;
         uint32_t audio_buffer_size_;
         bool auto_buffer_size_enabled_{false};
+        bool chunked_project_saves_{false};
         std::unique_ptr<uapmd::IDocumentProvider> documentProvider_;
         int32_t next_source_node_id_ = 1;  // Used only by addDeviceInputToTrack
         std::set<int32_t> hidden_tracks_;
@@ -279,6 +280,14 @@ namespace uapmd_app {
         // Notifies all registered callbacks when complete
         void removePluginInstance(int32_t instanceId);
 
+        // How many removed instances the plugin host keeps for reuse (see
+        // AudioPluginHostingAPI::instancePoolCapacity()). Loading a project
+        // also prewarms one spare instance of each plugin it uses. 0 turns
+        // both off.
+        static constexpr uint32_t kDefaultPluginInstancePoolCapacity{4};
+        void setPluginInstancePoolCapacity(uint32_t capacity);
+        uint32_t pluginInstancePoolCapacity();
+
         // Enable virtual MIDI device for an instance
         // Notifies all registered callbacks when complete
         void enableUmpDevice(int32_t instanceId, const std::string& deviceName);
@@ -435,6 +444,39 @@ namespace uapmd_app {
                                std::string& error);
         bool removeUmpEventFromClip(int32_t trackIndex, int32_t clipId,
                                     int32_t eventIndex, std::string& error);
+
+        // Many UMP edits to one clip, applied as a single content replacement and
+        // therefore a single undo step.
+        struct UmpEventInsertion {
+            uint64_t tick{0};
+            std::vector<uint32_t> words;
+        };
+        struct UmpEventBatch {
+            // Drop every existing event before inserting; removals are ignored.
+            bool replaceAll{false};
+            // Logical event indices as reported by getMidiClipUmpEvents() before the batch.
+            std::vector<int32_t> removals;
+            // Events landing on the same tick as existing ones go after them.
+            std::vector<UmpEventInsertion> insertions;
+            // Apply the valid items even if some are rejected. Otherwise any
+            // rejected item leaves the clip untouched.
+            bool allowPartial{false};
+        };
+        struct UmpEventBatchResult {
+            struct ItemError {
+                // "removals" or "insertions"
+                std::string list;
+                int32_t itemIndex{-1};
+                std::string error;
+            };
+            bool applied{false};
+            int32_t removedEvents{0};
+            int32_t insertedEvents{0};
+            std::vector<ItemError> itemErrors;
+            std::string error;
+        };
+        UmpEventBatchResult applyUmpEventBatch(int32_t trackIndex, int32_t clipId,
+                                               const UmpEventBatch& batch);
         bool getClipAudioEvents(int32_t trackIndex, int32_t clipId,
                                 std::vector<uapmd::ClipMarker>& markers,
                                 std::vector<uapmd::AudioWarpPoint>& audioWarps,
@@ -501,6 +543,11 @@ namespace uapmd_app {
         using ProjectSaveCallback = std::function<void(ProjectResult)>;
 
         void saveProject(const std::filesystem::path& file, ProjectSaveCallback callback);
+        // When enabled, saveProject() keeps plug-in states and MIDI clips in a
+        // binary chunk container next to the project file and rewrites only
+        // the chunks that changed since the previous save.
+        void setChunkedProjectSaves(bool enabled) { chunked_project_saves_ = enabled; }
+        bool chunkedProjectSaves() const { return chunked_project_saves_; }
         // OBSOLETE: use `saveProject()` with callback instead.
         ProjectResult saveProjectSync(const std::filesystem::path& file);
         void loadProject(const std::filesystem::path& file, std::function<void(ProjectResult)> callback);
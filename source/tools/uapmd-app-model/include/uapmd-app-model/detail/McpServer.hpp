@@ -28,7 +28,9 @@ enum class McpConnectionState {
  *                  Constructed with McpServer(std::string relayUrl, bool autoReconnect).
  *
  * In both modes, incoming JSON-RPC requests are queued and dispatched on the
- * main thread by calling processMainThreadQueue() from the render loop each frame.
+ * main thread by calling processMainThreadQueue(). The GUI does that from the
+ * render loop each frame; a host without a frame loop installs a wakeup
+ * (setMainThreadWakeup()) and drains the queue when it fires.
  */
 class McpServer {
 public:
@@ -51,6 +53,13 @@ public:
     /** Call once per frame from the main/GUI thread to process queued tool calls. */
     void processMainThreadQueue();
 
+    /**
+     * Called on the transport thread right after a call is queued, so that a
+     * main thread sleeping between events can wake up and process it. Set it
+     * before start().
+     */
+    void setMainThreadWakeup(std::function<void()> wakeup);
+
 private:
     struct Impl;
     std::unique_ptr<Impl> impl_;
@@ -322,6 +322,14 @@ export const sequencer = {
         __remidy_sequencer_setPluginBypassed(instanceId, bypassed);
     },
 
+    getPluginSleepsWhenSilent: function(instanceId) {
+        return __remidy_sequencer_getPluginSleepsWhenSilent(instanceId);
+    },
+
+    setPluginSleepsWhenSilent: function(instanceId, sleepsWhenSilent) {
+        __remidy_sequencer_setPluginSleepsWhenSilent(instanceId, sleepsWhenSilent);
+    },
+
     getHistoryState: function() {
         return __remidy_sequencer_get_history_state();
     },
@@ -234,6 +234,8 @@ globalThis.uapmd = {
         getPluginFormat: (instanceId) => __remidy_sequencer_getPluginFormat(instanceId),
         isPluginBypassed: (instanceId) => __remidy_sequencer_isPluginBypassed(instanceId),
         setPluginBypassed: (instanceId, bypassed) => __remidy_sequencer_setPluginBypassed(instanceId, bypassed),
+        getPluginSleepsWhenSilent: (instanceId) => __remidy_sequencer_getPluginSleepsWhenSilent(instanceId),
+        setPluginSleepsWhenSilent: (instanceId, sleepsWhenSilent) => __remidy_sequencer_setPluginSleepsWhenSilent(instanceId, sleepsWhenSilent),
         getTrackInfos: () => __remidy_sequencer_getTrackInfos(),
         // Track mutations return a MutationJob. Poll it through
         // uapmd.mutations.getJob(jobId); the engine model thread is never
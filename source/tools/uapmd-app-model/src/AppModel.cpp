@@ -9,6 +9,7 @@
 #include <cstring>
 #include <unordered_map>
 #include <map>
+#include <set>
 #include <unordered_set>
 #include <vector>
 #include <functional>
@@ -386,6 +387,7 @@ uapmd_app::AppModel::AppModel(size_t audioBufferSizeInFrames, size_t umpBufferSi
     clip_enablement_extension_ = std::make_unique<ClipEnablementSerializationExtension>(*this);
     sequencer_.engine()->timeline().addProjectSerializationExtension(*clip_enablement_extension_);
     sequencer_.engine()->functionBlockManager()->setMidiIOManager(this);
+    sequencer_.engine()->pluginHost()->instancePoolCapacity(kDefaultPluginInstancePoolCapacity);
     plugin_state_change_dispatch_->app_model = this;
     auto dispatch = plugin_state_change_dispatch_;
     plugin_state_change_listener_id_ = sequencer_.engine()->pluginHost()->addPluginStateChangeListener([dispatch](int32_t instanceId) {
@@ -1290,6 +1292,16 @@ void uapmd_app::AppModel::forgetRemovedPluginInstance(int32_t instanceId) {
             cb(instanceId);
 }
 
+void uapmd_app::AppModel::setPluginInstancePoolCapacity(uint32_t capacity) {
+    if (auto* host = sequencer_.engine()->pluginHost())
+        host->instancePoolCapacity(capacity);
+}
+
+uint32_t uapmd_app::AppModel::pluginInstancePoolCapacity() {
+    auto* host = sequencer_.engine()->pluginHost();
+    return host ? host->instancePoolCapacity() : 0;
+}
+
 void uapmd_app::AppModel::removePluginInstance(int32_t instanceId) {
     if (sequencer_.engine()->frozenTrackManager().isInstanceBusy(instanceId))
         return;
@@ -1583,6 +1595,8 @@ void uapmd_app::AppModel::showPluginUI(int32_t instanceId, bool needsCreate, boo
 
     result.success = true;
     result.visible = true;
+    // An open editor keeps its track live; undoes an automatic freeze.
+    sequencer_.engine()->autoFreezeScheduler().pluginUIOpened(instanceId);
 
     // Notify all registered callbacks
     for (auto& cb : uiShown) {
@@ -1608,6 +1622,7 @@ void uapmd_app::AppModel::hidePluginUI(int32_t instanceId) {
     if (instance->hasUISupport() && instance->isUIVisible()) {
         instance->hideUI();
     }
+    sequencer_.engine()->autoFreezeScheduler().pluginUIClosed(instanceId);
 
     result.success = true;
     result.visible = false;
@@ -2366,7 +2381,8 @@ static bool modifyMidiClipUmp(
     const std::function<bool(std::vector<uapmd_ump_t>&,
                              std::vector<uint64_t>&,
                              std::string&)>& modifier,
-    std::string& error)
+    std::string& error,
+    uapmd::ProjectMutationOrigin origin = uapmd::ProjectMutationOrigin::User)
 {
     auto& appModel = uapmd_app::AppModel::instance();
     auto tracks = appModel.getTimelineTracks();
@@ -2387,7 +2403,7 @@ static bool modifyMidiClipUmp(
         return false;
 
     if (!appModel.sequencer().engine()->timeline().replaceMidiClipContent(
-            trackIndex, clipId, std::move(newWords), std::move(newTicks))) {
+            trackIndex, clipId, std::move(newWords), std::move(newTicks), origin)) {
         error = "Failed to replace clip data";
         return false;
     }
@@ -2434,21 +2450,28 @@ choc::value::Value uapmd_app::AppModel::getMidiClipUmpEvents(int32_t trackIndex,
     return result;
 }
 
-bool uapmd_app::AppModel::addUmpEventToClip(int32_t trackIndex, int32_t clipId,
-                                         uint64_t tick,
-                                         std::vector<uint32_t> wordsIn,
-                                         std::string& error)
+// Checks that words hold exactly one UMP message.
+static bool validateUmpEventWords(const std::vector<uint32_t>& words, std::string& error)
 {
-    if (wordsIn.empty()) { error = "words must not be empty"; return false; }
-    // Validate word count matches UMP message type
-    umppi::Ump u(wordsIn[0]);
+    if (words.empty()) { error = "words must not be empty"; return false; }
+    umppi::Ump u(words[0]);
     int expectedSz = std::max(1, u.getSizeInInts());
-    if (static_cast<int>(wordsIn.size()) != expectedSz) {
-        error = "words count (" + std::to_string(wordsIn.size()) +
+    if (static_cast<int>(words.size()) != expectedSz) {
+        error = "words count (" + std::to_string(words.size()) +
                 ") does not match UMP message type (expected " +
                 std::to_string(expectedSz) + ")";
         return false;
     }
+    return true;
+}
+
+bool uapmd_app::AppModel::addUmpEventToClip(int32_t trackIndex, int32_t clipId,
+                                         uint64_t tick,
+                                         std::vector<uint32_t> wordsIn,
+                                         std::string& error)
+{
+    if (!validateUmpEventWords(wordsIn, error))
+        return false;
     const bool changed = modifyMidiClipUmp(trackIndex, clipId,
         [tick, &wordsIn](std::vector<uapmd_ump_t>& w,
                          std::vector<uint64_t>& t,
@@ -2506,6 +2529,107 @@ bool uapmd_app::AppModel::removeUmpEventFromClip(int32_t trackIndex, int32_t cli
     return changed;
 }
 
+uapmd_app::AppModel::UmpEventBatchResult uapmd_app::AppModel::applyUmpEventBatch(
+    int32_t trackIndex, int32_t clipId, const UmpEventBatch& batch)
+{
+    UmpEventBatchResult result;
+    std::vector<bool> insertionAccepted(batch.insertions.size(), false);
+    for (size_t i = 0; i < batch.insertions.size(); ++i) {
+        std::string itemError;
+        if (validateUmpEventWords(batch.insertions[i].words, itemError))
+            insertionAccepted[i] = true;
+        else
+            result.itemErrors.push_back({"insertions", static_cast<int32_t>(i), std::move(itemError)});
+    }
+
+    const bool changed = modifyMidiClipUmp(trackIndex, clipId,
+        [&](std::vector<uapmd_ump_t>& w, std::vector<uint64_t>& t, std::string& err) {
+            struct EventSpan {
+                size_t wordStart{0};
+                size_t wordCount{0};
+                uint64_t tick{0};
+            };
+            std::vector<EventSpan> existing;
+            for (size_t i = 0; i < w.size();) {
+                umppi::Ump u(w[i]);
+                const auto count = std::min(static_cast<size_t>(std::max(1, u.getSizeInInts())), w.size() - i);
+                existing.push_back({i, count, i < t.size() ? t[i] : 0});
+                i += count;
+            }
+
+            std::vector<bool> removed(existing.size(), batch.replaceAll);
+            if (!batch.replaceAll) {
+                for (size_t i = 0; i < batch.removals.size(); ++i) {
+                    const auto eventIndex = batch.removals[i];
+                    std::string itemError;
+                    if (eventIndex < 0 || static_cast<size_t>(eventIndex) >= existing.size())
+                        itemError = "eventIndex out of range";
+                    else if (removed[static_cast<size_t>(eventIndex)])
+                        itemError = "eventIndex listed more than once";
+                    if (!itemError.empty()) {
+                        result.itemErrors.push_back({"removals", static_cast<int32_t>(i), std::move(itemError)});
+                        continue;
+                    }
+                    removed[static_cast<size_t>(eventIndex)] = true;
+                }
+            }
+            if (!result.itemErrors.empty() && !batch.allowPartial) {
+                err = std::to_string(result.itemErrors.size()) + " item(s) rejected; the clip was not changed";
+                return false;
+            }
+
+            std::vector<size_t> insertionOrder;
+            for (size_t i = 0; i < batch.insertions.size(); ++i)
+                if (insertionAccepted[i])
+                    insertionOrder.push_back(i);
+            std::stable_sort(insertionOrder.begin(), insertionOrder.end(), [&](size_t a, size_t b) {
+                return batch.insertions[a].tick < batch.insertions[b].tick;
+            });
+
+            std::vector<uapmd_ump_t> words;
+            std::vector<uint64_t> ticks;
+            words.reserve(w.size());
+            ticks.reserve(w.size());
+            auto appendInsertion = [&](const UmpEventInsertion& insertion) {
+                words.insert(words.end(), insertion.words.begin(), insertion.words.end());
+                ticks.insert(ticks.end(), insertion.words.size(), insertion.tick);
+                ++result.insertedEvents;
+            };
+            size_t nextInsertion = 0;
+            for (size_t e = 0; e < existing.size(); ++e) {
+                if (removed[e]) {
+                    ++result.removedEvents;
+                    continue;
+                }
+                const auto& span = existing[e];
+                while (nextInsertion < insertionOrder.size() &&
+                       batch.insertions[insertionOrder[nextInsertion]].tick < span.tick)
+                    appendInsertion(batch.insertions[insertionOrder[nextInsertion++]]);
+                words.insert(words.end(),
+                             w.begin() + static_cast<std::ptrdiff_t>(span.wordStart),
+                             w.begin() + static_cast<std::ptrdiff_t>(span.wordStart + span.wordCount));
+                ticks.insert(ticks.end(), span.wordCount, span.tick);
+            }
+            while (nextInsertion < insertionOrder.size())
+                appendInsertion(batch.insertions[insertionOrder[nextInsertion++]]);
+
+            if (result.removedEvents == 0 && result.insertedEvents == 0) {
+                err = "Nothing to apply";
+                return false;
+            }
+            w = std::move(words);
+            t = std::move(ticks);
+            return true;
+        }, result.error, uapmd::ProjectMutationOrigin::Remote);
+
+    result.applied = changed;
+    if (changed)
+        sequencer_.engine()->markTrackDirty(trackIndex);
+    else
+        result.removedEvents = result.insertedEvents = 0;
+    return result;
+}
+
 bool uapmd_app::AppModel::getClipAudioEvents(int32_t trackIndex, int32_t clipId,
                                          std::vector<uapmd::ClipMarker>& markers,
                                          std::vector<uapmd::AudioWarpPoint>& audioWarps,
@@ -2631,28 +2755,6 @@ bool uapmd_app::AppModel::setClipAudioEvents(int32_t trackIndex, int32_t clipId,
         }
     }
 
-    auto reader = uapmd::createAudioFileReaderFromPath(clip->filepath);
-    if (!reader) {
-        error = "Could not reopen the audio file for warp rebuild.";
-        return false;
-    }
-
-    auto targetClip = *clip;
-    targetClip.markers = markers;
-    clipLookup[targetClip.referenceId] = targetClip;
-    auto resolvedWarps = resolveAudioWarpPoints(
-        targetClip,
-        audioWarps,
-        clipLookup,
-        sequencer_.engine()->masterTrackMarkers(),
-                                                static_cast<double>(sampleRate()));
-    auto newNode = std::make_unique<uapmd::AudioFileSourceNode>(
-        clip->sourceNodeInstanceId,
-        std::move(reader),
-        static_cast<double>(sampleRate()),
-        resolvedWarps
-    );
-
     if (!sequencer_.engine()->timeline().replaceAudioClipContent(
             trackIndex,
             clipId,
@@ -3240,6 +3342,7 @@ void uapmd_app::AppModel::saveProject(const std::filesystem::path& projectFile,
 
     TimelineFacade::ProjectSaveOptions options;
     options.excludedTrackIndexes.assign(hidden_tracks_.begin(), hidden_tracks_.end());
+    options.chunkContainer = chunked_project_saves_;
     engine->timeline().saveProject(
         projectFile,
         std::move(options),
@@ -3307,6 +3410,7 @@ void uapmd_app::AppModel::loadProject(const std::filesystem::path& projectFile,
                 fbm->deleteEmptyDevices();
 
             if (auto* host = sequencer_.engine()->pluginHost()) {
+                std::set<std::pair<std::string, std::string>> usedPlugins;
                 for (int32_t instanceId : host->instanceIds()) {
                     auto result = registerPluginInstanceInternal(instanceId, std::nullopt);
                     if (!result.error.empty()) {
@@ -3315,7 +3419,13 @@ void uapmd_app::AppModel::loadProject(const std::filesystem::path& projectFile,
                     }
                     for (auto& cb : instanceCreated)
                         cb(result);
+                    if (auto* instance = host->getInstance(instanceId))
+                        usedPlugins.emplace(instance->formatName(), instance->pluginId());
                 }
+                // A spare of each, so that adding another one is immediate.
+                if (host->instancePoolCapacity() > 0)
+                    for (auto [format, pluginId] : usedPlugins)
+                        sequencer_.engine()->prewarmPlugin(format, pluginId, 1);
             }
 
             callback({true, {}});
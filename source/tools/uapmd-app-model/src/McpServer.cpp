@@ -89,6 +89,13 @@ static double getDoubleArg(const choc::value::Value& args, const char* key, doub
     return fallback;
 }
 
+static bool getBoolArg(const choc::value::Value& args, const char* key, bool fallback = false)
+{
+    if (args.isObject() && args.hasObjectMember (key))
+        return args[key].get<bool>();
+    return fallback;
+}
+
 namespace {
 constexpr std::string_view kMasterMarkerReferenceId = "master_track";
 
@@ -564,6 +571,21 @@ static choc::value::Value buildToolDefinitions()
             "Removes all words belonging to that logical event (1 for MIDI1, 2 for MIDI2).",
             R"j({"type":"object","required":["trackIndex","clipId","eventIndex"],"properties":{"trackIndex":{"type":"integer"},"clipId":{"type":"integer"},"eventIndex":{"type":"integer","description":"Zero-based logical event index from get_clip_ump_events"}}})j"
         },
+        {
+            "edit_clip_ump_events",
+            "Apply many UMP edits to a MIDI clip as one transaction and one undo step. "
+            "removals are eventIndex values from get_clip_ump_events taken before the edit; "
+            "insertions are {tick, words} like add_ump_event. Rejected items are listed in errors[] "
+            "with their list and itemIndex; unless allowPartial is true, any rejected item leaves the clip unchanged.",
+            R"j({"type":"object","required":["trackIndex","clipId"],"properties":{"trackIndex":{"type":"integer"},"clipId":{"type":"integer"},"removals":{"type":"array","items":{"type":"integer"}},"insertions":{"type":"array","items":{"type":"object","required":["tick","words"],"properties":{"tick":{"type":"integer"},"words":{"type":"array","items":{"type":"integer"}}}}},"allowPartial":{"type":"boolean","description":"Apply the valid items even if some are rejected (default false)"}}})j"
+        },
+        {
+            "set_clip_ump_events",
+            "Replace the whole event list of a MIDI clip in one transaction and one undo step. "
+            "events are {tick, words} like add_ump_event, in any order. "
+            "Rejected events are listed in errors[]; unless allowPartial is true, any rejected event leaves the clip unchanged.",
+            R"j({"type":"object","required":["trackIndex","clipId","events"],"properties":{"trackIndex":{"type":"integer"},"clipId":{"type":"integer"},"events":{"type":"array","items":{"type":"object","required":["tick","words"],"properties":{"tick":{"type":"integer"},"words":{"type":"array","items":{"type":"integer"}}}}},"allowPartial":{"type":"boolean","description":"Apply the valid events even if some are rejected (default false)"}}})j"
+        },
         {
             "create_empty_midi_clip",
             "Create a new empty MIDI clip on a track. Returns clipId. "
@@ -1279,6 +1301,91 @@ static choc::value::Value toolRemoveUmpEvent(const choc::value::Value& args)
     return choc::value::createObject ("");
 }
 
+static std::vector<AppModel::UmpEventInsertion> getUmpEventInsertions(
+    const choc::value::Value& args, const char* key)
+{
+    std::vector<AppModel::UmpEventInsertion> insertions;
+    if (!args.isObject() || !args.hasObjectMember (key))
+        return insertions;
+    auto list = args[key];
+    if (!list.isArray())
+        throw std::invalid_argument (std::string (key) + " must be an array");
+    insertions.reserve (list.size());
+    for (uint32_t i = 0; i < list.size(); ++i) {
+        auto item = list[i];
+        AppModel::UmpEventInsertion insertion;
+        // Malformed items keep empty words so they are reported per item.
+        if (item.isObject()) {
+            insertion.tick = static_cast<uint64_t>(std::max<int64_t>(0, getInt64Arg (item, "tick", 0)));
+            if (item.hasObjectMember ("words") && item["words"].isArray()) {
+                auto wordsVal = item["words"];
+                for (uint32_t w = 0; w < wordsVal.size(); ++w)
+                    insertion.words.push_back (static_cast<uint32_t>(wordsVal[w].get<int64_t>()));
+            }
+        }
+        insertions.push_back (std::move (insertion));
+    }
+    return insertions;
+}
+
+static choc::value::Value umpEventBatchResultToValue(const AppModel::UmpEventBatchResult& r)
+{
+    auto result = choc::value::createObject ("");
+    result.setMember ("applied", r.applied);
+    result.setMember ("removedEvents", r.removedEvents);
+    result.setMember ("insertedEvents", r.insertedEvents);
+    auto errors = choc::value::createEmptyArray();
+    for (const auto& itemError : r.itemErrors) {
+        auto obj = choc::value::createObject ("");
+        obj.setMember ("list", itemError.list);
+        obj.setMember ("itemIndex", itemError.itemIndex);
+        obj.setMember ("error", itemError.error);
+        errors.addArrayElement (obj);
+    }
+    result.setMember ("errors", errors);
+    if (!r.error.empty())
+        result.setMember ("error", r.error);
+    return result;
+}
+
+static choc::value::Value toolEditClipUmpEvents(const choc::value::Value& args)
+{
+    auto trackIndex = getIntArg (args, "trackIndex");
+    auto clipId     = getIntArg (args, "clipId");
+    if (trackIndex < 0 || clipId < 0)
+        throw std::invalid_argument ("trackIndex and clipId are required");
+
+    AppModel::UmpEventBatch batch;
+    if (args.hasObjectMember ("removals")) {
+        auto removals = args["removals"];
+        if (!removals.isArray())
+            throw std::invalid_argument ("removals must be an array");
+        for (uint32_t i = 0; i < removals.size(); ++i)
+            batch.removals.push_back (static_cast<int32_t>(removals[i].get<int64_t>()));
+    }
+    batch.insertions   = getUmpEventInsertions (args, "insertions");
+    batch.allowPartial = getBoolArg (args, "allowPartial", false);
+    return umpEventBatchResultToValue (
+        AppModel::instance().applyUmpEventBatch (trackIndex, clipId, batch));
+}
+
+static choc::value::Value toolSetClipUmpEvents(const choc::value::Value& args)
+{
+    auto trackIndex = getIntArg (args, "trackIndex");
+    auto clipId     = getIntArg (args, "clipId");
+    if (trackIndex < 0 || clipId < 0)
+        throw std::invalid_argument ("trackIndex and clipId are required");
+    if (!args.hasObjectMember ("events"))
+        throw std::invalid_argument ("events is required");
+
+    AppModel::UmpEventBatch batch;
+    batch.replaceAll   = true;
+    batch.insertions   = getUmpEventInsertions (args, "events");
+    batch.allowPartial = getBoolArg (args, "allowPartial", false);
+    return umpEventBatchResultToValue (
+        AppModel::instance().applyUmpEventBatch (trackIndex, clipId, batch));
+}
+
 static choc::value::Value toolCreateEmptyMidiClip(const choc::value::Value& args)
 {
     auto trackIndex      = getIntArg   (args, "trackIndex");
@@ -1420,6 +1527,7 @@ struct McpServer::Impl {
     };
     std::mutex queueMutex_;
     std::queue<std::shared_ptr<PendingCall>> queue_;
+    std::function<void()> mainThreadWakeup_;
 
     // Post work to the main thread and block until it's processed.
     // On Wasm the JS caller is already on the main thread, so call directly.
@@ -1436,6 +1544,8 @@ struct McpServer::Impl {
             std::lock_guard lock (queueMutex_);
             queue_.push (call);
         }
+        if (mainThreadWakeup_)
+            mainThreadWakeup_();
         return future.get();
 #endif
     }
@@ -1637,6 +1747,8 @@ struct McpServer::Impl {
             else if (toolName == "get_clip_ump_events")      toolResult = toolGetClipUmpEvents (args);
             else if (toolName == "add_ump_event")            toolResult = toolAddUmpEvent (args);
             else if (toolName == "remove_ump_event")         toolResult = toolRemoveUmpEvent (args);
+            else if (toolName == "edit_clip_ump_events")     toolResult = toolEditClipUmpEvents (args);
+            else if (toolName == "set_clip_ump_events")      toolResult = toolSetClipUmpEvents (args);
             else if (toolName == "create_empty_midi_clip")   toolResult = toolCreateEmptyMidiClip (args);
             else if (toolName == "play")                     toolResult = toolPlay (args);
             else if (toolName == "stop")                     toolResult = toolStop (args);
@@ -1805,6 +1917,7 @@ McpConnectionMode McpServer::mode() const          { return impl_->mode_; }
 McpConnectionState McpServer::connectionState() const { return impl_->connState_.load(); }
 int McpServer::port() const                        { return impl_->port_; }
 void McpServer::processMainThreadQueue()           { impl_->processQueue(); }
+void McpServer::setMainThreadWakeup(std::function<void()> wakeup) { impl_->mainThreadWakeup_ = std::move (wakeup); }
 
 std::string McpServer::statusMessage() const
 {
@@ -1862,6 +1975,7 @@ McpConnectionMode  McpServer::mode()            const { return impl_->mode_; }
 McpConnectionState McpServer::connectionState() const { return impl_->connState_.load(); }
 int                McpServer::port()            const { return impl_->port_; }
 void               McpServer::processMainThreadQueue() { impl_->processQueue(); }
+void               McpServer::setMainThreadWakeup(std::function<void()> wakeup) { impl_->mainThreadWakeup_ = std::move (wakeup); }
 
 std::string McpServer::statusMessage() const
 {
@@ -778,6 +778,31 @@ void UapmdJSRuntime::registerSequencerInstanceAPI()
         return choc::value::Value();
     });
 
+    jsContext_.registerFunction ("__remidy_sequencer_getPluginSleepsWhenSilent", [] (choc::javascript::ArgumentList args) -> choc::value::Value
+    {
+        auto instanceId = args.get<int32_t> (0, -1);
+        if (instanceId < 0)
+            return choc::value::createBool (false);
+
+        auto& sequencer = uapmd_app::AppModel::instance().sequencer();
+        auto* instance = sequencer.engine()->getPluginInstance (instanceId);
+        return choc::value::createBool (instance ? instance->sleepsWhenSilent() : false);
+    });
+
+    jsContext_.registerFunction ("__remidy_sequencer_setPluginSleepsWhenSilent", [] (choc::javascript::ArgumentList args) -> choc::value::Value
+    {
+        auto instanceId = args.get<int32_t> (0, -1);
+        auto sleepsWhenSilent = args.get<bool> (1, false);
+
+        if (instanceId >= 0)
+        {
+            auto& sequencer = uapmd_app::AppModel::instance().sequencer();
+            sequencer.engine()->commands().setPluginSleepsWhenSilent(
+                instanceId, sleepsWhenSilent);
+        }
+        return choc::value::Value();
+    });
+
     jsContext_.registerFunction ("__remidy_sequencer_get_history_state", [] (choc::javascript::ArgumentList) -> choc::value::Value
     {
         const auto state = uapmd_app::AppModel::instance().historyState();
@@ -247,6 +247,58 @@ TEST(AppLayerUndoIntegrationTest, EmptyMidiClipCreationCompoundUndoAndRedo) {
     EXPECT_EQ(track->clipManager().clipCount(), 1u);
 }
 
+TEST(AppLayerUndoIntegrationTest, UmpEventBatchIsOneUndoStepAndAllOrNothing) {
+    ScopedTestEventLoop eventLoop;
+    struct ScopedAppModelInstance {
+        ScopedAppModelInstance() { uapmd_app::AppModel::instantiate(); }
+        ~ScopedAppModelInstance() { uapmd_app::AppModel::cleanupInstance(); }
+    } appModelInstance;
+
+    auto& model = uapmd_app::AppModel::instance();
+    std::optional<int32_t> trackIndex;
+    model.addTrack([&](int32_t index, std::string) {
+        trackIndex = index;
+    });
+    pumpUntil([&] { return trackIndex.has_value(); });
+    ASSERT_TRUE(trackIndex.has_value());
+    const auto clip = model.createEmptyMidiClip(*trackIndex);
+    ASSERT_TRUE(clip.success) << clip.error;
+    auto eventCount = [&] {
+        return model.getMidiClipUmpEvents(*trackIndex, clip.clipId)["events"].size();
+    };
+
+    uapmd_app::AppModel::UmpEventBatch batch;
+    batch.insertions = {
+        {480, {0x40803C00u, 0x00000000u}},
+        {0, {0x40903C00u, 0x7FFF0000u}},
+        {960, {0x20903C7Fu}},
+    };
+    auto applied = model.applyUmpEventBatch(*trackIndex, clip.clipId, batch);
+    ASSERT_TRUE(applied.applied) << applied.error;
+    EXPECT_EQ(applied.insertedEvents, 3);
+    auto events = model.getMidiClipUmpEvents(*trackIndex, clip.clipId)["events"];
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0]["tick"].get<int64_t>(), 0);
+    EXPECT_EQ(events[1]["tick"].get<int64_t>(), 480);
+    EXPECT_EQ(events[2]["tick"].get<int64_t>(), 960);
+
+    uapmd_app::AppModel::UmpEventBatch rejected;
+    rejected.removals = {0, 7};
+    rejected.insertions = {{240, {0x40903E00u}}};
+    const auto rejectedResult = model.applyUmpEventBatch(*trackIndex, clip.clipId, rejected);
+    EXPECT_FALSE(rejectedResult.applied);
+    ASSERT_EQ(rejectedResult.itemErrors.size(), 2u);
+    EXPECT_EQ(rejectedResult.itemErrors[0].list, "insertions");
+    EXPECT_EQ(rejectedResult.itemErrors[1].list, "removals");
+    EXPECT_EQ(rejectedResult.itemErrors[1].itemIndex, 1);
+    EXPECT_EQ(eventCount(), 3u);
+
+    auto result = moveHistory(model, false);
+    ASSERT_TRUE(result.has_value());
+    ASSERT_TRUE(result->empty()) << *result;
+    EXPECT_EQ(eventCount(), 0u);
+}
+
 TEST(AppLayerUndoIntegrationTest, JavaScriptTrackJobParticipatesInHistory) {
     ScopedTestEventLoop eventLoop;
     struct ScopedAppModelInstance {
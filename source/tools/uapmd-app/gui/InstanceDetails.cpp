@@ -384,6 +384,21 @@ void InstanceDetails::render(const RenderContext& context) {
                             ImGui::SetTooltip(pluginBypassed ? "Plugin bypassed (click to enable)" : "Bypass plugin");
 
                         ImGui::SameLine();
+
+                        bool sleepsWhenSilent = instance->sleepsWhenSilent();
+                        std::string sleepLabel = std::format("Sleep when silent##InstanceSleep{}", instanceId);
+                        if (ImGui::Checkbox(sleepLabel.c_str(), &sleepsWhenSilent))
+                            if (uapmd_app::AppModel::instance()
+                                    .sequencer().engine()->commands()
+                                    .setPluginSleepsWhenSilent(instanceId, sleepsWhenSilent))
+                                uapmd_app::AppModel::instance()
+                                    .markPluginInstanceTrackDirty(instanceId);
+                        if (ImGui::IsItemHovered())
+                            ImGui::SetTooltip(instance->sleeping()
+                                ? "Skipped while its input and output stay silent (asleep now)"
+                                : "Skip processing while its input and output stay silent. Leave off for instruments that play by themselves.");
+
+                        ImGui::SameLine();
                     }
                 }
 
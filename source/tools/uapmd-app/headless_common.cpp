@@ -0,0 +1,170 @@
+// Headless daemon mode: the application model, audio engine and MCP server
+// without ImGui or a window. The main thread sleeps until work is posted to it
+// instead of polling once per rendered frame.
+
+#include "main_common.hpp"
+#include <uapmd-app-model/uapmd-app-model.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+namespace uapmd_app {
+
+namespace {
+
+std::atomic<bool> interruptRequested{false};
+
+extern "C" void handleInterruptSignal(int) {
+    interruptRequested.store(true, std::memory_order_relaxed);
+}
+
+/**
+ * Main-thread event loop for the headless daemon.
+ * Tasks posted from other threads wake the main thread through a condition
+ * variable, so they run as soon as they are queued.
+ */
+class HeadlessEventLoop final : public remidy::EventLoop {
+    std::queue<std::function<void()>> taskQueue_;
+    std::mutex queueMutex_;
+    std::condition_variable taskAvailable_;
+    std::thread::id mainThreadId_{std::this_thread::get_id()};
+    bool stopRequested_ = false;
+
+protected:
+    void initializeOnUIThreadImpl() override {
+        mainThreadId_ = std::this_thread::get_id();
+    }
+
+    bool runningOnMainThreadImpl() override {
+        return std::this_thread::get_id() == mainThreadId_;
+    }
+
+    void enqueueTaskOnMainThreadImpl(std::function<void()>&& func) override {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            taskQueue_.push(std::move(func));
+        }
+        taskAvailable_.notify_one();
+    }
+
+    void startImpl() override {
+        runUntil([] { return false; });
+    }
+
+    void stopImpl() override {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            stopRequested_ = true;
+        }
+        taskAvailable_.notify_one();
+    }
+
+    void processQueuedTasksImpl() override {
+        processQueuedTasks();
+    }
+
+public:
+    void processQueuedTasks() {
+        std::queue<std::function<void()>> localQueue;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            std::swap(localQueue, taskQueue_);
+        }
+        while (!localQueue.empty()) {
+            auto task = std::move(localQueue.front());
+            localQueue.pop();
+            task();
+        }
+    }
+
+    /**
+     * Runs tasks as they are posted until stop() is called or `done` returns
+     * true. Signal handlers cannot notify the condition variable, so the wait
+     * also times out periodically to re-check `done`.
+     */
+    void runUntil(const std::function<bool()>& done) {
+        constexpr auto kPollInterval = std::chrono::milliseconds(200);
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(queueMutex_);
+                taskAvailable_.wait_for(lock, kPollInterval, [this] {
+                    return stopRequested_ || !taskQueue_.empty();
+                });
+                if (stopRequested_ && taskQueue_.empty())
+                    return;
+            }
+            processQueuedTasks();
+            if (done())
+                return;
+        }
+    }
+};
+
+} // namespace
+
+int runHeadlessLoop(const HeadlessOptions& options) {
+#if defined(UAPMD_MCP_HAS_HTTP_SERVER)
+    // Like the GUI's event loop, this one stays installed for the rest of the process.
+    auto eventLoop = std::make_unique<HeadlessEventLoop>();
+    auto* eventLoopPtr = eventLoop.get();
+    remidy::setEventLoop(eventLoop.release());
+    remidy::EventLoop::initializeOnUIThread();
+
+    std::signal(SIGINT, handleInterruptSignal);
+    std::signal(SIGTERM, handleInterruptSignal);
+
+    uapmd_app::AppModel::instantiate();
+    auto audioManager = uapmd::AudioIODeviceManager::instance();
+    uapmd::AudioIODeviceManager::Configuration audioConfig{ .logger = remidy::Logger::global() };
+    audioManager->initialize(audioConfig);
+
+    // There is no UI to wait for; this releases the startup plug-in scan.
+    uapmd_app::AppModel::instance().notifyUiReady();
+    uapmd_app::AppModel::instance().notifyPersistentStorageReady();
+    uapmd_app::AppModel::instance().setAudioEngineEnabled(true);
+
+    auto mcpServer = std::make_unique<McpServer>(options.mcpPort);
+    mcpServer->setMainThreadWakeup([server = mcpServer.get()] {
+        remidy::EventLoop::enqueueTaskOnMainThread([server] {
+            server->processMainThreadQueue();
+        });
+    });
+    mcpServer->start();
+    std::cout << "uapmd-app running headless; send SIGINT or SIGTERM to quit." << std::endl;
+
+    eventLoopPtr->runUntil([] { return interruptRequested.load(std::memory_order_relaxed); });
+
+    // In-flight requests block their transport threads until the main thread
+    // answers them, so keep serving the queue while the server shuts down.
+    std::atomic<bool> serverStopped{false};
+    std::thread serverStopper([&] {
+        mcpServer->stop();
+        serverStopped.store(true);
+        remidy::EventLoop::enqueueTaskOnMainThread([] {});
+    });
+    eventLoopPtr->runUntil([&] { return serverStopped.load(); });
+    serverStopper.join();
+    mcpServer->processMainThreadQueue();
+    mcpServer.reset();
+
+    uapmd_app::AppModel::instance().setAudioEngineEnabled(false);
+    uapmd_app::AppModel::cleanupInstance();
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    return EXIT_SUCCESS;
+#else
+    (void) options;
+    std::cerr << "Headless mode requires the MCP HTTP server, which this build does not include." << std::endl;
+    return EXIT_FAILURE;
+#endif
+}
+
+} // namespace uapmd_app
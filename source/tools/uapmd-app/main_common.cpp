@@ -128,14 +128,14 @@ int runMainLoop(int argc, char** argv) {
             }
             continue;
         }
-        /*if (arg == "--shell" || arg == "--cli" || arg == "--no-gui" || arg == "--headless") {
+        if (arg == "--no-gui" || arg == "--headless") {
             requestedMode = Mode::Headless;
             continue;
         }
         if (arg == "--gui") {
             requestedMode = Mode::Gui;
             continue;
-        }*/
+        }
         positional.push_back(arg);
     }
 
@@ -175,8 +175,10 @@ int runMainLoop(int argc, char** argv) {
     }
 
     if (!runGui) {
-        std::cerr << "uapmd-app can only run in GUI mode" << std::endl;
-        return EXIT_FAILURE;
+        HeadlessOptions headlessOptions{};
+        if (mcpPort > 0)
+            headlessOptions.mcpPort = mcpPort;
+        return runHeadlessLoop(headlessOptions);
     }
 
     // Create windowing backend with priority: SDL3 > SDL2 > GLFW
@@ -10,4 +10,14 @@ namespace uapmd_app {
      */
     int runMainLoop(int argc, char** argv);
 
+    struct HeadlessOptions {
+        int mcpPort = 37373;
+    };
+
+    /**
+     * Runs the application model and MCP server without a window until SIGINT
+     * or SIGTERM. Implemented in headless_common.cpp.
+     */
+    int runHeadlessLoop(const HeadlessOptions& options);
+
 } // namespace uapmd_app
@@ -2734,41 +2734,25 @@ namespace uapmd::ara {
                 return ARA::kARATrue;
             }
 
-            if (!reader->use64BitSamples) {
-                std::vector<float*> floatBuffers;
-                floatBuffers.reserve(channelCount);
-                for (uint32_t ch = 0; ch < channelCount; ch++)
-                    floatBuffers.push_back(static_cast<float*>(buffers[ch]));
-                return impl->document_view->readAudioSourceSamples(
-                    reader->audio_source_id,
-                    samplePosition,
-                    samplesPerChannel,
-                    floatBuffers.data(),
-                    channelCount)
-                    ? ARA::kARATrue
-                    : ARA::kARAFalse;
-            }
-
-            std::vector<std::vector<float>> temp(channelCount);
-            std::vector<float*> tempPtrs;
-            tempPtrs.reserve(channelCount);
-            for (uint32_t ch = 0; ch < channelCount; ch++) {
-                temp[ch].resize(static_cast<size_t>(samplesPerChannel));
-                tempPtrs.push_back(temp[ch].data());
-            }
+            // 64-bit buffers are read as floats into their own first half and
+            // widened in place.
+            std::vector<float*> floatBuffers;
+            floatBuffers.reserve(channelCount);
+            for (uint32_t ch = 0; ch < channelCount; ch++)
+                floatBuffers.push_back(static_cast<float*>(buffers[ch]));
             if (!impl->document_view->readAudioSourceSamples(
                     reader->audio_source_id,
                     samplePosition,
                     samplesPerChannel,
-                    tempPtrs.data(),
+                    floatBuffers.data(),
                     channelCount))
                 return ARA::kARAFalse;
 
-            for (uint32_t ch = 0; ch < channelCount; ch++) {
-                auto* dst = static_cast<double*>(buffers[ch]);
-                for (ARA::ARASampleCount i = 0; i < samplesPerChannel; i++)
-                    dst[i] = temp[ch][static_cast<size_t>(i)];
-            }
+            if (reader->use64BitSamples)
+                for (uint32_t ch = 0; ch < channelCount; ch++)
+                    remidy::convertSamplesInPlace(
+                        buffers[ch], 1, 0, static_cast<size_t>(samplesPerChannel),
+                        remidy::AudioContentType::Float32, remidy::AudioContentType::Float64);
             return ARA::kARATrue;
         }
     } // namespace
@@ -52,8 +52,11 @@ namespace uapmd {
         virtual std::string_view commandId() const = 0;
         virtual std::string description() const = 0;
 
-        // Bytes retained for as long as this command sits in history.
+        // Bytes retained for as long as this command sits in history, apart
+        // from the shared payloads reported by collectSharedPayloads().
         virtual size_t retainedSizeInBytes() const = 0;
+        virtual void collectSharedPayloads(std::vector<ProjectHistorySharedPayload>& payloads) const {
+        }
 
         // Coalescing of adjacent commands inside a gesture scope. Only ever
         // called with a command of the same commandId(), so implementations
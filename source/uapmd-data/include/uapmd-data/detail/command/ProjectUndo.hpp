@@ -6,6 +6,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace uapmd {
 
@@ -67,6 +68,14 @@ namespace uapmd {
         }
     };
 
+    // A payload that several history entries can hold at once, such as an
+    // interned plug-in state. The history charges it once, for as long as any
+    // entry holds it, rather than once per holder.
+    struct ProjectHistorySharedPayload {
+        std::shared_ptr<const void> payload{};
+        size_t sizeInBytes{0};
+    };
+
     // An operation owns everything needed to move one document edit in either
     // direction. Implementations must invoke their completion exactly once.
     // Synchronous operations invoke it before returning; plug-in and track
@@ -76,7 +85,10 @@ namespace uapmd {
         virtual ~ProjectUndoableOperation() = default;
 
         virtual std::string description() const = 0;
+        // Excludes what collectSharedPayloads() reports.
         virtual size_t historySizeInBytes() const = 0;
+        virtual void collectSharedPayloads(std::vector<ProjectHistorySharedPayload>& payloads) const {
+        }
 
         // Called only for already-performed adjacent operations inside an
         // explicit gesture scope. Implementations return true after extending
@@ -125,6 +125,10 @@ namespace uapmd {
             });
         }
 
+        // Publishing thread only. False once every reader has let go of the
+        // snapshots replaced so far, after a reclaimRetired() call.
+        bool hasRetired() const noexcept { return !retired_.empty(); }
+
         // Publishing thread only. This is intended for non-RT code that already
         // serializes snapshot publication and therefore needs no hazard slot.
         const T* currentOnPublisherThread() const noexcept { return current_owner_.get(); }
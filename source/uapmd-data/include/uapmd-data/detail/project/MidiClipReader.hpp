@@ -4,6 +4,7 @@
 #include <vector>
 #include <filesystem>
 #include <cstdint>
+#include <span>
 #include "../midi/MidiTimelineEvents.hpp"
 #include "../timeline/TimelineTrack.hpp"
 
@@ -46,6 +47,8 @@ namespace uapmd {
         //  - Traditional SMF (Format 0, 1, 2) with "MThd" header
         //  - SMF2 (MIDI 2.0 Clip File) with "SMF2CLIP" header per M2-116-U v1.0
         static ClipInfo readAnyFormat(const std::filesystem::path& file);
+        // Decodes an in-memory SMF2 (MIDI 2.0 Clip File) image, such as a project chunk
+        static ClipInfo readSmf2Clip(std::span<const uint8_t> bytes);
         static SeparatedMasterTrackEvents separateMasterTrackEvents(ClipInfo clipInfo);
 
         // Check if a file is a valid SMF2 (MIDI 2.0 Clip File) with "SMF2CLIP" header
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "ProjectChunkContainer.hpp"
+
+namespace uapmd {
+
+    class PluginStateStore;
+
+    // One immutable plug-in state, shared by every holder of the same bytes:
+    // undo history, track freezing and project saves. Large states may be
+    // kept zlib-compressed; bytes() always returns the original content.
+    class PluginStateBlob {
+    public:
+        const ProjectChunkId& id() const { return id_; }
+        size_t size() const { return static_cast<size_t>(id_.size); }
+        bool empty() const { return id_.size == 0; }
+        bool compressed() const { return compressed_; }
+        // What this blob actually occupies, for history budgets.
+        size_t retainedSizeInBytes() const { return sizeof(*this) + data_.capacity(); }
+
+        std::vector<uint8_t> bytes() const;
+
+    private:
+        friend class PluginStateStore;
+        PluginStateBlob() = default;
+
+        ProjectChunkId id_{};
+        std::vector<uint8_t> data_;
+        bool compressed_{false};
+    };
+
+    using PluginStateRef = std::shared_ptr<const PluginStateBlob>;
+
+    // Process-wide, content-addressed store of plug-in states.
+    //
+    // intern() returns the blob already holding the same bytes when one is
+    // alive, so identical states -- duplicated tracks, an instrument that did
+    // not change between undo snapshots -- are held once. The store keeps only
+    // weak references: a blob is released with its last holder.
+    //
+    // Thread-safe; plug-ins report state from arbitrary threads.
+    class PluginStateStore {
+    public:
+        struct Configuration {
+            // States at least this large are compressed when that saves at
+            // least an eighth of their size. Zero disables compression.
+            size_t compressionThresholdInBytes{16 * 1024};
+        };
+
+        struct Statistics {
+            size_t blobCount{0};
+            // Sum of the original sizes of the live blobs.
+            size_t logicalSizeInBytes{0};
+            // Sum of what the live blobs occupy after compression.
+            size_t retainedSizeInBytes{0};
+            // intern() calls answered with an existing blob.
+            uint64_t sharedHits{0};
+        };
+
+        static PluginStateStore& instance();
+
+        PluginStateRef intern(std::vector<uint8_t> bytes);
+
+        void configure(Configuration configuration);
+        Statistics statistics() const;
+
+    private:
+        void purgeExpired();
+
+        mutable std::mutex mutex_;
+        Configuration configuration_{};
+        std::unordered_map<ProjectChunkId, std::weak_ptr<const PluginStateBlob>, ProjectChunkIdHash> blobs_;
+        uint64_t shared_hits_{0};
+        size_t interns_since_purge_{0};
+    };
+
+} // namespace uapmd
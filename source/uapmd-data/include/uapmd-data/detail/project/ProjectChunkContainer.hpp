@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace uapmd {
+
+    // Identifies a chunk by its content: the FNV-1a hash of its bytes and
+    // their length. Equal content always yields the same id, which is what
+    // lets a save skip chunks the container already holds.
+    struct ProjectChunkId {
+        uint64_t hash{0};
+        uint64_t size{0};
+
+        static ProjectChunkId of(std::span<const uint8_t> data);
+
+        bool operator==(const ProjectChunkId&) const = default;
+    };
+
+    struct ProjectChunkIdHash {
+        size_t operator()(const ProjectChunkId& id) const noexcept {
+            return static_cast<size_t>(id.hash ^ (id.size * 0x9E3779B97F4A7C15ull));
+        }
+    };
+
+    // Binary sidecar holding the bulky parts of a project -- plug-in states and
+    // MIDI clips -- next to its JSON manifest ("<project>.uapmdchunks").
+    //
+    // The manifest stays the source of truth for structure and refers to a
+    // chunk with a reference string (see makeReference()) where it would
+    // otherwise name a .state or .midi2 file.
+    //
+    // Layout: an 8-byte magic and version, the chunk payloads (each 8-byte
+    // aligned), an index of (hash, size, offset) entries, and a fixed trailer
+    // pointing at that index. Saves append new payloads and a fresh index;
+    // the previous index and chunks no longer referenced become dead space
+    // until the next compaction. The trailer carries a checksum, so that an
+    // append cut short by a crash falls back to the trailer before it.
+    //
+    // The index lists the chunks of the latest save ("live") followed by
+    // those only the save before it used, so the manifest that was on disk
+    // while the container was committed still loads if the new manifest
+    // never gets written.
+    class ProjectChunkContainer {
+    public:
+        static constexpr std::string_view kReferencePrefix = "uapmd-chunk:";
+
+        ~ProjectChunkContainer();
+        ProjectChunkContainer(const ProjectChunkContainer&) = delete;
+        ProjectChunkContainer& operator=(const ProjectChunkContainer&) = delete;
+
+        // The container that belongs to a project manifest.
+        static std::filesystem::path containerPathFor(const std::filesystem::path& projectFile);
+
+        static std::string makeReference(const ProjectChunkId& id);
+        static std::optional<ProjectChunkId> parseReference(std::string_view reference);
+        static bool isReference(std::string_view value) { return value.starts_with(kReferencePrefix); }
+
+        // Maps the container read-only and parses its index. Chunk contents
+        // are not touched until they are asked for, so a load only pages in
+        // what it actually restores. Returns nullptr and sets error if the
+        // file is missing or malformed.
+        static std::shared_ptr<const ProjectChunkContainer> open(
+            const std::filesystem::path& path,
+            std::string& error);
+
+        const std::filesystem::path& path() const { return path_; }
+        size_t fileSize() const { return size_; }
+        // Every indexed chunk, including those kept for the previous save.
+        size_t chunkCount() const { return index_.size(); }
+        size_t liveChunkCount() const { return live_.size(); }
+        // Whether the end of the file was an interrupted save, and the index
+        // is that of the save before it.
+        bool recoveredFromInterruptedSave() const { return end_ != size_; }
+        bool contains(const ProjectChunkId& id) const { return index_.contains(id); }
+
+        // A view into the mapping, valid for the lifetime of this object.
+        std::optional<std::span<const uint8_t>> chunk(const ProjectChunkId& id) const;
+        std::optional<std::vector<uint8_t>> readChunk(const ProjectChunkId& id) const;
+
+    private:
+        friend class ProjectChunkContainerWriter;
+        ProjectChunkContainer() = default;
+
+        std::filesystem::path path_;
+        const uint8_t* data_{nullptr};
+        size_t size_{0};
+        uint32_t version_{0};
+        // End of the trailer in use; the file past it is a torn append.
+        uint64_t end_{0};
+        uint64_t index_offset_{0};
+        std::unordered_map<ProjectChunkId, uint64_t, ProjectChunkIdHash> index_;
+        std::unordered_set<ProjectChunkId, ProjectChunkIdHash> live_;
+#if defined(_WIN32)
+        void* file_handle_{nullptr};
+        void* mapping_handle_{nullptr};
+#elif defined(__EMSCRIPTEN__)
+        std::vector<uint8_t> contents_;
+#endif
+    };
+
+    // Collects the chunks one save refers to and writes only those the
+    // existing container does not already hold.
+    //
+    // Not thread-safe; a save feeds it from one plug-in callback at a time.
+    class ProjectChunkContainerWriter {
+    public:
+        explicit ProjectChunkContainerWriter(std::filesystem::path containerFile);
+
+        // Registers data for this save and returns the manifest reference.
+        std::string add(std::vector<uint8_t> data);
+
+        // Appends the new chunks and a fresh index, or rewrites the container
+        // from scratch when appending would leave more dead space than live
+        // data, and flushes the file to disk. Must run before the manifest
+        // that refers to the chunks is written; the chunks of the save before
+        // stay indexed until the next commit, so a manifest write that fails
+        // leaves the old project loadable.
+        bool commit(std::string& error);
+
+        size_t writtenChunkCount() const { return written_chunks_; }
+        size_t reusedChunkCount() const { return reused_.size(); }
+
+    private:
+        std::filesystem::path path_;
+        std::shared_ptr<const ProjectChunkContainer> existing_;
+        std::vector<ProjectChunkId> order_;
+        std::unordered_map<ProjectChunkId, std::vector<uint8_t>, ProjectChunkIdHash> pending_;
+        std::unordered_set<ProjectChunkId, ProjectChunkIdHash> reused_;
+        size_t written_chunks_{0};
+    };
+
+} // namespace uapmd
@@ -25,6 +25,11 @@ namespace uapmd {
             const std::filesystem::path& relativePath,
             const std::vector<uint8_t>& data,
             std::string& error) = 0;
+
+        // Directory backing writeExtensionFile() for extensionId, for extensions
+        // that stream or copy large files instead of passing them through memory.
+        // Empty when the context is not filesystem-backed.
+        virtual std::filesystem::path extensionDataDirectory(std::string_view) const { return {}; }
     };
 
     class ProjectSerializationReadContext {
@@ -38,6 +43,9 @@ namespace uapmd {
             std::string_view extensionId,
             const std::filesystem::path& relativePath,
             std::string& error) = 0;
+
+        // See ProjectSerializationWriteContext::extensionDataDirectory().
+        virtual std::filesystem::path extensionDataDirectory(std::string_view) const { return {}; }
     };
 
     class ProjectSerializationExtension {
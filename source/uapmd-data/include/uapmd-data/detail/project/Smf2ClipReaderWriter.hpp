@@ -3,6 +3,7 @@
 #include <array>
 #include <filesystem>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -16,6 +17,9 @@ namespace uapmd {
     public:
         static std::optional<Smf2Clip> read(const std::filesystem::path& file, std::string* errorMessage = nullptr);
         static bool write(const std::filesystem::path& file, const Smf2Clip& clip, std::string* errorMessage = nullptr);
+        // The same file image, in memory, for clips stored inside a project chunk container.
+        static std::optional<Smf2Clip> decode(std::span<const uint8_t> bytes, std::string* errorMessage = nullptr);
+        static std::optional<std::vector<uint8_t>> encode(const Smf2Clip& clip, std::string* errorMessage = nullptr);
 
     private:
         static constexpr const char* kFileHeader = "SMF2CLIP";
@@ -33,7 +33,9 @@ struct StemSeparatorModelFileSpec {
     bool required() const { return !extensions.empty(); }
 };
 
-// Return false from the progress callback to cancel the separation.
+// Return false from the progress callback to cancel the separation. Progress
+// is reported from the thread that called separate(); shouldCancel may also be
+// polled from the separator's own worker threads, so it must be thread-safe.
 using StemSeparationProgressCallback = std::function<bool(float /*progress*/, const std::string& /*message*/)>;
 using StemSeparationCancelCallback = std::function<bool()>;
 
@@ -4,6 +4,7 @@
 #include <vector>
 #include <filesystem>
 #include <map>
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -74,6 +75,14 @@ namespace uapmd {
         // Used to restore fileless audio clips, such as an empty audio clip.
         virtual int64_t durationSamples() = 0;
         virtual void durationSamples(int64_t samples) = 0;
+        // Source offset and loop. A clip with a region keeps its saved duration.
+        virtual ClipRegion region() = 0;
+        virtual void region(ClipRegion value) = 0;
+        // Persistent id of an earlier clip whose content this clip plays, when
+        // they were linked (see TimelineFacade::addLinkedClip). The clip still
+        // names its own file, which is loaded when the link cannot be restored.
+        virtual std::string linkedReferenceId() = 0;
+        virtual void linkedReferenceId(const std::string& referenceId) = 0;
 
         static std::unique_ptr<UapmdProjectClipData> create();
     };
@@ -90,6 +99,9 @@ namespace uapmd {
         std::string display_name{};
         std::string state_file{};
         int32_t group_index{-1};
+        // AudioPluginInstanceAPI::sleepsWhenSilent(); absent keeps the
+        // instance's own default.
+        std::optional<bool> sleeps_when_silent{};
     };
 
     class UapmdProjectPluginGraphData {
@@ -11,6 +11,12 @@ namespace uapmd {
 
     // Timeline audio file source node
     // Plays back audio files as clips on the timeline
+    //
+    // Warps are applied while playing: the node keeps only the decoded audio
+    // and a map of warp segments, and a streaming time-stretcher reads ahead
+    // of the playhead. A seek primes the stretcher with pre-roll input so
+    // output starts on the sought position without latency. Offline renders
+    // use a separate, higher quality stretcher.
     class AudioFileSourceNode : public AudioSourceNode {
     public:
         AudioFileSourceNode(
@@ -24,8 +30,15 @@ namespace uapmd {
             double targetSampleRate,
             std::vector<AudioWarpPoint> audioWarps
         );
+        // Re-warps the decoded audio of `source` without reading the file
+        // again. The decoded audio is shared, not copied.
+        AudioFileSourceNode(
+            int32_t instanceId,
+            const AudioFileSourceNode& source,
+            std::vector<AudioWarpPoint> audioWarps
+        );
 
-        virtual ~AudioFileSourceNode() = default;
+        ~AudioFileSourceNode() override;
 
         // SourceNode interface
         int32_t instanceId() const override { return instance_id_; }
@@ -41,15 +54,30 @@ namespace uapmd {
         int64_t totalLength() const override;
         bool isPlaying() const override { return is_playing_.load(std::memory_order_acquire); }
         void setPlaying(bool playing) override { is_playing_.store(playing, std::memory_order_release); }
+        void setOfflineRendering(bool offline) override { offline_rendering_ = offline; }
         void processAudio(float** buffers, uint32_t numChannels, int32_t frameCount) override;
         uint32_t channelCount() const override { return channel_count_; }
 
         // Audio file specific
         double sampleRate() const { return sample_rate_; }
+        // Decoded frames, before warping.
         int64_t numFrames() const { return num_frames_; }
         const std::vector<AudioWarpPoint>& audioWarps() const { return audio_warps_; }
+        // True when both nodes play the same shared decoded audio.
+        bool sharesAudioWith(const AudioFileSourceNode& other) const { return audio_buffer_ == other.audio_buffer_; }
 
     private:
+        struct WarpSegment {
+            int64_t outputStart{0};
+            int64_t outputSamples{0};
+            int64_t inputStart{0};
+            int64_t inputSamples{0};
+        };
+        struct WarpStretcher;
+
+        void prepareWarps();
+        void processWarped(float** buffers, uint32_t numChannels, int32_t frameCount);
+
         int32_t instance_id_;
         bool bypassed_{false};
         std::atomic<bool> is_playing_{false};
@@ -57,13 +85,23 @@ namespace uapmd {
 
         // Audio file data (loaded into memory)
         std::unique_ptr<uapmd::AudioFileReader> reader_;
-        std::vector<std::vector<float>> audio_buffer_;  // Per-channel planar buffers
+        // Per-channel planar buffers; shared with re-warped copies of this node
+        std::shared_ptr<const std::vector<std::vector<float>>> audio_buffer_;
         uint32_t channel_count_{0};
         int64_t num_frames_{0};  // Number of frames at source sample rate
         double sample_rate_{0.0};  // Source file sample rate
         double target_sample_rate_{0.0};  // Target playback sample rate
         std::vector<AudioWarpPoint> audio_warps_;
 
+        // Warp playback state. Segments are immutable once built; the
+        // stretchers and cursors belong to the rendering thread.
+        std::vector<WarpSegment> warp_segments_;
+        int64_t warped_frames_{0};
+        double max_warp_rate_{1.0};
+        std::unique_ptr<WarpStretcher> realtime_stretcher_;
+        std::unique_ptr<WarpStretcher> offline_stretcher_;  // created on first offline use
+        bool offline_rendering_{false};
+
         // Resampling state
         std::atomic<double> source_position_{0.0};  // Current fractional position in source buffer
 
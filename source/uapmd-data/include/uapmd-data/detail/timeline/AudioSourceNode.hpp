@@ -16,6 +16,9 @@ namespace uapmd {
         virtual int64_t totalLength() const = 0;
         virtual bool isPlaying() const = 0;
         virtual void setPlaying(bool playing) = 0;
+        // Set before processAudio() while an offline render runs, where
+        // sources may trade speed for quality.
+        virtual void setOfflineRendering(bool offline) {}
 
         // Audio generation
         // Generates audio into the provided buffers
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace uapmd {
+
+    enum class AutomationInterpolation : uint8_t {
+        // Ramps linearly towards the next point.
+        Linear = 0,
+        // Keeps the value until the next point.
+        Hold = 1,
+    };
+
+    struct AutomationPoint {
+        int64_t samplePosition{0};
+        double value{0.0};
+        // How the value moves from this point to the next one.
+        AutomationInterpolation interpolation{AutomationInterpolation::Linear};
+    };
+
+    // A breakpoint curve over timeline samples. Before the first point the
+    // curve holds the first value and after the last point the last value.
+    // Several points at one position make a step: the last of them wins from
+    // that sample on.
+    //
+    // Immutable once built, so a published curve can be read by the audio
+    // thread without synchronization. Lookups are binary searches, so seeking
+    // costs the same anywhere in a long lane.
+    class AutomationCurve {
+    public:
+        AutomationCurve() = default;
+
+        explicit AutomationCurve(std::vector<AutomationPoint> points)
+            : points_(std::move(points)) {
+            std::stable_sort(points_.begin(), points_.end(),
+                [](const AutomationPoint& a, const AutomationPoint& b) {
+                    return a.samplePosition < b.samplePosition;
+                });
+        }
+
+        const std::vector<AutomationPoint>& points() const { return points_; }
+        bool empty() const { return points_.empty(); }
+
+        double valueAt(int64_t samplePosition) const {
+            if (points_.empty())
+                return 0.0;
+            return valueBefore(pointAfter(samplePosition), samplePosition);
+        }
+
+        // Calls emit(frameOffset, value) for the block [startSample,
+        // startSample + frameCount): once at frame 0, at every point inside the
+        // block, and every rampStepFrames frames while a linear segment is
+        // changing. Offsets are strictly increasing. Never allocates.
+        template<typename Emit>
+        void forEachChange(int64_t startSample, int32_t frameCount, int32_t rampStepFrames, Emit&& emit) const {
+            if (points_.empty() || frameCount <= 0)
+                return;
+            rampStepFrames = std::max(1, rampStepFrames);
+            int32_t frame = 0;
+            while (frame < frameCount) {
+                const auto position = startSample + frame;
+                const auto next = pointAfter(position);
+                emit(frame, valueBefore(next, position));
+
+                int64_t nextFrame = frameCount;
+                if (next != points_.end()) {
+                    nextFrame = std::min<int64_t>(nextFrame, next->samplePosition - startSample);
+                    const auto previous = next - 1;
+                    if (next != points_.begin() &&
+                        previous->interpolation == AutomationInterpolation::Linear &&
+                        previous->value != next->value)
+                        nextFrame = std::min<int64_t>(nextFrame, frame + rampStepFrames);
+                }
+                frame = static_cast<int32_t>(nextFrame);
+            }
+        }
+
+    private:
+        using Iterator = std::vector<AutomationPoint>::const_iterator;
+
+        // The first point strictly after samplePosition.
+        Iterator pointAfter(int64_t samplePosition) const {
+            return std::upper_bound(points_.begin(), points_.end(), samplePosition,
+                [](int64_t position, const AutomationPoint& point) {
+                    return position < point.samplePosition;
+                });
+        }
+
+        double valueBefore(Iterator next, int64_t samplePosition) const {
+            if (next == points_.begin())
+                return next->value;
+            const auto previous = next - 1;
+            if (next == points_.end() || previous->interpolation == AutomationInterpolation::Hold)
+                return previous->value;
+            const auto span = static_cast<double>(next->samplePosition - previous->samplePosition);
+            const auto t = static_cast<double>(samplePosition - previous->samplePosition) / span;
+            return previous->value + (next->value - previous->value) * t;
+        }
+
+        std::vector<AutomationPoint> points_{};
+    };
+
+} // namespace uapmd
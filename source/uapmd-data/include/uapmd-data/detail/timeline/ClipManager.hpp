@@ -46,6 +46,7 @@ namespace uapmd {
         bool setClipPosition(int32_t clipId, const TimelinePosition& position);
         bool setClipMarkers(int32_t clipId, std::vector<ClipMarker> markers);
         bool setAudioWarps(int32_t clipId, std::vector<AudioWarpPoint> audioWarps);
+        bool setClipRegion(int32_t clipId, const ClipRegion& region);
 
         // Query clips at timeline position (RT-safe after initial query)
         std::vector<ClipData> getActiveClipsAt(const TimelinePosition& position);
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <array>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <atomic>
 #include <cstdint>
@@ -11,6 +14,10 @@ namespace uapmd {
 
     // Concrete implementation of MIDI clip playback
     // Pre-loads UMP events and generates them sample-accurately during playback
+    //
+    // The events and their schedule are immutable once built, and linked
+    // nodes share them: any number of clips can play one event table while
+    // only the playback cursor is per node.
     class MidiClipSourceNode : public MidiSourceNode {
     public:
         // Constructor
@@ -30,6 +37,10 @@ namespace uapmd {
             std::vector<MidiTimeSignatureChange> timeSignatureChanges
         );
 
+        // A linked node: plays the same events as `source` and shares them
+        // instead of copying them.
+        MidiClipSourceNode(int32_t instanceId, const MidiClipSourceNode& source);
+
         ~MidiClipSourceNode() override = default;
 
         // SourceNode interface
@@ -53,6 +64,7 @@ namespace uapmd {
             double tempo,
             uint32_t frameOffsetInBlock = 0
         ) override;
+        void releaseHeldNotes(remidy::EventSequence& eventOut, uint32_t frameOffsetInBlock = 0) override;
 
         // NRPN intercept: when set, Assignable Controller (NRPN) events in this clip
         // are routed to the callback instead of being forwarded as raw UMP.
@@ -61,58 +73,81 @@ namespace uapmd {
         void setNrpnInterceptCallback(NrpnInterceptCallback cb) { nrpn_intercept_callback_ = std::move(cb); }
 
         // Access to clip data for UI/dump purposes
-        const std::vector<uapmd_ump_t>& umpEvents() const { return ump_events_; }
-        const std::vector<uint64_t>& eventTimestampsSamples() const { return event_timestamps_samples_; }
-        const std::vector<uint64_t>& eventTimestampsTicks() const { return event_timestamps_ticks_; }
-        const std::vector<MidiTempoChange>& tempoChanges() const { return tempo_changes_; }
-        const std::vector<MidiTimeSignatureChange>& timeSignatureChanges() const { return time_signature_changes_; }
-        const std::vector<uint64_t>& tempoChangeSamples() const { return tempo_change_samples_; }
-        const std::vector<uint64_t>& timeSignatureChangeSamples() const { return time_signature_change_samples_; }
-        uint32_t tickResolution() const { return tick_resolution_; }
-        double clipTempo() const { return clip_tempo_; }
+        const std::vector<uapmd_ump_t>& umpEvents() const { return content_->umpEvents; }
+        const std::vector<uint64_t>& eventTimestampsSamples() const { return schedule_->eventSamples; }
+        const std::vector<uint64_t>& eventTimestampsTicks() const { return content_->tickTimestamps; }
+        const std::vector<MidiTempoChange>& tempoChanges() const { return content_->tempoChanges; }
+        const std::vector<MidiTimeSignatureChange>& timeSignatureChanges() const { return content_->timeSignatureChanges; }
+        const std::vector<uint64_t>& tempoChangeSamples() const { return content_->tempoChangeSamples; }
+        const std::vector<uint64_t>& timeSignatureChangeSamples() const { return content_->timeSignatureChangeSamples; }
+        uint32_t tickResolution() const { return content_->tickResolution; }
+        double clipTempo() const { return content_->clipTempo; }
         void setPlaybackTempoMap(std::vector<MidiTempoChange> tempoChanges);
         void clearPlaybackTempoMap();
+        // True when both nodes play the same shared event table.
+        bool sharesEventsWith(const MidiClipSourceNode& other) const { return content_ == other.content_; }
 
     private:
+        // Event times in samples for one playback tempo map.
+        struct Schedule {
+            std::vector<MidiTempoChange> tempoChanges;
+            std::vector<uint64_t> eventSamples;
+            int64_t totalLengthSamples{0};
+        };
+
+        // Authored content; never modified after construction.
+        struct Content {
+            std::vector<uapmd_ump_t> umpEvents;           // Pre-loaded UMP messages
+            std::vector<uint64_t> tickTimestamps;         // Original tick timestamps (for UI/dump)
+            std::vector<MidiTempoChange> tempoChanges;
+            std::vector<MidiTimeSignatureChange> timeSignatureChanges;
+            std::vector<uint64_t> tempoChangeSamples;
+            std::vector<uint64_t> timeSignatureChangeSamples;
+            uint32_t tickResolution{480};
+            double clipTempo{120.0};
+            double targetSampleRate{48000.0};
+
+            // The schedule built most recently for any node sharing this
+            // content. Linked nodes given the same tempo map reuse it.
+            mutable std::mutex scheduleMutex;
+            mutable std::weak_ptr<const Schedule> lastSchedule;
+
+            std::vector<uint64_t> sampleTimeline(
+                const std::vector<uint64_t>& ticks,
+                const std::vector<MidiTempoChange>& tempoChanges) const;
+            std::shared_ptr<const Schedule> schedule(std::vector<MidiTempoChange> tempoChanges) const;
+        };
+
         int32_t instance_id_;
         bool bypassed_{false};
         std::atomic<bool> is_playing_{false};
         std::atomic<int64_t> playback_position_{0};  // In samples
 
-        // MIDI clip data
-        std::vector<uapmd_ump_t> ump_events_;           // Pre-loaded UMP messages
-        std::vector<uint64_t> event_timestamps_ticks_;   // Original tick timestamps (for UI/dump)
-        std::vector<uint64_t> event_timestamps_samples_; // Converted to samples (for playback)
-        std::vector<MidiTempoChange> tempo_changes_;
-        std::vector<MidiTempoChange> playback_tempo_changes_;
-        std::vector<MidiTimeSignatureChange> time_signature_changes_;
-        std::vector<uint64_t> tempo_change_samples_;
-        std::vector<uint64_t> time_signature_change_samples_;
-        uint32_t tick_resolution_;
-        double clip_tempo_;
-        double target_sample_rate_;
-        int64_t total_length_samples_{0};
+        std::shared_ptr<const Content> content_;
+        std::shared_ptr<const Schedule> schedule_;
 
         // Playback state
         std::atomic<size_t> next_event_index_{0};  // Next event to emit
 
+        // Notes started and not yet ended, packed as group << 11 | channel << 7 | note.
+        // Beyond the capacity, further notes are not tracked.
+        static constexpr size_t kMaxHeldNotes = 128;
+        std::array<uint16_t, kMaxHeldNotes> held_notes_{};
+        size_t held_note_count_{0};
+
         // Optional NRPN intercept callback (set once from non-audio thread)
         NrpnInterceptCallback nrpn_intercept_callback_{};
 
         // Helper: append one complete UMP message (all its words) to EventSequence.
         // words[0..wordCount-1] must be the consecutive uint32_t words of a single UMP message.
-        void appendUmpToEventSequence(
+        bool appendUmpToEventSequence(
             remidy::EventSequence& seq,
             const uapmd_ump_t* words,
             size_t wordCount,
             uint32_t frameOffset
         );
 
-        // Pre-compute sample timestamps using tempo change map
-        void rebuildSampleTimelines();
-        std::vector<uint64_t> computeSampleTimeline(
-            const std::vector<uint64_t>& ticks,
-            const std::vector<MidiTempoChange>& tempoChanges) const;
+        void trackHeldNote(const uapmd_ump_t* words, size_t wordCount);
     };
 
 } // namespace uapmd
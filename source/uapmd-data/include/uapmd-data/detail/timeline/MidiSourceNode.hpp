@@ -32,6 +32,14 @@ namespace uapmd {
             double tempo,
             uint32_t frameOffsetInBlock = 0
         ) = 0;
+
+        // Appends note-offs for the notes this source started and has not
+        // ended yet. Called where playback jumps within the source, such as
+        // the end of a loop, or stops before the source does.
+        virtual void releaseHeldNotes(
+            remidy::EventSequence& eventOut,
+            uint32_t frameOffsetInBlock = 0
+        ) = 0;
     };
 
 } // namespace uapmd
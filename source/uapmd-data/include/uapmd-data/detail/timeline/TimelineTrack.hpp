@@ -96,6 +96,10 @@ namespace uapmd {
         std::vector<std::vector<float>> temp_source_buffers_;   // [channel][samples]
         std::vector<float*> temp_source_buffer_ptrs_;
 
+        // Device input narrowed from a 64-bit track context, for device input
+        // sources; grown on first use.
+        std::vector<std::vector<float>> device_input_buffers_;   // [channel][samples]
+
         NrpnParameterCallback nrpn_parameter_callback_{};
 
         // Helper to ensure buffers are allocated
@@ -394,13 +394,39 @@ namespace uapmd {
         }
     };
 
+    // The part of a clip's source that the clip plays.
+    // Playback starts `sourceOffsetSamples` into the source. With a non-zero
+    // `loopLengthSamples`, the source range [sourceOffsetSamples,
+    // sourceOffsetSamples + loopLengthSamples) repeats for as long as the
+    // clip lasts; otherwise the source just plays on.
+    struct ClipRegion {
+        int64_t sourceOffsetSamples{0};
+        int64_t loopLengthSamples{0};
+
+        bool loops() const { return loopLengthSamples > 0; }
+
+        // Source position for a position relative to the clip start.
+        int64_t sourcePositionAt(int64_t clipOffsetSamples) const {
+            if (loops() && clipOffsetSamples >= 0)
+                clipOffsetSamples %= loopLengthSamples;
+            return sourceOffsetSamples + clipOffsetSamples;
+        }
+
+        bool operator==(const ClipRegion& other) const {
+            return sourceOffsetSamples == other.sourceOffsetSamples &&
+                   loopLengthSamples == other.loopLengthSamples;
+        }
+        bool operator!=(const ClipRegion& other) const { return !(*this == other); }
+    };
+
     // Represents a single clip on a track
     struct ClipData {
         int32_t clipId{-1};
         std::string referenceId;
         TimelinePosition position;          // Absolute position on timeline (calculated from anchor)
-        int64_t durationSamples{0};         // Duration of clip (full file length)
+        int64_t durationSamples{0};         // Duration of clip on the timeline
         int32_t sourceNodeInstanceId{-1};  // Which source node plays this clip
+        ClipRegion region;                  // Source offset and loop
 
         // Playback properties
         double gain{1.0};
@@ -457,8 +483,7 @@ namespace uapmd {
             anchorOffset = TimelinePosition::fromSeconds(reference.offset, sampleRate);
         }
 
-        // Note: Clip regions, looping, automation, and time-stretch NOT included in this phase
-        // Each clip plays the entire audio file from start to finish
+        // Note: Clip automation is NOT included in this phase
 
         ClipData() = default;
 
@@ -473,7 +498,7 @@ namespace uapmd {
         int64_t getSourcePosition(const TimelinePosition& timelinePos) const {
             if (!contains(timelinePos))
                 return -1;
-            return timelinePos.samples - position.samples;
+            return region.sourcePositionAt(timelinePos.samples - position.samples);
         }
 
         // Get the position within the source file, calculating absolute position from anchors
@@ -482,7 +507,7 @@ namespace uapmd {
             if (timelinePos.samples < absPos.samples ||
                 timelinePos.samples >= absPos.samples + durationSamples)
                 return -1;
-            return timelinePos.samples - absPos.samples;
+            return region.sourcePositionAt(timelinePos.samples - absPos.samples);
         }
 
         // Helper: Calculate absolute position from anchor
@@ -523,6 +548,7 @@ namespace uapmd {
     struct TimelineState {
         TimelinePosition playheadPosition;
         bool isPlaying{false};
+        bool offlineRendering{false};           // Rendering offline, not to the device
         bool loopEnabled{false};
         TimelinePosition loopStart;
         TimelinePosition loopEnd;
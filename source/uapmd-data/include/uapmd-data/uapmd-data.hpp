@@ -25,9 +25,12 @@
 #include "detail/project/AudioGraphProvider.hpp"
 #include "detail/project/UapmdPluginGraphBuilder.hpp"
 #include "detail/project/ProjectArchive.hpp"
+#include "detail/project/ProjectChunkContainer.hpp"
+#include "detail/project/PluginStateStore.hpp"
 #include "detail/timeline/TimelineTypes.hpp"
 #include "detail/timeline/TimeReferenceResolver.hpp"
 #include "detail/timeline/TempoMap.hpp"
+#include "detail/timeline/AutomationCurve.hpp"
 #include "detail/timeline/AudioFileSourceNode.hpp"
 #include "detail/timeline/TimelineTrack.hpp"
 #include "detail/timeline/ClipManager.hpp"
@@ -64,6 +64,13 @@ namespace uapmd {
                 return result;
             }
 
+            void collectSharedPayloads(std::vector<ProjectHistorySharedPayload>& payloads) const override {
+                if (forward_)
+                    forward_->collectSharedPayloads(payloads);
+                if (backward_)
+                    backward_->collectSharedPayloads(payloads);
+            }
+
             // A command that registered no revert changed nothing, so the
             // history engine drops the entry. This is what replaces the
             // "if (before == after) return true;" early-out that every
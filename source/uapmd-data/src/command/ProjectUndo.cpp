@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <optional>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -72,6 +74,12 @@ namespace uapmd {
                 return result;
             }
 
+            void collectSharedPayloads(std::vector<ProjectHistorySharedPayload>& payloads) const override {
+                for (const auto& child : children_)
+                    if (child)
+                        child->collectSharedPayloads(payloads);
+            }
+
             void perform(
                 const ProjectUndoExecutionContext& context,
                 ProjectUndoCompletion completion) override {
@@ -224,7 +232,10 @@ namespace uapmd {
             std::shared_ptr<ProjectUndoableOperation> operation{};
             uint64_t beforeStateId{0};
             uint64_t afterStateId{0};
+            // Excludes sharedPayloads, which are charged through
+            // shared_payload_holders_.
             size_t sizeInBytes{0};
+            std::vector<ProjectHistorySharedPayload> sharedPayloads{};
         };
 
         struct Pending {
@@ -255,10 +266,17 @@ namespace uapmd {
 
         ProjectUndoState state() const {
             size_t retainedHistorySize = history_size_in_bytes_;
-            if (compound_)
+            if (compound_) {
+                std::vector<ProjectHistorySharedPayload> payloads;
                 for (const auto& child : compound_->children)
-                    if (child)
+                    if (child) {
                         retainedHistorySize += child->historySizeInBytes();
+                        child->collectSharedPayloads(payloads);
+                    }
+                for (const auto& payload : uniquePayloads(std::move(payloads)))
+                    if (!shared_payload_holders_.contains(payload.payload.get()))
+                        retainedHistorySize += payload.sizeInBytes;
+            }
             return {
                 .busy = pending_.has_value() || compound_.has_value(),
                 .compoundOpen = compound_.has_value(),
@@ -639,13 +657,20 @@ namespace uapmd {
         void finishPerform(std::shared_ptr<ProjectUndoableOperation> operation) {
             clearEntries(redo_stack_);
             const auto size = operation->historySizeInBytes();
+            std::vector<ProjectHistorySharedPayload> payloads;
+            operation->collectSharedPayloads(payloads);
+            payloads = uniquePayloads(std::move(payloads));
+            for (const auto& payload : payloads)
+                if (shared_payload_holders_[payload.payload.get()]++ == 0)
+                    history_size_in_bytes_ += payload.sizeInBytes;
             const auto beforeStateId = current_state_id_;
             const auto afterStateId = next_state_id_++;
             undo_stack_.push_back({
                 .operation = std::move(operation),
                 .beforeStateId = beforeStateId,
                 .afterStateId = afterStateId,
-                .sizeInBytes = size
+                .sizeInBytes = size,
+                .sharedPayloads = std::move(payloads)
             });
             history_size_in_bytes_ += size;
             current_state_id_ = afterStateId;
@@ -671,17 +696,38 @@ namespace uapmd {
             // otherwise a successful edit could become non-undoable immediately.
             while (history_size_in_bytes_ > maximum_history_size_in_bytes_
                 && undo_stack_.size() > 1) {
-                history_size_in_bytes_ -= undo_stack_.front().sizeInBytes;
+                release(undo_stack_.front());
                 undo_stack_.erase(undo_stack_.begin());
             }
         }
 
         void clearEntries(std::vector<Entry>& entries) {
             for (const auto& entry : entries)
-                history_size_in_bytes_ -= std::min(history_size_in_bytes_, entry.sizeInBytes);
+                release(entry);
             entries.clear();
         }
 
+        void release(const Entry& entry) {
+            history_size_in_bytes_ -= std::min(history_size_in_bytes_, entry.sizeInBytes);
+            for (const auto& payload : entry.sharedPayloads) {
+                auto it = shared_payload_holders_.find(payload.payload.get());
+                if (it == shared_payload_holders_.end() || --it->second > 0)
+                    continue;
+                shared_payload_holders_.erase(it);
+                history_size_in_bytes_ -= std::min(history_size_in_bytes_, payload.sizeInBytes);
+            }
+        }
+
+        // One entry can reach the same payload from both of its directions.
+        static std::vector<ProjectHistorySharedPayload> uniquePayloads(
+            std::vector<ProjectHistorySharedPayload> payloads) {
+            std::unordered_set<const void*> seen;
+            std::erase_if(payloads, [&seen](const ProjectHistorySharedPayload& payload) {
+                return !payload.payload || !seen.insert(payload.payload.get()).second;
+            });
+            return payloads;
+        }
+
         static void completeClient(
             ProjectUndoCompletion completion,
             ProjectUndoResult result) {
@@ -691,6 +737,8 @@ namespace uapmd {
 
         size_t maximum_history_size_in_bytes_{0};
         size_t history_size_in_bytes_{0};
+        // Entries holding each shared payload; it is charged while non-zero.
+        std::unordered_map<const void*, size_t> shared_payload_holders_{};
         ProjectModelThreadDispatcher dispatch_to_model_thread_{};
         std::thread::id model_thread_id_{};
         std::vector<Entry> undo_stack_{};
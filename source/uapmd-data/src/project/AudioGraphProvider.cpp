@@ -231,6 +231,8 @@ void parsePluginListPayload(const choc::value::ValueView& root, GraphT& graph) {
                 node.state_file = std::string(pluginObj["state_file"].getString());
             if (pluginObj.hasObjectMember("group_index"))
                 node.group_index = pluginObj["group_index"].getWithDefault<int32_t>(-1);
+            if (pluginObj.hasObjectMember("sleeps_when_silent"))
+                node.sleeps_when_silent = pluginObj["sleeps_when_silent"].getWithDefault<bool>(false);
             graph.addPlugin(std::move(node));
         }
     }
@@ -255,6 +257,8 @@ choc::value::Value serializePluginListPayload(GraphT& graph) {
             pluginObj.addMember("display_name", plugin.display_name);
             pluginObj.addMember("state_file", plugin.state_file);
             pluginObj.addMember("group_index", static_cast<int64_t>(plugin.group_index));
+            if (plugin.sleeps_when_silent)
+                pluginObj.addMember("sleeps_when_silent", *plugin.sleeps_when_silent);
             pluginsArray.addArrayElement(pluginObj);
         }
         obj.addMember("plugins", pluginsArray);
@@ -605,6 +609,7 @@ void populateProjectGraphPlugins(
         nodeData.plugin_id = instance->pluginId();
         nodeData.format = instance->formatName();
         nodeData.display_name = instance->displayName();
+        nodeData.sleeps_when_silent = instance->sleepsWhenSilent();
         graphData.addPlugin(std::move(nodeData));
 
         auto nodeIndex = graphData.plugins().size() - 1;
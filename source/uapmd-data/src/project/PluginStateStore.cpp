@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <zlib.h>
+
+#include <uapmd-data/uapmd-data.hpp>
+
+namespace uapmd {
+
+namespace {
+
+// Expired entries are swept after this many interns rather than on every one.
+constexpr size_t kPurgeInterval = 256;
+
+bool compressInto(const std::vector<uint8_t>& source, std::vector<uint8_t>& destination) {
+    uLongf destinationSize = compressBound(static_cast<uLong>(source.size()));
+    destination.resize(destinationSize);
+    // States are compressed on the model thread while the user waits for an
+    // edit to land, so speed matters more than ratio.
+    if (compress2(destination.data(), &destinationSize, source.data(),
+                  static_cast<uLong>(source.size()), Z_BEST_SPEED) != Z_OK)
+        return false;
+    destination.resize(destinationSize);
+    destination.shrink_to_fit();
+    return true;
+}
+
+} // namespace
+
+std::vector<uint8_t> PluginStateBlob::bytes() const {
+    if (!compressed_)
+        return data_;
+    std::vector<uint8_t> result(size());
+    uLongf resultSize = static_cast<uLongf>(result.size());
+    if (uncompress(result.data(), &resultSize, data_.data(), static_cast<uLong>(data_.size())) != Z_OK
+        || resultSize != result.size())
+        return {};
+    return result;
+}
+
+PluginStateStore& PluginStateStore::instance() {
+    static PluginStateStore store;
+    return store;
+}
+
+PluginStateRef PluginStateStore::intern(std::vector<uint8_t> bytes) {
+    const auto id = ProjectChunkId::of(bytes);
+
+    std::lock_guard lock(mutex_);
+    if (++interns_since_purge_ >= kPurgeInterval)
+        purgeExpired();
+
+    if (auto it = blobs_.find(id); it != blobs_.end()) {
+        if (auto existing = it->second.lock()) {
+            // The id is only a hash; identical content is confirmed before
+            // the existing blob is shared.
+            if (existing->bytes() == bytes) {
+                ++shared_hits_;
+                return existing;
+            }
+            // A collision keeps the first blob indexed and leaves this one
+            // unshared.
+            std::shared_ptr<PluginStateBlob> unshared(new PluginStateBlob());
+            unshared->id_ = id;
+            unshared->data_ = std::move(bytes);
+            return unshared;
+        }
+    }
+
+    std::shared_ptr<PluginStateBlob> blob(new PluginStateBlob());
+    blob->id_ = id;
+    const auto threshold = configuration_.compressionThresholdInBytes;
+    std::vector<uint8_t> compressed;
+    if (threshold > 0 && bytes.size() >= threshold && compressInto(bytes, compressed)
+        && compressed.size() <= bytes.size() - bytes.size() / 8) {
+        blob->data_ = std::move(compressed);
+        blob->compressed_ = true;
+    } else {
+        blob->data_ = std::move(bytes);
+    }
+    blobs_[id] = blob;
+    return blob;
+}
+
+void PluginStateStore::configure(Configuration configuration) {
+    std::lock_guard lock(mutex_);
+    configuration_ = configuration;
+}
+
+PluginStateStore::Statistics PluginStateStore::statistics() const {
+    std::lock_guard lock(mutex_);
+    Statistics result;
+    result.sharedHits = shared_hits_;
+    for (const auto& [id, weak] : blobs_) {
+        auto blob = weak.lock();
+        if (!blob)
+            continue;
+        ++result.blobCount;
+        result.logicalSizeInBytes += blob->size();
+        result.retainedSizeInBytes += blob->retainedSizeInBytes();
+    }
+    return result;
+}
+
+void PluginStateStore::purgeExpired() {
+    interns_since_purge_ = 0;
+    std::erase_if(blobs_, [](const auto& entry) { return entry.second.expired(); });
+}
+
+} // namespace uapmd
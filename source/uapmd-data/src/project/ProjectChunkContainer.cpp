@@ -0,0 +1,538 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <format>
+#include <fstream>
+
+#include <uapmd-data/uapmd-data.hpp>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace uapmd {
+
+namespace {
+
+constexpr std::array<char, 8> kMagic{'U', 'A', 'P', 'M', 'D', 'C', 'H', 'K'};
+constexpr std::array<char, 8> kTrailerMagicV1{'U', 'C', 'H', 'K', 'I', 'D', 'X', '1'};
+constexpr std::array<char, 8> kTrailerMagicV2{'U', 'C', 'H', 'K', 'I', 'D', 'X', '2'};
+constexpr std::array<char, 8> kTrailerMagic{'U', 'C', 'H', 'K', 'I', 'D', 'X', '3'};
+constexpr uint32_t kVersion = 3;
+constexpr uint64_t kAlignment = 8;
+
+// The structs below are written and read in native byte order, and the
+// format is little-endian.
+static_assert(std::endian::native == std::endian::little,
+              "ProjectChunkContainer reads and writes its structs in native byte order");
+
+struct FileHeader {
+    std::array<char, 8> magic{kMagic};
+    uint32_t version{kVersion};
+    uint32_t reserved{0};
+};
+static_assert(sizeof(FileHeader) == 16);
+
+struct IndexEntry {
+    uint64_t hash{0};
+    uint64_t size{0};
+    uint64_t offset{0};
+};
+static_assert(sizeof(IndexEntry) == 24);
+
+// The first live_count index entries are the chunks of the latest save; the
+// rest are kept for the save before it (see ProjectChunkContainerWriter).
+// The checksum covers the index and the three counts, so that open() can tell
+// a complete trailer from the torn end of an interrupted append.
+struct Trailer {
+    uint64_t index_offset{0};
+    uint64_t index_count{0};
+    uint64_t live_count{0};
+    uint64_t checksum{0};
+    std::array<char, 8> magic{kTrailerMagic};
+};
+static_assert(sizeof(Trailer) == 40);
+
+// Version 2 had no checksum, so only the trailer at the end was trusted.
+struct TrailerV2 {
+    uint64_t index_offset{0};
+    uint64_t index_count{0};
+    uint64_t live_count{0};
+    std::array<char, 8> magic{kTrailerMagicV2};
+};
+static_assert(sizeof(TrailerV2) == 32);
+
+// Version 1 indexed the latest save only.
+struct TrailerV1 {
+    uint64_t index_offset{0};
+    uint64_t index_count{0};
+    std::array<char, 8> magic{kTrailerMagicV1};
+};
+static_assert(sizeof(TrailerV1) == 24);
+
+uint64_t alignUp(uint64_t value) {
+    return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// FNV-1a, for chunk ids and trailer checksums.
+constexpr uint64_t kHashOffset = 14695981039346656037ull;
+
+uint64_t continueHash(uint64_t hash, const void* data, size_t size) {
+    constexpr uint64_t kPrime = 1099511628211ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<const uint8_t*>(data)[i];
+        hash *= kPrime;
+    }
+    return hash;
+}
+
+uint64_t trailerChecksum(const void* index, const Trailer& trailer) {
+    auto hash = continueHash(kHashOffset, index,
+                             static_cast<size_t>(trailer.index_count) * sizeof(IndexEntry));
+    return continueHash(hash, &trailer, offsetof(Trailer, checksum));
+}
+
+// Flushes a file's data to the device, so that whatever is written after it,
+// such as the manifest, can never be on disk without it.
+bool syncToDisk(const std::filesystem::path& path) {
+#if defined(_WIN32)
+    auto handle = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+    const bool synced = FlushFileBuffers(handle) != 0;
+    CloseHandle(handle);
+    return synced;
+#elif defined(__EMSCRIPTEN__)
+    (void) path;
+    return true;
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    const bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+#endif
+}
+
+bool writePadding(std::ostream& out, uint64_t& position) {
+    static constexpr std::array<char, kAlignment> kZeros{};
+    const auto aligned = alignUp(position);
+    if (aligned == position)
+        return true;
+    out.write(kZeros.data(), static_cast<std::streamsize>(aligned - position));
+    position = aligned;
+    return static_cast<bool>(out);
+}
+
+bool writeIndexAndTrailer(
+    std::ostream& out,
+    uint64_t& position,
+    const std::vector<IndexEntry>& entries,
+    size_t liveCount) {
+    if (!writePadding(out, position))
+        return false;
+    Trailer trailer;
+    trailer.index_offset = position;
+    trailer.index_count = entries.size();
+    trailer.live_count = liveCount;
+    trailer.checksum = trailerChecksum(entries.data(), trailer);
+    if (!entries.empty())
+        out.write(reinterpret_cast<const char*>(entries.data()),
+                  static_cast<std::streamsize>(entries.size() * sizeof(IndexEntry)));
+    out.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+    position += entries.size() * sizeof(IndexEntry) + sizeof(trailer);
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+// ── ProjectChunkId ────────────────────────────────────────────────────────────
+
+ProjectChunkId ProjectChunkId::of(std::span<const uint8_t> data) {
+    return {continueHash(kHashOffset, data.data(), data.size()), data.size()};
+}
+
+// ── ProjectChunkContainer ─────────────────────────────────────────────────────
+
+ProjectChunkContainer::~ProjectChunkContainer() {
+#if defined(_WIN32)
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (mapping_handle_)
+        CloseHandle(static_cast<HANDLE>(mapping_handle_));
+    if (file_handle_ && file_handle_ != INVALID_HANDLE_VALUE)
+        CloseHandle(static_cast<HANDLE>(file_handle_));
+#elif !defined(__EMSCRIPTEN__)
+    if (data_)
+        munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+}
+
+std::filesystem::path ProjectChunkContainer::containerPathFor(const std::filesystem::path& projectFile) {
+    auto path = projectFile;
+    path.replace_extension(".uapmdchunks");
+    return path;
+}
+
+std::string ProjectChunkContainer::makeReference(const ProjectChunkId& id) {
+    return std::format("{}{:016x}-{}", kReferencePrefix, id.hash, id.size);
+}
+
+std::optional<ProjectChunkId> ProjectChunkContainer::parseReference(std::string_view reference) {
+    if (!isReference(reference))
+        return std::nullopt;
+    reference.remove_prefix(kReferencePrefix.size());
+    const auto dash = reference.find('-');
+    if (dash == std::string_view::npos)
+        return std::nullopt;
+
+    ProjectChunkId id;
+    const auto hashText = reference.substr(0, dash);
+    const auto sizeText = reference.substr(dash + 1);
+    auto [hashEnd, hashEc] = std::from_chars(hashText.data(), hashText.data() + hashText.size(), id.hash, 16);
+    auto [sizeEnd, sizeEc] = std::from_chars(sizeText.data(), sizeText.data() + sizeText.size(), id.size);
+    if (hashEc != std::errc{} || hashEnd != hashText.data() + hashText.size() ||
+        sizeEc != std::errc{} || sizeEnd != sizeText.data() + sizeText.size())
+        return std::nullopt;
+    return id;
+}
+
+std::shared_ptr<const ProjectChunkContainer> ProjectChunkContainer::open(
+    const std::filesystem::path& path,
+    std::string& error) {
+    std::shared_ptr<ProjectChunkContainer> file(new ProjectChunkContainer());
+    file->path_ = path;
+
+#if defined(_WIN32)
+    auto handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        error = "Failed to open project chunk container: " + path.string();
+        return nullptr;
+    }
+    file->file_handle_ = handle;
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart <= 0) {
+        error = "Failed to query project chunk container size: " + path.string();
+        return nullptr;
+    }
+    file->size_ = static_cast<size_t>(size.QuadPart);
+    file->mapping_handle_ = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!file->mapping_handle_) {
+        error = "Failed to map project chunk container: " + path.string();
+        return nullptr;
+    }
+    file->data_ = static_cast<const uint8_t*>(
+        MapViewOfFile(static_cast<HANDLE>(file->mapping_handle_), FILE_MAP_READ, 0, 0, 0));
+#elif defined(__EMSCRIPTEN__)
+    // The Emscripten filesystem is memory-backed already; mapping buys nothing.
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "Failed to open project chunk container: " + path.string();
+        return nullptr;
+    }
+    file->contents_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    file->size_ = file->contents_.size();
+    file->data_ = file->contents_.data();
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "Failed to open project chunk container: " + path.string();
+        return nullptr;
+    }
+    struct stat status{};
+    if (fstat(fd, &status) != 0 || status.st_size <= 0) {
+        ::close(fd);
+        error = "Failed to query project chunk container size: " + path.string();
+        return nullptr;
+    }
+    file->size_ = static_cast<size_t>(status.st_size);
+    void* mapped = mmap(nullptr, file->size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        error = "Failed to map project chunk container: " + path.string();
+        return nullptr;
+    }
+    file->data_ = static_cast<const uint8_t*>(mapped);
+#endif
+    if (!file->data_ || file->size_ < sizeof(FileHeader) + sizeof(TrailerV1)) {
+        error = "Project chunk container is truncated: " + path.string();
+        return nullptr;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, file->data_, sizeof(header));
+    if (header.magic != kMagic || header.version < 1 || header.version > kVersion) {
+        error = "Unsupported or damaged project chunk container: " + path.string();
+        return nullptr;
+    }
+    // Whether a trailer describes an index that lies in the file before indexEnd.
+    const auto plausible = [](const Trailer& trailer, uint64_t indexEnd) {
+        return trailer.magic == kTrailerMagic &&
+            trailer.index_offset >= sizeof(FileHeader) && trailer.index_offset <= indexEnd &&
+            trailer.index_count <= (indexEnd - trailer.index_offset) / sizeof(IndexEntry) &&
+            trailer.live_count <= trailer.index_count;
+    };
+
+    Trailer trailer;
+    uint64_t end = 0;
+    if (header.version == 1) {
+        TrailerV1 old;
+        std::memcpy(&old, file->data_ + file->size_ - sizeof(old), sizeof(old));
+        trailer.index_offset = old.index_offset;
+        trailer.index_count = trailer.live_count = old.index_count;
+        trailer.magic = old.magic == kTrailerMagicV1 ? kTrailerMagic : old.magic;
+        if (plausible(trailer, file->size_ - sizeof(old)))
+            end = file->size_;
+    } else if (header.version == 2) {
+        TrailerV2 old;
+        std::memcpy(&old, file->data_ + file->size_ - sizeof(old), sizeof(old));
+        trailer.index_offset = old.index_offset;
+        trailer.index_count = old.index_count;
+        trailer.live_count = old.live_count;
+        trailer.magic = old.magic == kTrailerMagicV2 ? kTrailerMagic : old.magic;
+        if (plausible(trailer, file->size_ - sizeof(old)))
+            end = file->size_;
+    } else {
+        // An append that was cut short leaves a torn tail after the trailer
+        // of the save before it, which appends never overwrite. The last
+        // trailer right behind its index and with a matching checksum is the
+        // latest complete save.
+        for (auto candidate = file->size_ / kAlignment * kAlignment;
+             candidate >= sizeof(FileHeader) + sizeof(Trailer); candidate -= kAlignment) {
+            const auto indexEnd = candidate - sizeof(Trailer);
+            std::memcpy(&trailer, file->data_ + indexEnd, sizeof(trailer));
+            if (plausible(trailer, indexEnd) &&
+                trailer.index_offset + trailer.index_count * sizeof(IndexEntry) == indexEnd &&
+                trailer.checksum == trailerChecksum(file->data_ + trailer.index_offset, trailer)) {
+                end = candidate;
+                break;
+            }
+        }
+    }
+    if (end == 0) {
+        error = "Unsupported or damaged project chunk container: " + path.string();
+        return nullptr;
+    }
+
+    file->version_ = header.version;
+    file->end_ = end;
+    file->index_offset_ = trailer.index_offset;
+    file->index_.reserve(static_cast<size_t>(trailer.index_count));
+    file->live_.reserve(static_cast<size_t>(trailer.live_count));
+    for (uint64_t i = 0; i < trailer.index_count; ++i) {
+        IndexEntry entry;
+        std::memcpy(&entry, file->data_ + trailer.index_offset + i * sizeof(IndexEntry), sizeof(entry));
+        if (entry.offset < sizeof(FileHeader) || entry.offset > trailer.index_offset ||
+            entry.size > trailer.index_offset - entry.offset) {
+            error = "Project chunk container index is damaged: " + path.string();
+            return nullptr;
+        }
+        file->index_[ProjectChunkId{entry.hash, entry.size}] = entry.offset;
+        if (i < trailer.live_count)
+            file->live_.insert(ProjectChunkId{entry.hash, entry.size});
+    }
+    return file;
+}
+
+std::optional<std::span<const uint8_t>> ProjectChunkContainer::chunk(const ProjectChunkId& id) const {
+    auto it = index_.find(id);
+    if (it == index_.end())
+        return std::nullopt;
+    return std::span<const uint8_t>(data_ + it->second, static_cast<size_t>(id.size));
+}
+
+std::optional<std::vector<uint8_t>> ProjectChunkContainer::readChunk(const ProjectChunkId& id) const {
+    auto view = chunk(id);
+    if (!view)
+        return std::nullopt;
+    return std::vector<uint8_t>(view->begin(), view->end());
+}
+
+// ── ProjectChunkContainerWriter ───────────────────────────────────────────────
+
+ProjectChunkContainerWriter::ProjectChunkContainerWriter(std::filesystem::path containerFile)
+    : path_(std::move(containerFile)) {
+    std::error_code ec;
+    if (std::filesystem::exists(path_, ec)) {
+        // A damaged or foreign container is simply rewritten.
+        std::string ignored;
+        existing_ = ProjectChunkContainer::open(path_, ignored);
+    }
+}
+
+std::string ProjectChunkContainerWriter::add(std::vector<uint8_t> data) {
+    const auto id = ProjectChunkId::of(data);
+    if (!pending_.contains(id) && !reused_.contains(id)) {
+        order_.push_back(id);
+        auto existing = existing_ ? existing_->chunk(id) : std::nullopt;
+        // The id is only a hash; identical content is confirmed byte by byte
+        // before the stored copy is trusted.
+        if (existing && std::equal(existing->begin(), existing->end(), data.begin(), data.end()))
+            reused_.insert(id);
+        else
+            pending_.emplace(id, std::move(data));
+    }
+    return ProjectChunkContainer::makeReference(id);
+}
+
+bool ProjectChunkContainerWriter::commit(std::string& error) {
+    // The manifest on disk still refers to the previous save's chunks until
+    // the new one replaces it, so those stay indexed, after this save's own,
+    // for one more save. Anything older is no longer referenced by any
+    // manifest that can exist.
+    std::unordered_set<ProjectChunkId, ProjectChunkIdHash> current(order_.begin(), order_.end());
+    std::vector<ProjectChunkId> retained;
+    if (existing_)
+        for (const auto& id : existing_->live_)
+            // A colliding pending chunk replaces the stored one under its id.
+            if (!current.contains(id) && !pending_.contains(id))
+                retained.push_back(id);
+
+    // Every chunk is already stored as the latest save's: the file on disk
+    // already serves both this save and the manifest it replaces.
+    if (existing_ && pending_.empty() && existing_->live_ == current) {
+        written_chunks_ = 0;
+        return true;
+    }
+
+    const uint64_t indexBytes = (order_.size() + retained.size()) * sizeof(IndexEntry);
+    uint64_t liveBytes = sizeof(FileHeader) + sizeof(Trailer) + indexBytes;
+    uint64_t appendedBytes = sizeof(Trailer) + indexBytes;
+    for (const auto& id : order_) {
+        liveBytes += alignUp(id.size);
+        if (pending_.contains(id))
+            appendedBytes += alignUp(id.size);
+    }
+    for (const auto& id : retained)
+        liveBytes += alignUp(id.size);
+
+    // A hash collision against an existing chunk cannot be appended under the
+    // same id, so it forces a rewrite in which the new content wins.
+    bool collides = false;
+    if (existing_)
+        for (const auto& [id, data] : pending_)
+            if (existing_->contains(id))
+                collides = true;
+
+    // A version 1 file is rewritten, since its trailer has no live count.
+    const bool append = existing_ && existing_->version_ == kVersion && !collides
+        && existing_->end_ + appendedBytes <= 2 * liveBytes;
+
+    if (append) {
+        std::vector<IndexEntry> entries;
+        entries.reserve(order_.size() + retained.size());
+        for (const auto& id : order_)
+            if (!pending_.contains(id))
+                entries.push_back({id.hash, id.size, existing_->index_.at(id)});
+        std::vector<IndexEntry> retainedEntries;
+        retainedEntries.reserve(retained.size());
+        for (const auto& id : retained)
+            retainedEntries.push_back({id.hash, id.size, existing_->index_.at(id)});
+        // Appends go after the last complete save, cutting away the torn
+        // tail of one that was interrupted.
+        const uint64_t originalSize = existing_->end_;
+        const bool truncate = existing_->end_ != existing_->fileSize();
+        existing_.reset();
+        std::error_code truncateEc;
+        if (truncate)
+            std::filesystem::resize_file(path_, originalSize, truncateEc);
+
+        std::fstream out(path_, std::ios::binary | std::ios::in | std::ios::out);
+        out.seekp(static_cast<std::streamoff>(originalSize));
+        uint64_t position = originalSize;
+        bool ok = !truncateEc && static_cast<bool>(out);
+        for (const auto& id : order_) {
+            auto it = pending_.find(id);
+            if (!ok || it == pending_.end())
+                continue;
+            ok = writePadding(out, position);
+            entries.push_back({id.hash, id.size, position});
+            out.write(reinterpret_cast<const char*>(it->second.data()),
+                      static_cast<std::streamsize>(it->second.size()));
+            position += it->second.size();
+            ok = ok && static_cast<bool>(out);
+        }
+        entries.insert(entries.end(), retainedEntries.begin(), retainedEntries.end());
+        ok = ok && writeIndexAndTrailer(out, position, entries, order_.size());
+        out.flush();
+        ok = ok && static_cast<bool>(out);
+        out.close();
+        ok = ok && syncToDisk(path_);
+        if (!ok) {
+            // Cut the partial append away so the previous index stays valid.
+            std::error_code ec;
+            std::filesystem::resize_file(path_, originalSize, ec);
+            error = "Failed to append to project chunk container: " + path_.string();
+            return false;
+        }
+        written_chunks_ = pending_.size();
+        return true;
+    }
+
+    auto tempPath = path_;
+    tempPath += ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        FileHeader header;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        uint64_t position = sizeof(header);
+        std::vector<IndexEntry> entries;
+        entries.reserve(order_.size() + retained.size());
+        std::vector<ProjectChunkId> all(order_);
+        all.insert(all.end(), retained.begin(), retained.end());
+        bool ok = static_cast<bool>(out);
+        for (const auto& id : all) {
+            std::span<const uint8_t> bytes;
+            if (auto it = pending_.find(id); it != pending_.end())
+                bytes = it->second;
+            else if (auto stored = existing_ ? existing_->chunk(id) : std::nullopt)
+                bytes = *stored;
+            ok = ok && writePadding(out, position);
+            entries.push_back({id.hash, id.size, position});
+            out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            position += bytes.size();
+            ok = ok && static_cast<bool>(out);
+        }
+        ok = ok && writeIndexAndTrailer(out, position, entries, order_.size());
+        out.flush();
+        ok = ok && static_cast<bool>(out);
+        out.close();
+        ok = ok && syncToDisk(tempPath);
+        if (!ok) {
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            error = "Failed to write project chunk container: " + tempPath.string();
+            return false;
+        }
+    }
+
+    // The mapping must go before the rename replaces the file underneath it.
+    existing_.reset();
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path_, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        error = std::format("Failed to replace project chunk container {}: {}", path_.string(), ec.message());
+        return false;
+    }
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+    // The rename itself is durable once the directory is.
+    syncToDisk(path_.parent_path().empty() ? std::filesystem::path(".") : path_.parent_path());
+#endif
+    written_chunks_ = order_.size();
+    reused_.clear();
+    return true;
+}
+
+} // namespace uapmd
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <uapmd-data/uapmd-data.hpp>
@@ -288,6 +289,17 @@ MidiClipSourceNode* findAuthoritativeTimelineMetaSource(const std::shared_ptr<Ti
         return result;
     }
 
+    MidiClipReader::ClipInfo MidiClipReader::readSmf2Clip(std::span<const uint8_t> bytes) {
+        ClipInfo result;
+        std::string errorMessage;
+        auto clipData = Smf2ClipReaderWriter::decode(bytes, &errorMessage);
+        if (!clipData || !populateClipInfoFromSmf2Clip(*clipData, result, errorMessage)) {
+            result.success = false;
+            result.error = errorMessage;
+        }
+        return result;
+    }
+
     MidiClipReader::SeparatedMasterTrackEvents MidiClipReader::separateMasterTrackEvents(ClipInfo clipInfo) {
         SeparatedMasterTrackEvents result;
         result.musicalClip = clipInfo;
@@ -396,7 +408,11 @@ MidiClipSourceNode* findAuthoritativeTimelineMetaSource(const std::shared_ptr<Ti
                 // before the authoritative map above corrected it. Refresh it now so
                 // content-bounds/render-length calculations match the corrected schedule instead
                 // of silently truncating or extending playback.
-                const int64_t correctedDuration = midiNode->totalLength();
+                // A looping clip's length is its own, not its content's.
+                if (clip.region.loops())
+                    continue;
+                const int64_t correctedDuration = std::max<int64_t>(
+                    0, midiNode->totalLength() - clip.region.sourceOffsetSamples);
                 if (correctedDuration != clip.durationSamples)
                     track->clipManager().resizeClip(clip.clipId, correctedDuration);
             }
@@ -16,13 +16,12 @@ std::vector<uint8_t> readRemainingBytes(std::ifstream& stream) {
         std::istreambuf_iterator<char>());
 }
 
-bool writeUmp(std::ofstream& stream, const umppi::Ump& ump) {
+int umpToBytes(const umppi::Ump& ump, std::array<uint8_t, 16>& buffer) {
     const int byteCount = ump.getSizeInBytes();
     if (byteCount <= 0)
-        return true;
+        return 0;
 
     const int wordCount = byteCount / static_cast<int>(sizeof(uint32_t));
-    std::array<uint8_t, 16> buffer{};
     const auto ints = ump.toInts();
 
     for (int word = 0; word < wordCount; ++word) {
@@ -33,12 +32,26 @@ bool writeUmp(std::ofstream& stream, const umppi::Ump& ump) {
         buffer[offset + 2] = static_cast<uint8_t>((value >> 8) & 0xFF);
         buffer[offset + 3] = static_cast<uint8_t>(value & 0xFF);
     }
+    return byteCount;
+}
+
+bool writeUmp(std::ofstream& stream, const umppi::Ump& ump) {
+    std::array<uint8_t, 16> buffer{};
+    const int byteCount = umpToBytes(ump, buffer);
+    if (byteCount <= 0)
+        return true;
 
     stream.write(reinterpret_cast<const char*>(buffer.data()),
                  static_cast<std::streamsize>(byteCount));
     return stream.good();
 }
 
+void appendUmp(std::vector<uint8_t>& bytes, const umppi::Ump& ump) {
+    std::array<uint8_t, 16> buffer{};
+    const int byteCount = umpToBytes(ump, buffer);
+    bytes.insert(bytes.end(), buffer.begin(), buffer.begin() + byteCount);
+}
+
 } // namespace
 
 bool Smf2ClipReaderWriter::validateHeader(const std::array<char, 8>& header) {
@@ -119,15 +132,22 @@ std::optional<Smf2Clip> Smf2ClipReaderWriter::read(const std::filesystem::path&
         setError(errorMessage, "Failed to open SMF2 Clip");
         return std::nullopt;
     }
+    return decode(readRemainingBytes(input), errorMessage);
+}
 
+std::optional<Smf2Clip> Smf2ClipReaderWriter::decode(std::span<const uint8_t> bytes, std::string* errorMessage) {
     std::array<char, 8> header{};
-    input.read(header.data(), static_cast<std::streamsize>(header.size()));
-    if (input.gcount() != static_cast<std::streamsize>(header.size()) || !validateHeader(header)) {
+    if (bytes.size() < header.size()) {
+        setError(errorMessage, "Invalid SMF2 Clip header");
+        return std::nullopt;
+    }
+    std::copy_n(bytes.begin(), header.size(), header.begin());
+    if (!validateHeader(header)) {
         setError(errorMessage, "Invalid SMF2 Clip header");
         return std::nullopt;
     }
 
-    const auto data = readRemainingBytes(input);
+    const auto data = bytes.subspan(header.size());
     if (data.empty() || (data.size() % sizeof(uint32_t)) != 0) {
         setError(errorMessage, "Corrupt SMF2 Clip payload");
         return std::nullopt;
@@ -140,6 +160,16 @@ std::optional<Smf2Clip> Smf2ClipReaderWriter::read(const std::filesystem::path&
     return clip;
 }
 
+std::optional<std::vector<uint8_t>> Smf2ClipReaderWriter::encode(const Smf2Clip& clip, std::string* errorMessage) {
+    if (!validateClipBody(clip, errorMessage))
+        return std::nullopt;
+
+    std::vector<uint8_t> bytes(kFileHeader, kFileHeader + 8);
+    for (const auto& ump : clip)
+        appendUmp(bytes, ump);
+    return bytes;
+}
+
 bool Smf2ClipReaderWriter::write(const std::filesystem::path& file, const Smf2Clip& clip, std::string* errorMessage) {
     if (!validateClipBody(clip, errorMessage))
         return false;
@@ -18,6 +18,8 @@ namespace uapmd {
         std::vector<ClipMarker> markers_{};
         std::vector<AudioWarpPoint> audio_warps_{};
         int64_t duration_samples_{0};
+        ClipRegion region_{};
+        std::string linked_reference_id_{};
 
     public:
         UapmdProjectClipDataImpl() = default;
@@ -48,6 +50,12 @@ namespace uapmd {
         int64_t durationSamples() override { return duration_samples_; }
         void durationSamples(int64_t samples) override { duration_samples_ = samples; }
 
+        ClipRegion region() override { return region_; }
+        void region(ClipRegion value) override { region_ = value; }
+
+        std::string linkedReferenceId() override { return linked_reference_id_; }
+        void linkedReferenceId(const std::string& referenceId) override { linked_reference_id_ = referenceId; }
+
     };
 
     std::unique_ptr<UapmdProjectClipData> UapmdProjectClipData::create() {
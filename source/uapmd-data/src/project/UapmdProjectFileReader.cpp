@@ -1,4 +1,5 @@
 #include <choc/text/choc_JSON.h>
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <map>
@@ -185,6 +186,14 @@ namespace uapmd {
         }
         if (clipObj.hasObjectMember("duration_samples"))
             clip->durationSamples(clipObj["duration_samples"].getWithDefault<int64_t>(0));
+        if (clipObj.hasObjectMember("source_offset_samples") || clipObj.hasObjectMember("loop_length_samples")) {
+            ClipRegion region;
+            region.sourceOffsetSamples = std::max<int64_t>(0, clipObj["source_offset_samples"].getWithDefault<int64_t>(0));
+            region.loopLengthSamples = std::max<int64_t>(0, clipObj["loop_length_samples"].getWithDefault<int64_t>(0));
+            clip->region(region);
+        }
+        if (clipObj.hasObjectMember("linked_to"))
+            clip->linkedReferenceId(std::string(clipObj["linked_to"].getString()));
 
         // Parse MIDI-specific metadata
         if (clipObj.hasObjectMember("tick_resolution")) {
@@ -298,6 +307,8 @@ namespace uapmd {
                     node.state_file = std::string(pluginObj["state_file"].getString());
                 if (pluginObj.hasObjectMember("group_index"))
                     node.group_index = pluginObj["group_index"].getWithDefault<int32_t>(-1);
+                if (pluginObj.hasObjectMember("sleeps_when_silent"))
+                    node.sleeps_when_silent = pluginObj["sleeps_when_silent"].getWithDefault<bool>(false);
                 if (auto* pluginListGraph = dynamic_cast<UapmdProjectPluginListGraphData*>(graph.get()))
                     pluginListGraph->addPlugin(node);
                 if (auto* dagGraph = dynamic_cast<UapmdAudioPluginFullDAGraphData*>(graph.get()))
@@ -109,6 +109,14 @@ namespace uapmd {
         if (clip->durationSamples() > 0)
             obj.addMember("duration_samples", clip->durationSamples());
 
+        const auto region = clip->region();
+        if (region.sourceOffsetSamples > 0)
+            obj.addMember("source_offset_samples", region.sourceOffsetSamples);
+        if (region.loops())
+            obj.addMember("loop_length_samples", region.loopLengthSamples);
+        if (!clip->linkedReferenceId().empty())
+            obj.addMember("linked_to", clip->linkedReferenceId());
+
         auto markers = clip->markers();
         if (!markers.empty()) {
             auto markersArray = choc::value::createEmptyArray();
@@ -12,18 +12,16 @@ namespace uapmd {
     namespace {
         constexpr double kSampleRateTolerance = 0.01;
         constexpr double kMinimumRatio = 1.0e-9;
+        // Warped audio is stretched in chunks of at most this many frames.
+        constexpr int64_t kStretchChunkFrames = 512;
+        // Stretcher input buffers are sized for warps up to this speed; faster
+        // segments fall back to seeking every chunk.
+        constexpr double kMaxStreamedWarpRate = 4.0;
 
         int64_t secondsToSamples(double seconds, double sampleRate) {
             return static_cast<int64_t>(std::llround(seconds * sampleRate));
         }
 
-        struct WarpSegment {
-            int64_t inputStart{0};
-            int64_t inputSamples{0};
-            int64_t outputSamples{0};
-            double speedRatio{1.0};
-        };
-
         std::vector<std::vector<float>> loadAndResampleToTarget(
             AudioFileReader& reader,
             double targetSampleRate,
@@ -101,150 +99,64 @@ namespace uapmd {
             return normalized;
         }
 
-        std::vector<WarpSegment> buildWarpSegments(const std::vector<AudioWarpPoint>& warps, int64_t sourceFrames, double targetSampleRate) {
-            std::vector<WarpSegment> segments;
-            if (warps.empty())
-                return segments;
-
-            segments.reserve(warps.size());
-            int64_t currentSourcePosition = 0;
-            for (size_t i = 0; i + 1 < warps.size(); ++i) {
-                const auto& start = warps[i];
-                const auto& end = warps[i + 1];
-                WarpSegment segment;
-                currentSourcePosition = std::clamp<int64_t>(currentSourcePosition, 0, sourceFrames);
-                segment.inputStart = currentSourcePosition;
-                const int64_t outputSamples = std::max<int64_t>(0, secondsToSamples(end.clipPositionOffset - start.clipPositionOffset, targetSampleRate));
-                const int64_t nextSourcePosition = std::clamp<int64_t>(
-                    currentSourcePosition + static_cast<int64_t>(std::llround(
-                        static_cast<double>(outputSamples) * std::max(start.speedRatio, kMinimumRatio))),
-                    0,
-                    sourceFrames);
-                segment.inputSamples = std::max<int64_t>(0, nextSourcePosition - currentSourcePosition);
-                segment.outputSamples = outputSamples;
-                segment.speedRatio = start.speedRatio;
-                segments.push_back(segment);
-                currentSourcePosition = nextSourcePosition;
-            }
-
-            const auto& last = warps.back();
-            WarpSegment tail;
-            tail.inputStart = currentSourcePosition;
-            tail.inputSamples = std::max<int64_t>(0, sourceFrames - tail.inputStart);
-            tail.speedRatio = std::max(last.speedRatio, kMinimumRatio);
-            tail.outputSamples = static_cast<int64_t>(std::llround(static_cast<double>(tail.inputSamples) / tail.speedRatio));
-            tail.outputSamples = std::max<int64_t>(0, tail.outputSamples);
-            segments.push_back(tail);
-            return segments;
-        }
-
-        void renderLinearFallback(
-            const std::vector<std::vector<float>>& input,
-            int64_t inputStart,
-            int64_t inputSamples,
-            std::vector<std::vector<float>>& output,
-            int64_t outputOffset,
-            int64_t outputSamples
-        ) {
-            if (outputSamples <= 0)
-                return;
-
-            const uint32_t channelCount = static_cast<uint32_t>(std::min(input.size(), output.size()));
-            if (inputSamples <= 0) {
-                for (uint32_t ch = 0; ch < channelCount; ++ch)
-                    std::fill_n(output[ch].data() + outputOffset, outputSamples, 0.0f);
-                return;
-            }
+    } // namespace
 
+    struct AudioFileSourceNode::WarpStretcher {
+        signalsmith::stretch::SignalsmithStretch<float> stretch;
+        int64_t inputCapacity{0};
+        // Input windows are copied here only where they run past the end of the audio.
+        std::vector<std::vector<float>> inputScratch;
+        std::vector<std::vector<float>> outputScratch;
+        std::vector<const float*> inputs;
+        std::vector<float*> outputs;
+        // Output frame the stretcher continues from, or -1 when it has to seek first.
+        int64_t nextOutputFrame{-1};
+        // Next source frame to feed; runs ahead of the output by the lookahead.
+        int64_t inputCursor{0};
+
+        WarpStretcher(uint32_t channelCount, double sampleRate, double maxRate, bool highQuality) {
+            const auto channels = static_cast<int>(channelCount);
+            if (highQuality)
+                stretch.presetDefault(channels, static_cast<float>(sampleRate));
+            else
+                stretch.presetCheaper(channels, static_cast<float>(sampleRate), true);
+
+            const double rate = std::min(maxRate, kMaxStreamedWarpRate);
+            inputCapacity = static_cast<int64_t>(std::ceil(rate * static_cast<double>(kStretchChunkFrames)))
+                + stretch.outputSeekLength(static_cast<float>(rate)) + 1;
+            inputScratch.assign(channelCount, std::vector<float>(static_cast<size_t>(inputCapacity), 0.0f));
+            outputScratch.assign(channelCount, std::vector<float>(static_cast<size_t>(kStretchChunkFrames), 0.0f));
+            inputs.resize(channelCount);
+            outputs.resize(channelCount);
             for (uint32_t ch = 0; ch < channelCount; ++ch) {
-                auto* out = output[ch].data() + outputOffset;
-                const auto* in = input[ch].data() + inputStart;
-                if (inputSamples == 1) {
-                    std::fill_n(out, outputSamples, in[0]);
-                    continue;
-                }
-                for (int64_t i = 0; i < outputSamples; ++i) {
-                    double t = outputSamples > 1
-                        ? static_cast<double>(i) / static_cast<double>(outputSamples - 1)
-                        : 0.0;
-                    double sourcePos = t * static_cast<double>(inputSamples - 1);
-                    int64_t index = static_cast<int64_t>(sourcePos);
-                    double frac = sourcePos - static_cast<double>(index);
-                    int64_t nextIndex = std::min<int64_t>(index + 1, inputSamples - 1);
-                    float a = in[index];
-                    float b = in[nextIndex];
-                    out[i] = a + static_cast<float>(frac) * (b - a);
-                }
+                inputs[ch] = inputScratch[ch].data();
+                outputs[ch] = outputScratch[ch].data();
             }
+            // Seeking sizes internal buffers on first use; do it here, not on the audio thread.
+            stretch.outputSeek(inputs, stretch.outputSeekLength(1.0f));
         }
 
-        std::vector<std::vector<float>> renderWarpedBuffer(
-            const std::vector<std::vector<float>>& source,
-            double targetSampleRate,
-            const std::vector<AudioWarpPoint>& audioWarps,
-            int64_t& renderedFrames
-        ) {
-            renderedFrames = 0;
-            const uint32_t channelCount = static_cast<uint32_t>(source.size());
-            if (channelCount == 0)
-                return {};
-
-            const int64_t sourceFrames = static_cast<int64_t>(source[0].size());
-            auto normalizedWarps = normalizeWarps(audioWarps);
-            auto segments = buildWarpSegments(normalizedWarps, sourceFrames, targetSampleRate);
-
-            for (const auto& segment : segments)
-                renderedFrames += segment.outputSamples;
-
-            std::vector<std::vector<float>> rendered(channelCount);
-            for (uint32_t ch = 0; ch < channelCount; ++ch)
-                rendered[ch].assign(renderedFrames, 0.0f);
-
-            signalsmith::stretch::SignalsmithStretch<float> stretch;
-            stretch.presetDefault(static_cast<int>(channelCount), static_cast<float>(targetSampleRate), true);
-
-            int64_t outputOffset = 0;
-            for (const auto& segment : segments) {
-                if (segment.outputSamples <= 0)
+        // Channel pointers to `length` source frames from `start`, zero-padded
+        // outside the audio. `length` must not exceed inputCapacity.
+        const std::vector<const float*>& window(const std::vector<std::vector<float>>& audio, int64_t start, int64_t length) {
+            const auto available = static_cast<int64_t>(audio.empty() ? 0 : audio[0].size());
+            const bool inside = start >= 0 && start + length <= available;
+            for (size_t ch = 0; ch < inputs.size(); ++ch) {
+                if (inside) {
+                    inputs[ch] = audio[ch].data() + start;
                     continue;
-                if (segment.inputSamples <= 0) {
-                    outputOffset += segment.outputSamples;
-                    continue;
-                }
-
-                std::vector<float*> outputPtrs;
-                outputPtrs.reserve(channelCount);
-                for (uint32_t ch = 0; ch < channelCount; ++ch)
-                    outputPtrs.push_back(rendered[ch].data() + outputOffset);
-
-                bool renderedWithStretch = false;
-                if (segment.inputSamples >= stretch.outputSeekLength(static_cast<float>(segment.speedRatio))) {
-                    stretch.reset();
-                    std::vector<const float*> inputPtrs;
-                    inputPtrs.reserve(channelCount);
-                    for (uint32_t ch = 0; ch < channelCount; ++ch)
-                        inputPtrs.push_back(source[ch].data() + segment.inputStart);
-                    renderedWithStretch = stretch.exact(inputPtrs,
-                                                        static_cast<int>(segment.inputSamples),
-                                                        outputPtrs,
-                                                        static_cast<int>(segment.outputSamples));
-                }
-
-                if (!renderedWithStretch) {
-                    renderLinearFallback(source,
-                                         segment.inputStart,
-                                         segment.inputSamples,
-                                         rendered,
-                                         outputOffset,
-                                         segment.outputSamples);
                 }
-
-                outputOffset += segment.outputSamples;
+                auto* scratch = inputScratch[ch].data();
+                std::fill_n(scratch, length, 0.0f);
+                const auto from = std::max<int64_t>(start, 0);
+                const auto to = std::min(start + length, available);
+                if (to > from)
+                    std::copy(audio[ch].data() + from, audio[ch].data() + to, scratch + (from - start));
+                inputs[ch] = scratch;
             }
-
-            return rendered;
+            return inputs;
         }
-    } // namespace
+    };
 
     AudioFileSourceNode::AudioFileSourceNode(
         int32_t instanceId,
@@ -265,21 +177,74 @@ namespace uapmd {
         if (!reader_)
             return;
 
-        audio_buffer_ = loadAndResampleToTarget(*reader_, targetSampleRate, channel_count_, num_frames_, sample_rate_);
-        if (!audio_warps_.empty()) {
-            int64_t warpedFrames = 0;
-            auto warpedBuffer = renderWarpedBuffer(audio_buffer_, targetSampleRate, audio_warps_, warpedFrames);
-            if (!warpedBuffer.empty()) {
-                audio_buffer_ = std::move(warpedBuffer);
-                num_frames_ = warpedFrames;
-                sample_rate_ = targetSampleRate;
-            }
-        }
+        audio_buffer_ = std::make_shared<const std::vector<std::vector<float>>>(
+            loadAndResampleToTarget(*reader_, targetSampleRate, channel_count_, num_frames_, sample_rate_));
+        prepareWarps();
 
         // Mark buffer as ready for realtime reading (memory barrier ensures visibility)
         buffer_ready_.store(true, std::memory_order_release);
     }
 
+    AudioFileSourceNode::AudioFileSourceNode(
+        int32_t instanceId,
+        const AudioFileSourceNode& source,
+        std::vector<AudioWarpPoint> audioWarps
+    ) : instance_id_(instanceId),
+        audio_buffer_(source.audio_buffer_),
+        channel_count_(source.channel_count_),
+        num_frames_(source.num_frames_),
+        sample_rate_(source.sample_rate_),
+        target_sample_rate_(source.target_sample_rate_),
+        audio_warps_(std::move(audioWarps)) {
+        prepareWarps();
+        buffer_ready_.store(source.buffer_ready_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    AudioFileSourceNode::~AudioFileSourceNode() = default;
+
+    void AudioFileSourceNode::prepareWarps() {
+        warp_segments_.clear();
+        warped_frames_ = 0;
+        max_warp_rate_ = 1.0;
+        realtime_stretcher_.reset();
+        offline_stretcher_.reset();
+        if (audio_warps_.empty() || !audio_buffer_ || audio_buffer_->empty())
+            return;
+
+        auto addSegment = [this](int64_t inputStart, int64_t inputSamples, int64_t outputSamples) {
+            if (outputSamples <= 0)
+                return;
+            warp_segments_.push_back({warped_frames_, outputSamples, inputStart, inputSamples});
+            warped_frames_ += outputSamples;
+            if (inputSamples > 0)
+                max_warp_rate_ = std::max(max_warp_rate_,
+                    static_cast<double>(inputSamples) / static_cast<double>(outputSamples));
+        };
+
+        const auto warps = normalizeWarps(audio_warps_);
+        int64_t currentSourcePosition = 0;
+        for (size_t i = 0; i + 1 < warps.size(); ++i) {
+            const auto& start = warps[i];
+            const auto& end = warps[i + 1];
+            const int64_t outputSamples = std::max<int64_t>(0, secondsToSamples(end.clipPositionOffset - start.clipPositionOffset, target_sample_rate_));
+            const int64_t nextSourcePosition = std::clamp<int64_t>(
+                currentSourcePosition + static_cast<int64_t>(std::llround(
+                    static_cast<double>(outputSamples) * std::max(start.speedRatio, kMinimumRatio))),
+                0,
+                num_frames_);
+            addSegment(currentSourcePosition, nextSourcePosition - currentSourcePosition, outputSamples);
+            currentSourcePosition = nextSourcePosition;
+        }
+
+        const int64_t tailInputSamples = std::max<int64_t>(0, num_frames_ - currentSourcePosition);
+        const double tailRatio = std::max(warps.back().speedRatio, kMinimumRatio);
+        addSegment(currentSourcePosition,
+                   tailInputSamples,
+                   std::max<int64_t>(0, static_cast<int64_t>(std::llround(static_cast<double>(tailInputSamples) / tailRatio))));
+
+        realtime_stretcher_ = std::make_unique<WarpStretcher>(channel_count_, target_sample_rate_, max_warp_rate_, false);
+    }
+
     void AudioFileSourceNode::seek(int64_t samplePosition) {
         playback_position_.store(samplePosition, std::memory_order_release);
         // Update source position (convert from target rate to source rate)
@@ -295,6 +260,8 @@ namespace uapmd {
     }
 
     int64_t AudioFileSourceNode::totalLength() const {
+        if (!warp_segments_.empty())
+            return warped_frames_;
         // Return length in target sample rate domain
         if (std::abs(sample_rate_ - target_sample_rate_) > kSampleRateTolerance) {
             double ratio = target_sample_rate_ / sample_rate_;
@@ -317,9 +284,15 @@ namespace uapmd {
         if (!buffer_ready_.load(std::memory_order_acquire))
             return;
 
-        if (audio_buffer_.empty())
+        if (!audio_buffer_ || audio_buffer_->empty())
+            return;
+
+        if (!warp_segments_.empty()) {
+            processWarped(buffers, numChannels, frameCount);
             return;
+        }
 
+        const auto& audio = *audio_buffer_;
         int64_t pos = playback_position_.load(std::memory_order_acquire);
 
         // Check if resampling is needed
@@ -335,8 +308,8 @@ namespace uapmd {
                 return;
 
             for (uint32_t ch = 0; ch < std::min(numChannels, channel_count_); ++ch) {
-                if (buffers[ch] && ch < audio_buffer_.size()) {
-                    const float* src = &audio_buffer_[ch][pos];
+                if (buffers[ch] && ch < audio.size()) {
+                    const float* src = &audio[ch][pos];
                     std::memcpy(buffers[ch], src, framesToCopy * sizeof(float));
                 }
             }
@@ -361,9 +334,9 @@ namespace uapmd {
                 // Linear interpolation between adjacent samples
                 // Reading from pre-allocated buffer (realtime-safe)
                 for (uint32_t ch = 0; ch < std::min(numChannels, channel_count_); ++ch) {
-                    if (buffers[ch] && ch < audio_buffer_.size()) {
-                        float sample0 = audio_buffer_[ch][sourceIndex];
-                        float sample1 = audio_buffer_[ch][sourceIndex + 1];
+                    if (buffers[ch] && ch < audio.size()) {
+                        float sample0 = audio[ch][sourceIndex];
+                        float sample1 = audio[ch][sourceIndex + 1];
                         buffers[ch][i] = sample0 + fraction * (sample1 - sample0);
                     }
                 }
@@ -378,6 +351,78 @@ namespace uapmd {
         }
     }
 
+    void AudioFileSourceNode::processWarped(float** buffers, uint32_t numChannels, int32_t frameCount) {
+        // Offline renders are not realtime; the higher quality stretcher may be created here.
+        if (offline_rendering_ && !offline_stretcher_)
+            offline_stretcher_ = std::make_unique<WarpStretcher>(channel_count_, target_sample_rate_, max_warp_rate_, true);
+        auto& stretcher = offline_rendering_ ? *offline_stretcher_ : *realtime_stretcher_;
+        const auto& audio = *audio_buffer_;
+        const uint32_t channels = std::min(numChannels, channel_count_);
+
+        const int64_t pos = playback_position_.load(std::memory_order_acquire);
+        int32_t framesCopied = 0;
+        while (framesCopied < frameCount) {
+            const int64_t outputFrame = pos + framesCopied;
+            if (outputFrame < 0 || outputFrame >= warped_frames_)
+                break;
+
+            const auto& segment = *std::prev(std::upper_bound(
+                warp_segments_.begin(), warp_segments_.end(), outputFrame,
+                [](int64_t frame, const WarpSegment& s) { return frame < s.outputStart; }));
+            const auto frames = static_cast<int32_t>(std::min<int64_t>({
+                frameCount - framesCopied,
+                segment.outputStart + segment.outputSamples - outputFrame,
+                kStretchChunkFrames}));
+            if (segment.inputSamples <= 0) {
+                // Warped past the end of the audio: silence.
+                stretcher.nextOutputFrame = -1;
+                framesCopied += frames;
+                continue;
+            }
+
+            const double rate = static_cast<double>(segment.inputSamples) / static_cast<double>(segment.outputSamples);
+            const auto sourceFrameAt = [&](int64_t frame) {
+                return segment.inputStart + static_cast<int64_t>(std::llround(static_cast<double>(frame - segment.outputStart) * rate));
+            };
+            const int64_t lookahead = stretcher.stretch.outputSeekLength(
+                static_cast<float>(std::min(rate, kMaxStreamedWarpRate)));
+            const int64_t nominalInputFrames = sourceFrameAt(outputFrame + frames) - sourceFrameAt(outputFrame);
+            // How far the input is off from where this chunk's output lines up
+            // with the warp map. The lookahead depends on the rate, so a warp
+            // point leaves some drift that is caught up over a few chunks.
+            const int64_t drift = sourceFrameAt(outputFrame + frames) + lookahead
+                - (stretcher.inputCursor + nominalInputFrames);
+
+            if (stretcher.nextOutputFrame == outputFrame &&
+                (drift > stretcher.inputCapacity || -drift > stretcher.inputCapacity))
+                stretcher.nextOutputFrame = -1;
+            int64_t inputFrames = nominalInputFrames;
+            if (stretcher.nextOutputFrame != outputFrame) {
+                // Seek pre-roll: the next output starts exactly on this source frame.
+                const int64_t start = sourceFrameAt(outputFrame);
+                stretcher.stretch.outputSeek(stretcher.window(audio, start, lookahead), static_cast<int>(lookahead));
+                stretcher.inputCursor = start + lookahead;
+            } else {
+                const int64_t maxCorrection = std::max<int64_t>(1, nominalInputFrames / 2);
+                inputFrames += std::clamp(drift, -maxCorrection, maxCorrection);
+            }
+            inputFrames = std::clamp<int64_t>(inputFrames, 0, stretcher.inputCapacity);
+            stretcher.stretch.process(stretcher.window(audio, stretcher.inputCursor, inputFrames),
+                                      static_cast<int>(inputFrames),
+                                      stretcher.outputs,
+                                      frames);
+            stretcher.inputCursor += inputFrames;
+            stretcher.nextOutputFrame = outputFrame + frames;
+
+            for (uint32_t ch = 0; ch < channels; ++ch)
+                if (buffers[ch])
+                    std::memcpy(buffers[ch] + framesCopied, stretcher.outputScratch[ch].data(), frames * sizeof(float));
+            framesCopied += frames;
+        }
+
+        playback_position_.store(pos + framesCopied, std::memory_order_release);
+    }
+
     std::vector<uint8_t> AudioFileSourceNode::saveState() {
         // Simple state: just the playback position
         std::vector<uint8_t> state(sizeof(int64_t));
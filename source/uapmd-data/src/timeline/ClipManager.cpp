@@ -321,6 +321,20 @@ namespace uapmd {
         return true;
     }
 
+    bool ClipManager::setClipRegion(int32_t clipId, const ClipRegion& region) {
+        if (region.sourceOffsetSamples < 0 || region.loopLengthSamples < 0)
+            return false;
+
+        std::lock_guard<std::mutex> lock(clips_mutex_);
+        auto it = clips_.find(clipId);
+        if (it == clips_.end())
+            return false;
+
+        it->second.region = region;
+        rebuildSnapshotLocked();
+        return true;
+    }
+
     std::vector<ClipData> ClipManager::getActiveClipsAt(const TimelinePosition& position) {
         std::lock_guard<std::mutex> lock(clips_mutex_);
         return collectActiveClipCopies(clips_, position);
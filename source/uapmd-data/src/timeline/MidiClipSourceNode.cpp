@@ -43,38 +43,59 @@ namespace uapmd {
         double targetSampleRate,
         std::vector<MidiTempoChange> tempoChanges,
         std::vector<MidiTimeSignatureChange> timeSignatureChanges
-    ) : instance_id_(instanceId),
-        ump_events_(std::move(umpEvents)),
-        event_timestamps_ticks_(std::move(umpTickTimestamps)),
-        tempo_changes_(std::move(tempoChanges)),
-        time_signature_changes_(std::move(timeSignatureChanges)),
-        tick_resolution_(tickResolution == 0 ? 480 : tickResolution),
-        clip_tempo_(clipTempo <= 0.0 ? 120.0 : clipTempo),
-        target_sample_rate_(targetSampleRate)
+    ) : instance_id_(instanceId)
     {
-        normalizeTempoChanges(tempo_changes_, clip_tempo_);
-        playback_tempo_changes_ = tempo_changes_;
-
+        auto content = std::make_shared<Content>();
+        content->umpEvents = std::move(umpEvents);
+        content->tickTimestamps = std::move(umpTickTimestamps);
+        content->tempoChanges = std::move(tempoChanges);
+        content->timeSignatureChanges = std::move(timeSignatureChanges);
+        content->tickResolution = tickResolution == 0 ? 480 : tickResolution;
+        content->clipTempo = clipTempo <= 0.0 ? 120.0 : clipTempo;
+        content->targetSampleRate = targetSampleRate;
+
+        normalizeTempoChanges(content->tempoChanges, content->clipTempo);
+
+        auto& timeSignatureChangesRef = content->timeSignatureChanges;
         auto timeSigComparator = [](const MidiTimeSignatureChange& a, const MidiTimeSignatureChange& b) {
             return a.tickPosition < b.tickPosition;
         };
-        if (time_signature_changes_.empty()) {
-            time_signature_changes_.push_back(MidiTimeSignatureChange{0, 4, 4});
+        if (timeSignatureChangesRef.empty()) {
+            timeSignatureChangesRef.push_back(MidiTimeSignatureChange{0, 4, 4});
         } else {
-            std::sort(time_signature_changes_.begin(), time_signature_changes_.end(), timeSigComparator);
-            if (time_signature_changes_.front().tickPosition > 0) {
-                time_signature_changes_.insert(
-                    time_signature_changes_.begin(),
+            std::sort(timeSignatureChangesRef.begin(), timeSignatureChangesRef.end(), timeSigComparator);
+            if (timeSignatureChangesRef.front().tickPosition > 0) {
+                timeSignatureChangesRef.insert(
+                    timeSignatureChangesRef.begin(),
                     MidiTimeSignatureChange{
                         0,
-                        time_signature_changes_.front().numerator,
-                        time_signature_changes_.front().denominator
+                        timeSignatureChangesRef.front().numerator,
+                        timeSignatureChangesRef.front().denominator
                     }
                 );
             }
         }
 
-        rebuildSampleTimelines();
+        std::vector<uint64_t> tempoTicks;
+        tempoTicks.reserve(content->tempoChanges.size());
+        for (const auto& change : content->tempoChanges)
+            tempoTicks.push_back(change.tickPosition);
+        content->tempoChangeSamples = content->sampleTimeline(tempoTicks, content->tempoChanges);
+
+        std::vector<uint64_t> timeSigTicks;
+        timeSigTicks.reserve(timeSignatureChangesRef.size());
+        for (const auto& change : timeSignatureChangesRef)
+            timeSigTicks.push_back(change.tickPosition);
+        content->timeSignatureChangeSamples = content->sampleTimeline(timeSigTicks, content->tempoChanges);
+
+        content_ = std::move(content);
+        schedule_ = content_->schedule(content_->tempoChanges);
+    }
+
+    MidiClipSourceNode::MidiClipSourceNode(int32_t instanceId, const MidiClipSourceNode& source)
+        : instance_id_(instanceId),
+          content_(source.content_),
+          schedule_(source.schedule_) {
     }
 
     std::vector<uint8_t> MidiClipSourceNode::saveState() {
@@ -87,16 +108,20 @@ namespace uapmd {
     }
 
     void MidiClipSourceNode::seek(int64_t samplePosition) {
-        playback_position_.store(samplePosition, std::memory_order_release);
+        // Playback jumped; whatever was held has been dealt with elsewhere
+        // (releaseHeldNotes() or the engine's stop flush).
+        if (samplePosition != playback_position_.exchange(samplePosition, std::memory_order_acq_rel))
+            held_note_count_ = 0;
 
         // Binary search for first event at or after samplePosition
+        const auto& eventSamples = schedule_->eventSamples;
         auto it = std::lower_bound(
-            event_timestamps_samples_.begin(),
-            event_timestamps_samples_.end(),
-            static_cast<uint64_t>(samplePosition)
+            eventSamples.begin(),
+            eventSamples.end(),
+            static_cast<uint64_t>(std::max<int64_t>(0, samplePosition))
         );
 
-        size_t index = std::distance(event_timestamps_samples_.begin(), it);
+        size_t index = std::distance(eventSamples.begin(), it);
         next_event_index_.store(index, std::memory_order_release);
     }
 
@@ -105,7 +130,7 @@ namespace uapmd {
     }
 
     int64_t MidiClipSourceNode::totalLength() const {
-        return total_length_samples_;
+        return schedule_->totalLengthSamples;
     }
 
     bool MidiClipSourceNode::isPlaying() const {
@@ -113,18 +138,19 @@ namespace uapmd {
     }
 
     void MidiClipSourceNode::setPlaying(bool playing) {
-        is_playing_.store(playing, std::memory_order_release);
+        if (!is_playing_.exchange(playing, std::memory_order_acq_rel) || playing)
+            return;
+        // Stopping flushes the notes downstream.
+        held_note_count_ = 0;
     }
 
     void MidiClipSourceNode::setPlaybackTempoMap(std::vector<MidiTempoChange> tempoChanges) {
-        normalizeTempoChanges(tempoChanges, clip_tempo_);
-        playback_tempo_changes_ = std::move(tempoChanges);
-        rebuildSampleTimelines();
+        normalizeTempoChanges(tempoChanges, content_->clipTempo);
+        schedule_ = content_->schedule(std::move(tempoChanges));
     }
 
     void MidiClipSourceNode::clearPlaybackTempoMap() {
-        playback_tempo_changes_ = tempo_changes_;
-        rebuildSampleTimelines();
+        schedule_ = content_->schedule(content_->tempoChanges);
     }
 
     void MidiClipSourceNode::processEvents(
@@ -137,26 +163,28 @@ namespace uapmd {
         if (bypassed_ || !is_playing_.load(std::memory_order_acquire))
             return;
 
+        const auto& umpEvents = content_->umpEvents;
+        const auto& eventTimestamps = schedule_->eventSamples;
         int64_t currentPos = playback_position_.load(std::memory_order_acquire);
         int64_t windowEnd = currentPos + frameCount;
         size_t eventIdx = next_event_index_.load(std::memory_order_acquire);
 
         // Emit all events within [currentPos, windowEnd)
-        while (eventIdx < ump_events_.size()) {
-            uint64_t eventSamples = event_timestamps_samples_[eventIdx];
+        while (eventIdx < umpEvents.size() && eventIdx < eventTimestamps.size()) {
+            uint64_t eventSamples = eventTimestamps[eventIdx];
 
             // Beyond current window
             if (eventSamples >= static_cast<uint64_t>(windowEnd))
                 break;
 
             // Determine how many 32-bit words this UMP message occupies.
-            // All words of one message share the same tick timestamp in ump_events_.
-            uint8_t messageType = static_cast<uint8_t>((ump_events_[eventIdx] >> 28) & 0xF);
+            // All words of one message share the same tick timestamp in umpEvents.
+            uint8_t messageType = static_cast<uint8_t>((umpEvents[eventIdx] >> 28) & 0xF);
             size_t wordsNeeded = static_cast<size_t>(umppi::umpSizeInInts(messageType));
             if (wordsNeeded == 0) wordsNeeded = 1;
 
             // Guard against reading past the end of the event buffer
-            if (eventIdx + wordsNeeded > ump_events_.size())
+            if (eventIdx + wordsNeeded > umpEvents.size())
                 break;
 
             // Within window - emit or intercept the complete multi-word message
@@ -166,7 +194,7 @@ namespace uapmd {
                 // NRPN intercept: MIDI2 channel voice messages (messageType==4) with 2 words
                 bool intercepted = false;
                 if (nrpn_intercept_callback_ && messageType == 4 && wordsNeeded >= 2) {
-                    umppi::Ump ump(ump_events_[eventIdx], ump_events_[eventIdx + 1], 0, 0);
+                    umppi::Ump ump(umpEvents[eventIdx], umpEvents[eventIdx + 1], 0, 0);
                     auto statusCode = static_cast<uint8_t>(ump.getStatusCode());
                     if (statusCode == umppi::MidiChannelStatus::NRPN ||
                         statusCode == umppi::MidiChannelStatus::RELATIVE_NRPN) {
@@ -179,18 +207,60 @@ namespace uapmd {
                     }
                 }
 
-                if (!intercepted)
-                    appendUmpToEventSequence(eventOut, &ump_events_[eventIdx], wordsNeeded, frameOffset);
+                if (!intercepted && appendUmpToEventSequence(eventOut, &umpEvents[eventIdx], wordsNeeded, frameOffset))
+                    trackHeldNote(&umpEvents[eventIdx], wordsNeeded);
             }
 
             eventIdx += wordsNeeded;
         }
 
         next_event_index_.store(eventIdx, std::memory_order_release);
+        playback_position_.store(windowEnd, std::memory_order_release);
+    }
+
+    void MidiClipSourceNode::releaseHeldNotes(remidy::EventSequence& eventOut, uint32_t frameOffsetInBlock) {
+        size_t released = 0;
+        for (; released < held_note_count_; ++released) {
+            const auto packed = held_notes_[released];
+            const auto noteOff = umppi::UmpFactory::midi2NoteOff(
+                static_cast<uint8_t>(packed >> 11), static_cast<uint8_t>((packed >> 7) & 0xF),
+                static_cast<uint8_t>(packed & 0x7F), 0, 0, 0);
+            const uapmd_ump_t words[2]{
+                static_cast<uapmd_ump_t>(noteOff >> 32),
+                static_cast<uapmd_ump_t>(noteOff & 0xFFFFFFFFu)
+            };
+            if (!appendUmpToEventSequence(eventOut, words, 2, frameOffsetInBlock))
+                break;
+        }
+        // Whatever did not fit stays held for the next call.
+        std::copy(held_notes_.begin() + released, held_notes_.begin() + held_note_count_, held_notes_.begin());
+        held_note_count_ -= released;
+    }
+
+    void MidiClipSourceNode::trackHeldNote(const uapmd_ump_t* words, size_t wordCount) {
+        const auto messageType = static_cast<uint8_t>(words[0] >> 28);
+        if (messageType != umppi::MidiMessageType::MIDI1 && messageType != umppi::MidiMessageType::MIDI2)
+            return;
+        const auto status = static_cast<uint8_t>(((words[0] >> 20) & 0xF) << 4);
+        if (status != umppi::MidiChannelStatus::NOTE_ON && status != umppi::MidiChannelStatus::NOTE_OFF)
+            return;
+        // Velocity 0 note-ons end notes, as SMF-imported content relies on.
+        const bool zeroVelocity = messageType == umppi::MidiMessageType::MIDI1
+            ? (words[0] & 0x7Fu) == 0
+            : wordCount < 2 || (words[1] >> 16) == 0;
+        const auto packed = static_cast<uint16_t>(((words[0] >> 13) & 0x7800u) | ((words[0] >> 9) & 0x780u) | ((words[0] >> 8) & 0x7Fu));
+        const auto end = held_notes_.begin() + held_note_count_;
+        const auto it = std::find(held_notes_.begin(), end, packed);
+        if (status == umppi::MidiChannelStatus::NOTE_ON && !zeroVelocity) {
+            if (it == end && held_note_count_ < kMaxHeldNotes)
+                held_notes_[held_note_count_++] = packed;
+        } else if (it != end) {
+            *it = held_notes_[--held_note_count_];
+        }
     }
 
 
-    void MidiClipSourceNode::appendUmpToEventSequence(
+    bool MidiClipSourceNode::appendUmpToEventSequence(
         remidy::EventSequence& seq,
         const uapmd_ump_t* words,
         size_t wordCount,
@@ -211,57 +281,52 @@ namespace uapmd {
 
         // Check that we have room for all words before writing any
         if (umpPosition + wordCount > umpCapacity)
-            return; // Buffer full - drop event
+            return false; // Buffer full - drop event
 
         // Write all words of the complete UMP message
         for (size_t i = 0; i < wordCount; i++)
             buffer[umpPosition++] = words[i];
 
         seq.position(umpPosition * sizeof(uint32_t));
+        return true;
     }
 
-    void MidiClipSourceNode::rebuildSampleTimelines() {
-        event_timestamps_samples_ = computeSampleTimeline(event_timestamps_ticks_, playback_tempo_changes_);
+    std::shared_ptr<const MidiClipSourceNode::Schedule> MidiClipSourceNode::Content::schedule(
+        std::vector<MidiTempoChange> playbackTempoChanges) const {
+        auto sameTempoMap = [&playbackTempoChanges](const Schedule& candidate) {
+            return std::equal(
+                candidate.tempoChanges.begin(), candidate.tempoChanges.end(),
+                playbackTempoChanges.begin(), playbackTempoChanges.end(),
+                [](const MidiTempoChange& a, const MidiTempoChange& b) {
+                    return a.tickPosition == b.tickPosition && a.bpm == b.bpm;
+                });
+        };
 
-        std::vector<uint64_t> tempoTicks;
-        tempoTicks.reserve(tempo_changes_.size());
-        for (const auto& change : tempo_changes_) {
-            tempoTicks.push_back(change.tickPosition);
-        }
-        tempo_change_samples_ = computeSampleTimeline(tempoTicks, tempo_changes_);
+        std::lock_guard<std::mutex> lock(scheduleMutex);
+        if (auto last = lastSchedule.lock(); last && sameTempoMap(*last))
+            return last;
 
-        std::vector<uint64_t> timeSigTicks;
-        timeSigTicks.reserve(time_signature_changes_.size());
-        for (const auto& change : time_signature_changes_) {
-            timeSigTicks.push_back(change.tickPosition);
-        }
-        time_signature_change_samples_ = computeSampleTimeline(timeSigTicks, tempo_changes_);
+        auto result = std::make_shared<Schedule>();
+        result->eventSamples = sampleTimeline(tickTimestamps, playbackTempoChanges);
+        result->tempoChanges = std::move(playbackTempoChanges);
 
-        total_length_samples_ = 0;
-        for (uint64_t samples : event_timestamps_samples_) {
-            if (static_cast<int64_t>(samples) > total_length_samples_) {
-                total_length_samples_ = static_cast<int64_t>(samples);
-            }
-        }
-        for (uint64_t samples : tempo_change_samples_) {
-            if (static_cast<int64_t>(samples) > total_length_samples_) {
-                total_length_samples_ = static_cast<int64_t>(samples);
-            }
-        }
-        for (uint64_t samples : time_signature_change_samples_) {
-            if (static_cast<int64_t>(samples) > total_length_samples_) {
-                total_length_samples_ = static_cast<int64_t>(samples);
-            }
-        }
+        int64_t totalLength = 0;
+        for (const auto* samples : {&result->eventSamples, &tempoChangeSamples, &timeSignatureChangeSamples})
+            for (uint64_t sample : *samples)
+                totalLength = std::max(totalLength, static_cast<int64_t>(sample));
 
         // Clip ranges are end-exclusive. Keep one sample after the last MIDI
         // timestamp so an event exactly at the final timestamp (most notably a
         // recorded note-off) still belongs to the render window.
-        if (!event_timestamps_samples_.empty())
-            ++total_length_samples_;
+        if (!result->eventSamples.empty())
+            ++totalLength;
+        result->totalLengthSamples = totalLength;
+
+        lastSchedule = result;
+        return result;
     }
 
-    std::vector<uint64_t> MidiClipSourceNode::computeSampleTimeline(
+    std::vector<uint64_t> MidiClipSourceNode::Content::sampleTimeline(
         const std::vector<uint64_t>& ticks,
         const std::vector<MidiTempoChange>& tempoChanges) const {
         std::vector<uint64_t> samples;
@@ -275,8 +340,8 @@ namespace uapmd {
         if (processedTick > 0 && processedTick > ticks.front())
             processedTick = ticks.front();
 
-        double bpm = tempoChanges[tempoIndex].bpm > 0.0 ? tempoChanges[tempoIndex].bpm : clip_tempo_;
-        double secondsPerTick = (60.0 / bpm) / static_cast<double>(tick_resolution_);
+        double bpm = tempoChanges[tempoIndex].bpm > 0.0 ? tempoChanges[tempoIndex].bpm : clipTempo;
+        double secondsPerTick = (60.0 / bpm) / static_cast<double>(tickResolution);
         double secondsAccum = 0.0;
 
         for (uint64_t tick : ticks) {
@@ -290,8 +355,8 @@ namespace uapmd {
                 ++tempoIndex;
                 double nextBpm = tempoChanges[tempoIndex].bpm;
                 if (nextBpm <= 0.0)
-                    nextBpm = clip_tempo_;
-                secondsPerTick = (60.0 / nextBpm) / static_cast<double>(tick_resolution_);
+                    nextBpm = clipTempo;
+                secondsPerTick = (60.0 / nextBpm) / static_cast<double>(tickResolution);
             }
 
             if (tick > processedTick) {
@@ -299,7 +364,7 @@ namespace uapmd {
                 processedTick = tick;
             }
 
-            samples.push_back(static_cast<uint64_t>(secondsAccum * target_sample_rate_));
+            samples.push_back(static_cast<uint64_t>(secondsAccum * targetSampleRate));
         }
 
         return samples;
@@ -11,7 +11,7 @@ namespace uapmd {
         struct ClipRenderWindow {
             int32_t destinationOffsetFrames{0};
             int32_t processFrameCount{0};
-            int64_t sourceStartSample{0};
+            int64_t clipOffsetSamples{0};  // Relative to the clip start
         };
 
         std::optional<ClipRenderWindow> computeClipRenderWindow(
@@ -33,9 +33,33 @@ namespace uapmd {
             ClipRenderWindow window;
             window.destinationOffsetFrames = static_cast<int32_t>(overlapStart - blockStartSample);
             window.processFrameCount = static_cast<int32_t>(overlapEnd - overlapStart);
-            window.sourceStartSample = overlapStart - clipStartSample;
+            window.clipOffsetSamples = overlapStart - clipStartSample;
             return window;
         }
+
+        // Splits a render window into runs that are contiguous in the clip's
+        // source. A looping clip wraps back to its loop start, so its windows
+        // can contain more than one run. `fn` gets the run's offset in the
+        // window, its length, its source position, and whether playback jumps
+        // or stops at its end.
+        template <typename Fn>
+        void forEachSourceRun(const ClipRenderWindow& window, const ClipData& clip, Fn&& fn) {
+            int32_t done = 0;
+            while (done < window.processFrameCount) {
+                const int64_t clipOffset = window.clipOffsetSamples + done;
+                auto frames = window.processFrameCount - done;
+                bool endsAtJump = clipOffset + frames >= clip.durationSamples;
+                if (clip.region.loops()) {
+                    const int64_t untilWrap = clip.region.loopLengthSamples - clipOffset % clip.region.loopLengthSamples;
+                    if (untilWrap <= frames) {
+                        frames = static_cast<int32_t>(untilWrap);
+                        endsAtJump = true;
+                    }
+                }
+                fn(done, frames, clip.region.sourcePositionAt(clipOffset), endsAtJump);
+                done += frames;
+            }
+        }
     }
 
     TimelineTrack::TimelineTrack(std::string referenceId, uint32_t channelCount, double sampleRate, uint32_t bufferSizeInFrames)
@@ -387,24 +411,29 @@ namespace uapmd {
                 if (!audioSourceNode)
                     continue;
 
-                audioSourceNode->seek(renderWindow->sourceStartSample);
                 audioSourceNode->setPlaying(renderTimeline.isPlaying);
+                audioSourceNode->setOfflineRendering(renderTimeline.offlineRendering);
 
-                // Zero pre-allocated scratch buffers and process
-                for (uint32_t ch = 0; ch < numChannels && ch < temp_source_buffers_.size(); ++ch)
-                    std::memset(temp_source_buffers_[ch].data(), 0, frameCount * sizeof(float));
+                const float gain = static_cast<float>(clip.gain);
+                forEachSourceRun(*renderWindow, clip, [&](int32_t runOffset, int32_t runFrames, int64_t sourcePosition, bool) {
+                    // A loop wrap is a seek back to the loop start.
+                    audioSourceNode->seek(sourcePosition);
 
-                audioSourceNode->processAudio(
-                    temp_source_buffer_ptrs_.data(),
-                    numChannels,
-                    renderWindow->processFrameCount);
+                    // Zero pre-allocated scratch buffers and process
+                    for (uint32_t ch = 0; ch < numChannels && ch < temp_source_buffers_.size(); ++ch)
+                        std::memset(temp_source_buffers_[ch].data(), 0, runFrames * sizeof(float));
 
-                // Mix into mixed source buffer with gain
-                const float gain = static_cast<float>(clip.gain);
-                for (uint32_t ch = 0; ch < numChannels; ++ch)
-                    for (int32_t frame = 0; frame < renderWindow->processFrameCount; ++frame)
-                        mixed_source_buffers_[ch][destinationOffsetFrames + renderWindow->destinationOffsetFrames + frame] +=
-                            temp_source_buffers_[ch][frame] * gain;
+                    audioSourceNode->processAudio(
+                        temp_source_buffer_ptrs_.data(),
+                        numChannels,
+                        runFrames);
+
+                    // Mix into mixed source buffer with gain
+                    const int32_t mixOffset = destinationOffsetFrames + renderWindow->destinationOffsetFrames + runOffset;
+                    for (uint32_t ch = 0; ch < numChannels; ++ch)
+                        for (int32_t frame = 0; frame < runFrames; ++frame)
+                            mixed_source_buffers_[ch][mixOffset + frame] += temp_source_buffers_[ch][frame] * gain;
+                });
             }
 
             // Process MIDI clips
@@ -429,16 +458,24 @@ namespace uapmd {
                 if (!midiNode)
                     continue;
 
-                midiNode->seek(renderWindow->sourceStartSample);
                 midiNode->setPlaying(renderTimeline.isPlaying);
 
-                midiNode->processEvents(
-                    process.eventIn(),
-                    renderWindow->processFrameCount,
-                    static_cast<int32_t>(sample_rate_),
-                    renderTimeline.tempo,
-                    static_cast<uint32_t>(destinationOffsetFrames + renderWindow->destinationOffsetFrames)
-                );
+                forEachSourceRun(*renderWindow, clip, [&](int32_t runOffset, int32_t runFrames, int64_t sourcePosition, bool endsAtJump) {
+                    const auto frameOffset = static_cast<uint32_t>(
+                        destinationOffsetFrames + renderWindow->destinationOffsetFrames + runOffset);
+                    midiNode->seek(sourcePosition);
+                    midiNode->processEvents(
+                        process.eventIn(),
+                        runFrames,
+                        static_cast<int32_t>(sample_rate_),
+                        renderTimeline.tempo,
+                        frameOffset
+                    );
+                    // Notes still sounding at a loop end or at a clip end
+                    // that cuts the source short end there.
+                    if (endsAtJump && renderTimeline.isPlaying)
+                        midiNode->releaseHeldNotes(process.eventIn(), frameOffset + static_cast<uint32_t>(runFrames - 1));
+                });
             }
         }
 
@@ -459,9 +496,28 @@ namespace uapmd {
                     // Stack-allocated pointer array (no heap alloc)
                     constexpr uint32_t kMaxDeviceChannels = 16;
                     float* devicePtrs[kMaxDeviceChannels];
-                    const uint32_t usableChannels = std::min(deviceChannelCount, kMaxDeviceChannels);
-                    for (uint32_t ch = 0; ch < usableChannels; ++ch)
-                        devicePtrs[ch] = const_cast<float*>(process.getFloatInBuffer(0, ch)) + destinationOffsetFrames;
+                    uint32_t usableChannels = std::min(deviceChannelCount, kMaxDeviceChannels);
+                    if (process.audioDataType() == remidy::AudioContentType::Float64) {
+                        // Source nodes take floats.
+                        const auto needed = static_cast<size_t>(destinationOffsetFrames + frameCount);
+                        try {
+                            if (device_input_buffers_.size() < usableChannels)
+                                device_input_buffers_.resize(usableChannels);
+                            for (uint32_t ch = 0; ch < usableChannels; ++ch)
+                                if (device_input_buffers_[ch].size() < needed)
+                                    device_input_buffers_[ch].resize(needed);
+                        } catch (const std::bad_alloc&) {
+                            usableChannels = 0;
+                        }
+                        for (uint32_t ch = 0; ch < usableChannels; ++ch) {
+                            const double* input = process.getDoubleInBuffer(0, ch) + destinationOffsetFrames;
+                            devicePtrs[ch] = device_input_buffers_[ch].data() + destinationOffsetFrames;
+                            std::copy_n(input, frameCount, devicePtrs[ch]);
+                        }
+                    } else {
+                        for (uint32_t ch = 0; ch < usableChannels; ++ch)
+                            devicePtrs[ch] = const_cast<float*>(process.getFloatInBuffer(0, ch)) + destinationOffsetFrames;
+                    }
 
                     deviceInputNode->setDeviceInputBuffers(devicePtrs, usableChannels);
                     deviceInputNode->setPlaying(renderTimeline.isPlaying);
@@ -481,13 +537,16 @@ namespace uapmd {
 
         // Write mixed source buffer to AudioProcessContext INPUT
         // Timeline track writes to sequencer track's input, then plugins process input->output
-        for (uint32_t ch = 0; ch < numChannels && ch < mixed_source_buffer_ptrs_.size(); ++ch) {
-            float* inBuffer = process.getFloatInBuffer(0, ch);
-            if (inBuffer)
-                std::memcpy(inBuffer + destinationOffsetFrames,
-                            mixed_source_buffer_ptrs_[ch] + destinationOffsetFrames,
-                            frameCount * sizeof(float));
-        }
+        process.withSampleType([&](auto* tag) {
+            using SampleType = std::remove_pointer_t<decltype(tag)>;
+            for (uint32_t ch = 0; ch < numChannels && ch < mixed_source_buffer_ptrs_.size(); ++ch) {
+                auto* inBuffer = process.getInBuffer<SampleType>(0, ch);
+                if (inBuffer)
+                    std::copy_n(mixed_source_buffer_ptrs_[ch] + destinationOffsetFrames,
+                                frameCount,
+                                inBuffer + destinationOffsetFrames);
+            }
+        });
     }
 
 } // namespace uapmd
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "AudioIODevice.hpp"
+#include "MidiIODevice.hpp"
+
+namespace uapmd {
+
+    class NullMidiIODevice;
+
+    // How the "null" audio driver behaves. There is no hardware behind it: a
+    // timer thread runs the device callback once per period at the configured
+    // rate, so the engine runs exactly as it does on a real device.
+    struct NullAudioIOSimulation {
+        uint32_t sampleRate{48000};
+        uint32_t inputChannels{2};
+        uint32_t outputChannels{2};
+        // Period sizes in frames, used in turn. Empty uses the preferred
+        // callback size, or the buffer size passed to open().
+        std::vector<uint32_t> periodSchedule{};
+        // Each period starts up to this late, uniformly distributed. The same
+        // seed gives the same sequence of delays.
+        std::chrono::microseconds jitter{0};
+        uint64_t jitterSeed{1};
+        // False runs the periods back to back instead of at the sample rate.
+        bool realtime{true};
+        // Device input, read from a WAV file. Silent when empty.
+        std::filesystem::path inputFile{};
+        bool loopInput{true};
+        // Device output is written to this WAV file when set.
+        std::filesystem::path outputFile{};
+        // Scripted MIDI ports clocked by the device; see NullMidiIODevice.
+        std::vector<std::shared_ptr<NullMidiIODevice>> midiPorts{};
+    };
+
+    struct NullAudioIOStatistics {
+        uint64_t periods{0};
+        uint64_t frames{0};
+        // Periods whose callback finished after the period's deadline, i.e.
+        // what would have been an xrun on hardware.
+        uint64_t deadlineMisses{0};
+        std::chrono::nanoseconds totalCallbackTime{0};
+        std::chrono::nanoseconds maxCallbackTime{0};
+        // How late a period started against its schedule, jitter included.
+        std::chrono::nanoseconds maxWakeupLateness{0};
+        // Output frames dropped because the WAV writer fell behind.
+        uint64_t droppedOutputFrames{0};
+    };
+
+    class NullAudioIODevice;
+
+    // Selected with AudioIODeviceManager::instance("null"), or by setting the
+    // UAPMD_AUDIO_DRIVER environment variable to "null" for the default
+    // instance(). Configure the simulation before open().
+    class NullAudioIODeviceManager final : public AudioIODeviceManager {
+        std::unique_ptr<NullAudioIODevice> device_;
+        NullAudioIOSimulation simulation_{};
+        Logger* logger_{};
+
+    protected:
+        std::vector<AudioIODeviceInfo> onDevices() override;
+        AudioIODevice* onOpen(int inputDeviceIndex, int outputDeviceIndex, uint32_t sampleRate, uint32_t bufferSize) override;
+
+    public:
+        NullAudioIODeviceManager();
+        ~NullAudioIODeviceManager() override;
+
+        void initialize(Configuration& config) override;
+        std::vector<uint32_t> getDeviceSampleRates(const std::string& deviceName, AudioIODirections direction) override;
+        bool platformProvidesAutoBufferSize() const override { return false; }
+
+        const NullAudioIOSimulation& simulation() const { return simulation_; }
+        // Applies from the next open().
+        void simulation(NullAudioIOSimulation simulation) { simulation_ = std::move(simulation); }
+        // Counters of the opened device since it last started.
+        NullAudioIOStatistics statistics() const;
+    };
+
+    // A virtual MIDI port for scripted input. Events are scheduled at device
+    // frame positions and delivered by the null audio device right before the
+    // period that contains them, so runs are reproducible. Messages sent to
+    // the port are kept for inspection.
+    //
+    // Registered ports are listed by getMidiInputPorts()/getMidiOutputPorts()
+    // and opened by their id like platform ports.
+    class NullMidiIODevice final : public MidiIODevice {
+        struct ScheduledEvent {
+            uint64_t frame;
+            std::vector<uapmd_ump_t> words;
+        };
+
+        std::string port_id_;
+        std::string display_name_;
+        std::vector<ump_receiver_t> receivers_{};
+        std::vector<void*> receiver_user_data_{};
+        std::vector<ScheduledEvent> scheduled_{};
+        size_t next_event_{0};
+        std::mutex sent_mutex_{};
+        std::vector<uapmd_ump_t> sent_{};
+
+    public:
+        explicit NullMidiIODevice(std::string portId, std::string displayName = "");
+        ~NullMidiIODevice() override;
+
+        const std::string& portId() const { return port_id_; }
+        const std::string& displayName() const { return display_name_; }
+
+        void addInputHandler(ump_receiver_t receiver, void* userData) override;
+        void removeInputHandler(ump_receiver_t receiver) override;
+        void send(uapmd_ump_t* messages, size_t sizeInBytes, uapmd_timestamp_t timestamp) override;
+
+        // Queues input at a device frame position. Events at the same frame
+        // keep their order. Not to be called while the device is running.
+        void schedule(uint64_t frame, const uapmd_ump_t* words, size_t sizeInBytes);
+        void clearSchedule();
+        // Device thread. Delivers the scheduled events before `endFrame`.
+        void deliverUntil(uint64_t endFrame);
+        // Rewinds the script; the null audio device does this when it starts.
+        void rewind();
+
+        // Everything sent to the port so far, and forgets it.
+        std::vector<uapmd_ump_t> takeSentMessages();
+    };
+
+    // Makes the port visible to the MIDI port enumeration. Registering another
+    // port under the same id replaces it.
+    void registerNullMidiPort(std::shared_ptr<NullMidiIODevice> port);
+    void unregisterNullMidiPort(const std::string& portId);
+    std::shared_ptr<NullMidiIODevice> findNullMidiPort(const std::string& portId);
+    std::vector<MidiPortInfo> getNullMidiPorts();
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <uapmd-plugin-hosting/uapmd-plugin-hosting.hpp>
+#include "PlaybackEngineExtension.hpp"
+
+namespace uapmd {
+
+class SequencerEngine;
+
+// Captures device input for armed tracks and registers each take as an audio
+// clip on its track when recording stops.
+//
+// The audio thread only copies samples into a preallocated ring per track. A
+// writer thread drains the rings into 32-bit float WAV files whose space is
+// reserved ahead of the write position, so disk I/O never reaches the audio
+// callback. A take that cannot continue seamlessly (ring overflow, transport
+// jump, file size limit) ends there instead of recording a gap.
+class AudioRecorder final : public PlaybackEngineExtension {
+public:
+    struct ArmedTrack {
+        std::string trackId;
+        // Channels of the device input bus, one file channel each.
+        std::vector<uint32_t> inputChannels;
+    };
+
+    struct Options {
+        std::filesystem::path directory;
+        // Only timeline samples in [punchIn, punchOut) are recorded.
+        std::optional<int64_t> punchIn;
+        std::optional<int64_t> punchOut;
+        // Audio buffered between the audio thread and the writer.
+        double ringSeconds{4.0};
+        // Disk space allocated ahead of the write position.
+        double preallocationSeconds{30.0};
+    };
+
+    struct Take {
+        std::string trackId;
+        std::filesystem::path path;
+        int64_t startSample{0};
+        int64_t frameCount{0};
+        int32_t clipId{-1};
+        // The take ended early because it could not continue seamlessly.
+        bool truncated{false};
+    };
+
+    explicit AudioRecorder(SequencerEngine& engine);
+    ~AudioRecorder() override;
+    std::string_view extensionId() const override { return "audio-recorder"; }
+
+    // Arming applies from the next start().
+    bool arm(ArmedTrack track);
+    void disarm(std::string_view trackId);
+    std::vector<ArmedTrack> armedTracks() const;
+
+    bool start(Options options, std::string& error);
+    void stop();
+    // Discards the running takes without adding clips.
+    void cancel();
+    bool isRecording() const;
+    // Takes that produced clips when recording last stopped.
+    std::vector<Take> lastTakes() const;
+
+    // Audio thread. `timelinePosition` is the timeline sample of the block's
+    // first frame. Never allocates, locks or blocks.
+    void capture(const AudioProcessContext& deviceInput,
+                 int64_t timelinePosition, uint32_t frameCount) noexcept;
+
+    void playbackStopped() override;
+    void recordingStopped() override;
+
+private:
+    struct Lane;
+    struct Session;
+
+    std::unique_ptr<Session> detachSession();
+    void commit();
+
+    mutable std::mutex mutex_;
+    std::vector<ArmedTrack> armed_;
+    std::unique_ptr<Session> session_;
+    std::vector<Take> last_takes_;
+    // The session capture() reads; in_capture_ lets detachSession() wait out
+    // a block that is still writing to it.
+    std::atomic<Session*> active_session_{nullptr};
+    std::atomic<bool> in_capture_{false};
+    SequencerEngine& engine_;
+};
+
+} // namespace uapmd
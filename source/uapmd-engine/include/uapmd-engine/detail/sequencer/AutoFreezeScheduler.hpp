@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "AudioProcessingEventHandler.hpp"
+
+namespace uapmd {
+
+class SequencerEngine;
+class TimelineFacade;
+
+// Freezes tracks automatically to keep track processing within a CPU budget.
+//
+// The cost of every track is measured on the audio thread around its
+// processing (as a fraction of the real time the processed frames represent).
+// While enabled, the scheduler periodically compares the total against the
+// budget and freezes the most expensive live tracks until the projection fits.
+// Tracks that are being edited are left alone: a track is held live for a while
+// after it becomes dirty and for as long as one of its plug-in UIs is open.
+// Either event also unfreezes a track the scheduler froze. Tracks frozen by the
+// user are never touched.
+class AutoFreezeScheduler final : public AudioProcessingEventHandler {
+public:
+    struct TrackLoad {
+        int32_t trackIndex{-1};
+        // Share of the callback period spent processing the track in the last
+        // evaluation window; for tracks frozen by the scheduler, the last cost
+        // measured while the track was live.
+        double load{0.0};
+        bool autoFrozen{false};
+        bool held{false};
+    };
+
+    AutoFreezeScheduler(SequencerEngine& engine, TimelineFacade& timeline);
+    ~AutoFreezeScheduler() override;
+
+    // Off by default. Disabling unfreezes the tracks the scheduler froze.
+    bool enabled() const;
+    void setEnabled(bool enabled);
+    // Share of each audio callback period that track processing may use.
+    double cpuBudget() const;
+    void setCpuBudget(double fractionOfCallback);
+    // How long a track stays live after it was last edited.
+    std::chrono::milliseconds editHoldDuration() const;
+    void setEditHoldDuration(std::chrono::milliseconds duration);
+
+    bool isAutoFrozen(int32_t trackIndex) const;
+    // Measurements of the last evaluation.
+    std::vector<TrackLoad> trackLoads() const;
+    double totalLoad() const;
+
+    // Closes the current measurement window and applies the policy. Runs on
+    // the main thread once per second while enabled; callable directly.
+    void evaluate();
+
+    void trackBecameDirty(int32_t trackIndex);
+    void pluginUIOpened(int32_t instanceId);
+    void pluginUIClosed(int32_t instanceId);
+
+    void beforeTrackProcess(const TrackAudioProcessingEvent& event) noexcept override;
+    void afterTrackProcess(const TrackAudioProcessingEvent& event) noexcept override;
+
+private:
+    // Tracks beyond this index are not measured and never frozen automatically.
+    static constexpr size_t kMaxMeasuredTracks = 512;
+    // Tracks using less than this share of the budget are not worth a render.
+    static constexpr double kMinimumShareOfBudget = 0.01;
+    static constexpr std::chrono::milliseconds kEvaluationInterval{1000};
+
+    struct TrackTimingSlot {
+        int64_t started_ns{0}; // audio thread only
+        std::atomic<uint64_t> busy_ns{0};
+        std::atomic<uint64_t> frames{0};
+    };
+
+    struct AsyncLifetime {
+        std::atomic<AutoFreezeScheduler*> owner{nullptr};
+    };
+
+    bool isHeld(const std::string& trackReferenceId,
+                std::chrono::steady_clock::time_point now) const;
+    void holdTrack(int32_t trackIndex, bool openedUI, int32_t instanceId);
+    void unfreezeIfAutoFrozen(int32_t trackIndex, const std::string& reference);
+    void startTimer();
+    void stopTimer();
+
+    SequencerEngine& engine_;
+    TimelineFacade& timeline_;
+    std::array<TrackTimingSlot, kMaxMeasuredTracks> timing_slots_{};
+
+    mutable std::mutex mutex_;
+    std::atomic<bool> enabled_{false};
+    double cpu_budget_{0.7};
+    std::chrono::milliseconds edit_hold_duration_{30000};
+    std::vector<std::string> measured_track_references_;
+    std::vector<TrackLoad> track_loads_;
+    double total_load_{0.0};
+    std::unordered_map<std::string, double> live_load_by_track_reference_;
+    std::unordered_set<std::string> auto_frozen_track_references_;
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point>
+        last_edit_by_track_reference_;
+    std::unordered_map<int32_t, std::string> open_ui_track_by_instance_;
+
+    std::shared_ptr<AsyncLifetime> async_lifetime_;
+    std::mutex timer_mutex_;
+    std::condition_variable timer_wake_;
+    bool timer_stopping_{false};
+    std::thread timer_thread_;
+};
+
+} // namespace uapmd
@@ -3,12 +3,14 @@
 #include <atomic>
 #include <cstdint>
 #include <deque>
+#include <filesystem>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -22,6 +24,9 @@ namespace uapmd {
 class TimelineFacade;
 class FrozenTrackAudioProcessorExtension;
 class FrozenTrackManagerProjectSerializationExtension;
+class FrozenTrackCacheFile;
+class FrozenTrackCacheFileWriter;
+class FrozenTrackCachePrefetcher;
 
 class FrozenTrackManager final : public ProjectDocumentEventListener {
 public:
@@ -37,6 +42,15 @@ public:
         Error,
     };
 
+    // Sample storage of frozen renders. Renders are streamed to a cache file and
+    // played back from a read-only mapping rather than held in memory. The
+    // integer formats are block-scaled, so track output above 0 dBFS survives.
+    enum class CacheSampleFormat : uint8_t {
+        Float32,
+        PCM24,
+        PCM16,
+    };
+
     FrozenTrackManager(SequencerEngine& engine, TimelineFacade& timeline);
     ~FrozenTrackManager();
 
@@ -51,6 +65,10 @@ public:
         int32_t trackIndex) const;
     uint64_t invalidationGenerationForTrack(int32_t trackIndex) const;
     std::string errorMessageForTrack(int32_t trackIndex) const;
+    // False for tracks a render would always reject: return tracks, tracks
+    // with device input, tracks without timeline content and tracks whose
+    // plug-ins report an infinite tail.
+    bool canFreezeTrack(int32_t trackIndex) const;
     bool isTrackBusy(int32_t trackIndex) const;
     bool isInstanceBusy(int32_t instanceId) const;
     bool hasBusyTrack() const;
@@ -60,6 +78,22 @@ public:
     void transportPlaybackStarted();
     void transportPlaybackStopped();
 
+    // When enabled, tracks whose plug-ins allow it (see
+    // SequencerEngine::canRenderTrackInBackground()) are rendered on a worker
+    // thread instead of pausing the engine. They still wait for a quiet
+    // transport, since the track is out of the mix while it renders; starting
+    // playback hands it back at once and the render runs again after Stop.
+    // Off by default.
+    bool backgroundRenderingEnabled() const;
+    void setBackgroundRenderingEnabled(bool enabled);
+
+    // Applies to renders started after the change.
+    CacheSampleFormat cacheSampleFormat() const;
+    void setCacheSampleFormat(CacheSampleFormat format);
+    // Memory kept resident ahead of the playhead, shared by all frozen tracks.
+    uint64_t cacheMemoryBudgetInBytes() const;
+    void setCacheMemoryBudgetInBytes(uint64_t bytes);
+
 private:
     friend class FrozenTrackAudioProcessorExtension;
     friend class FrozenTrackManagerProjectSerializationExtension;
@@ -70,7 +104,7 @@ private:
     struct CachedAudio {
         int64_t start_sample{0};
         std::vector<uint32_t> bus_channel_counts;
-        std::vector<std::vector<float>> channels;
+        std::shared_ptr<const FrozenTrackCacheFile> file;
     };
 
     struct PlaybackState {
@@ -95,6 +129,8 @@ private:
         uint64_t generation{0};
         OfflineTrackRenderSettings settings;
         OfflineRenderProgress progress;
+        std::shared_ptr<FrozenTrackCacheFileWriter> writer;
+        std::filesystem::path cache_path;
     };
 
     struct AsyncLifetime {
@@ -104,6 +140,11 @@ private:
     std::string_view extensionId() const;
     bool saveProjectExtensionData(ProjectSerializationWriteContext& context, std::string& error);
     bool loadProjectExtensionData(ProjectSerializationReadContext& context, std::string& error);
+    // Whether target still holds the copy saved from this very render.
+    bool renderCopyIsCurrent(
+        const std::string& trackReferenceId,
+        const std::shared_ptr<const FrozenTrackCacheFile>& render,
+        const std::filesystem::path& target) const;
     bool shouldProcessAudio(
         SequencerEngine& engine,
         uapmd_track_index_t trackIndex,
@@ -140,6 +181,16 @@ private:
     void prepareRender(std::string trackReferenceId);
     void enqueueRenderStep(const std::shared_ptr<RenderOperation>& operation);
     void renderNextChunk(const std::shared_ptr<RenderOperation>& operation);
+    void startBackgroundRender(const std::shared_ptr<RenderOperation>& operation);
+    void completeBackgroundRender(
+        const std::shared_ptr<RenderOperation>& operation,
+        bool canceled,
+        OfflineTrackRenderStepResult step);
+    void cancelRenderOperation(
+        const std::shared_ptr<RenderOperation>& operation);
+    void finishRenderOperation(
+        const std::shared_ptr<RenderOperation>& operation,
+        OfflineTrackRenderStepResult step);
     void completeRenderOperation(
         const std::shared_ptr<RenderOperation>& operation);
     void startNextQueuedRender();
@@ -149,7 +200,24 @@ private:
     void failRender(
         const std::shared_ptr<RenderOperation>& operation,
         std::string error);
+    void restoreRender(
+        std::string trackReferenceId,
+        uint64_t generation,
+        std::shared_ptr<const FrozenTrackCacheFile> file);
+    // Publishes cachedAudio as the track's frozen render if generation is still
+    // current. Must run inside resetTrackProcessingState()'s transition.
+    bool publishCachedAudio(
+        const std::string& trackReferenceId,
+        uint64_t generation,
+        std::unique_ptr<CachedAudio>& cachedAudio);
+    std::filesystem::path sessionCacheDirectory();
+    void updatePrefetchFiles();
     bool operationIsCurrent(const RenderOperation& operation) const;
+    bool rendersInBackground(int32_t trackIndex) const;
+    // Why a render of the track would fail up front, or empty if it would not.
+    std::string freezeBlockerForTrack(int32_t trackIndex) const;
+    // Whether a render has to wait for a quiet transport.
+    bool mustDeferRender() const;
     void updatePlaybackState(std::string_view trackReferenceId);
     void publishPlaybackSnapshot();
     void clearAllPlaybackCaches();
@@ -164,11 +232,31 @@ private:
     std::vector<std::unique_ptr<PlaybackSnapshot>> playback_snapshots_;
     std::atomic<const PlaybackSnapshot*> active_playback_snapshot_{nullptr};
     std::vector<std::unique_ptr<CachedAudio>> retained_cached_audio_;
+    std::atomic<CacheSampleFormat> cache_sample_format_{CacheSampleFormat::PCM24};
+    // Renders made in this session live here until they are saved into the
+    // project; the directory is removed with the manager.
+    std::filesystem::path session_cache_directory_;
+    std::unordered_map<std::string, std::filesystem::path>
+        session_cache_files_by_track_reference_;
+    // The project copy each render was last saved to, so that later saves
+    // skip renders that are already there unchanged.
+    struct SavedRenderCopy {
+        std::weak_ptr<const FrozenTrackCacheFile> render;
+        std::filesystem::path target;
+        std::filesystem::file_time_type written_at{};
+        uintmax_t size{0};
+    };
+    std::unordered_map<std::string, SavedRenderCopy>
+        saved_render_copies_by_track_reference_;
+    std::unique_ptr<FrozenTrackCachePrefetcher> prefetcher_;
     std::shared_ptr<RenderOperation> active_render_;
     std::deque<std::string> queued_renders_;
     std::function<void()> pending_playback_start_;
     std::atomic<bool> stopping_{false};
     std::atomic<bool> playback_active_{false};
+    std::atomic<bool> background_rendering_enabled_{false};
+    // Steps the active background render; joined before it is finished.
+    std::thread background_render_thread_;
     std::shared_ptr<AsyncLifetime> async_lifetime_;
     uint64_t transport_quiet_listener_token_{0};
     ProjectDocumentEventListenerToken project_document_event_listener_token_{0};
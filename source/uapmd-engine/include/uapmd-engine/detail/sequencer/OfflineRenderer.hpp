@@ -16,8 +16,18 @@ enum class OfflineInfiniteTailPolicy {
     LATENCY_FALLBACK = 1,
 };
 
+enum class OfflineRenderFileFormat {
+    // FLAC for a ".flac" extension, WAV otherwise.
+    FROM_EXTENSION = 0,
+    // 32-bit float.
+    WAV = 1,
+    // 24-bit lossless; samples beyond full scale are clipped.
+    FLAC = 2,
+};
+
 struct OfflineRenderSettings {
     std::filesystem::path outputPath;
+    OfflineRenderFileFormat fileFormat{OfflineRenderFileFormat::FROM_EXTENSION};
     double startSeconds{0.0};
     std::optional<double> endSeconds;
     bool useContentFallback{false};
@@ -63,6 +73,17 @@ struct OfflineTrackRenderSettings {
     uint32_t bufferSize{1024};
     uint32_t umpBufferSize{65536};
     uint64_t maximumBytes{512ULL * 1024ULL * 1024ULL};
+    // Render alongside live playback instead of pausing the engine. Requires
+    // SequencerEngine::canRenderTrackInBackground() for the track.
+    bool background{false};
+    // When set, every rendered block is handed to this sink (one pointer per
+    // output channel, in bus order) instead of being accumulated in
+    // OfflineTrackRenderResult::channels, and maximumBytes does not apply.
+    // Returning false fails the render with the given error.
+    std::function<bool(const float* const* channels,
+                       uint32_t channelCount,
+                       int32_t frameCount,
+                       std::string& error)> blockSink;
 };
 
 struct OfflineTrackRenderResult {
@@ -86,8 +107,44 @@ struct OfflineTrackRenderStepResult {
     std::string errorMessage;
 };
 
+// Renders several tracks into one file each. Tracks are rendered one after
+// another with SequencerEngine::renderOfflineTrack(), streaming every block to
+// its file; a pool of encoder threads compresses and writes the blocks while
+// the next ones render. Each stem holds all output buses of its track, in bus
+// order.
+struct OfflineStemRenderSettings {
+    struct Stem {
+        int32_t trackIndex{0};
+        std::filesystem::path outputPath;
+    };
+    std::vector<Stem> stems;
+    OfflineRenderFileFormat fileFormat{OfflineRenderFileFormat::FROM_EXTENSION};
+    int64_t startSample{0};
+    int64_t endSample{0};
+    int32_t sampleRate{48000};
+    uint32_t bufferSize{1024};
+    uint32_t umpBufferSize{65536};
+    // 0 picks one less than the hardware threads, at most 4.
+    uint32_t encoderThreads{0};
+};
+
+struct OfflineStemRenderResult {
+    bool success{false};
+    bool canceled{false};
+    // Written files, in stem order. Empty unless the render succeeded.
+    std::vector<std::filesystem::path> outputPaths;
+    std::string errorMessage;
+};
+
+OfflineRenderFileFormat resolveOfflineRenderFileFormat(OfflineRenderFileFormat format,
+                                                       const std::filesystem::path& path);
+
 OfflineRenderResult renderOfflineProject(SequencerEngine& engine,
                                          const OfflineRenderSettings& settings,
                                          const OfflineRenderCallbacks& callbacks = {});
 
+OfflineStemRenderResult renderOfflineStems(SequencerEngine& engine,
+                                           const OfflineStemRenderSettings& settings,
+                                           const OfflineRenderCallbacks& callbacks = {});
+
 } // namespace uapmd
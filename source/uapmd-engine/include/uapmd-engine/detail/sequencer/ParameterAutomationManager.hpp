@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <uapmd-data/uapmd-data.hpp>
+#include <uapmd-plugin-hosting/uapmd-plugin-hosting.hpp>
+#include "SequenceProcessContext.hpp"
+#include "SequencerProcessingLifecycleListener.hpp"
+
+namespace uapmd {
+    typedef int32_t uapmd_track_index_t;
+    class SequencerEngine;
+
+    struct ParameterAutomationLane {
+        int32_t instanceId{-1};
+        int32_t parameterIndex{-1};
+        // Plain parameter values, as setParameterValue() takes them.
+        std::vector<AutomationPoint> points{};
+    };
+
+    // Breakpoint automation lanes for the parameters of plug-ins on regular
+    // tracks, played while the transport runs.
+    //
+    // The timeline renders each track's lanes for exactly the samples it
+    // renders its clips for, so automation follows loops and latency
+    // compensation the same way. The values go into preallocated per-block
+    // buffers, and the audio thread hands them to each plug-in's RT
+    // parameter queue with their frame offsets right before the track graph
+    // runs: points land on their sample, and linear ramps move every
+    // kRampStepFrames frames.
+    //
+    // A lane only sends a value when it changes. It restates its current
+    // value at the start of the next block after a seek, a transport start or
+    // stop, a loop wrap, a block that was not rendered or dropped events, a
+    // processing reset or a lane edit, since the plug-in may not hold it
+    // then. Events of a bypassed track never reach its plug-ins; they catch
+    // up at the next change or transport transition.
+    class ParameterAutomationManager final
+        : public ProjectSerializationExtension
+        , public SequencerProcessingLifecycleListener {
+    public:
+        static constexpr int32_t kRampStepFrames = 32;
+        // Capacity of each per-block event buffer. Further events in a block
+        // are dropped and counted in droppedEventCount(), and their lanes
+        // restate their values in the next block.
+        static constexpr size_t kEventCapacityPerBlock = 1024;
+        // Reader slots of the lane snapshot: live playback, and one render
+        // running beside it.
+        static constexpr size_t kLiveReader = 0;
+        static constexpr size_t kRenderReader = 1;
+        static constexpr size_t kReaderCount = 2;
+
+        explicit ParameterAutomationManager(SequencerEngine& engine);
+        ~ParameterAutomationManager() override;
+
+        std::string_view extensionId() const override {
+            return "org.uapmd.engine.parameter-automation";
+        }
+        bool saveProjectData(UapmdProjectData& project, std::string& error) override;
+        bool loadProjectData(UapmdProjectData& project, std::string& error) override;
+
+        // Replaces the lane of the parameter; no points removes it. Fails when
+        // the instance is not on a regular track.
+        bool setLane(int32_t instanceId, int32_t parameterIndex, std::vector<AutomationPoint> points);
+        bool removeLane(int32_t instanceId, int32_t parameterIndex);
+        std::vector<ParameterAutomationLane> lanes(uapmd_track_index_t trackIndex) const;
+
+        // Audio thread, or the thread rendering the track. Appends the values
+        // of the track's lanes for [renderStartSample, renderStartSample +
+        // frameCount), placed `destinationOffsetFrames` into the block.
+        // Never allocates.
+        void render(uapmd_track_index_t trackIndex,
+                    int64_t renderStartSample,
+                    int32_t destinationOffsetFrames,
+                    int32_t frameCount,
+                    std::vector<ParameterAutomationEvent>& events,
+                    size_t readerIndex = kLiveReader) const noexcept;
+        // Thread of the live render(), before rendering each block. Blocks of
+        // an older transport generation are discarded unplayed, so a new one
+        // restates every lane.
+        void liveTransportGeneration(uint64_t generation) noexcept {
+            live_transport_generation_.store(generation, std::memory_order_relaxed);
+        }
+        // Any thread. Makes every lane restate its value in its next block.
+        void restateAll() noexcept { restate_epoch_.fetch_add(1, std::memory_order_release); }
+        // Events dropped because a block's buffer was full, since creation.
+        uint64_t droppedEventCount() const noexcept {
+            return dropped_events_.load(std::memory_order_relaxed);
+        }
+        // Same threads as render(). Enqueues the events to the track's
+        // plug-ins in block order. Events whose instance has left the track
+        // are dropped.
+        void apply(uapmd_track_index_t trackIndex,
+                   std::vector<ParameterAutomationEvent>& events,
+                   size_t readerIndex = kLiveReader) const noexcept;
+
+        void trackRemoved(uapmd_track_index_t trackIndex) override;
+        void pluginInstanceWillBeDestroyed(int32_t instanceId) override;
+        void pluginGraphChanged() override;
+        void audioProcessingConfigurationChanged() override;
+        void trackProcessingStateReset(uapmd_track_index_t trackIndex) override;
+        void processingStateReset() override;
+        void transportTransition(SequencerTransportTransition transition,
+                                 int64_t audiblePositionSamples) override;
+
+    private:
+        struct Lane {
+            int32_t instanceId{-1};
+            int32_t parameterIndex{-1};
+            std::shared_ptr<const AutomationCurve> curve{};
+        };
+        // What a reader last sent for a lane, and where its render stopped.
+        struct LaneCursor {
+            uint64_t epoch{0};
+            int64_t nextSample{-1};
+            double value{0.0};
+        };
+        struct RtLane {
+            int32_t instanceId{-1};
+            int32_t parameterIndex{-1};
+            std::shared_ptr<const AutomationCurve> curve{};
+            // One per reader, each touched only by its reader's thread.
+            mutable std::array<LaneCursor, kReaderCount> cursors{};
+        };
+        struct RtTrack {
+            std::vector<RtLane> lanes{};
+            std::vector<std::pair<int32_t, uapmd_plugin_hosting::AudioPluginInstanceAPI*>> instances{};
+        };
+        using RtSnapshot = std::vector<RtTrack>;
+
+        // Republishes the lanes against the current tracks. Given an instance
+        // that is about to be destroyed, leaves it out and returns only once
+        // no reader holds an older snapshot that could still reach it.
+        void publish(int32_t destroyedInstanceId = -1);
+
+        SequencerEngine& engine_;
+        std::vector<Lane> lanes_{};
+        RtSnapshotPublisher<RtSnapshot, kReaderCount> snapshot_{};
+        // Starts at 1, so that fresh cursors never match.
+        std::atomic<uint64_t> restate_epoch_{1};
+        std::atomic<uint64_t> live_transport_generation_{0};
+        mutable std::atomic<uint64_t> dropped_events_{0};
+    };
+}
@@ -54,6 +54,10 @@ public:
     virtual bool setClipAudioWarps(int32_t trackIndex, int32_t clipId,
                                    std::vector<AudioWarpPoint> audioWarps,
                                    ProjectMutationOrigin origin = ProjectMutationOrigin::User) = 0;
+    // Sets where in its source the clip starts and whether it loops. The
+    // clip's duration is left alone; resize it to repeat the loop further.
+    virtual bool setClipRegion(int32_t trackIndex, int32_t clipId, const ClipRegion& region,
+                               ProjectMutationOrigin origin = ProjectMutationOrigin::User) = 0;
 
     // Track properties. These address their track by its stable document
     // identity during replay, so inserting or removing another track does not
@@ -73,6 +77,10 @@ public:
     // its runtime instance id, which changes when it is removed and restored.
     virtual bool setPluginBypassed(int32_t instanceId, bool bypassed,
                                    ProjectMutationOrigin origin = ProjectMutationOrigin::User) = 0;
+    // Whether the plug-in is skipped while it only turns silence into
+    // silence. Off by default; meant for effects and input-driven plug-ins.
+    virtual bool setPluginSleepsWhenSilent(int32_t instanceId, bool sleepsWhenSilent,
+                                           ProjectMutationOrigin origin = ProjectMutationOrigin::User) = 0;
     virtual bool setPluginParameterValue(int32_t instanceId, int32_t parameterIndex, double value,
                                          ProjectMutationOrigin origin = ProjectMutationOrigin::User) = 0;
     // Per-note edits share the plug-in's identity and history, so changing the
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+
+namespace uapmd {
+
+// Opt-in detector for allocations and mutex locks made on the audio thread. It is
+// compiled only when UAPMD_ENABLE_RT_SAFETY_CHECKS is ON (which defines
+// UAPMD_RT_SAFETY_CHECKS=1); otherwise every member below is an inline no-op.
+//
+// SequencerEngine marks the calling thread for the duration of processAudio().
+// The interposed malloc/free family (glibc), operator new/delete (elsewhere) and
+// pthread_mutex_lock count every call made while the thread is marked. Setting the
+// UAPMD_RT_SAFETY_ABORT environment variable (or abortOnViolation(true)) turns the
+// first violation into a stack trace followed by std::abort().
+class RealtimeSafetyMonitor {
+public:
+    struct Counters {
+        uint64_t allocations{0};
+        uint64_t deallocations{0};
+        uint64_t lockAcquisitions{0};
+
+        uint64_t total() const { return allocations + deallocations + lockAcquisitions; }
+    };
+
+#if UAPMD_RT_SAFETY_CHECKS
+    // Marks the current thread as an audio thread while alive. Scopes may nest.
+    class AudioThreadScope {
+    public:
+        AudioThreadScope() noexcept;
+        ~AudioThreadScope() noexcept;
+        AudioThreadScope(const AudioThreadScope&) = delete;
+        AudioThreadScope& operator=(const AudioThreadScope&) = delete;
+    };
+
+    // Unmarks the current thread while alive, for calls that are known to be
+    // non-realtime and are tracked elsewhere (e.g. diagnostics on deadline misses).
+    class SuppressionScope {
+    public:
+        SuppressionScope() noexcept;
+        ~SuppressionScope() noexcept;
+        SuppressionScope(const SuppressionScope&) = delete;
+        SuppressionScope& operator=(const SuppressionScope&) = delete;
+    private:
+        int32_t saved_depth_;
+    };
+
+    static constexpr bool available() { return true; }
+    static bool isAudioThread() noexcept;
+    static Counters counters() noexcept;
+    static void resetCounters() noexcept;
+    static bool abortOnViolation() noexcept;
+    static void abortOnViolation(bool enabled) noexcept;
+#else
+    class AudioThreadScope {
+    public:
+        AudioThreadScope() noexcept = default;
+    };
+
+    class SuppressionScope {
+    public:
+        SuppressionScope() noexcept = default;
+    };
+
+    static constexpr bool available() { return false; }
+    static bool isAudioThread() noexcept { return false; }
+    static Counters counters() noexcept { return {}; }
+    static void resetCounters() noexcept {}
+    static bool abortOnViolation() noexcept { return false; }
+    static void abortOnViolation(bool) noexcept {}
+#endif
+};
+
+} // namespace uapmd
@@ -4,10 +4,23 @@
 #include "uapmd-midi-service/uapmd-midi-service.hpp"
 
 namespace uapmd {
+    // A plain parameter value from an automation lane, due `frameOffset`
+    // frames into the block.
+    struct ParameterAutomationEvent {
+        int32_t instanceId{-1};
+        int32_t parameterIndex{-1};
+        int32_t frameOffset{0};
+        double value{0.0};
+    };
+
     class SequenceProcessContext {
         MasterContext master_context{};
     public:
         MasterContext& masterContext() { return master_context; }
         std::vector<AudioProcessContext*> tracks{};
+        // Index-aligned with tracks: where automation rendered for each
+        // track's block goes, or nullptr when the block takes none. Storage is
+        // preallocated and must not grow on the audio thread.
+        std::vector<std::vector<ParameterAutomationEvent>*> automation{};
     };
-}
\ No newline at end of file
+}
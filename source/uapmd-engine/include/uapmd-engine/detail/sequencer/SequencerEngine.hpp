@@ -14,6 +14,7 @@
 #include "SequencerProcessingLifecycleListener.hpp"
 #include "PluginInstanceLifecycleListener.hpp"
 #include "LatencyCompensationManager.hpp"
+#include "ParameterAutomationManager.hpp"
 #include "OfflineRenderer.hpp"
 #include "TimelineFacade.hpp"
 
@@ -21,6 +22,7 @@ namespace uapmd {
     class SequencerEngine;
     class SequencerTrack;
     class FrozenTrackManager;
+    class AutoFreezeScheduler;
     class TailProcessManager;
     class MidiRecorder;
     class PlaybackEngineExtension;
@@ -45,6 +47,15 @@ namespace uapmd {
         ProjectObjectId trackId;
     };
 
+    // An aux send from a track's main output bus into a return track.
+    struct TrackSend {
+        uapmd_track_index_t returnTrackIndex{-1};
+        // Linear, clamped to the track fader's range.
+        double gain{1.0};
+        // Taps the track before its fader rather than after it.
+        bool preFader{false};
+    };
+
     // A sequence processor that works as a facade for the overall audio processing at each AudioPluginTrack.
     // It is used to enqueue input events to each audio track, to process once at a time when an audio I/O event arrives.
     // It is independent of DeviceIODispatcher, which fires `processAudio()` in its audio I/O callback.
@@ -77,6 +88,7 @@ namespace uapmd {
 
         virtual uapmd_plugin_hosting::AudioPluginHostingAPI* pluginHost() = 0;
         virtual FrozenTrackManager& frozenTrackManager() = 0;
+        virtual AutoFreezeScheduler& autoFreezeScheduler() = 0;
         virtual TailProcessManager& tailProcessManager() = 0;
         virtual uapmd_plugin_hosting::AudioPluginInstanceAPI* getPluginInstance(int32_t instanceId) = 0;
         virtual uapmd_midi_service::UapmdFunctionBlockManager* functionBlockManager() = 0;
@@ -96,6 +108,7 @@ namespace uapmd {
         virtual uint32_t masterTrackRenderLeadInSamples() = 0;
         virtual bool trackHasLiveInput(uapmd_track_index_t trackIndex) = 0;
         virtual LatencyCompensationManager* latencyCompensationManager() = 0;
+        virtual ParameterAutomationManager* parameterAutomationManager() = 0;
         virtual uint32_t trackOutputAlignmentHoldbackInSamples(uapmd_track_index_t trackIndex) = 0;
         virtual uint32_t trackOutputBusAlignmentHoldbackInSamples(uapmd_track_index_t trackIndex, uint32_t outputBusIndex) = 0;
         virtual uapmd_graph::TrackOutputRoutingTarget trackOutputBusRoutingTarget(uapmd_track_index_t trackIndex, uint32_t outputBusIndex) = 0;
@@ -104,6 +117,18 @@ namespace uapmd {
             uapmd_track_index_t trackIndex,
             const std::vector<uapmd_graph::TrackOutputRoutingRule>& rules) = 0;
         virtual bool isOutputAlignmentActive() = 0;
+        // Return tracks hold shared effects. Each one takes the sum of the
+        // sends that target it as extra input on its first input bus, and is
+        // processed after every other track in the block; send paths are
+        // delay-compensated so a return stays aligned with the dry signal.
+        // Return tracks cannot send, which keeps the order one level deep.
+        // Clearing the flag drops the sends that targeted the track.
+        virtual bool trackIsReturn(uapmd_track_index_t trackIndex) = 0;
+        virtual bool setTrackIsReturn(uapmd_track_index_t trackIndex, bool isReturn) = 0;
+        virtual std::vector<TrackSend> trackSends(uapmd_track_index_t trackIndex) = 0;
+        // Fails without changing anything when a send does not target another
+        // return track, or when the track itself is a return.
+        virtual bool setTrackSends(uapmd_track_index_t trackIndex, std::vector<TrackSend> sends) = 0;
         // Create track with plugin + configure bus (replaces manual addSimpleTrack + configureMainBus pattern)
         // Appends by default. A non-negative insertion index is used when
         // restoring a removed track so its ordering is preserved.
@@ -128,6 +153,12 @@ namespace uapmd {
         // a new plugin.
         virtual void addPluginToTrack(uapmd_track_index_t trackIndex, std::string& format, std::string& pluginId, std::function<void(int32_t instanceId, uapmd_track_index_t trackIndex, std::string error)> callback, std::string restoreNodeId = {}) = 0;
         virtual bool removePluginInstance(int32_t instanceId) = 0;
+        // Fills the plugin host's instance pool with `count` instances of the
+        // plugin, configured the way addPluginToTrack() would configure them,
+        // so that inserting it later does not wait for instantiation. Does
+        // nothing while the pool capacity (pluginHost()->instancePoolCapacity())
+        // is 0.
+        virtual void prewarmPlugin(std::string& format, std::string& pluginId, uint32_t count) = 0;
         virtual bool removeTrack(uapmd_track_index_t trackIndex) = 0;
         virtual bool replaceTrackGraph(uapmd_track_index_t trackIndex, std::unique_ptr<uapmd_graph::AudioPluginGraph>&& graph) = 0;
 
@@ -141,9 +172,18 @@ namespace uapmd {
 
         // Set default channel configuration (called by RealtimeSequencer when device changes)
         virtual void setDefaultChannels(uint32_t inputChannels, uint32_t outputChannels) = 0;
+        // A changed rate is applied to every existing plugin instance in place,
+        // keeping its state; no project reload is needed. Non-audio thread.
         virtual void setSampleRate(int32_t sampleRate) = 0;
         virtual bool offlineRendering() const = 0;
         virtual void offlineRendering(bool enabled) = 0;
+        // Sample format of the track, mix and master buses; Float32 by
+        // default. Float64 runs the session in 64-bit: VST3 and CLAP plugins
+        // added afterwards process doubles natively, and other plugins as well
+        // as the device are converted at their boundary. Implies
+        // resetProcessingState(), so the same restriction applies.
+        virtual AudioContentType audioDataType() = 0;
+        virtual void audioDataType(AudioContentType dataType) = 0;
 
         virtual void setEngineActive(bool active) = 0;
 
@@ -204,9 +244,17 @@ namespace uapmd {
         // callback; step performs bounded work on the calling thread; finish
         // restores plugin/transport state and invokes transition before audio
         // processing is admitted again.
+        //
+        // With OfflineTrackRenderSettings::background, begin only withholds the
+        // rendered track from the live walk (it is heard as silence) and the
+        // rest of the project keeps playing. step may then be driven from one
+        // worker thread; begin and finish stay on the main thread.
         virtual bool beginOfflineTrackRender(
             const OfflineTrackRenderSettings& settings,
             std::string& error) = 0;
+        // Whether every plug-in on the track is of a format that may process on
+        // a render thread while the audio thread keeps running the other tracks.
+        virtual bool canRenderTrackInBackground(uapmd_track_index_t trackIndex) = 0;
         virtual OfflineTrackRenderStepResult renderOfflineTrackStep(
             uint32_t maximumBlocks) = 0;
         virtual OfflineTrackRenderResult finishOfflineTrackRender(
@@ -51,6 +51,9 @@ namespace uapmd {
         virtual double tailLengthInSeconds() = 0;
         virtual double trackGain() const = 0;
         virtual bool trackGain(double value) = 0;
+        // The fader node behind trackGain(), or nullptr when the graph has
+        // none. Looking it up walks the graph, so not for the audio thread.
+        virtual uapmd_graph::webaudio_compat::GainNode* trackGainNode() = 0;
         // These control admission to the main mix without stopping the graph.
         virtual bool muted() const = 0;
         virtual void muted(bool value) = 0;
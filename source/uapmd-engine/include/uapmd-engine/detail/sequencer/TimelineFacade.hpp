@@ -85,6 +85,19 @@ public:
         const std::string& filepath = "",
         ProjectMutationOrigin origin = ProjectMutationOrigin::User) = 0;
 
+    // Adds a clip that plays the same content as an existing one. The new
+    // clip's source shares the original's decoded audio or MIDI events
+    // instead of copying them, so repeating a pattern this way costs almost
+    // no memory. Region, duration, gain, markers and warps are taken over;
+    // afterwards the two clips are edited independently. `sourceTrackIndex`
+    // may differ from `trackIndex`.
+    virtual ClipAddResult addLinkedClip(
+        int32_t trackIndex,
+        const TimelinePosition& position,
+        int32_t sourceTrackIndex,
+        int32_t sourceClipId,
+        ProjectMutationOrigin origin = ProjectMutationOrigin::User) = 0;
+
     virtual bool removeClipFromTrack(
         int32_t trackIndex,
         int32_t clipId,
@@ -252,6 +265,10 @@ public:
         // final storage. Such callers mark the captured history node only after
         // the provider confirms the final write.
         bool markHistorySaved{true};
+        // Store plug-in states and exported MIDI clips as chunks of one binary
+        // container next to the manifest rather than as a file each. Chunks
+        // the container already holds are not written again.
+        bool chunkContainer{false};
     };
     using ProjectSaveCallback = std::function<void(ProjectResult)>;
     using ProjectLoadCallback = std::function<void(ProjectResult)>;
@@ -373,6 +390,18 @@ public:
     // Called by SequencerEngineImpl via the registered AudioPreprocessCallback.
     // Writes into targetSequence.tracks[i], typically pump ring-buffer slots.
     virtual void processTracksAudio(AudioProcessContext& process, SequenceProcessContext& targetSequence) = 0;
+    // Feeds a single track's clip sources into trackContext for a private,
+    // always-running render transport starting at renderStartSample (render
+    // offset already applied). The transport is derived from renderTimeline, a
+    // copy of state() the caller took on the main thread; the shared timeline
+    // is neither read nor moved, so this may run on a render thread while
+    // processTracksAudio() serves live playback, provided the caller keeps
+    // that track out of the live walk meanwhile.
+    virtual void processTrackAudioForRender(AudioProcessContext& process,
+                                            TimelineTrack& track,
+                                            AudioProcessContext& trackContext,
+                                            const TimelineState& renderTimeline,
+                                            int64_t renderStartSample) = 0;
 
     // Lifecycle hooks called by SequencerEngineImpl when tracks are added/removed
     virtual void onTrackAdded(uint32_t outputChannels,
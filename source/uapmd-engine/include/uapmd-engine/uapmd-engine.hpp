@@ -6,19 +6,24 @@
 #include "detail/devices/AudioIODevice.hpp"
 #include "detail/devices/MidiIODevice.hpp"
 #include "detail/devices/DeviceIODispatcher.hpp"
+#include "detail/devices/NullIODevice.hpp"
 #include "detail/sequencer/OfflineRenderer.hpp"
 #include "detail/sequencer/TailProcessManager.hpp"
 #include "detail/sequencer/MidiRecorder.hpp"
+#include "detail/sequencer/AudioRecorder.hpp"
 #include "detail/sequencer/PlaybackEngineExtension.hpp"
 #include "detail/sequencer/TrackAudioProcessorExtension.hpp"
 #include "detail/sequencer/AudioProcessingEventHandler.hpp"
+#include "detail/sequencer/RealtimeSafetyMonitor.hpp"
 #include "detail/sequencer/SequencerProcessingLifecycleListener.hpp"
 #include "detail/sequencer/PluginInstanceLifecycleListener.hpp"
 #include "detail/sequencer/ProjectAddressBook.hpp"
 #include "detail/sequencer/ProjectCommands.hpp"
 #include "detail/sequencer/FrozenTrackManager.hpp"
+#include "detail/sequencer/AutoFreezeScheduler.hpp"
 #include "detail/sequencer/SequencerTrack.hpp"
 #include "detail/sequencer/SequenceProcessContext.hpp"
+#include "detail/sequencer/ParameterAutomationManager.hpp"
 #include "detail/sequencer/TimelineFacade.hpp"
 #include "detail/sequencer/SequencerEngine.hpp"
 #include "detail/sequencer/RealtimeSequencer.hpp"
@@ -1,4 +1,6 @@
+#include <cstdlib>
 #include "uapmd-midi-service/uapmd-midi-service.hpp"
+#include <remidy/detail/common.hpp>
 
 #if defined(__EMSCRIPTEN__)
 #include "WebAudioWorkletIODevice.hpp"
@@ -9,7 +11,12 @@
 #endif
 
 uapmd::AudioIODeviceManager* uapmd::AudioIODeviceManager::instance(const std::string &driverName) {
-    (void) driverName;
+    // The null driver runs without hardware, e.g. on headless CI machines.
+    const char* requested = driverName.empty() ? std::getenv("UAPMD_AUDIO_DRIVER") : driverName.c_str();
+    if (requested && remidy_strcasecmp(requested, "null") == 0) {
+        static uapmd::NullAudioIODeviceManager nullImpl{};
+        return &nullImpl;
+    }
 #if defined(__EMSCRIPTEN__)
     static uapmd::WebAudioWorkletIODeviceManager impl{};
 #elif defined(__ANDROID__)
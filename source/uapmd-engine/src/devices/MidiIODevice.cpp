@@ -264,6 +264,9 @@ std::shared_ptr<uapmd::MidiIODevice> uapmd::createLibreMidiIODevice(std::string
 std::vector<uapmd::MidiPortInfo> uapmd::getMidiInputPorts(const std::vector<std::string>& excludedPortIds) {
     auto observer = makeObserver();
     std::vector<MidiPortInfo> result;
+    for (auto& port : getNullMidiPorts())
+        if (std::ranges::find(excludedPortIds, port.id) == excludedPortIds.end())
+            result.push_back(std::move(port));
     for (const auto& port : observer.get_input_ports())
         if (!isExcluded(port, excludedPortIds))
             result.push_back({portId(port), displayName(port)});
@@ -273,6 +276,9 @@ std::vector<uapmd::MidiPortInfo> uapmd::getMidiInputPorts(const std::vector<std:
 std::vector<uapmd::MidiPortInfo> uapmd::getMidiOutputPorts(const std::vector<std::string>& excludedPortIds) {
     auto observer = makeObserver();
     std::vector<MidiPortInfo> result;
+    for (auto& port : getNullMidiPorts())
+        if (std::ranges::find(excludedPortIds, port.id) == excludedPortIds.end())
+            result.push_back(std::move(port));
     for (const auto& port : observer.get_output_ports())
         if (!isExcluded(port, excludedPortIds))
             result.push_back({portId(port), displayName(port)});
@@ -280,6 +286,8 @@ std::vector<uapmd::MidiPortInfo> uapmd::getMidiOutputPorts(const std::vector<std
 }
 
 std::shared_ptr<MidiIOFeature> uapmd::openLibreMidiInputPort(const std::string& requestedPortId) {
+    if (auto port = findNullMidiPort(requestedPortId))
+        return port;
     auto observer = makeObserver();
     for (const auto& port : observer.get_input_ports())
         if (portId(port) == requestedPortId)
@@ -288,6 +296,8 @@ std::shared_ptr<MidiIOFeature> uapmd::openLibreMidiInputPort(const std::string&
 }
 
 std::shared_ptr<MidiIOFeature> uapmd::openLibreMidiOutputPort(const std::string& requestedPortId) {
+    if (auto port = findNullMidiPort(requestedPortId))
+        return port;
     auto observer = makeObserver();
     for (const auto& port : observer.get_output_ports())
         if (portId(port) == requestedPortId)
@@ -0,0 +1,493 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <utility>
+
+#include <choc/audio/choc_AudioFileFormat_WAV.h>
+#include "uapmd-engine/uapmd-engine.hpp"
+#include "../sequencer/SampleRing.hpp"
+
+namespace uapmd {
+    namespace {
+        constexpr uint32_t kDefaultPeriodFrames = 256;
+        // Output buffered between the device thread and the WAV writer.
+        constexpr double kOutputRingSeconds = 4.0;
+        constexpr auto kWriterIdleInterval = std::chrono::milliseconds(2);
+
+        std::chrono::nanoseconds framesToDuration(uint64_t frames, uint32_t sampleRate) {
+            return std::chrono::nanoseconds(frames * 1'000'000'000ull / sampleRate);
+        }
+
+        void storeMax(std::atomic<int64_t>& target, int64_t value) {
+            auto current = target.load(std::memory_order_relaxed);
+            while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+        }
+
+        std::mutex& nullMidiPortsMutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        std::vector<std::shared_ptr<NullMidiIODevice>>& nullMidiPorts() {
+            static std::vector<std::shared_ptr<NullMidiIODevice>> ports;
+            return ports;
+        }
+    }
+
+    // NullAudioIODevice
+
+    class NullAudioIODevice final : public AudioIODevice {
+        Logger* logger_;
+        MasterContext master_context{};
+        AudioProcessContext data; // no UMP events handled here.
+        std::vector<std::function<uapmd_status_t(AudioProcessContext& data)>> callbacks{};
+        NullAudioIOSimulation simulation_{};
+        uint32_t buffer_size_{kDefaultPeriodFrames};
+        uint32_t preferred_callback_frames_{0};
+        uint32_t configured_capacity_{0};
+
+        // Device input, planar, loaded at configure().
+        std::vector<std::vector<float>> input_{};
+        uint64_t input_frames_{0};
+
+        std::unique_ptr<SampleRing> output_ring_{};
+        std::vector<const float*> output_channels_{};
+        std::unique_ptr<choc::audio::AudioFileWriter> writer_{};
+        std::thread writer_thread_{};
+        std::atomic<bool> writer_running_{false};
+
+        std::thread thread_{};
+        std::atomic<bool> running_{false};
+
+        std::atomic<uint64_t> periods_{0};
+        std::atomic<uint64_t> frames_{0};
+        std::atomic<uint64_t> deadline_misses_{0};
+        std::atomic<int64_t> total_callback_ns_{0};
+        std::atomic<int64_t> max_callback_ns_{0};
+        std::atomic<int64_t> max_wakeup_lateness_ns_{0};
+        std::atomic<uint64_t> dropped_output_frames_{0};
+
+        uint32_t periodFrames(uint64_t periodIndex) const {
+            const auto& schedule = simulation_.periodSchedule;
+            if (!schedule.empty())
+                return std::max(schedule[periodIndex % schedule.size()], 1u);
+            return preferred_callback_frames_ > 0 ? preferred_callback_frames_ : buffer_size_;
+        }
+
+        uint32_t maximumPeriodFrames() const {
+            const auto& schedule = simulation_.periodSchedule;
+            if (!schedule.empty())
+                return std::max(*std::ranges::max_element(schedule), 1u);
+            return periodFrames(0);
+        }
+
+        bool loadInput() {
+            input_.clear();
+            input_frames_ = 0;
+            if (simulation_.inputFile.empty())
+                return true;
+            auto reader = createAudioFileReaderFromPath(simulation_.inputFile.string());
+            if (!reader) {
+                logger_->logError("Null audio device: cannot read input file %s", simulation_.inputFile.string().c_str());
+                return false;
+            }
+            const auto properties = reader->getProperties();
+            if (properties.sampleRate != simulation_.sampleRate)
+                logger_->logWarning("Null audio device: %s is %u Hz and plays unresampled at %u Hz",
+                                    simulation_.inputFile.string().c_str(), properties.sampleRate, simulation_.sampleRate);
+            input_.assign(properties.numChannels, std::vector<float>(properties.numFrames, 0.0f));
+            std::vector<float*> channels;
+            for (auto& channel : input_)
+                channels.push_back(channel.data());
+            reader->readFrames(0, properties.numFrames, channels.data(), properties.numChannels);
+            input_frames_ = properties.numFrames;
+            return true;
+        }
+
+        void readInput(uint64_t position, uint32_t frames) {
+            for (uint32_t ch = 0; ch < simulation_.inputChannels; ++ch) {
+                auto* dst = data.getFloatInBuffer(0, ch);
+                if (!dst)
+                    continue;
+                // A mono file feeds every input channel.
+                const auto* src = ch < input_.size() ? &input_[ch]
+                    : input_.size() == 1 ? &input_[0] : nullptr;
+                if (!src || input_frames_ == 0) {
+                    std::fill_n(dst, frames, 0.0f);
+                    continue;
+                }
+                for (uint32_t frame = 0; frame < frames; ++frame) {
+                    auto sourceFrame = position + frame;
+                    if (simulation_.loopInput)
+                        sourceFrame %= input_frames_;
+                    dst[frame] = sourceFrame < input_frames_ ? (*src)[sourceFrame] : 0.0f;
+                }
+            }
+        }
+
+        bool openOutput() {
+            if (simulation_.outputFile.empty() || simulation_.outputChannels == 0)
+                return true;
+            choc::audio::AudioFileProperties properties;
+            properties.sampleRate = static_cast<double>(simulation_.sampleRate);
+            properties.numChannels = simulation_.outputChannels;
+            properties.bitDepth = choc::audio::BitDepth::float32;
+            writer_ = choc::audio::WAVAudioFileFormat<true>().createWriter(simulation_.outputFile.string(), properties);
+            if (!writer_) {
+                logger_->logError("Null audio device: cannot write output file %s", simulation_.outputFile.string().c_str());
+                return false;
+            }
+            output_ring_ = std::make_unique<SampleRing>(
+                static_cast<size_t>(kOutputRingSeconds * simulation_.sampleRate) * simulation_.outputChannels);
+            output_channels_.assign(simulation_.outputChannels, nullptr);
+            writer_running_.store(true, std::memory_order_release);
+            writer_thread_ = std::thread([this] { runWriter(); });
+            return true;
+        }
+
+        void closeOutput() {
+            if (writer_thread_.joinable()) {
+                writer_running_.store(false, std::memory_order_release);
+                writer_thread_.join();
+            }
+            if (writer_)
+                writer_->flush();
+            writer_.reset();
+            output_ring_.reset();
+        }
+
+        // Writer thread. Deinterleaves whole frames from the ring into the file.
+        void runWriter() {
+            const auto channelCount = simulation_.outputChannels;
+            std::vector<float> pending;
+            std::vector<std::vector<float>> planar(channelCount);
+            std::vector<const float*> channels(channelCount);
+            const auto drain = [&] {
+                const auto drained = output_ring_->drain([&](const float* samples, size_t count) {
+                    pending.insert(pending.end(), samples, samples + count);
+                });
+                const auto frames = pending.size() / channelCount;
+                if (frames == 0)
+                    return drained;
+                for (uint32_t ch = 0; ch < channelCount; ++ch) {
+                    planar[ch].resize(frames);
+                    for (size_t frame = 0; frame < frames; ++frame)
+                        planar[ch][frame] = pending[frame * channelCount + ch];
+                    channels[ch] = planar[ch].data();
+                }
+                writer_->appendFrames(choc::buffer::createChannelArrayView(
+                    channels.data(), channelCount, static_cast<uint32_t>(frames)));
+                pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(frames * channelCount));
+                return drained;
+            };
+            while (writer_running_.load(std::memory_order_acquire))
+                if (drain() == 0)
+                    std::this_thread::sleep_for(kWriterIdleInterval);
+            drain();
+        }
+
+        void captureOutput(uint32_t frames) {
+            if (!output_ring_)
+                return;
+            const auto channelCount = static_cast<uint32_t>(output_channels_.size());
+            if (output_ring_->writableSamples() < static_cast<size_t>(frames) * channelCount) {
+                dropped_output_frames_.fetch_add(frames, std::memory_order_relaxed);
+                return;
+            }
+            const auto busChannels = data.audioOutBusCount() > 0 ? data.outputChannelCount(0) : 0;
+            for (uint32_t ch = 0; ch < channelCount; ++ch)
+                output_channels_[ch] = ch < busChannels ? data.getFloatOutBuffer(0, ch) : nullptr;
+            output_ring_->writeFrames(output_channels_.data(), channelCount, 0, frames);
+        }
+
+        // The device thread. Period n is due when the frames before it have
+        // played at the sample rate; it must be done by the time it would
+        // have played itself.
+        void run() {
+            using clock = std::chrono::steady_clock;
+            std::mt19937_64 random{simulation_.jitterSeed};
+            const auto jitterNanoseconds = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(simulation_.jitter).count());
+            const auto sampleRate = simulation_.sampleRate;
+            auto origin = clock::now();
+            uint64_t position = 0;
+            for (uint64_t period = 0; running_.load(std::memory_order_acquire); ++period) {
+                const auto frames = periodFrames(period);
+                const auto scheduled = origin + framesToDuration(position, sampleRate);
+                const auto deadline = origin + framesToDuration(position + frames, sampleRate);
+                if (simulation_.realtime) {
+                    auto wake = scheduled;
+                    // mt19937_64 output is fully specified, unlike the standard
+                    // distributions, so the delays repeat on every platform.
+                    if (jitterNanoseconds > 0)
+                        wake += std::chrono::nanoseconds(random() % (jitterNanoseconds + 1));
+                    std::this_thread::sleep_until(wake);
+                }
+
+                const auto begin = clock::now();
+                for (const auto& port : simulation_.midiPorts)
+                    if (port)
+                        port->deliverUntil(position + frames);
+                readInput(position, frames);
+                master_context.playbackPositionSamples(static_cast<int64_t>(position));
+                data.frameCount(static_cast<int32_t>(frames));
+                for (auto& callback : callbacks)
+                    callback(data);
+                const auto end = clock::now();
+                captureOutput(frames);
+
+                const auto callbackTime = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+                periods_.fetch_add(1, std::memory_order_relaxed);
+                frames_.fetch_add(frames, std::memory_order_relaxed);
+                total_callback_ns_.fetch_add(callbackTime, std::memory_order_relaxed);
+                storeMax(max_callback_ns_, callbackTime);
+                if (simulation_.realtime) {
+                    storeMax(max_wakeup_lateness_ns_,
+                             std::chrono::duration_cast<std::chrono::nanoseconds>(begin - scheduled).count());
+                    if (end > deadline) {
+                        deadline_misses_.fetch_add(1, std::memory_order_relaxed);
+                        // Like a hardware xrun, the overrun is lost rather than
+                        // made up by running the next periods early.
+                        origin += end - deadline;
+                    }
+                }
+                position += frames;
+            }
+        }
+
+    public:
+        explicit NullAudioIODevice(Logger* logger)
+            : logger_(logger), data(master_context, 0) {
+        }
+
+        ~NullAudioIODevice() override {
+            stop();
+        }
+
+        bool configure(const NullAudioIOSimulation& simulation, uint32_t sampleRate, uint32_t bufferSize) {
+            stop();
+            simulation_ = simulation;
+            if (sampleRate > 0)
+                simulation_.sampleRate = sampleRate;
+            if (simulation_.sampleRate == 0)
+                simulation_.sampleRate = 48000;
+            buffer_size_ = bufferSize > 0 ? bufferSize : kDefaultPeriodFrames;
+            master_context.sampleRate(static_cast<int32_t>(simulation_.sampleRate));
+            configured_capacity_ = 0;
+            return loadInput();
+        }
+
+        void addAudioCallback(std::function<uapmd_status_t(AudioProcessContext& data)>&& callback) override {
+            callbacks.emplace_back(std::move(callback));
+        }
+        void clearAudioCallbacks() override {
+            callbacks.clear();
+        }
+        void setPreferredCallbackSize(uint32_t framesPerCallback) override {
+            preferred_callback_frames_ = framesPerCallback;
+        }
+        uint32_t preferredCallbackSize() const override { return preferred_callback_frames_; }
+
+        double sampleRate() override { return simulation_.sampleRate; }
+        uint32_t inputChannels() override { return simulation_.inputChannels; }
+        uint32_t outputChannels() override { return simulation_.outputChannels; }
+        std::vector<uint32_t> getNativeSampleRates() override { return {simulation_.sampleRate}; }
+        void clearOutputBuffers() override { data.clearAudioOutputs(); }
+        bool useAutoBufferSize() override { return false; }
+        bool useAutoBufferSize(bool) override { return false; }
+
+        uapmd_status_t start() override {
+            if (running_.load(std::memory_order_acquire))
+                return 0;
+            // Sized up front so that no period allocates.
+            const auto capacity = maximumPeriodFrames();
+            if (capacity != configured_capacity_) {
+                data.configureMainBus(static_cast<int32_t>(simulation_.inputChannels),
+                                      static_cast<int32_t>(simulation_.outputChannels), capacity);
+                configured_capacity_ = capacity;
+            }
+            if (!openOutput())
+                return 1;
+            for (const auto& port : simulation_.midiPorts)
+                if (port)
+                    port->rewind();
+            periods_ = 0;
+            frames_ = 0;
+            deadline_misses_ = 0;
+            total_callback_ns_ = 0;
+            max_callback_ns_ = 0;
+            max_wakeup_lateness_ns_ = 0;
+            dropped_output_frames_ = 0;
+            running_.store(true, std::memory_order_release);
+            thread_ = std::thread([this] { run(); });
+            return 0;
+        }
+
+        uapmd_status_t stop() override {
+            if (thread_.joinable()) {
+                running_.store(false, std::memory_order_release);
+                thread_.join();
+            }
+            closeOutput();
+            return 0;
+        }
+
+        bool isPlaying() override { return running_.load(std::memory_order_acquire); }
+
+        NullAudioIOStatistics statistics() const {
+            NullAudioIOStatistics result;
+            result.periods = periods_.load(std::memory_order_relaxed);
+            result.frames = frames_.load(std::memory_order_relaxed);
+            result.deadlineMisses = deadline_misses_.load(std::memory_order_relaxed);
+            result.totalCallbackTime = std::chrono::nanoseconds(total_callback_ns_.load(std::memory_order_relaxed));
+            result.maxCallbackTime = std::chrono::nanoseconds(max_callback_ns_.load(std::memory_order_relaxed));
+            result.maxWakeupLateness = std::chrono::nanoseconds(max_wakeup_lateness_ns_.load(std::memory_order_relaxed));
+            result.droppedOutputFrames = dropped_output_frames_.load(std::memory_order_relaxed);
+            return result;
+        }
+    };
+
+    // NullAudioIODeviceManager
+
+    NullAudioIODeviceManager::NullAudioIODeviceManager() : AudioIODeviceManager("null") {
+    }
+
+    NullAudioIODeviceManager::~NullAudioIODeviceManager() = default;
+
+    void NullAudioIODeviceManager::initialize(Configuration& config) {
+        logger_ = config.logger ? config.logger : Logger::global();
+        initialized = true;
+    }
+
+    std::vector<AudioIODeviceInfo> NullAudioIODeviceManager::onDevices() {
+        std::vector<AudioIODeviceInfo> result;
+        if (simulation_.inputChannels > 0)
+            result.push_back({UAPMD_AUDIO_DIRECTION_INPUT, 0, "Null Audio Input",
+                              simulation_.sampleRate, simulation_.inputChannels});
+        if (simulation_.outputChannels > 0)
+            result.push_back({UAPMD_AUDIO_DIRECTION_OUTPUT, 1, "Null Audio Output",
+                              simulation_.sampleRate, simulation_.outputChannels});
+        return result;
+    }
+
+    AudioIODevice* NullAudioIODeviceManager::onOpen(int inputDeviceIndex,
+                                                    int outputDeviceIndex,
+                                                    uint32_t sampleRate,
+                                                    uint32_t bufferSize) {
+        (void) inputDeviceIndex;
+        (void) outputDeviceIndex;
+        if (!logger_)
+            logger_ = Logger::global();
+        if (!device_)
+            device_ = std::make_unique<NullAudioIODevice>(logger_);
+        if (!device_->configure(simulation_, sampleRate, bufferSize))
+            return nullptr;
+        for (const auto& port : simulation_.midiPorts)
+            if (port)
+                registerNullMidiPort(port);
+        return device_.get();
+    }
+
+    std::vector<uint32_t> NullAudioIODeviceManager::getDeviceSampleRates(const std::string&, AudioIODirections) {
+        return {22050, 44100, 48000, 88200, 96000, 176400, 192000};
+    }
+
+    NullAudioIOStatistics NullAudioIODeviceManager::statistics() const {
+        return device_ ? device_->statistics() : NullAudioIOStatistics{};
+    }
+
+    // NullMidiIODevice
+
+    NullMidiIODevice::NullMidiIODevice(std::string portId, std::string displayName)
+        : port_id_(std::move(portId)),
+          display_name_(displayName.empty() ? port_id_ : std::move(displayName)) {
+    }
+
+    NullMidiIODevice::~NullMidiIODevice() = default;
+
+    void NullMidiIODevice::addInputHandler(ump_receiver_t receiver, void* userData) {
+        receivers_.push_back(receiver);
+        receiver_user_data_.push_back(userData);
+    }
+
+    void NullMidiIODevice::removeInputHandler(ump_receiver_t receiver) {
+        const auto position = std::ranges::find(receivers_, receiver);
+        if (position == receivers_.end())
+            return;
+        const auto index = static_cast<size_t>(position - receivers_.begin());
+        receivers_.erase(position);
+        receiver_user_data_.erase(receiver_user_data_.begin() + static_cast<std::ptrdiff_t>(index));
+    }
+
+    void NullMidiIODevice::send(uapmd_ump_t* messages, size_t sizeInBytes, uapmd_timestamp_t) {
+        if (!messages || sizeInBytes < sizeof(uapmd_ump_t))
+            return;
+        std::lock_guard lock(sent_mutex_);
+        sent_.insert(sent_.end(), messages, messages + sizeInBytes / sizeof(uapmd_ump_t));
+    }
+
+    void NullMidiIODevice::schedule(uint64_t frame, const uapmd_ump_t* words, size_t sizeInBytes) {
+        if (!words || sizeInBytes < sizeof(uapmd_ump_t))
+            return;
+        ScheduledEvent event{frame, {words, words + sizeInBytes / sizeof(uapmd_ump_t)}};
+        const auto position = std::ranges::upper_bound(scheduled_, frame, {}, &ScheduledEvent::frame);
+        scheduled_.insert(position, std::move(event));
+    }
+
+    void NullMidiIODevice::clearSchedule() {
+        scheduled_.clear();
+        next_event_ = 0;
+    }
+
+    void NullMidiIODevice::deliverUntil(uint64_t endFrame) {
+        for (; next_event_ < scheduled_.size() && scheduled_[next_event_].frame < endFrame; ++next_event_) {
+            auto& event = scheduled_[next_event_];
+            for (size_t i = 0; i < receivers_.size(); ++i)
+                receivers_[i](receiver_user_data_[i], event.words.data(),
+                              event.words.size() * sizeof(uapmd_ump_t),
+                              static_cast<uapmd_timestamp_t>(event.frame));
+        }
+    }
+
+    void NullMidiIODevice::rewind() {
+        next_event_ = 0;
+    }
+
+    std::vector<uapmd_ump_t> NullMidiIODevice::takeSentMessages() {
+        std::lock_guard lock(sent_mutex_);
+        return std::exchange(sent_, {});
+    }
+
+    void registerNullMidiPort(std::shared_ptr<NullMidiIODevice> port) {
+        if (!port)
+            return;
+        std::lock_guard lock(nullMidiPortsMutex());
+        auto& ports = nullMidiPorts();
+        std::erase_if(ports, [&](const auto& existing) { return existing->portId() == port->portId(); });
+        ports.push_back(std::move(port));
+    }
+
+    void unregisterNullMidiPort(const std::string& portId) {
+        std::lock_guard lock(nullMidiPortsMutex());
+        std::erase_if(nullMidiPorts(), [&](const auto& existing) { return existing->portId() == portId; });
+    }
+
+    std::shared_ptr<NullMidiIODevice> findNullMidiPort(const std::string& portId) {
+        std::lock_guard lock(nullMidiPortsMutex());
+        for (const auto& port : nullMidiPorts())
+            if (port->portId() == portId)
+                return port;
+        return nullptr;
+    }
+
+    std::vector<MidiPortInfo> getNullMidiPorts() {
+        std::lock_guard lock(nullMidiPortsMutex());
+        std::vector<MidiPortInfo> result;
+        for (const auto& port : nullMidiPorts())
+            result.push_back({port->portId(), port->displayName()});
+        return result;
+    }
+}
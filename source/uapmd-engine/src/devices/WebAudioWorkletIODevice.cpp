@@ -27,15 +27,18 @@ namespace uapmd {
             return;
         const auto frames = std::min<uint32_t>(static_cast<uint32_t>(frameCount), bufferSize);
         auto* destination = sab->track_output + trackIndex * kWebAudioChannels * bufferSize;
-        for (uint32_t channel = 0; channel < kWebAudioChannels; ++channel) {
-            auto* dst = destination + channel * bufferSize;
-            const auto* src = context.audioOutBusCount() > 0 &&
-                    channel < context.outputChannelCount(0)
-                ? context.getFloatOutBuffer(0, channel)
-                : nullptr;
-            if (src)
-                std::memcpy(dst, src, frames * sizeof(float));
-        }
+        context.withSampleType([&](auto* tag) {
+            using SampleType = std::remove_pointer_t<decltype(tag)>;
+            for (uint32_t channel = 0; channel < kWebAudioChannels; ++channel) {
+                auto* dst = destination + channel * bufferSize;
+                const auto* src = context.audioOutBusCount() > 0 &&
+                        channel < context.outputChannelCount(0)
+                    ? context.getOutBuffer<SampleType>(0, channel)
+                    : nullptr;
+                if (src)
+                    std::copy_n(src, frames, dst);
+            }
+        });
     }
 
     void publishWebAudioTrackCount(uint32_t trackCount) {
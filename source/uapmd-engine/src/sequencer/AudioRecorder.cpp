@@ -0,0 +1,414 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <uapmd-engine/uapmd-engine.hpp>
+#include "SampleRing.hpp"
+
+namespace uapmd {
+
+namespace {
+
+constexpr uint32_t kWavHeaderSize = 44;
+constexpr uint32_t kBytesPerSample = sizeof(float);
+// Bounds the per-block pointer table capture() keeps on the stack.
+constexpr size_t kMaxRecordedChannels = 64;
+// The writer polls rather than being woken, since the audio thread must not
+// signal. A few milliseconds is far below any sensible ring size.
+constexpr auto kWriterIdleInterval = std::chrono::milliseconds(2);
+
+void putLittleEndian(uint8_t* destination, uint32_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i)
+        destination[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+// Canonical 44-byte header for 32-bit float WAV.
+void writeWavHeader(std::FILE* file, uint32_t channelCount, uint32_t sampleRate, uint32_t dataBytes) {
+    uint8_t header[kWavHeaderSize]{};
+    std::memcpy(header, "RIFF", 4);
+    putLittleEndian(header + 4, 36 + dataBytes, 4);
+    std::memcpy(header + 8, "WAVEfmt ", 8);
+    putLittleEndian(header + 16, 16, 4);
+    putLittleEndian(header + 20, 3, 2); // WAVE_FORMAT_IEEE_FLOAT
+    putLittleEndian(header + 22, channelCount, 2);
+    putLittleEndian(header + 24, sampleRate, 4);
+    putLittleEndian(header + 28, sampleRate * channelCount * kBytesPerSample, 4);
+    putLittleEndian(header + 32, channelCount * kBytesPerSample, 2);
+    putLittleEndian(header + 34, 8 * kBytesPerSample, 2);
+    std::memcpy(header + 36, "data", 4);
+    putLittleEndian(header + 40, dataBytes, 4);
+    std::fseek(file, 0, SEEK_SET);
+    std::fwrite(header, 1, sizeof(header), file);
+}
+
+bool setFileSize(std::FILE* file, uint64_t size) {
+    std::fflush(file);
+#if defined(_WIN32)
+    return _chsize_s(_fileno(file), static_cast<__int64>(size)) == 0;
+#else
+    return ftruncate(fileno(file), static_cast<off_t>(size)) == 0;
+#endif
+}
+
+// Allocates disk blocks for the first `size` bytes and extends the file to
+// that length, so that the writer neither waits for the filesystem to find
+// blocks nor fails half way on a full disk. ftruncate() alone only makes a
+// sparse file on most filesystems; it is the fallback where allocating is
+// not supported.
+bool reserveFileSpace(std::FILE* file, uint64_t size) {
+    std::fflush(file);
+#if defined(_WIN32)
+    const auto handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file)));
+    if (handle != INVALID_HANDLE_VALUE) {
+        FILE_ALLOCATION_INFO allocation{};
+        allocation.AllocationSize.QuadPart = static_cast<LONGLONG>(size);
+        FILE_END_OF_FILE_INFO endOfFile{};
+        endOfFile.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+        if (SetFileInformationByHandle(handle, FileAllocationInfo, &allocation, sizeof(allocation)) &&
+            SetFileInformationByHandle(handle, FileEndOfFileInfo, &endOfFile, sizeof(endOfFile)))
+            return true;
+    }
+#elif defined(__linux__) || defined(__ANDROID__)
+    // Unlike posix_fallocate(), fails instead of writing zeros where the
+    // filesystem cannot allocate.
+    if (fallocate(fileno(file), 0, 0, static_cast<off_t>(size)) == 0)
+        return true;
+#elif defined(__APPLE__)
+    struct stat status{};
+    if (fstat(fileno(file), &status) == 0 && static_cast<uint64_t>(status.st_size) < size) {
+        fstore_t store{F_ALLOCATECONTIG, F_PEOFPOSMODE, 0,
+                       static_cast<off_t>(size - static_cast<uint64_t>(status.st_size)), 0};
+        if (fcntl(fileno(file), F_PREALLOCATE, &store) == -1) {
+            store.fst_flags = F_ALLOCATEALL;
+            fcntl(fileno(file), F_PREALLOCATE, &store);
+        }
+    }
+#elif !defined(__EMSCRIPTEN__)
+    if (posix_fallocate(fileno(file), 0, static_cast<off_t>(size)) == 0)
+        return true;
+#endif
+    return setFileSize(file, size);
+}
+
+std::string fileNameComponent(std::string_view text) {
+    std::string result;
+    for (const char c : text)
+        result.push_back(std::isalnum(static_cast<unsigned char>(c)) || c == '-' ? c : '_');
+    return result.empty() ? std::string("track") : result;
+}
+
+} // namespace
+
+struct AudioRecorder::Lane {
+    Lane(ArmedTrack track, size_t ringSamples)
+        : trackId(std::move(track.trackId)),
+          inputChannels(std::move(track.inputChannels)),
+          ring(ringSamples) {}
+
+    std::string trackId;
+    std::vector<uint32_t> inputChannels;
+    std::filesystem::path path;
+    SampleRing ring;
+
+    // Writer side (the writer thread, then the stopping thread once it has
+    // joined).
+    std::FILE* file{nullptr};
+    uint64_t samplesWritten{0};
+    uint64_t reservedBytes{0};
+    bool writeFailed{false};
+
+    // Audio thread side; read by the stopping thread after detachSession().
+    int64_t startSample{-1};
+    int64_t nextSample{0};
+    bool ended{false};
+    bool truncated{false};
+};
+
+struct AudioRecorder::Session {
+    std::vector<std::unique_ptr<Lane>> lanes;
+    int32_t sampleRate{48000};
+    int64_t punchIn{std::numeric_limits<int64_t>::min()};
+    int64_t punchOut{std::numeric_limits<int64_t>::max()};
+    // Frames that still fit the 32-bit WAV size fields, per lane.
+    std::vector<int64_t> maximumFrames;
+    uint64_t preallocationBytesPerChannel{0};
+    std::atomic<bool> writerRunning{true};
+    std::thread writer;
+
+    // Returns the number of samples written.
+    size_t drain() {
+        size_t total = 0;
+        for (auto& lane : lanes) {
+            total += lane->ring.drain([&](const float* samples, size_t count) {
+                if (lane->writeFailed || !lane->file)
+                    return;
+                const auto end = kWavHeaderSize + (lane->samplesWritten + count) * kBytesPerSample;
+                if (end > lane->reservedBytes) {
+                    const auto step = preallocationBytesPerChannel * lane->inputChannels.size();
+                    const auto reserved = std::max<uint64_t>(end, lane->reservedBytes + step);
+                    // Reserving is an optimisation; a filesystem that refuses
+                    // it still gets the samples.
+                    if (reserveFileSpace(lane->file, reserved))
+                        lane->reservedBytes = reserved;
+                }
+                if (std::fwrite(samples, kBytesPerSample, count, lane->file) != count)
+                    lane->writeFailed = true;
+                lane->samplesWritten += count;
+            });
+        }
+        return total;
+    }
+
+    void runWriter() {
+        while (writerRunning.load(std::memory_order_acquire))
+            if (drain() == 0)
+                std::this_thread::sleep_for(kWriterIdleInterval);
+    }
+};
+
+AudioRecorder::AudioRecorder(SequencerEngine& engine) : engine_(engine) {}
+
+AudioRecorder::~AudioRecorder() { cancel(); }
+
+bool AudioRecorder::arm(ArmedTrack track) {
+    if (track.trackId.empty() || track.inputChannels.empty() ||
+        track.inputChannels.size() > kMaxRecordedChannels)
+        return false;
+    std::lock_guard lock(mutex_);
+    std::erase_if(armed_, [&](const ArmedTrack& armed) { return armed.trackId == track.trackId; });
+    armed_.push_back(std::move(track));
+    return true;
+}
+
+void AudioRecorder::disarm(std::string_view trackId) {
+    std::lock_guard lock(mutex_);
+    std::erase_if(armed_, [&](const ArmedTrack& armed) { return armed.trackId == trackId; });
+}
+
+std::vector<AudioRecorder::ArmedTrack> AudioRecorder::armedTracks() const {
+    std::lock_guard lock(mutex_);
+    return armed_;
+}
+
+bool AudioRecorder::start(Options options, std::string& error) {
+    {
+        std::lock_guard lock(mutex_);
+        if (session_) {
+            error = "Audio recording is already running";
+            return false;
+        }
+        if (armed_.empty()) {
+            error = "No track is armed for audio recording";
+            return false;
+        }
+        std::error_code ec;
+        std::filesystem::create_directories(options.directory, ec);
+        if (ec) {
+            error = "Cannot create recording directory " + options.directory.string() + ": " + ec.message();
+            return false;
+        }
+
+        auto session = std::make_unique<Session>();
+        session->sampleRate = std::max(1, engine_.currentSampleRate());
+        if (options.punchIn)
+            session->punchIn = *options.punchIn;
+        if (options.punchOut)
+            session->punchOut = *options.punchOut;
+        session->preallocationBytesPerChannel = static_cast<uint64_t>(
+            std::max(0.0, options.preallocationSeconds) * session->sampleRate) * kBytesPerSample;
+        const auto ringFrames = static_cast<size_t>(
+            std::max(0.1, options.ringSeconds) * session->sampleRate);
+        const auto stamp = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+
+        for (const auto& armed : armed_) {
+            const auto channels = static_cast<uint32_t>(armed.inputChannels.size());
+            auto lane = std::make_unique<Lane>(armed, ringFrames * channels);
+            const auto baseName = fileNameComponent(armed.trackId) + "-" + std::to_string(stamp);
+            lane->path = options.directory / (baseName + ".wav");
+            for (int suffix = 2; std::filesystem::exists(lane->path); ++suffix)
+                lane->path = options.directory / (baseName + "-" + std::to_string(suffix) + ".wav");
+            lane->file = std::fopen(lane->path.string().c_str(), "wb+");
+            if (!lane->file) {
+                error = "Cannot create " + lane->path.string();
+                for (auto& opened : session->lanes) {
+                    std::fclose(opened->file);
+                    std::filesystem::remove(opened->path, ec);
+                }
+                return false;
+            }
+            writeWavHeader(lane->file, channels, static_cast<uint32_t>(session->sampleRate), 0);
+            const auto reserved = kWavHeaderSize + session->preallocationBytesPerChannel * channels;
+            lane->reservedBytes = reserveFileSpace(lane->file, reserved) ? reserved : kWavHeaderSize;
+            session->maximumFrames.push_back(static_cast<int64_t>(
+                (std::numeric_limits<uint32_t>::max() - kWavHeaderSize) / (channels * kBytesPerSample)));
+            session->lanes.push_back(std::move(lane));
+        }
+
+        session->writer = std::thread([raw = session.get()] { raw->runWriter(); });
+        active_session_.store(session.get(), std::memory_order_seq_cst);
+        session_ = std::move(session);
+    }
+    engine_.notifyRecordingStarted();
+    return true;
+}
+
+void AudioRecorder::capture(const AudioProcessContext& deviceInput,
+                            int64_t timelinePosition, uint32_t frameCount) noexcept {
+    in_capture_.store(true, std::memory_order_seq_cst);
+    auto* session = active_session_.load(std::memory_order_seq_cst);
+    if (!session || frameCount == 0) {
+        in_capture_.store(false, std::memory_order_release);
+        return;
+    }
+
+    const auto begin = std::max(timelinePosition, session->punchIn);
+    const auto end = std::min(timelinePosition + static_cast<int64_t>(frameCount), session->punchOut);
+    const uint32_t deviceChannels =
+        deviceInput.audioInBusCount() > 0 ? static_cast<uint32_t>(deviceInput.inputChannelCount(0)) : 0;
+
+    for (size_t i = 0; begin < end && i < session->lanes.size(); ++i) {
+        auto& lane = *session->lanes[i];
+        if (lane.ended)
+            continue;
+        const auto count = end - begin;
+        if (lane.startSample >= 0 && begin != lane.nextSample) {
+            // The transport jumped; anything after it belongs to another take.
+            lane.ended = true;
+            continue;
+        }
+        const auto recorded = lane.startSample >= 0 ? lane.nextSample - lane.startSample : 0;
+        const auto channelCount = static_cast<uint32_t>(lane.inputChannels.size());
+        if (recorded + count > session->maximumFrames[i] ||
+            lane.ring.writableSamples() < static_cast<size_t>(count) * channelCount) {
+            lane.ended = true;
+            lane.truncated = true;
+            continue;
+        }
+
+        // Channels the device does not provide are recorded as silence.
+        const float* channels[kMaxRecordedChannels];
+        for (uint32_t ch = 0; ch < channelCount; ++ch) {
+            const auto source = lane.inputChannels[ch];
+            channels[ch] = source < deviceChannels ? deviceInput.getFloatInBuffer(0, source) : nullptr;
+        }
+        lane.ring.writeFrames(channels, channelCount,
+                              static_cast<uint32_t>(begin - timelinePosition),
+                              static_cast<uint32_t>(count));
+        if (lane.startSample < 0)
+            lane.startSample = begin;
+        lane.nextSample = end;
+    }
+
+    in_capture_.store(false, std::memory_order_release);
+}
+
+std::unique_ptr<AudioRecorder::Session> AudioRecorder::detachSession() {
+    std::unique_ptr<Session> session;
+    {
+        std::lock_guard lock(mutex_);
+        session = std::move(session_);
+    }
+    if (!session)
+        return nullptr;
+    active_session_.store(nullptr, std::memory_order_seq_cst);
+    while (in_capture_.load(std::memory_order_seq_cst))
+        std::this_thread::yield();
+    session->writerRunning.store(false, std::memory_order_release);
+    if (session->writer.joinable())
+        session->writer.join();
+    session->drain();
+    return session;
+}
+
+void AudioRecorder::playbackStopped() { commit(); }
+
+void AudioRecorder::recordingStopped() { commit(); }
+
+void AudioRecorder::commit() {
+    auto session = detachSession();
+    if (!session)
+        return;
+
+    std::vector<Take> takes;
+    for (auto& lane : session->lanes) {
+        const auto channels = static_cast<uint32_t>(lane->inputChannels.size());
+        const auto frames = static_cast<int64_t>(lane->samplesWritten / channels);
+        const auto dataBytes = static_cast<uint32_t>(frames * channels * kBytesPerSample);
+        bool usable = !lane->writeFailed && frames > 0;
+        if (lane->file) {
+            usable = setFileSize(lane->file, kWavHeaderSize + dataBytes) && usable;
+            writeWavHeader(lane->file, channels, static_cast<uint32_t>(session->sampleRate), dataBytes);
+            usable = std::fclose(lane->file) == 0 && usable;
+            lane->file = nullptr;
+        }
+        std::error_code ec;
+        const auto trackIndex = engine_.timeline().trackIndexForReferenceId(lane->trackId);
+        if (!usable || trackIndex < 0) {
+            if (lane->writeFailed)
+                remidy::Logger::global()->logError("Audio recording to %s failed", lane->path.string().c_str());
+            std::filesystem::remove(lane->path, ec);
+            continue;
+        }
+        auto reader = createAudioFileReaderFromPath(lane->path.string());
+        auto result = engine_.timeline().addAudioClipToTrack(
+            trackIndex,
+            TimelinePosition::fromSamples(lane->startSample, session->sampleRate),
+            std::move(reader),
+            lane->path.string());
+        if (!result.success) {
+            remidy::Logger::global()->logError("Recorded take %s could not be added: %s",
+                                               lane->path.string().c_str(), result.error.c_str());
+            continue;
+        }
+        takes.push_back(Take{lane->trackId, lane->path, lane->startSample, frames,
+                             result.clipId, lane->truncated});
+    }
+
+    std::lock_guard lock(mutex_);
+    last_takes_ = std::move(takes);
+}
+
+void AudioRecorder::stop() {
+    if (!isRecording())
+        return;
+    engine_.notifyRecordingStopped();
+}
+
+void AudioRecorder::cancel() {
+    auto session = detachSession();
+    if (!session)
+        return;
+    for (auto& lane : session->lanes) {
+        if (lane->file)
+            std::fclose(lane->file);
+        lane->file = nullptr;
+        std::error_code ec;
+        std::filesystem::remove(lane->path, ec);
+    }
+}
+
+bool AudioRecorder::isRecording() const {
+    std::lock_guard lock(mutex_);
+    return session_ != nullptr;
+}
+
+std::vector<AudioRecorder::Take> AudioRecorder::lastTakes() const {
+    std::lock_guard lock(mutex_);
+    return last_takes_;
+}
+
+} // namespace uapmd
@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include <remidy/remidy.hpp>
+#include <uapmd-engine/uapmd-engine.hpp>
+
+namespace uapmd {
+
+namespace {
+
+int64_t steadyNowInNanoseconds() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+AutoFreezeScheduler::AutoFreezeScheduler(
+    SequencerEngine& engine,
+    TimelineFacade& timeline)
+    : engine_(engine)
+    , timeline_(timeline)
+    , async_lifetime_(std::make_shared<AsyncLifetime>()) {
+    async_lifetime_->owner.store(this, std::memory_order_release);
+}
+
+AutoFreezeScheduler::~AutoFreezeScheduler() {
+    async_lifetime_->owner.store(nullptr, std::memory_order_release);
+    stopTimer();
+}
+
+bool AutoFreezeScheduler::enabled() const {
+    return enabled_.load(std::memory_order_acquire);
+}
+
+void AutoFreezeScheduler::setEnabled(bool enabled) {
+    if (enabled_.exchange(enabled, std::memory_order_acq_rel) == enabled)
+        return;
+    if (enabled) {
+        // Start from a fresh window rather than whatever accumulated while
+        // the scheduler was off.
+        for (auto& slot : timing_slots_) {
+            slot.busy_ns.store(0, std::memory_order_relaxed);
+            slot.frames.store(0, std::memory_order_relaxed);
+        }
+        startTimer();
+        return;
+    }
+
+    stopTimer();
+    std::unordered_set<std::string> autoFrozen;
+    {
+        std::lock_guard lock(mutex_);
+        autoFrozen = std::move(auto_frozen_track_references_);
+        auto_frozen_track_references_.clear();
+    }
+    const auto tracks = timeline_.tracks();
+    for (size_t index = 0; index < tracks.size(); ++index)
+        if (tracks[index] && autoFrozen.contains(tracks[index]->referenceId()))
+            engine_.frozenTrackManager().setFreezePolicyForTrack(
+                static_cast<int32_t>(index), FrozenTrackManager::FreezePolicy::Off);
+}
+
+double AutoFreezeScheduler::cpuBudget() const {
+    std::lock_guard lock(mutex_);
+    return cpu_budget_;
+}
+
+void AutoFreezeScheduler::setCpuBudget(double fractionOfCallback) {
+    std::lock_guard lock(mutex_);
+    cpu_budget_ = std::clamp(fractionOfCallback, 0.0, 1.0);
+}
+
+std::chrono::milliseconds AutoFreezeScheduler::editHoldDuration() const {
+    std::lock_guard lock(mutex_);
+    return edit_hold_duration_;
+}
+
+void AutoFreezeScheduler::setEditHoldDuration(std::chrono::milliseconds duration) {
+    std::lock_guard lock(mutex_);
+    edit_hold_duration_ = std::max(duration, std::chrono::milliseconds{0});
+}
+
+bool AutoFreezeScheduler::isAutoFrozen(int32_t trackIndex) const {
+    const auto tracks = timeline_.tracks();
+    if (trackIndex < 0 || static_cast<size_t>(trackIndex) >= tracks.size() ||
+        !tracks[static_cast<size_t>(trackIndex)])
+        return false;
+    std::lock_guard lock(mutex_);
+    return auto_frozen_track_references_.contains(
+        tracks[static_cast<size_t>(trackIndex)]->referenceId());
+}
+
+std::vector<AutoFreezeScheduler::TrackLoad> AutoFreezeScheduler::trackLoads() const {
+    std::lock_guard lock(mutex_);
+    return track_loads_;
+}
+
+double AutoFreezeScheduler::totalLoad() const {
+    std::lock_guard lock(mutex_);
+    return total_load_;
+}
+
+void AutoFreezeScheduler::evaluate() {
+    const auto sampleRate = engine_.currentSampleRate();
+    const auto tracks = timeline_.tracks();
+    auto& frozenTracks = engine_.frozenTrackManager();
+    const auto now = std::chrono::steady_clock::now();
+
+    std::vector<std::string> references(tracks.size());
+    std::vector<bool> frozenByPolicy(tracks.size(), false);
+    std::vector<bool> live(tracks.size(), false);
+    std::vector<bool> freezable(tracks.size(), false);
+    for (size_t index = 0; index < tracks.size(); ++index) {
+        if (!tracks[index])
+            continue;
+        const auto trackIndex = static_cast<int32_t>(index);
+        references[index] = tracks[index]->referenceId();
+        frozenByPolicy[index] = frozenTracks.freezePolicyForTrack(trackIndex) ==
+            FrozenTrackManager::FreezePolicy::On;
+        live[index] = !frozenByPolicy[index] &&
+            frozenTracks.runtimeStateForTrack(trackIndex) ==
+                FrozenTrackManager::RuntimeState::Live &&
+            !frozenTracks.isTrackBusy(trackIndex);
+        // A track a render would reject would end in an error, keep its On
+        // policy, and hide the load of the tracks that could take its place.
+        freezable[index] = live[index] && frozenTracks.canFreezeTrack(trackIndex);
+    }
+
+    std::vector<int32_t> freezeCandidates;
+    {
+        std::lock_guard lock(mutex_);
+
+        // Tracks the user unfroze (or removed) are no longer ours.
+        std::erase_if(auto_frozen_track_references_, [&](const std::string& reference) {
+            const auto it = std::ranges::find(references, reference);
+            return it == references.end() ||
+                !frozenByPolicy[static_cast<size_t>(it - references.begin())];
+        });
+        std::erase_if(open_ui_track_by_instance_, [&](const auto& entry) {
+            return std::ranges::find(references, entry.second) == references.end();
+        });
+        std::erase_if(last_edit_by_track_reference_, [&](const auto& entry) {
+            return now - entry.second >= edit_hold_duration_;
+        });
+
+        std::vector<double> loads(tracks.size(), 0.0);
+        for (size_t index = 0; index < tracks.size() && index < kMaxMeasuredTracks; ++index) {
+            const auto busy = timing_slots_[index].busy_ns.exchange(0, std::memory_order_acq_rel);
+            const auto frames = timing_slots_[index].frames.exchange(0, std::memory_order_acq_rel);
+            if (frames == 0 || sampleRate <= 0)
+                continue;
+            const double realtimeNs = static_cast<double>(frames) * 1e9 / sampleRate;
+            loads[index] = static_cast<double>(busy) / realtimeNs;
+        }
+
+        // Measurements are taken by track index. After tracks were added,
+        // removed or reordered they cannot be attributed; start over.
+        if (references != measured_track_references_) {
+            measured_track_references_ = references;
+            track_loads_.clear();
+            total_load_ = 0.0;
+            return;
+        }
+
+        track_loads_.clear();
+        total_load_ = 0.0;
+        for (size_t index = 0; index < tracks.size(); ++index) {
+            if (!tracks[index])
+                continue;
+            const auto& reference = references[index];
+            total_load_ += loads[index];
+            if (live[index] && loads[index] > 0.0)
+                live_load_by_track_reference_[reference] = loads[index];
+            TrackLoad entry;
+            entry.trackIndex = static_cast<int32_t>(index);
+            entry.autoFrozen = auto_frozen_track_references_.contains(reference);
+            entry.held = isHeld(reference, now);
+            const auto lastLive = live_load_by_track_reference_.find(reference);
+            entry.load = entry.autoFrozen && lastLive != live_load_by_track_reference_.end()
+                ? lastLive->second
+                : loads[index];
+            track_loads_.push_back(entry);
+        }
+        std::erase_if(live_load_by_track_reference_, [&](const auto& entry) {
+            return std::ranges::find(references, entry.first) == references.end();
+        });
+
+        if (!enabled_.load(std::memory_order_acquire) || total_load_ <= cpu_budget_)
+            return;
+
+        std::vector<std::pair<double, int32_t>> candidates;
+        for (size_t index = 0; index < tracks.size(); ++index)
+            if (freezable[index] && loads[index] > 0.0 &&
+                loads[index] >= cpu_budget_ * kMinimumShareOfBudget &&
+                !isHeld(references[index], now))
+                candidates.emplace_back(loads[index], static_cast<int32_t>(index));
+        std::ranges::sort(candidates, std::greater{});
+        // A frozen track still costs a little to play back; treat it as free
+        // here and let the next window correct the estimate.
+        double projected = total_load_;
+        for (const auto& [load, trackIndex] : candidates) {
+            if (projected <= cpu_budget_)
+                break;
+            freezeCandidates.push_back(trackIndex);
+            projected -= load;
+        }
+    }
+
+    // FrozenTrackManager may call back into the engine; never hold mutex_ here.
+    for (const auto trackIndex : freezeCandidates) {
+        if (!frozenTracks.setFreezePolicyForTrack(
+                trackIndex, FrozenTrackManager::FreezePolicy::On))
+            continue;
+        std::lock_guard lock(mutex_);
+        auto_frozen_track_references_.insert(
+            references[static_cast<size_t>(trackIndex)]);
+    }
+}
+
+void AutoFreezeScheduler::trackBecameDirty(int32_t trackIndex) {
+    holdTrack(trackIndex, false, -1);
+}
+
+void AutoFreezeScheduler::pluginUIOpened(int32_t instanceId) {
+    holdTrack(engine_.findTrackIndexForInstance(instanceId), true, instanceId);
+}
+
+void AutoFreezeScheduler::pluginUIClosed(int32_t instanceId) {
+    std::lock_guard lock(mutex_);
+    const auto it = open_ui_track_by_instance_.find(instanceId);
+    if (it == open_ui_track_by_instance_.end())
+        return;
+    // The edit hold starts when the editor goes away.
+    last_edit_by_track_reference_[it->second] = std::chrono::steady_clock::now();
+    open_ui_track_by_instance_.erase(it);
+}
+
+void AutoFreezeScheduler::beforeTrackProcess(const TrackAudioProcessingEvent& event) noexcept {
+    if (event.track_index < 0 ||
+        static_cast<size_t>(event.track_index) >= kMaxMeasuredTracks)
+        return;
+    timing_slots_[static_cast<size_t>(event.track_index)].started_ns = steadyNowInNanoseconds();
+}
+
+void AutoFreezeScheduler::afterTrackProcess(const TrackAudioProcessingEvent& event) noexcept {
+    if (event.track_index < 0 ||
+        static_cast<size_t>(event.track_index) >= kMaxMeasuredTracks ||
+        event.frame_count <= 0)
+        return;
+    auto& slot = timing_slots_[static_cast<size_t>(event.track_index)];
+    const auto elapsed = steadyNowInNanoseconds() - slot.started_ns;
+    if (elapsed > 0)
+        slot.busy_ns.fetch_add(static_cast<uint64_t>(elapsed), std::memory_order_relaxed);
+    slot.frames.fetch_add(static_cast<uint64_t>(event.frame_count), std::memory_order_relaxed);
+}
+
+bool AutoFreezeScheduler::isHeld(
+    const std::string& trackReferenceId,
+    std::chrono::steady_clock::time_point now) const {
+    for (const auto& [instanceId, reference] : open_ui_track_by_instance_)
+        if (reference == trackReferenceId)
+            return true;
+    const auto edited = last_edit_by_track_reference_.find(trackReferenceId);
+    return edited != last_edit_by_track_reference_.end() &&
+        now - edited->second < edit_hold_duration_;
+}
+
+void AutoFreezeScheduler::holdTrack(int32_t trackIndex, bool openedUI, int32_t instanceId) {
+    const auto tracks = timeline_.tracks();
+    if (trackIndex < 0 || static_cast<size_t>(trackIndex) >= tracks.size() ||
+        !tracks[static_cast<size_t>(trackIndex)])
+        return;
+    const auto reference = tracks[static_cast<size_t>(trackIndex)]->referenceId();
+    {
+        std::lock_guard lock(mutex_);
+        if (openedUI)
+            open_ui_track_by_instance_[instanceId] = reference;
+        else
+            last_edit_by_track_reference_[reference] = std::chrono::steady_clock::now();
+    }
+    unfreezeIfAutoFrozen(trackIndex, reference);
+}
+
+void AutoFreezeScheduler::unfreezeIfAutoFrozen(
+    int32_t trackIndex,
+    const std::string& reference) {
+    {
+        std::lock_guard lock(mutex_);
+        if (!auto_frozen_track_references_.erase(reference))
+            return;
+    }
+    engine_.frozenTrackManager().setFreezePolicyForTrack(
+        trackIndex, FrozenTrackManager::FreezePolicy::Off);
+}
+
+void AutoFreezeScheduler::startTimer() {
+    stopTimer();
+    {
+        std::lock_guard lock(timer_mutex_);
+        timer_stopping_ = false;
+    }
+    const std::weak_ptr<AsyncLifetime> weakLifetime(async_lifetime_);
+    timer_thread_ = std::thread([this, weakLifetime] {
+        std::unique_lock lock(timer_mutex_);
+        while (!timer_wake_.wait_for(lock, kEvaluationInterval, [this] { return timer_stopping_; })) {
+            // Freezing is a main-thread operation like any other policy change.
+            remidy::EventLoop::enqueueTaskOnMainThread([weakLifetime] {
+                const auto lifetime = weakLifetime.lock();
+                auto* owner = lifetime
+                    ? lifetime->owner.load(std::memory_order_acquire)
+                    : nullptr;
+                if (owner && owner->enabled())
+                    owner->evaluate();
+            });
+        }
+    });
+}
+
+void AutoFreezeScheduler::stopTimer() {
+    {
+        std::lock_guard lock(timer_mutex_);
+        timer_stopping_ = true;
+    }
+    timer_wake_.notify_all();
+    if (timer_thread_.joinable())
+        timer_thread_.join();
+}
+
+} // namespace uapmd
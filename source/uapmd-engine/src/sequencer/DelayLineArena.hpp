@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace uapmd {
+
+// Latency compensation delay lines carved out of one allocation. Every line
+// is a set of channel rings of the same power-of-two length that share a
+// write position, so wrapping is a mask and a block moves in at most two
+// contiguous spans per ring. Samples are doubles, which carry either sample
+// format of the track contexts losslessly.
+//
+// The layout is fixed at construction. Build it off the audio thread; the
+// audio thread only reads and writes samples.
+class DelayLineArena {
+public:
+    struct LineSpec {
+        uint32_t channels{0};
+        // Longest delay the line must hold at the largest block size.
+        size_t maxDelayFrames{0};
+        size_t maxBlockFrames{0};
+
+        size_t ringFrames() const noexcept { return std::bit_ceil(std::max<size_t>(maxDelayFrames + maxBlockFrames, 1)); }
+        // Specs that get the same rings are interchangeable.
+        bool operator==(const LineSpec& other) const noexcept {
+            return channels == other.channels && ringFrames() == other.ringFrames();
+        }
+    };
+
+    class Line {
+        friend class DelayLineArena;
+        double* samples_{};
+        uint32_t channels_{0};
+        size_t mask_{0};
+        size_t write_position_{0};
+
+        template <typename From, typename To>
+        static void copySamples(const From* from, To* to, size_t count) noexcept {
+            if constexpr (std::is_same_v<From, To>)
+                std::memcpy(to, from, count * sizeof(To));
+            else
+                for (size_t i = 0; i < count; ++i)
+                    to[i] = static_cast<To>(from[i]);
+        }
+
+    public:
+        uint32_t channelCount() const noexcept { return channels_; }
+        size_t frames() const noexcept { return channels_ > 0 ? mask_ + 1 : 0; }
+        // A block of `blockFrames` is written before it is read, so the
+        // delay can take up the rest of the ring.
+        size_t maxDelayFrames(size_t blockFrames) const noexcept {
+            return frames() > blockFrames ? frames() - blockFrames : 0;
+        }
+        double* channel(uint32_t ch) noexcept { return samples_ + static_cast<size_t>(ch) * frames(); }
+
+        // Passes the `count` frames that start `delay` frames behind the
+        // write position, in at most two spans: fn(span, offsetInBlock, length).
+        template <typename Fn>
+        void forEachDelayedSpan(uint32_t ch, size_t delay, size_t count, Fn&& fn) noexcept {
+            const auto* ring = channel(ch);
+            const size_t start = (write_position_ - delay) & mask_;
+            const size_t first = std::min(count, frames() - start);
+            fn(ring + start, size_t{0}, first);
+            if (first < count)
+                fn(ring, first, count - first);
+        }
+
+        template <typename SampleType>
+        void write(uint32_t ch, const SampleType* input, size_t count) noexcept {
+            auto* ring = channel(ch);
+            const size_t start = write_position_ & mask_;
+            const size_t first = std::min(count, frames() - start);
+            copySamples(input, ring + start, first);
+            if (first < count)
+                copySamples(input + first, ring, count - first);
+        }
+
+        template <typename SampleType>
+        void read(uint32_t ch, size_t delay, SampleType* output, size_t count) noexcept {
+            forEachDelayedSpan(ch, delay, count, [output](const double* span, size_t offset, size_t length) {
+                copySamples(span, output + offset, length);
+            });
+        }
+
+        void advance(size_t count) noexcept { write_position_ = (write_position_ + count) & mask_; }
+
+        void clear() noexcept {
+            std::fill_n(samples_, static_cast<size_t>(channels_) * frames(), 0.0);
+            write_position_ = 0;
+        }
+    };
+
+    DelayLineArena() = default;
+
+    explicit DelayLineArena(const std::vector<LineSpec>& specs) {
+        size_t total = 0;
+        lines_.resize(specs.size());
+        for (size_t i = 0; i < specs.size(); ++i) {
+            if (specs[i].channels == 0)
+                continue;
+            const auto frames = specs[i].ringFrames();
+            lines_[i].channels_ = specs[i].channels;
+            lines_[i].mask_ = frames - 1;
+            total += frames * specs[i].channels;
+        }
+        samples_.assign(total, 0.0);
+        size_t offset = 0;
+        for (auto& line : lines_) {
+            line.samples_ = samples_.data() + offset;
+            offset += static_cast<size_t>(line.channels_) * line.frames();
+        }
+    }
+
+    DelayLineArena(const DelayLineArena&) = delete;
+    DelayLineArena& operator=(const DelayLineArena&) = delete;
+
+    size_t lineCount() const noexcept { return lines_.size(); }
+    Line& line(size_t index) noexcept { return lines_[index]; }
+    size_t sizeInBytes() const noexcept { return samples_.size() * sizeof(double); }
+
+    void clear() noexcept {
+        std::fill(samples_.begin(), samples_.end(), 0.0);
+        for (auto& line : lines_)
+            line.write_position_ = 0;
+    }
+
+private:
+    std::vector<double> samples_;
+    std::vector<Line> lines_;
+};
+
+}
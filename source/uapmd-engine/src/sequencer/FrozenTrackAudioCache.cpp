@@ -0,0 +1,574 @@
+#include "FrozenTrackAudioCache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <format>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace uapmd {
+namespace {
+
+constexpr std::array<char, 8> kMagic{'U', 'A', 'P', 'M', 'D', 'F', 'Z', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kDefaultMemoryBudgetInBytes = 64ULL * 1024ULL * 1024ULL;
+constexpr size_t kPageSize = 4096;
+
+// The header, block scales and samples are written and read in native byte
+// order, and the format is little-endian.
+static_assert(std::endian::native == std::endian::little,
+              "Frozen track cache files are written in native byte order");
+
+// At the start of the header page. Bus channel counts follow immediately, up
+// to the end of the page.
+struct FileHeader {
+    std::array<char, 8> magic{kMagic};
+    uint32_t version{kVersion};
+    uint32_t sample_format{0};
+    int32_t sample_rate{0};
+    uint32_t channel_count{0};
+    int64_t start_sample{0};
+    int64_t frame_count{0};
+    uint32_t frames_per_block{FrozenTrackCacheFile::kFramesPerBlock};
+    uint32_t bus_count{0};
+};
+static_assert(sizeof(FileHeader) == 48);
+constexpr size_t kMaximumBusCount =
+    (FrozenTrackCacheFile::kHeaderSize - sizeof(FileHeader)) / sizeof(uint32_t);
+
+size_t bytesPerSample(FrozenTrackManager::CacheSampleFormat format) {
+    switch (format) {
+        case FrozenTrackManager::CacheSampleFormat::PCM16: return 2;
+        case FrozenTrackManager::CacheSampleFormat::PCM24: return 3;
+        case FrozenTrackManager::CacheSampleFormat::Float32:
+        default: return 4;
+    }
+}
+
+size_t encodedBlockSize(uint32_t channelCount, size_t sampleBytes) {
+    return channelCount * sizeof(float) +
+        static_cast<size_t>(FrozenTrackCacheFile::kFramesPerBlock) * channelCount * sampleBytes;
+}
+
+} // namespace
+
+// ── FrozenTrackCacheFile ──────────────────────────────────────────────────────
+
+FrozenTrackCacheFile::~FrozenTrackCacheFile() {
+#if defined(_WIN32)
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (mapping_handle_)
+        CloseHandle(static_cast<HANDLE>(mapping_handle_));
+    if (file_handle_ && file_handle_ != INVALID_HANDLE_VALUE)
+        CloseHandle(static_cast<HANDLE>(file_handle_));
+#elif !defined(__EMSCRIPTEN__)
+    if (data_)
+        munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+}
+
+std::shared_ptr<const FrozenTrackCacheFile> FrozenTrackCacheFile::open(
+    const std::filesystem::path& path,
+    std::string& error) {
+    std::shared_ptr<FrozenTrackCacheFile> file(new FrozenTrackCacheFile());
+    file->path_ = path;
+
+#if defined(_WIN32)
+    auto handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        error = "Failed to open frozen track cache: " + path.string();
+        return nullptr;
+    }
+    file->file_handle_ = handle;
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart <= 0) {
+        error = "Failed to query frozen track cache size: " + path.string();
+        return nullptr;
+    }
+    file->size_ = static_cast<size_t>(size.QuadPart);
+    file->mapping_handle_ = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!file->mapping_handle_) {
+        error = "Failed to map frozen track cache: " + path.string();
+        return nullptr;
+    }
+    file->data_ = static_cast<const uint8_t*>(
+        MapViewOfFile(static_cast<HANDLE>(file->mapping_handle_), FILE_MAP_READ, 0, 0, 0));
+#elif defined(__EMSCRIPTEN__)
+    // The Emscripten filesystem is memory-backed already; mapping buys nothing.
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "Failed to open frozen track cache: " + path.string();
+        return nullptr;
+    }
+    file->contents_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    file->size_ = file->contents_.size();
+    file->data_ = file->contents_.data();
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "Failed to open frozen track cache: " + path.string();
+        return nullptr;
+    }
+    struct stat status{};
+    if (fstat(fd, &status) != 0 || status.st_size <= 0) {
+        ::close(fd);
+        error = "Failed to query frozen track cache size: " + path.string();
+        return nullptr;
+    }
+    file->size_ = static_cast<size_t>(status.st_size);
+    void* mapped = mmap(nullptr, file->size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        error = "Failed to map frozen track cache: " + path.string();
+        return nullptr;
+    }
+    file->data_ = static_cast<const uint8_t*>(mapped);
+#endif
+    if (!file->data_ || file->size_ < kHeaderSize) {
+        error = "Frozen track cache is truncated: " + path.string();
+        return nullptr;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, file->data_, sizeof(header));
+    if (header.magic != kMagic || header.version != kVersion ||
+        header.frames_per_block != kFramesPerBlock ||
+        header.sample_format > static_cast<uint32_t>(SampleFormat::PCM16) ||
+        header.channel_count == 0 || header.frame_count < 0 ||
+        header.bus_count > kMaximumBusCount) {
+        error = "Unsupported frozen track cache: " + path.string();
+        return nullptr;
+    }
+    file->sample_format_ = static_cast<SampleFormat>(header.sample_format);
+    file->sample_rate_ = header.sample_rate;
+    file->start_sample_ = header.start_sample;
+    file->frame_count_ = header.frame_count;
+    file->channel_count_ = header.channel_count;
+    file->bus_channel_counts_.resize(header.bus_count);
+    if (header.bus_count > 0)
+        std::memcpy(file->bus_channel_counts_.data(), file->data_ + sizeof(header),
+                    header.bus_count * sizeof(uint32_t));
+    file->bytes_per_sample_ = bytesPerSample(file->sample_format_);
+    file->block_size_ = encodedBlockSize(file->channel_count_, file->bytes_per_sample_);
+
+    const auto blockCount = static_cast<size_t>(
+        (header.frame_count + kFramesPerBlock - 1) / kFramesPerBlock);
+    if (file->size_ < kHeaderSize + blockCount * file->block_size_) {
+        error = "Frozen track cache is truncated: " + path.string();
+        return nullptr;
+    }
+    return file;
+}
+
+void FrozenTrackCacheFile::read(
+    uint32_t channel,
+    int64_t firstFrame,
+    float* destination,
+    int32_t frames) const noexcept {
+    if (!destination || frames <= 0)
+        return;
+    if (channel >= channel_count_) {
+        std::memset(destination, 0, static_cast<size_t>(frames) * sizeof(float));
+        return;
+    }
+
+    int32_t written = 0;
+    while (written < frames) {
+        const int64_t frame = firstFrame + written;
+        if (frame < 0 || frame >= frame_count_) {
+            // Silence up to the start of the render, or for the rest of the block.
+            const int32_t silent = frame < 0
+                ? static_cast<int32_t>(std::min<int64_t>(-frame, frames - written))
+                : frames - written;
+            std::memset(destination + written, 0, static_cast<size_t>(silent) * sizeof(float));
+            written += silent;
+            continue;
+        }
+
+        const auto blockIndex = static_cast<size_t>(frame / kFramesPerBlock);
+        const auto frameInBlock = static_cast<uint32_t>(frame % kFramesPerBlock);
+        const int32_t count = static_cast<int32_t>(std::min<int64_t>(
+            {static_cast<int64_t>(kFramesPerBlock - frameInBlock),
+             frame_count_ - frame,
+             static_cast<int64_t>(frames - written)}));
+
+        const uint8_t* block = data_ + kHeaderSize + blockIndex * block_size_;
+        float scale;
+        std::memcpy(&scale, block + channel * sizeof(float), sizeof(float));
+        const size_t frameStride = channel_count_ * bytes_per_sample_;
+        const uint8_t* sample = block + channel_count_ * sizeof(float) +
+            frameInBlock * frameStride + channel * bytes_per_sample_;
+        float* out = destination + written;
+
+        switch (sample_format_) {
+            case SampleFormat::PCM16:
+                for (int32_t i = 0; i < count; ++i, sample += frameStride) {
+                    int16_t value;
+                    std::memcpy(&value, sample, sizeof(value));
+                    out[i] = static_cast<float>(value) * (scale / 32767.0f);
+                }
+                break;
+            case SampleFormat::PCM24:
+                for (int32_t i = 0; i < count; ++i, sample += frameStride) {
+                    const int32_t value = static_cast<int32_t>(
+                        (static_cast<uint32_t>(sample[0]) << 8) |
+                        (static_cast<uint32_t>(sample[1]) << 16) |
+                        (static_cast<uint32_t>(sample[2]) << 24)) >> 8;
+                    out[i] = static_cast<float>(value) * (scale / 8388607.0f);
+                }
+                break;
+            case SampleFormat::Float32:
+            default:
+                for (int32_t i = 0; i < count; ++i, sample += frameStride)
+                    std::memcpy(out + i, sample, sizeof(float));
+                break;
+        }
+        written += count;
+    }
+}
+
+bool FrozenTrackCacheFile::byteRangeForFrames(
+    int64_t firstFrame,
+    int64_t frames,
+    bool wholePagesOnly,
+    size_t& offset,
+    size_t& length) const noexcept {
+    firstFrame = std::max<int64_t>(0, firstFrame);
+    const int64_t lastFrame = std::min(frame_count_, firstFrame + std::max<int64_t>(0, frames));
+    if (lastFrame <= firstFrame)
+        return false;
+    const auto firstBlock = static_cast<size_t>(firstFrame / kFramesPerBlock);
+    const auto endBlock = static_cast<size_t>((lastFrame + kFramesPerBlock - 1) / kFramesPerBlock);
+    // Blocks start at kHeaderSize, a page boundary, so neither rounding
+    // reaches into the header page.
+    const size_t begin = kHeaderSize + firstBlock * block_size_;
+    size_t end = std::min(size_, kHeaderSize + endBlock * block_size_);
+    if (wholePagesOnly) {
+        // Inwards: a page shared with a block outside the range stays.
+        offset = (begin + kPageSize - 1) / kPageSize * kPageSize;
+        end = end / kPageSize * kPageSize;
+    } else {
+        // Outwards: the first page holds the start of the first block.
+        offset = begin / kPageSize * kPageSize;
+    }
+    if (end <= offset)
+        return false;
+    length = end - offset;
+    return true;
+}
+
+void FrozenTrackCacheFile::prefetch(int64_t firstFrame, int64_t frames) const noexcept {
+    size_t offset = 0;
+    size_t length = 0;
+    if (!byteRangeForFrames(firstFrame, frames, false, offset, length))
+        return;
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+    madvise(const_cast<uint8_t*>(data_) + offset, length, MADV_WILLNEED);
+#endif
+    // Touch each page as well: WILLNEED only starts readahead, and Windows has no
+    // equivalent hint for a plain view.
+    volatile uint8_t sink = 0;
+    for (size_t position = offset; position < offset + length; position += kPageSize)
+        sink = sink + data_[position];
+}
+
+void FrozenTrackCacheFile::evict(int64_t firstFrame, int64_t frames) const noexcept {
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+    size_t offset = 0;
+    size_t length = 0;
+    if (!byteRangeForFrames(firstFrame, frames, true, offset, length))
+        return;
+    // The mapping is read-only and file-backed, so dropping pages never loses data.
+    madvise(const_cast<uint8_t*>(data_) + offset, length, MADV_DONTNEED);
+#else
+    (void) firstFrame;
+    (void) frames;
+#endif
+}
+
+// ── FrozenTrackCacheFileWriter ────────────────────────────────────────────────
+
+FrozenTrackCacheFileWriter::~FrozenTrackCacheFileWriter() {
+    if (!finished_)
+        abandon();
+}
+
+bool FrozenTrackCacheFileWriter::open(
+    const std::filesystem::path& path,
+    SampleFormat format,
+    int32_t sampleRate,
+    int64_t startSample,
+    int64_t frameCount,
+    std::string& error) {
+    path_ = path;
+    partial_path_ = path;
+    partial_path_ += ".part";
+    format_ = format;
+    sample_rate_ = sampleRate;
+    start_sample_ = startSample;
+    frame_count_ = frameCount;
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    if (ec) {
+        error = std::format("Failed to create frozen track cache directory {}: {}",
+                            path.parent_path().string(), ec.message());
+        return false;
+    }
+    out_.open(partial_path_, std::ios::binary | std::ios::trunc);
+    if (!out_) {
+        error = "Failed to create frozen track cache: " + partial_path_.string();
+        return false;
+    }
+    // Reserve the header page; finish() fills it in once the layout is known.
+    const std::vector<char> header(FrozenTrackCacheFile::kHeaderSize, 0);
+    out_.write(header.data(), static_cast<std::streamsize>(header.size()));
+    if (!out_) {
+        error = "Failed to write frozen track cache: " + partial_path_.string();
+        return false;
+    }
+    return true;
+}
+
+bool FrozenTrackCacheFileWriter::append(
+    const float* const* channels,
+    uint32_t channelCount,
+    int32_t frames,
+    std::string& error) {
+    if (channel_count_ == 0) {
+        if (channelCount == 0) {
+            error = "Frozen track render has no channels.";
+            return false;
+        }
+        channel_count_ = channelCount;
+        staging_.assign(static_cast<size_t>(FrozenTrackCacheFile::kFramesPerBlock) * channelCount, 0.0f);
+        encoded_.resize(encodedBlockSize(channelCount, bytesPerSample(format_)));
+    } else if (channelCount != channel_count_) {
+        error = "Frozen track render changed its channel count.";
+        return false;
+    }
+
+    int32_t consumed = 0;
+    while (consumed < frames) {
+        const auto count = std::min<int32_t>(
+            frames - consumed,
+            static_cast<int32_t>(FrozenTrackCacheFile::kFramesPerBlock - staged_frames_));
+        for (uint32_t channel = 0; channel < channel_count_; ++channel) {
+            auto* staged = staging_.data() + static_cast<size_t>(channel) * FrozenTrackCacheFile::kFramesPerBlock;
+            std::copy_n(channels[channel] + consumed, count, staged + staged_frames_);
+        }
+        staged_frames_ += static_cast<uint32_t>(count);
+        consumed += count;
+        if (staged_frames_ == FrozenTrackCacheFile::kFramesPerBlock && !flushBlock(error))
+            return false;
+    }
+    return true;
+}
+
+bool FrozenTrackCacheFileWriter::flushBlock(std::string& error) {
+    if (staged_frames_ == 0)
+        return true;
+    // Zero-pad a partial final block so every block has the same size.
+    for (uint32_t channel = 0; channel < channel_count_; ++channel) {
+        auto* staged = staging_.data() + static_cast<size_t>(channel) * FrozenTrackCacheFile::kFramesPerBlock;
+        std::fill(staged + staged_frames_, staged + FrozenTrackCacheFile::kFramesPerBlock, 0.0f);
+    }
+
+    const size_t sampleBytes = bytesPerSample(format_);
+    const size_t frameStride = channel_count_ * sampleBytes;
+    uint8_t* samples = encoded_.data() + channel_count_ * sizeof(float);
+    for (uint32_t channel = 0; channel < channel_count_; ++channel) {
+        const auto* staged = staging_.data() + static_cast<size_t>(channel) * FrozenTrackCacheFile::kFramesPerBlock;
+        float scale = 1.0f;
+        if (format_ != SampleFormat::Float32) {
+            float peak = 0.0f;
+            for (uint32_t frame = 0; frame < FrozenTrackCacheFile::kFramesPerBlock; ++frame)
+                if (std::isfinite(staged[frame]))
+                    peak = std::max(peak, std::abs(staged[frame]));
+            scale = peak > 0.0f ? peak : 1.0f;
+        }
+        std::memcpy(encoded_.data() + channel * sizeof(float), &scale, sizeof(float));
+
+        uint8_t* sample = samples + channel * sampleBytes;
+        for (uint32_t frame = 0; frame < FrozenTrackCacheFile::kFramesPerBlock; ++frame, sample += frameStride) {
+            const float value = std::isfinite(staged[frame]) ? staged[frame] : 0.0f;
+            switch (format_) {
+                case SampleFormat::PCM16: {
+                    const auto quantized = static_cast<int16_t>(
+                        std::lround(std::clamp(value / scale, -1.0f, 1.0f) * 32767.0f));
+                    std::memcpy(sample, &quantized, sizeof(quantized));
+                    break;
+                }
+                case SampleFormat::PCM24: {
+                    const auto quantized = static_cast<int32_t>(
+                        std::lround(std::clamp(value / scale, -1.0f, 1.0f) * 8388607.0f));
+                    sample[0] = static_cast<uint8_t>(quantized & 0xFF);
+                    sample[1] = static_cast<uint8_t>((quantized >> 8) & 0xFF);
+                    sample[2] = static_cast<uint8_t>((quantized >> 16) & 0xFF);
+                    break;
+                }
+                case SampleFormat::Float32:
+                default:
+                    std::memcpy(sample, &value, sizeof(value));
+                    break;
+            }
+        }
+    }
+
+    out_.write(reinterpret_cast<const char*>(encoded_.data()), static_cast<std::streamsize>(encoded_.size()));
+    if (!out_) {
+        error = "Failed to write frozen track cache: " + partial_path_.string();
+        return false;
+    }
+    written_frames_ += staged_frames_;
+    staged_frames_ = 0;
+    return true;
+}
+
+bool FrozenTrackCacheFileWriter::finish(
+    const std::vector<uint32_t>& busChannelCounts,
+    std::string& error) {
+    if (!flushBlock(error))
+        return false;
+    if (written_frames_ != frame_count_ || channel_count_ == 0) {
+        error = "Frozen track render is incomplete.";
+        return false;
+    }
+    if (busChannelCounts.size() > kMaximumBusCount) {
+        error = "Frozen track render has too many output buses.";
+        return false;
+    }
+
+    FileHeader header;
+    header.sample_format = static_cast<uint32_t>(format_);
+    header.sample_rate = sample_rate_;
+    header.channel_count = channel_count_;
+    header.start_sample = start_sample_;
+    header.frame_count = frame_count_;
+    header.bus_count = static_cast<uint32_t>(busChannelCounts.size());
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!busChannelCounts.empty())
+        out_.write(reinterpret_cast<const char*>(busChannelCounts.data()),
+                   static_cast<std::streamsize>(busChannelCounts.size() * sizeof(uint32_t)));
+    out_.close();
+    if (!out_) {
+        error = "Failed to write frozen track cache: " + partial_path_.string();
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(partial_path_, path_, ec);
+    if (ec) {
+        error = std::format("Failed to finalize frozen track cache {}: {}", path_.string(), ec.message());
+        return false;
+    }
+    finished_ = true;
+    return true;
+}
+
+void FrozenTrackCacheFileWriter::abandon() {
+    if (out_.is_open())
+        out_.close();
+    if (!partial_path_.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(partial_path_, ec);
+    }
+}
+
+// ── FrozenTrackCachePrefetcher ────────────────────────────────────────────────
+
+FrozenTrackCachePrefetcher::FrozenTrackCachePrefetcher(PositionProvider position)
+    : position_(std::move(position))
+    , memory_budget_in_bytes_(kDefaultMemoryBudgetInBytes) {
+    thread_ = std::thread([this] { run(); });
+}
+
+FrozenTrackCachePrefetcher::~FrozenTrackCachePrefetcher() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void FrozenTrackCachePrefetcher::setFiles(
+    std::vector<std::shared_ptr<const FrozenTrackCacheFile>> files) {
+    {
+        std::lock_guard lock(mutex_);
+        files_ = std::move(files);
+    }
+    wake_.notify_one();
+}
+
+void FrozenTrackCachePrefetcher::setMemoryBudgetInBytes(uint64_t bytes) {
+    memory_budget_in_bytes_.store(bytes, std::memory_order_relaxed);
+    wake_.notify_one();
+}
+
+uint64_t FrozenTrackCachePrefetcher::memoryBudgetInBytes() const {
+    return memory_budget_in_bytes_.load(std::memory_order_relaxed);
+}
+
+void FrozenTrackCachePrefetcher::setPlaybackActive(bool active) {
+    {
+        std::lock_guard lock(mutex_);
+        playback_active_ = active;
+    }
+    wake_.notify_one();
+}
+
+void FrozenTrackCachePrefetcher::run() {
+    // Also runs once while stopped so that a Play right after a seek does not
+    // start with cold pages.
+    constexpr auto kPlaybackInterval = std::chrono::milliseconds(25);
+    constexpr auto kIdleInterval = std::chrono::milliseconds(250);
+    std::unique_lock lock(mutex_);
+    while (!stopping_) {
+        lock.unlock();
+        prefetchOnce(position_ ? position_() : 0);
+        lock.lock();
+        wake_.wait_for(lock, playback_active_ ? kPlaybackInterval : kIdleInterval);
+    }
+}
+
+void FrozenTrackCachePrefetcher::prefetchOnce(int64_t position) {
+    std::vector<std::shared_ptr<const FrozenTrackCacheFile>> files;
+    {
+        std::lock_guard lock(mutex_);
+        files = files_;
+    }
+    if (files.empty())
+        return;
+
+    const auto share = memory_budget_in_bytes_.load(std::memory_order_relaxed) / files.size();
+    for (const auto& file : files) {
+        const auto frameBytes = std::max<size_t>(1, file->blockSizeInBytes() / FrozenTrackCacheFile::kFramesPerBlock);
+        const auto windowFrames = std::max<int64_t>(
+            FrozenTrackCacheFile::kFramesPerBlock, static_cast<int64_t>(share / frameBytes));
+        const auto frame = position - file->startSample();
+        // Keep a quarter of the window behind the playhead for short rewinds.
+        const auto keptBehind = windowFrames / 4;
+        file->prefetch(frame, windowFrames - keptBehind);
+        if (frame - keptBehind > 0)
+            file->evict(0, frame - keptBehind);
+        file->evict(frame + windowFrames, file->frameCount());
+    }
+}
+
+} // namespace uapmd
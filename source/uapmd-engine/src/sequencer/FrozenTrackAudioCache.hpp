@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "uapmd-engine/uapmd-engine.hpp"
+
+namespace uapmd {
+
+// On-disk frozen track render ("*.ufz").
+//
+// A 4 KiB header page is followed by fixed-size blocks of kFramesPerBlock
+// interleaved frames. Each block starts with one float scale per channel; the
+// samples that follow are stored relative to that scale, so the integer formats
+// keep full resolution for track outputs that exceed 0 dBFS before the master.
+// The last block is zero-padded to the full block size.
+class FrozenTrackCacheFile {
+public:
+    using SampleFormat = FrozenTrackManager::CacheSampleFormat;
+
+    static constexpr uint32_t kFramesPerBlock = 1024;
+    static constexpr size_t kHeaderSize = 4096;
+
+    ~FrozenTrackCacheFile();
+    FrozenTrackCacheFile(const FrozenTrackCacheFile&) = delete;
+    FrozenTrackCacheFile& operator=(const FrozenTrackCacheFile&) = delete;
+
+    // Maps a finished cache file read-only. Returns nullptr and sets error if the
+    // file is missing, truncated or of an unknown version.
+    static std::shared_ptr<const FrozenTrackCacheFile> open(
+        const std::filesystem::path& path,
+        std::string& error);
+
+    const std::filesystem::path& path() const { return path_; }
+    SampleFormat sampleFormat() const { return sample_format_; }
+    int32_t sampleRate() const { return sample_rate_; }
+    int64_t startSample() const { return start_sample_; }
+    int64_t frameCount() const { return frame_count_; }
+    uint32_t channelCount() const { return channel_count_; }
+    const std::vector<uint32_t>& busChannelCounts() const { return bus_channel_counts_; }
+    size_t blockSizeInBytes() const { return block_size_; }
+
+    // Audio-thread safe: decodes straight from the mapping without allocating or
+    // locking. Frames outside the render are written as silence.
+    void read(uint32_t channel, int64_t firstFrame, float* destination, int32_t frames) const noexcept;
+
+    // Non-realtime residency hints for the frame range (relative to startSample()).
+    void prefetch(int64_t firstFrame, int64_t frames) const noexcept;
+    void evict(int64_t firstFrame, int64_t frames) const noexcept;
+
+private:
+    FrozenTrackCacheFile() = default;
+    // The bytes of the blocks holding the frames, widened to page boundaries,
+    // or narrowed to the pages that hold nothing else with wholePagesOnly.
+    bool byteRangeForFrames(int64_t firstFrame, int64_t frames, bool wholePagesOnly,
+                            size_t& offset, size_t& length) const noexcept;
+
+    std::filesystem::path path_;
+    SampleFormat sample_format_{SampleFormat::Float32};
+    int32_t sample_rate_{0};
+    int64_t start_sample_{0};
+    int64_t frame_count_{0};
+    uint32_t channel_count_{0};
+    std::vector<uint32_t> bus_channel_counts_;
+    size_t bytes_per_sample_{4};
+    size_t block_size_{0};
+
+    const uint8_t* data_{nullptr};
+    size_t size_{0};
+#if defined(_WIN32)
+    void* file_handle_{nullptr};
+    void* mapping_handle_{nullptr};
+#elif defined(__EMSCRIPTEN__)
+    std::vector<uint8_t> contents_;
+#endif
+};
+
+// Streams rendered blocks into a new cache file. Data is written to
+// "<path>.part" and only renamed into place by finish(), so a mapped file with
+// the same name is never modified underneath a reader.
+class FrozenTrackCacheFileWriter {
+public:
+    using SampleFormat = FrozenTrackManager::CacheSampleFormat;
+
+    ~FrozenTrackCacheFileWriter();
+
+    bool open(const std::filesystem::path& path,
+              SampleFormat format,
+              int32_t sampleRate,
+              int64_t startSample,
+              int64_t frameCount,
+              std::string& error);
+    bool append(const float* const* channels, uint32_t channelCount, int32_t frames, std::string& error);
+    bool finish(const std::vector<uint32_t>& busChannelCounts, std::string& error);
+    // Removes the partial file. Also done on destruction unless finish() succeeded.
+    void abandon();
+
+private:
+    bool flushBlock(std::string& error);
+
+    std::filesystem::path path_;
+    std::filesystem::path partial_path_;
+    std::ofstream out_;
+    SampleFormat format_{SampleFormat::Float32};
+    int32_t sample_rate_{0};
+    int64_t start_sample_{0};
+    int64_t frame_count_{0};
+    int64_t written_frames_{0};
+    uint32_t channel_count_{0};
+    std::vector<float> staging_;
+    uint32_t staged_frames_{0};
+    std::vector<uint8_t> encoded_;
+    bool finished_{false};
+};
+
+// Keeps the region just ahead of the playhead of every frozen track resident and
+// releases what is far behind it, sharing one memory budget across all tracks.
+class FrozenTrackCachePrefetcher {
+public:
+    using PositionProvider = std::function<int64_t()>;
+
+    explicit FrozenTrackCachePrefetcher(PositionProvider position);
+    ~FrozenTrackCachePrefetcher();
+
+    void setFiles(std::vector<std::shared_ptr<const FrozenTrackCacheFile>> files);
+    void setMemoryBudgetInBytes(uint64_t bytes);
+    uint64_t memoryBudgetInBytes() const;
+    void setPlaybackActive(bool active);
+
+private:
+    void run();
+    void prefetchOnce(int64_t position);
+
+    PositionProvider position_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<std::shared_ptr<const FrozenTrackCacheFile>> files_;
+    std::atomic<uint64_t> memory_budget_in_bytes_;
+    bool playback_active_{false};
+    bool stopping_{false};
+    std::thread thread_;
+};
+
+} // namespace uapmd
@@ -1,21 +1,30 @@
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstring>
+#include <format>
 #include <functional>
 #include <limits>
 #include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include <remidy/remidy.hpp>
 #include <uapmd-engine/uapmd-engine.hpp>
+#include "FrozenTrackAudioCache.hpp"
 
 namespace uapmd {
 namespace {
 
-constexpr std::string_view kManifestHeader = "uapmd-track-freezing-v2";
+// v3 adds "render.<track>=<path>" entries naming the saved render of a track.
+constexpr std::string_view kManifestHeader = "uapmd-track-freezing-v3";
+constexpr std::string_view kPreviousManifestHeader = "uapmd-track-freezing-v2";
 constexpr std::string_view kLegacyManifestHeader = "uapmd-track-freezing-v1";
+constexpr std::string_view kRenderDirectory = "frozen";
+constexpr std::string_view kRenderFileExtension = ".ufz";
 constexpr uint32_t kRenderBufferSize = 1024;
-constexpr uint64_t kMaximumFrozenTrackBytes = 512ULL * 1024ULL * 1024ULL;
 
 std::string_view trim(std::string_view value) {
     while (!value.empty() &&
@@ -29,6 +38,29 @@ std::string_view trim(std::string_view value) {
     return value;
 }
 
+// Track reference ids are generated by the engine, but they end up in file
+// names, so anything outside a conservative character set is replaced.
+std::string cacheFileStem(std::string_view trackReferenceId) {
+    std::string stem;
+    stem.reserve(trackReferenceId.size());
+    for (const char c : trackReferenceId)
+        stem.push_back(
+            (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+            (c >= '0' && c <= '9') || c == '-' || c == '_'
+            ? c
+            : '_');
+    return stem.empty() ? std::string{"track"} : stem;
+}
+
+bool isSafeRenderPath(const std::filesystem::path& path) {
+    if (path.empty() || path.is_absolute() || path.has_root_name())
+        return false;
+    for (const auto& part : path)
+        if (part == "..")
+            return false;
+    return path.extension() == kRenderFileExtension;
+}
+
 } // namespace
 
 FrozenTrackManagerProjectSerializationExtension::
@@ -93,6 +125,8 @@ FrozenTrackManager::FrozenTrackManager(
     , audio_processor_extension_(
           std::make_unique<FrozenTrackAudioProcessorExtension>(*this)) {
     async_lifetime_->owner.store(this, std::memory_order_release);
+    prefetcher_ = std::make_unique<FrozenTrackCachePrefetcher>(
+        [&engine] { return engine.playbackPosition(); });
     const std::weak_ptr<AsyncLifetime> weakLifetime(async_lifetime_);
     transport_quiet_listener_token_ =
         engine_.tailProcessManager().addTransportQuietListener([weakLifetime] {
@@ -121,8 +155,18 @@ FrozenTrackManager::~FrozenTrackManager() {
         timeline_.projectDocumentEvents().removeProjectDocumentEventListener(
             project_document_event_listener_token_);
 
+    // stopping_ makes a background render stop at its next step.
+    if (background_render_thread_.joinable())
+        background_render_thread_.join();
     if (active_render_)
         engine_.finishOfflineTrackRender(true);
+    prefetcher_.reset();
+
+    // Mapped renders stay readable after their directory entries are removed.
+    if (!session_cache_directory_.empty()) {
+        std::error_code ec;
+        std::filesystem::remove_all(session_cache_directory_, ec);
+    }
 }
 
 FrozenTrackManagerProjectSerializationExtension&
@@ -187,27 +231,21 @@ void FrozenTrackManager::processAudio(
         context.masterContext().playbackPositionSamples() -
         cachedAudio->start_sample;
     const int32_t frameCount = std::max(0, context.frameCount());
-    size_t cachedChannel = 0;
+    const auto& file = *cachedAudio->file;
+    uint32_t cachedChannel = 0;
     for (int32_t bus = 0; bus < context.audioOutBusCount(); ++bus)
         for (uint32_t channel = 0;
              channel <
              static_cast<uint32_t>(context.outputChannelCount(bus));
              ++channel) {
             auto* output = context.getFloatOutBuffer(bus, channel);
-            if (!output || cachedChannel >= cachedAudio->channels.size()) {
-                ++cachedChannel;
-                continue;
-            }
-            const auto& input = cachedAudio->channels[cachedChannel++];
-            for (int32_t frame = 0; frame < frameCount; ++frame) {
-                const int64_t sourceFrame = cacheFrame + frame;
-                output[frame] =
-                    sourceFrame >= 0 &&
-                    static_cast<size_t>(sourceFrame) < input.size()
-                    ? input[static_cast<size_t>(sourceFrame)]
-                    : 0.0f;
-            }
+            // read() yields silence for channels the render does not have.
+            if (output)
+                file.read(cachedChannel, cacheFrame, output, frameCount);
+            ++cachedChannel;
         }
+    // The cache holds floats; every output channel was written above.
+    context.convertAudioOutputs(AudioContentType::Float32, context.audioDataType());
 }
 
 void FrozenTrackManager::audioContentChanged(int32_t trackIndex) {
@@ -238,6 +276,8 @@ bool FrozenTrackManager::setFreezePolicyForTrack(
     bool startRender = false;
     bool resetLiveGraph = false;
     uint64_t transitionGeneration = 0;
+    const bool deferRender =
+        policy != FreezePolicy::Off && mustDeferRender();
     {
         std::lock_guard lock(mutex_);
         const auto existing = policies_by_track_reference_.find(referenceId);
@@ -272,8 +312,7 @@ bool FrozenTrackManager::setFreezePolicyForTrack(
             }
         } else {
             policies_by_track_reference_[referenceId] = FreezePolicy::On;
-            if (playback_active_.load(std::memory_order_acquire) ||
-                !engine_.tailProcessManager().isTransportQuiet()) {
+            if (deferRender) {
                 runtime.render_deferred_until_transport_quiet = true;
                 runtime.state = RuntimeState::Live;
             } else {
@@ -319,30 +358,71 @@ bool FrozenTrackManager::unfreezeTrack(int32_t trackIndex) {
     return setFreezePolicyForTrack(trackIndex, FreezePolicy::Off);
 }
 
+bool FrozenTrackManager::backgroundRenderingEnabled() const {
+    return background_rendering_enabled_.load(std::memory_order_acquire);
+}
+
+void FrozenTrackManager::setBackgroundRenderingEnabled(bool enabled) {
+    background_rendering_enabled_.store(enabled, std::memory_order_release);
+}
+
+FrozenTrackManager::CacheSampleFormat
+FrozenTrackManager::cacheSampleFormat() const {
+    return cache_sample_format_.load(std::memory_order_acquire);
+}
+
+void FrozenTrackManager::setCacheSampleFormat(CacheSampleFormat format) {
+    cache_sample_format_.store(format, std::memory_order_release);
+}
+
+uint64_t FrozenTrackManager::cacheMemoryBudgetInBytes() const {
+    return prefetcher_->memoryBudgetInBytes();
+}
+
+void FrozenTrackManager::setCacheMemoryBudgetInBytes(uint64_t bytes) {
+    prefetcher_->setMemoryBudgetInBytes(bytes);
+}
+
 void FrozenTrackManager::transportPlaybackStarted() {
     playback_active_.store(true, std::memory_order_release);
-    std::lock_guard lock(mutex_);
-    for (auto& [referenceId, runtime] :
-         runtime_by_track_reference_) {
-        if (runtime.state != RuntimeState::Rendering ||
-            !policies_by_track_reference_.contains(referenceId))
-            continue;
-        ++runtime.invalidation_generation;
-        runtime.state = RuntimeState::Live;
-        runtime.render_deferred_until_transport_quiet = true;
-        auto& state = playback_states_by_track_reference_[referenceId];
-        if (!state)
-            state = std::make_unique<PlaybackState>();
-        state->policy.store(
-            FreezePolicy::On, std::memory_order_release);
-        state->runtime_state.store(
-            RuntimeState::Live, std::memory_order_release);
-        state->cached_audio.store(nullptr, std::memory_order_release);
+    prefetcher_->setPlaybackActive(true);
+    std::shared_ptr<RenderOperation> withdrawnRender;
+    {
+        std::lock_guard lock(mutex_);
+        for (auto& [referenceId, runtime] :
+             runtime_by_track_reference_) {
+            if (runtime.state != RuntimeState::Rendering ||
+                !policies_by_track_reference_.contains(referenceId))
+                continue;
+            ++runtime.invalidation_generation;
+            runtime.state = RuntimeState::Live;
+            runtime.render_deferred_until_transport_quiet = true;
+            auto& state = playback_states_by_track_reference_[referenceId];
+            if (!state)
+                state = std::make_unique<PlaybackState>();
+            state->policy.store(
+                FreezePolicy::On, std::memory_order_release);
+            state->runtime_state.store(
+                RuntimeState::Live, std::memory_order_release);
+            state->cached_audio.store(nullptr, std::memory_order_release);
+        }
+        if (active_render_ && active_render_->settings.background)
+            withdrawnRender = active_render_;
+    }
+    // A background render holds its track out of the live walk, so it gives
+    // the track back before playback starts rather than at the render
+    // thread's next main-thread turn. The render runs again once the
+    // transport is quiet.
+    if (withdrawnRender) {
+        if (background_render_thread_.joinable())
+            background_render_thread_.join();
+        cancelRenderOperation(withdrawnRender);
     }
 }
 
 void FrozenTrackManager::transportPlaybackStopped() {
     playback_active_.store(false, std::memory_order_release);
+    prefetcher_->setPlaybackActive(false);
     // Play/Resume may have been deferred while an active render restores the
     // plugin instances. Stop/Pause revokes that deferred user request: once
     // the renderer completes, it may resume queued freezing work, but must
@@ -419,6 +499,27 @@ std::string FrozenTrackManager::errorMessageForTrack(int32_t trackIndex) const {
     return {};
 }
 
+bool FrozenTrackManager::canFreezeTrack(int32_t trackIndex) const {
+    return freezeBlockerForTrack(trackIndex).empty();
+}
+
+std::string FrozenTrackManager::freezeBlockerForTrack(int32_t trackIndex) const {
+    const auto& tracks = engine_.tracks();
+    if (trackIndex < 0 || static_cast<size_t>(trackIndex) >= tracks.size())
+        return "The track does not exist.";
+    if (engine_.trackHasLiveInput(trackIndex))
+        return "Tracks with device audio input cannot be frozen.";
+    if (engine_.trackIsReturn(trackIndex))
+        return "Return tracks cannot be frozen.";
+    const auto bounds = timeline_.calculateTrackContentBounds(trackIndex);
+    if (!bounds.hasContent || bounds.lastSample <= 0)
+        return "The track has no renderable timeline content.";
+    auto* track = tracks[static_cast<size_t>(trackIndex)];
+    if (track && !std::isfinite(track->tailLengthInSeconds()))
+        return "Tracks with an infinite plugin tail cannot be frozen.";
+    return {};
+}
+
 bool FrozenTrackManager::isTrackBusy(int32_t trackIndex) const {
     return runtimeStateForTrack(trackIndex) == RuntimeState::Rendering;
 }
@@ -453,6 +554,12 @@ bool FrozenTrackManager::requestPlaybackAfterBusyTrackRestored(
         if (runtime.state != RuntimeState::Rendering ||
             !policies_by_track_reference_.contains(referenceId))
             continue;
+        // A background render does not hold the engine; playback may start
+        // right away and transportPlaybackStarted() withdraws it.
+        if (active_render_ &&
+            active_render_->track_reference_id == referenceId &&
+            active_render_->settings.background)
+            continue;
         ++runtime.invalidation_generation;
         runtime.render_deferred_until_transport_quiet = true;
         if (active_render_ &&
@@ -603,13 +710,51 @@ void FrozenTrackManager::pluginGraphChanged(
 void FrozenTrackManager::masterTrackChanged(const ProjectDocumentEvent&) {
 }
 
+bool FrozenTrackManager::renderCopyIsCurrent(
+    const std::string& trackReferenceId,
+    const std::shared_ptr<const FrozenTrackCacheFile>& render,
+    const std::filesystem::path& target) const {
+    SavedRenderCopy copy;
+    {
+        std::lock_guard lock(mutex_);
+        const auto it = saved_render_copies_by_track_reference_.find(trackReferenceId);
+        if (it == saved_render_copies_by_track_reference_.end())
+            return false;
+        copy = it->second;
+    }
+    if (copy.render.lock() != render || copy.target != target)
+        return false;
+    std::error_code ec;
+    const auto writtenAt = std::filesystem::last_write_time(target, ec);
+    if (ec || writtenAt != copy.written_at)
+        return false;
+    const auto size = std::filesystem::file_size(target, ec);
+    return !ec && size == copy.size;
+}
+
 bool FrozenTrackManager::saveProjectExtensionData(
     ProjectSerializationWriteContext& context,
     std::string& error) {
     std::unordered_map<std::string, FreezePolicy> policies;
+    std::unordered_map<std::string, std::shared_ptr<const FrozenTrackCacheFile>>
+        renders;
     {
         std::lock_guard lock(mutex_);
         policies = policies_by_track_reference_;
+        std::erase_if(saved_render_copies_by_track_reference_, [](const auto& entry) {
+            return entry.second.render.expired();
+        });
+        for (const auto& [referenceId, runtime] : runtime_by_track_reference_) {
+            if (runtime.state != RuntimeState::Frozen)
+                continue;
+            auto state = playback_states_by_track_reference_.find(referenceId);
+            const auto* cachedAudio =
+                state == playback_states_by_track_reference_.end()
+                ? nullptr
+                : state->second->cached_audio.load(std::memory_order_acquire);
+            if (cachedAudio && cachedAudio->file)
+                renders.emplace(referenceId, cachedAudio->file);
+        }
     }
 
     std::string manifest(kManifestHeader);
@@ -618,6 +763,68 @@ bool FrozenTrackManager::saveProjectExtensionData(
         if (!referenceId.empty() && policy == FreezePolicy::On)
             manifest += "track." + referenceId + "=on\n";
 
+    // Renders are copied next to the manifest so that re-opening the project
+    // does not re-render. A render already saved there is left untouched:
+    // either the track plays the project copy itself, or this manager wrote
+    // that copy from the same render and it has not changed since. Copies go
+    // through a temporary name so that a mapped render is replaced, never
+    // rewritten in place.
+    const auto dataDirectory = context.extensionDataDirectory(extensionId());
+    if (!dataDirectory.empty()) {
+        const auto renderDirectory = dataDirectory / kRenderDirectory;
+        std::unordered_set<std::string> savedFileNames;
+        for (const auto& [referenceId, file] : renders) {
+            if (!policies.contains(referenceId))
+                continue;
+            const auto fileName =
+                cacheFileStem(referenceId) + std::string(kRenderFileExtension);
+            const auto target = renderDirectory / fileName;
+            std::error_code ec;
+            if (!std::filesystem::equivalent(file->path(), target, ec) &&
+                !renderCopyIsCurrent(referenceId, file, target)) {
+                std::filesystem::create_directories(renderDirectory, ec);
+                auto partial = target;
+                partial += ".part";
+                ec.clear();
+                std::filesystem::copy_file(
+                    file->path(),
+                    partial,
+                    std::filesystem::copy_options::overwrite_existing,
+                    ec);
+                if (!ec)
+                    std::filesystem::rename(partial, target, ec);
+                if (ec) {
+                    // The track simply re-renders on the next load.
+                    std::filesystem::remove(partial, ec);
+                    remidy::Logger::global()->logWarning(
+                        "Failed to save the frozen render of track %s", referenceId.c_str());
+                    continue;
+                }
+                SavedRenderCopy copy{file, target};
+                copy.written_at = std::filesystem::last_write_time(target, ec);
+                copy.size = std::filesystem::file_size(target, ec);
+                std::lock_guard lock(mutex_);
+                if (ec)
+                    saved_render_copies_by_track_reference_.erase(referenceId);
+                else
+                    saved_render_copies_by_track_reference_[referenceId] = std::move(copy);
+            }
+            savedFileNames.insert(fileName);
+            manifest += "render." + referenceId + "=" +
+                std::string(kRenderDirectory) + "/" + fileName + "\n";
+        }
+        std::error_code ec;
+        for (const auto& entry :
+             std::filesystem::directory_iterator(renderDirectory, ec)) {
+            const auto name = entry.path().filename().string();
+            if (entry.path().extension() == kRenderFileExtension &&
+                !savedFileNames.contains(name)) {
+                std::error_code removeError;
+                std::filesystem::remove(entry.path(), removeError);
+            }
+        }
+    }
+
     return context.writeExtensionFile(
         extensionId(),
         kManifestPath,
@@ -632,12 +839,15 @@ bool FrozenTrackManager::loadProjectExtensionData(
     auto bytes =
         context.readExtensionFile(extensionId(), kManifestPath, readError);
     std::unordered_map<std::string, FreezePolicy> policies;
+    std::unordered_map<std::string, std::filesystem::path> renderPaths;
     if (bytes) {
         std::string_view manifest(
             reinterpret_cast<const char*>(bytes->data()), bytes->size());
         const auto newline = manifest.find('\n');
         const auto header = manifest.substr(0, newline);
-        if (header != kManifestHeader && header != kLegacyManifestHeader) {
+        if (header != kManifestHeader &&
+            header != kPreviousManifestHeader &&
+            header != kLegacyManifestHeader) {
             error = "Unsupported track-freezing manifest version.";
             return false;
         }
@@ -656,15 +866,38 @@ bool FrozenTrackManager::loadProjectExtensionData(
             const auto key = trim(line.substr(0, equals));
             const auto value = trim(line.substr(equals + 1));
             constexpr std::string_view trackPrefix{"track."};
+            constexpr std::string_view renderPrefix{"render."};
             if (key.starts_with(trackPrefix) && value == "on") {
                 const auto referenceId = key.substr(trackPrefix.size());
                 if (!referenceId.empty())
                     policies.emplace(referenceId, FreezePolicy::On);
+            } else if (key.starts_with(renderPrefix)) {
+                const auto referenceId = key.substr(renderPrefix.size());
+                const std::filesystem::path path{std::string(value)};
+                if (!referenceId.empty() && isSafeRenderPath(path))
+                    renderPaths.emplace(referenceId, path);
             }
         }
     }
 
+    // A saved render is reused only if it still matches the session rate;
+    // anything unreadable silently falls back to rendering again.
+    const auto dataDirectory = context.extensionDataDirectory(extensionId());
+    const auto sampleRate = timeline_.state().sample_rate;
+    std::unordered_map<std::string, std::shared_ptr<const FrozenTrackCacheFile>>
+        savedRenders;
+    if (!dataDirectory.empty())
+        for (const auto& [referenceId, path] : renderPaths) {
+            if (!policies.contains(referenceId))
+                continue;
+            std::string openError;
+            auto file = FrozenTrackCacheFile::open(dataDirectory / path, openError);
+            if (file && (sampleRate <= 0 || file->sampleRate() == sampleRate))
+                savedRenders.emplace(referenceId, std::move(file));
+        }
+
     std::vector<std::string> toRender;
+    std::vector<std::pair<std::string, uint64_t>> toRestore;
     {
         std::lock_guard lock(mutex_);
         policies_by_track_reference_ = std::move(policies);
@@ -676,13 +909,32 @@ bool FrozenTrackManager::loadProjectExtensionData(
             if (!state)
                 state = std::make_unique<PlaybackState>();
             state->cached_audio.store(nullptr, std::memory_order_release);
-            toRender.push_back(referenceId);
+            if (savedRenders.contains(referenceId))
+                toRestore.emplace_back(referenceId, runtime.invalidation_generation);
+            else
+                toRender.push_back(referenceId);
         }
     }
     clearAllPlaybackCaches();
     error.clear();
     for (const auto& referenceId : toRender)
         beginRender(referenceId);
+    for (auto& [referenceId, generation] : toRestore) {
+        const std::weak_ptr<AsyncLifetime> weakLifetime(async_lifetime_);
+        remidy::EventLoop::enqueueTaskOnMainThread(
+            [weakLifetime,
+             referenceId,
+             generation,
+             file = savedRenders.at(referenceId)]() mutable {
+                const auto lifetime = weakLifetime.lock();
+                auto* owner = lifetime
+                    ? lifetime->owner.load(std::memory_order_acquire)
+                    : nullptr;
+                if (owner)
+                    owner->restoreRender(
+                        std::move(referenceId), generation, std::move(file));
+            });
+    }
     return true;
 }
 
@@ -711,8 +963,7 @@ void FrozenTrackManager::invalidateTrack(
     std::string_view trackReferenceId) {
     if (trackReferenceId.empty())
         return;
-    if (playback_active_.load(std::memory_order_acquire) ||
-        !engine_.tailProcessManager().isTransportQuiet()) {
+    if (mustDeferRender()) {
         std::lock_guard lock(mutex_);
         const std::string referenceId(trackReferenceId);
         auto& runtime = runtime_by_track_reference_[referenceId];
@@ -830,8 +1081,7 @@ void FrozenTrackManager::beginRender(std::string trackReferenceId) {
 void FrozenTrackManager::prepareRender(std::string trackReferenceId) {
     if (stopping_.load(std::memory_order_acquire))
         return;
-    if (playback_active_.load(std::memory_order_acquire) ||
-        !engine_.tailProcessManager().isTransportQuiet()) {
+    if (mustDeferRender()) {
         std::lock_guard lock(mutex_);
         auto runtime =
             runtime_by_track_reference_.find(trackReferenceId);
@@ -884,7 +1134,7 @@ void FrozenTrackManager::prepareRender(std::string trackReferenceId) {
     operation->settings.bufferSize = kRenderBufferSize;
     operation->settings.umpBufferSize =
         static_cast<uint32_t>(engine_.umpBufferSizeInBytes());
-    operation->settings.maximumBytes = kMaximumFrozenTrackBytes;
+    operation->settings.background = rendersInBackground(trackIndex);
     {
         std::lock_guard lock(mutex_);
         auto runtime =
@@ -896,28 +1146,16 @@ void FrozenTrackManager::prepareRender(std::string trackReferenceId) {
         operation->generation = runtime->second.invalidation_generation;
     }
 
-    if (engine_.trackHasLiveInput(trackIndex)) {
-        failRender(
-            operation,
-            "Tracks with device audio input cannot be frozen.");
+    if (auto blocker = freezeBlockerForTrack(trackIndex); !blocker.empty()) {
+        failRender(operation, std::move(blocker));
         return;
     }
 
     const auto bounds = timeline_.calculateTrackContentBounds(trackIndex);
-    if (!bounds.hasContent || bounds.lastSample <= 0) {
-        failRender(operation, "The track has no renderable timeline content.");
-        return;
-    }
     auto* track =
         engine_.tracks()[static_cast<size_t>(trackIndex)];
     const auto tailSeconds =
         track ? std::max(0.0, track->tailLengthInSeconds()) : 0.0;
-    if (!std::isfinite(tailSeconds)) {
-        failRender(
-            operation,
-            "Tracks with an infinite plugin tail cannot be frozen.");
-        return;
-    }
     const auto tailSampleCount = std::ceil(
         static_cast<long double>(tailSeconds) *
         static_cast<long double>(operation->settings.sampleRate));
@@ -945,7 +1183,35 @@ void FrozenTrackManager::prepareRender(std::string trackReferenceId) {
         static_cast<double>(operation->progress.totalFrames) /
         static_cast<double>(operation->settings.sampleRate);
 
+    // Stream the render to disk instead of accumulating it in memory. The
+    // generation in the name keeps a new render from replacing a file that the
+    // audio thread may still be reading.
     std::string error;
+    operation->cache_path = sessionCacheDirectory() /
+        std::format("{}-{}{}",
+                    cacheFileStem(operation->track_reference_id),
+                    operation->generation,
+                    kRenderFileExtension);
+    operation->writer = std::make_shared<FrozenTrackCacheFileWriter>();
+    if (!operation->writer->open(
+            operation->cache_path,
+            cache_sample_format_.load(std::memory_order_acquire),
+            operation->settings.sampleRate,
+            operation->settings.startSample,
+            operation->progress.totalFrames,
+            error)) {
+        failRender(operation, std::move(error));
+        startNextQueuedRender();
+        return;
+    }
+    operation->settings.blockSink =
+        [writer = operation->writer](const float* const* channels,
+                                     uint32_t channelCount,
+                                     int32_t frameCount,
+                                     std::string& sinkError) {
+            return writer->append(channels, channelCount, frameCount, sinkError);
+        };
+
     if (!engine_.beginOfflineTrackRender(operation->settings, error)) {
         failRender(operation, std::move(error));
         startNextQueuedRender();
@@ -959,7 +1225,10 @@ void FrozenTrackManager::prepareRender(std::string trackReferenceId) {
         runtime.state = RuntimeState::Rendering;
     }
     updatePlaybackState(operation->track_reference_id);
-    enqueueRenderStep(operation);
+    if (operation->settings.background)
+        startBackgroundRender(operation);
+    else
+        enqueueRenderStep(operation);
 }
 
 void FrozenTrackManager::enqueueRenderStep(
@@ -979,21 +1248,7 @@ void FrozenTrackManager::enqueueRenderStep(
 void FrozenTrackManager::renderNextChunk(
     const std::shared_ptr<RenderOperation>& operation) {
     if (!operationIsCurrent(*operation)) {
-        engine_.finishOfflineTrackRender(
-            true,
-            [this, &operation](OfflineTrackRenderResult&) {
-                {
-                    std::lock_guard lock(mutex_);
-                    auto runtime = runtime_by_track_reference_.find(
-                        operation->track_reference_id);
-                    if (runtime != runtime_by_track_reference_.end()) {
-                        runtime->second.state = RuntimeState::Live;
-                        runtime->second.error_message.clear();
-                    }
-                }
-                updatePlaybackState(operation->track_reference_id);
-            });
-        completeRenderOperation(operation);
+        cancelRenderOperation(operation);
         return;
     }
 
@@ -1009,7 +1264,90 @@ void FrozenTrackManager::renderNextChunk(
         enqueueRenderStep(operation);
         return;
     }
+    finishRenderOperation(operation, std::move(step));
+}
+
+void FrozenTrackManager::startBackgroundRender(
+    const std::shared_ptr<RenderOperation>& operation) {
+    if (background_render_thread_.joinable())
+        background_render_thread_.join();
+    const std::weak_ptr<AsyncLifetime> weakLifetime(async_lifetime_);
+    background_render_thread_ = std::thread([this, weakLifetime, operation] {
+        // Short steps keep invalidation and structural edits on the main
+        // thread responsive; between them the render runs as fast as it can.
+        constexpr uint32_t kBlocksPerBackgroundStep = 4;
+        OfflineTrackRenderStepResult step;
+        bool canceled = false;
+        while (true) {
+            if (!operationIsCurrent(*operation)) {
+                canceled = true;
+                break;
+            }
+            step = engine_.renderOfflineTrackStep(kBlocksPerBackgroundStep);
+            {
+                std::lock_guard lock(mutex_);
+                if (active_render_ == operation)
+                    operation->progress = step.progress;
+            }
+            if (step.state != OfflineTrackRenderStepState::InProgress)
+                break;
+            std::this_thread::yield();
+        }
+        // The engine session is finished on the main thread, like every
+        // other transition of the track.
+        remidy::EventLoop::enqueueTaskOnMainThread(
+            [weakLifetime, operation, canceled, step = std::move(step)]() mutable {
+                const auto lifetime = weakLifetime.lock();
+                auto* owner = lifetime
+                    ? lifetime->owner.load(std::memory_order_acquire)
+                    : nullptr;
+                if (owner)
+                    owner->completeBackgroundRender(
+                        operation, canceled, std::move(step));
+            });
+    });
+}
+
+void FrozenTrackManager::completeBackgroundRender(
+    const std::shared_ptr<RenderOperation>& operation,
+    bool canceled,
+    OfflineTrackRenderStepResult step) {
+    if (background_render_thread_.joinable())
+        background_render_thread_.join();
+    {
+        // transportPlaybackStarted() may have withdrawn it already.
+        std::lock_guard lock(mutex_);
+        if (active_render_ != operation)
+            return;
+    }
+    if (canceled)
+        cancelRenderOperation(operation);
+    else
+        finishRenderOperation(operation, std::move(step));
+}
+
+void FrozenTrackManager::cancelRenderOperation(
+    const std::shared_ptr<RenderOperation>& operation) {
+    engine_.finishOfflineTrackRender(
+        true,
+        [this, &operation](OfflineTrackRenderResult&) {
+            {
+                std::lock_guard lock(mutex_);
+                auto runtime = runtime_by_track_reference_.find(
+                    operation->track_reference_id);
+                if (runtime != runtime_by_track_reference_.end()) {
+                    runtime->second.state = RuntimeState::Live;
+                    runtime->second.error_message.clear();
+                }
+            }
+            updatePlaybackState(operation->track_reference_id);
+        });
+    completeRenderOperation(operation);
+}
 
+void FrozenTrackManager::finishRenderOperation(
+    const std::shared_ptr<RenderOperation>& operation,
+    OfflineTrackRenderStepResult step) {
     if (step.state == OfflineTrackRenderStepState::Error) {
         engine_.finishOfflineTrackRender(
             false,
@@ -1072,10 +1410,22 @@ void FrozenTrackManager::finishRender(
         return;
     }
 
+    std::string error;
+    if (!operation->writer ||
+        !operation->writer->finish(result.busChannelCounts, error)) {
+        failRender(operation, error.empty() ? "Track rendering failed." : error);
+        return;
+    }
+    auto file = FrozenTrackCacheFile::open(operation->cache_path, error);
+    if (!file) {
+        failRender(operation, std::move(error));
+        return;
+    }
+
     auto cachedAudio = std::make_unique<CachedAudio>();
     cachedAudio->start_sample = result.startSample;
     cachedAudio->bus_channel_counts = std::move(result.busChannelCounts);
-    cachedAudio->channels = std::move(result.channels);
+    cachedAudio->file = std::move(file);
 
     const auto trackIndex =
         trackIndexForReferenceId(operation->track_reference_id);
@@ -1085,38 +1435,124 @@ void FrozenTrackManager::finishRender(
     // Clear live graph buffers and publish the immutable cache as one audio-
     // excluded transition. Otherwise a callback can refill an alignment or
     // pump buffer between the clear and the state change.
+    bool published = false;
     engine_.resetTrackProcessingState(
         trackIndex,
         false,
-        [this, &operation, &cachedAudio] {
-            std::lock_guard lock(mutex_);
-            if (playback_active_.load(std::memory_order_acquire))
-                return;
-            auto runtime = runtime_by_track_reference_.find(
-                operation->track_reference_id);
-            if (runtime == runtime_by_track_reference_.end() ||
-                runtime->second.invalidation_generation !=
-                    operation->generation ||
-                !policies_by_track_reference_.contains(
-                    operation->track_reference_id))
+        [this, &operation, &cachedAudio, &published] {
+            // An exclusive render restored plugin state that playback may
+            // already have moved on from; a background render never left it.
+            if (!operation->settings.background &&
+                playback_active_.load(std::memory_order_acquire))
                 return;
+            published = publishCachedAudio(
+                operation->track_reference_id,
+                operation->generation,
+                cachedAudio);
+        });
+    if (!published)
+        return;
 
-            auto& playbackState =
-                playback_states_by_track_reference_[
-                    operation->track_reference_id];
-            if (!playbackState)
-                playbackState = std::make_unique<PlaybackState>();
-            const auto* published = cachedAudio.get();
-            retained_cached_audio_.push_back(std::move(cachedAudio));
-            playbackState->cached_audio.store(
-                published, std::memory_order_release);
-            runtime->second.state = RuntimeState::Frozen;
-            runtime->second.error_message.clear();
-            playbackState->policy.store(
-                FreezePolicy::On, std::memory_order_release);
-            playbackState->runtime_state.store(
-                RuntimeState::Frozen, std::memory_order_release);
+    // The previous render of this track is no longer reachable from new
+    // snapshots. Unlinking it is safe while a callback still reads the mapping.
+    std::filesystem::path superseded;
+    {
+        std::lock_guard lock(mutex_);
+        auto& current =
+            session_cache_files_by_track_reference_[operation->track_reference_id];
+        superseded = std::exchange(current, operation->cache_path);
+    }
+    if (!superseded.empty() && superseded != operation->cache_path) {
+        std::error_code ec;
+        std::filesystem::remove(superseded, ec);
+    }
+    updatePrefetchFiles();
+}
+
+void FrozenTrackManager::restoreRender(
+    std::string trackReferenceId,
+    uint64_t generation,
+    std::shared_ptr<const FrozenTrackCacheFile> file) {
+    if (stopping_.load(std::memory_order_acquire))
+        return;
+    const auto trackIndex = trackIndexForReferenceId(trackReferenceId);
+    if (trackIndex < 0)
+        return;
+
+    auto cachedAudio = std::make_unique<CachedAudio>();
+    cachedAudio->start_sample = file->startSample();
+    cachedAudio->bus_channel_counts = file->busChannelCounts();
+    cachedAudio->file = std::move(file);
+
+    // Unlike a fresh render this needs no plugin state round trip, so it is
+    // also safe to publish while the transport is running.
+    bool published = false;
+    engine_.resetTrackProcessingState(
+        trackIndex,
+        false,
+        [this, &trackReferenceId, generation, &cachedAudio, &published] {
+            published = publishCachedAudio(
+                trackReferenceId, generation, cachedAudio);
         });
+    if (published)
+        updatePrefetchFiles();
+}
+
+bool FrozenTrackManager::publishCachedAudio(
+    const std::string& trackReferenceId,
+    uint64_t generation,
+    std::unique_ptr<CachedAudio>& cachedAudio) {
+    std::lock_guard lock(mutex_);
+    auto runtime = runtime_by_track_reference_.find(trackReferenceId);
+    if (runtime == runtime_by_track_reference_.end() ||
+        runtime->second.invalidation_generation != generation ||
+        !policies_by_track_reference_.contains(trackReferenceId))
+        return false;
+
+    auto& playbackState =
+        playback_states_by_track_reference_[trackReferenceId];
+    if (!playbackState)
+        playbackState = std::make_unique<PlaybackState>();
+    const auto* published = cachedAudio.get();
+    retained_cached_audio_.push_back(std::move(cachedAudio));
+    playbackState->cached_audio.store(
+        published, std::memory_order_release);
+    runtime->second.state = RuntimeState::Frozen;
+    runtime->second.error_message.clear();
+    playbackState->policy.store(
+        FreezePolicy::On, std::memory_order_release);
+    playbackState->runtime_state.store(
+        RuntimeState::Frozen, std::memory_order_release);
+    return true;
+}
+
+std::filesystem::path FrozenTrackManager::sessionCacheDirectory() {
+    if (session_cache_directory_.empty()) {
+        std::error_code ec;
+        auto base = std::filesystem::temp_directory_path(ec);
+        if (ec)
+            base = std::filesystem::current_path(ec);
+        session_cache_directory_ = base / "uapmd-frozen-tracks" /
+            std::format(
+                "{:x}-{:x}",
+                std::chrono::steady_clock::now().time_since_epoch().count(),
+                reinterpret_cast<uintptr_t>(this));
+    }
+    return session_cache_directory_;
+}
+
+void FrozenTrackManager::updatePrefetchFiles() {
+    std::vector<std::shared_ptr<const FrozenTrackCacheFile>> files;
+    {
+        std::lock_guard lock(mutex_);
+        for (const auto& [_, state] : playback_states_by_track_reference_) {
+            const auto* cachedAudio =
+                state->cached_audio.load(std::memory_order_acquire);
+            if (cachedAudio && cachedAudio->file)
+                files.push_back(cachedAudio->file);
+        }
+    }
+    prefetcher_->setFiles(std::move(files));
 }
 
 void FrozenTrackManager::failRender(
@@ -1157,6 +1593,19 @@ bool FrozenTrackManager::operationIsCurrent(
         policies_by_track_reference_.contains(operation.track_reference_id);
 }
 
+bool FrozenTrackManager::rendersInBackground(int32_t trackIndex) const {
+    return background_rendering_enabled_.load(std::memory_order_acquire) &&
+        trackIndex >= 0 &&
+        engine_.canRenderTrackInBackground(trackIndex);
+}
+
+// Exclusive renders pause the whole engine and background renders take their
+// track out of the live walk, so neither may start while it can be heard.
+bool FrozenTrackManager::mustDeferRender() const {
+    return playback_active_.load(std::memory_order_acquire) ||
+        !engine_.tailProcessManager().isTransportQuiet();
+}
+
 void FrozenTrackManager::updatePlaybackState(
     std::string_view trackReferenceId) {
     std::lock_guard lock(mutex_);
@@ -1212,6 +1661,7 @@ void FrozenTrackManager::clearAllPlaybackCaches() {
         }
     }
     publishPlaybackSnapshot();
+    updatePrefetchFiles();
 }
 
 } // namespace uapmd
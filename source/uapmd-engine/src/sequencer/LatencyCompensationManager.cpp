@@ -42,24 +42,10 @@ namespace uapmd {
         }
     }
 
-    void LatencyCompensationManagerImpl::OutputAlignmentDelayLine::reset() {
-        write_position = 0;
-        for (auto& bus : buses)
-            for (auto& channel : bus)
-                std::fill(channel.begin(), channel.end(), 0.0f);
-    }
-
-    void LatencyCompensationManagerImpl::OutputAlignmentDelayLine::configure(
-        AudioProcessContext* ctx,
-        size_t delayFrames) {
-        capacity_frames = std::max<size_t>(1, delayFrames + 1);
-        const uint32_t busCount = ctx ? ctx->audioOutBusCount() : 0;
-        buses.assign(busCount, {});
-        for (uint32_t busIndex = 0; busIndex < busCount; ++busIndex) {
-            const uint32_t channelCount = ctx->outputChannelCount(busIndex);
-            buses[busIndex].assign(channelCount, std::vector<float>(capacity_frames, 0.0f));
-        }
-        write_position = 0;
+    LatencyCompensationManagerImpl::CompensationBuffers::CompensationBuffers(BuffersLayout bufferLayout)
+        : layout(std::move(bufferLayout))
+        , arena(layout.lines)
+        , track_clear_requested(std::make_unique<std::atomic<bool>[]>(layout.output_alignment_lines.size())) {
     }
 
     LatencyCompensationManagerImpl::LatencyCompensationManagerImpl(
@@ -85,6 +71,12 @@ namespace uapmd {
         , prepare_for_timing_change_(std::move(prepareForTimingChange)) {
     }
 
+    LatencyCompensationManagerImpl::~LatencyCompensationManagerImpl() {
+        reclaimRetiredBuffers();
+        delete staged_buffers_.exchange(nullptr, std::memory_order_acq_rel);
+        delete buffers_.exchange(nullptr, std::memory_order_acq_rel);
+    }
+
     void LatencyCompensationManagerImpl::clearPluginTimingListeners() {
         callbacks_alive_->store(false, std::memory_order_release);
         while (!timing_listener_ids_.empty())
@@ -485,31 +477,95 @@ namespace uapmd {
             std::memory_order_release);
     }
 
+    void LatencyCompensationManagerImpl::stageBuffers(std::unique_ptr<CompensationBuffers> buffers) {
+        reclaimRetiredBuffers();
+        // A set staged earlier and not taken yet is simply replaced.
+        delete staged_buffers_.exchange(buffers.release(), std::memory_order_acq_rel);
+    }
+
+    void LatencyCompensationManagerImpl::reclaimRetiredBuffers() {
+        for (auto& retired : retired_buffers_)
+            delete retired.exchange(nullptr, std::memory_order_acq_rel);
+    }
+
+    LatencyCompensationManagerImpl::CompensationBuffers*
+    LatencyCompensationManagerImpl::upcomingBuffers() const {
+        auto* staged = staged_buffers_.load(std::memory_order_acquire);
+        return staged ? staged : buffers_.load(std::memory_order_acquire);
+    }
+
+    void LatencyCompensationManagerImpl::clearTrackBuffers(
+        CompensationBuffers& buffers,
+        size_t trackIndex) noexcept {
+        if (trackIndex >= buffers.layout.output_alignment_lines.size())
+            return;
+        const auto range = buffers.layout.output_alignment_lines[trackIndex];
+        for (size_t i = 0; i < range.count; ++i)
+            buffers.arena.line(range.first + i).clear();
+    }
+
     void LatencyCompensationManagerImpl::reconfigureOutputAlignmentBuffers() {
-        output_alignment_delay_lines_.resize(tracks_.size());
         if (!track_routing_manager_)
             return;
-        const size_t delayCapacityFrames =
-            static_cast<size_t>(track_routing_manager_->maxOutputAlignmentHoldbackInSamples()) +
-            audio_buffer_size_in_frames_;
-        for (size_t i = 0; i < output_alignment_delay_lines_.size(); ++i) {
+        // Every line can hold the longest holdback of its kind.
+        const size_t blockFrames = audio_buffer_size_in_frames_;
+        const size_t alignmentFrames = track_routing_manager_->maxOutputAlignmentHoldbackInSamples();
+        const size_t sendFrames = track_routing_manager_->maxSendHoldbackInSamples();
+
+        BuffersLayout layout;
+        layout.output_alignment_lines.resize(tracks_.size());
+        layout.send_lines.resize(tracks_.size());
+        layout.return_inputs.resize(tracks_.size());
+        auto addLines = [&layout](LineRange& range, size_t count, int32_t channels, size_t delayFrames, size_t maxBlockFrames) {
+            range = {layout.lines.size(), count};
+            layout.lines.insert(
+                layout.lines.end(),
+                count,
+                DelayLineArena::LineSpec{static_cast<uint32_t>(std::max(channels, 0)), delayFrames, maxBlockFrames});
+        };
+        for (size_t i = 0; i < tracks_.size(); ++i) {
             auto* ctx = i < sequence_.tracks.size() ? sequence_.tracks[i] : nullptr;
-            output_alignment_delay_lines_[i].configure(ctx, delayCapacityFrames);
+            if (!ctx)
+                continue;
+            const auto trackIndex = static_cast<uapmd_track_index_t>(i);
+            if (alignmentFrames > 0) {
+                const auto busCount = static_cast<uint32_t>(ctx->audioOutBusCount());
+                layout.output_alignment_lines[i] = {layout.lines.size(), busCount};
+                for (uint32_t busIndex = 0; busIndex < busCount; ++busIndex)
+                    layout.lines.push_back({
+                        static_cast<uint32_t>(ctx->outputChannelCount(busIndex)), alignmentFrames, blockFrames});
+            }
+
+            const auto* routes = track_routing_manager_->trackSendRoutes(trackIndex);
+            if (sendFrames > 0 && routes && ctx->audioOutBusCount() > 0)
+                addLines(layout.send_lines[i], routes->size(), ctx->outputChannelCount(0), sendFrames, blockFrames);
+
+            if (track_routing_manager_->trackIsReturn(trackIndex) && ctx->audioInBusCount() > 0)
+                addLines(layout.return_inputs[i], 1, ctx->inputChannelCount(0), 0, blockFrames);
         }
+
+        // Rings rounded up to the same sizes: keep the buffers, with no
+        // allocation and nothing to swap.
+        if (layout == buffers_layout_ && upcomingBuffers())
+            return;
+        buffers_layout_ = layout;
+        stageBuffers(std::make_unique<CompensationBuffers>(std::move(layout)));
     }
 
     void LatencyCompensationManagerImpl::resetOutputAlignmentBuffers() {
-        for (auto& delayLine : output_alignment_delay_lines_)
-            delayLine.reset();
+        // Staged buffers start out silent; the current ones are cleared on
+        // the audio thread, before they are used again.
+        if (auto* buffers = buffers_.load(std::memory_order_acquire))
+            buffers->clear_requested.store(true, std::memory_order_release);
     }
 
     void LatencyCompensationManagerImpl::resetTrackOutputAlignment(
         uapmd_track_index_t trackIndex) {
-        if (trackIndex < 0 ||
-            static_cast<size_t>(trackIndex) >=
-                output_alignment_delay_lines_.size())
+        auto* buffers = buffers_.load(std::memory_order_acquire);
+        if (!buffers || trackIndex < 0 ||
+            static_cast<size_t>(trackIndex) >= buffers->layout.output_alignment_lines.size())
             return;
-        output_alignment_delay_lines_[static_cast<size_t>(trackIndex)].reset();
+        buffers->track_clear_requested[static_cast<size_t>(trackIndex)].store(true, std::memory_order_release);
     }
 
     void LatencyCompensationManagerImpl::applyLatencyCompensationTimingUpdate(bool isPlaybackActive) {
@@ -556,55 +612,184 @@ namespace uapmd {
         schedulePrerollFromAudiblePosition(playback_position_samples_.load(std::memory_order_acquire));
     }
 
+    void LatencyCompensationManagerImpl::beginBlock() noexcept {
+        auto* buffers = buffers_.load(std::memory_order_relaxed);
+        if (staged_buffers_.load(std::memory_order_acquire)) {
+            // Only this thread fills a retired slot; if none is free, the
+            // swap waits for the next block.
+            std::atomic<CompensationBuffers*>* retiredSlot = nullptr;
+            for (auto& retired : retired_buffers_)
+                if (!retired.load(std::memory_order_acquire)) {
+                    retiredSlot = &retired;
+                    break;
+                }
+            if (!buffers || retiredSlot)
+                if (auto* staged = staged_buffers_.exchange(nullptr, std::memory_order_acq_rel)) {
+                    if (buffers)
+                        retiredSlot->store(buffers, std::memory_order_release);
+                    buffers = staged;
+                    buffers_.store(buffers, std::memory_order_release);
+                }
+        }
+        if (!buffers)
+            return;
+
+        if (buffers->clear_requested.exchange(false, std::memory_order_acq_rel))
+            buffers->arena.clear();
+        for (size_t i = 0; i < buffers->layout.output_alignment_lines.size(); ++i)
+            if (buffers->track_clear_requested[i].load(std::memory_order_relaxed) &&
+                buffers->track_clear_requested[i].exchange(false, std::memory_order_acq_rel))
+                clearTrackBuffers(*buffers, i);
+    }
+
     void LatencyCompensationManagerImpl::applyOutputAlignment(
         uapmd_track_index_t trackIndex,
         AudioProcessContext& ctx,
         int32_t trackFrameCount) {
-        if (trackIndex < 0 || static_cast<size_t>(trackIndex) >= output_alignment_delay_lines_.size())
+        auto* buffers = buffers_.load(std::memory_order_relaxed);
+        if (!buffers || !track_routing_manager_ || trackIndex < 0 ||
+            static_cast<size_t>(trackIndex) >= buffers->layout.output_alignment_lines.size())
             return;
 
-        auto& delayLine = output_alignment_delay_lines_[static_cast<size_t>(trackIndex)];
-        if (delayLine.capacity_frames == 0)
-            return;
+        const auto lines = buffers->layout.output_alignment_lines[static_cast<size_t>(trackIndex)];
+        const auto frames = static_cast<size_t>(std::max(trackFrameCount, 0));
+        const auto busCount = std::min<size_t>(ctx.audioOutBusCount(), lines.count);
+        for (uint32_t busIndex = 0; busIndex < busCount; ++busIndex) {
+            auto& line = buffers->arena.line(lines.first + busIndex);
+            const size_t delayFrames = std::min<size_t>(
+                track_routing_manager_->trackOutputAlignmentHoldbackInSamples(trackIndex, busIndex),
+                line.maxDelayFrames(frames));
+            if (delayFrames == 0)
+                continue;
 
-        bool usedDelay = false;
-        const size_t startWritePosition = delayLine.write_position;
-        if (!track_routing_manager_)
+            const uint32_t numChannels = std::min<uint32_t>(ctx.outputChannelCount(busIndex), line.channelCount());
+            ctx.withSampleType([&](auto* tag) {
+                using SampleType = std::remove_pointer_t<decltype(tag)>;
+                for (uint32_t ch = 0; ch < numChannels; ++ch) {
+                    auto* buffer = ctx.getOutBuffer<SampleType>(busIndex, ch);
+                    if (!buffer)
+                        continue;
+                    line.write(ch, buffer, frames);
+                    line.read(ch, delayFrames, buffer, frames);
+                }
+            });
+            line.advance(frames);
+        }
+    }
+
+    void LatencyCompensationManagerImpl::runSends(
+        uapmd_track_index_t trackIndex,
+        AudioProcessContext& ctx,
+        int32_t trackFrameCount,
+        bool admitted,
+        bool preFader) noexcept {
+        const auto* routes = track_routing_manager_->trackSendRoutes(trackIndex);
+        auto* buffers = buffers_.load(std::memory_order_relaxed);
+        if (!routes || !buffers || ctx.audioOutBusCount() == 0 ||
+            static_cast<size_t>(trackIndex) >= buffers->layout.send_lines.size())
             return;
-        for (uint32_t busIndex = 0; busIndex < ctx.audioOutBusCount(); ++busIndex) {
-            const uint32_t outputAlignmentDelay =
-                track_routing_manager_->trackOutputAlignmentHoldbackInSamples(trackIndex, busIndex);
-            if (outputAlignmentDelay == 0 || busIndex >= delayLine.buses.size())
+        const auto lines = buffers->layout.send_lines[static_cast<size_t>(trackIndex)];
+        const auto frames = static_cast<size_t>(std::max(trackFrameCount, 0));
+        for (size_t sendIndex = 0; sendIndex < routes->size(); ++sendIndex) {
+            const auto& route = (*routes)[sendIndex];
+            if (route.pre_fader != preFader)
+                continue;
+            auto* line = sendIndex < lines.count ? &buffers->arena.line(lines.first + sendIndex) : nullptr;
+            const size_t delayFrames = line
+                ? std::min<size_t>(route.holdback_in_samples, line->maxDelayFrames(frames))
+                : 0;
+            // A send without holdback goes straight to the return.
+            if (delayFrames == 0)
+                line = nullptr;
+
+            DelayLineArena::Line* target = nullptr;
+            if (admitted && route.return_track_index >= 0 &&
+                static_cast<size_t>(route.return_track_index) < buffers->layout.return_inputs.size()) {
+                const auto input = buffers->layout.return_inputs[static_cast<size_t>(route.return_track_index)];
+                if (input.count > 0 && buffers->arena.line(input.first).frames() >= frames)
+                    target = &buffers->arena.line(input.first);
+            }
+            if (!line && !target)
                 continue;
 
-            auto& busStorage = delayLine.buses[busIndex];
-            const size_t maxDelayFrames = delayLine.capacity_frames > 0 ? delayLine.capacity_frames - 1 : 0;
-            const size_t appliedDelayFrames = std::min<size_t>(outputAlignmentDelay, maxDelayFrames);
-            const uint32_t numChannels = std::min<uint32_t>(
-                ctx.outputChannelCount(busIndex),
-                static_cast<uint32_t>(busStorage.size()));
-            for (uint32_t ch = 0; ch < numChannels; ++ch) {
-                auto& delayChannel = busStorage[ch];
-                float* buffer = ctx.getFloatOutBuffer(busIndex, ch);
-                if (!buffer)
-                    continue;
-                size_t writePosition = startWritePosition;
-                for (int32_t frame = 0; frame < trackFrameCount; ++frame) {
-                    const float inputSample = buffer[frame];
-                    delayChannel[writePosition] = inputSample;
-                    const size_t readPosition =
-                        (writePosition + delayLine.capacity_frames - appliedDelayFrames) %
-                        delayLine.capacity_frames;
-                    buffer[frame] = delayChannel[readPosition];
-                    writePosition = (writePosition + 1) % delayLine.capacity_frames;
+            // Channel k of the return takes source channel k % sourceChannels;
+            // surplus source channels fold onto the return's channels.
+            const uint32_t sourceChannels = line
+                ? std::min<uint32_t>(ctx.outputChannelCount(0), line->channelCount())
+                : ctx.outputChannelCount(0);
+            const uint32_t returnChannels = target ? target->channelCount() : 0;
+            const double gain = route.gain;
+            ctx.withSampleType([&](auto* tag) {
+                using SampleType = std::remove_pointer_t<decltype(tag)>;
+                for (uint32_t ch = 0; ch < sourceChannels; ++ch) {
+                    const auto* buffer = ctx.getOutBuffer<SampleType>(0, ch);
+                    if (!buffer)
+                        continue;
+                    auto mix = [&](const auto* span, size_t offset, size_t length) {
+                        for (uint32_t k = ch % returnChannels; k < returnChannels;
+                             k += std::min(sourceChannels, returnChannels)) {
+                            auto* input = target->channel(k) + offset;
+                            for (size_t frame = 0; frame < length; ++frame)
+                                input[frame] += span[frame] * gain;
+                        }
+                    };
+                    if (line)
+                        line->write(ch, buffer, frames);
+                    if (returnChannels == 0)
+                        continue;
+                    if (line)
+                        line->forEachDelayedSpan(ch, delayFrames, frames, mix);
+                    else
+                        mix(buffer, 0, frames);
                 }
-            }
-            usedDelay = true;
+            });
+            if (line)
+                line->advance(frames);
         }
+    }
 
-        if (usedDelay)
-            delayLine.write_position =
-                (startWritePosition + static_cast<size_t>(trackFrameCount)) % delayLine.capacity_frames;
+    void LatencyCompensationManagerImpl::captureTrackSends(
+        uapmd_track_index_t trackIndex,
+        AudioProcessContext& ctx,
+        int32_t trackFrameCount,
+        bool admitted,
+        uapmd_graph::webaudio_compat::GainNode* deferredFader) noexcept {
+        const bool hasSends = track_routing_manager_ && trackIndex >= 0;
+        if (hasSends)
+            runSends(trackIndex, ctx, trackFrameCount, admitted, true);
+        if (deferredFader)
+            deferredFader->applyToOutputs(ctx);
+        if (hasSends)
+            runSends(trackIndex, ctx, trackFrameCount, admitted, false);
+    }
+
+    void LatencyCompensationManagerImpl::mixReturnInput(
+        uapmd_track_index_t trackIndex,
+        AudioProcessContext& ctx,
+        int32_t trackFrameCount,
+        bool deliver) noexcept {
+        auto* buffers = buffers_.load(std::memory_order_relaxed);
+        if (!buffers || trackIndex < 0 ||
+            static_cast<size_t>(trackIndex) >= buffers->layout.return_inputs.size())
+            return;
+        const auto range = buffers->layout.return_inputs[static_cast<size_t>(trackIndex)];
+        if (range.count == 0)
+            return;
+        auto& channels = buffers->arena.line(range.first);
+        const size_t count = std::min(static_cast<size_t>(std::max(trackFrameCount, 0)), channels.frames());
+        ctx.withSampleType([&](auto* tag) {
+            using SampleType = std::remove_pointer_t<decltype(tag)>;
+            for (uint32_t ch = 0; ch < channels.channelCount(); ++ch) {
+                auto* channel = channels.channel(ch);
+                auto* input = deliver && ctx.audioInBusCount() > 0 && ch < ctx.inputChannelCount(0)
+                    ? ctx.getInBuffer<SampleType>(0, ch)
+                    : nullptr;
+                if (input)
+                    for (size_t frame = 0; frame < count; ++frame)
+                        input[frame] += static_cast<SampleType>(channel[frame]);
+                std::fill_n(channel, count, 0.0);
+            }
+        });
     }
 
     void LatencyCompensationManagerImpl::afterTrackProcess(
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <functional>
 #include <memory>
@@ -13,6 +14,8 @@
 #include <uapmd-engine/detail/sequencer/AudioProcessingEventHandler.hpp>
 #include <uapmd-engine/detail/sequencer/SequencerProcessingLifecycleListener.hpp>
 
+#include "DelayLineArena.hpp"
+
 using namespace uapmd_plugin_hosting;
 
 namespace uapmd {
@@ -24,13 +27,36 @@ namespace uapmd {
         : public LatencyCompensationManager
         , public AudioProcessingEventHandler
         , public SequencerProcessingLifecycleListener {
-        struct OutputAlignmentDelayLine {
-            std::vector<std::vector<std::vector<float>>> buses;
-            size_t write_position{0};
-            size_t capacity_frames{0};
+        struct LineRange {
+            size_t first{0};
+            size_t count{0};
+
+            bool operator==(const LineRange&) const = default;
+        };
+
+        // Per track, indexes into the arena lines: one output alignment line
+        // per output bus, one line per send route, and the return input (a
+        // block of the return's input channels). Zero-delay paths get none.
+        struct BuffersLayout {
+            std::vector<DelayLineArena::LineSpec> lines;
+            std::vector<LineRange> output_alignment_lines;
+            std::vector<LineRange> send_lines;
+            std::vector<LineRange> return_inputs;
+
+            bool operator==(const BuffersLayout&) const = default;
+        };
+
+        // Everything the audio thread reads and writes for compensation, in
+        // one arena. A new set is built off the audio thread when the layout
+        // changes, and swapped in by beginBlock().
+        struct CompensationBuffers {
+            BuffersLayout layout;
+            DelayLineArena arena;
+            // Set off the audio thread, applied by beginBlock().
+            std::atomic<bool> clear_requested{false};
+            std::unique_ptr<std::atomic<bool>[]> track_clear_requested;
 
-            void reset();
-            void configure(AudioProcessContext* ctx, size_t delayFrames);
+            explicit CompensationBuffers(BuffersLayout bufferLayout);
         };
 
         size_t& audio_buffer_size_in_frames_;
@@ -51,7 +77,15 @@ namespace uapmd {
         std::atomic<bool>& is_playback_active_;
         std::atomic<int64_t>& playback_position_samples_;
         std::atomic<int64_t>& render_playback_position_samples_;
-        std::vector<OutputAlignmentDelayLine> output_alignment_delay_lines_{};
+        // Owned by the audio thread between swaps; staged and retired sets
+        // are owned by whoever holds the pointer and deleted off the audio
+        // thread. Two retired slots cover the swaps that can happen between
+        // two reclaimRetiredBuffers() calls.
+        std::atomic<CompensationBuffers*> buffers_{nullptr};
+        std::atomic<CompensationBuffers*> staged_buffers_{nullptr};
+        std::array<std::atomic<CompensationBuffers*>, 2> retired_buffers_{};
+        // The layout last staged; an unchanged layout keeps its buffers.
+        BuffersLayout buffers_layout_{};
         std::function<void(const std::function<void()>&)> run_mutation_{};
         std::function<AudioPluginInstanceAPI*(int32_t)> resolve_plugin_instance_{};
         std::function<void()> prepare_for_timing_change_{};
@@ -68,9 +102,20 @@ namespace uapmd {
         uint32_t maxRenderLeadInSamples() const;
         int64_t maxStopDrainInSamples() const;
         void schedulePrerollFromAudiblePosition(int64_t samples);
+        void stageBuffers(std::unique_ptr<CompensationBuffers> buffers);
+        void reclaimRetiredBuffers();
+        // The set the next block will use: the staged one if any.
+        CompensationBuffers* upcomingBuffers() const;
+        static void clearTrackBuffers(CompensationBuffers& buffers, size_t trackIndex) noexcept;
         void applyStateChange();
         void handlePluginTimingInfoChange(int32_t instanceId, remidy::PluginTimingInfoChange change);
         bool refreshGraphTimingInfo(int32_t instanceId);
+        void runSends(
+            uapmd_track_index_t trackIndex,
+            AudioProcessContext& ctx,
+            int32_t trackFrameCount,
+            bool admitted,
+            bool preFader) noexcept;
 
     public:
         LatencyCompensationManagerImpl(
@@ -84,6 +129,7 @@ namespace uapmd {
             std::function<void(const std::function<void()>&)> runMutation,
             std::function<AudioPluginInstanceAPI*(int32_t)> resolvePluginInstance,
             std::function<void()> prepareForTimingChange);
+        ~LatencyCompensationManagerImpl() override;
 
         void attachTrackRoutingManager(TrackRoutingManager& trackRoutingManager);
         void syncPluginTimingListeners();
@@ -118,10 +164,30 @@ namespace uapmd {
         void stopPlayback();
         void pausePlayback();
         void resumePlayback();
+        // Audio thread, before the first track of a block: swaps in staged
+        // buffers and applies pending clears.
+        void beginBlock() noexcept;
         void applyOutputAlignment(
             uapmd_track_index_t trackIndex,
             AudioProcessContext& ctx,
             int32_t trackFrameCount);
+        // Audio thread, between a source track's graph and its output
+        // alignment: feeds the pre-fader sends, applies a fader the graph
+        // deferred, then feeds the post-fader sends. An unadmitted (muted or
+        // solo-gated) track keeps its send delays running but adds nothing.
+        void captureTrackSends(
+            uapmd_track_index_t trackIndex,
+            AudioProcessContext& ctx,
+            int32_t trackFrameCount,
+            bool admitted,
+            uapmd_graph::webaudio_compat::GainNode* deferredFader) noexcept;
+        // Audio thread, before a return track's graph: adds the block's sends
+        // to its first input bus when `deliver` is set, and clears them.
+        void mixReturnInput(
+            uapmd_track_index_t trackIndex,
+            AudioProcessContext& ctx,
+            int32_t trackFrameCount,
+            bool deliver) noexcept;
 
         void afterTrackProcess(const TrackAudioProcessingEvent& event) noexcept override;
         void trackAdded(uapmd_track_index_t trackIndex) override;
@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <format>
+
+#include <choc/audio/choc_AudioFileFormat_FLAC.h>
+#include <choc/audio/choc_AudioFileFormat_WAV.h>
+#include <choc/audio/choc_SampleBuffers.h>
+
+#include "OfflineAudioFileWriter.hpp"
+
+namespace uapmd {
+
+OfflineEncoderPool::OfflineEncoderPool(uint32_t threadCount) {
+    threads_.reserve(std::max(threadCount, 1u));
+    for (uint32_t i = 0; i < std::max(threadCount, 1u); ++i)
+        threads_.emplace_back([this] { run(); });
+}
+
+OfflineEncoderPool::~OfflineEncoderPool() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_)
+        if (thread.joinable())
+            thread.join();
+}
+
+uint32_t OfflineEncoderPool::defaultThreadCount(uint32_t maximum) {
+    const auto hardware = std::thread::hardware_concurrency();
+    return std::clamp(hardware > 1 ? hardware - 1 : 1u, 1u, std::max(maximum, 1u));
+}
+
+void OfflineEncoderPool::schedule(OfflineAudioFileWriter* writer) {
+    {
+        std::lock_guard lock(mutex_);
+        ready_.push_back(writer);
+    }
+    wake_.notify_one();
+}
+
+void OfflineEncoderPool::run() {
+    while (true) {
+        OfflineAudioFileWriter* writer{nullptr};
+        {
+            std::unique_lock lock(mutex_);
+            wake_.wait(lock, [this] { return stopping_ || !ready_.empty(); });
+            // Writers wait for their queue before they go away, so anything
+            // still scheduled is drained even while stopping.
+            if (ready_.empty())
+                return;
+            writer = ready_.front();
+            ready_.pop_front();
+        }
+        writer->encodeQueued();
+    }
+}
+
+OfflineAudioFileWriter::OfflineAudioFileWriter(OfflineEncoderPool& pool)
+    : pool_(pool) {}
+
+OfflineAudioFileWriter::~OfflineAudioFileWriter() {
+    if (!finished_)
+        abandon();
+}
+
+bool OfflineAudioFileWriter::open(const std::filesystem::path& path,
+                                  OfflineRenderFileFormat format,
+                                  int32_t sampleRate,
+                                  uint32_t channelCount,
+                                  uint32_t maximumBlockFrames,
+                                  std::string& error) {
+    if (writer_) {
+        error = "Output file is already open.";
+        return false;
+    }
+    if (sampleRate <= 0 || channelCount == 0 || maximumBlockFrames == 0) {
+        error = "Output file settings are invalid.";
+        return false;
+    }
+
+    choc::audio::AudioFileProperties props;
+    props.sampleRate = static_cast<double>(sampleRate);
+    props.numChannels = channelCount;
+    try {
+        switch (resolveOfflineRenderFileFormat(format, path)) {
+        case OfflineRenderFileFormat::FLAC:
+            // FLAC stores integers only; 24 bits is the deepest choc encodes.
+            props.bitDepth = choc::audio::BitDepth::int24;
+            writer_ = choc::audio::FLACAudioFileFormat<true>().createWriter(path.string(), props);
+            break;
+        default:
+            props.bitDepth = choc::audio::BitDepth::float32;
+            writer_ = choc::audio::WAVAudioFileFormat<true>().createWriter(path.string(), props);
+            break;
+        }
+    } catch (const std::exception& e) {
+        error = e.what();
+        writer_.reset();
+    }
+    if (!writer_) {
+        if (error.empty())
+            error = "Failed to open output file for writing.";
+        std::error_code removeEc;
+        std::filesystem::remove(path, removeEc);
+        return false;
+    }
+
+    path_ = path;
+    channel_count_ = channelCount;
+    maximum_block_frames_ = maximumBlockFrames;
+    blocks_.resize(kQueuedBlockLimit);
+    free_.clear();
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        blocks_[i].samples.resize(static_cast<size_t>(channelCount) * maximumBlockFrames);
+        free_.push_back(i);
+    }
+    finished_ = false;
+    return true;
+}
+
+bool OfflineAudioFileWriter::append(const float* const* channels,
+                                    uint32_t channelCount,
+                                    int32_t frames,
+                                    std::string& error) {
+    if (!writer_) {
+        error = "Output file is not open.";
+        return false;
+    }
+    if (channelCount != channel_count_) {
+        error = std::format("Expected {} channels for the output file, got {}.", channel_count_, channelCount);
+        return false;
+    }
+
+    for (int32_t offset = 0; offset < frames;) {
+        const auto length = std::min<uint32_t>(static_cast<uint32_t>(frames - offset), maximum_block_frames_);
+        size_t index;
+        {
+            std::unique_lock lock(mutex_);
+            changed_.wait(lock, [this] { return !free_.empty() || !error_.empty(); });
+            if (!error_.empty()) {
+                error = error_;
+                return false;
+            }
+            index = free_.back();
+            free_.pop_back();
+        }
+
+        // The slot belongs to this thread until it is queued.
+        auto& block = blocks_[index];
+        for (uint32_t ch = 0; ch < channelCount; ++ch) {
+            auto* destination = block.samples.data() + static_cast<size_t>(ch) * maximum_block_frames_;
+            if (channels[ch])
+                std::copy_n(channels[ch] + offset, length, destination);
+            else
+                std::fill_n(destination, length, 0.0f);
+        }
+        block.frames = length;
+
+        bool schedule = false;
+        {
+            std::lock_guard lock(mutex_);
+            queued_.push_back(index);
+            schedule = !scheduled_;
+            scheduled_ = true;
+        }
+        if (schedule)
+            pool_.schedule(this);
+        offset += static_cast<int32_t>(length);
+    }
+    return true;
+}
+
+void OfflineAudioFileWriter::encodeQueued() {
+    std::vector<float*> channels(channel_count_);
+    std::unique_lock lock(mutex_);
+    while (!queued_.empty()) {
+        const auto index = queued_.front();
+        queued_.pop_front();
+        if (!discarding_ && error_.empty()) {
+            lock.unlock();
+            auto& block = blocks_[index];
+            for (uint32_t ch = 0; ch < channel_count_; ++ch)
+                channels[ch] = block.samples.data() + static_cast<size_t>(ch) * maximum_block_frames_;
+            bool written = false;
+            std::string failure;
+            try {
+                written = writer_->appendFrames(
+                    choc::buffer::createChannelArrayView(channels.data(), channel_count_, block.frames));
+            } catch (const std::exception& e) {
+                failure = e.what();
+            }
+            lock.lock();
+            if (!written)
+                error_ = failure.empty() ? std::format("Failed to write {}.", path_.string()) : failure;
+        }
+        free_.push_back(index);
+        changed_.notify_all();
+    }
+    scheduled_ = false;
+    changed_.notify_all();
+}
+
+void OfflineAudioFileWriter::waitUntilIdle(std::unique_lock<std::mutex>& lock) {
+    changed_.wait(lock, [this] { return !scheduled_; });
+}
+
+void OfflineAudioFileWriter::close() {
+    if (!writer_)
+        return;
+    try {
+        writer_->flush();
+    } catch (const std::exception& e) {
+        if (error_.empty())
+            error_ = e.what();
+    }
+    writer_.reset();
+}
+
+bool OfflineAudioFileWriter::finish(std::string& error) {
+    if (!writer_) {
+        error = "Output file is not open.";
+        return false;
+    }
+    {
+        std::unique_lock lock(mutex_);
+        waitUntilIdle(lock);
+    }
+    close();
+    if (!error_.empty()) {
+        error = error_;
+        abandon();
+        return false;
+    }
+    finished_ = true;
+    return true;
+}
+
+void OfflineAudioFileWriter::abandon() {
+    {
+        std::unique_lock lock(mutex_);
+        discarding_ = true;
+        waitUntilIdle(lock);
+    }
+    writer_.reset();
+    if (!path_.empty()) {
+        std::error_code removeEc;
+        std::filesystem::remove(path_, removeEc);
+    }
+    path_.clear();
+    finished_ = true;
+}
+
+} // namespace uapmd
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "uapmd-engine/uapmd-engine.hpp"
+
+namespace choc::audio { class AudioFileWriter; }
+
+namespace uapmd {
+
+class OfflineAudioFileWriter;
+
+// Worker threads that encode queued render blocks. Any number of writers can
+// share a pool; a writer is encoded by at most one thread at a time, so its
+// blocks reach the file in order.
+class OfflineEncoderPool {
+public:
+    explicit OfflineEncoderPool(uint32_t threadCount);
+    ~OfflineEncoderPool();
+    OfflineEncoderPool(const OfflineEncoderPool&) = delete;
+    OfflineEncoderPool& operator=(const OfflineEncoderPool&) = delete;
+
+    // One thread less than the hardware offers, leaving one to the renderer,
+    // and at most `maximum`.
+    static uint32_t defaultThreadCount(uint32_t maximum);
+
+private:
+    friend class OfflineAudioFileWriter;
+    void schedule(OfflineAudioFileWriter* writer);
+    void run();
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<OfflineAudioFileWriter*> ready_;
+    bool stopping_{false};
+    std::vector<std::thread> threads_;
+};
+
+// Streams rendered audio into a WAV or FLAC file while the renderer keeps
+// going. append() copies the block into one of a fixed number of slots and
+// returns; the pool encodes and writes it. When every slot is queued, append()
+// waits for the encoder, so memory use does not grow with the render length.
+class OfflineAudioFileWriter {
+public:
+    static constexpr uint32_t kQueuedBlockLimit = 16;
+
+    explicit OfflineAudioFileWriter(OfflineEncoderPool& pool);
+    // Abandons the file unless finish() succeeded.
+    ~OfflineAudioFileWriter();
+    OfflineAudioFileWriter(const OfflineAudioFileWriter&) = delete;
+    OfflineAudioFileWriter& operator=(const OfflineAudioFileWriter&) = delete;
+
+    bool open(const std::filesystem::path& path,
+              OfflineRenderFileFormat format,
+              int32_t sampleRate,
+              uint32_t channelCount,
+              uint32_t maximumBlockFrames,
+              std::string& error);
+    bool isOpen() const { return writer_ != nullptr; }
+    // Blocks longer than maximumBlockFrames are queued in pieces.
+    bool append(const float* const* channels, uint32_t channelCount, int32_t frames, std::string& error);
+    // Waits for the queued blocks and closes the file.
+    bool finish(std::string& error);
+    // Drops the queued blocks, closes and removes the file.
+    void abandon();
+
+private:
+    friend class OfflineEncoderPool;
+    struct Block {
+        std::vector<float> samples; // planar, maximum_block_frames_ per channel
+        uint32_t frames{0};
+    };
+
+    // Pool thread: writes queued blocks until the queue is empty.
+    void encodeQueued();
+    void waitUntilIdle(std::unique_lock<std::mutex>& lock);
+    void close();
+
+    OfflineEncoderPool& pool_;
+    std::filesystem::path path_;
+    std::unique_ptr<choc::audio::AudioFileWriter> writer_;
+    uint32_t channel_count_{0};
+    uint32_t maximum_block_frames_{0};
+    std::vector<Block> blocks_;
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::deque<size_t> queued_;
+    std::vector<size_t> free_;
+    bool scheduled_{false};
+    bool discarding_{false};
+    std::string error_;
+    bool finished_{false};
+};
+
+} // namespace uapmd
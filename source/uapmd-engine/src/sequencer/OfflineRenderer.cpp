@@ -1,17 +1,18 @@
 #include <algorithm>
+#include <cctype>
 #include <cmath>
 #include <cstring>
 #include <filesystem>
 #include <format>
+#include <memory>
 #include <optional>
 #include <vector>
 
-#include <choc/audio/choc_AudioFileFormat_WAV.h>
-#include <choc/audio/choc_SampleBuffers.h>
 #include <remidy/remidy.hpp>
 #include <uapmd-data/uapmd-data.hpp>
 #include <uapmd-engine/uapmd-engine.hpp>
 
+#include "OfflineAudioFileWriter.hpp"
 #include "StopDrainUtilities.hpp"
 
 using namespace uapmd_graph;
@@ -101,6 +102,16 @@ private:
 
 } // namespace
 
+OfflineRenderFileFormat resolveOfflineRenderFileFormat(OfflineRenderFileFormat format,
+                                                       const std::filesystem::path& path) {
+    if (format != OfflineRenderFileFormat::FROM_EXTENSION)
+        return format;
+    auto extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".flac" ? OfflineRenderFileFormat::FLAC : OfflineRenderFileFormat::WAV;
+}
+
 OfflineRenderResult renderOfflineProject(SequencerEngine& engine,
                                          const OfflineRenderSettings& settings,
                                          const OfflineRenderCallbacks& callbacks) {
@@ -208,18 +219,16 @@ OfflineRenderResult renderOfflineProject(SequencerEngine& engine,
         remidy::AudioProcessContext deviceContext(masterContext, settings.umpBufferSize);
         deviceContext.configureMainBus(settings.outputChannels, settings.outputChannels, settings.bufferSize);
 
-        choc::audio::AudioFileProperties props;
-        props.sampleRate = static_cast<double>(settings.sampleRate);
-        props.numChannels = settings.outputChannels;
-        props.bitDepth = choc::audio::BitDepth::float32;
-
-        auto writer = choc::audio::WAVAudioFileFormat<true>().createWriter(settings.outputPath.string(), props);
-        if (!writer) {
-            result.errorMessage = "Failed to open output file for writing.";
-            std::error_code removeEc;
-            std::filesystem::remove(settings.outputPath, removeEc);
+        // Encoding runs on its own thread, overlapping with the graph.
+        OfflineEncoderPool encoderPool(1);
+        OfflineAudioFileWriter writer(encoderPool);
+        if (!writer.open(settings.outputPath,
+                         settings.fileFormat,
+                         settings.sampleRate,
+                         settings.outputChannels,
+                         settings.bufferSize,
+                         result.errorMessage))
             return result;
-        }
 
         int64_t currentSample = startSample;
         int64_t silenceFramesAccumulated = 0;
@@ -281,8 +290,11 @@ OfflineRenderResult renderOfflineProject(SequencerEngine& engine,
                     silenceFramesAccumulated += framesToRender;
             }
 
-            auto view = choc::buffer::createChannelArrayView(channelPtrs.data(), settings.outputChannels, framesToRender);
-            writer->appendFrames(view);
+            if (!writer.append(channelPtrs.data(),
+                               settings.outputChannels,
+                               static_cast<int32_t>(framesToRender),
+                               result.errorMessage))
+                return result;
 
             currentSample += framesToRender;
 
@@ -306,14 +318,13 @@ OfflineRenderResult renderOfflineProject(SequencerEngine& engine,
             }
         }
 
-        writer->flush();
-
         if (result.canceled) {
-            std::error_code removeEc;
-            std::filesystem::remove(settings.outputPath, removeEc);
+            writer.abandon();
             result.errorMessage = "Render canceled.";
             return result;
         }
+        if (!writer.finish(result.errorMessage))
+            return result;
 
         result.success = true;
         result.renderedSeconds = static_cast<double>(std::max<int64_t>(0, currentSample - startSample)) /
@@ -327,4 +338,110 @@ OfflineRenderResult renderOfflineProject(SequencerEngine& engine,
     }
 }
 
+OfflineStemRenderResult renderOfflineStems(SequencerEngine& engine,
+                                           const OfflineStemRenderSettings& settings,
+                                           const OfflineRenderCallbacks& callbacks) {
+    OfflineStemRenderResult result;
+
+    if (settings.stems.empty()) {
+        result.errorMessage = "No stems to render.";
+        return result;
+    }
+    for (const auto& stem : settings.stems) {
+        if (stem.outputPath.empty()) {
+            result.errorMessage = "Output path is empty.";
+            return result;
+        }
+        if (stem.outputPath.parent_path().empty())
+            continue;
+        std::error_code dirEc;
+        std::filesystem::create_directories(stem.outputPath.parent_path(), dirEc);
+        if (dirEc) {
+            result.errorMessage = std::format("Cannot create output directory: {}", dirEc.message());
+            return result;
+        }
+    }
+
+    constexpr uint32_t kMaximumDefaultEncoderThreads = 4;
+    OfflineEncoderPool encoderPool(settings.encoderThreads > 0
+        ? settings.encoderThreads
+        : OfflineEncoderPool::defaultThreadCount(kMaximumDefaultEncoderThreads));
+    // A stem's last blocks are still being encoded while the next track
+    // renders; each writer holds at most kQueuedBlockLimit blocks.
+    std::vector<std::unique_ptr<OfflineAudioFileWriter>> writers;
+    writers.reserve(settings.stems.size());
+
+    const auto stemCount = static_cast<double>(settings.stems.size());
+    for (size_t stemIndex = 0; stemIndex < settings.stems.size(); ++stemIndex) {
+        const auto& stem = settings.stems[stemIndex];
+        auto& writer = *writers.emplace_back(std::make_unique<OfflineAudioFileWriter>(encoderPool));
+
+        OfflineTrackRenderSettings trackSettings;
+        trackSettings.trackIndex = stem.trackIndex;
+        trackSettings.startSample = settings.startSample;
+        trackSettings.endSample = settings.endSample;
+        trackSettings.sampleRate = settings.sampleRate;
+        trackSettings.bufferSize = settings.bufferSize;
+        trackSettings.umpBufferSize = settings.umpBufferSize;
+        // The channel count is only known once the track render has begun.
+        trackSettings.blockSink = [&writer, &stem, &settings](const float* const* channels,
+                                                              uint32_t channelCount,
+                                                              int32_t frameCount,
+                                                              std::string& error) {
+            if (!writer.isOpen() &&
+                !writer.open(stem.outputPath,
+                             settings.fileFormat,
+                             settings.sampleRate,
+                             channelCount,
+                             settings.bufferSize,
+                             error))
+                return false;
+            return writer.append(channels, channelCount, frameCount, error);
+        };
+
+        OfflineRenderCallbacks trackCallbacks;
+        trackCallbacks.shouldCancel = callbacks.shouldCancel;
+        if (callbacks.onProgress) {
+            trackCallbacks.onProgress = [&callbacks, stemIndex, stemCount](const OfflineRenderProgress& trackProgress) {
+                auto progress = trackProgress;
+                progress.progress = std::clamp(
+                    (static_cast<double>(stemIndex) + trackProgress.progress) / stemCount,
+                    0.0,
+                    1.0);
+                callbacks.onProgress(progress);
+            };
+        }
+
+        auto trackResult = engine.renderOfflineTrack(trackSettings, trackCallbacks);
+        if (trackResult.canceled) {
+            result.canceled = true;
+            result.errorMessage = "Render canceled.";
+            return result;
+        }
+        if (!trackResult.success) {
+            result.errorMessage = trackResult.errorMessage.empty()
+                ? "Track render failed."
+                : std::move(trackResult.errorMessage);
+            return result;
+        }
+        if (!writer.isOpen()) {
+            result.errorMessage = "Track render produced no audio.";
+            return result;
+        }
+    }
+
+    for (auto& writer : writers) {
+        if (!writer->finish(result.errorMessage)) {
+            // Do not leave a partial set of stems behind.
+            for (auto& other : writers)
+                other->abandon();
+            return result;
+        }
+    }
+    result.success = true;
+    for (const auto& stem : settings.stems)
+        result.outputPaths.push_back(stem.outputPath);
+    return result;
+}
+
 } // namespace uapmd
@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <thread>
+
+#include <choc/text/choc_JSON.h>
+#include <uapmd-engine/uapmd-engine.hpp>
+
+namespace uapmd {
+
+    namespace {
+        constexpr std::string_view kProjectSettingsKey{"parameter_automation"};
+    }
+
+    ParameterAutomationManager::ParameterAutomationManager(SequencerEngine& engine)
+        : engine_(engine) {
+    }
+
+    ParameterAutomationManager::~ParameterAutomationManager() = default;
+
+    bool ParameterAutomationManager::setLane(
+            int32_t instanceId,
+            int32_t parameterIndex,
+            std::vector<AutomationPoint> points) {
+        if (points.empty())
+            return removeLane(instanceId, parameterIndex);
+        if (parameterIndex < 0 || engine_.findTrackIndexForInstance(instanceId) < 0)
+            return false;
+        auto curve = std::make_shared<const AutomationCurve>(std::move(points));
+        auto it = std::ranges::find_if(lanes_, [&](const Lane& lane) {
+            return lane.instanceId == instanceId && lane.parameterIndex == parameterIndex;
+        });
+        if (it != lanes_.end())
+            it->curve = std::move(curve);
+        else
+            lanes_.push_back({instanceId, parameterIndex, std::move(curve)});
+        publish();
+        return true;
+    }
+
+    bool ParameterAutomationManager::removeLane(int32_t instanceId, int32_t parameterIndex) {
+        const auto removed = std::erase_if(lanes_, [&](const Lane& lane) {
+            return lane.instanceId == instanceId && lane.parameterIndex == parameterIndex;
+        });
+        if (removed == 0)
+            return false;
+        publish();
+        return true;
+    }
+
+    std::vector<ParameterAutomationLane> ParameterAutomationManager::lanes(uapmd_track_index_t trackIndex) const {
+        std::vector<ParameterAutomationLane> result;
+        for (const auto& lane : lanes_)
+            if (engine_.findTrackIndexForInstance(lane.instanceId) == trackIndex)
+                result.push_back({lane.instanceId, lane.parameterIndex, lane.curve->points()});
+        return result;
+    }
+
+    void ParameterAutomationManager::render(
+            uapmd_track_index_t trackIndex,
+            int64_t renderStartSample,
+            int32_t destinationOffsetFrames,
+            int32_t frameCount,
+            std::vector<ParameterAutomationEvent>& events,
+            size_t readerIndex) const noexcept {
+        const auto snapshot = snapshot_.protect(readerIndex);
+        if (!snapshot || trackIndex < 0 || static_cast<size_t>(trackIndex) >= snapshot->size() ||
+            readerIndex >= kReaderCount)
+            return;
+        const auto epoch = restate_epoch_.load(std::memory_order_acquire) +
+            (readerIndex == kLiveReader ? live_transport_generation_.load(std::memory_order_relaxed) : 0);
+        for (const auto& lane : (*snapshot)[static_cast<size_t>(trackIndex)].lanes) {
+            auto& cursor = lane.cursors[readerIndex];
+            // Anything but the continuation of the previous render restates.
+            bool restate = cursor.epoch != epoch || cursor.nextSample != renderStartSample;
+            bool dropped = false;
+            lane.curve->forEachChange(renderStartSample, frameCount, kRampStepFrames,
+                [&](int32_t frame, double value) {
+                    if (!restate && value == cursor.value)
+                        return;
+                    // push_back must never reallocate here.
+                    if (events.size() >= events.capacity()) {
+                        dropped = true;
+                        dropped_events_.fetch_add(1, std::memory_order_relaxed);
+                        return;
+                    }
+                    events.push_back({lane.instanceId, lane.parameterIndex, destinationOffsetFrames + frame, value});
+                    cursor.value = value;
+                    restate = false;
+                });
+            cursor.epoch = epoch;
+            cursor.nextSample = dropped ? -1 : renderStartSample + frameCount;
+        }
+    }
+
+    void ParameterAutomationManager::apply(
+            uapmd_track_index_t trackIndex,
+            std::vector<ParameterAutomationEvent>& events,
+            size_t readerIndex) const noexcept {
+        if (events.empty())
+            return;
+        const auto snapshot = snapshot_.protect(readerIndex);
+        if (snapshot && trackIndex >= 0 && static_cast<size_t>(trackIndex) < snapshot->size()) {
+            const auto& instances = (*snapshot)[static_cast<size_t>(trackIndex)].instances;
+            // Lanes were rendered one after another; formats want each block's
+            // events in time order.
+            std::ranges::sort(events, {}, &ParameterAutomationEvent::frameOffset);
+            for (const auto& event : events) {
+                const auto it = std::ranges::find(instances, event.instanceId,
+                    &std::pair<int32_t, uapmd_plugin_hosting::AudioPluginInstanceAPI*>::first);
+                if (it != instances.end() && it->second)
+                    it->second->enqueueParameterValueRT(event.parameterIndex, event.value, event.frameOffset);
+            }
+        }
+        events.clear();
+    }
+
+    void ParameterAutomationManager::trackRemoved(uapmd_track_index_t) {
+        // Runs while the audio thread is held off, so the snapshot can drop
+        // the track's plug-ins before anything resolves events against them.
+        std::erase_if(lanes_, [this](const Lane& lane) {
+            return engine_.findTrackIndexForInstance(lane.instanceId) < 0;
+        });
+        publish();
+    }
+
+    void ParameterAutomationManager::pluginInstanceWillBeDestroyed(int32_t instanceId) {
+        std::erase_if(lanes_, [instanceId](const Lane& lane) { return lane.instanceId == instanceId; });
+        // The instance is still on its track at this point; leave it out of
+        // the snapshot explicitly.
+        publish(instanceId);
+    }
+
+    void ParameterAutomationManager::pluginGraphChanged() {
+        publish();
+    }
+
+    void ParameterAutomationManager::audioProcessingConfigurationChanged() {
+        restateAll();
+    }
+
+    void ParameterAutomationManager::trackProcessingStateReset(uapmd_track_index_t) {
+        restateAll();
+    }
+
+    void ParameterAutomationManager::processingStateReset() {
+        restateAll();
+    }
+
+    void ParameterAutomationManager::transportTransition(SequencerTransportTransition, int64_t) {
+        restateAll();
+    }
+
+    void ParameterAutomationManager::publish(int32_t destroyedInstanceId) {
+        auto snapshot = std::make_unique<RtSnapshot>();
+        auto& tracks = engine_.tracks();
+        snapshot->resize(tracks.size());
+        for (size_t i = 0; i < tracks.size(); ++i) {
+            if (!tracks[i])
+                continue;
+            for (const auto instanceId : tracks[i]->orderedInstanceIds())
+                if (instanceId != destroyedInstanceId)
+                    (*snapshot)[i].instances.emplace_back(instanceId, engine_.getPluginInstance(instanceId));
+        }
+        for (const auto& lane : lanes_) {
+            const auto trackIndex = engine_.findTrackIndexForInstance(lane.instanceId);
+            if (trackIndex >= 0 && static_cast<size_t>(trackIndex) < snapshot->size())
+                (*snapshot)[static_cast<size_t>(trackIndex)].lanes.push_back(
+                    {lane.instanceId, lane.parameterIndex, lane.curve});
+        }
+        snapshot_.publish(std::move(snapshot));
+        if (destroyedInstanceId < 0)
+            return;
+        // Blocks rendered before this publish may still carry events for the
+        // instance; wait until no reader can resolve them against it.
+        while (snapshot_.hasRetired()) {
+            std::this_thread::yield();
+            snapshot_.reclaimRetired();
+        }
+    }
+
+    bool ParameterAutomationManager::saveProjectData(UapmdProjectData& project, std::string&) {
+        auto lanes = choc::value::createEmptyArray();
+        auto& tracks = engine_.tracks();
+        for (const auto& lane : lanes_) {
+            const auto trackIndex = engine_.findTrackIndexForInstance(lane.instanceId);
+            if (trackIndex < 0 || static_cast<size_t>(trackIndex) >= tracks.size())
+                continue;
+            // Instance ids are not stable across sessions; the plug-in's
+            // position on its track is.
+            const auto& ids = tracks[static_cast<size_t>(trackIndex)]->orderedInstanceIds();
+            const auto plugin = std::ranges::find(ids, lane.instanceId) - ids.begin();
+            auto points = choc::value::createEmptyArray();
+            for (const auto& point : lane.curve->points()) {
+                auto entry = choc::value::createObject("AutomationPoint");
+                entry.addMember("sample", point.samplePosition);
+                entry.addMember("value", point.value);
+                entry.addMember("hold", point.interpolation == AutomationInterpolation::Hold);
+                points.addArrayElement(entry);
+            }
+            auto entry = choc::value::createObject("ParameterAutomationLane");
+            entry.addMember("track", trackIndex);
+            entry.addMember("plugin", static_cast<int32_t>(plugin));
+            entry.addMember("parameter", lane.parameterIndex);
+            entry.addMember("points", points);
+            lanes.addArrayElement(entry);
+        }
+        if (lanes.size() == 0) {
+            project.settings().erase(std::string(kProjectSettingsKey));
+            return true;
+        }
+        auto value = choc::value::createObject("ParameterAutomation");
+        value.addMember("lanes", lanes);
+        project.settings()[std::string(kProjectSettingsKey)] =
+            choc::json::toString(value, false);
+        return true;
+    }
+
+    bool ParameterAutomationManager::loadProjectData(UapmdProjectData& project, std::string& error) {
+        std::vector<Lane> loaded;
+        const auto it = project.settings().find(std::string(kProjectSettingsKey));
+        if (it != project.settings().end()) {
+            try {
+                const auto value = choc::json::parse(it->second);
+                if (!value.isObject()) {
+                    error = "Parameter automation settings must be an object.";
+                    return false;
+                }
+                auto& tracks = engine_.tracks();
+                if (value.hasObjectMember("lanes") && value["lanes"].isArray())
+                    for (const auto& entry : value["lanes"]) {
+                        if (!entry.isObject())
+                            continue;
+                        // Lanes whose plug-in did not load are dropped one by
+                        // one rather than failing the whole project.
+                        const auto trackIndex = entry["track"].getWithDefault<int32_t>(-1);
+                        const auto plugin = entry["plugin"].getWithDefault<int32_t>(-1);
+                        const auto parameterIndex = entry["parameter"].getWithDefault<int32_t>(-1);
+                        if (trackIndex < 0 || static_cast<size_t>(trackIndex) >= tracks.size() ||
+                            !tracks[static_cast<size_t>(trackIndex)] || plugin < 0 || parameterIndex < 0)
+                            continue;
+                        const auto& ids = tracks[static_cast<size_t>(trackIndex)]->orderedInstanceIds();
+                        if (static_cast<size_t>(plugin) >= ids.size())
+                            continue;
+                        std::vector<AutomationPoint> points;
+                        if (entry.hasObjectMember("points") && entry["points"].isArray())
+                            for (const auto& point : entry["points"]) {
+                                if (!point.isObject())
+                                    continue;
+                                points.push_back({
+                                    point["sample"].getWithDefault<int64_t>(0),
+                                    point["value"].getWithDefault<double>(0.0),
+                                    point["hold"].getWithDefault<bool>(false)
+                                        ? AutomationInterpolation::Hold
+                                        : AutomationInterpolation::Linear});
+                            }
+                        if (points.empty())
+                            continue;
+                        loaded.push_back({ids[static_cast<size_t>(plugin)], parameterIndex,
+                                          std::make_shared<const AutomationCurve>(std::move(points))});
+                    }
+            } catch (const std::exception& exception) {
+                error = exception.what();
+                return false;
+            }
+        }
+        lanes_ = std::move(loaded);
+        publish();
+        return true;
+    }
+
+}
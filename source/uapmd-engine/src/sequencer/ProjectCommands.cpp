@@ -57,6 +57,11 @@ namespace uapmd {
         return executeClip<ClipAudioWarpsProperty>(trackIndex, clipId, std::move(audioWarps), origin);
     }
 
+    bool ProjectCommandsImpl::setClipRegion(
+        int32_t trackIndex, int32_t clipId, const ClipRegion& region, ProjectMutationOrigin origin) {
+        return executeClip<ClipRegionProperty>(trackIndex, clipId, region, origin);
+    }
+
     bool ProjectCommandsImpl::setTrackGain(
         int32_t trackIndex, double gain, ProjectMutationOrigin origin) {
         return executeTrack<TrackGainProperty>(trackIndex, gain, origin);
@@ -90,6 +95,11 @@ namespace uapmd {
         return executePlugin<PluginBypassedProperty>(instanceId, bypassed, origin);
     }
 
+    bool ProjectCommandsImpl::setPluginSleepsWhenSilent(
+        int32_t instanceId, bool sleepsWhenSilent, ProjectMutationOrigin origin) {
+        return executePlugin<PluginSleepsWhenSilentProperty>(instanceId, sleepsWhenSilent, origin);
+    }
+
     bool ProjectCommandsImpl::setPluginParameterValue(
         int32_t instanceId, int32_t parameterIndex, double value, ProjectMutationOrigin origin) {
         auto plugin = target_.addresses().pluginAddress(instanceId);
@@ -42,6 +42,7 @@ namespace uapmd {
         bool setClipNeedsFileSave(int32_t, int32_t, bool, ProjectMutationOrigin) override;
         bool setClipMarkers(int32_t, int32_t, std::vector<ClipMarker>, ProjectMutationOrigin) override;
         bool setClipAudioWarps(int32_t, int32_t, std::vector<AudioWarpPoint>, ProjectMutationOrigin) override;
+        bool setClipRegion(int32_t, int32_t, const ClipRegion&, ProjectMutationOrigin) override;
 
         bool setTrackGain(int32_t, double, ProjectMutationOrigin) override;
         bool setTrackMuted(int32_t, bool, ProjectMutationOrigin) override;
@@ -50,6 +51,7 @@ namespace uapmd {
         bool setTrackFreezePolicyEnabled(int32_t, bool, ProjectMutationOrigin) override;
 
         bool setPluginBypassed(int32_t, bool, ProjectMutationOrigin) override;
+        bool setPluginSleepsWhenSilent(int32_t, bool, ProjectMutationOrigin) override;
         bool setPluginParameterValue(int32_t, int32_t, double, ProjectMutationOrigin) override;
         bool setPluginPerNoteControllerValue(
             int32_t,
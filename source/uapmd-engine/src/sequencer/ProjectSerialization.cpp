@@ -227,6 +227,16 @@ namespace uapmd::sequencer_detail {
 
             return clip;
         }
+
+        bool fileHasContents(const std::filesystem::path& path, const std::vector<uint8_t>& expected) {
+            std::error_code ec;
+            if (std::filesystem::file_size(path, ec) != expected.size() || ec)
+                return false;
+            std::ifstream in(path, std::ios::binary);
+            std::vector<uint8_t> actual(expected.size());
+            in.read(reinterpret_cast<char*>(actual.data()), static_cast<std::streamsize>(actual.size()));
+            return in && actual == expected;
+        }
     } // namespace
 
     std::filesystem::path makeRelativePath(
@@ -257,9 +267,6 @@ namespace uapmd::sequencer_detail {
     std::string writePluginStateBlob(
         const std::filesystem::path& projectDir,
         const std::filesystem::path& pluginStateDir,
-        const std::string& scopeLabel,
-        size_t pluginOrder,
-        int32_t instanceId,
         const std::vector<uint8_t>& stateData,
         std::string& error) {
         std::error_code createDirEc;
@@ -271,23 +278,38 @@ namespace uapmd::sequencer_detail {
             return {};
         }
 
-        auto filename = std::format("{}_plugin{}_instance{}.state",
-                                    scopeLabel,
-                                    pluginOrder,
-                                    instanceId);
-        auto targetPath = pluginStateDir / filename;
-
-        try {
-            std::ofstream out(targetPath, std::ios::binary);
-            if (!out)
-                throw std::runtime_error("Failed to open state file for writing");
-            out.write(reinterpret_cast<const char*>(stateData.data()),
-                      static_cast<std::streamsize>(stateData.size()));
-        } catch (const std::exception& ex) {
-            error = std::format("Failed to write plugin state to {}: {}",
-                                targetPath.string(),
-                                ex.what());
-            return {};
+        // The name is only a hash, so an existing file is reused when its bytes
+        // match and a colliding one is stepped past with a numbered variant.
+        const auto id = ProjectChunkId::of(stateData);
+        std::filesystem::path targetPath;
+        bool alreadyWritten = false;
+        for (uint32_t variant = 0; ; ++variant) {
+            targetPath = pluginStateDir / (variant == 0
+                ? std::format("{:016x}-{}.state", id.hash, id.size)
+                : std::format("{:016x}-{}-{}.state", id.hash, id.size, variant));
+            std::error_code existingEc;
+            if (!std::filesystem::exists(targetPath, existingEc))
+                break;
+            if (fileHasContents(targetPath, stateData)) {
+                alreadyWritten = true;
+                break;
+            }
+        }
+        if (!alreadyWritten) {
+            try {
+                std::ofstream out(targetPath, std::ios::binary);
+                if (!out)
+                    throw std::runtime_error("Failed to open state file for writing");
+                out.write(reinterpret_cast<const char*>(stateData.data()),
+                          static_cast<std::streamsize>(stateData.size()));
+                if (!out)
+                    throw std::runtime_error("Failed to write state file");
+            } catch (const std::exception& ex) {
+                error = std::format("Failed to write plugin state to {}: {}",
+                                    targetPath.string(),
+                                    ex.what());
+                return {};
+            }
         }
 
         auto recordedPath = targetPath;
@@ -296,6 +318,44 @@ namespace uapmd::sequencer_detail {
         return recordedPath.generic_string();
     }
 
+    bool isPluginStateBlobName(std::string_view filename) {
+        // <16 lowercase hex digits>-<size>[-<variant>].state
+        constexpr std::string_view kSuffix = ".state";
+        if (!filename.ends_with(kSuffix))
+            return false;
+        filename.remove_suffix(kSuffix.size());
+        if (filename.size() < 18 || filename[16] != '-')
+            return false;
+        auto isLowerHex = [](char c) { return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'); };
+        if (!std::all_of(filename.begin(), filename.begin() + 16, isLowerHex))
+            return false;
+        auto isNumber = [](std::string_view text) {
+            return !text.empty()
+                && std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; });
+        };
+        const auto numbers = filename.substr(17);
+        const auto dash = numbers.find('-');
+        if (dash == std::string_view::npos)
+            return isNumber(numbers);
+        return isNumber(numbers.substr(0, dash)) && isNumber(numbers.substr(dash + 1));
+    }
+
+    void removeUnreferencedPluginStateBlobs(
+        const std::filesystem::path& pluginStateDir,
+        const std::unordered_set<std::string>& referencedFilenames) {
+        std::error_code ec;
+        std::vector<std::filesystem::path> stale;
+        for (std::filesystem::directory_iterator it(pluginStateDir, ec), end; !ec && it != end; it.increment(ec)) {
+            const auto filename = it->path().filename().string();
+            if (isPluginStateBlobName(filename) && !referencedFilenames.contains(filename))
+                stale.push_back(it->path());
+        }
+        for (const auto& path : stale) {
+            std::error_code removeEc;
+            std::filesystem::remove(path, removeEc);
+        }
+    }
+
     bool serializeProjectClip(
         TimelineTrack& timelineTrack,
         const ClipData& clip,
@@ -308,6 +368,7 @@ namespace uapmd::sequencer_detail {
         const std::string& clipContextLabel,
         bool includeTimelineMeta,
         size_t& midiExportCounter,
+        ProjectChunkContainerWriter* chunkWriter,
         std::string& error) {
         auto projectClip = UapmdProjectClipData::create();
         projectClip->referenceId(clip.referenceId);
@@ -316,10 +377,33 @@ namespace uapmd::sequencer_detail {
         projectClip->markers(clip.markers);
         projectClip->audioWarps(clip.audioWarps);
         projectClip->durationSamples(clip.durationSamples);
+        projectClip->region(clip.region);
 
         std::filesystem::path clipPath = clip.filepath;
         if (clip.clipType == ClipType::Midi) {
             bool needsExport = clip.needsFileSave || clipPath.empty() || !std::filesystem::exists(clipPath);
+            if (needsExport && chunkWriter) {
+                auto sourceNode = timelineTrack.getSourceNode(clip.sourceNodeInstanceId);
+                auto* midiNode = dynamic_cast<MidiClipSourceNode*>(sourceNode.get());
+                if (!midiNode) {
+                    error = std::format("{} is missing MIDI data", clipContextLabel);
+                    return false;
+                }
+
+                std::string encodeError;
+                auto clipBytes = Smf2ClipReaderWriter::encode(
+                    buildSmf2ClipFromMidiNode(*midiNode, includeTimelineMeta), &encodeError);
+                if (!clipBytes) {
+                    error = std::move(encodeError);
+                    return false;
+                }
+                // A chunk reference is not a path, so it skips the
+                // project-relative rewrite below.
+                projectClip->file(chunkWriter->add(std::move(*clipBytes)));
+                serializedClipLookup[clip.referenceId] = projectClip.get();
+                projectTrack.clips().push_back(std::move(projectClip));
+                return true;
+            }
             if (needsExport) {
                 std::filesystem::create_directories(clipDir);
                 auto exportName = std::format("{}{}_{}.midi2",
@@ -439,6 +523,11 @@ namespace uapmd::sequencer_detail {
         return true;
     }
 
+    std::filesystem::path FilesystemProjectSerializationWriteContext::extensionDataDirectory(
+        std::string_view extensionId) const {
+        return extensionDataRoot(project_dir_, extensionId);
+    }
+
     FilesystemProjectSerializationReadContext::FilesystemProjectSerializationReadContext(
         std::filesystem::path projectFile,
         std::filesystem::path projectDir)
@@ -454,6 +543,11 @@ namespace uapmd::sequencer_detail {
         return project_dir_;
     }
 
+    std::filesystem::path FilesystemProjectSerializationReadContext::extensionDataDirectory(
+        std::string_view extensionId) const {
+        return extensionDataRoot(project_dir_, extensionId);
+    }
+
     std::optional<std::vector<uint8_t>> FilesystemProjectSerializationReadContext::readExtensionFile(
         std::string_view extensionId,
         const std::filesystem::path& relativePath,
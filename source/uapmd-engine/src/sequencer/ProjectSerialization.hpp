@@ -6,6 +6,7 @@
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "uapmd-engine/uapmd-engine.hpp"
@@ -18,15 +19,23 @@ namespace uapmd::sequencer_detail {
 
     std::vector<ClipData> sortedTrackClips(TimelineTrack& timelineTrack);
 
+    // State files are named by content, so a state shared by several plug-ins
+    // or unchanged since the previous save is written once.
     std::string writePluginStateBlob(
         const std::filesystem::path& projectDir,
         const std::filesystem::path& pluginStateDir,
-        const std::string& scopeLabel,
-        size_t pluginOrder,
-        int32_t instanceId,
         const std::vector<uint8_t>& stateData,
         std::string& error);
 
+    // Whether a file name is one writePluginStateBlob() produces.
+    bool isPluginStateBlobName(std::string_view filename);
+
+    // Deletes the state files named by content in pluginStateDir that are not
+    // among referencedFilenames. Files named any other way are left alone.
+    void removeUnreferencedPluginStateBlobs(
+        const std::filesystem::path& pluginStateDir,
+        const std::unordered_set<std::string>& referencedFilenames);
+
     bool serializeProjectClip(
         TimelineTrack& timelineTrack,
         const ClipData& clip,
@@ -39,6 +48,7 @@ namespace uapmd::sequencer_detail {
         const std::string& clipContextLabel,
         bool includeTimelineMeta,
         size_t& midiExportCounter,
+        ProjectChunkContainerWriter* chunkWriter,
         std::string& error);
 
     class FilesystemProjectSerializationWriteContext final : public ProjectSerializationWriteContext {
@@ -56,6 +66,7 @@ namespace uapmd::sequencer_detail {
             const std::filesystem::path& relativePath,
             const std::vector<uint8_t>& data,
             std::string& error) override;
+        std::filesystem::path extensionDataDirectory(std::string_view extensionId) const override;
     };
 
     class FilesystemProjectSerializationReadContext final : public ProjectSerializationReadContext {
@@ -72,6 +83,7 @@ namespace uapmd::sequencer_detail {
             std::string_view extensionId,
             const std::filesystem::path& relativePath,
             std::string& error) override;
+        std::filesystem::path extensionDataDirectory(std::string_view extensionId) const override;
     };
 
 } // namespace uapmd::sequencer_detail
@@ -0,0 +1,242 @@
+// Only compiled when UAPMD_ENABLE_RT_SAFETY_CHECKS is ON. This translation unit
+// replaces the process-wide allocator entry points and pthread_mutex_lock, so it
+// must not allocate or lock anything itself on the counting paths.
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(__linux__) && defined(__GLIBC__)
+#define UAPMD_RT_SAFETY_INTERPOSE_LIBC 1
+#include <dlfcn.h>
+#include <malloc.h>
+#include <pthread.h>
+#else
+#define UAPMD_RT_SAFETY_INTERPOSE_LIBC 0
+#endif
+
+#if UAPMD_HAS_CPPTRACE
+#include <cpptrace/cpptrace.hpp>
+#endif
+
+#include "uapmd-engine/detail/sequencer/RealtimeSafetyMonitor.hpp"
+
+// The allocator hooks can run before TLS of a dlopen()ed module is set up; the
+// initial-exec model keeps the thread-local lookup itself allocation-free.
+#if defined(__GNUC__) || defined(__clang__)
+#define UAPMD_RT_SAFETY_TLS __attribute__((tls_model("initial-exec"))) thread_local
+#else
+#define UAPMD_RT_SAFETY_TLS thread_local
+#endif
+
+namespace {
+
+    UAPMD_RT_SAFETY_TLS int32_t audio_thread_depth{0};
+
+    std::atomic<uint64_t> allocation_count{0};
+    std::atomic<uint64_t> deallocation_count{0};
+    std::atomic<uint64_t> lock_count{0};
+    std::atomic<bool> abort_on_violation{std::getenv("UAPMD_RT_SAFETY_ABORT") != nullptr};
+
+    [[noreturn]] void reportAndAbort(const char* kind) {
+        // Everything from here on may allocate; make sure it is not counted again.
+        audio_thread_depth = 0;
+        std::fprintf(stderr, "uapmd: %s on the audio thread (UAPMD_RT_SAFETY_CHECKS)\n", kind);
+#if UAPMD_HAS_CPPTRACE
+        cpptrace::generate_trace(1).print();
+#endif
+        std::fflush(stderr);
+        std::abort();
+    }
+
+    inline void noteViolation(std::atomic<uint64_t>& counter, const char* kind) {
+        if (audio_thread_depth <= 0)
+            return;
+        counter.fetch_add(1, std::memory_order_relaxed);
+        if (abort_on_violation.load(std::memory_order_relaxed))
+            reportAndAbort(kind);
+    }
+
+} // namespace
+
+namespace uapmd {
+
+    RealtimeSafetyMonitor::AudioThreadScope::AudioThreadScope() noexcept {
+        ++audio_thread_depth;
+    }
+
+    RealtimeSafetyMonitor::AudioThreadScope::~AudioThreadScope() noexcept {
+        --audio_thread_depth;
+    }
+
+    RealtimeSafetyMonitor::SuppressionScope::SuppressionScope() noexcept
+        : saved_depth_(audio_thread_depth) {
+        audio_thread_depth = 0;
+    }
+
+    RealtimeSafetyMonitor::SuppressionScope::~SuppressionScope() noexcept {
+        audio_thread_depth = saved_depth_;
+    }
+
+    bool RealtimeSafetyMonitor::isAudioThread() noexcept {
+        return audio_thread_depth > 0;
+    }
+
+    RealtimeSafetyMonitor::Counters RealtimeSafetyMonitor::counters() noexcept {
+        return Counters{
+            allocation_count.load(std::memory_order_relaxed),
+            deallocation_count.load(std::memory_order_relaxed),
+            lock_count.load(std::memory_order_relaxed),
+        };
+    }
+
+    void RealtimeSafetyMonitor::resetCounters() noexcept {
+        allocation_count.store(0, std::memory_order_relaxed);
+        deallocation_count.store(0, std::memory_order_relaxed);
+        lock_count.store(0, std::memory_order_relaxed);
+    }
+
+    bool RealtimeSafetyMonitor::abortOnViolation() noexcept {
+        return abort_on_violation.load(std::memory_order_relaxed);
+    }
+
+    void RealtimeSafetyMonitor::abortOnViolation(bool enabled) noexcept {
+        abort_on_violation.store(enabled, std::memory_order_relaxed);
+    }
+
+} // namespace uapmd
+
+#if UAPMD_RT_SAFETY_INTERPOSE_LIBC
+
+namespace {
+    using MutexLockFunction = int (*)(pthread_mutex_t*);
+    std::atomic<MutexLockFunction> next_mutex_lock{nullptr};
+
+    // dlsym() only takes loader-internal locks, never pthread_mutex_lock.
+    MutexLockFunction resolveNextMutexLock() {
+        auto lock = reinterpret_cast<MutexLockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+        next_mutex_lock.store(lock, std::memory_order_release);
+        return lock;
+    }
+} // namespace
+
+// glibc lets the main program replace the malloc family (see "Replacing malloc" in
+// the glibc manual). operator new/delete in libstdc++ end up here, so they are not
+// replaced separately. The __libc_* entry points are the original implementations.
+extern "C" {
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* ptr, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void* ptr);
+
+    void* malloc(size_t size) noexcept {
+        noteViolation(allocation_count, "malloc");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) noexcept {
+        noteViolation(allocation_count, "calloc");
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* ptr, size_t size) noexcept {
+        noteViolation(allocation_count, "realloc");
+        return __libc_realloc(ptr, size);
+    }
+
+    void* memalign(size_t alignment, size_t size) noexcept {
+        noteViolation(allocation_count, "memalign");
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size) noexcept {
+        noteViolation(allocation_count, "aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** result, size_t alignment, size_t size) noexcept {
+        noteViolation(allocation_count, "posix_memalign");
+        if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+        void* ptr = __libc_memalign(alignment, size);
+        if (!ptr)
+            return ENOMEM;
+        *result = ptr;
+        return 0;
+    }
+
+    void free(void* ptr) noexcept {
+        if (ptr)
+            noteViolation(deallocation_count, "free");
+        __libc_free(ptr);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept {
+        auto lock = next_mutex_lock.load(std::memory_order_acquire);
+        // Only a lock taken by an earlier static initializer gets here.
+        if (!lock)
+            lock = resolveNextMutexLock();
+        noteViolation(lock_count, "pthread_mutex_lock");
+        return lock(mutex);
+    }
+}
+
+namespace {
+    // Before main(), so that no audio thread ever reaches dlsym(), which may
+    // allocate and lock the first time it runs.
+    __attribute__((constructor(101))) void resolveInterposedFunctions() {
+        resolveNextMutexLock();
+    }
+} // namespace
+
+#else
+
+// Without libc interposition only C++ allocations are observable.
+void* operator new(std::size_t size) {
+    noteViolation(allocation_count, "operator new");
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    noteViolation(allocation_count, "operator new[]");
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    noteViolation(allocation_count, "operator new");
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    noteViolation(allocation_count, "operator new[]");
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr)
+        noteViolation(deallocation_count, "operator delete");
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    if (ptr)
+        noteViolation(deallocation_count, "operator delete[]");
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    operator delete[](ptr);
+}
+
+#endif
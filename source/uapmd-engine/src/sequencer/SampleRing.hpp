@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace uapmd {
+
+// Interleaved samples handed from the audio thread to the writer. One
+// producer, one consumer; positions only ever grow.
+class SampleRing {
+public:
+    explicit SampleRing(size_t minimumCapacity)
+        : buffer_(std::bit_ceil(std::max<size_t>(minimumCapacity, 1))),
+          mask_(buffer_.size() - 1) {}
+
+    size_t writableSamples() const noexcept {
+        return buffer_.size() - (write_.load(std::memory_order_relaxed) - read_.load(std::memory_order_acquire));
+    }
+
+    // Producer side. The caller has checked writableSamples().
+    void writeFrames(const float* const* channels, uint32_t channelCount,
+                     uint32_t offset, uint32_t frameCount) noexcept {
+        auto position = write_.load(std::memory_order_relaxed);
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+            for (uint32_t ch = 0; ch < channelCount; ++ch)
+                buffer_[position++ & mask_] = channels[ch] ? channels[ch][offset + frame] : 0.0f;
+        write_.store(position, std::memory_order_release);
+    }
+
+    // Consumer side. Passes the readable samples as at most two spans.
+    template <typename Consume>
+    size_t drain(Consume&& consume) {
+        const auto read = read_.load(std::memory_order_relaxed);
+        const auto available = write_.load(std::memory_order_acquire) - read;
+        if (available == 0)
+            return 0;
+        const auto start = read & mask_;
+        const auto first = std::min(available, buffer_.size() - start);
+        consume(buffer_.data() + start, first);
+        if (first < available)
+            consume(buffer_.data(), available - first);
+        read_.store(read + available, std::memory_order_release);
+        return available;
+    }
+
+private:
+    std::vector<float> buffer_;
+    size_t mask_;
+    std::atomic<size_t> write_{0};
+    std::atomic<size_t> read_{0};
+};
+
+}
@@ -3,12 +3,14 @@
 #include <array>
 #include <format>
 #include <mutex>
+#include <optional>
 #include <thread>
 #include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <chrono>
 #include <iostream>
+#include <stdexcept>
 #include <unordered_set>
 #include <umppi/umppi.hpp>
 
@@ -46,6 +48,8 @@ namespace uapmd {
     struct PumpSlot {
         std::unique_ptr<AudioProcessContext> ctx;
         uint64_t transport_generation{0};
+        // Parameter automation rendered for the same block as ctx.
+        std::vector<ParameterAutomationEvent> automation;
     };
 
     struct PumpTrackRing {
@@ -56,18 +60,48 @@ namespace uapmd {
         explicit PumpTrackRing(MasterContext& mc, size_t umpBufSizeInInts) {
             for (size_t i = 0; i < kPumpSlots; i++) {
                 slots[i].ctx = std::make_unique<AudioProcessContext>(mc, umpBufSizeInInts);
+                slots[i].automation.reserve(ParameterAutomationManager::kEventCapacityPerBlock);
                 free_slots.try_enqueue(i);
             }
         }
     };
 
     static void clearAudioInputBuses(AudioProcessContext& ctx) {
-        for (int32_t busIndex = 0; busIndex < ctx.audioInBusCount(); ++busIndex)
-            for (uint32_t ch = 0; ch < ctx.inputChannelCount(busIndex); ++ch) {
-                auto* buffer = ctx.getFloatInBuffer(busIndex, ch);
-                if (buffer)
-                    std::memset(buffer, 0, static_cast<size_t>(ctx.frameCount()) * sizeof(float));
-            }
+        ctx.withSampleType([&](auto* tag) {
+            using SampleType = std::remove_pointer_t<decltype(tag)>;
+            for (int32_t busIndex = 0; busIndex < ctx.audioInBusCount(); ++busIndex)
+                for (uint32_t ch = 0; ch < ctx.inputChannelCount(busIndex); ++ch) {
+                    auto* buffer = ctx.getInBuffer<SampleType>(busIndex, ch);
+                    if (buffer)
+                        std::memset(buffer, 0, static_cast<size_t>(ctx.frameCount()) * sizeof(SampleType));
+                }
+        });
+    }
+
+    // The engine's contexts hold doubles in a 64-bit session, device contexts
+    // always floats; the conversion happens while summing.
+    static void accumulateChannel(
+        AudioProcessContext& dstCtx,
+        bool dstIsInput,
+        uint32_t dstBusIndex,
+        const AudioProcessContext& srcCtx,
+        uint32_t srcBusIndex,
+        uint32_t ch,
+        int32_t frameCount) {
+        dstCtx.withSampleType([&](auto* dstTag) {
+            using DstType = std::remove_pointer_t<decltype(dstTag)>;
+            srcCtx.withSampleType([&](auto* srcTag) {
+                using SrcType = std::remove_pointer_t<decltype(srcTag)>;
+                auto* dst = dstIsInput
+                    ? dstCtx.getInBuffer<DstType>(static_cast<int32_t>(dstBusIndex), ch)
+                    : dstCtx.getOutBuffer<DstType>(static_cast<int32_t>(dstBusIndex), ch);
+                const auto* src = srcCtx.getOutBuffer<SrcType>(static_cast<int32_t>(srcBusIndex), ch);
+                if (!dst || !src)
+                    return;
+                for (int32_t frame = 0; frame < frameCount; ++frame)
+                    dst[frame] += static_cast<DstType>(src[frame]);
+            });
+        });
     }
 
     static void accumulateAudioBus(
@@ -82,14 +116,8 @@ namespace uapmd {
         const uint32_t numChannels = std::min(
             static_cast<uint32_t>(dstCtx.outputChannelCount(static_cast<int32_t>(dstBusIndex))),
             static_cast<uint32_t>(srcCtx.outputChannelCount(static_cast<int32_t>(srcBusIndex))));
-        for (uint32_t ch = 0; ch < numChannels; ++ch) {
-            auto* dst = dstCtx.getFloatOutBuffer(static_cast<int32_t>(dstBusIndex), ch);
-            const auto* src = srcCtx.getFloatOutBuffer(static_cast<int32_t>(srcBusIndex), ch);
-            if (!dst || !src)
-                continue;
-            for (int32_t frame = 0; frame < frameCount; ++frame)
-                dst[frame] += src[frame];
-        }
+        for (uint32_t ch = 0; ch < numChannels; ++ch)
+            accumulateChannel(dstCtx, false, dstBusIndex, srcCtx, srcBusIndex, ch, frameCount);
     }
 
     static void accumulateAudioBusToInput(
@@ -104,14 +132,8 @@ namespace uapmd {
         const uint32_t numChannels = std::min(
             static_cast<uint32_t>(dstCtx.inputChannelCount(static_cast<int32_t>(dstBusIndex))),
             static_cast<uint32_t>(srcCtx.outputChannelCount(static_cast<int32_t>(srcBusIndex))));
-        for (uint32_t ch = 0; ch < numChannels; ++ch) {
-            auto* dst = dstCtx.getFloatInBuffer(static_cast<int32_t>(dstBusIndex), ch);
-            const auto* src = srcCtx.getFloatOutBuffer(static_cast<int32_t>(srcBusIndex), ch);
-            if (!dst || !src)
-                continue;
-            for (int32_t frame = 0; frame < frameCount; ++frame)
-                dst[frame] += src[frame];
-        }
+        for (uint32_t ch = 0; ch < numChannels; ++ch)
+            accumulateChannel(dstCtx, true, dstBusIndex, srcCtx, srcBusIndex, ch, frameCount);
     }
 
     static void applyTrackBusesLayout(SequencerTrack* track, const AudioGraphBusesLayout& layout) {
@@ -180,7 +202,16 @@ namespace uapmd {
         // Reader 0 is the audio callback; reader 1 is the MIDI output worker.
         RtSnapshotPublisher<PlatformMidiRoutes, 2> platform_midi_output_routes_;
         std::unique_ptr<MidiRecorder> midi_recorder_;
+        std::unique_ptr<AudioRecorder> audio_recorder_;
         std::vector<PlaybackEngineExtension*> playback_engine_extensions_;
+        // Parameter values that plug-ins sent as NRPN output, queued on the
+        // audio thread and handed to the main thread by the MIDI output worker.
+        struct PluginParameterOutput {
+            int32_t instance_id{-1};
+            int32_t param_id{0};
+            double value{0.0};
+        };
+        moodycamel::ReaderWriterQueue<PluginParameterOutput> plugin_parameter_output_queue_{256};
         std::atomic<bool> platform_midi_output_worker_running_{true};
         std::thread platform_midi_output_worker_;
         UapmdFunctionBlockManager function_block_manager{};
@@ -213,11 +244,33 @@ namespace uapmd {
         // Offline rendering mode
         std::atomic<bool> offline_rendering_{false};
         std::atomic<bool> track_freeze_render_active_{false};
-        bool executing_track_freeze_render_step_{false};
+        // Thread currently rendering a track block. Live input and plug-in edits
+        // to a busy track are rejected unless they come from the render itself.
+        std::atomic<std::thread::id> track_freeze_render_step_thread_{};
+        bool executingTrackFreezeRenderStep() const {
+            return track_freeze_render_step_thread_.load(std::memory_order_acquire) ==
+                std::this_thread::get_id();
+        }
+        // Track that a background render has taken out of the live walk (see
+        // OfflineTrackRenderSettings::background). The pump and processAudio()
+        // skip it; its graph and clip sources belong to the render thread.
+        std::atomic<SequencerTrack*> background_render_track_{nullptr};
+        // Render-thread side of the structure mutation handshake, equivalent to
+        // in_process_audio_ for processAudio().
+        std::atomic<bool> in_background_render_step_{false};
         struct OfflineTrackRenderSession {
             OfflineTrackRenderSettings settings;
+            // Background renders address the track by identity: indices shift
+            // when other tracks are added or removed while they run.
+            SequencerTrack* track{nullptr};
+            TimelineTrack* timeline_track{nullptr};
+            int64_t render_offset{0};
             OfflineTrackRenderResult result;
             TimelineState previous_timeline_state;
+            // Taken on the main thread when the render begins; background
+            // steps derive their private transport from it instead of reading
+            // the timeline state the audio thread is writing.
+            TimelineState render_timeline_state;
             int64_t previous_playback_position{0};
             bool previous_offline_rendering{false};
             int64_t current_sample{0};
@@ -225,8 +278,14 @@ namespace uapmd {
             std::unique_ptr<AudioProcessContext> device_context;
             std::unique_ptr<AudioProcessContext> track_context;
             SequenceProcessContext render_sequence;
-            std::vector<std::pair<int32_t, std::vector<uint8_t>>>
+            // Parameter automation for the block being rendered.
+            std::vector<ParameterAutomationEvent> automation;
+            // Interned, so a state that undo history or another track already
+            // holds is not copied again for the length of the render.
+            std::vector<std::pair<int32_t, PluginStateRef>>
                 plugin_states;
+            std::vector<const float*> sink_channels;
+            std::vector<float> sink_silence;
         };
         std::unique_ptr<OfflineTrackRenderSession> track_freeze_render_session_;
         using TrackAudioProcessorExtensions = std::vector<TrackAudioProcessorExtension*>;
@@ -266,7 +325,8 @@ namespace uapmd {
             SequencerEngineImpl& engine;
             explicit StructureMutationGuard(SequencerEngineImpl& e) : engine(e) {
                 engine.structure_mutation_active_.store(true, std::memory_order_seq_cst);
-                while (engine.in_process_audio_.load(std::memory_order_seq_cst))
+                while (engine.in_process_audio_.load(std::memory_order_seq_cst) ||
+                       engine.in_background_render_step_.load(std::memory_order_seq_cst))
                     std::this_thread::yield();
             }
             ~StructureMutationGuard() {
@@ -301,6 +361,7 @@ namespace uapmd {
         std::unique_ptr<TrackRoutingManager> track_routing_manager_{};
         std::unique_ptr<LatencyCompensationManagerImpl> latency_compensation_manager_{};
         std::unique_ptr<TailProcessManagerImpl> tail_process_manager_{};
+        std::unique_ptr<ParameterAutomationManager> parameter_automation_manager_{};
 
         void ensureTrackBusConfiguration(int32_t trackIndex, remidy::PluginAudioBuses* pluginBuses);
         void ensureContextBusConfiguration(AudioProcessContext* ctx, remidy::PluginAudioBuses* pluginBuses);
@@ -310,6 +371,7 @@ namespace uapmd {
         // Timeline facade (owns timeline tracks, clips, project loading)
         std::unique_ptr<TimelineFacade> timeline_;
         std::unique_ptr<FrozenTrackManager> frozen_track_manager_;
+        std::unique_ptr<AutoFreezeScheduler> auto_freeze_scheduler_;
 
     public:
         void registerAddinExtensionPoints(uapmd_addin::AddinManager& manager) override {
@@ -333,6 +395,7 @@ namespace uapmd {
 
         AudioPluginHostingAPI* pluginHost() override;
         FrozenTrackManager& frozenTrackManager() override { return *frozen_track_manager_; }
+        AutoFreezeScheduler& autoFreezeScheduler() override { return *auto_freeze_scheduler_; }
         TailProcessManager& tailProcessManager() override { return *tail_process_manager_; }
 
         SequenceProcessContext& data() override { return sequence; }
@@ -348,6 +411,7 @@ namespace uapmd {
         uint32_t masterTrackRenderLeadInSamples() override;
         bool trackHasLiveInput(uapmd_track_index_t trackIndex) override;
         LatencyCompensationManager* latencyCompensationManager() override;
+        ParameterAutomationManager* parameterAutomationManager() override;
         uint32_t trackOutputAlignmentHoldbackInSamples(uapmd_track_index_t trackIndex) override;
         uint32_t trackOutputBusAlignmentHoldbackInSamples(uapmd_track_index_t trackIndex, uint32_t outputBusIndex) override;
         TrackOutputRoutingTarget trackOutputBusRoutingTarget(uapmd_track_index_t trackIndex, uint32_t outputBusIndex) override;
@@ -356,6 +420,10 @@ namespace uapmd {
             uapmd_track_index_t trackIndex,
             const std::vector<TrackOutputRoutingRule>& rules) override;
         bool isOutputAlignmentActive() override;
+        bool trackIsReturn(uapmd_track_index_t trackIndex) override;
+        bool setTrackIsReturn(uapmd_track_index_t trackIndex, bool isReturn) override;
+        std::vector<TrackSend> trackSends(uapmd_track_index_t trackIndex) override;
+        bool setTrackSends(uapmd_track_index_t trackIndex, std::vector<TrackSend> sends) override;
 
         void setDefaultChannels(uint32_t inputChannels, uint32_t outputChannels) override;
         void setSampleRate(int32_t newSampleRate) override;
@@ -376,6 +444,7 @@ namespace uapmd {
         bool replaceTrackGraph(uapmd_track_index_t trackIndex, std::unique_ptr<AudioPluginGraph>&& graph) override;
         void addPluginToTrack(int32_t trackIndex, std::string& format, std::string& pluginId, std::function<void(int32_t instanceId, int32_t trackIndex, std::string error)> callback, std::string restoreNodeId = {}) override;
         bool removePluginInstance(int32_t instanceId) override;
+        void prewarmPlugin(std::string& format, std::string& pluginId, uint32_t count) override;
 
         uint8_t getInstanceGroup(int32_t instanceId) const override {
             for (const auto& t : tracks_)
@@ -389,7 +458,7 @@ namespace uapmd {
         }
 
         bool setInstanceGroup(int32_t instanceId, uint8_t group) override {
-            if (!executing_track_freeze_render_step_ &&
+            if (!executingTrackFreezeRenderStep() &&
                 frozen_track_manager_->isInstanceBusy(instanceId))
                 return false;
             // Find which track owns this instance and set the group there.
@@ -500,6 +569,7 @@ namespace uapmd {
 
         void pumpAudio(AudioProcessContext& process) override;
         uapmd_status_t processAudio(AudioProcessContext& process) override;
+        bool canRenderTrackInBackground(uapmd_track_index_t trackIndex) override;
         bool beginOfflineTrackRender(
             const OfflineTrackRenderSettings& settings,
             std::string& error) override;
@@ -557,6 +627,8 @@ namespace uapmd {
 
         bool offlineRendering() const override;
         void offlineRendering(bool enabled) override;
+        AudioContentType audioDataType() override;
+        void audioDataType(AudioContentType dataType) override;
 
         void setEngineActive(bool active) override {
             engine_active_.store(active, std::memory_order_release);
@@ -609,10 +681,12 @@ namespace uapmd {
             PlatformMidiRoute& route, uapmd_ump_t* ump, size_t sizeInBytes, uapmd_timestamp_t timestamp);
         void enqueuePlatformMidiOutput(int32_t trackIndex, const uapmd_ump_t* ump, size_t sizeInBytes);
         void runPlatformMidiOutputWorker();
+        void notifyPluginParameterOutput(int32_t instanceId, int32_t paramId, double value);
         void removePlatformMidiTrackConnections(std::string_view trackId);
         void refreshPlatformMidiTrackIndices();
         void requestAllNotesOff();
         void applyLatencyCompensationTimingUpdateLocked();
+        void runAuxRoutingChange(const std::function<void()>& change);
         TrackOutputRoutingTarget effectiveTrackOutputBusRoutingTarget(
             uapmd_track_index_t trackIndex,
             uint32_t outputBusIndex) const;
@@ -622,6 +696,7 @@ namespace uapmd {
         void reconfigureOutputAlignmentBuffers();
         void resetOutputAlignmentBuffers();
         void notifyAudioProcessingConfigurationChanged();
+        void reconfigurePluginInstances();
         void notifyPluginGraphChanged();
         void notifyPluginInstanceAdded(int32_t instanceId, AudioPluginInstanceAPI& instance);
         void notifyGraphTimingChanged();
@@ -682,6 +757,8 @@ namespace uapmd {
         timeline_ = TimelineFacade::create(*this, std::move(historyFactory));
         midi_recorder_ = std::make_unique<MidiRecorder>(*this);
         addPlaybackEngineExtension(*midi_recorder_);
+        audio_recorder_ = std::make_unique<AudioRecorder>(*this);
+        addPlaybackEngineExtension(*audio_recorder_);
         tail_process_manager_ = std::make_unique<TailProcessManagerImpl>(
             audio_buffer_size_in_frames,
             this->sampleRate,
@@ -691,6 +768,8 @@ namespace uapmd {
         frozen_track_manager_ = std::make_unique<FrozenTrackManager>(*this, *timeline_);
         timeline_->addProjectSerializationExtension(frozen_track_manager_->projectSerializationExtension());
         addTrackAudioProcessorExtension(frozen_track_manager_->audioProcessorExtension());
+        auto_freeze_scheduler_ = std::make_unique<AutoFreezeScheduler>(*this, *timeline_);
+        addAudioProcessingEventHandler(*auto_freeze_scheduler_);
         master_track_ = SequencerTrack::create(
             timeline_->audioGraphProviderRegistry(),
             umpBufferSizeInInts,
@@ -746,10 +825,18 @@ namespace uapmd {
             mix_bus_context_,
             sequence,
             timeline_.get(),
-            *latency_compensation_manager_);
+            *latency_compensation_manager_,
+            [this](const std::function<void()>& change) {
+                runAuxRoutingChange(change);
+            });
+        timeline_->addProjectSerializationExtension(*track_routing_manager_);
         latency_compensation_manager_->attachTrackRoutingManager(*track_routing_manager_);
         addAudioProcessingEventHandler(*latency_compensation_manager_);
+        addProcessingLifecycleListener(*track_routing_manager_);
         addProcessingLifecycleListener(*latency_compensation_manager_);
+        parameter_automation_manager_ = std::make_unique<ParameterAutomationManager>(*this);
+        timeline_->addProjectSerializationExtension(*parameter_automation_manager_);
+        addProcessingLifecycleListener(*parameter_automation_manager_);
         reconfigureMixBusContext();
         configureTrackRouting(master_track_.get());
         platform_midi_output_worker_ = std::thread([this] { runPlatformMidiOutputWorker(); });
@@ -768,6 +855,10 @@ namespace uapmd {
         platform_midi_output_worker_running_.store(false, std::memory_order_release);
         if (platform_midi_output_worker_.joinable())
             platform_midi_output_worker_.join();
+        if (auto_freeze_scheduler_) {
+            removeAudioProcessingEventHandler(*auto_freeze_scheduler_);
+            auto_freeze_scheduler_.reset();
+        }
         if (frozen_track_manager_) {
             removeTrackAudioProcessorExtension(frozen_track_manager_->audioProcessorExtension());
             timeline_->removeProjectSerializationExtension(frozen_track_manager_->projectSerializationExtension());
@@ -780,6 +871,14 @@ namespace uapmd {
             removeProcessingLifecycleListener(*latency_compensation_manager_);
             timeline_->removeProjectSerializationExtension(*latency_compensation_manager_);
         }
+        if (track_routing_manager_) {
+            removeProcessingLifecycleListener(*track_routing_manager_);
+            timeline_->removeProjectSerializationExtension(*track_routing_manager_);
+        }
+        if (parameter_automation_manager_) {
+            removeProcessingLifecycleListener(*parameter_automation_manager_);
+            timeline_->removeProjectSerializationExtension(*parameter_automation_manager_);
+        }
         tail_process_manager_.reset();
         // Detach output mappers while plugin instances are still alive. This is a separate
         // step from clearAllDevices() because AppModel::DeviceState holds shared_ptrs to
@@ -1021,6 +1120,52 @@ namespace uapmd {
         applyLatencyCompensationTimingUpdateLocked();
     }
 
+    void SequencerEngineImpl::runAuxRoutingChange(const std::function<void()>& change) {
+        StructureMutationGuard mutationGuard(*this);
+        change();
+        reconfigureMixBusContext();
+        reconfigureMasterTrackInputBuses();
+        reconfigureOutputAlignmentBuffers();
+        applyLatencyCompensationTimingUpdateLocked();
+    }
+
+    bool SequencerEngineImpl::trackIsReturn(uapmd_track_index_t trackIndex) {
+        return track_routing_manager_ && track_routing_manager_->trackIsReturn(trackIndex);
+    }
+
+    bool SequencerEngineImpl::setTrackIsReturn(uapmd_track_index_t trackIndex, bool isReturn) {
+        if (!track_routing_manager_ || frozen_track_manager_->isTrackBusy(trackIndex))
+            return false;
+        if (isReturn == trackIsReturn(trackIndex))
+            return trackIndex >= 0 && static_cast<size_t>(trackIndex) < tracks_.size();
+        // A return's input depends on other tracks, so its frozen render would
+        // go stale; drop the freeze before the track starts receiving sends.
+        if (isReturn &&
+            frozen_track_manager_->freezePolicyForTrack(trackIndex) != FrozenTrackManager::FreezePolicy::Off)
+            frozen_track_manager_->setFreezePolicyForTrack(trackIndex, FrozenTrackManager::FreezePolicy::Off);
+        bool changed = false;
+        runAuxRoutingChange([&] {
+            changed = track_routing_manager_->setTrackIsReturn(trackIndex, isReturn);
+        });
+        return changed;
+    }
+
+    std::vector<TrackSend> SequencerEngineImpl::trackSends(uapmd_track_index_t trackIndex) {
+        return track_routing_manager_
+            ? track_routing_manager_->trackSends(trackIndex)
+            : std::vector<TrackSend>{};
+    }
+
+    bool SequencerEngineImpl::setTrackSends(uapmd_track_index_t trackIndex, std::vector<TrackSend> sends) {
+        if (!track_routing_manager_ || frozen_track_manager_->isTrackBusy(trackIndex))
+            return false;
+        bool changed = false;
+        runAuxRoutingChange([&] {
+            changed = track_routing_manager_->setTrackSends(trackIndex, std::move(sends));
+        });
+        return changed;
+    }
+
     bool SequencerEngineImpl::isOutputAlignmentActive() {
         return track_routing_manager_ && track_routing_manager_->isOutputAlignmentActive();
     }
@@ -1029,6 +1174,10 @@ namespace uapmd {
         return latency_compensation_manager_.get();
     }
 
+    ParameterAutomationManager* SequencerEngineImpl::parameterAutomationManager() {
+        return parameter_automation_manager_.get();
+    }
+
     TrackOutputRoutingTarget SequencerEngineImpl::effectiveTrackOutputBusRoutingTarget(
         uapmd_track_index_t trackIndex,
         uint32_t outputBusIndex) const {
@@ -1105,8 +1254,10 @@ namespace uapmd {
                 if (entry.second)
                     entry.second->clearQueuedEvents();
         };
+        auto* withheldTrack = background_render_track_.load(std::memory_order_acquire);
         for (auto& track : tracks_)
-            clearTrackEvents(track.get());
+            if (track.get() != withheldTrack)
+                clearTrackEvents(track.get());
         clearTrackEvents(master_track_.get());
 
         if (input_analyser_)
@@ -1164,6 +1315,8 @@ namespace uapmd {
     void SequencerEngineImpl::pumpAudio(AudioProcessContext& process) {
         const auto transportGeneration =
             transport_generation_.load(std::memory_order_acquire);
+        if (parameter_automation_manager_)
+            parameter_automation_manager_->liveTransportGeneration(transportGeneration);
         const auto trackFrameCount = static_cast<int32_t>(
             std::min(static_cast<size_t>(process.frameCount()), audio_buffer_size_in_frames));
 
@@ -1171,7 +1324,8 @@ namespace uapmd {
         // vectors non-atomically, so clamp every loop below to the smallest size
         // and skip the not-yet-published tracks for this quantum (lock-free).
         const size_t pumpTrackCount = std::min(
-            std::min(tracks_.size(), pump_sequence_.tracks.size()),
+            std::min(std::min(tracks_.size(), pump_sequence_.tracks.size()),
+                     pump_sequence_.automation.size()),
             std::min(pump_rings_.size(), pump_slot_indices_.size()));
 
         // ── Step 1: acquire a free ring-buffer slot per track ─────────────────
@@ -1180,7 +1334,14 @@ namespace uapmd {
         // timeline_->processTracksAudio(process, pump_sequence_)) writes into the
         // ring slot rather than into the shared sequence.tracks[t].
         std::fill(pump_slot_indices_.begin(), pump_slot_indices_.end(), SIZE_MAX);
+        auto* withheldTrack = background_render_track_.load(std::memory_order_acquire);
         for (size_t t = 0; t < pumpTrackCount; t++) {
+            if (withheldTrack && tracks_[t].get() == withheldTrack) {
+                // A background render feeds this track's clip sources itself.
+                pump_sequence_.tracks[t] = nullptr;
+                pump_sequence_.automation[t] = nullptr;
+                continue;
+            }
             size_t idx;
             if (pump_rings_[t]->free_slots.try_dequeue(idx)) {
                 pump_slot_indices_[t] = idx;
@@ -1190,10 +1351,14 @@ namespace uapmd {
                 ctx->eventOut().position(0);
                 ctx->frameCount(trackFrameCount);
                 pump_sequence_.tracks[t] = ctx;
+                slot.automation.clear();
+                pump_sequence_.automation[t] = &slot.automation;
             } else {
                 // All slots full: pump is kPumpLookahead quanta ahead of RT.
                 // Fall back to the shared sequence context (single-threaded path only).
+                // The block goes without automation; the next one restates the values.
                 pump_sequence_.tracks[t] = (t < sequence.tracks.size()) ? sequence.tracks[t] : nullptr;
+                pump_sequence_.automation[t] = nullptr;
             }
         }
 
@@ -1201,15 +1366,18 @@ namespace uapmd {
         for (size_t t = 0; t < pumpTrackCount; t++) {
             auto* ctx = pump_sequence_.tracks[t];
             if (!ctx) continue;
-            for (uint32_t i = 0; i < ctx->audioInBusCount(); i++) {
-                for (uint32_t ch = 0, nCh = ctx->inputChannelCount(i); ch < nCh; ch++) {
-                    float* dst = ctx->getFloatInBuffer(i, ch);
-                    if (process.audioInBusCount() > 0 && ch < process.inputChannelCount(0))
-                        memcpy(dst, process.getFloatInBuffer(0, ch), trackFrameCount * sizeof(float));
-                    else
-                        memset(dst, 0, trackFrameCount * sizeof(float));
+            ctx->withSampleType([&](auto* tag) {
+                using SampleType = std::remove_pointer_t<decltype(tag)>;
+                for (uint32_t i = 0; i < ctx->audioInBusCount(); i++) {
+                    for (uint32_t ch = 0, nCh = ctx->inputChannelCount(i); ch < nCh; ch++) {
+                        auto* dst = ctx->getInBuffer<SampleType>(i, ch);
+                        if (process.audioInBusCount() > 0 && ch < process.inputChannelCount(0))
+                            std::copy_n(process.getFloatInBuffer(0, ch), trackFrameCount, dst);
+                        else
+                            memset(dst, 0, trackFrameCount * sizeof(SampleType));
+                    }
                 }
-            }
+            });
         }
 
         // ── Step 3: advance timeline and fill events / audio from clip sources ─
@@ -1229,6 +1397,9 @@ namespace uapmd {
         // Record start time for deadline tracking
         auto startTime = std::chrono::steady_clock::now();
 
+        // No-op unless built with UAPMD_ENABLE_RT_SAFETY_CHECKS.
+        RealtimeSafetyMonitor::AudioThreadScope realtimeSafetyScope;
+
         // Structural-mutation handshake: announce we're inside the audio walk before
         // anything touches the per-track vectors, then back out with silence if a
         // main-thread mutation is in flight (see structure_mutation_active_).
@@ -1303,11 +1474,16 @@ namespace uapmd {
                     sequence.tracks[t]->clearAudioOutputs();
                     sequence.tracks[t]->eventIn().position(0);
                     sequence.tracks[t]->eventOut().position(0);
+                    slot.automation.clear();
                 }
             }
             // If no slot available: keep sequence.tracks[t] as-is (stale fallback).
         }
 
+        // Block boundary for the compensation delay lines: a layout staged
+        // since the last block takes over here.
+        latency_compensation_manager_->beginBlock();
+
         // Process all tracks (track_processing_flags_ may lag sequence.tracks
         // while the main thread is adding a track, hence the extra clamp).
         const size_t processTrackCount = std::min(
@@ -1315,11 +1491,34 @@ namespace uapmd {
             track_processing_flags_.size());
         auto eventHandlers = audio_processing_event_handlers_.protect();
         auto extensions = track_audio_processor_extensions_.protect();
-        for (size_t i = 0; i < processTrackCount; i++) {
+        auto* withheldTrack = background_render_track_.load(std::memory_order_acquire);
+
+        // Solo is additive at the engine level: any number of tracks may be
+        // marked solo, and only soloed tracks are admitted when at least one is
+        // selected. Mute always wins. Gate after graph processing so plugin
+        // state, tails, meters, and timeline state remain continuous. Return
+        // tracks are solo-safe: a soloed source is still heard through them.
+        bool anySolo = false;
+        for (const auto& track : tracks_)
+            if (track && track->solo()) {
+                anySolo = true;
+                break;
+            }
+
+        auto processTrack = [&](size_t i) {
             // Set processing flag BEFORE accessing sequence.tracks[i]
             track_processing_flags_[i]->store(true, std::memory_order_release);
 
             auto& tp = *sequence.tracks[i];
+            const auto trackIndex = static_cast<uapmd_track_index_t>(i);
+            // A stale slot still holds the sends mixed into it last time.
+            const bool isReturn = track_routing_manager_->trackIsReturn(trackIndex);
+            if (isReturn)
+                latency_compensation_manager_->mixReturnInput(
+                    trackIndex,
+                    tp,
+                    trackFrameCount,
+                    i < rt_dequeued_slots_.size() && rt_dequeued_slots_[i] != SIZE_MAX);
             const TrackAudioProcessingEvent event{
                 static_cast<uapmd_track_index_t>(i),
                 *tracks_[i],
@@ -1331,7 +1530,10 @@ namespace uapmd {
                     if (handler)
                         handler->beforeTrackProcess(event);
             bool processedByExtension = false;
-            if (extensions) {
+            // A background render owns this track's graph; it is heard as
+            // silence until the render hands it back.
+            const bool withheld = tracks_[i].get() == withheldTrack;
+            if (extensions && !withheld) {
                 for (auto* extension : *extensions) {
                     if (!extension || !extension->shouldProcessAudio(
                             *this,
@@ -1348,10 +1550,29 @@ namespace uapmd {
                     break;
                 }
             }
-            if (!processedByExtension && !tracks_[i]->bypassed())
+            // A pre-fader send needs the signal the track fader would scale,
+            // so the fader runs after the sends have read it.
+            webaudio_compat::GainNode* deferredFader = nullptr;
+            if (!processedByExtension && !withheld && !tracks_[i]->bypassed()) {
+                deferredFader = track_routing_manager_->trackDeferredFader(trackIndex);
+                if (deferredFader)
+                    deferredFader->deferred(true);
+                if (i < rt_dequeued_slots_.size() && rt_dequeued_slots_[i] != SIZE_MAX)
+                    parameter_automation_manager_->apply(
+                        trackIndex,
+                        pump_rings_[i]->slots[rt_dequeued_slots_[i]].automation);
                 tracks_[i]->graph().processAudio(tp);
-            else if (!processedByExtension)
+                if (deferredFader)
+                    deferredFader->deferred(false);
+            } else if (!processedByExtension)
                 tp.clearAudioOutputs();
+            if (!isReturn)
+                latency_compensation_manager_->captureTrackSends(
+                    trackIndex,
+                    tp,
+                    trackFrameCount,
+                    !tracks_[i]->muted() && (!anySolo || tracks_[i]->solo()),
+                    deferredFader);
 
             if (eventHandlers)
                 for (auto* handler : *eventHandlers)
@@ -1361,7 +1582,14 @@ namespace uapmd {
 
             // Clear processing flag AFTER we're done with the track context
             track_processing_flags_[i]->store(false, std::memory_order_release);
-        }
+        };
+        // Returns go last so every send into them has been captured.
+        for (size_t i = 0; i < processTrackCount; i++)
+            if (!track_routing_manager_->trackIsReturn(static_cast<uapmd_track_index_t>(i)))
+                processTrack(i);
+        for (size_t i = 0; i < processTrackCount; i++)
+            if (track_routing_manager_->trackIsReturn(static_cast<uapmd_track_index_t>(i)))
+                processTrack(i);
 
 #ifdef __EMSCRIPTEN__
         publishWebAudioTrackCount(static_cast<uint32_t>(processTrackCount));
@@ -1383,6 +1611,11 @@ namespace uapmd {
         const auto renderPosition = render_playback_position_samples_.load(std::memory_order_acquire);
         const bool prerollActive = isPlaybackActive && renderPosition < audiblePosition;
 
+        // Armed tracks record the device input of the block heard at the
+        // audible position. Preroll blocks precede it and are not recorded.
+        if (isPlaybackActive && !prerollActive && !offline_rendering_.load(std::memory_order_acquire))
+            audio_recorder_->capture(process, audiblePosition, process.frameCount());
+
         // Clear main output bus (bus 0) before mixing
         if (process.audioOutBusCount() > 0) {
             for (uint32_t ch = 0; ch < process.outputChannelCount(0); ch++) {
@@ -1405,17 +1638,6 @@ namespace uapmd {
             masterCtx->clearAudioOutputs();
         }
 
-        // Solo is additive at the engine level: any number of tracks may be
-        // marked solo, and only soloed tracks are admitted when at least one is
-        // selected. Mute always wins. Gate after graph processing so plugin
-        // state, tails, meters, and timeline state remain continuous.
-        bool anySolo = false;
-        for (const auto& track : tracks_)
-            if (track && track->solo()) {
-                anySolo = true;
-                break;
-            }
-
         // Stage compensated track output buses into a dedicated mixer context so
         // downstream processing can still see per-bus structure before the final
         // master/device fold.
@@ -1427,7 +1649,9 @@ namespace uapmd {
             if (!track || !ctx)
                 continue;
             ctx->eventIn().position(0); // clean up *in* events here.
-            if (track->muted() || (anySolo && !track->solo()))
+            if (track->muted() ||
+                (anySolo && !track->solo() &&
+                 !track_routing_manager_->trackIsReturn(static_cast<uapmd_track_index_t>(t))))
                 continue;
 
             for (uint32_t busIndex = 0; busIndex < ctx->audioOutBusCount(); ++busIndex) {
@@ -1528,6 +1752,8 @@ namespace uapmd {
         //if (elapsedMicros > availableTimeMicros) {
         if (elapsedMicros > availableTimeMicros) {
             double cpuLoad = (static_cast<double>(elapsedMicros) / availableTimeMicros) * 100.0;
+            // The block is already late; the logger's allocation and lock are not counted against it.
+            RealtimeSafetyMonitor::SuppressionScope deadlineDiagnostics;
             remidy::Logger::global()->logWarning(
                 "Audio deadline missed: processed %d frames in %.2f μs (available: %.2f μs, CPU load: %.1f%%)",
                 process.frameCount(),
@@ -1541,6 +1767,34 @@ namespace uapmd {
         return 0;
     }
 
+    bool SequencerEngineImpl::canRenderTrackInBackground(uapmd_track_index_t trackIndex) {
+#ifdef __EMSCRIPTEN__
+        // WebCLAP instances only process inside the AudioWorklet.
+        (void) trackIndex;
+        return false;
+#else
+        if (trackIndex < 0 ||
+            static_cast<size_t>(trackIndex) >= tracks_.size() ||
+            !tracks_[static_cast<size_t>(trackIndex)])
+            return false;
+        // A return's input is produced by the live pass over its sources.
+        if (trackIsReturn(trackIndex))
+            return false;
+        for (const auto instanceId :
+             tracks_[static_cast<size_t>(trackIndex)]->orderedInstanceIds()) {
+            auto* instance = getPluginInstance(instanceId);
+            if (!instance)
+                return false;
+            // Each format opts in. CLAP does not: its plugins may ask
+            // thread-check whether they run on the audio thread, and the
+            // render thread is not one.
+            if (!instance->supportsProcessingOffAudioThread())
+                return false;
+        }
+        return true;
+#endif
+    }
+
     bool SequencerEngineImpl::beginOfflineTrackRender(
         const OfflineTrackRenderSettings& settings,
         std::string& error) {
@@ -1560,7 +1814,12 @@ namespace uapmd {
             error = "Track render settings are invalid.";
             return false;
         }
-        if (isPlaybackActive()) {
+        if (settings.background) {
+            if (!canRenderTrackInBackground(settings.trackIndex)) {
+                error = "The track's plugins cannot be rendered in the background.";
+                return false;
+            }
+        } else if (isPlaybackActive()) {
             error = "Track freezing cannot start during playback.";
             return false;
         }
@@ -1573,9 +1832,24 @@ namespace uapmd {
 
         auto session = std::make_unique<OfflineTrackRenderSession>();
         session->settings = settings;
+        if (settings.background) {
+            const auto timelineTracks = timeline_->tracks();
+            session->track = tracks_[static_cast<size_t>(settings.trackIndex)].get();
+            session->timeline_track =
+                static_cast<size_t>(settings.trackIndex) < timelineTracks.size()
+                ? timelineTracks[static_cast<size_t>(settings.trackIndex)]
+                : nullptr;
+            if (!session->track || !session->timeline_track) {
+                error = "Track index is invalid.";
+                return false;
+            }
+        }
+        session->render_offset =
+            timeline_->trackRenderOffsetInSamples(settings.trackIndex);
         session->result.startSample = settings.startSample;
         session->current_sample = settings.startSample;
         session->previous_timeline_state = timeline_->state();
+        session->render_timeline_state = session->previous_timeline_state;
         // A track render can only begin while realtime playback is inactive.
         // Do not preserve a stale caller-owned playing flag: Stop/Pause may
         // synchronously dispatch the deferred render before their caller
@@ -1618,7 +1892,11 @@ namespace uapmd {
         }
         const auto totalFrames = static_cast<uint64_t>(
             settings.endSample - settings.startSample);
-        if (channelCount == 0 ||
+        if (channelCount == 0) {
+            error = "Track has no renderable output channel.";
+            return false;
+        }
+        if (!settings.blockSink &&
             totalFrames > settings.maximumBytes / sizeof(float) / channelCount) {
             error =
                 "The frozen audio would exceed the per-track memory limit.";
@@ -1626,21 +1904,38 @@ namespace uapmd {
         }
 
         try {
-            session->result.channels.resize(static_cast<size_t>(channelCount));
-            for (auto& channel : session->result.channels)
-                channel.resize(static_cast<size_t>(totalFrames), 0.0f);
+            if (settings.blockSink) {
+                session->sink_channels.resize(static_cast<size_t>(channelCount), nullptr);
+                session->sink_silence.resize(settings.bufferSize, 0.0f);
+            } else {
+                session->result.channels.resize(static_cast<size_t>(channelCount));
+                for (auto& channel : session->result.channels)
+                    channel.resize(static_cast<size_t>(totalFrames), 0.0f);
+            }
 
+            session->automation.reserve(ParameterAutomationManager::kEventCapacityPerBlock);
+            // The render starts from the curves, not from what an earlier one sent.
+            parameter_automation_manager_->restateAll();
             session->render_sequence.tracks.resize(
                 static_cast<size_t>(settings.trackIndex) + 1, nullptr);
             session->render_sequence.tracks[
                 static_cast<size_t>(settings.trackIndex)] =
                 session->track_context.get();
 
-            track_freeze_render_active_.store(
-                true, std::memory_order_seq_cst);
+            if (settings.background) {
+                // Only this track leaves the live walk. Once the audio thread is
+                // seen outside processAudio() it can no longer be inside the
+                // track's graph, and the pump stops feeding its clip sources.
+                background_render_track_.store(
+                    session->track, std::memory_order_seq_cst);
+            } else {
+                track_freeze_render_active_.store(
+                    true, std::memory_order_seq_cst);
+            }
             while (in_process_audio_.load(std::memory_order_seq_cst))
                 std::this_thread::yield();
-            tail_process_manager_->holdStoppedOutputSilent();
+            if (!settings.background)
+                tail_process_manager_->holdStoppedOutputSilent();
 
             auto* track = tracks_[static_cast<size_t>(settings.trackIndex)].get();
             for (const auto instanceId : track->orderedInstanceIds()) {
@@ -1650,11 +1945,28 @@ namespace uapmd {
                 if (instance->hasUISupport() && instance->isUIVisible())
                     instance->hideUI();
                 session->plugin_states.emplace_back(
-                    instanceId, instance->saveStateSync());
+                    instanceId,
+                    PluginStateStore::instance().intern(instance->saveStateSync()));
             }
 
-            clearTrackProcessingState(settings.trackIndex, true);
-            offline_rendering_.store(true, std::memory_order_release);
+            if (settings.background) {
+                // The rest of the project keeps playing, so the shared buffers
+                // and alignment state are cleared under the mutation handshake.
+                // The plug-ins themselves are no longer reachable from the audio
+                // thread and are reset outside it to keep the exclusion short.
+                {
+                    StructureMutationGuard mutationGuard(*this);
+                    clearTrackProcessingState(settings.trackIndex, false);
+                }
+                for (const auto instanceId : track->orderedInstanceIds())
+                    if (auto* instance = getPluginInstance(instanceId)) {
+                        instance->stopProcessing();
+                        instance->startProcessing();
+                    }
+            } else {
+                clearTrackProcessingState(settings.trackIndex, true);
+                offline_rendering_.store(true, std::memory_order_release);
+            }
             track_freeze_render_session_ = std::move(session);
             return true;
         } catch (const std::exception& exception) {
@@ -1663,6 +1975,10 @@ namespace uapmd {
             error = "Failed to prepare existing plugin instances for rendering.";
         }
 
+        if (settings.background) {
+            background_render_track_.store(nullptr, std::memory_order_release);
+            return false;
+        }
         timeline_->state() = session->previous_timeline_state;
         playbackPosition(session->previous_playback_position);
         offline_rendering_.store(
@@ -1690,6 +2006,16 @@ namespace uapmd {
                 const auto frames = static_cast<int32_t>(std::min<int64_t>(
                     session->settings.endSample - session->current_sample,
                     session->settings.bufferSize));
+                // A background render takes part in the structure mutation
+                // handshake one block at a time, so a main-thread mutator
+                // waits for at most one block. It backs off the same way
+                // processAudio() does and resumes on the next step.
+                std::optional<InProcessAudioScope> backgroundStep;
+                if (session->settings.background) {
+                    backgroundStep.emplace(in_background_render_step_);
+                    if (structure_mutation_active_.load(std::memory_order_seq_cst))
+                        break;
+                }
                 session->master_context.playbackPositionSamples(
                     session->current_sample);
                 session->device_context->frameCount(frames);
@@ -1699,34 +2025,74 @@ namespace uapmd {
                 clearAudioInputBuses(*session->track_context);
                 session->track_context->clearAudioOutputs();
 
-                // TimelineFacade currently derives clip events from the
-                // engine's transport. Install the render transport only for
-                // this bounded call, then restore the public stopped state
-                // before yielding back to the application event loop.
-                timeline_->state() = session->previous_timeline_state;
-                timeline_->state().loopEnabled = false;
-                playbackPosition(session->current_sample);
-                executing_track_freeze_render_step_ = true;
-                try {
-                    timeline_->processTracksAudio(
-                        *session->device_context, session->render_sequence);
-                } catch (...) {
+                // A background render's track can move while it runs; the
+                // handshake above keeps the index steady for this block.
+                auto automationTrack = static_cast<uapmd_track_index_t>(session->settings.trackIndex);
+                if (session->settings.background) {
+                    const auto it = std::ranges::find_if(tracks_, [session](const auto& track) {
+                        return track.get() == session->track;
+                    });
+                    automationTrack = it != tracks_.end()
+                        ? static_cast<uapmd_track_index_t>(it - tracks_.begin()) : -1;
+                }
+                session->automation.clear();
+                parameter_automation_manager_->render(
+                    automationTrack,
+                    std::max<int64_t>(0, session->current_sample + session->render_offset),
+                    0, frames, session->automation, ParameterAutomationManager::kRenderReader);
+
+                if (session->settings.background) {
+                    // Live playback owns the shared transport; feed the clip
+                    // sources from a private one instead.
+                    track_freeze_render_step_thread_.store(
+                        std::this_thread::get_id(), std::memory_order_release);
+                    timeline_->processTrackAudioForRender(
+                        *session->device_context,
+                        *session->timeline_track,
+                        *session->track_context,
+                        session->render_timeline_state,
+                        session->current_sample + session->render_offset);
+                    parameter_automation_manager_->apply(
+                        automationTrack, session->automation, ParameterAutomationManager::kRenderReader);
+                    session->track->graph().processAudio(*session->track_context);
+                    track_freeze_render_step_thread_.store(
+                        std::thread::id{}, std::memory_order_release);
+                } else {
+                    // TimelineFacade currently derives clip events from the
+                    // engine's transport. Install the render transport only for
+                    // this bounded call, then restore the public stopped state
+                    // before yielding back to the application event loop.
+                    timeline_->state() = session->previous_timeline_state;
+                    timeline_->state().loopEnabled = false;
+                    playbackPosition(session->current_sample);
+                    track_freeze_render_step_thread_.store(
+                        std::this_thread::get_id(), std::memory_order_release);
+                    try {
+                        timeline_->processTracksAudio(
+                            *session->device_context, session->render_sequence);
+                    } catch (...) {
+                        timeline_->state() = session->previous_timeline_state;
+                        playbackPosition(session->previous_playback_position);
+                        track_freeze_render_step_thread_.store(
+                            std::thread::id{}, std::memory_order_release);
+                        throw;
+                    }
                     timeline_->state() = session->previous_timeline_state;
                     playbackPosition(session->previous_playback_position);
-                    executing_track_freeze_render_step_ = false;
-                    throw;
+                    parameter_automation_manager_->apply(
+                        automationTrack, session->automation, ParameterAutomationManager::kRenderReader);
+                    tracks_[static_cast<size_t>(session->settings.trackIndex)]
+                        ->graph().processAudio(*session->track_context);
+                    track_freeze_render_step_thread_.store(
+                        std::thread::id{}, std::memory_order_release);
                 }
-                timeline_->state() = session->previous_timeline_state;
-                playbackPosition(session->previous_playback_position);
-                tracks_[static_cast<size_t>(session->settings.trackIndex)]
-                    ->graph().processAudio(*session->track_context);
-                executing_track_freeze_render_step_ = false;
 
                 size_t cachedChannel = 0;
                 const auto destinationOffset =
                     static_cast<size_t>(
                         session->current_sample -
                         session->settings.startSample);
+                const bool streaming = static_cast<bool>(session->settings.blockSink);
                 for (int32_t bus = 0;
                      bus < session->track_context->audioOutBusCount();
                      ++bus)
@@ -1737,7 +2103,10 @@ namespace uapmd {
                         const auto* input =
                             session->track_context->getFloatOutBuffer(
                                 bus, channel);
-                        if (input)
+                        if (streaming) {
+                            if (cachedChannel < session->sink_channels.size())
+                                session->sink_channels[cachedChannel] = input;
+                        } else if (input)
                             std::copy_n(
                                 input,
                                 frames,
@@ -1745,15 +2114,31 @@ namespace uapmd {
                                     static_cast<std::ptrdiff_t>(destinationOffset));
                         ++cachedChannel;
                     }
+                if (streaming) {
+                    // A missing channel buffer is delivered as silence.
+                    for (auto& channel : session->sink_channels)
+                        if (!channel)
+                            channel = session->sink_silence.data();
+                    std::string sinkError;
+                    if (!session->settings.blockSink(
+                            session->sink_channels.data(),
+                            static_cast<uint32_t>(session->sink_channels.size()),
+                            frames,
+                            sinkError))
+                        throw std::runtime_error(
+                            sinkError.empty() ? "Failed to store the rendered track audio." : sinkError);
+                }
 
                 session->current_sample += frames;
             }
         } catch (const std::exception& error) {
-            executing_track_freeze_render_step_ = false;
+            track_freeze_render_step_thread_.store(
+                std::thread::id{}, std::memory_order_release);
             step.errorMessage = error.what();
             return step;
         } catch (...) {
-            executing_track_freeze_render_step_ = false;
+            track_freeze_render_step_thread_.store(
+                std::thread::id{}, std::memory_order_release);
             step.errorMessage = "Existing plugin processing failed.";
             return step;
         }
@@ -1796,16 +2181,19 @@ namespace uapmd {
         if (canceled)
             result.errorMessage = "Track render canceled.";
 
-        auto* track =
-            tracks_[static_cast<size_t>(session->settings.trackIndex)].get();
+        auto* track = session->settings.background
+            ? session->track
+            : tracks_[static_cast<size_t>(session->settings.trackIndex)].get();
         if (track)
             for (const auto instanceId : track->orderedInstanceIds())
                 if (auto* instance = getPluginInstance(instanceId))
                     instance->stopProcessing();
         try {
             for (auto& [instanceId, state] : session->plugin_states)
-                if (auto* instance = getPluginInstance(instanceId))
-                    instance->loadStateSync(state);
+                if (auto* instance = getPluginInstance(instanceId)) {
+                    auto bytes = state->bytes();
+                    instance->loadStateSync(bytes);
+                }
         } catch (const std::exception& exception) {
             result.errorMessage = std::format(
                 "Failed to restore plugin state after freezing: {}",
@@ -1819,6 +2207,27 @@ namespace uapmd {
                 if (auto* instance = getPluginInstance(instanceId))
                     instance->startProcessing();
 
+        if (session->settings.background) {
+            result.success = !result.canceled && result.errorMessage.empty();
+            if (!result.success) {
+                result.channels.clear();
+                result.busChannelCounts.clear();
+            }
+            // The track is still withheld here, so whatever transition installs
+            // (e.g. a frozen render) is in place before the live walk resumes it.
+            if (transition)
+                transition(result);
+            StructureMutationGuard mutationGuard(*this);
+            const auto it = std::ranges::find_if(tracks_, [track](const auto& entry) {
+                return entry.get() == track;
+            });
+            if (it != tracks_.end())
+                clearTrackProcessingState(
+                    static_cast<uapmd_track_index_t>(it - tracks_.begin()), false);
+            background_render_track_.store(nullptr, std::memory_order_release);
+            return std::move(result);
+        }
+
         timeline_->state() = session->previous_timeline_state;
         playbackPosition(session->previous_playback_position);
         offline_rendering_.store(
@@ -1889,11 +2298,29 @@ namespace uapmd {
 
     void SequencerEngineImpl::setSampleRate(int32_t newSampleRate) {
         if (newSampleRate > 0) {
+            const bool changed = newSampleRate != sampleRate;
             sampleRate = newSampleRate;
+            if (changed)
+                reconfigurePluginInstances();
             notifyAudioProcessingConfigurationChanged();
         }
     }
 
+    void SequencerEngineImpl::reconfigurePluginInstances() {
+        // Instances are created with the engine's block capacity as their
+        // maximum block size, and keep it.
+        for (const auto instanceId : plugin_host->instanceIds()) {
+            auto* instance = plugin_host->getInstance(instanceId);
+            if (!instance)
+                continue;
+            if (instance->reconfigure(static_cast<uint32_t>(sampleRate),
+                                      static_cast<uint32_t>(audio_buffer_size_in_frames)) != 0)
+                remidy::Logger::global()->logError(std::format(
+                    "Plugin instance {} ({}) could not be reconfigured for {} Hz",
+                    instanceId, instance->displayName(), sampleRate).c_str());
+        }
+    }
+
     uapmd_track_index_t SequencerEngineImpl::addEmptyTrack(
         uapmd_track_index_t insertionIndex) {
         return publishPreparedTrack(prepareTrack(), insertionIndex);
@@ -2046,6 +2473,9 @@ namespace uapmd {
         pump_sequence_.tracks.insert(
             pump_sequence_.tracks.begin() + insertionIndex,
             nullptr);
+        pump_sequence_.automation.insert(
+            pump_sequence_.automation.begin() + insertionIndex,
+            nullptr);
 
         {
             std::lock_guard<std::mutex> lock(instance_map_mutex_);
@@ -2126,6 +2556,8 @@ namespace uapmd {
             pump_rings_.erase(pump_rings_.begin() + static_cast<long>(index));
         if (static_cast<size_t>(index) < pump_sequence_.tracks.size())
             pump_sequence_.tracks.erase(pump_sequence_.tracks.begin() + static_cast<long>(index));
+        if (static_cast<size_t>(index) < pump_sequence_.automation.size())
+            pump_sequence_.automation.erase(pump_sequence_.automation.begin() + static_cast<long>(index));
         for (auto* listener : processing_lifecycle_listeners_)
             if (listener)
                 listener->trackRemoved(index);
@@ -2284,8 +2716,19 @@ namespace uapmd {
         });
     }
 
+    void SequencerEngineImpl::prewarmPlugin(std::string& format, std::string& pluginId, uint32_t count) {
+        plugin_host->prewarmPluginInstances(static_cast<uint32_t>(sampleRate),
+                                            static_cast<uint32_t>(audio_buffer_size_in_frames),
+                                            default_input_channels_,
+                                            default_output_channels_,
+                                            false,
+                                            format,
+                                            pluginId,
+                                            count);
+    }
+
     bool SequencerEngineImpl::removePluginInstance(int32_t instanceId) {
-        if (!executing_track_freeze_render_step_ &&
+        if (!executingTrackFreezeRenderStep() &&
             frozen_track_manager_->isInstanceBusy(instanceId))
             return false;
         // Hide and destroy UI first (if caller didn't already)
@@ -2382,6 +2825,10 @@ namespace uapmd {
             else
                 dirty_track_reference_ids_.erase(trackId);
         }
+        // An edited track goes back to live processing before the freeze
+        // manager would schedule a re-render of it.
+        if (dirty && auto_freeze_scheduler_)
+            auto_freeze_scheduler_->trackBecameDirty(trackIndex);
         if (dirty && frozen_track_manager_)
             frozen_track_manager_->projectTrackBecameDirty(trackIndex);
     }
@@ -2452,8 +2899,11 @@ namespace uapmd {
                 if (entry.second)
                     entry.second->requestStopFlush();
         };
+        // A background render's note flow must not be cut by live transport.
+        auto* withheldTrack = background_render_track_.load(std::memory_order_acquire);
         for (auto& track : tracks_)
-            flushTrackNotes(track.get());
+            if (track.get() != withheldTrack)
+                flushTrackNotes(track.get());
         flushTrackNotes(master_track_.get());
     }
 
@@ -2620,30 +3070,16 @@ namespace uapmd {
                 int32_t paramId = (bank * 128) + index;
                 double value = static_cast<double>(value32) / 4294967295.0;
 
-                // FIXME: we have to strictly determine whether the output event handler must be RT-safe or not.
-                // Defer the node lookup and notification to the main thread. This
-                // callback runs on the audio thread, where getPluginNode() is both
-                // forbidden (it takes the graph's non-realtime farbot access, a
-                // blocking mutex) and deadlock-prone: the UI thread holds that mutex
-                // while spin-waiting for the audio thread in nonRealtimeRelease().
-                // The parameter listeners are UI/JS code that expects the main
-                // thread anyway (all other notify sites run there).
-                // FIXME: enqueueTaskOnMainThread() allocates and briefly locks the
-                // task queue mutex, so this path is not strictly lock-free; NRPN
-                // output events are sporadic enough that this is acceptable for now.
-                remidy::EventLoop::enqueueTaskOnMainThread([this, instanceId, paramId, value] {
-                    for (const auto& track : tracks()) {
-                        if (auto* node = track->graph().getPluginNode(instanceId)) {
-                            node->parameterUpdateEvent().notify(paramId, value);
-                            return;
-                        }
-                    }
-                    if (master_track_) {
-                        if (auto* node = master_track_->graph().getPluginNode(instanceId)) {
-                            node->parameterUpdateEvent().notify(paramId, value);
-                        }
-                    }
-                });
+                // The node lookup and notification happen on the main thread.
+                // getPluginNode() takes the graph's non-realtime farbot access, a
+                // blocking mutex that the UI thread holds while spin-waiting for
+                // the audio thread in nonRealtimeRelease(), and the parameter
+                // listeners are UI/JS code that expects the main thread anyway.
+                // Posting the task allocates, so the audio thread only queues the
+                // value and the MIDI output worker posts it. Freeze renders are
+                // not the queue's producer and their values are not announced.
+                if (!executingTrackFreezeRenderStep())
+                    plugin_parameter_output_queue_.try_enqueue({instanceId, paramId, value});
             }
 
             // Rewrite group field
@@ -2665,7 +3101,7 @@ namespace uapmd {
 
     // UMP routing
     void SequencerEngineImpl::enqueueUmp(int32_t instanceId, uapmd_ump_t* ump, size_t sizeInBytes, uapmd_timestamp_t timestamp) {
-        if (!executing_track_freeze_render_step_ &&
+        if (!executingTrackFreezeRenderStep() &&
             frozen_track_manager_->isInstanceBusy(instanceId))
             return;
         auto scheduleForTrack = [&](SequencerTrack* track) {
@@ -2949,9 +3385,29 @@ namespace uapmd {
                 }
     }
 
+    void SequencerEngineImpl::notifyPluginParameterOutput(int32_t instanceId, int32_t paramId, double value) {
+        for (const auto& track : tracks()) {
+            if (auto* node = track->graph().getPluginNode(instanceId)) {
+                node->parameterUpdateEvent().notify(paramId, value);
+                return;
+            }
+        }
+        if (master_track_) {
+            if (auto* node = master_track_->graph().getPluginNode(instanceId))
+                node->parameterUpdateEvent().notify(paramId, value);
+        }
+    }
+
     void SequencerEngineImpl::runPlatformMidiOutputWorker() {
         while (platform_midi_output_worker_running_.load(std::memory_order_acquire)) {
             bool sent = false;
+            PluginParameterOutput parameter;
+            while (plugin_parameter_output_queue_.try_dequeue(parameter)) {
+                remidy::EventLoop::enqueueTaskOnMainThread([this, parameter] {
+                    notifyPluginParameterOutput(parameter.instance_id, parameter.param_id, parameter.value);
+                });
+                sent = true;
+            }
             {
                 const auto routes = platform_midi_output_routes_.protect(1);
                 if (routes) for (const auto& route : *routes) {
@@ -2968,7 +3424,7 @@ namespace uapmd {
     }
 
     void SequencerEngineImpl::sendNoteOn(int32_t instanceId, int32_t note) {
-        if (!executing_track_freeze_render_step_ &&
+        if (!executingTrackFreezeRenderStep() &&
             frozen_track_manager_->isInstanceBusy(instanceId))
             return;
         uapmd_ump_t umps[2];
@@ -2979,7 +3435,7 @@ namespace uapmd {
     }
 
     void SequencerEngineImpl::sendNoteOff(int32_t instanceId, int32_t note) {
-        if (!executing_track_freeze_render_step_ &&
+        if (!executingTrackFreezeRenderStep() &&
             frozen_track_manager_->isInstanceBusy(instanceId))
             return;
         uapmd_ump_t umps[2];
@@ -2990,7 +3446,7 @@ namespace uapmd {
     }
 
     void SequencerEngineImpl::sendPitchBend(int32_t instanceId, float normalizedValue) {
-        if (!executing_track_freeze_render_step_ &&
+        if (!executingTrackFreezeRenderStep() &&
             frozen_track_manager_->isInstanceBusy(instanceId))
             return;
         uapmd_ump_t umps[2];
@@ -3003,7 +3459,7 @@ namespace uapmd {
     }
 
     void SequencerEngineImpl::sendChannelPressure(int32_t instanceId, float pressure) {
-        if (!executing_track_freeze_render_step_ &&
+        if (!executingTrackFreezeRenderStep() &&
             frozen_track_manager_->isInstanceBusy(instanceId))
             return;
         uapmd_ump_t umps[2];
@@ -3016,7 +3472,7 @@ namespace uapmd {
     }
 
     void SequencerEngineImpl::setParameterValue(int32_t instanceId, int32_t index, double value) {
-        if (!executing_track_freeze_render_step_ &&
+        if (!executingTrackFreezeRenderStep() &&
             frozen_track_manager_->isInstanceBusy(instanceId))
             return;
         auto* instance = getPluginInstance(instanceId);
@@ -3041,6 +3497,20 @@ namespace uapmd {
         offline_rendering_.store(enabled, std::memory_order_release);
     }
 
+    AudioContentType uapmd::SequencerEngineImpl::audioDataType() {
+        return sequence.masterContext().audioDataType();
+    }
+
+    void uapmd::SequencerEngineImpl::audioDataType(AudioContentType dataType) {
+        // Every track, pump slot, mix and master context shares this master
+        // context. Instances that already exist keep what they were configured
+        // for and are converted around.
+        sequence.masterContext().audioDataType(dataType);
+        plugin_host->processingDataType(dataType);
+        // The buffers still hold the previous format.
+        resetProcessingState();
+    }
+
     void uapmd::SequencerEngineImpl::cleanupEmptyTracks() {
         // It uses busy-waiting to ensure the audio thread is not currently processing
         // the track before deletion.
@@ -41,6 +41,7 @@ namespace uapmd {
         double tailLengthInSeconds() override { return graph_ ? graph_->mainOutputTailLengthInSeconds() : 0.0; }
         double trackGain() const override;
         bool trackGain(double value) override;
+        webaudio_compat::GainNode* trackGainNode() override { return findTrackGainNode(); }
         bool muted() const override { return muted_.load(std::memory_order_acquire); }
         void muted(bool value) override { muted_.store(value, std::memory_order_release); }
         bool solo() const override { return solo_.load(std::memory_order_acquire); }
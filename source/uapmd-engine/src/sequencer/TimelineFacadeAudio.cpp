@@ -26,22 +26,7 @@ namespace uapmd {
         const auto masterSnapshotGuard = master_track_snapshot_.protect();
         const auto& masterSnapshot = *masterSnapshotGuard;
         auto updateTransportMetaForPlayhead = [&masterSnapshot, this](TimelineState& state) {
-            if (masterSnapshot.empty())
-                return;
-            const double playheadSeconds =
-                static_cast<double>(state.playheadPosition.samples) /
-                std::max(1.0, static_cast<double>(sampleRate_));
-            for (const auto& point : masterSnapshot.tempoPoints) {
-                if (point.timeSeconds <= playheadSeconds) {
-                    state.tempo = point.bpm;
-                } else break;
-            }
-            for (const auto& point : masterSnapshot.timeSignaturePoints) {
-                if (point.timeSeconds <= playheadSeconds) {
-                    state.timeSignatureNumerator = point.signature.numerator;
-                    state.timeSignatureDenominator = point.signature.denominator;
-                } else break;
-            }
+            applyMasterTrackTransportMeta(masterSnapshot, state);
         };
 
         const bool offlineRenderPlaying = engine_.offlineRendering();
@@ -67,6 +52,7 @@ namespace uapmd {
         // content being frozen.
         renderTransport.isPlaying =
             timeline_.isPlaying || offlineRenderPlaying;
+        renderTransport.offlineRendering = offlineRenderPlaying;
         renderTransport.playheadPosition.samples = wrapToLoopRange(
             (timeline_.isPlaying || offlineRenderPlaying ||
              renderPlayheadRaw != audiblePlayheadSamples) ?
@@ -113,12 +99,15 @@ namespace uapmd {
                     static_cast<uint32_t>(process.inputChannelCount(0)),
                     static_cast<uint32_t>(trackContext->inputChannelCount(0))
                 );
-                for (uint32_t ch = 0; ch < deviceChannels; ++ch) {
-                    const float* src = process.getFloatInBuffer(0, ch);
-                    float* dst = trackContext->getFloatInBuffer(0, ch);
-                    if (src && dst)
-                        std::memcpy(dst, src, safeFrames * sizeof(float));
-                }
+                trackContext->withSampleType([&](auto* tag) {
+                    using SampleType = std::remove_pointer_t<decltype(tag)>;
+                    for (uint32_t ch = 0; ch < deviceChannels; ++ch) {
+                        const float* src = process.getFloatInBuffer(0, ch);
+                        auto* dst = trackContext->getInBuffer<SampleType>(0, ch);
+                        if (src && dst)
+                            std::copy_n(src, safeFrames, dst);
+                    }
+                });
             }
 
             auto renderTimeline = renderTransport;
@@ -138,6 +127,11 @@ namespace uapmd {
             renderTimeline.seekTo(renderPosition, sampleRate_);
             updateTransportMetaForPlayhead(renderTimeline);
 
+            // Automation is rendered per segment too, so it wraps with the clips.
+            auto* automationEvents = renderTransport.isPlaying && i < targetSequence.automation.size()
+                ? targetSequence.automation[i] : nullptr;
+            auto* automation = automationEvents ? engine_.parameterAutomationManager() : nullptr;
+
             int32_t destinationOffsetFrames = 0;
             int32_t remainingFrames = safeFrames;
             int64_t segmentStartSample = renderStartSample;
@@ -167,6 +161,9 @@ namespace uapmd {
                     segmentStartSample,
                     destinationOffsetFrames,
                     segmentFrames);
+                if (automation)
+                    automation->render(static_cast<uapmd_track_index_t>(i), segmentStartSample,
+                                       destinationOffsetFrames, segmentFrames, *automationEvents);
 
                 destinationOffsetFrames += segmentFrames;
                 remainingFrames -= segmentFrames;
@@ -177,6 +174,61 @@ namespace uapmd {
         }
     }
 
+    void TimelineFacadeImpl::processTrackAudioForRender(
+            AudioProcessContext& process,
+            TimelineTrack& track,
+            AudioProcessContext& trackContext,
+            const TimelineState& baseTimeline,
+            int64_t renderStartSample) {
+        const auto masterSnapshotGuard = master_track_snapshot_.protect();
+
+        // A private running transport: timeline_ is written by the audio
+        // thread, so it is neither read nor written here and live playback is
+        // unaffected. Looping is never applied to renders.
+        TimelineState renderTimeline = baseTimeline;
+        renderTimeline.isPlaying = true;
+        renderTimeline.offlineRendering = true;
+        renderTimeline.loopEnabled = false;
+        TimelinePosition renderPosition{};
+        renderPosition.samples = std::max<int64_t>(0, renderStartSample);
+        renderTimeline.seekTo(renderPosition, sampleRate_);
+        applyMasterTrackTransportMeta(*masterSnapshotGuard, renderTimeline);
+
+        auto& masterCtx = process.masterContext();
+        masterCtx.playbackPositionSamples(renderPosition.samples);
+        masterCtx.isPlaying(true);
+        masterCtx.tempo(static_cast<uint32_t>(60000000.0 / renderTimeline.tempo));
+        masterCtx.timeSignatureNumerator(renderTimeline.timeSignatureNumerator);
+        masterCtx.timeSignatureDenominator(renderTimeline.timeSignatureDenominator);
+
+        const auto frames = static_cast<int32_t>(std::min(
+            static_cast<size_t>(process.frameCount()),
+            trackContext.audioBufferCapacityInFrames()));
+        track.processAudioForRenderSegment(
+            trackContext, renderTimeline, renderPosition.samples, 0, frames);
+    }
+
+    void TimelineFacadeImpl::applyMasterTrackTransportMeta(
+            const MasterTrackSnapshot& snapshot,
+            TimelineState& state) const {
+        if (snapshot.empty())
+            return;
+        const double playheadSeconds =
+            static_cast<double>(state.playheadPosition.samples) /
+            std::max(1.0, static_cast<double>(sampleRate_));
+        for (const auto& point : snapshot.tempoPoints) {
+            if (point.timeSeconds <= playheadSeconds) {
+                state.tempo = point.bpm;
+            } else break;
+        }
+        for (const auto& point : snapshot.timeSignaturePoints) {
+            if (point.timeSeconds <= playheadSeconds) {
+                state.timeSignatureNumerator = point.signature.numerator;
+                state.timeSignatureDenominator = point.signature.denominator;
+            } else break;
+        }
+    }
+
     void TimelineFacadeImpl::onTrackAdded(
             uint32_t outputChannels,
             double sampleRate,
@@ -90,12 +90,17 @@ namespace uapmd {
         }
 
         int32_t sourceNodeId = next_source_node_id_++;
-        auto sourceNode = std::make_unique<AudioFileSourceNode>(
-            sourceNodeId,
-            std::move(reader),
-            static_cast<double>(sampleRate_),
-            audioWarps
-        );
+        // Another clip of the same file already holds it decoded; a looped
+        // or repeated sample is decoded once per project, not once per clip.
+        auto decoded = findDecodedAudioSource(filepath);
+        auto sourceNode = decoded
+            ? std::make_unique<AudioFileSourceNode>(sourceNodeId, *decoded, audioWarps)
+            : std::make_unique<AudioFileSourceNode>(
+                sourceNodeId,
+                std::move(reader),
+                static_cast<double>(sampleRate_),
+                audioWarps
+            );
 
         int64_t durationSamples = sourceNode->totalLength();
 
@@ -114,6 +119,12 @@ namespace uapmd {
 
         int32_t clipId = timelineTrack.addClip(clip, std::move(sourceNode));
         if (clipId >= 0) {
+            if (!filepath.empty()) {
+                // Files whose clips are all gone would otherwise stay listed forever.
+                std::erase_if(decoded_audio_sources_, [](const auto& entry) { return entry.second.expired(); });
+                decoded_audio_sources_[filepath] = std::dynamic_pointer_cast<AudioFileSourceNode>(
+                    timelineTrack.getSourceNode(sourceNodeId));
+            }
             result.success = true;
             result.clipId = clipId;
             result.sourceNodeId = sourceNodeId;
@@ -124,6 +135,23 @@ namespace uapmd {
         return result;
     }
 
+    std::shared_ptr<AudioFileSourceNode> TimelineFacadeImpl::findDecodedAudioSource(const std::string& filepath) {
+        if (filepath.empty())
+            return nullptr;
+        auto it = decoded_audio_sources_.find(filepath);
+        if (it == decoded_audio_sources_.end())
+            return nullptr;
+        auto node = it->second.lock();
+        if (!node) {
+            decoded_audio_sources_.erase(it);
+            return nullptr;
+        }
+        // Decoded for another sample rate.
+        if (node && std::abs(node->sampleRate() - static_cast<double>(sampleRate_)) >= 1.0)
+            return nullptr;
+        return node;
+    }
+
     TimelineFacade::ClipAddResult TimelineFacadeImpl::addAudioClipToTrack(
             int32_t trackIndex,
             const TimelinePosition& position,
@@ -147,6 +175,53 @@ namespace uapmd {
         origin);
     }
 
+    TimelineFacade::ClipAddResult TimelineFacadeImpl::addLinkedClip(
+            int32_t trackIndex,
+            const TimelinePosition& position,
+            int32_t sourceTrackIndex,
+            int32_t sourceClipId,
+            ProjectMutationOrigin origin) {
+                ClipAddResult result;
+        auto* targetTrack = resolveTrack(trackIndex);
+        auto* sourceTrack = resolveTrack(sourceTrackIndex);
+        if (!targetTrack || !sourceTrack) {
+            result.error = "Invalid track index";
+            return result;
+        }
+        const auto* sourceClip = sourceTrack->clipManager().getClip(sourceClipId);
+        if (!sourceClip) {
+            result.error = "Invalid clip";
+            return result;
+        }
+
+        const int32_t sourceNodeId = next_source_node_id_++;
+        ClipData clip = *sourceClip;
+        clip.clipId = -1;
+        clip.referenceId = takePendingClipReferenceId();
+        clip.position = position;
+        clip.sourceNodeInstanceId = sourceNodeId;
+        clip.setTimeReference(TimeReference::fromContainerStart({}, position.toSeconds(sampleRate_)), sampleRate_);
+
+        auto sourceNode = sourceTrack->getSourceNode(sourceClip->sourceNodeInstanceId);
+        int32_t clipId = -1;
+        if (auto midi = std::dynamic_pointer_cast<MidiClipSourceNode>(sourceNode))
+            clipId = targetTrack->addClip(clip, std::make_unique<MidiClipSourceNode>(sourceNodeId, *midi));
+        else if (auto audio = std::dynamic_pointer_cast<AudioFileSourceNode>(sourceNode))
+            clipId = targetTrack->addClip(clip, std::make_unique<AudioFileSourceNode>(
+                sourceNodeId, *audio, audio->audioWarps()));
+        if (clipId < 0) {
+            result.error = "Failed to add linked clip to track";
+            return result;
+        }
+
+        result.success = true;
+        result.clipId = clipId;
+        result.sourceNodeId = sourceNodeId;
+        emitClipAdded(*targetTrack, clipId, sourceNodeId);
+        notifyTimelineChanged();
+        return recordAddedClip(trackIndex, std::move(result), origin);
+    }
+
     TimelineFacade::ClipAddResult TimelineFacadeImpl::addMidiClipToTrack(
             int32_t trackIndex,
             const TimelinePosition& position,
@@ -400,10 +475,24 @@ namespace uapmd {
                 return false;
         }
 
-        const auto sourcePath = filepath.empty() ? clip->filepath : filepath;
-        auto reader = createAudioFileReaderFromPath(sourcePath);
-        if (!reader)
-            return false;
+        // Re-warping the same file reuses the decoded audio of the current
+        // source; warps are applied while playing, so nothing is rendered here.
+        std::shared_ptr<AudioFileSourceNode> currentSource;
+        if (filepath.empty()) {
+            currentSource = std::dynamic_pointer_cast<AudioFileSourceNode>(
+                targetTrack->getSourceNode(clip->sourceNodeInstanceId));
+            if (currentSource && std::abs(currentSource->sampleRate() - static_cast<double>(sampleRate_)) >= 1.0)
+                currentSource.reset();
+        } else {
+            currentSource = findDecodedAudioSource(filepath);
+        }
+        std::unique_ptr<AudioFileReader> reader;
+        if (!currentSource) {
+            const auto sourcePath = filepath.empty() ? clip->filepath : filepath;
+            reader = createAudioFileReaderFromPath(sourcePath);
+            if (!reader)
+                return false;
+        }
 
         // Resolved against the clip as it will be, not as it is: a warp may
         // reference a marker that this same call is adding.
@@ -414,11 +503,16 @@ namespace uapmd {
         auto resolvedWarps = resolveAudioWarpPoints(
             target, audioWarps, lookup, masterTrackMarkers, static_cast<double>(sampleRate_));
 
-        auto replacement = std::make_unique<AudioFileSourceNode>(
-            clip->sourceNodeInstanceId,
-            std::move(reader),
-            static_cast<double>(sampleRate_),
-            std::move(resolvedWarps));
+        auto replacement = currentSource
+            ? std::make_unique<AudioFileSourceNode>(
+                clip->sourceNodeInstanceId,
+                *currentSource,
+                std::move(resolvedWarps))
+            : std::make_unique<AudioFileSourceNode>(
+                clip->sourceNodeInstanceId,
+                std::move(reader),
+                static_cast<double>(sampleRate_),
+                std::move(resolvedWarps));
         const int64_t sourceDuration = replacement->totalLength();
 
         {
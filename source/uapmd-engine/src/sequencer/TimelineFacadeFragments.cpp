@@ -659,6 +659,7 @@ namespace uapmd {
         auto& clips = targetTrack->clipManager();
         clips.setClipGain(result.clipId, source.gain);
         clips.setClipMuted(result.clipId, source.muted);
+        clips.setClipRegion(result.clipId, source.region);
         if (!clips.setClipAnchor(result.clipId, source.timeReference(sampleRate_), sampleRate_)) {
             removeClipRaw(*targetTrack, result.clipId);
             result.success = false;
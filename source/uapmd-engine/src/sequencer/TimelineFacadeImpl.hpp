@@ -77,9 +77,17 @@ namespace uapmd {
         MasterTrackSnapshot computeMasterTrackSnapshot() const;
         // Recomputes and publishes for the audio thread. Model thread only.
         void rebuildMasterTrackSnapshot();
+        // Applies the tempo and time signature in effect at state's playhead.
+        void applyMasterTrackTransportMeta(const MasterTrackSnapshot& snapshot,
+                                           TimelineState& state) const;
 
         TimelineState timeline_;
         int32_t next_source_node_id_{1};
+        // The latest source node decoded from each audio file; clips of the
+        // same file share its decoded audio. Entries of removed nodes are
+        // erased as they are found. Model thread only.
+        std::unordered_map<std::string, std::weak_ptr<AudioFileSourceNode>> decoded_audio_sources_{};
+        std::shared_ptr<AudioFileSourceNode> findDecodedAudioSource(const std::string& filepath);
         uint32_t next_timeline_track_reference_{1};
         std::function<void()> timeline_changed_callback_{};
         // Detail for the most recent failed property write; see
@@ -865,6 +873,13 @@ namespace uapmd {
             const std::string& filepath,
             ProjectMutationOrigin origin) override;
 
+        ClipAddResult addLinkedClip(
+            int32_t trackIndex,
+            const TimelinePosition& position,
+            int32_t sourceTrackIndex,
+            int32_t sourceClipId,
+            ProjectMutationOrigin origin) override;
+
         ClipAddResult addMidiClipToTrack(
             int32_t trackIndex,
             const TimelinePosition& position,
@@ -1017,6 +1032,7 @@ namespace uapmd {
             std::string_view pluginId,
             std::string_view nodeId,
             bool bypassed,
+            bool sleepsWhenSilent,
             uint8_t group,
             const std::vector<uint8_t>& state,
             const std::vector<uapmd_graph::AudioPluginGraphConnection>& connections,
@@ -1167,6 +1183,12 @@ namespace uapmd {
 
         void processTracksAudio(AudioProcessContext& process, SequenceProcessContext& targetSequence) override;
 
+        void processTrackAudioForRender(AudioProcessContext& process,
+                                        TimelineTrack& track,
+                                        AudioProcessContext& trackContext,
+                                        const TimelineState& renderTimeline,
+                                        int64_t renderStartSample) override;
+
         void onTrackAdded(
             uint32_t outputChannels,
             double sampleRate,
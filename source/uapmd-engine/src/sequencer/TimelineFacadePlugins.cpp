@@ -114,6 +114,7 @@ namespace uapmd {
             std::string_view pluginId,
             std::string_view nodeId,
             bool bypassed,
+            bool sleepsWhenSilent,
             uint8_t group,
             const std::vector<uint8_t>& state,
             const std::vector<uapmd_graph::AudioPluginGraphConnection>& connections,
@@ -165,7 +166,7 @@ namespace uapmd {
             trackIndex,
             formatCopy,
             pluginIdCopy,
-            [this, bypassed, group, state, restoreConnections = std::move(restoreConnections)](
+            [this, bypassed, sleepsWhenSilent, group, state, restoreConnections = std::move(restoreConnections)](
                 int32_t newInstanceId,
                 int32_t,
                 std::string addError) mutable {
@@ -184,6 +185,7 @@ namespace uapmd {
                     return;
                 }
                 restored->bypassed(bypassed);
+                restored->sleepsWhenSilent(sleepsWhenSilent);
                 if (state.empty()) {
                     restoreConnections(newInstanceId, {});
                     return;
@@ -266,6 +268,7 @@ namespace uapmd {
              format = instance->formatName(),
              pluginId = instance->pluginId(),
              bypassed = instance->bypassed(),
+             sleepsWhenSilent = instance->sleepsWhenSilent(),
              group = engine_.getInstanceGroup(instanceId),
              connections = std::move(connections),
              completion = std::move(finish)](
@@ -281,6 +284,7 @@ namespace uapmd {
                      format = std::move(format),
                      pluginId = std::move(pluginId),
                      bypassed,
+                     sleepsWhenSilent,
                      group,
                      connections = std::move(connections),
                      state = std::move(state),
@@ -304,8 +308,9 @@ namespace uapmd {
                             .format = std::move(format),
                             .pluginId = std::move(pluginId),
                             .bypassed = bypassed,
+                            .sleepsWhenSilent = sleepsWhenSilent,
                             .group = group,
-                            .state = std::move(state),
+                            .state = PluginStateStore::instance().intern(std::move(state)),
                             .connections = std::move(connections)
                         };
                         const PluginAddress address{
@@ -383,10 +388,12 @@ namespace uapmd {
                         using Command = timeline_detail::PluginStateCommand;
                         const PluginAddress address{
                             target.trackReferenceId, target.nodeId};
+                        auto& stateStore = PluginStateStore::instance();
                         auto forward = std::make_shared<Command>(
-                            *this, address, *after, "Load plug-in state");
+                            *this, address, stateStore.intern(*after), "Load plug-in state");
                         auto revert = std::make_shared<Command>(
-                            *this, address, std::move(before), "Load plug-in state");
+                            *this, address, stateStore.intern(std::move(before)),
+                            "Load plug-in state");
                         writePluginState(
                             address,
                             *after,
@@ -432,8 +439,9 @@ namespace uapmd {
             snapshot->pluginId,
             address.nodeId,
             snapshot->bypassed,
+            snapshot->sleepsWhenSilent,
             snapshot->group,
-            snapshot->state,
+            snapshot->state ? snapshot->state->bytes() : std::vector<uint8_t>{},
             snapshot->connections,
             [completion = std::move(completion)](
                 int32_t restoredInstanceId, std::string error) mutable {
@@ -519,7 +527,8 @@ namespace uapmd {
                                     std::make_shared<timeline_detail::PluginPresetCommand>(
                                         *this, address, presetIndex, "Load plug-in preset"),
                                     std::make_shared<timeline_detail::PluginStateCommand>(
-                                        *this, address, std::move(before),
+                                        *this, address,
+                                        PluginStateStore::instance().intern(std::move(before)),
                                         "Load plug-in preset"),
                                     origin,
                                     std::move(completion));
@@ -134,16 +134,18 @@ namespace uapmd::timeline_detail {
         std::string format;
         std::string pluginId;
         bool bypassed{false};
+        bool sleepsWhenSilent{false};
         uint8_t group{0};
-        std::vector<uint8_t> state;
+        PluginStateRef state;
         std::vector<uapmd_graph::AudioPluginGraphConnection> connections;
     };
 
+    // Leaves out the state, which the holding command reports as a shared
+    // payload.
     inline size_t retainedValueSize(const PluginInstanceSnapshot& snapshot) {
         size_t result = sizeof(snapshot)
             + snapshot.format.capacity()
             + snapshot.pluginId.capacity()
-            + snapshot.state.capacity()
             + snapshot.connections.capacity()
                 * sizeof(uapmd_graph::AudioPluginGraphConnection);
         for (const auto& connection : snapshot.connections)
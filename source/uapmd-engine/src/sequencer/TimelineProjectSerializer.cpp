@@ -1,5 +1,6 @@
 #include "TimelineProjectSerializer.hpp"
 
+#include <algorithm>
 #include <charconv>
 #include <unordered_set>
 #include <fstream>
@@ -69,6 +70,17 @@ namespace uapmd::timeline_detail {
             }
             return escaped;
         }
+
+    // Whether two clips play one shared event table or decoded audio.
+    bool sharesSource(const SourceNode& a, const SourceNode& b) {
+        if (auto* midiA = dynamic_cast<const MidiClipSourceNode*>(&a))
+            if (auto* midiB = dynamic_cast<const MidiClipSourceNode*>(&b))
+                return midiA->sharesEventsWith(*midiB);
+        if (auto* audioA = dynamic_cast<const AudioFileSourceNode*>(&a))
+            if (auto* audioB = dynamic_cast<const AudioFileSourceNode*>(&b))
+                return audioA->sharesAudioWith(*audioB);
+        return false;
+    }
     }
 
 
@@ -150,9 +162,15 @@ namespace uapmd::timeline_detail {
             operation.project_dir = operation.project_file.parent_path();
             if (!operation.project_dir.empty())
                 std::filesystem::create_directories(operation.project_dir);
-            operation.plugin_state_dir = operation.project_dir / "plugin_states";
+            // One directory per project file, so that pruning a save's
+            // superseded states never reaches those of a sibling project.
+            operation.plugin_state_dir =
+                operation.project_dir / "plugin_states" / operation.project_file.filename();
             operation.graph_dir = operation.project_dir / "graphs";
             operation.project = UapmdProjectData::create();
+            if (options.chunkContainer)
+                operation.chunk_writer = std::make_unique<ProjectChunkContainerWriter>(
+                    ProjectChunkContainer::containerPathFor(operation.project_file));
 
             ProjectSaveBuild build;
             build.clipDir = operation.project_dir / "clips";
@@ -162,6 +180,7 @@ namespace uapmd::timeline_detail {
             if (!serializeMasterTrack(operation, build, error))
                 return false;
             applySerializedClipAnchors(build);
+            applySerializedClipLinks(build);
             return true;
         } catch (const std::exception& e) {
             error = e.what();
@@ -169,6 +188,32 @@ namespace uapmd::timeline_detail {
         }
     }
 
+    // Clips sharing one source, such as those placed by addLinkedClip(), are
+    // written as links to the first of them so that a load shares it again.
+    // Master track clips are restored on their own and are never linked.
+    void TimelineProjectSerializer::applySerializedClipLinks(ProjectSaveBuild& build) {
+        std::vector<std::pair<std::shared_ptr<SourceNode>, std::string>> firstClipsBySource;
+        const auto timelineTracks = facade_.tracks();
+        for (const auto& serializedTrack : build.tracks) {
+            if (serializedTrack.trackIndex == kMasterTrackIndex)
+                continue;
+            auto* timelineTrack = timelineTracks[static_cast<size_t>(serializedTrack.trackIndex)];
+            for (const auto& clip : serializedTrack.clips) {
+                auto clipIt = build.clipLookup.find(clip.referenceId);
+                auto source = timelineTrack->getSourceNode(clip.sourceNodeInstanceId);
+                if (clipIt == build.clipLookup.end() || !source)
+                    continue;
+                auto first = std::ranges::find_if(firstClipsBySource, [&source](const auto& entry) {
+                    return sharesSource(*entry.first, *source);
+                });
+                if (first != firstClipsBySource.end())
+                    clipIt->second->linkedReferenceId(first->second);
+                else
+                    firstClipsBySource.emplace_back(std::move(source), clip.referenceId);
+            }
+        }
+    }
+
     bool TimelineProjectSerializer::serializeTracks(
         PendingProjectSaveContext& operation,
         const TimelineFacade::ProjectSaveOptions& options,
@@ -208,6 +253,7 @@ namespace uapmd::timeline_detail {
                         std::format("Clip {} on track {}", clip.clipId, trackIndex),
                         false,
                         build.midiExportCounter,
+                        operation.chunk_writer.get(),
                         error))
                     return false;
             }
@@ -284,6 +330,7 @@ namespace uapmd::timeline_detail {
                         "Master clip",
                         true,
                         build.midiExportCounter,
+                        operation.chunk_writer.get(),
                         error))
                     return false;
             }
@@ -357,18 +404,22 @@ namespace uapmd::timeline_detail {
                         return;
                     }
 
-                    std::string writeError;
-                    auto relativePath = sequencer_detail::writePluginStateBlob(
-                        operation->project_dir,
-                        operation->plugin_state_dir,
-                        pending.scope_label,
-                        pending.plugin_order,
-                        pending.instance_id,
-                        state,
-                        writeError);
-                    if (!writeError.empty()) {
-                        complete({false, std::move(writeError)});
-                        return;
+                    std::string relativePath;
+                    if (operation->chunk_writer) {
+                        relativePath = operation->chunk_writer->add(std::move(state));
+                    } else {
+                        std::string writeError;
+                        relativePath = sequencer_detail::writePluginStateBlob(
+                            operation->project_dir,
+                            operation->plugin_state_dir,
+                            state,
+                            writeError);
+                        if (!writeError.empty()) {
+                            complete({false, std::move(writeError)});
+                            return;
+                        }
+                        operation->written_state_files.insert(
+                            std::filesystem::path(relativePath).filename().string());
                     }
 
                     if (pending.set_state_file)
@@ -402,6 +453,14 @@ namespace uapmd::timeline_detail {
             }
         }
 
+        // The manifest refers to chunks by content, so they must be on disk
+        // before it is.
+        std::string chunkError;
+        if (operation->chunk_writer && !operation->chunk_writer->commit(chunkError)) {
+            complete({false, std::move(chunkError)});
+            return;
+        }
+
         std::string projectDataError;
         if (!saveProjectDataExtensions(*operation->project, projectDataError)) {
             complete({false, std::move(projectDataError)});
@@ -417,6 +476,12 @@ namespace uapmd::timeline_detail {
             complete({false, std::move(extensionError)});
             return;
         }
+        // Only now is no manifest left that refers to the superseded states.
+        // A chunk container save wrote no state files, so it has no list to
+        // compare the directory against.
+        if (!operation->chunk_writer && !operation->carries_unresolved_graph)
+            sequencer_detail::removeUnreferencedPluginStateBlobs(
+                operation->plugin_state_dir, operation->written_state_files);
 
         // Marking history and announcing the save touch the document, so they
         // run on the model thread even when the last plug-in reported from
@@ -469,6 +534,9 @@ namespace uapmd::timeline_detail {
         std::filesystem::path file;
         std::filesystem::path dir;
         std::unique_ptr<UapmdProjectData> project;
+        // Mapped when the manifest has a chunk container beside it. Plug-in
+        // load steps hold on to it until their state has been restored.
+        std::shared_ptr<const ProjectChunkContainer> chunks;
         UapmdProjectTrackData* masterTrack{nullptr};
         std::vector<ClipMarker> masterTrackMarkers;
         bool hasExplicitMasterTrackClips{false};
@@ -485,6 +553,50 @@ namespace uapmd::timeline_detail {
         TimelineFacade::ProjectLoadCallback callback;
     };
 
+    namespace {
+    // Reads a MIDI clip the manifest names either by path or by chunk
+    // reference. A chunk is decoded straight from the container mapping.
+    MidiClipReader::ClipInfo readProjectMidiClip(
+        const ProjectLoadRun& run,
+        const std::filesystem::path& resolvedPath,
+        const std::string& reference) {
+        if (!ProjectChunkContainer::isReference(reference))
+            return MidiClipReader::readAnyFormat(resolvedPath);
+
+        MidiClipReader::ClipInfo result;
+        auto id = ProjectChunkContainer::parseReference(reference);
+        auto bytes = id && run.chunks ? run.chunks->chunk(*id) : std::nullopt;
+        if (!bytes) {
+            result.success = false;
+            result.error = "MIDI clip chunk is missing from the project chunk container: " + reference;
+            return result;
+        }
+        return MidiClipReader::readSmf2Clip(*bytes);
+    }
+
+    // The clip a link saved by applySerializedClipLinks() points at, if it
+    // has been loaded already.
+    const LoadedClipRef* findLoadedClip(const ProjectLoadRun& run, const std::string& referenceId) {
+        if (referenceId.empty())
+            return nullptr;
+        for (const auto& [_, loaded] : run.loadedClips)
+            if (loaded.clipReferenceId == referenceId)
+                return &loaded;
+        return nullptr;
+    }
+
+    // A clip with a region keeps the length it was saved with; others take
+    // the length of their content, as they always have.
+    void restoreClipRegion(TimelineTrack& track, int32_t clipId, UapmdProjectClipData& clip) {
+        const auto region = clip.region();
+        if (region == ClipRegion{})
+            return;
+        track.clipManager().setClipRegion(clipId, region);
+        if (clip.durationSamples() > 0)
+            track.clipManager().resizeClip(clipId, clip.durationSamples());
+    }
+    }
+
     void TimelineProjectSerializer::loadProject(
         const std::filesystem::path& projectFile,
         TimelineFacade::ProjectLoadCallback callback) {
@@ -530,6 +642,19 @@ namespace uapmd::timeline_detail {
             return false;
         }
         run.dir = run.file.parent_path();
+        // Only the index is read here; chunks are paged in as clips and
+        // plug-in states are restored.
+        auto containerPath = ProjectChunkContainer::containerPathFor(run.file);
+        std::error_code containerEc;
+        if (std::filesystem::exists(containerPath, containerEc)) {
+            std::string chunkError;
+            run.chunks = ProjectChunkContainer::open(containerPath, chunkError);
+            if (!run.chunks)
+                std::cerr << "Warning: " << chunkError << std::endl;
+            else if (run.chunks->recoveredFromInterruptedSave())
+                std::cerr << "Warning: the last save to " << containerPath.string()
+                          << " was interrupted; using the chunks of the save before it" << std::endl;
+        }
         run.masterTrack = run.project->masterTrack();
         if (run.masterTrack) {
             run.masterTrackMarkers = run.masterTrack->markers();
@@ -707,6 +832,7 @@ namespace uapmd::timeline_detail {
             std::string nodeId = plugin.node_id;
             const std::string pluginName = plugin.display_name;
             const int32_t groupIndex = plugin.group_index;
+            const auto sleepsWhenSilent = plugin.sleeps_when_silent;
 
             if (pluginId.empty()) {
                 auto fallbackId = catalogFindByName(format, pluginName);
@@ -730,24 +856,30 @@ namespace uapmd::timeline_detail {
                 continue;
             }
 
-            std::filesystem::path resolvedState;
-            if (!stateFile.empty())
-                resolvedState = makeAbsolutePath(run.dir, stateFile);
+            SavedPluginStateSource resolvedState;
+            if (ProjectChunkContainer::isReference(stateFile)) {
+                resolvedState.container = run.chunks;
+                resolvedState.chunk = ProjectChunkContainer::parseReference(stateFile);
+                resolvedState.label = stateFile;
+            } else if (!stateFile.empty()) {
+                resolvedState.file = makeAbsolutePath(run.dir, stateFile);
+                resolvedState.label = resolvedState.file.string();
+            }
 
             const std::string pluginLabel = pluginName.empty() ? pluginId : pluginName;
 
             run.pluginSteps->push_back(
                 [this, trackIndex, format = std::move(format), pluginId = std::move(pluginId),
-                 resolvedState, groupIndex, pluginLabel, nodeId = std::move(nodeId)](
+                 resolvedState, groupIndex, sleepsWhenSilent, pluginLabel, nodeId = std::move(nodeId)](
                     std::function<void()> done) mutable {
                     engine_.addPluginToTrack(
                         trackIndex, format, pluginId,
-                        [this, resolvedState, groupIndex, pluginLabel, pluginId, format,
+                        [this, resolvedState, groupIndex, sleepsWhenSilent, pluginLabel, pluginId, format,
                          done = std::move(done)](
                             int32_t instanceId, int32_t, std::string error) mutable {
                             restoreLoadedPluginState(
-                                instanceId, error, resolvedState, groupIndex, pluginLabel,
-                                pluginId, format);
+                                instanceId, error, resolvedState, groupIndex, sleepsWhenSilent,
+                                pluginLabel, pluginId, format);
                             if (done)
                                 done();
                         },
@@ -756,14 +888,15 @@ namespace uapmd::timeline_detail {
         }
     }
 
-    // Applies the saved group and opaque state to a plug-in that has just been
-    // instantiated during a load. A plug-in that fails here is reported and
+    // Applies the saved group, sleep setting and opaque state to a plug-in
+    // that has just been instantiated during a load. A plug-in that fails here is reported and
     // skipped: one unavailable plug-in must not abort the whole project.
     void TimelineProjectSerializer::restoreLoadedPluginState(
         int32_t instanceId,
         const std::string& instantiationError,
-        const std::filesystem::path& stateFile,
+        const SavedPluginStateSource& state,
         int32_t groupIndex,
+        std::optional<bool> sleepsWhenSilent,
         const std::string& pluginLabel,
         const std::string& pluginId,
         const std::string& format) {
@@ -778,22 +911,36 @@ namespace uapmd::timeline_detail {
         // A saved group assignment overrides the automatically assigned one.
         if (groupIndex >= 0 && groupIndex <= 15)
             engine_.setInstanceGroup(instanceId, static_cast<uint8_t>(groupIndex));
-        if (stateFile.empty())
+        auto* instance = engine_.getPluginInstance(instanceId);
+        if (instance && sleepsWhenSilent)
+            instance->sleepsWhenSilent(*sleepsWhenSilent);
+        if (state.label.empty())
             return;
 
-        auto* instance = engine_.getPluginInstance(instanceId);
         if (!instance) {
             std::cerr << "Warning: Failed to get plugin instance " << instanceId
                       << " while restoring state for " << pluginLabel << std::endl;
             return;
         }
-        std::ifstream f(stateFile, std::ios::binary);
-        if (!f) {
-            std::cerr << "Warning: Failed to open state file for plugin "
-                      << pluginLabel << ": " << stateFile << std::endl;
-            return;
+        std::vector<uint8_t> data;
+        if (state.file.empty()) {
+            auto chunk = state.chunk && state.container
+                ? state.container->readChunk(*state.chunk) : std::nullopt;
+            if (!chunk) {
+                std::cerr << "Warning: Missing state chunk for plugin "
+                          << pluginLabel << ": " << state.label << std::endl;
+                return;
+            }
+            data = std::move(*chunk);
+        } else {
+            std::ifstream f(state.file, std::ios::binary);
+            if (!f) {
+                std::cerr << "Warning: Failed to open state file for plugin "
+                          << pluginLabel << ": " << state.file << std::endl;
+                return;
+            }
+            data.assign(std::istreambuf_iterator<char>(f), {});
         }
-        std::vector<uint8_t> data((std::istreambuf_iterator<char>(f)), {});
         instance->loadStateSync(data);
     }
 
@@ -836,13 +983,27 @@ namespace uapmd::timeline_detail {
         position.samples = static_cast<int64_t>(clip.absolutePositionInSamples());
 
         const auto clipType = clip.clipType();
+        const auto clipReference = clip.file().generic_string();
+        const bool inChunkContainer = ProjectChunkContainer::isReference(clipReference);
         std::filesystem::path resolvedPath = clip.file();
-        if (!resolvedPath.empty())
+        if (!resolvedPath.empty() && !inChunkContainer)
             resolvedPath = makeAbsolutePath(run.dir, resolvedPath);
+        // Chunks have no file name; the clip is named after its identity.
+        const auto clipName = inChunkContainer
+            ? clip.referenceId()
+            : resolvedPath.filename().string();
 
         auto* timelineTrack = facade_.tracks()[static_cast<size_t>(trackIndex)];
+        const auto* linkedClip = findLoadedClip(run, clip.linkedReferenceId());
 
         if (clipType != "midi") {
+            // A linked clip plays the file its link target was loaded from,
+            // whose decoded audio the timeline then shares between them.
+            if (linkedClip) {
+                const auto* target = linkedClip->track->clipManager().getClip(linkedClip->clipId);
+                if (target && target->clipType == ClipType::Audio && !target->filepath.empty())
+                    resolvedPath = target->filepath;
+            }
             std::unique_ptr<AudioFileReader> reader;
             std::string filepath;
             if (resolvedPath.empty()) {
@@ -873,6 +1034,7 @@ namespace uapmd::timeline_detail {
                 run.error = loadResult.error.empty() ? "Failed to load audio clip" : loadResult.error;
                 return false;
             }
+            restoreClipRegion(*timelineTrack, loadResult.clipId, clip);
             auto* loadedClip = timelineTrack->clipManager().getClip(loadResult.clipId);
             run.loadedClips[&clip] = LoadedClipRef{
                 timelineTrack,
@@ -881,11 +1043,14 @@ namespace uapmd::timeline_detail {
             return true;
         }
 
+        if (linkedClip && restoreLinkedMidiClip(run, clip, trackIndex, *linkedClip, position, clipName))
+            return true;
+
         if (resolvedPath.empty()) {
             run.error = "MIDI clip is missing file path";
             return false;
         }
-        auto clipInfo = MidiClipReader::readAnyFormat(resolvedPath);
+        auto clipInfo = readProjectMidiClip(run, resolvedPath, clipReference);
         if (!clipInfo.success) {
             run.error = clipInfo.error.empty() ? "Failed to parse MIDI clip" : clipInfo.error;
             return false;
@@ -910,7 +1075,7 @@ namespace uapmd::timeline_detail {
                 clipTempo,
                 std::move(musicalClip.tempo_changes),
                 std::move(musicalClip.time_signature_changes),
-                resolvedPath.filename().string(),
+                clipName,
                 clip.nrpnToParameterMapping(),
                 separated.hasMasterTrackClip(),
                 ProjectMutationOrigin::Load);
@@ -918,6 +1083,7 @@ namespace uapmd::timeline_detail {
                 run.error = loadResult.error.empty() ? "Failed to load MIDI clip" : loadResult.error;
                 return false;
             }
+            restoreClipRegion(*timelineTrack, loadResult.clipId, clip);
             auto* loadedClip = timelineTrack->clipManager().getClip(loadResult.clipId);
             if (loadedClip) {
                 loadedClip->markers = clip.markers();
@@ -938,7 +1104,7 @@ namespace uapmd::timeline_detail {
                 masterClip.tempo,
                 std::move(masterClip.tempo_changes),
                 std::move(masterClip.time_signature_changes),
-                std::format("{} Meta", resolvedPath.filename().string()),
+                std::format("{} Meta", clipName),
                 false, "",
                 ProjectMutationOrigin::Load);
             if (!masterLoadResult.success) {
@@ -958,6 +1124,57 @@ namespace uapmd::timeline_detail {
         return true;
     }
 
+    // Places a MIDI clip over the events of the clip it was linked to instead
+    // of reading its own copy, then applies what the clip saved for itself.
+    // Returns false, having added nothing, when the link cannot be restored.
+    bool TimelineProjectSerializer::restoreLinkedMidiClip(
+        ProjectLoadRun& run,
+        UapmdProjectClipData& clip,
+        int32_t trackIndex,
+        const LoadedClipRef& linkedClip,
+        const TimelinePosition& position,
+        const std::string& clipName) {
+        const auto timelineTracks = facade_.tracks();
+        const auto sourceTrack = std::ranges::find(timelineTracks, linkedClip.track);
+        const auto* target = linkedClip.track->clipManager().getClip(linkedClip.clipId);
+        if (sourceTrack == timelineTracks.end() || !target || target->clipType != ClipType::Midi)
+            return false;
+
+        auto loadResult = facade_.addLinkedClip(
+            trackIndex, position,
+            static_cast<int32_t>(std::distance(timelineTracks.begin(), sourceTrack)),
+            linkedClip.clipId,
+            ProjectMutationOrigin::Load);
+        if (!loadResult.success)
+            return false;
+
+        // The new clip took over the target's region and length; replace them
+        // with its own, as restoreClipRegion() would for an unlinked clip.
+        auto* timelineTrack = timelineTracks[static_cast<size_t>(trackIndex)];
+        auto& clips = timelineTrack->clipManager();
+        const auto region = clip.region();
+        clips.setClipRegion(loadResult.clipId, region);
+        auto source = std::dynamic_pointer_cast<MidiClipSourceNode>(
+            timelineTrack->getSourceNode(loadResult.sourceNodeId));
+        if (region != ClipRegion{} && clip.durationSamples() > 0)
+            clips.resizeClip(loadResult.clipId, clip.durationSamples());
+        else if (source)
+            clips.resizeClip(loadResult.clipId, source->totalLength());
+
+        auto* loadedClip = clips.getClip(loadResult.clipId);
+        if (loadedClip) {
+            loadedClip->name = clipName;
+            loadedClip->nrpnToParameterMapping = clip.nrpnToParameterMapping();
+            loadedClip->markers = clip.markers();
+            loadedClip->audioWarps = clip.audioWarps();
+        }
+        run.loadedClips[&clip] = LoadedClipRef{
+            timelineTrack,
+            loadResult.clipId,
+            loadedClip ? loadedClip->referenceId : std::string{}};
+        return true;
+    }
+
     // The master track carries the project's tempo and time-signature map.
     void TimelineProjectSerializer::restoreMasterTrackClips(ProjectLoadRun& run) {
         if (!run.error.empty() || !run.masterTrack)
@@ -967,10 +1184,14 @@ namespace uapmd::timeline_detail {
             if (!clip || clip->clipType() != "midi")
                 continue;
             host_.stageClipReferenceId(clip->referenceId());
-            auto resolvedPath = makeAbsolutePath(run.dir, clip->file());
-            if (resolvedPath.empty())
+            const auto clipReference = clip->file().generic_string();
+            const bool inChunkContainer = ProjectChunkContainer::isReference(clipReference);
+            auto resolvedPath = inChunkContainer
+                ? std::filesystem::path{}
+                : makeAbsolutePath(run.dir, clip->file());
+            if (resolvedPath.empty() && !inChunkContainer)
                 continue;
-            auto clipInfo = MidiClipReader::readAnyFormat(resolvedPath);
+            auto clipInfo = readProjectMidiClip(run, resolvedPath, clipReference);
             if (!clipInfo.success)
                 continue;
             double clipTempo = clipInfo.tempo_changes.empty()
@@ -989,7 +1210,7 @@ namespace uapmd::timeline_detail {
                 clipTempo,
                 std::move(clipInfo.tempo_changes),
                 std::move(clipInfo.time_signature_changes),
-                resolvedPath.filename().string(),
+                inChunkContainer ? clip->referenceId() : resolvedPath.filename().string(),
                 false,
                 resolvedPath.string(),
                 ProjectMutationOrigin::Load);
@@ -1182,6 +1403,7 @@ namespace uapmd::timeline_detail {
         // through as-is. Re-serializing it from the substitute runtime graph
         // would write it back as something less than it is.
         if (!sequencerTrack->unresolvedGraphPayload().empty()) {
+            operation.carries_unresolved_graph = true;
             auto graphData = UapmdProjectPluginGraphData::create();
             graphData->graphType(sequencerTrack->unresolvedGraphType());
             projectTrack.graph(std::move(graphData));
@@ -1205,16 +1427,14 @@ namespace uapmd::timeline_detail {
             [this](int32_t instanceId) {
                 return engine_.getPluginInstance(instanceId);
             },
-            [&operation, &scopeLabel](int32_t instanceId, size_t pluginOrder, AudioPluginInstanceAPI* instance,
-                                      const std::function<void(const std::string& relativePath)>& setStateFile) {
+            [&operation](int32_t instanceId, size_t, AudioPluginInstanceAPI* instance,
+                         const std::function<void(const std::string& relativePath)>& setStateFile) {
                 if (setStateFile)
                     setStateFile({});
                 operation.pending_states.push_back(PendingProjectPluginState{
                     .instance_id = instanceId,
-                    .plugin_order = pluginOrder,
                     .instance = instance,
-                    .set_state_file = setStateFile,
-                    .scope_label = scopeLabel
+                    .set_state_file = setStateFile
                 });
             });
         if (!graphData)
@@ -12,6 +12,8 @@
 
 #include <filesystem>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -24,6 +26,7 @@ namespace uapmd::timeline_detail {
     // State shared by the phases of one project load, defined in the
     // implementation file because nothing outside it needs the details.
     struct ProjectLoadRun;
+    struct LoadedClipRef;
     struct ProjectSaveBuild;
 
     // Reports one save's outcome exactly once, from whichever asynchronous
@@ -77,6 +80,16 @@ namespace uapmd::timeline_detail {
             std::vector<AudioWarpPoint> audioWarps) = 0;
     };
 
+    // Where a plug-in's saved state lives: its own file, or a chunk of the
+    // project's chunk container. It is read only once the plug-in exists.
+    struct SavedPluginStateSource {
+        std::filesystem::path file;
+        std::shared_ptr<const ProjectChunkContainer> container;
+        std::optional<ProjectChunkId> chunk;
+        // What the manifest said, for diagnostics. Empty means no state.
+        std::string label;
+    };
+
     class TimelineProjectSerializer {
         SequencerEngine& engine_;
         TimelineFacade& facade_;
@@ -144,6 +157,7 @@ namespace uapmd::timeline_detail {
             ProjectSaveBuild& build,
             std::string& error);
         void applySerializedClipAnchors(ProjectSaveBuild& build);
+        void applySerializedClipLinks(ProjectSaveBuild& build);
         void runPendingPluginStateCaptures(
             std::shared_ptr<PendingProjectSaveContext> operation,
             ProjectSaveCompletion complete);
@@ -167,8 +181,9 @@ namespace uapmd::timeline_detail {
         void restoreLoadedPluginState(
             int32_t instanceId,
             const std::string& instantiationError,
-            const std::filesystem::path& stateFile,
+            const SavedPluginStateSource& state,
             int32_t groupIndex,
+            std::optional<bool> sleepsWhenSilent,
             const std::string& pluginLabel,
             const std::string& pluginId,
             const std::string& format);
@@ -177,6 +192,13 @@ namespace uapmd::timeline_detail {
             ProjectLoadRun& run,
             UapmdProjectClipData& clip,
             int32_t trackIndex);
+        bool restoreLinkedMidiClip(
+            ProjectLoadRun& run,
+            UapmdProjectClipData& clip,
+            int32_t trackIndex,
+            const LoadedClipRef& linkedClip,
+            const TimelinePosition& position,
+            const std::string& clipName);
         void restoreMasterTrackClips(ProjectLoadRun& run);
         void applyLoadedClipAnchors(ProjectLoadRun& run);
         void installLoadCompletion(ProjectLoadRun& run);
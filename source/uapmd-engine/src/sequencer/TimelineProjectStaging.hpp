@@ -10,6 +10,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include <uapmd-data/uapmd-data.hpp>
@@ -22,10 +23,8 @@ namespace uapmd::timeline_detail {
 
     struct PendingProjectPluginState {
         int32_t instance_id{-1};
-        size_t plugin_order{0};
         AudioPluginInstanceAPI* instance{};
         std::function<void(const std::string& relativePath)> set_state_file{};
-        std::string scope_label;
     };
 
     struct PendingProjectGraphSave {
@@ -40,8 +39,16 @@ namespace uapmd::timeline_detail {
         std::filesystem::path plugin_state_dir;
         std::filesystem::path graph_dir;
         std::unique_ptr<UapmdProjectData> project;
+        // Set when the save targets a chunk container; see ProjectSaveOptions.
+        std::unique_ptr<ProjectChunkContainerWriter> chunk_writer;
         std::vector<PendingProjectPluginState> pending_states;
         std::vector<PendingProjectGraphSave> pending_graphs;
+        // The state files this save refers to, by file name. The others in
+        // plugin_state_dir, which only this project file writes to, are
+        // deleted once the manifest is written, unless a graph carried through
+        // unresolved may refer to them or the states went to a chunk container.
+        std::unordered_set<std::string> written_state_files;
+        bool carries_unresolved_graph{false};
         size_t next_pending_state{0};
         uint64_t history_state_id{0};
         bool emit_document_event{true};
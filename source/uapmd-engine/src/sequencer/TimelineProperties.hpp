@@ -568,6 +568,26 @@ namespace uapmd::timeline_detail {
         }
     };
 
+    struct ClipRegionProperty : ClipPropertyDescriptor<ClipRegionProperty, ClipRegion> {
+        static constexpr std::string_view commandId{"clip.setRegion"};
+        static constexpr std::string_view changeType{"clip-region-changed"};
+
+        static std::string describe(const ClipRegion& value) {
+            return value.loops() ? "Loop clip" : "Change clip region";
+        }
+
+        static ClipRegion read(PropertyCommandTarget&, const ClipSubject& subject) {
+            return subject.clip->region;
+        }
+
+        static bool write(
+            PropertyCommandTarget&,
+            const ClipSubject& subject,
+            const ClipRegion& value) {
+            return subject.track->clipManager().setClipRegion(subject.clipId, value);
+        }
+    };
+
     struct TrackGainProperty : TrackPropertyDescriptor<TrackGainProperty, double> {
         static constexpr std::string_view commandId{"track.setGain"};
         static constexpr std::string_view changeType{"track-gain-changed"};
@@ -678,6 +698,24 @@ namespace uapmd::timeline_detail {
         }
     };
 
+    struct PluginSleepsWhenSilentProperty : PluginPropertyDescriptor<PluginSleepsWhenSilentProperty, bool> {
+        static constexpr std::string_view commandId{"plugin.setSleepsWhenSilent"};
+        static constexpr std::string_view changeType{"plugin-sleep-changed"};
+
+        static std::string describe(bool value) {
+            return value ? "Let plug-in sleep when silent" : "Keep plug-in awake";
+        }
+
+        static bool read(PropertyCommandTarget&, const PluginSubject& subject) {
+            return subject.instance->sleepsWhenSilent();
+        }
+
+        static bool write(PropertyCommandTarget&, const PluginSubject& subject, bool value) {
+            subject.instance->sleepsWhenSilent(value);
+            return true;
+        }
+    };
+
     struct PluginGroupProperty : PluginPropertyDescriptor<PluginGroupProperty, uint8_t> {
         static constexpr std::string_view commandId{"plugin.setGroup"};
         static constexpr std::string_view changeType{"plugin-group-changed"};
@@ -1086,15 +1124,16 @@ namespace uapmd::timeline_detail {
         }
     };
 
-    // Writes one opaque state blob into the addressed plug-in.
+    // Writes one opaque state blob into the addressed plug-in. The blob is
+    // interned, so history entries that hold the same state share it.
     class PluginStateCommand final : public PluginCommandBase {
-        std::vector<uint8_t> state_;
+        PluginStateRef state_;
 
     public:
         PluginStateCommand(
             PropertyCommandTarget& target,
             PluginAddress address,
-            std::vector<uint8_t> state,
+            PluginStateRef state,
             std::string label)
             : PluginCommandBase(target, std::move(address), std::move(label))
             , state_(std::move(state)) {
@@ -1108,14 +1147,19 @@ namespace uapmd::timeline_detail {
             return sizeof(*this)
                 + address_.trackReferenceId.capacity()
                 + address_.nodeId.capacity()
-                + label_.capacity()
-                + state_.capacity();
+                + label_.capacity();
+        }
+
+        void collectSharedPayloads(std::vector<ProjectHistorySharedPayload>& payloads) const override {
+            if (state_)
+                payloads.push_back({state_, state_->retainedSizeInBytes()});
         }
 
         void execute(
             ProjectCommandContext&,
             ProjectCommandCompletion completion) override {
-            target_.writePluginState(address_, state_, std::move(completion));
+            target_.writePluginState(
+                address_, state_ ? state_->bytes() : std::vector<uint8_t>{}, std::move(completion));
         }
     };
 
@@ -1185,6 +1229,11 @@ namespace uapmd::timeline_detail {
                 + (snapshot_ ? retainedValueSize(*snapshot_) : 0);
         }
 
+        void collectSharedPayloads(std::vector<ProjectHistorySharedPayload>& payloads) const override {
+            if (snapshot_ && snapshot_->state)
+                payloads.push_back({snapshot_->state, snapshot_->state->retainedSizeInBytes()});
+        }
+
         void execute(
             ProjectCommandContext&,
             ProjectCommandCompletion completion) override {
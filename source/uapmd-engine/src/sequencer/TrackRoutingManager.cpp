@@ -1,6 +1,7 @@
 #include "TrackRoutingManager.hpp"
 
 #include <algorithm>
+#include <choc/text/choc_JSON.h>
 #include <vector>
 
 #include "LatencyCompensationManagerImpl.hpp"
@@ -11,6 +12,8 @@ using namespace uapmd_graph;
 namespace uapmd {
 
     namespace {
+        constexpr std::string_view kProjectSettingsKey{"aux_sends"};
+
         void applyTrackBusesLayout(SequencerTrack* track, const AudioGraphBusesLayout& layout) {
             if (!track)
                 return;
@@ -31,7 +34,8 @@ namespace uapmd {
         std::unique_ptr<AudioProcessContext>& mixBusContext,
         SequenceProcessContext& sequence,
         TimelineFacade* timeline,
-        LatencyCompensationManager& latencyCompensationManager)
+        LatencyCompensationManager& latencyCompensationManager,
+        std::function<void(const std::function<void()>&)> runRoutingChange)
         : audio_buffer_size_in_frames_(audioBufferSizeInFrames)
         , sample_rate_(sampleRate)
         , default_output_channels_(defaultOutputChannels)
@@ -41,7 +45,8 @@ namespace uapmd {
         , mix_bus_context_(mixBusContext)
         , sequence_(sequence)
         , timeline_(timeline)
-        , latency_compensation_manager_(latencyCompensationManager) {
+        , latency_compensation_manager_(latencyCompensationManager)
+        , run_routing_change_(std::move(runRoutingChange)) {
         rebuildRoutingCaches();
     }
 
@@ -50,7 +55,9 @@ namespace uapmd {
         max_track_render_lead_in_samples_ = 0;
         max_monitored_live_input_render_lead_in_samples_ = 0;
         max_output_alignment_holdback_in_samples_ = 0;
+        max_send_holdback_in_samples_ = 0;
         output_alignment_active_ = false;
+        syncAuxRoutingSlots();
 
         for (size_t trackIndex = 0; trackIndex < tracks_.size(); ++trackIndex) {
             auto* track = tracks_[trackIndex].get();
@@ -85,6 +92,39 @@ namespace uapmd {
                 cache.audible_render_lead_in_samples);
         }
 
+        // A return hears its sends as it hears its own timeline, so a send
+        // path runs through the whole render lead of its return. Returns never
+        // send, so their leads are final at this point.
+        for (size_t trackIndex = 0; trackIndex < tracks_.size(); ++trackIndex) {
+            auto* track = tracks_[trackIndex].get();
+            auto& cache = track_routing_caches_[trackIndex];
+            if (!track || track_is_return_[trackIndex] || track->graph().outputBusCount() == 0)
+                continue;
+            for (const auto& send : track_sends_[trackIndex]) {
+                const auto returnIndex = send.returnTrackIndex;
+                if (!trackIsReturn(returnIndex) || !tracks_[static_cast<size_t>(returnIndex)])
+                    continue;
+                const uint32_t pathLatency =
+                    track->graph().outputLatencyInSamples(0) +
+                    track_routing_caches_[static_cast<size_t>(returnIndex)].audible_render_lead_in_samples;
+                cache.send_routes.push_back(TrackSendRoute{
+                    returnIndex,
+                    static_cast<float>(send.gain),
+                    send.preFader,
+                    0,
+                });
+                cache.send_path_latencies_in_samples.push_back(pathLatency);
+                cache.audible_render_lead_in_samples = std::max(
+                    cache.audible_render_lead_in_samples,
+                    pathLatency);
+                if (send.preFader && !cache.deferred_fader)
+                    cache.deferred_fader = track->trackGainNode();
+            }
+            max_track_render_lead_in_samples_ = std::max(
+                max_track_render_lead_in_samples_,
+                cache.audible_render_lead_in_samples);
+        }
+
         if (timeline_)
             for (size_t trackIndex = 0; trackIndex < tracks_.size(); ++trackIndex)
                 if (trackUsesLowLatencyMonitoring(static_cast<int32_t>(trackIndex)))
@@ -123,6 +163,208 @@ namespace uapmd {
                     holdback);
                 output_alignment_active_ = output_alignment_active_ || holdback > 0;
             }
+
+            // The return applies its own live-input holdback to what it
+            // receives, so a send only makes up the lead it does not use.
+            for (size_t sendIndex = 0; sendIndex < cache.send_routes.size(); ++sendIndex) {
+                const uint32_t pathLatency = cache.send_path_latencies_in_samples[sendIndex];
+                const uint32_t holdback =
+                    cache.audible_render_lead_in_samples > pathLatency
+                    ? cache.audible_render_lead_in_samples - pathLatency
+                    : 0;
+                cache.send_routes[sendIndex].holdback_in_samples = holdback;
+                max_send_holdback_in_samples_ = std::max(max_send_holdback_in_samples_, holdback);
+                output_alignment_active_ = output_alignment_active_ || holdback > 0;
+            }
+        }
+    }
+
+    void TrackRoutingManager::syncAuxRoutingSlots() {
+        track_is_return_.resize(tracks_.size(), 0);
+        track_sends_.resize(tracks_.size());
+    }
+
+    bool TrackRoutingManager::trackIsReturn(uapmd_track_index_t trackIndex) const {
+        return trackIndex >= 0 &&
+            static_cast<size_t>(trackIndex) < track_is_return_.size() &&
+            track_is_return_[static_cast<size_t>(trackIndex)] != 0;
+    }
+
+    bool TrackRoutingManager::setTrackIsReturn(uapmd_track_index_t trackIndex, bool isReturn) {
+        syncAuxRoutingSlots();
+        if (trackIndex < 0 || static_cast<size_t>(trackIndex) >= tracks_.size())
+            return false;
+        const auto index = static_cast<size_t>(trackIndex);
+        if (isReturn && !track_sends_[index].empty())
+            return false;
+        track_is_return_[index] = isReturn ? 1 : 0;
+        if (!isReturn)
+            for (auto& sends : track_sends_)
+                std::erase_if(sends, [trackIndex](const TrackSend& send) {
+                    return send.returnTrackIndex == trackIndex;
+                });
+        return true;
+    }
+
+    std::vector<TrackSend> TrackRoutingManager::trackSends(uapmd_track_index_t trackIndex) const {
+        if (trackIndex < 0 || static_cast<size_t>(trackIndex) >= track_sends_.size())
+            return {};
+        return track_sends_[static_cast<size_t>(trackIndex)];
+    }
+
+    bool TrackRoutingManager::validTrackSends(
+        uapmd_track_index_t trackIndex,
+        const std::vector<TrackSend>& sends) const {
+        if (trackIndex < 0 || static_cast<size_t>(trackIndex) >= tracks_.size())
+            return false;
+        if (sends.empty())
+            return true;
+        if (trackIsReturn(trackIndex))
+            return false;
+        return std::ranges::all_of(sends, [&](const TrackSend& send) {
+            return send.returnTrackIndex != trackIndex && trackIsReturn(send.returnTrackIndex);
+        });
+    }
+
+    bool TrackRoutingManager::setTrackSends(uapmd_track_index_t trackIndex, std::vector<TrackSend> sends) {
+        syncAuxRoutingSlots();
+        if (!validTrackSends(trackIndex, sends))
+            return false;
+        for (auto& send : sends)
+            send.gain = std::clamp(send.gain, 0.0, 8.0);
+        track_sends_[static_cast<size_t>(trackIndex)] = std::move(sends);
+        return true;
+    }
+
+    const std::vector<TrackRoutingManager::TrackSendRoute>* TrackRoutingManager::trackSendRoutes(
+        uapmd_track_index_t trackIndex) const {
+        if (trackIndex < 0 || static_cast<size_t>(trackIndex) >= track_routing_caches_.size())
+            return nullptr;
+        return &track_routing_caches_[static_cast<size_t>(trackIndex)].send_routes;
+    }
+
+    webaudio_compat::GainNode* TrackRoutingManager::trackDeferredFader(uapmd_track_index_t trackIndex) const {
+        if (trackIndex < 0 || static_cast<size_t>(trackIndex) >= track_routing_caches_.size())
+            return nullptr;
+        return track_routing_caches_[static_cast<size_t>(trackIndex)].deferred_fader;
+    }
+
+    uint32_t TrackRoutingManager::maxSendHoldbackInSamples() const {
+        return max_send_holdback_in_samples_;
+    }
+
+    bool TrackRoutingManager::saveProjectData(UapmdProjectData& project, std::string&) {
+        auto returns = choc::value::createEmptyArray();
+        auto sends = choc::value::createEmptyArray();
+        for (size_t trackIndex = 0; trackIndex < track_is_return_.size(); ++trackIndex)
+            if (track_is_return_[trackIndex])
+                returns.addArrayElement(static_cast<int32_t>(trackIndex));
+        for (size_t trackIndex = 0; trackIndex < track_sends_.size(); ++trackIndex)
+            for (const auto& send : track_sends_[trackIndex]) {
+                auto entry = choc::value::createObject("TrackSend");
+                entry.addMember("track", static_cast<int32_t>(trackIndex));
+                entry.addMember("return", send.returnTrackIndex);
+                entry.addMember("gain", send.gain);
+                entry.addMember("pre_fader", send.preFader);
+                sends.addArrayElement(entry);
+            }
+        if (returns.size() == 0 && sends.size() == 0) {
+            project.settings().erase(std::string(kProjectSettingsKey));
+            return true;
+        }
+        auto value = choc::value::createObject("AuxSends");
+        value.addMember("returns", returns);
+        value.addMember("sends", sends);
+        project.settings()[std::string(kProjectSettingsKey)] =
+            choc::json::toString(value, false);
+        return true;
+    }
+
+    bool TrackRoutingManager::loadProjectData(UapmdProjectData& project, std::string& error) {
+        std::vector<uapmd_track_index_t> returns;
+        std::vector<std::pair<uapmd_track_index_t, TrackSend>> sends;
+        const auto it = project.settings().find(std::string(kProjectSettingsKey));
+        if (it != project.settings().end()) {
+            try {
+                const auto value = choc::json::parse(it->second);
+                if (!value.isObject()) {
+                    error = "Aux send settings must be an object.";
+                    return false;
+                }
+                if (value.hasObjectMember("returns") && value["returns"].isArray())
+                    for (const auto& index : value["returns"])
+                        if (const auto parsed = index.getWithDefault<int32_t>(-1); parsed >= 0)
+                            returns.push_back(parsed);
+                if (value.hasObjectMember("sends") && value["sends"].isArray())
+                    for (const auto& entry : value["sends"]) {
+                        if (!entry.isObject())
+                            continue;
+                        TrackSend send;
+                        send.returnTrackIndex = entry["return"].getWithDefault<int32_t>(-1);
+                        send.gain = entry["gain"].getWithDefault<double>(1.0);
+                        send.preFader = entry["pre_fader"].getWithDefault<bool>(false);
+                        sends.emplace_back(entry["track"].getWithDefault<int32_t>(-1), send);
+                    }
+            } catch (const std::exception& exception) {
+                error = exception.what();
+                return false;
+            }
+        }
+
+        // Entries that no longer fit the loaded tracks are dropped one by one
+        // rather than failing the whole project.
+        auto apply = [&]() {
+            syncAuxRoutingSlots();
+            std::ranges::fill(track_is_return_, 0);
+            for (auto& trackSends : track_sends_)
+                trackSends.clear();
+            for (const auto index : returns)
+                if (static_cast<size_t>(index) < track_is_return_.size())
+                    track_is_return_[static_cast<size_t>(index)] = 1;
+            for (const auto& [trackIndex, send] : sends) {
+                if (!validTrackSends(trackIndex, {send}))
+                    continue;
+                auto& trackSends = track_sends_[static_cast<size_t>(trackIndex)];
+                trackSends.push_back(send);
+                trackSends.back().gain = std::clamp(send.gain, 0.0, 8.0);
+            }
+        };
+        if (run_routing_change_)
+            run_routing_change_(apply);
+        else
+            apply();
+        return true;
+    }
+
+    void TrackRoutingManager::trackAdded(uapmd_track_index_t trackIndex) {
+        if (track_is_return_.size() + 1 != tracks_.size() ||
+            trackIndex < 0 || static_cast<size_t>(trackIndex) > track_is_return_.size()) {
+            syncAuxRoutingSlots();
+            return;
+        }
+        track_is_return_.insert(track_is_return_.begin() + trackIndex, 0);
+        track_sends_.insert(track_sends_.begin() + trackIndex, std::vector<TrackSend>{});
+        for (auto& trackSends : track_sends_)
+            for (auto& send : trackSends)
+                if (send.returnTrackIndex >= trackIndex)
+                    ++send.returnTrackIndex;
+    }
+
+    void TrackRoutingManager::trackRemoved(uapmd_track_index_t trackIndex) {
+        if (trackIndex < 0 || static_cast<size_t>(trackIndex) >= track_is_return_.size()) {
+            syncAuxRoutingSlots();
+            return;
+        }
+        track_is_return_.erase(track_is_return_.begin() + trackIndex);
+        if (static_cast<size_t>(trackIndex) < track_sends_.size())
+            track_sends_.erase(track_sends_.begin() + trackIndex);
+        for (auto& trackSends : track_sends_) {
+            std::erase_if(trackSends, [trackIndex](const TrackSend& send) {
+                return send.returnTrackIndex == trackIndex;
+            });
+            for (auto& send : trackSends)
+                if (send.returnTrackIndex > trackIndex)
+                    --send.returnTrackIndex;
         }
     }
 
@@ -374,6 +616,24 @@ namespace uapmd {
                     track->tailLengthInSeconds() + downstreamTailLengthInSecondsForTarget(target),
                 });
             }
+
+            if (trackIndex >= track_routing_caches_.size())
+                continue;
+            const auto& cache = track_routing_caches_[trackIndex];
+            for (size_t sendIndex = 0; sendIndex < cache.send_routes.size(); ++sendIndex) {
+                const auto returnIndex = cache.send_routes[sendIndex].return_track_index;
+                if (static_cast<size_t>(returnIndex) >= tracks_.size())
+                    continue;
+                auto* returnTrack = tracks_[static_cast<size_t>(returnIndex)].get();
+                if (!returnTrack)
+                    continue;
+                paths.push_back(StopDrainPathInfo{
+                    cache.send_path_latencies_in_samples[sendIndex],
+                    track->tailLengthInSeconds() + returnTrack->tailLengthInSeconds() +
+                        downstreamTailLengthInSecondsForTarget(
+                            effectiveTrackOutputBusRoutingTarget(returnIndex, 0)),
+                });
+            }
         }
 
         return computeStopDrainFrames(
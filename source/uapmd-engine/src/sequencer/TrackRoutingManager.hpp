@@ -1,7 +1,9 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "uapmd-engine/uapmd-engine.hpp"
@@ -9,12 +11,29 @@
 namespace uapmd {
     class LatencyCompensationManager;
 
-    class TrackRoutingManager {
+    class TrackRoutingManager final
+        : public ProjectSerializationExtension
+        , public SequencerProcessingLifecycleListener {
+    public:
+        // A send as the audio thread runs it: the main output bus delayed by
+        // `holdback_in_samples`, scaled and added to the return's input.
+        struct TrackSendRoute {
+            uapmd_track_index_t return_track_index{-1};
+            float gain{1.0f};
+            bool pre_fader{false};
+            uint32_t holdback_in_samples{0};
+        };
+
+    private:
         struct TrackRoutingCache {
             std::vector<uapmd_graph::TrackOutputRoutingTarget> effective_targets{};
             std::vector<uint32_t> path_latencies_in_samples{};
             std::vector<uint32_t> output_alignment_holdbacks_in_samples{};
             uint32_t audible_render_lead_in_samples{0};
+            std::vector<TrackSendRoute> send_routes{};
+            std::vector<uint32_t> send_path_latencies_in_samples{};
+            // Set when a send taps the track before its fader.
+            uapmd_graph::webaudio_compat::GainNode* deferred_fader{};
         };
 
         size_t& audio_buffer_size_in_frames_;
@@ -32,6 +51,14 @@ namespace uapmd {
         uint32_t max_monitored_live_input_render_lead_in_samples_{0};
         uint32_t max_output_alignment_holdback_in_samples_{0};
         bool output_alignment_active_{false};
+        uint32_t max_send_holdback_in_samples_{0};
+        // Authored aux routing, kept index-aligned with tracks_.
+        std::vector<uint8_t> track_is_return_{};
+        std::vector<std::vector<TrackSend>> track_sends_{};
+        std::function<void(const std::function<void()>&)> run_routing_change_{};
+
+        void syncAuxRoutingSlots();
+        bool validTrackSends(uapmd_track_index_t trackIndex, const std::vector<TrackSend>& sends) const;
 
         uapmd_graph::TrackOutputRoutingTarget authoredTrackOutputBusRoutingTarget(
             uapmd_track_index_t trackIndex,
@@ -68,7 +95,8 @@ namespace uapmd {
             std::unique_ptr<AudioProcessContext>& mixBusContext,
             SequenceProcessContext& sequence,
             TimelineFacade* timeline,
-            LatencyCompensationManager& latencyCompensationManager);
+            LatencyCompensationManager& latencyCompensationManager,
+            std::function<void(const std::function<void()>&)> runRoutingChange);
 
         void rebuildRoutingCaches();
 
@@ -90,6 +118,25 @@ namespace uapmd {
             uapmd_track_index_t trackIndex,
             uint32_t outputBusIndex) const;
         bool isOutputAlignmentActive() const;
+
+        // Callers hold the structure mutation guard around the setters and
+        // reconfigure afterwards, as for the output routing rules.
+        bool trackIsReturn(uapmd_track_index_t trackIndex) const;
+        bool setTrackIsReturn(uapmd_track_index_t trackIndex, bool isReturn);
+        std::vector<TrackSend> trackSends(uapmd_track_index_t trackIndex) const;
+        bool setTrackSends(uapmd_track_index_t trackIndex, std::vector<TrackSend> sends);
+        // Audio-thread views of the routing cache.
+        const std::vector<TrackSendRoute>* trackSendRoutes(uapmd_track_index_t trackIndex) const;
+        uapmd_graph::webaudio_compat::GainNode* trackDeferredFader(uapmd_track_index_t trackIndex) const;
+        uint32_t maxSendHoldbackInSamples() const;
+
+        std::string_view extensionId() const override {
+            return "org.uapmd.engine.aux-sends";
+        }
+        bool saveProjectData(UapmdProjectData& project, std::string& error) override;
+        bool loadProjectData(UapmdProjectData& project, std::string& error) override;
+        void trackAdded(uapmd_track_index_t trackIndex) override;
+        void trackRemoved(uapmd_track_index_t trackIndex) override;
         int64_t maxStopDrainInSamples() const;
         void reconfigureMasterTrackInputBuses();
         void reconfigureMixBusContext();
@@ -16,6 +16,12 @@ namespace uapmd_graph::webaudio_compat {
         // Apply the gain ramp to the existing output buffers of `process` without
         // touching the input buffers.  Used when the GainNode lives outside a graph.
         virtual void applyToOutputs(uapmd::AudioProcessContext& process) = 0;
+
+        // While deferred, processAudio() passes audio through unchanged and the
+        // owner applies the gain with applyToOutputs() once it has read the
+        // ungained signal (e.g. for a pre-fader send). Not persisted.
+        virtual bool deferred() const = 0;
+        virtual void deferred(bool value) = 0;
     };
 
     std::unique_ptr<AudioGraphBuiltInNodeFactory> createGainNodeFactory();
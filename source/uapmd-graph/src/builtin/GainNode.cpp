@@ -35,6 +35,7 @@ namespace uapmd_graph::webaudio_compat {
             std::string node_id_;
             std::string display_name_;
             std::atomic<bool> bypassed_{false};
+            std::atomic<bool> deferred_{false};
             std::atomic<double> target_gain_{1.0};
             double current_gain_{1.0};
             ParameterUpdateEvent parameter_update_event_{};
@@ -105,10 +106,19 @@ namespace uapmd_graph::webaudio_compat {
             int32_t processAudio(AudioProcessContext& process) override {
                 process.copyInputsToOutputs();
                 copyEvents(process.eventOut(), process.eventIn());
-                applyToOutputs(process);
+                if (!deferred())
+                    applyToOutputs(process);
                 return 0;
             }
 
+            bool deferred() const override {
+                return deferred_.load(std::memory_order_acquire);
+            }
+
+            void deferred(bool value) override {
+                deferred_.store(value, std::memory_order_release);
+            }
+
             void applyToOutputs(AudioProcessContext& process) override {
                 if (bypassed())
                     return;
@@ -38,8 +38,8 @@ namespace uapmd_midi_service {
         uint8_t group() const { return ump_group; }
         void group(uint8_t groupId) { ump_group = groupId; }
 
-        // Detach the UMP output mapper (unregisters parameter listeners from the plugin)
-        // while the plugin instance is still alive. Must be called before the plugin is
+        // Detach the UMP output mapper and the MIDI-CI session (unregisters parameter listeners
+        // from the plugin and cancels their pending work) while the plugin instance is still alive. Must be called before the plugin is
         // freed, because DeviceState::device shared_ptrs may outlive the engine tracks.
         void detachOutputMapper();
 
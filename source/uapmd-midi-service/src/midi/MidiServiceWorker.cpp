@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <iterator>
+#include "MidiServiceWorker.hpp"
+
+namespace uapmd_midi_service {
+
+    MidiServiceWorker::MidiServiceWorker() {
+        thread_ = std::thread([this] { run(); });
+    }
+
+    MidiServiceWorker::~MidiServiceWorker() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+            tasks_.clear();
+        }
+        wake_.notify_one();
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+    MidiServiceWorker& MidiServiceWorker::instance() {
+        static MidiServiceWorker worker;
+        return worker;
+    }
+
+    void MidiServiceWorker::run() {
+        std::unique_lock lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (stopping_)
+                return;
+            auto task = std::move(tasks_.front());
+            tasks_.pop_front();
+            runTask(lock, std::move(task));
+        }
+    }
+
+    void MidiServiceWorker::runTask(std::unique_lock<std::mutex>& lock, Task task) {
+        running_owners_.push_back(task.owner);
+        lock.unlock();
+
+        task.run();
+        // Captures are released before cancel() of the owner returns.
+        task.run = nullptr;
+
+        lock.lock();
+        running_owners_.pop_back();
+        task_done_.notify_all();
+    }
+
+    bool MidiServiceWorker::waitFor(const void* owner, const std::function<bool()>& ready, std::chrono::milliseconds timeout) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::unique_lock lock(mutex_);
+        while (true) {
+            lock.unlock();
+            if (ready())
+                return true;
+            lock.lock();
+            if (stopping_ || std::chrono::steady_clock::now() >= deadline)
+                break;
+            // A waiting owner's queued tasks would overtake its running one.
+            const auto next = std::ranges::find_if(tasks_, [this, owner](const Task& t) {
+                return t.owner != owner && std::ranges::find(running_owners_, t.owner) == running_owners_.end();
+            });
+            if (next == tasks_.end()) {
+                // The plugin's reply does not signal us; poll for it.
+                wake_.wait_for(lock, std::chrono::milliseconds(10));
+                continue;
+            }
+            auto task = std::move(*next);
+            tasks_.erase(next);
+            runTask(lock, std::move(task));
+        }
+        lock.unlock();
+        return ready();
+    }
+
+    void MidiServiceWorker::post(const void* owner, std::function<void()>&& task) {
+        {
+            std::lock_guard lock(mutex_);
+            if (stopping_)
+                return;
+            tasks_.push_back({owner, std::move(task)});
+        }
+        wake_.notify_one();
+    }
+
+    void MidiServiceWorker::cancel(const void* owner) {
+        std::deque<Task> dropped{};
+        std::unique_lock lock(mutex_);
+        const auto first = std::stable_partition(tasks_.begin(), tasks_.end(),
+                                                 [owner](const Task& t) { return t.owner != owner; });
+        std::move(first, tasks_.end(), std::back_inserter(dropped));
+        tasks_.erase(first, tasks_.end());
+        if (!isWorkerThread())
+            task_done_.wait(lock, [this, owner] { return std::ranges::find(running_owners_, owner) == running_owners_.end(); });
+        lock.unlock();
+        // `dropped` goes out of scope here, outside the lock, as its captures may take locks of their own.
+    }
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace uapmd_midi_service {
+
+    // The one thread that all function blocks run their MIDI-CI and controller notification work on,
+    // so that neither the MIDI input path nor the plugin's parameter callbacks wait for it.
+    //
+    // Tasks run one at a time, in the order they were posted. A task that waits for a plugin (such as a
+    // State reply) does so through waitFor(), which keeps the other owners' tasks running meanwhile.
+    class MidiServiceWorker {
+        struct Task {
+            const void* owner{};
+            std::function<void()> run{};
+        };
+
+        std::mutex mutex_{};
+        std::condition_variable wake_{};
+        std::condition_variable task_done_{};
+        std::deque<Task> tasks_{};
+        // Owners whose task is running, outermost first; more than one while tasks run inside waitFor().
+        std::vector<const void*> running_owners_{};
+        bool stopping_{false};
+        std::thread thread_{};
+
+        void run();
+        void runTask(std::unique_lock<std::mutex>& lock, Task task);
+
+    public:
+        MidiServiceWorker();
+        ~MidiServiceWorker();
+
+        static MidiServiceWorker& instance();
+
+        void post(const void* owner, std::function<void()>&& task);
+
+        // From a task of `owner`: runs the tasks of other owners that are not themselves waiting, until
+        // `ready()` holds, `timeout` passes or the worker stops. The owner's later tasks stay queued, so
+        // they still run in order. Returns `ready()`.
+        bool waitFor(const void* owner, const std::function<bool()>& ready, std::chrono::milliseconds timeout);
+
+        // Drops the queued tasks of `owner` and waits for its running one to return, after which none of
+        // its tasks run anymore. From a task, only the queued ones are dropped.
+        void cancel(const void* owner);
+
+        bool isWorkerThread() const { return std::this_thread::get_id() == thread_.get_id(); }
+    };
+
+}
@@ -82,6 +82,8 @@ namespace uapmd_midi_service {
         if (ump_output_mapper_)
             ump_output_mapper_->detach();
         ump_output_mapper_.reset();
+        if (uapmd_sessions)
+            uapmd_sessions->detach();
     }
 
     void UapmdFunctionBlock::initialize() {
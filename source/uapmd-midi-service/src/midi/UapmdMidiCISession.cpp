@@ -1,4 +1,6 @@
 
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <future>
 #include <iostream>
@@ -9,6 +11,7 @@
 #include <utility>
 #include "uapmd-midi-service/uapmd-midi-service.hpp"
 #include "uapmd-plugin-hosting/uapmd-plugin-hosting.hpp"
+#include "MidiServiceWorker.hpp"
 #include "UapmdMidiCISession.hpp"
 
 using namespace uapmd_plugin_hosting;
@@ -29,6 +32,26 @@ namespace uapmd_midi_service {
 
             std::function<void()> on_process_midi_message_report{};
 
+            // MIDI-CI runs on the MidiServiceWorker. The MIDI input path only
+            // posts SysEx7 packets, so property exchange replies, which may wait
+            // for the plugin to produce its state, never hold up incoming notes.
+            // Cleared on detach; replies waiting for the plugin give up then.
+            std::atomic<bool> running{false};
+            // Set by parameter metadata changes until the worker picks up the
+            // rebuild, so that a burst of changes costs one rebuild.
+            std::atomic<bool> control_lists_dirty{false};
+
+            remidy::PluginParameterSupport* parameter_support{};
+            remidy::EventListenerId metadata_listener_id{0};
+            // Worker thread only, once running.
+            std::vector<ParameterMetadata> parameter_list{};
+
+            void publishControlLists(MidiCIDevice& ciDevice);
+            // Waits on the worker for the plugin's reply, while the worker serves other function blocks.
+            // Gives up when the session detaches, or after kPluginReplyTimeout.
+            template <typename T>
+            bool waitForPlugin(std::future<T>& reply);
+
         public:
             UapmdMidiCISessionImpl(
                 UapmdFunctionBlock* device,
@@ -43,17 +66,32 @@ namespace uapmd_midi_service {
                 version(std::move(versionString)) {
             }
 
+            ~UapmdMidiCISessionImpl() override {
+                detach();
+            }
+
             void setupMidiCISession() override;
             void interceptUmpInput(uapmd_ump_t* ump, size_t sizeInBytes, uapmd_timestamp_t timestamp) override;
+            void detach() override;
             void setMidiMessageReportHandler(std::function<void()>&& onProcessMidiMessageReport) override {
                 on_process_midi_message_report = std::move(onProcessMidiMessageReport);
             }
         };
     }
 
+    // A plugin that takes longer than this to save or load its State gets a failed reply.
+    constexpr std::chrono::milliseconds kPluginReplyTimeout{10000};
+
+    template <typename T>
+    bool UapmdMidiCISessionImpl::waitForPlugin(std::future<T>& reply) {
+        const auto replied = [&reply] { return reply.wait_for(std::chrono::seconds(0)) == std::future_status::ready; };
+        MidiServiceWorker::instance().waitFor(this, [this, &replied] { return !running || replied(); }, kPluginReplyTimeout);
+        return running && replied();
+    }
+
     void UapmdMidiCISessionImpl::interceptUmpInput(uapmd_ump_t* ump, size_t sizeInBytes, uapmd_timestamp_t timestamp) {
 
-        if (ci_input_forwarders.empty() || !ump || sizeInBytes == 0)
+        if (!running || ci_input_forwarders.empty() || !ump || sizeInBytes == 0)
             return;
 
         if (sizeInBytes % sizeof(uapmd_ump_t) != 0)
@@ -63,13 +101,35 @@ namespace uapmd_midi_service {
         if (word_count == 0)
             return;
 
+        // MIDI-CI only travels in SysEx7 packets; everything else stays on
+        // the input path without touching the worker.
         auto* words = reinterpret_cast<const uint32_t*>(ump);
-        umppi::UmpWordSpan word_span{words, word_count};
-        const auto timestamp_ns = static_cast<uint64_t>(timestamp);
+        std::vector<uint32_t> sysex{};
+        for (size_t i = 0; i < word_count;) {
+            const auto size = std::max<size_t>(1, umppi::Ump(words[i]).getSizeInBytes() / sizeof(uint32_t));
+            if (words[i] >> 28 == 3 && i + size <= word_count)
+                sysex.insert(sysex.end(), words + i, words + i + size);
+            i += size;
+        }
+        if (sysex.empty())
+            return;
 
-        for (auto& forwarder : ci_input_forwarders)
-            forwarder(word_span, timestamp_ns);
+        MidiServiceWorker::instance().post(this, [this, sysex = std::move(sysex), timestamp_ns = static_cast<uint64_t>(timestamp)] {
+            if (!running)
+                return;
+            umppi::UmpWordSpan word_span{sysex.data(), sysex.size()};
+            for (auto& forwarder : ci_input_forwarders)
+                forwarder(word_span, timestamp_ns);
+        });
+    }
 
+    void UapmdMidiCISessionImpl::detach() {
+        running = false;
+        if (parameter_support && metadata_listener_id != 0)
+            parameter_support->parameterMetadataChangeEvent().removeListener(metadata_listener_id);
+        parameter_support = nullptr;
+        metadata_listener_id = 0;
+        MidiServiceWorker::instance().cancel(this);
     }
 
     void setupParameterList(std::string controlType,
@@ -113,6 +173,41 @@ namespace uapmd_midi_service {
         }
     }
 
+    // Controller and program lists are served from what was last published
+    // here, and only rebuilt when the plugin reports changed parameter
+    // metadata. There is no preset list notification, so the program list is
+    // refreshed along with them.
+    void UapmdMidiCISessionImpl::publishControlLists(MidiCIDevice& ciDevice) {
+        if (!instance)
+            return;
+        std::vector<commonproperties::MidiCIControl> allCtrlList{};
+
+        parameter_list = instance->parameterMetadataList();
+        setupParameterList(MidiCIControlType::NRPN, allCtrlList, parameter_list, ciDevice);
+        // FIXME: we need some way to indicate the context key (it is impossible so far, by design).
+        auto perNoteControllerList = instance->perNoteControllerMetadataList(remidy::PER_NOTE_CONTROLLER_PER_NOTE, 64);
+        setupParameterList(MidiCIControlType::PNAC, allCtrlList, perNoteControllerList, ciDevice);
+
+        StandardPropertiesExtensions::setAllCtrlList(ciDevice, allCtrlList);
+
+        std::vector<PresetsMetadata> presetsList = instance->presetMetadataList();
+        std::vector<commonproperties::MidiCIProgram> programList{};
+        programList.reserve(presetsList.size());
+        for (auto& p : presetsList) {
+            // Unlike nominal mappings, we use bank MSB as part of preset index upper bits.
+            // To identify whether the bank MSB is for preset index or preset bank, we use the first 1 bit as
+            // - 1 to indicate that the field is index (8th-13th. bits)
+            // - 0 to indicate that the field is bank MSB (8th-13th. bits)
+            if (p.index < 1 << 13) {
+                auto msb = static_cast<uint8_t>(p.index >= 0x80 ? p.index / 0x80 | 0x40 : p.bank / 0x80);
+                auto lsb = static_cast<uint8_t>(p.bank % 0x80);
+                auto index = static_cast<uint8_t>(p.index % 0x80);
+                programList.push_back({p.name, {msb, lsb, index}});
+            }
+        }
+        StandardPropertiesExtensions::setProgramList(ciDevice, programList);
+    }
+
     void UapmdMidiCISessionImpl::setupMidiCISession() {
         midicci::MidiCIDeviceConfiguration ci_config{
             midicci::DEFAULT_RECEIVABLE_MAX_SYSEX_SIZE,
@@ -169,38 +264,15 @@ namespace uapmd_midi_service {
 
         hostProps.updateCommonRulesDeviceInfo(device_info);
 
-        std::vector<commonproperties::MidiCIControl> allCtrlList{};
-
-        auto parameterList = instance->parameterMetadataList();
-        setupParameterList(MidiCIControlType::NRPN, allCtrlList, parameterList, ciDevice);
-        // FIXME: we need some way to indicate the context key (it is impossible so far, by design).
-        auto perNoteControllerList = instance->perNoteControllerMetadataList(remidy::PER_NOTE_CONTROLLER_PER_NOTE, 64);
-        setupParameterList(MidiCIControlType::PNAC, allCtrlList, perNoteControllerList, ciDevice);
-
-        StandardPropertiesExtensions::setAllCtrlList(ciDevice, allCtrlList);
-
-        std::vector<PresetsMetadata> presetsList = instance->presetMetadataList();
-        std::vector<commonproperties::MidiCIProgram> programList{};
-        programList.reserve(presetsList.size());
-        for (auto& p : presetsList) {
-            // Unlike nominal mappings, we use bank MSB as part of preset index upper bits.
-            // To identify whether the bank MSB is for preset index or preset bank, we use the first 1 bit as
-            // - 1 to indicate that the field is index (8th-13th. bits)
-            // - 0 to indicate that the field is bank MSB (8th-13th. bits)
-            if (p.index < 1 << 13) {
-                auto msb = static_cast<uint8_t>(p.index >= 0x80 ? p.index / 0x80 | 0x40 : p.bank / 0x80);
-                auto lsb = static_cast<uint8_t>(p.bank % 0x80);
-                auto index = static_cast<uint8_t>(p.index % 0x80);
-                programList.push_back({p.name, {msb, lsb, index}});
-            }
-        }
-        StandardPropertiesExtensions::setProgramList(ciDevice, programList);
+        publishControlLists(ciDevice);
 
         // Set up custom property getter/setter for dynamic state management
         // Retrieve the original getter before setting the new one
         auto originalGetter = hostProps.getPropertyBinaryGetter();
 
-        // Create custom property getter that uses AudioPluginNode::saveState() for State/fullState
+        // Create custom property getter that uses AudioPluginNode::saveState() for State/fullState.
+        // It runs on the worker, so waiting for the plugin does not block MIDI input, and the wait
+        // serves the other function blocks (see waitForPlugin()).
         auto customGetter = [this, originalGetter](const std::string& property_id, const std::string& res_id) -> std::vector<uint8_t> {
             if (property_id == StandardPropertyNames::STATE && res_id == MidiCIStatePredefinedNames::FULL_STATE) {
                 if (instance) {
@@ -210,6 +282,8 @@ namespace uapmd_midi_service {
                                            [statePromise](std::vector<uint8_t> state, std::string error, void* callbackContext) {
                                                statePromise->set_value({std::move(state), std::move(error)});
                                            });
+                    if (!waitForPlugin(stateFuture))
+                        return {};
                     auto [state, error] = stateFuture.get();
                     if (error.empty())
                         return state;
@@ -235,6 +309,8 @@ namespace uapmd_midi_service {
                                         [loadPromise](std::string error, void* callbackContext) {
                                             loadPromise->set_value(std::move(error));
                                         });
+                    if (!waitForPlugin(loadFuture))
+                        return false;
                     return loadFuture.get().empty();
                 }
                 return false;
@@ -245,12 +321,15 @@ namespace uapmd_midi_service {
         hostProps.setPropertyBinarySetter(customSetter);
 
         on_process_midi_message_report = [&] {
-            // Dump all current parameter values when MIDI Message Report is requested
+            // Dump all current parameter values when MIDI Message Report is requested.
+            // Runs on the worker, from the list last published there, and goes out as one
+            // batch that the device splits into packets as it needs to.
             if (!instance || !device->midiIO())
                 return;
 
-            auto parameterList = instance->parameterMetadataList();
-            for (auto& p : parameterList) {
+            std::vector<uapmd_ump_t> batch{};
+            batch.reserve(parameter_list.size() * 2);
+            for (auto& p : parameter_list) {
                 if (p.hidden || !p.automatable)
                     continue;
                 if (p.index >= (1 << 14))
@@ -276,12 +355,11 @@ namespace uapmd_midi_service {
                 const uint8_t controllerIndex = static_cast<uint8_t>(p.index & 0x7F);
                 const auto data = static_cast<uint32_t>(normalized * static_cast<double>(UINT32_MAX));
                 auto ump = umppi::UmpFactory::midi2NRPN(group, channel, bank, controllerIndex, data);
-                uapmd_ump_t words[2]{
-                    static_cast<uapmd_ump_t>(ump >> 32),
-                    static_cast<uapmd_ump_t>(ump & 0xFFFFFFFFu)
-                };
-                device->midiIO()->send(words, sizeof(words), 0);
+                batch.push_back(static_cast<uapmd_ump_t>(ump >> 32));
+                batch.push_back(static_cast<uapmd_ump_t>(ump & 0xFFFFFFFFu));
             }
+            if (!batch.empty())
+                device->midiIO()->send(batch.data(), batch.size() * sizeof(uapmd_ump_t), 0);
         };
 
         ciDevice.getMessenger().addMessageCallback([this](const Message& req) {
@@ -290,6 +368,20 @@ namespace uapmd_midi_service {
                     on_process_midi_message_report();
             }
         });
+
+        running = true;
+        // Published lists stay until the plugin reports a metadata change.
+        if ((parameter_support = instance ? instance->parameterSupport() : nullptr))
+            metadata_listener_id = parameter_support->parameterMetadataChangeEvent().addListener([this] {
+                if (control_lists_dirty.exchange(true))
+                    return;
+                MidiServiceWorker::instance().post(this, [this] {
+                    control_lists_dirty = false;
+                    if (!running)
+                        return;
+                    publishControlLists(ci_session->getDevice());
+                });
+            });
     }
 
     std::unique_ptr<UapmdMidiCISession> UapmdMidiCISession::create(
@@ -13,6 +13,11 @@ namespace uapmd_midi_service {
     // Handles UAPMD-specific MIDI-CI messages. Namely, it registers property getter and setter for
     // AllCtrlList, CtrlMapList, ProgramList, and State.
     //
+    // MIDI-CI SysEx is handed to the MidiServiceWorker, so property replies that wait for the plugin
+    // (State) never hold up the MIDI input path, nor, as they wait through MidiServiceWorker::waitFor(),
+    // the other function blocks. The control lists are cached and only rebuilt on that
+    // worker when the plugin reports a parameter metadata change.
+    //
     // There is no "output interceptor" as it will be handled by MidiCISession and its registered `MidiIODevice`.
     //
     // It used to be part of the public API and therefore everything is pure virtual, but we don't really expose
@@ -33,5 +38,9 @@ namespace uapmd_midi_service {
         virtual void interceptUmpInput(uapmd_ump_t* ump, size_t sizeInBytes, uapmd_timestamp_t timestamp) = 0;
 
         virtual void setMidiMessageReportHandler(std::function<void()>&& onProcessMidiMessageReport) = 0;
+
+        // Cancels the session's work on the worker and unregisters the plugin listeners. Call while the
+        // plugin instance is still alive; it is also done on destruction.
+        virtual void detach() = 0;
     };
 }
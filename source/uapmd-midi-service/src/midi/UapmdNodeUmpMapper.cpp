@@ -4,6 +4,7 @@
 #include <limits>
 #include <umppi/umppi.hpp>
 #include "uapmd-midi-service/uapmd-midi-service.hpp"
+#include "MidiServiceWorker.hpp"
 #include "UapmdNodeUmpMapper.hpp"
 
 namespace uapmd_midi_service {
@@ -55,7 +56,7 @@ namespace uapmd_midi_service {
         if (!parameter_support)
             return;
         param_change_listener_id = parameter_support->parameterChangeEvent().addListener([this](uint32_t index, double value) {
-            sendParameterValue(index, value);
+            queueParameterValue(index, value);
         });
         per_note_change_listener_id = parameter_support->perNoteControllerChangeEvent().addListener(
             [this](remidy::PerNoteControllerContextTypes types, uint32_t context, uint32_t parameterIndex, double value) {
@@ -84,6 +85,7 @@ namespace uapmd_midi_service {
                 // Some plugin backends tear parameter support down during shutdown; destructors must not terminate.
             }
         }
+        MidiServiceWorker::instance().cancel(this);
         device = nullptr;
         plugin = nullptr;
         parameter_support = nullptr;
@@ -91,12 +93,7 @@ namespace uapmd_midi_service {
         per_note_change_listener_id = -1;
     }
 
-    void UapmdNodeUmpOutputMapper::sendParameterValue(uint16_t index, double value) {
-        if (!device)
-            return;
-        if (index >= 1 << 14)
-            return;
-        double normalized = normalizeParameterValue(index, value);
+    uint64_t UapmdNodeUmpOutputMapper::parameterValueUmp(uint16_t index, double normalized) {
         if (!std::isfinite(normalized))
             normalized = 0.0;
         const double clamped = std::clamp(normalized, 0.0, 1.0);
@@ -105,7 +102,15 @@ namespace uapmd_midi_service {
         const uint8_t bank = static_cast<uint8_t>((index >> 7) & 0x7F);
         const uint8_t controllerIndex = static_cast<uint8_t>(index & 0x7F);
         const auto data = static_cast<uint32_t>(clamped * static_cast<double>(std::numeric_limits<uint32_t>::max()));
-        auto ump = umppi::UmpFactory::midi2NRPN(group, channel, bank, controllerIndex, data);
+        return umppi::UmpFactory::midi2NRPN(group, channel, bank, controllerIndex, data);
+    }
+
+    void UapmdNodeUmpOutputMapper::sendParameterValue(uint16_t index, double value) {
+        if (!device)
+            return;
+        if (index >= 1 << 14)
+            return;
+        auto ump = parameterValueUmp(index, normalizeParameterValue(index, value));
         uapmd_ump_t words[2]{
             static_cast<uapmd_ump_t>(ump >> 32),
             static_cast<uapmd_ump_t>(ump & 0xFFFFFFFFu)
@@ -113,6 +118,42 @@ namespace uapmd_midi_service {
         device->send(words, sizeof(words), 0);
     }
 
+    void UapmdNodeUmpOutputMapper::queueParameterValue(uint16_t index, double value) {
+        if (!device || index >= 1 << 14)
+            return;
+        const double normalized = normalizeParameterValue(index, value);
+        {
+            std::lock_guard lock(pending_parameter_mutex_);
+            auto pending = std::ranges::find(pending_parameter_values_, index, &std::pair<uint16_t, double>::first);
+            if (pending != pending_parameter_values_.end())
+                pending->second = normalized;
+            else
+                pending_parameter_values_.emplace_back(index, normalized);
+            if (std::exchange(parameter_flush_posted_, true))
+                return;
+        }
+        MidiServiceWorker::instance().post(this, [this] { flushParameterValues(); });
+    }
+
+    void UapmdNodeUmpOutputMapper::flushParameterValues() {
+        std::vector<std::pair<uint16_t, double>> values{};
+        {
+            std::lock_guard lock(pending_parameter_mutex_);
+            values.swap(pending_parameter_values_);
+            parameter_flush_posted_ = false;
+        }
+        if (!device || values.empty())
+            return;
+        std::vector<uapmd_ump_t> batch{};
+        batch.reserve(values.size() * 2);
+        for (auto& [index, normalized] : values) {
+            auto ump = parameterValueUmp(index, normalized);
+            batch.push_back(static_cast<uapmd_ump_t>(ump >> 32));
+            batch.push_back(static_cast<uapmd_ump_t>(ump & 0xFFFFFFFFu));
+        }
+        device->send(batch.data(), batch.size() * sizeof(uapmd_ump_t), 0);
+    }
+
     void UapmdNodeUmpOutputMapper::sendPerNoteControllerValue(uint8_t note, uint8_t index, double value) {
         if (!device)
             return;
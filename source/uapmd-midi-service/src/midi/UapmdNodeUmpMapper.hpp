@@ -1,5 +1,8 @@
 #pragma once
 #include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 #include <remidy/remidy.hpp>
 #include "readerwriterqueue.h"
 #include "uapmd-midi-service/detail/midi/MidiIOFeature.hpp"
@@ -40,6 +43,16 @@ namespace uapmd_midi_service {
         remidy::EventListenerId param_change_listener_id;
         remidy::EventListenerId per_note_change_listener_id;
 
+        // Parameter changes waiting for the MidiServiceWorker, latest value per index in the order they
+        // first changed. A burst of changes, such as a preset load, goes out as one batch.
+        std::mutex pending_parameter_mutex_{};
+        std::vector<std::pair<uint16_t, double>> pending_parameter_values_{};
+        bool parameter_flush_posted_{false};
+
+        void queueParameterValue(uint16_t index, double value);
+        void flushParameterValues();
+        static uint64_t parameterValueUmp(uint16_t index, double normalized);
+
         double normalizeParameterValue(uint16_t index, double plainValue) const;
         double normalizePerNoteControllerValue(remidy::PerNoteControllerContextTypes types, uint32_t context, uint32_t parameterIndex, double plainValue) const;
 
@@ -3,10 +3,12 @@
 #include "StemSeparationSupport.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cmath>
 #include <exception>
 #include <format>
+#include <stdexcept>
 #include <string>
 #include <system_error>
 #include <vector>
@@ -24,7 +26,13 @@ using uapmd::import::StemSeparatorModelFileSpec;
 namespace {
 
 constexpr float kProgressAfterLoad = 0.05f;
-constexpr float kProgressAfterSeparation = 0.90f;
+
+// Process() runs its own chunked overlap-add over whatever it is given; these
+// outer windows, a few model chunks long, bound how much audio and how many
+// stem buffers one call holds. ggml already spreads one inference over every
+// core, and a second Inference would load the weights again, so windows run
+// one at a time.
+constexpr int kChunksPerWindow = 4;
 
 // The GGUF format carries a stem *count* and no stem names, so these have to
 // be inferred. Published BS-Roformer and Mel-Band-Roformer models are vocal
@@ -99,17 +107,18 @@ StemSeparationResult BSRoformerStemSeparator::separate(const StemSeparationReque
 
     // Inference reports cancellation by throwing, so remember that we asked
     // for it and tell the two kinds of cancellation apart in the handler.
-    bool cancelRequested = false;
+    // Polled from the separation worker as well as this thread.
+    std::atomic<bool> cancelRequested{false};
     auto shouldCancel = [&]() {
-        if (cancelRequested)
+        if (cancelRequested.load(std::memory_order_acquire))
             return true;
         if (request.shouldCancel && request.shouldCancel())
-            cancelRequested = true;
-        return cancelRequested;
+            cancelRequested.store(true, std::memory_order_release);
+        return cancelRequested.load(std::memory_order_acquire);
     };
     auto emitProgress = [&](float value, const std::string& message) {
         if (request.progressCallback && !request.progressCallback(value, message))
-            cancelRequested = true;
+            cancelRequested.store(true, std::memory_order_release);
     };
 
     try {
@@ -129,8 +138,8 @@ StemSeparationResult BSRoformerStemSeparator::separate(const StemSeparationReque
         const auto sampleRate = static_cast<uint32_t>(modelSampleRate);
 
         emitProgress(kProgressAfterLoad, "Preparing BS-Roformer input...");
-        uapmd_stems::StereoAudio input;
-        if (!uapmd_stems::loadStereoAudio(request.audioFile, sampleRate, input, result.error))
+        uapmd_stems::StereoAudioReader input;
+        if (!input.open(request.audioFile, sampleRate, result.error))
             return result;
 
         if (shouldCancel()) {
@@ -138,105 +147,92 @@ StemSeparationResult BSRoformerStemSeparator::separate(const StemSeparationReque
             return result;
         }
 
-        const auto interleaved = interleaveStereo(input);
-
         // These come from the model, and they decide how long the run takes:
         // every sample is processed `overlap` times, so the total work is
         // roughly (audio duration / step) inference passes. Say so before
-        // starting -- progress only arrives once a whole pass completes, and
+        // starting -- progress only arrives once a whole window completes, and
         // one pass is tens of seconds on CPU.
         const auto chunkSize = inference.GetDefaultChunkSize();
         const auto overlap = std::max(1, inference.GetDefaultNumOverlap());
+        uapmd_stems::WindowedSeparationOptions options;
+        options.windowFrames = static_cast<size_t>(std::max(chunkSize, 1)) * kChunksPerWindow;
+        options.overlapFrames = static_cast<size_t>(std::max(chunkSize, 1)) / 2;
+        options.workerCount = 1;
+        const auto windowCount = uapmd_stems::windowCountFor(input.frameCount(), options);
         const auto inputSeconds = static_cast<double>(input.frameCount()) / sampleRate;
-        const auto totalChunks = expectedChunkCount(input.frameCount(), chunkSize, overlap);
+        const auto passesPerWindow = expectedChunkCount(options.windowFrames, chunkSize, overlap);
         remidy::Logger::global()->logInfo(
-            "BS-Roformer: %.1fs of audio; chunk %.1fs, overlap %d -> %d inference passes",
-            inputSeconds, static_cast<double>(chunkSize) / sampleRate, overlap, totalChunks);
+            "BS-Roformer: %.1fs of audio; chunk %.1fs, overlap %d -> %zu windows of ~%d inference passes",
+            inputSeconds, static_cast<double>(chunkSize) / sampleRate, overlap, windowCount, passesPerWindow);
+
+        auto separateWindow = [&](const uapmd_stems::StereoAudio& window) {
+            const auto stems = inference.Process(
+                interleaveStereo(window), chunkSize, overlap,
+                [](float) {},
+                [&]() { return shouldCancel(); });
+            if (stems.empty())
+                throw std::runtime_error("BS-Roformer returned no stems");
+
+            // Process() hands back interleaved stereo; the writer wants planar.
+            std::vector<uapmd_stems::StereoAudio> planar(stems.size());
+            for (size_t index = 0; index < stems.size(); ++index) {
+                const auto& stem = stems[index];
+                const size_t frameCount = stem.size() / 2;
+                planar[index].left.resize(frameCount);
+                planar[index].right.resize(frameCount);
+                for (size_t frame = 0; frame < frameCount; ++frame) {
+                    planar[index].left[frame] = stem[frame * 2];
+                    planar[index].right[frame] = stem[frame * 2 + 1];
+                }
+            }
+            return planar;
+        };
+
+        uapmd_stems::StemFileSet files(
+            request.outputDirectory, std::filesystem::path(request.audioFile).stem().string(),
+            sampleRate, input.frameCount(), stemNames);
 
         const auto separationStart = std::chrono::steady_clock::now();
         emitProgress(kProgressAfterLoad,
-                     std::format("Separating stems (pass 1 of {})...", std::max(totalChunks, 1)));
-
-        const auto stems = inference.Process(
-            interleaved,
-            chunkSize,
-            overlap,
-            [&](float progress) {
-                const auto fraction = std::clamp(progress, 0.0f, 1.0f);
+                     std::format("Separating stems (window 1 of {})...", std::max<size_t>(windowCount, 1)));
+        const auto outcome = uapmd_stems::separateInWindows(
+            input, options, separateWindow,
+            [&files](size_t stem, size_t stemCount, const float* left, const float* right, size_t frames) {
+                return files.append(stem, stemCount, left, right, frames);
+            },
+            [&](size_t completed, size_t total) {
+                const auto fraction = static_cast<double>(completed) / static_cast<double>(total);
                 const auto elapsed = std::chrono::duration<double>(
                     std::chrono::steady_clock::now() - separationStart).count();
-                const auto done = std::max(1, static_cast<int>(std::lround(fraction * totalChunks)));
-                const auto remaining = fraction > 0.0f ? elapsed * (1.0 - fraction) / fraction : 0.0;
-
+                const auto remaining = elapsed * (1.0 - fraction) / fraction;
                 remidy::Logger::global()->logInfo(
-                    "BS-Roformer: pass %d/%d (%.0f%%), %.0fs elapsed, ~%.0fs left",
-                    done, totalChunks, fraction * 100.0, elapsed, remaining);
-
-                const auto scaled = kProgressAfterLoad
-                    + fraction * (kProgressAfterSeparation - kProgressAfterLoad);
-                emitProgress(scaled, std::format("Separating stems: pass {} of {}, ~{} left",
-                                                 done, std::max(totalChunks, 1),
-                                                 formatDuration(remaining)));
+                    "BS-Roformer: window %zu/%zu (%.0f%%), %.0fs elapsed, ~%.0fs left",
+                    completed, total, fraction * 100.0, elapsed, remaining);
+                emitProgress(kProgressAfterLoad + static_cast<float>(fraction) * (1.0f - kProgressAfterLoad),
+                             std::format("Separating stems: window {} of {}, ~{} left",
+                                         completed, total, formatDuration(remaining)));
             },
             [&]() { return shouldCancel(); });
 
-        if (shouldCancel()) {
+        if (outcome == uapmd_stems::WindowedSeparationOutcome::Canceled || shouldCancel()) {
             result.canceled = true;
             return result;
         }
-        if (stems.empty()) {
-            result.error = "BS-Roformer returned no stems";
-            return result;
-        }
 
-        std::error_code ec;
-        std::filesystem::create_directories(request.outputDirectory, ec);
-        if (ec) {
-            result.error = std::format("Failed to create output directory: {}", ec.message());
+        std::vector<std::pair<std::string, std::filesystem::path>> written;
+        if (outcome != uapmd_stems::WindowedSeparationOutcome::Completed || !files.commit(written)) {
+            result.error = files.error();
             return result;
         }
-
-        const auto labels = stemNames(stems.size());
-        const auto baseName = std::filesystem::path(request.audioFile).stem().string();
-
-        for (size_t index = 0; index < stems.size(); ++index) {
-            if (shouldCancel()) {
-                result.canceled = true;
-                result.stems.clear();
-                return result;
-            }
-
-            // Process() hands back interleaved stereo; the writer wants planar.
-            const auto& stem = stems[index];
-            const size_t frameCount = stem.size() / 2;
-            std::vector<float> left(frameCount);
-            std::vector<float> right(frameCount);
-            for (size_t frame = 0; frame < frameCount; ++frame) {
-                left[frame] = stem[frame * 2];
-                right[frame] = stem[frame * 2 + 1];
-            }
-
-            auto outPath = request.outputDirectory
-                / std::format("{}_{}.wav", baseName, labels[index]);
-            if (!uapmd_stems::writeStereoWav(outPath, left.data(), right.data(), frameCount, sampleRate)) {
-                result.error = std::format("Failed to write stem {}", labels[index]);
-                result.stems.clear();
-                return result;
-            }
-
-            result.stems.push_back(StemFile{labels[index], outPath});
-            emitProgress(kProgressAfterSeparation
-                             + (1.0f - kProgressAfterSeparation)
-                                   * static_cast<float>(index + 1) / static_cast<float>(stems.size()),
-                         std::format("Writing stem {}...", labels[index]));
-        }
+        for (auto& [label, path] : written)
+            result.stems.push_back(StemFile{label, path});
 
         result.success = !result.stems.empty();
         if (!result.success)
             result.error = "No stems were generated";
         return result;
     } catch (const std::exception& ex) {
-        if (cancelRequested) {
+        if (cancelRequested.load(std::memory_order_acquire)) {
             result.canceled = true;
             result.success = false;
             return result;
@@ -11,6 +11,8 @@
 #include <limits>
 #include <stdexcept>
 #include <system_error>
+#include <thread>
+#include <utility>
 
 #include <dsp.hpp>
 #include <model.hpp>
@@ -28,6 +30,14 @@ namespace {
 
 constexpr uint32_t kTargetChannels = 2;
 
+// demucs_inference() already segments its input internally; these windows
+// only bound how much audio one call holds. Each in-flight window carries its
+// own inference buffers, so the worker count is capped as well.
+constexpr double kWindowSeconds = 60.0;
+constexpr double kOverlapSeconds = 2.0;
+constexpr unsigned kMaxWorkers = 4;
+constexpr float kProgressAfterLoad = 0.05f;
+
 struct SeparationCanceled : std::exception {
     const char* what() const noexcept override {
         return "Demucs separation canceled";
@@ -40,10 +50,11 @@ void checkShouldCancel(const StemSeparationCancelCallback& shouldCancel) {
     }
 }
 
-Eigen::MatrixXf buildEigenWaveform(const std::vector<float>& left,
-                                   const std::vector<float>& right)
+Eigen::MatrixXf buildEigenWaveform(const uapmd_stems::StereoAudio& input)
 {
-    const size_t frameCount = std::min(left.size(), right.size());
+    const auto& left = input.left;
+    const auto& right = input.right;
+    const size_t frameCount = input.frameCount();
     if (frameCount == 0) {
         return {};
     }
@@ -95,8 +106,8 @@ StemSeparationResult DemucsStemSeparator::separate(const StemSeparationRequest&
         return result;
     }
 
-    uapmd_stems::StereoAudio input;
-    if (!uapmd_stems::loadStereoAudio(audioFile, demucscpp::SUPPORTED_SAMPLE_RATE, input, result.error))
+    uapmd_stems::StereoAudioReader input;
+    if (!input.open(audioFile, demucscpp::SUPPORTED_SAMPLE_RATE, result.error))
         return result;
 
     auto emitProgress = [&](float progressValue, const std::string& message) {
@@ -113,66 +124,80 @@ StemSeparationResult DemucsStemSeparator::separate(const StemSeparationRequest&
     try {
         checkShouldCancel(shouldCancel);
 
-        auto waveform = buildEigenWaveform(input.left, input.right);
-        if (waveform.size() == 0) {
-            result.error = "Failed to prepare input audio";
-            return result;
-        }
-
+        emitProgress(0.0f, "Loading Demucs model...");
         demucscpp::demucs_model model{};
         if (!demucscpp::load_demucs_model(request.modelPath, &model)) {
             result.error = "Unable to load Demucs model";
             return result;
         }
 
-        demucscpp::ProgressCallback progress = [emitProgress](float progressValue, const std::string& message) {
-            emitProgress(progressValue, message);
+        uapmd_stems::WindowedSeparationOptions options;
+        options.windowFrames = static_cast<size_t>(kWindowSeconds * demucscpp::SUPPORTED_SAMPLE_RATE);
+        options.overlapFrames = static_cast<size_t>(kOverlapSeconds * demucscpp::SUPPORTED_SAMPLE_RATE);
+        options.workerCount = std::clamp(std::thread::hardware_concurrency(), 1u, kMaxWorkers);
+        const auto windowCount = uapmd_stems::windowCountFor(input.frameCount(), options);
+
+        // The model is only read during inference, so the workers share it;
+        // demucs.cpp's own multi-threaded driver does the same.
+        auto separateWindow = [&](const uapmd_stems::StereoAudio& window) {
+            auto waveform = buildEigenWaveform(window);
+            if (waveform.size() == 0)
+                throw std::runtime_error("Failed to prepare input audio");
+
+            // Progress is reported per window by the caller; inside one, the
+            // callback is only a cancellation point.
+            demucscpp::ProgressCallback progress = [&shouldCancel](float, const std::string&) {
+                checkShouldCancel(shouldCancel);
+            };
+            auto separation = demucscpp::demucs_inference(model, waveform, progress);
+            const int nbSources = separation.dimension(0);
+            const int nbChannels = separation.dimension(1);
+            const int nbFrames = separation.dimension(2);
+            if (nbChannels != static_cast<int>(kTargetChannels))
+                throw std::runtime_error("Demucs returned unexpected channel count");
+
+            std::vector<uapmd_stems::StereoAudio> stems(static_cast<size_t>(nbSources));
+            for (int target = 0; target < nbSources; ++target) {
+                auto& stem = stems[static_cast<size_t>(target)];
+                stem.left.resize(static_cast<size_t>(nbFrames));
+                stem.right.resize(static_cast<size_t>(nbFrames));
+                for (int frame = 0; frame < nbFrames; ++frame) {
+                    stem.left[static_cast<size_t>(frame)] = separation(target, 0, frame);
+                    stem.right[static_cast<size_t>(frame)] = separation(target, 1, frame);
+                }
+            }
+            return stems;
         };
 
-        auto separation = demucscpp::demucs_inference(model, waveform, progress);
-        const int nbSources = separation.dimension(0);
-        const int nbChannels = separation.dimension(1);
-        const int nbFrames = separation.dimension(2);
-
-        if (nbChannels != static_cast<int>(kTargetChannels)) {
-            result.error = "Demucs returned unexpected channel count";
-            return result;
-        }
-
-        checkShouldCancel(shouldCancel);
-
-        std::error_code ec;
-        std::filesystem::create_directories(outputDir, ec);
-        if (ec) {
-            result.error = std::format("Failed to create output directory: {}", ec.message());
+        uapmd_stems::StemFileSet files(
+            outputDir, std::filesystem::path(audioFile).stem().string(),
+            demucscpp::SUPPORTED_SAMPLE_RATE, input.frameCount(),
+            [isFourSource = model.is_4sources](size_t) { return stemNames(isFourSource); });
+
+        emitProgress(kProgressAfterLoad, std::format("Separating stems (window 1 of {})...", windowCount));
+        const auto outcome = uapmd_stems::separateInWindows(
+            input, options, separateWindow,
+            [&files](size_t stem, size_t stemCount, const float* left, const float* right, size_t frames) {
+                return files.append(stem, stemCount, left, right, frames);
+            },
+            [&](size_t completed, size_t total) {
+                emitProgress(kProgressAfterLoad
+                                 + (1.0f - kProgressAfterLoad) * static_cast<float>(completed)
+                                       / static_cast<float>(total),
+                             std::format("Separating stems: window {} of {}", completed, total));
+            },
+            [&shouldCancel] { return shouldCancel && shouldCancel(); });
+
+        if (outcome == uapmd_stems::WindowedSeparationOutcome::Canceled)
+            throw SeparationCanceled{};
+
+        std::vector<std::pair<std::string, std::filesystem::path>> written;
+        if (outcome != uapmd_stems::WindowedSeparationOutcome::Completed || !files.commit(written)) {
+            result.error = files.error();
             return result;
         }
-
-        const auto stemLabels = stemNames(model.is_4sources);
-        const int stemsToWrite = std::min(static_cast<int>(stemLabels.size()), nbSources);
-
-        for (int target = 0; target < stemsToWrite; ++target) {
-            checkShouldCancel(shouldCancel);
-            std::vector<float> stemLeft(static_cast<size_t>(nbFrames));
-            std::vector<float> stemRight(static_cast<size_t>(nbFrames));
-            for (int frame = 0; frame < nbFrames; ++frame) {
-                stemLeft[static_cast<size_t>(frame)] = separation(target, 0, frame);
-                stemRight[static_cast<size_t>(frame)] = separation(target, 1, frame);
-            }
-
-            auto outPath = outputDir / std::format("{}_{}.wav",
-                                                   std::filesystem::path(audioFile).stem().string(),
-                                                   stemLabels[target]);
-            if (!uapmd_stems::writeStereoWav(outPath, stemLeft.data(), stemRight.data(),
-                                             static_cast<size_t>(nbFrames),
-                                             demucscpp::SUPPORTED_SAMPLE_RATE)) {
-                result.error = std::format("Failed to write stem {}", stemLabels[target]);
-                result.stems.clear();
-                return result;
-            }
-
-            result.stems.push_back(StemFile{stemLabels[target], outPath});
-        }
+        for (auto& [label, path] : written)
+            result.stems.push_back(StemFile{label, path});
 
         result.success = !result.stems.empty();
         if (!result.success && result.error.empty()) {
@@ -8,6 +8,7 @@
 #include <limits>
 #include <memory>
 #include <ranges>
+#include <span>
 #include <string>
 #include <thread>
 #include <tuple>
@@ -21,6 +22,7 @@
 #include <uapmd-addin-core/uapmd-addin-core.hpp>
 #if UAPMD_ENABLE_LIBSONARE
 #include <uapmd-engine/uapmd-engine.hpp>
+#include "MirAnalysisPipeline.hpp"
 #include "MirDiagnostics.hpp"
 #include "MirTempoAnalysis.hpp"
 #include "MirRhythmAnalysis.hpp"
@@ -38,6 +40,8 @@ constexpr std::string_view kCommandExtensionPoint{"/uapmd/app/command/v1"};
 constexpr uint32_t kDefaultTickResolution = 480;
 constexpr uint8_t kTempoGroup = 0;
 constexpr uint8_t kTempoChannel = 0;
+// Keys cached results; bump whenever the analysis below can change its output.
+constexpr uint32_t kAnalyserVersion = 2;
 
 enum class MirStage {
     Idle,
@@ -308,7 +312,6 @@ private:
             if (projectTickResolution == 0)
                 projectTickResolution = kDefaultTickResolution;
 
-            std::vector<AnalysisResult> results;
             std::vector<uapmd::ProjectClipSnapshot> midiClips;
             for (const auto& trackId : view.trackIds()) {
                 for (const auto& clipId : view.clipIds(trackId)) {
@@ -318,14 +321,11 @@ private:
                 }
             }
 
-            const auto sourceIds = view.audioSourceIds();
-            totalSources_.store(static_cast<int>(sourceIds.size()), std::memory_order_release);
-            stage_.store(MirStage::Analyzing, std::memory_order_release);
-            for (const auto& sourceId : sourceIds) {
-                if (stopRequested_.load(std::memory_order_acquire))
-                    return;
-                processedSources_.fetch_add(1, std::memory_order_acq_rel);
-
+            // Gather the sources up front so the pool's workers only touch
+            // their own snapshots and files, not the document.
+            std::vector<uapmd::ProjectAudioSourceSnapshot> sources;
+            std::vector<uapmd::ProjectClipSnapshot> sourceClips;
+            for (const auto& sourceId : view.audioSourceIds()) {
                 const auto source = view.getAudioSource(sourceId);
                 if (!source || source->frameCount <= 0 || source->channelCount == 0 || source->sampleRate <= 0)
                     continue;
@@ -336,52 +336,32 @@ private:
                         return intervalsOverlap(*sourceClip, midiClip);
                     }))
                     continue;
+                sources.push_back(*source);
+                sourceClips.push_back(*sourceClip);
+            }
 
-                const auto frameCount = static_cast<size_t>(source->frameCount);
-                std::vector<std::vector<float>> channels(
-                    source->channelCount, std::vector<float>(frameCount));
-                std::vector<float*> destinations;
-                destinations.reserve(channels.size());
-                for (auto& channel : channels)
-                    destinations.push_back(channel.data());
-
-                if (!view.readAudioSourceSamples(
-                        sourceId, 0, source->frameCount, destinations.data(), source->channelCount))
-                    continue;
-
-                std::vector<float> mono(frameCount, 0.0f);
-                for (size_t frame = 0; frame < frameCount; ++frame) {
-                    for (const auto& channel : channels)
-                        mono[frame] += channel[frame];
-                    mono[frame] /= static_cast<float>(channels.size());
-                }
+            totalSources_.store(static_cast<int>(sources.size()), std::memory_order_release);
+            stage_.store(MirStage::Analyzing, std::memory_order_release);
 
-                const auto rawLog = [&diagnostics](std::string_view message) {
-                    diagnostics.append(message);
-                };
+            const uapmd_mir::AnalysisLogger rawLog = [&diagnostics](std::string_view message) {
+                diagnostics.append(message);
+            };
+            uapmd_mir::MirAnalysisKinds kinds;
+            kinds.rhythm = [&rawLog](std::span<const float> mono, int sampleRate,
+                                     uapmd_mir::MirFeatures& features) {
                 rawLog(std::format(
-                    "libsonare raw source frames={} sample_rate={:.6f} duration={:.6f}s",
-                    frameCount, source->sampleRate, frameCount / source->sampleRate));
-
-                AnalysisResult result;
-                result.position = sourceClip->position;
-                result.tick_resolution = projectTickResolution;
-                result.duration_samples = sourceClip->durationSamples;
-                result.sample_rate = source->sampleRate;
-                result.bpm = 120.0;
-                result.tempo_points = uapmd_mir::sonare::detectTempoMap(
-                    mono, static_cast<int>(source->sampleRate), result.bpm, rawLog);
-                if (!result.tempo_points.empty())
-                    result.bpm = result.tempo_points.front().second;
-
-                result.time_signatures = uapmd_mir::sonare::detectRhythmMap(
-                    mono, static_cast<int>(source->sampleRate),
-                    result.tempo_points, result.bpm, rawLog);
-                if (!result.time_signatures.empty()) {
-                    result.time_signature_numerator = std::get<1>(result.time_signatures.front());
-                    result.time_signature_denominator = std::get<2>(result.time_signatures.front());
-                }
-
+                    "libsonare raw window frames={} sample_rate={} duration={:.6f}s",
+                    mono.size(), sampleRate, static_cast<double>(mono.size()) / sampleRate));
+                features.bpm = 120.0;
+                features.tempo_points = uapmd_mir::sonare::detectTempoMap(
+                    mono, sampleRate, features.bpm, rawLog);
+                if (!features.tempo_points.empty())
+                    features.bpm = features.tempo_points.front().second;
+                features.time_signatures = uapmd_mir::sonare::detectRhythmMap(
+                    mono, sampleRate, features.tempo_points, features.bpm, rawLog);
+            };
+            kinds.harmony = [&rawLog](std::span<const float> mono, int sampleRate,
+                                      uapmd_mir::MirFeatures& features) {
                 SonareChordDetectionOptions options{};
                 options.min_duration = 0.25f;
                 options.smoothing_window = 0.5f;
@@ -399,24 +379,50 @@ private:
                 SonareChordAnalysisResult chords{};
                 rawLog("uapmd calling libsonare chord analysis");
                 const auto chordError = sonare_detect_chords_ex(
-                    mono.data(), mono.size(), static_cast<int>(source->sampleRate),
-                    &options, &chords);
-                if (chordError == SONARE_OK) {
-                    rawLog(std::format(
-                        "libsonare raw chords count={}", chords.chord_count));
-                    for (size_t index = 0; index < chords.chord_count; ++index) {
-                        const auto& chord = chords.chords[index];
-                        rawLog(std::format(
-                            "libsonare raw chord index={} start={:.6f}s end={:.6f}s root={} quality={} bass={} confidence={:.6f}",
-                            index, chord.start, chord.end, static_cast<int>(chord.root),
-                            static_cast<int>(chord.quality), static_cast<int>(chord.bass),
-                            chord.confidence));
-                        result.chords.emplace_back(chord.start, chordLabel(chord));
-                    }
-                    sonare_free_chord_analysis_result(&chords);
-                } else
+                    mono.data(), mono.size(), sampleRate, &options, &chords);
+                if (chordError != SONARE_OK) {
                     rawLog(std::format(
                         "libsonare raw chords error={}", static_cast<int>(chordError)));
+                    return;
+                }
+                rawLog(std::format(
+                    "libsonare raw chords count={}", chords.chord_count));
+                for (size_t index = 0; index < chords.chord_count; ++index) {
+                    const auto& chord = chords.chords[index];
+                    rawLog(std::format(
+                        "libsonare raw chord index={} start={:.6f}s end={:.6f}s root={} quality={} bass={} confidence={:.6f}",
+                        index, chord.start, chord.end, static_cast<int>(chord.root),
+                        static_cast<int>(chord.quality), static_cast<int>(chord.bass),
+                        chord.confidence));
+                    features.chords.emplace_back(chord.start, chordLabel(chord));
+                }
+                sonare_free_chord_analysis_result(&chords);
+            };
+
+            const uapmd_mir::MirAnalysisCache cache{"libsonare", kAnalyserVersion};
+            auto features = uapmd_mir::analyzeSources(
+                view, sources, cache, kinds, stopRequested_, processedSources_);
+            if (stopRequested_.load(std::memory_order_acquire))
+                return;
+
+            std::vector<AnalysisResult> results;
+            for (size_t index = 0; index < sources.size(); ++index) {
+                if (!features[index])
+                    continue;
+                auto& analysed = *features[index];
+                AnalysisResult result;
+                result.position = sourceClips[index].position;
+                result.tick_resolution = projectTickResolution;
+                result.duration_samples = sourceClips[index].durationSamples;
+                result.sample_rate = sources[index].sampleRate;
+                result.bpm = analysed.bpm;
+                result.tempo_points = std::move(analysed.tempo_points);
+                result.time_signatures = std::move(analysed.time_signatures);
+                if (!result.time_signatures.empty()) {
+                    result.time_signature_numerator = std::get<1>(result.time_signatures.front());
+                    result.time_signature_denominator = std::get<2>(result.time_signatures.front());
+                }
+                result.chords = std::move(analysed.chords);
                 results.push_back(std::move(result));
             }
 
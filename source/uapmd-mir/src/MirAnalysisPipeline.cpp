@@ -0,0 +1,606 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string_view>
+
+#if defined(UAPMD_HAS_CPPLOCATE)
+#include <cpplocate/cpplocate.h>
+#endif
+
+#include "MirAnalysisPipeline.hpp"
+
+namespace uapmd_mir {
+
+namespace {
+
+constexpr int64_t kReadBlockFrames = 64 * 1024;
+constexpr std::string_view kEntryMagic = "uapmd-mir-cache 1";
+constexpr std::string_view kSourceMagic = "uapmd-mir-source 1";
+
+// Incremental FNV-1a 64, the hash the project chunk container uses.
+class ContentHasher {
+public:
+    ContentHasher() = default;
+    explicit ContentHasher(uint64_t resumeFrom) : hash_(resumeFrom) {}
+
+    void update(std::span<const float> samples) {
+        for (const auto sample : samples) {
+            auto bits = std::bit_cast<uint32_t>(sample);
+            for (int byte = 0; byte < 4; ++byte) {
+                hash_ ^= bits & 0xFFu;
+                hash_ *= 1099511628211ull;
+                bits >>= 8;
+            }
+        }
+    }
+
+    uint64_t value() const { return hash_; }
+
+private:
+    uint64_t hash_{14695981039346656037ull};
+};
+
+uint64_t hashString(std::string_view text) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const auto c : text) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Serialises reads that have to go through the document view; it makes no
+// promise about concurrent readers, unlike the per-task file readers.
+std::mutex viewReadMutex;
+
+// Modification time doubles as the last use, which eviction goes by.
+void markUsed(const std::filesystem::path& path) {
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+}
+
+std::optional<std::string> readTextFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return std::nullopt;
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+} // namespace
+
+// MirMonoReader
+
+MirMonoReader::MirMonoReader(const uapmd::ProjectDocumentView& view,
+                             const uapmd::ProjectAudioSourceSnapshot& source)
+    : view_(view), source_(source), hash_(ContentHasher{}.value()) {
+    // A reader of our own streams the file sequentially; going through the
+    // view would reopen it for every block.
+    if (!source_.filepath.empty())
+        reader_ = uapmd::createAudioFileReaderFromPath(source_.filepath);
+    readerFrames_ = reader_
+        ? static_cast<int64_t>(reader_->getProperties().numFrames) : source_.frameCount;
+    readerChannels_ = reader_
+        ? std::min(reader_->getProperties().numChannels, source_.channelCount) : source_.channelCount;
+
+    const auto blockFrames = static_cast<size_t>(std::clamp<int64_t>(source_.frameCount, 0, kReadBlockFrames));
+    block_.assign(source_.channelCount, std::vector<float>(blockFrames));
+    destinations_.reserve(block_.size());
+    for (auto& channel : block_)
+        destinations_.push_back(channel.data());
+}
+
+MirMonoReader::~MirMonoReader() = default;
+
+bool MirMonoReader::read(std::span<float> destination) {
+    if (source_.channelCount == 0)
+        return false;
+    ContentHasher hasher{hash_};
+    const auto gain = 1.0f / static_cast<float>(source_.channelCount);
+    size_t written = 0;
+    while (written < destination.size() && !finished()) {
+        const auto frames = std::min({kReadBlockFrames, source_.frameCount - position_,
+                                      static_cast<int64_t>(destination.size() - written)});
+        if (reader_) {
+            for (auto& channel : block_)
+                std::fill_n(channel.begin(), frames, 0.0f);
+            const auto available = std::min(frames, readerFrames_ - position_);
+            if (available > 0)
+                reader_->readFrames(static_cast<uint64_t>(position_), static_cast<uint64_t>(available),
+                                    destinations_.data(), readerChannels_);
+        } else {
+            std::lock_guard lock(viewReadMutex);
+            if (!view_.readAudioSourceSamples(source_.audioSourceId, position_, frames,
+                                              destinations_.data(), source_.channelCount))
+                return false;
+        }
+
+        auto mono = destination.subspan(written, static_cast<size_t>(frames));
+        for (size_t frame = 0; frame < mono.size(); ++frame) {
+            float sum = 0.0f;
+            for (const auto& channel : block_)
+                sum += channel[frame];
+            mono[frame] = sum * gain;
+        }
+        hasher.update(mono);
+        hash_ = hasher.value();
+        written += mono.size();
+        position_ += frames;
+    }
+    return true;
+}
+
+std::optional<uint64_t> hashMonoSource(
+        const uapmd::ProjectDocumentView& view,
+        const uapmd::ProjectAudioSourceSnapshot& source,
+        const std::atomic<bool>& stopRequested) {
+    if (source.frameCount <= 0 || source.channelCount == 0)
+        return std::nullopt;
+    MirMonoReader reader(view, source);
+    std::vector<float> block(static_cast<size_t>(std::min(kReadBlockFrames, source.frameCount)));
+    while (!reader.finished()) {
+        if (stopRequested.load(std::memory_order_acquire))
+            return std::nullopt;
+        if (!reader.read(block))
+            return std::nullopt;
+    }
+    return reader.contentHash();
+}
+
+// MirAnalysisCache
+
+MirAnalysisCache::MirAnalysisCache(std::string analyser, uint32_t version,
+                                   std::filesystem::path directory, uintmax_t sizeLimit)
+    : analyser_(std::move(analyser)), version_(version), directory_(std::move(directory)),
+      sizeLimit_(sizeLimit) {
+}
+
+std::filesystem::path MirAnalysisCache::defaultDirectory() {
+    if (const auto* overridden = std::getenv("UAPMD_MIR_CACHE_DIR"); overridden && *overridden)
+        return overridden;
+#if defined(UAPMD_HAS_CPPLOCATE)
+    if (const auto local = cpplocate::localDir("uapmd"); !local.empty())
+        return std::filesystem::path(local) / "mir-cache";
+#endif
+    std::error_code ec;
+    auto base = std::filesystem::temp_directory_path(ec);
+    if (ec)
+        base = std::filesystem::current_path(ec);
+    return base / "uapmd-mir-cache";
+}
+
+std::optional<uint64_t> MirAnalysisCache::knownContentHash(const std::string& filepath) const {
+    if (filepath.empty())
+        return std::nullopt;
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(filepath, ec);
+    if (ec)
+        return std::nullopt;
+    const auto modified = std::filesystem::last_write_time(filepath, ec);
+    if (ec)
+        return std::nullopt;
+
+    const auto memoPath = directory_ / std::format("{:016x}.mirsource", hashString(filepath));
+    const auto contents = readTextFile(memoPath);
+    if (!contents)
+        return std::nullopt;
+    std::istringstream stream(*contents);
+    std::string magic, path;
+    uint64_t storedSize{0}, contentHash{0};
+    int64_t storedModified{0};
+    if (!std::getline(stream, magic) || magic != kSourceMagic || !std::getline(stream, path)
+        || path != filepath || !(stream >> storedSize >> storedModified >> std::hex >> contentHash))
+        return std::nullopt;
+    if (storedSize != size || storedModified != modified.time_since_epoch().count())
+        return std::nullopt;
+    markUsed(memoPath);
+    return contentHash;
+}
+
+void MirAnalysisCache::rememberContentHash(const std::string& filepath, uint64_t contentHash) const {
+    if (filepath.empty())
+        return;
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(filepath, ec);
+    if (ec)
+        return;
+    const auto modified = std::filesystem::last_write_time(filepath, ec);
+    if (ec)
+        return;
+    writeAtomically(directory_ / std::format("{:016x}.mirsource", hashString(filepath)),
+                    std::format("{}\n{}\n{} {} {:x}\n", kSourceMagic, filepath, size,
+                                modified.time_since_epoch().count(), contentHash));
+}
+
+std::optional<MirFeatures> MirAnalysisCache::load(uint64_t contentHash, double sampleRate) const {
+    const auto path = entryPath(contentHash, sampleRate);
+    const auto contents = readTextFile(path);
+    if (!contents)
+        return std::nullopt;
+
+    std::istringstream stream(*contents);
+    std::string line;
+    if (!std::getline(stream, line) || line != kEntryMagic)
+        return std::nullopt;
+    MirFeatures features;
+    bool complete = false;
+    while (std::getline(stream, line)) {
+        std::istringstream fields(line);
+        std::string kind;
+        fields >> kind;
+        if (kind == "bpm") {
+            if (!(fields >> features.bpm))
+                return std::nullopt;
+        } else if (kind == "tempo") {
+            double time{}, bpm{};
+            if (!(fields >> time >> bpm))
+                return std::nullopt;
+            features.tempo_points.emplace_back(time, bpm);
+        } else if (kind == "meter") {
+            double time{};
+            unsigned numerator{}, denominator{};
+            if (!(fields >> time >> numerator >> denominator))
+                return std::nullopt;
+            features.time_signatures.emplace_back(
+                time, static_cast<uint8_t>(numerator), static_cast<uint8_t>(denominator));
+        } else if (kind == "chord") {
+            double time{};
+            std::string label;
+            if (!(fields >> time) || !std::getline(fields >> std::ws, label))
+                return std::nullopt;
+            features.chords.emplace_back(time, std::move(label));
+        } else if (kind == "end") {
+            complete = true;
+            break;
+        }
+    }
+    // An entry cut short is treated as missing rather than as "no events".
+    if (!complete)
+        return std::nullopt;
+    markUsed(path);
+    return features;
+}
+
+void MirAnalysisCache::store(uint64_t contentHash, double sampleRate, const MirFeatures& features) const {
+    std::string contents{kEntryMagic};
+    contents += std::format("\nbpm {}\n", features.bpm);
+    for (const auto& [time, bpm] : features.tempo_points)
+        contents += std::format("tempo {} {}\n", time, bpm);
+    for (const auto& [time, numerator, denominator] : features.time_signatures)
+        contents += std::format("meter {} {} {}\n", time, numerator, denominator);
+    for (const auto& [time, label] : features.chords)
+        contents += std::format("chord {} {}\n", time, label);
+    contents += "end\n";
+    writeAtomically(entryPath(contentHash, sampleRate), contents);
+}
+
+std::filesystem::path MirAnalysisCache::entryPath(uint64_t contentHash, double sampleRate) const {
+    return directory_ / std::format("{}-v{}-{:016x}-{}.mircache",
+                                    analyser_, version_, contentHash, static_cast<int64_t>(sampleRate));
+}
+
+bool MirAnalysisCache::writeAtomically(const std::filesystem::path& path, const std::string& contents) const {
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    auto temporary = path;
+    temporary += std::format(".{:x}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+        file << contents;
+        if (!file.flush()) {
+            file.close();
+            std::filesystem::remove(temporary, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) {
+        std::filesystem::remove(temporary, ec);
+        return false;
+    }
+    evictBeyondSizeLimit();
+    return true;
+}
+
+void MirAnalysisCache::evictBeyondSizeLimit() const {
+    struct CacheFile {
+        std::filesystem::path path;
+        std::filesystem::file_time_type lastUsed;
+        uintmax_t size;
+    };
+    std::vector<CacheFile> files;
+    uintmax_t total = 0;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(directory_, ec), end; !ec && it != end; it.increment(ec)) {
+        // Only what this cache writes: the directory may be shared through UAPMD_MIR_CACHE_DIR.
+        const auto extension = it->path().extension();
+        if (extension != ".mircache" && extension != ".mirsource")
+            continue;
+        std::error_code fileError;
+        const auto size = it->file_size(fileError);
+        const auto lastUsed = it->last_write_time(fileError);
+        if (fileError)
+            continue;
+        files.push_back({it->path(), lastUsed, size});
+        total += size;
+    }
+    if (total <= sizeLimit_)
+        return;
+
+    std::ranges::sort(files, {}, &CacheFile::lastUsed);
+    for (const auto& file : files) {
+        if (total <= sizeLimit_)
+            break;
+        // Another run may have evicted it already; it is gone either way.
+        std::filesystem::remove(file.path, ec);
+        total -= file.size;
+    }
+}
+
+// MirTaskPool
+
+MirTaskPool::MirTaskPool(size_t threadCount) {
+    threadCount = std::max<size_t>(threadCount, 1);
+    threads_.reserve(threadCount);
+    for (size_t index = 0; index < threadCount; ++index)
+        threads_.emplace_back([this] { run(); });
+}
+
+MirTaskPool::~MirTaskPool() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    available_.notify_all();
+    for (auto& thread : threads_)
+        thread.join();
+}
+
+size_t MirTaskPool::defaultThreadCount() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void MirTaskPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard lock(mutex_);
+        tasks_.push(std::move(task));
+    }
+    available_.notify_one();
+}
+
+void MirTaskPool::wait() {
+    std::unique_lock lock(mutex_);
+    idle_.wait(lock, [this] { return tasks_.empty() && active_ == 0; });
+}
+
+void MirTaskPool::run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mutex_);
+            available_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty())
+                return;
+            task = std::move(tasks_.front());
+            tasks_.pop();
+            ++active_;
+        }
+        try {
+            task();
+        } catch (const std::exception& error) {
+            remidy::Logger::global()->logError(std::format(
+                "MIR analysis task failed: {}", error.what()).c_str());
+        } catch (...) {
+            remidy::Logger::global()->logError("MIR analysis task failed");
+        }
+        {
+            std::lock_guard lock(mutex_);
+            --active_;
+            if (tasks_.empty() && active_ == 0)
+                idle_.notify_all();
+        }
+    }
+}
+
+// mergeWindowFeatures
+
+namespace {
+
+// Every feature event is a pair or tuple whose first element is its time.
+template <typename Event>
+bool sameValue(Event a, Event b) {
+    std::get<0>(a) = 0.0;
+    std::get<0>(b) = 0.0;
+    return a == b;
+}
+
+template <typename Event>
+void mergeEvents(std::vector<Event>& merged, const std::vector<Event>& window,
+                 double windowStart, double ownedStart, double ownedEnd) {
+    std::optional<Event> opening;
+    std::vector<Event> owned;
+    for (auto event : window) {
+        std::get<0>(event) += windowStart;
+        if (std::get<0>(event) <= ownedStart)
+            opening = std::move(event);
+        else if (std::get<0>(event) < ownedEnd)
+            owned.push_back(std::move(event));
+    }
+    if (opening) {
+        std::get<0>(*opening) = ownedStart;
+        if (merged.empty() || !sameValue(merged.back(), *opening))
+            merged.push_back(std::move(*opening));
+    }
+    std::ranges::move(owned, std::back_inserter(merged));
+}
+
+} // namespace
+
+void mergeWindowFeatures(MirFeatures& merged, const MirFeatures& window,
+                         double windowStart, double ownedStart, double ownedEnd,
+                         bool firstWindow) {
+    if (firstWindow)
+        merged.bpm = window.bpm;
+    mergeEvents(merged.tempo_points, window.tempo_points, windowStart, ownedStart, ownedEnd);
+    mergeEvents(merged.time_signatures, window.time_signatures, windowStart, ownedStart, ownedEnd);
+    mergeEvents(merged.chords, window.chords, windowStart, ownedStart, ownedEnd);
+}
+
+// analyzeSources
+
+namespace {
+
+// One source being analysed window by window. Both halves of the current
+// window read the same buffer, which is refilled once the second of them has
+// finished; only the overlap is carried over into the next window.
+struct WindowedAnalysis {
+    WindowedAnalysis(const uapmd::ProjectDocumentView& view,
+                     const uapmd::ProjectAudioSourceSnapshot& source)
+        : reader(view, source) {}
+
+    MirMonoReader reader;
+    uint64_t content_hash{0};
+    std::vector<float> window;
+    int64_t window_start{0};
+    bool first_window{true};
+    MirFeatures rhythm;
+    MirFeatures harmony;
+    MirFeatures merged;
+    std::atomic<int> remaining{0};
+};
+
+} // namespace
+
+std::vector<std::optional<MirFeatures>> analyzeSources(
+        const uapmd::ProjectDocumentView& view,
+        const std::vector<uapmd::ProjectAudioSourceSnapshot>& sources,
+        const MirAnalysisCache& cache,
+        const MirAnalysisKinds& kinds,
+        const std::atomic<bool>& stopRequested,
+        std::atomic<int>& processedSources,
+        const MirAnalysisWindowing& windowing) {
+    std::vector<std::optional<MirFeatures>> results(sources.size());
+    MirTaskPool pool;
+
+    const auto stopped = [&stopRequested] {
+        return stopRequested.load(std::memory_order_acquire);
+    };
+    const auto finish = [&](size_t index, std::optional<MirFeatures> features) {
+        results[index] = std::move(features);
+        processedSources.fetch_add(1, std::memory_order_acq_rel);
+    };
+
+    std::function<void(size_t, std::shared_ptr<WindowedAnalysis>)> analyseNextWindow;
+    analyseNextWindow = [&](size_t index, std::shared_ptr<WindowedAnalysis> state) {
+        const auto& source = sources[index];
+        if (stopped())
+            return;
+        const auto windowFrames = std::max<int64_t>(
+            1, std::llround(windowing.windowSeconds * source.sampleRate));
+        const auto overlapFrames = std::clamp<int64_t>(
+            std::llround(windowing.overlapSeconds * source.sampleRate), 0, windowFrames / 2);
+        const auto hopFrames = windowFrames - overlapFrames;
+
+        if (!state->first_window) {
+            state->window_start += static_cast<int64_t>(state->window.size()) - overlapFrames;
+            state->window.erase(state->window.begin(), state->window.end() - overlapFrames);
+        }
+        // A remainder shorter than half a hop joins this window rather than
+        // being analysed on its own with too little context.
+        auto windowLength = windowFrames;
+        if (source.frameCount - (state->window_start + windowFrames) < hopFrames / 2)
+            windowLength = source.frameCount - state->window_start;
+        const auto carried = state->window.size();
+        state->window.resize(static_cast<size_t>(windowLength));
+        if (!state->reader.read(std::span(state->window).subspan(carried)))
+            return finish(index, std::nullopt);
+
+        const auto lastWindow = state->window_start + windowLength >= source.frameCount;
+        const auto sampleRate = static_cast<int>(source.sampleRate);
+        const auto complete = [&, index, state, lastWindow, overlapFrames, hopFrames] {
+            const auto& source = sources[index];
+            if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+            if (stopped())
+                return;
+            auto features = std::move(state->rhythm);
+            features.chords = std::move(state->harmony.chords);
+            const auto seconds = [&source](int64_t frame) {
+                return static_cast<double>(frame) / source.sampleRate;
+            };
+            const auto ownedStart = state->first_window
+                ? -std::numeric_limits<double>::infinity()
+                : seconds(state->window_start + overlapFrames / 2);
+            const auto ownedEnd = lastWindow
+                ? std::numeric_limits<double>::infinity()
+                : seconds(state->window_start + hopFrames + overlapFrames / 2);
+            mergeWindowFeatures(state->merged, features, seconds(state->window_start),
+                                ownedStart, ownedEnd, state->first_window);
+            state->first_window = false;
+            if (!lastWindow)
+                return analyseNextWindow(index, state);
+
+            state->window = {};
+            cache.store(state->content_hash, source.sampleRate, state->merged);
+            finish(index, std::move(state->merged));
+        };
+        state->rhythm = {};
+        state->harmony = {};
+        state->remaining.store(2, std::memory_order_release);
+        pool.submit([&, state, sampleRate, complete] {
+            if (!stopped())
+                kinds.rhythm(state->window, sampleRate, state->rhythm);
+            complete();
+        });
+        pool.submit([&, state, sampleRate, complete] {
+            if (!stopped())
+                kinds.harmony(state->window, sampleRate, state->harmony);
+            complete();
+        });
+    };
+
+    for (size_t index = 0; index < sources.size(); ++index) {
+        pool.submit([&, index] {
+            const auto& source = sources[index];
+            if (stopped())
+                return;
+            auto hash = cache.knownContentHash(source.filepath);
+            if (hash)
+                if (auto cached = cache.load(*hash, source.sampleRate))
+                    return finish(index, std::move(cached));
+
+            // Content already analysed under another path or an older
+            // modification time is found by its hash, which costs one read
+            // of the source but none of the analysis.
+            if (!hash) {
+                hash = hashMonoSource(view, source, stopRequested);
+                if (!hash)
+                    return finish(index, std::nullopt);
+                cache.rememberContentHash(source.filepath, *hash);
+                if (auto cached = cache.load(*hash, source.sampleRate))
+                    return finish(index, std::move(cached));
+            }
+            if (source.sampleRate <= 0)
+                return finish(index, std::nullopt);
+
+            auto state = std::make_shared<WindowedAnalysis>(view, source);
+            state->content_hash = *hash;
+            analyseNextWindow(index, std::move(state));
+        });
+    }
+    pool.wait();
+    return results;
+}
+
+} // namespace uapmd_mir
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <span>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <uapmd-engine/uapmd-engine.hpp>
+
+namespace uapmd_mir {
+
+// What one analyser derives from one audio source. Times are seconds from the
+// start of the source, so the result does not depend on where its clip sits on
+// the timeline and can be cached by source content alone.
+struct MirFeatures {
+    double bpm{120.0};
+    std::vector<std::pair<double, double>> tempo_points;
+    std::vector<std::tuple<double, uint8_t, uint8_t>> time_signatures;
+    std::vector<std::pair<double, std::string>> chords;
+};
+
+// Reads a source front to back, downmixing each block to mono and hashing it
+// as it arrives. Nothing is buffered besides one block per channel; callers
+// choose how much of the mono signal they hold at a time.
+class MirMonoReader {
+public:
+    MirMonoReader(const uapmd::ProjectDocumentView& view,
+                  const uapmd::ProjectAudioSourceSnapshot& source);
+    ~MirMonoReader();
+    MirMonoReader(const MirMonoReader&) = delete;
+    MirMonoReader& operator=(const MirMonoReader&) = delete;
+
+    int64_t position() const { return position_; }
+    int64_t frameCount() const { return source_.frameCount; }
+    bool finished() const { return position_ >= source_.frameCount; }
+
+    // Fills destination with the next frames; past the end of the source it
+    // is left short. Returns false when the source cannot be read.
+    bool read(std::span<float> destination);
+
+    // The hash of every frame read so far.
+    uint64_t contentHash() const { return hash_; }
+
+private:
+    const uapmd::ProjectDocumentView& view_;
+    uapmd::ProjectAudioSourceSnapshot source_;
+    std::unique_ptr<uapmd::AudioFileReader> reader_;
+    int64_t readerFrames_{0};
+    uint32_t readerChannels_{0};
+    std::vector<std::vector<float>> block_;
+    std::vector<float*> destinations_;
+    int64_t position_{0};
+    uint64_t hash_;
+};
+
+// Hashes a whole source without keeping any of it, for looking the source up
+// in the cache before analysing it.
+std::optional<uint64_t> hashMonoSource(
+    const uapmd::ProjectDocumentView& view,
+    const uapmd::ProjectAudioSourceSnapshot& source,
+    const std::atomic<bool>& stopRequested);
+
+// Analysis results kept on disk across runs and sessions, keyed by the hash
+// of the analysed audio and the analyser's name and version. Bump the version
+// whenever the analyser's output for the same audio can change.
+//
+// Hashing still means reading the audio, so the cache also remembers the hash
+// of each file by path, size and modification time; an unchanged file is
+// answered without being read at all.
+//
+// The directory is kept under sizeLimit bytes: every store drops the least
+// recently used files until the rest fit. A hit counts as a use.
+//
+// Entries are written to a temporary file and renamed into place, so
+// concurrent runs never see a partial entry. All members are const and safe
+// to call from several threads.
+class MirAnalysisCache {
+public:
+    static constexpr uintmax_t kDefaultSizeLimit = 64 * 1024 * 1024;
+
+    MirAnalysisCache(std::string analyser, uint32_t version,
+                     std::filesystem::path directory = defaultDirectory(),
+                     uintmax_t sizeLimit = kDefaultSizeLimit);
+
+    // UAPMD_MIR_CACHE_DIR when set, otherwise "mir-cache" in the application's
+    // local data directory, or in the temporary directory where there is none.
+    static std::filesystem::path defaultDirectory();
+
+    const std::filesystem::path& directory() const { return directory_; }
+
+    std::optional<uint64_t> knownContentHash(const std::string& filepath) const;
+    void rememberContentHash(const std::string& filepath, uint64_t contentHash) const;
+
+    std::optional<MirFeatures> load(uint64_t contentHash, double sampleRate) const;
+    void store(uint64_t contentHash, double sampleRate, const MirFeatures& features) const;
+
+private:
+    std::filesystem::path entryPath(uint64_t contentHash, double sampleRate) const;
+    bool writeAtomically(const std::filesystem::path& path, const std::string& contents) const;
+    void evictBeyondSizeLimit() const;
+
+    std::string analyser_;
+    uint32_t version_;
+    std::filesystem::path directory_;
+    uintmax_t sizeLimit_;
+};
+
+// A fixed set of threads draining one task queue. Tasks may submit further
+// tasks; wait() returns once the queue is empty and no task is running.
+class MirTaskPool {
+public:
+    explicit MirTaskPool(size_t threadCount = defaultThreadCount());
+    ~MirTaskPool();
+    MirTaskPool(const MirTaskPool&) = delete;
+    MirTaskPool& operator=(const MirTaskPool&) = delete;
+
+    static size_t defaultThreadCount();
+
+    void submit(std::function<void()> task);
+    void wait();
+
+private:
+    void run();
+
+    std::mutex mutex_;
+    std::condition_variable available_;
+    std::condition_variable idle_;
+    std::queue<std::function<void()>> tasks_;
+    size_t active_{0};
+    bool stopping_{false};
+    std::vector<std::thread> threads_;
+};
+
+// The two independent halves of an analyser. Meter detection consumes the
+// tempo map, so tempo and meter stay one task; chords only need the samples
+// and run alongside them.
+struct MirAnalysisKinds {
+    std::function<void(std::span<const float> samples, int sampleRate, MirFeatures& features)> rhythm;
+    std::function<void(std::span<const float> samples, int sampleRate, MirFeatures& features)> harmony;
+};
+
+// How much of a source the analysers see at once. Long sources are analysed
+// in windows of windowSeconds that overlap by overlapSeconds, so memory stays
+// bounded by the window rather than by the file. Each window contributes the
+// events of its middle part; the overlap gives onset and beat tracking
+// context on both sides of every seam. Sources no longer than one window are
+// analysed whole.
+struct MirAnalysisWindowing {
+    double windowSeconds{120.0};
+    double overlapSeconds{15.0};
+};
+
+// Adds one window's features, in seconds from windowStart, to the features
+// merged so far. Only events in [ownedStart, ownedEnd) are kept, and the value
+// in effect at ownedStart opens the range unless it merely continues the last
+// merged one. The first window also decides the overall bpm.
+void mergeWindowFeatures(MirFeatures& merged, const MirFeatures& window,
+                         double windowStart, double ownedStart, double ownedEnd,
+                         bool firstWindow);
+
+// Analyses every source on a task pool, answering from the cache where it
+// can. Returns one entry per source, empty for sources that could not be read
+// or when stopRequested was raised. processedSources counts finished sources.
+std::vector<std::optional<MirFeatures>> analyzeSources(
+    const uapmd::ProjectDocumentView& view,
+    const std::vector<uapmd::ProjectAudioSourceSnapshot>& sources,
+    const MirAnalysisCache& cache,
+    const MirAnalysisKinds& kinds,
+    const std::atomic<bool>& stopRequested,
+    std::atomic<int>& processedSources,
+    const MirAnalysisWindowing& windowing = {});
+
+} // namespace uapmd_mir
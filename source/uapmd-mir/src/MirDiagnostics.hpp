@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <mutex>
 #include <string_view>
 #include <thread>
 #include <vector>
@@ -24,6 +25,7 @@ enum class MirDiagnosticKind {
 // Buffers every raw analyzer value produced during one run and emits them
 // grouped by kind once the run is over. Logging them as they are produced
 // swamps the logger; the analysis is off the audio thread but still hot.
+// append() may be called from several analysis workers at once.
 class MirDiagnosticLog {
 public:
     MirDiagnosticLog() {
@@ -32,6 +34,7 @@ public:
     }
 
     void append(std::string_view message) {
+        std::lock_guard lock(mutex_);
         const auto required = bytes_.size() + message.size() + 1;
         if (required > bytes_.capacity())
             bytes_.reserve(std::max(required, bytes_.capacity() * 2));
@@ -42,6 +45,7 @@ public:
     }
 
     void flush() {
+        std::lock_guard lock(mutex_);
         std::this_thread::sleep_for(std::chrono::milliseconds(25));
         size_t emitted = 0;
         for (int kind = 0; kind < static_cast<int>(MirDiagnosticKind::Count); ++kind)
@@ -78,6 +82,7 @@ private:
         return MirDiagnosticKind::Other;
     }
 
+    std::mutex mutex_;
     std::vector<char> bytes_;
     std::vector<Record> records_;
 };
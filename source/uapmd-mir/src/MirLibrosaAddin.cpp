@@ -8,6 +8,7 @@
 #include <limits>
 #include <memory>
 #include <ranges>
+#include <span>
 #include <string>
 #include <thread>
 #include <tuple>
@@ -17,6 +18,7 @@
 #include <uapmd-addin-core/uapmd-addin-core.hpp>
 #include <uapmd-engine/uapmd-engine.hpp>
 
+#include "MirAnalysisPipeline.hpp"
 #include "MirDiagnostics.hpp"
 #include "MirLibrosaAnalysis.hpp"
 
@@ -28,6 +30,8 @@ constexpr std::string_view kCommandExtensionPoint{"/uapmd/app/command/v1"};
 constexpr uint32_t kDefaultTickResolution = 480;
 constexpr uint8_t kTempoGroup = 0;
 constexpr uint8_t kTempoChannel = 0;
+// Keys cached results; bump whenever the analysis below can change its output.
+constexpr uint32_t kAnalyserVersion = 2;
 
 struct AnalysisResult {
     uapmd::TimelinePosition position;
@@ -245,13 +249,9 @@ private:
                         clip && clip->clipType == uapmd::ClipType::Midi)
                         midiClips.push_back(*clip);
 
-            const auto sourceIds = view.audioSourceIds();
-            totalSources_.store(static_cast<int>(sourceIds.size()), std::memory_order_release);
-            std::vector<AnalysisResult> results;
-            for (const auto sourceId : sourceIds) {
-                if (stopRequested_.load(std::memory_order_acquire))
-                    return;
-                processedSources_.fetch_add(1, std::memory_order_acq_rel);
+            std::vector<uapmd::ProjectAudioSourceSnapshot> sources;
+            std::vector<uapmd::ProjectClipSnapshot> sourceClips;
+            for (const auto sourceId : view.audioSourceIds()) {
                 const auto source = view.getAudioSource(sourceId);
                 if (!source || source->frameCount <= 0 || source->channelCount == 0
                     || source->sampleRate <= 0)
@@ -261,50 +261,54 @@ private:
                         return intervalsOverlap(*sourceClip, midiClip);
                     }))
                     continue;
+                sources.push_back(*source);
+                sourceClips.push_back(*sourceClip);
+            }
+            totalSources_.store(static_cast<int>(sources.size()), std::memory_order_release);
 
-                const auto frameCount = static_cast<size_t>(source->frameCount);
-                std::vector<std::vector<float>> channels(
-                    source->channelCount, std::vector<float>(frameCount));
-                std::vector<float*> destinations;
-                destinations.reserve(channels.size());
-                for (auto& channel : channels)
-                    destinations.push_back(channel.data());
-                if (!view.readAudioSourceSamples(sourceId, 0, source->frameCount,
-                                                 destinations.data(), source->channelCount))
-                    continue;
-
-                std::vector<float> mono(frameCount, 0.0f);
-                for (size_t frame = 0; frame < frameCount; ++frame) {
-                    for (const auto& channel : channels)
-                        mono[frame] += channel[frame];
-                    mono[frame] /= static_cast<float>(channels.size());
-                }
-
+            uapmd_mir::MirAnalysisKinds kinds;
+            kinds.rhythm = [&rawLog](std::span<const float> mono, int sampleRate,
+                                     uapmd_mir::MirFeatures& features) {
                 rawLog(std::format(
-                    "librosa.cpp raw source frames={} sample_rate={:.6f} duration={:.6f}s",
-                    frameCount, source->sampleRate, frameCount / source->sampleRate));
+                    "librosa.cpp raw window frames={} sample_rate={} duration={:.6f}s",
+                    mono.size(), sampleRate, static_cast<double>(mono.size()) / sampleRate));
+                features.bpm = 120.0;
+                features.tempo_points = uapmd_mir::librosa_cpp::detectTempoMap(
+                    mono, sampleRate, features.bpm, rawLog);
+                if (!features.tempo_points.empty())
+                    features.bpm = features.tempo_points.front().second;
+                features.time_signatures = uapmd_mir::librosa_cpp::detectRhythmMap(
+                    mono, sampleRate, features.tempo_points, features.bpm, rawLog);
+            };
+            kinds.harmony = [&rawLog](std::span<const float> mono, int sampleRate,
+                                      uapmd_mir::MirFeatures& features) {
+                features.chords = uapmd_mir::librosa_cpp::detectChords(mono, sampleRate, rawLog);
+            };
+
+            const uapmd_mir::MirAnalysisCache cache{"librosa", kAnalyserVersion};
+            auto features = uapmd_mir::analyzeSources(
+                view, sources, cache, kinds, stopRequested_, processedSources_);
+            if (stopRequested_.load(std::memory_order_acquire))
+                return;
 
+            std::vector<AnalysisResult> results;
+            for (size_t index = 0; index < sources.size(); ++index) {
+                if (!features[index])
+                    continue;
+                auto& analysed = *features[index];
                 AnalysisResult result;
-                result.position = sourceClip->position;
+                result.position = sourceClips[index].position;
                 result.tick_resolution = tickResolution;
-                result.duration_samples = sourceClip->durationSamples;
-                result.sample_rate = source->sampleRate;
-                result.bpm = 120.0;
-                result.tempo_points = uapmd_mir::librosa_cpp::detectTempoMap(
-                    mono, static_cast<int>(source->sampleRate), result.bpm, rawLog);
-                if (!result.tempo_points.empty())
-                    result.bpm = result.tempo_points.front().second;
-
-                result.time_signatures = uapmd_mir::librosa_cpp::detectRhythmMap(
-                    mono, static_cast<int>(source->sampleRate),
-                    result.tempo_points, result.bpm, rawLog);
+                result.duration_samples = sourceClips[index].durationSamples;
+                result.sample_rate = sources[index].sampleRate;
+                result.bpm = analysed.bpm;
+                result.tempo_points = std::move(analysed.tempo_points);
+                result.time_signatures = std::move(analysed.time_signatures);
                 if (!result.time_signatures.empty()) {
                     result.time_signature_numerator = std::get<1>(result.time_signatures.front());
                     result.time_signature_denominator = std::get<2>(result.time_signatures.front());
                 }
-
-                result.chords = uapmd_mir::librosa_cpp::detectChords(
-                    mono, static_cast<int>(source->sampleRate), rawLog);
+                result.chords = std::move(analysed.chords);
                 results.push_back(std::move(result));
             }
 
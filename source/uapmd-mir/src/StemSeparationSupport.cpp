@@ -1,7 +1,15 @@
 #include "StemSeparationSupport.hpp"
 
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <exception>
 #include <format>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
 
 #include <choc/audio/choc_AudioFileFormat_WAV.h>
 #include <choc/audio/choc_SampleBuffers.h>
@@ -14,6 +22,7 @@ namespace {
 
 constexpr uint32_t kStereoChannels = 2;
 constexpr size_t kWriteBlockFrames = 8192;
+constexpr auto kCancelPollInterval = std::chrono::milliseconds(100);
 
 std::pair<std::vector<float>, std::vector<float>> downmixToStereo(
     const std::vector<std::vector<float>>& channels)
@@ -65,104 +74,425 @@ std::pair<std::vector<float>, std::vector<float>> downmixToStereo(
     return {left, right};
 }
 
-std::vector<float> resampleChannel(const std::vector<float>& input,
-                                   uint32_t sourceRate,
-                                   uint32_t targetRate)
-{
-    if (input.empty() || sourceRate == targetRate)
-        return input;
+} // namespace
 
-    const double ratio = static_cast<double>(targetRate) / static_cast<double>(sourceRate);
-    size_t targetFrames = static_cast<size_t>(std::llround(input.size() * ratio));
-    targetFrames = std::max<size_t>(1, targetFrames);
+// StereoAudioReader
 
-    std::vector<float> output(targetFrames, 0.0f);
-    const double step = static_cast<double>(sourceRate) / static_cast<double>(targetRate);
+struct StereoAudioReader::Impl {
+    std::unique_ptr<uapmd::AudioFileReader> reader;
+    uapmd::AudioFileReader::Properties properties{};
+    uint32_t targetSampleRate{0};
+    size_t frameCount{0};
+    std::mutex mutex;
+};
 
-    for (size_t i = 0; i < targetFrames; ++i) {
-        const double sourcePos = i * step;
-        const size_t index = static_cast<size_t>(sourcePos);
-        const double frac = sourcePos - static_cast<double>(index);
-        if (index >= input.size() - 1) {
-            output[i] = input.back();
-        } else {
-            const float sample0 = input[index];
-            const float sample1 = input[index + 1];
-            output[i] = sample0 + static_cast<float>(frac) * (sample1 - sample0);
-        }
-    }
-    return output;
-}
+StereoAudioReader::StereoAudioReader() : impl_(std::make_unique<Impl>()) {}
+StereoAudioReader::~StereoAudioReader() = default;
 
-} // namespace
-
-bool loadStereoAudio(const std::string& filepath,
-                     uint32_t targetSampleRate,
-                     StereoAudio& audio,
-                     std::string& error)
+bool StereoAudioReader::open(const std::string& filepath,
+                             uint32_t targetSampleRate,
+                             std::string& error)
 {
-    auto reader = uapmd::createAudioFileReaderFromPath(filepath);
-    if (!reader) {
+    impl_->reader = uapmd::createAudioFileReaderFromPath(filepath);
+    if (!impl_->reader) {
         error = "Unsupported audio format";
         return false;
     }
 
-    const auto props = reader->getProperties();
-    if (props.numChannels == 0 || props.numFrames == 0) {
+    impl_->properties = impl_->reader->getProperties();
+    const auto& props = impl_->properties;
+    if (props.numChannels == 0 || props.numFrames == 0 || props.sampleRate == 0) {
         error = "Audio file has no data";
+        impl_->reader.reset();
         return false;
     }
 
-    std::vector<std::vector<float>> channelData(props.numChannels, std::vector<float>(props.numFrames, 0.0f));
+    impl_->targetSampleRate = targetSampleRate;
+    if (props.sampleRate == targetSampleRate) {
+        impl_->frameCount = static_cast<size_t>(props.numFrames);
+    } else {
+        const double ratio = static_cast<double>(targetSampleRate) / static_cast<double>(props.sampleRate);
+        impl_->frameCount = std::max<size_t>(
+            1, static_cast<size_t>(std::llround(static_cast<double>(props.numFrames) * ratio)));
+    }
+    return true;
+}
+
+size_t StereoAudioReader::frameCount() const {
+    return impl_->reader ? impl_->frameCount : 0;
+}
+
+void StereoAudioReader::read(size_t startFrame, size_t frameCount, StereoAudio& audio)
+{
+    audio.left.clear();
+    audio.right.clear();
+    if (!impl_->reader || startFrame >= impl_->frameCount)
+        return;
+    frameCount = std::min(frameCount, impl_->frameCount - startFrame);
+    if (frameCount == 0)
+        return;
+
+    const auto& props = impl_->properties;
+    const auto sourceFrames = static_cast<size_t>(props.numFrames);
+    const bool resampling = props.sampleRate != impl_->targetSampleRate;
+    // Linear interpolation also reads the source frame after each position.
+    const double step = static_cast<double>(props.sampleRate) / static_cast<double>(impl_->targetSampleRate);
+    const size_t firstSource = resampling
+        ? std::min(static_cast<size_t>(static_cast<double>(startFrame) * step), sourceFrames - 1)
+        : startFrame;
+    const size_t lastSource = resampling
+        ? std::min(static_cast<size_t>(static_cast<double>(startFrame + frameCount - 1) * step) + 1,
+                   sourceFrames - 1)
+        : startFrame + frameCount - 1;
+    const size_t sourceCount = lastSource - firstSource + 1;
+
+    std::vector<std::vector<float>> channelData(props.numChannels, std::vector<float>(sourceCount, 0.0f));
     std::vector<float*> destPtrs;
     destPtrs.reserve(props.numChannels);
     for (auto& channel : channelData)
         destPtrs.push_back(channel.data());
-    reader->readFrames(0, props.numFrames, destPtrs.data(), props.numChannels);
+    {
+        // AudioFileReader keeps decoder state, so reads must not interleave.
+        std::lock_guard lock(impl_->mutex);
+        impl_->reader->readFrames(firstSource, sourceCount, destPtrs.data(), props.numChannels);
+    }
 
     auto [left, right] = downmixToStereo(channelData);
-    audio.left = resampleChannel(left, props.sampleRate, targetSampleRate);
-    audio.right = resampleChannel(right, props.sampleRate, targetSampleRate);
-    if (audio.frameCount() == 0) {
-        error = "Failed to prepare input audio";
-        return false;
+    if (!resampling) {
+        audio.left = std::move(left);
+        audio.right = std::move(right);
+        return;
     }
-    return true;
+
+    audio.left.resize(frameCount);
+    audio.right.resize(frameCount);
+    for (size_t i = 0; i < frameCount; ++i) {
+        const double sourcePos = static_cast<double>(startFrame + i) * step;
+        const size_t index = static_cast<size_t>(sourcePos);
+        if (index >= sourceFrames - 1) {
+            audio.left[i] = left.back();
+            audio.right[i] = right.back();
+            continue;
+        }
+        const auto local = index - firstSource;
+        const auto frac = static_cast<float>(sourcePos - static_cast<double>(index));
+        audio.left[i] = left[local] + frac * (left[local + 1] - left[local]);
+        audio.right[i] = right[local] + frac * (right[local + 1] - right[local]);
+    }
+}
+
+// StereoWavStreamWriter
+
+struct StereoWavStreamWriter::Impl {
+    std::unique_ptr<choc::audio::AudioFileWriter> writer;
+    choc::buffer::ChannelArrayBuffer<float> buffer{kStereoChannels, static_cast<uint32_t>(kWriteBlockFrames)};
+};
+
+StereoWavStreamWriter::StereoWavStreamWriter() : impl_(std::make_unique<Impl>()) {}
+
+StereoWavStreamWriter::~StereoWavStreamWriter() {
+    close();
 }
 
-bool writeStereoWav(const std::filesystem::path& path,
-                    const float* left,
-                    const float* right,
-                    size_t frameCount,
-                    uint32_t sampleRate)
+bool StereoWavStreamWriter::open(const std::filesystem::path& path,
+                                 uint32_t sampleRate,
+                                 size_t expectedFrameCount)
 {
     choc::audio::AudioFileProperties props;
     props.sampleRate = sampleRate;
     props.numChannels = kStereoChannels;
-    props.numFrames = static_cast<uint64_t>(frameCount);
+    props.numFrames = static_cast<uint64_t>(expectedFrameCount);
     props.formatName = "wav";
-    auto writer = choc::audio::WAVAudioFileFormat<true>().createWriter(path.string(), props);
-    if (!writer)
-        return false;
+    impl_->writer = choc::audio::WAVAudioFileFormat<true>().createWriter(path.string(), props);
+    return impl_->writer != nullptr;
+}
 
+bool StereoWavStreamWriter::append(const float* left, const float* right, size_t frameCount)
+{
+    if (!impl_->writer)
+        return false;
     const float* sources[kStereoChannels]{left, right};
-    choc::buffer::ChannelArrayBuffer<float> buffer(kStereoChannels, kWriteBlockFrames);
-    uint64_t written = 0;
-    const uint64_t totalFrames = static_cast<uint64_t>(frameCount);
-
-    while (written < totalFrames) {
-        const uint64_t framesRemaining = totalFrames - written;
-        const uint32_t blockFrames = static_cast<uint32_t>(std::min<uint64_t>(framesRemaining, kWriteBlockFrames));
+    size_t written = 0;
+    while (written < frameCount) {
+        const auto blockFrames = static_cast<uint32_t>(std::min(frameCount - written, kWriteBlockFrames));
         for (uint32_t ch = 0; ch < kStereoChannels; ++ch)
             for (uint32_t i = 0; i < blockFrames; ++i)
-                buffer.getSample(ch, i) = sources[ch][written + i];
-        auto view = buffer.getView().getStart(blockFrames);
-        if (!writer->appendFrames(view))
+                impl_->buffer.getSample(ch, i) = sources[ch][written + i];
+        auto view = impl_->buffer.getView().getStart(blockFrames);
+        if (!impl_->writer->appendFrames(view))
             return false;
         written += blockFrames;
     }
+    return true;
+}
+
+bool StereoWavStreamWriter::close()
+{
+    if (!impl_->writer)
+        return true;
+    const bool flushed = impl_->writer->flush();
+    impl_->writer.reset();
+    return flushed;
+}
+
+// StemFileSet
+
+StemFileSet::StemFileSet(std::filesystem::path directory,
+                         std::string baseName,
+                         uint32_t sampleRate,
+                         size_t expectedFrameCount,
+                         LabelsForCount labelsForCount)
+    : directory_(std::move(directory)),
+      base_name_(std::move(baseName)),
+      sample_rate_(sampleRate),
+      expected_frame_count_(expectedFrameCount),
+      labels_for_count_(std::move(labelsForCount))
+{
+}
+
+StemFileSet::~StemFileSet() {
+    if (!committed_)
+        discard();
+}
 
-    return writer->flush();
+bool StemFileSet::openAll(size_t stemCount)
+{
+    opened_ = true;
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    if (ec) {
+        error_ = std::format("Failed to create output directory: {}", ec.message());
+        return false;
+    }
+
+    const auto labels = labels_for_count_(stemCount);
+    const auto count = std::min(labels.size(), stemCount);
+    stems_.resize(count);
+    for (size_t index = 0; index < count; ++index) {
+        auto& stem = stems_[index];
+        stem.label = labels[index];
+        stem.path = directory_ / std::format("{}_{}.wav", base_name_, stem.label);
+        stem.writer = std::make_unique<StereoWavStreamWriter>();
+        if (!stem.writer->open(stem.path, sample_rate_, expected_frame_count_)) {
+            error_ = std::format("Failed to write stem {}", stem.label);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool StemFileSet::append(size_t stem, size_t stemCount,
+                         const float* left, const float* right, size_t frameCount)
+{
+    if (!opened_ && !openAll(stemCount))
+        return false;
+    if (!error_.empty())
+        return false;
+    if (stem >= stems_.size())
+        return true;
+    if (!stems_[stem].writer->append(left, right, frameCount)) {
+        error_ = std::format("Failed to write stem {}", stems_[stem].label);
+        return false;
+    }
+    return true;
+}
+
+bool StemFileSet::commit(std::vector<std::pair<std::string, std::filesystem::path>>& stems)
+{
+    if (!error_.empty())
+        return false;
+    for (auto& stem : stems_) {
+        if (!stem.writer->close()) {
+            error_ = std::format("Failed to write stem {}", stem.label);
+            return false;
+        }
+    }
+    stems.clear();
+    for (const auto& stem : stems_)
+        stems.emplace_back(stem.label, stem.path);
+    committed_ = true;
+    return true;
+}
+
+void StemFileSet::discard()
+{
+    for (auto& stem : stems_) {
+        if (stem.writer)
+            stem.writer->close();
+        std::error_code ec;
+        std::filesystem::remove(stem.path, ec);
+    }
+    stems_.clear();
+}
+
+// Windowed separation
+
+size_t windowCountFor(size_t frameCount, const WindowedSeparationOptions& options)
+{
+    if (frameCount == 0)
+        return 0;
+    const auto window = std::max<size_t>(options.windowFrames, 1);
+    if (frameCount <= window)
+        return 1;
+    const auto hop = window - std::min(options.overlapFrames, window / 2);
+    return 1 + (frameCount - window + hop - 1) / hop;
+}
+
+WindowedSeparationOutcome separateInWindows(StereoAudioReader& input,
+                                            const WindowedSeparationOptions& options,
+                                            const WindowSeparator& separate,
+                                            const StemBlockSink& sink,
+                                            const WindowProgress& progress,
+                                            const std::function<bool()>& shouldCancel)
+{
+    const auto totalFrames = input.frameCount();
+    const auto windowCount = windowCountFor(totalFrames, options);
+    if (windowCount == 0)
+        return WindowedSeparationOutcome::Completed;
+
+    const auto window = std::max<size_t>(options.windowFrames, 1);
+    const auto overlap = windowCount > 1 ? std::min(options.overlapFrames, window / 2) : 0;
+    const auto hop = window - overlap;
+    const auto workerCount = std::clamp<size_t>(options.workerCount, 1, windowCount);
+    // Finished windows wait here until every earlier one is delivered; this
+    // caps how many can pile up behind a slow one.
+    const auto maxWindowsAhead = workerCount * 2;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::map<size_t, std::vector<StereoAudio>> finished;
+    size_t nextWindow = 0;
+    size_t delivered = 0;
+    bool stopping = false;
+    std::exception_ptr failure;
+
+    auto work = [&] {
+        StereoAudio windowInput;
+        while (true) {
+            size_t index;
+            {
+                std::unique_lock lock(mutex);
+                changed.wait(lock, [&] {
+                    return stopping || nextWindow >= windowCount || nextWindow < delivered + maxWindowsAhead;
+                });
+                if (stopping || nextWindow >= windowCount)
+                    return;
+                index = nextWindow++;
+            }
+            try {
+                const auto start = index * hop;
+                const auto length = std::min(window, totalFrames - start);
+                input.read(start, length, windowInput);
+                windowInput.left.resize(length);
+                windowInput.right.resize(length);
+                auto stems = separate(windowInput);
+                for (auto& stem : stems) {
+                    stem.left.resize(length);
+                    stem.right.resize(length);
+                }
+                std::lock_guard lock(mutex);
+                finished.emplace(index, std::move(stems));
+            } catch (...) {
+                std::lock_guard lock(mutex);
+                if (!failure)
+                    failure = std::current_exception();
+                stopping = true;
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount);
+    for (size_t index = 0; index < workerCount; ++index)
+        workers.emplace_back(work);
+
+    auto stopWorkers = [&] {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        changed.notify_all();
+        for (auto& worker : workers)
+            if (worker.joinable())
+                worker.join();
+    };
+    // The sink and progress callbacks may throw (a backend's cancellation
+    // does); the workers must be joined on that path too.
+    struct StopOnExit {
+        decltype(stopWorkers)& stop;
+        ~StopOnExit() { stop(); }
+    } stopOnExit{stopWorkers};
+
+    auto finish = [&](WindowedSeparationOutcome outcome) {
+        stopWorkers();
+        if (failure)
+            std::rethrow_exception(failure);
+        return outcome;
+    };
+
+    // Each stem's faded-out tail of the previous window, waiting for the
+    // faded-in head of the next one.
+    std::vector<StereoAudio> tails;
+    for (size_t index = 0; index < windowCount; ++index) {
+        std::optional<std::vector<StereoAudio>> stems;
+        while (!stems) {
+            bool failed = false;
+            {
+                std::unique_lock lock(mutex);
+                changed.wait_for(lock, kCancelPollInterval, [&] {
+                    return failure || finished.contains(index);
+                });
+                failed = failure != nullptr;
+                if (auto found = finished.find(index); !failed && found != finished.end()) {
+                    stems = std::move(found->second);
+                    finished.erase(found);
+                    delivered = index + 1;
+                }
+            }
+            if (failed)
+                return finish(WindowedSeparationOutcome::Canceled);
+            changed.notify_all();
+            if (shouldCancel && shouldCancel())
+                return finish(WindowedSeparationOutcome::Canceled);
+        }
+
+        if (index == 0)
+            tails.resize(stems->size());
+        else if (stems->size() != tails.size())
+            throw std::runtime_error("Separator changed its stem count between windows");
+
+        const bool first = index == 0;
+        const bool last = index + 1 == windowCount;
+        for (size_t stemIndex = 0; stemIndex < stems->size(); ++stemIndex) {
+            auto& stem = (*stems)[stemIndex];
+            auto& tail = tails[stemIndex];
+            const auto length = stem.frameCount();
+            if (!first) {
+                for (size_t i = 0; i < overlap && i < length; ++i) {
+                    const auto gain = (static_cast<float>(i) + 0.5f) / static_cast<float>(overlap);
+                    stem.left[i] = stem.left[i] * gain + tail.left[i];
+                    stem.right[i] = stem.right[i] * gain + tail.right[i];
+                }
+            }
+            const auto emitted = last ? length : length - overlap;
+            if (!last) {
+                for (size_t i = emitted; i < length; ++i) {
+                    const auto gain = (static_cast<float>(length - i) - 0.5f) / static_cast<float>(overlap);
+                    stem.left[i] *= gain;
+                    stem.right[i] *= gain;
+                }
+                tail.left.assign(stem.left.begin() + static_cast<std::ptrdiff_t>(emitted), stem.left.end());
+                tail.right.assign(stem.right.begin() + static_cast<std::ptrdiff_t>(emitted), stem.right.end());
+            }
+            if (!sink(stemIndex, stems->size(), stem.left.data(), stem.right.data(), emitted))
+                return finish(WindowedSeparationOutcome::SinkFailed);
+        }
+
+        if (progress)
+            progress(index + 1, windowCount);
+    }
+    return finish(WindowedSeparationOutcome::Completed);
 }
 
 } // namespace uapmd_stems
@@ -3,7 +3,10 @@
 #include <algorithm>
 #include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace uapmd_stems {
@@ -18,19 +21,137 @@ struct StereoAudio {
     size_t frameCount() const { return std::min(left.size(), right.size()); }
 };
 
-// Reads any format uapmd-data can open, downmixes to stereo (odd channels feed
-// the left, even ones the right) and resamples to `targetSampleRate`.
-// Returns false and fills `error` when the file cannot be used.
-bool loadStereoAudio(const std::string& filepath,
-                     uint32_t targetSampleRate,
-                     StereoAudio& audio,
-                     std::string& error);
-
-// Writes a stereo WAV. `left` and `right` must both hold `frameCount` samples.
-bool writeStereoWav(const std::filesystem::path& path,
-                    const float* left,
-                    const float* right,
-                    size_t frameCount,
-                    uint32_t sampleRate);
+// Streams any format uapmd-data can open as stereo at `targetSampleRate`:
+// channels are downmixed (odd channels feed the left, even ones the right)
+// and resampled per read, so only the requested range is ever decoded.
+//
+// read() is thread-safe; separation workers share one reader.
+class StereoAudioReader {
+public:
+    StereoAudioReader();
+    ~StereoAudioReader();
+
+    // Returns false and fills `error` when the file cannot be used.
+    bool open(const std::string& filepath, uint32_t targetSampleRate, std::string& error);
+
+    // Length at the target rate.
+    size_t frameCount() const;
+
+    // Fills `audio` with frames [startFrame, startFrame + frameCount), clipped
+    // to the end of the file.
+    void read(size_t startFrame, size_t frameCount, StereoAudio& audio);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// A stereo WAV written a block at a time, so a stem reaches disk while the
+// rest of the file is still being separated.
+class StereoWavStreamWriter {
+public:
+    StereoWavStreamWriter();
+    ~StereoWavStreamWriter();
+
+    bool open(const std::filesystem::path& path, uint32_t sampleRate, size_t expectedFrameCount);
+    bool append(const float* left, const float* right, size_t frameCount);
+    bool close();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// The "<baseName>_<label>.wav" files of one separation, written as output
+// arrives. Files are discarded on destruction unless commit() succeeded, so a
+// canceled or failed run leaves no partial stems behind.
+class StemFileSet {
+public:
+    // Names the stems once their count is known. Stems past the returned
+    // labels are dropped.
+    using LabelsForCount = std::function<std::vector<std::string>(size_t stemCount)>;
+
+    StemFileSet(std::filesystem::path directory,
+                std::string baseName,
+                uint32_t sampleRate,
+                size_t expectedFrameCount,
+                LabelsForCount labelsForCount);
+    ~StemFileSet();
+
+    // Usable as a StemBlockSink. On failure error() says why.
+    bool append(size_t stem, size_t stemCount, const float* left, const float* right, size_t frameCount);
+
+    // Closes every file and returns (label, path) per stem in stem order.
+    bool commit(std::vector<std::pair<std::string, std::filesystem::path>>& stems);
+
+    const std::string& error() const { return error_; }
+
+private:
+    struct Stem {
+        std::string label;
+        std::filesystem::path path;
+        std::unique_ptr<StereoWavStreamWriter> writer;
+    };
+
+    bool openAll(size_t stemCount);
+    void discard();
+
+    std::filesystem::path directory_;
+    std::string base_name_;
+    uint32_t sample_rate_;
+    size_t expected_frame_count_;
+    LabelsForCount labels_for_count_;
+    std::vector<Stem> stems_;
+    bool opened_{false};
+    bool committed_{false};
+    std::string error_;
+};
+
+// Windowed separation
+//
+// A long input is cut into windows that overlap by `overlapFrames`; each one
+// is separated on its own and neighbouring results are crossfaded linearly
+// across the overlap, so memory is bounded by the window size times the
+// number of windows in flight rather than by the file length.
+
+struct WindowedSeparationOptions {
+    size_t windowFrames{0};
+    // At most half a window.
+    size_t overlapFrames{0};
+    // Windows separated concurrently. Each holds its own inference buffers.
+    size_t workerCount{1};
+};
+
+// Separates one window. Returns one StereoAudio per stem, each as long as the
+// window; the same stem count for every window. Called from worker threads,
+// concurrently when workerCount > 1. May throw; the exception is rethrown by
+// separateInWindows() on the calling thread.
+using WindowSeparator = std::function<std::vector<StereoAudio>(const StereoAudio& window)>;
+
+// Receives each stem's finished frames in order. Return false to abort.
+using StemBlockSink = std::function<bool(size_t stem, size_t stemCount,
+                                         const float* left, const float* right, size_t frameCount)>;
+
+// Reports windows completed so far. Called on the calling thread.
+using WindowProgress = std::function<void(size_t completed, size_t total)>;
+
+enum class WindowedSeparationOutcome {
+    Completed,
+    Canceled,
+    SinkFailed,
+};
+
+// Windows whose count and layout separateInWindows() uses for `frameCount`.
+size_t windowCountFor(size_t frameCount, const WindowedSeparationOptions& options);
+
+// Runs the windows on `options.workerCount` threads and delivers the
+// crossfaded output in order. `shouldCancel` is polled while waiting for
+// windows; once it returns true no further window is started.
+WindowedSeparationOutcome separateInWindows(StereoAudioReader& input,
+                                            const WindowedSeparationOptions& options,
+                                            const WindowSeparator& separate,
+                                            const StemBlockSink& sink,
+                                            const WindowProgress& progress,
+                                            const std::function<bool()>& shouldCancel);
 
 } // namespace uapmd_stems
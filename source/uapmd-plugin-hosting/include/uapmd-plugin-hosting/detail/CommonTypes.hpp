@@ -16,4 +16,5 @@ namespace uapmd {
     typedef remidy::EventSequence EventSequence;
     typedef remidy::AudioProcessContext AudioProcessContext;
     typedef remidy::MasterContext MasterContext;
+    typedef remidy::AudioContentType AudioContentType;
 }
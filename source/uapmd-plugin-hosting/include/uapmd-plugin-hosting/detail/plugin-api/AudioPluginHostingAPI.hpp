@@ -23,6 +23,43 @@ namespace uapmd_plugin_hosting {
         virtual void deletePluginInstance(int32_t instanceId) = 0;
         virtual AudioPluginInstanceAPI* getInstance(int32_t instanceId) = 0;
 
+        // Makes a format that the scanner does not know about (an in-app
+        // format, or a stand-in for tests) available to createPluginInstance(),
+        // along with its plugins. The format is not owned and has to outlive
+        // the host. Call it before creating instances of any plugin; a rescan
+        // drops the plugins from the catalog again.
+        virtual void registerPluginFormat(remidy::PluginFormat* /*format*/,
+                                          std::vector<remidy::PluginCatalogEntry> /*entries*/) {}
+
+        // Instance pool. With a non-zero capacity, deletePluginInstance() stops
+        // the instance, resets it to the state it was created with and keeps
+        // it, and createPluginInstance() of the same plugin and channel layout
+        // takes it back instead of instantiating (reconfiguring it if the
+        // sample rate or buffer size differ) and starts it again. The least recently deleted instances go first
+        // once the pool is full. 0 (the default) destroys instances as before.
+        virtual uint32_t instancePoolCapacity() { return 0; }
+        virtual void instancePoolCapacity(uint32_t) {}
+        // Instantiates up to `count` instances of the plugin into the pool, one
+        // per main thread task, so that inserting it later is immediate. They
+        // are parked stopped, like deleted ones.
+        virtual void prewarmPluginInstances(uint32_t /*sampleRate*/,
+                                            uint32_t /*bufferSize*/,
+                                            std::optional<uint32_t> /*mainInputChannels*/,
+                                            std::optional<uint32_t> /*mainOutputChannels*/,
+                                            bool /*offlineMode*/,
+                                            std::string& /*format*/,
+                                            std::string& /*pluginId*/,
+                                            uint32_t /*count*/) {}
+        virtual void clearInstancePool() {}
+
+        // Sample format new instances are asked to process in. With Float64,
+        // VST3 and CLAP instances are configured for 64-bit processing (and
+        // fall back to 32-bit if the plugin cannot do it); other formats stay
+        // 32-bit. Whatever an instance runs in, processAudio() converts the
+        // buses in place when it differs from the context's audioDataType().
+        virtual remidy::AudioContentType processingDataType() { return remidy::AudioContentType::Float32; }
+        virtual void processingDataType(remidy::AudioContentType) {}
+
         // In some plugin format (namely VST3), an instance may report its internal state changed,
         // and in that case we will have to tell the document models that the plugin becomes dirty.
         // On the other hand, most plugin formats are good and host is the single source of truth,
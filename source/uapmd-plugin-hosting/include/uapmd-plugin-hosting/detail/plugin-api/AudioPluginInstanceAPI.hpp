@@ -62,8 +62,26 @@ namespace uapmd_plugin_hosting {
         virtual uapmd_status_t startProcessing() = 0;
         virtual uapmd_status_t stopProcessing() = 0;
         virtual uapmd_status_t processAudio(AudioProcessContext &process) = 0;
+        // Applies a new sample rate and maximum block size to a running
+        // instance, keeping its state. Non-RT thread; processAudio() may keep
+        // being called meanwhile and passes blocks through untouched while
+        // the instance cannot process them. Returns non-zero on failure.
+        virtual uapmd_status_t reconfigure(uint32_t sampleRate, uint32_t bufferSizeInFrames) {
+            (void) sampleRate;
+            (void) bufferSizeInFrames;
+            return -1;
+        }
         virtual uint32_t latencyInSamples() const = 0;
         virtual double tailLengthInSeconds() const = 0;
+        // Whether processAudio() may run on a render thread instead of the
+        // audio thread; see remidy::PluginInstance::supportsProcessingOffAudioThread().
+        virtual bool supportsProcessingOffAudioThread() const { return false; }
+        // Whether processAudio() skips the plugin while it only turns silence
+        // into silence; see SilenceSleepTracker.
+        virtual bool sleepsWhenSilent() const { return false; }
+        virtual void sleepsWhenSilent(bool value) { (void) value; }
+        // Whether the plugin is skipped at the moment.
+        virtual bool sleeping() const { return false; }
         virtual bool requiresReplacingProcess() const = 0;
         virtual std::vector<ParameterMetadata> parameterMetadataList() = 0;
         virtual std::vector<ParameterMetadata> perNoteControllerMetadataList(remidy::PerNoteControllerContextTypes contextType, uint32_t context) = 0;
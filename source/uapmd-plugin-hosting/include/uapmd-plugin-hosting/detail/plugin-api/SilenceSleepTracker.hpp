@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "remidy/remidy.hpp"
+#include "../CommonTypes.hpp"
+
+namespace uapmd_plugin_hosting {
+
+    // Decides when a plugin instance can skip process() because it would
+    // only turn silence into silence, and when it has to run again.
+    //
+    // An instance falls asleep once its input has been silent, without
+    // events, for its reported tail length, and its output has stayed below
+    // the threshold for kDecayHoldSeconds on top. An infinite tail, or
+    // output events, keep it awake. Any input event, input above the
+    // threshold, transport start or stop, or requestWake() wakes it for the
+    // next block.
+    //
+    // Off unless enabled. RemidyAudioPluginInstance enables it for plugins
+    // with audio input: an instrument that follows the transport can go
+    // quiet between notes it generates itself, and would not come back.
+    //
+    // Audio thread, except for the setters and requestWake().
+    class SilenceSleepTracker {
+        std::atomic<bool> enabled_{false};
+        std::atomic<bool> sleeping_{false};
+        std::atomic<bool> wake_requested_{false};
+        bool input_quiet_{false};
+        bool was_playing_{false};
+        int64_t quiet_input_frames_{0};
+        int64_t quiet_output_frames_{0};
+
+        void reset();
+
+    public:
+        // -120 dBFS.
+        static constexpr double kSilenceThreshold{1.0e-6};
+        // How long the output has to stay quiet, measured, before sleeping;
+        // covers plugins that report a shorter tail than they have.
+        static constexpr double kDecayHoldSeconds{0.1};
+
+        bool enabled() const { return enabled_.load(std::memory_order_acquire); }
+        // Disabling also wakes the instance.
+        void enabled(bool value);
+        bool sleeping() const { return sleeping_.load(std::memory_order_acquire); }
+
+        // Any thread. Parameter, preset and state changes call this, since
+        // they can make a silent instance sound without any input.
+        void requestWake() { wake_requested_.store(true, std::memory_order_release); }
+
+        // Before process(). Records the silent input channels in the input
+        // silence flags (or clears them, when disabled, without scanning)
+        // and resets the output flags. Returns true when the block can be
+        // skipped; skipBlock() then stands in for process().
+        bool beginBlock(remidy::AudioProcessContext& process);
+        // After process() has run the block.
+        void endBlock(remidy::AudioProcessContext& process, double tailLengthInSeconds);
+        // Silent outputs for a skipped block.
+        static void skipBlock(remidy::AudioProcessContext& process);
+    };
+
+}
@@ -25,6 +25,7 @@ namespace uapmd_plugin_hosting {
         std::unique_ptr<PluginInstance> instance{nullptr};
         std::string displayName;
         std::atomic<PluginInstancingState> instancing_state{PluginInstancingState::Created};
+        bool processing{false};
 
         void setupInstance(PluginUIThreadRequirement uiThreadRequirement, std::function<void(std::string error)> callback);
 
@@ -44,5 +45,12 @@ namespace uapmd_plugin_hosting {
         PluginInstance::ConfigurationRequest& configurationRequest() { return config; }
 
         std::atomic<PluginInstancingState>& instancingState() { return instancing_state; }
+
+        // Stop and restart processing of a ready instance, e.g. while it is
+        // parked in the host's instance pool. The destructor stops the
+        // instance only if it is still processing.
+        StatusCode stopProcessing();
+        StatusCode startProcessing();
+        bool isProcessing() const { return processing; }
     };
 }
\ No newline at end of file
@@ -12,3 +12,4 @@
 #include "detail/plugin-api/AapUiHostDetailsExtension.hpp"
 #include "detail/plugin-api/AudioPluginHostingAPI.hpp"
 #include "detail/plugin-api/AudioPluginNodeFeature.hpp"
+#include "detail/plugin-api/SilenceSleepTracker.hpp"
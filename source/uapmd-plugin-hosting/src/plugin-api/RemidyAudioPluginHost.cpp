@@ -1,7 +1,10 @@
 
 #include "RemidyAudioPluginHost.hpp"
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <ranges>
+#include <thread>
 #if ANDROID
 #include <android/log.h>
 #endif
@@ -93,8 +96,22 @@ namespace uapmd_plugin_hosting {
         };
 
         bool bypassed_{true};
+        // What the instance was configured to process in; the buses are
+        // converted around process() when the context holds the other format.
+        remidy::AudioContentType plugin_data_type_{remidy::AudioContentType::Float32};
+        // Handshake between processAudio() and a reconfigure() that has to
+        // keep the instance out of process() (see supportsLiveReconfiguration()).
+        std::atomic<bool> reconfiguring_{false};
+        std::atomic<bool> in_process_audio_{false};
+        SilenceSleepTracker sleep_tracker_{};
         remidy::EventListenerId plugin_state_change_listener_id_{0};
+        remidy::EventListenerId parameter_change_listener_id_{0};
         std::function<void()> on_plugin_state_changed_{};
+        // What the instance is reset to when it goes back to the host's pool.
+        std::vector<uint8_t> default_state_{};
+        // Removed on destruction, so that a pooled instance does not notify
+        // listeners of the session it left.
+        std::vector<remidy::EventListenerId> timing_listener_ids_{};
         std::shared_ptr<uapmd_plugin_hosting::PluginInstancing> instancing{};
         remidy::PluginInstance* instance{};
 #ifdef UAPMD_HAS_ARA
@@ -119,15 +136,32 @@ namespace uapmd_plugin_hosting {
         explicit RemidyAudioPluginInstance(const std::shared_ptr<uapmd_plugin_hosting::PluginInstancing>& instancing, remidy::PluginInstance* instance, std::function<void()> onPluginStateChanged)
           : instancing(instancing), instance(instance), on_plugin_state_changed_(std::move(onPluginStateChanged)) {
             bypassed_ = false;
+            if (instancing)
+                plugin_data_type_ = instancing->configurationRequest().dataType;
+            // Effects sleep unless opted out. A plugin without audio input
+            // may generate sound from the transport alone, so it stays awake.
+            if (instance)
+                if (auto* buses = instance->audioBuses())
+                    sleep_tracker_.enabled(!buses->audioInputBuses().empty());
             if (instance)
                 plugin_state_change_listener_id_ = instance->pluginStateChangeEvent().addListener([this] {
+                    sleep_tracker_.requestWake();
                     if (on_plugin_state_changed_)
                         on_plugin_state_changed_();
                 });
+            // Covers edits made in the plugin's own UI as well.
+            if (instance && instance->parameters())
+                parameter_change_listener_id_ = instance->parameters()->parameterChangeEvent().addListener(
+                    [this](uint32_t, double) { sleep_tracker_.requestWake(); });
         }
         ~RemidyAudioPluginInstance() override {
             if (instance && plugin_state_change_listener_id_ != 0)
                 instance->pluginStateChangeEvent().removeListener(plugin_state_change_listener_id_);
+            if (instance && parameter_change_listener_id_ != 0 && instance->parameters())
+                instance->parameters()->parameterChangeEvent().removeListener(parameter_change_listener_id_);
+            if (instance)
+                for (const auto listenerId : timing_listener_ids_)
+                    instance->timingInfoChangeEvent().removeListener(listenerId);
             bypassed_ = true;
             if (ui_support) {
                 if (uiVisible)
@@ -143,6 +177,7 @@ namespace uapmd_plugin_hosting {
         bool bypassed() const override { return bypassed_; }
         void bypassed(bool value) override {
             bypassed_ = value;
+            sleep_tracker_.requestWake();
             // For WebCLAP the actual DSP runs in the AudioWorklet thread and is
             // gated by info.active, which is not touched by the C++ bypassed_ flag.
             // Relay the state change so the worklet stops/resumes generating audio.
@@ -157,24 +192,42 @@ namespace uapmd_plugin_hosting {
         uapmd_status_t startProcessing() override {
             if (!instance)
                 return -1;
-            return static_cast<uapmd_status_t>(instance->startProcessing());
+            sleep_tracker_.requestWake();
+            return static_cast<uapmd_status_t>(instancing ? instancing->startProcessing() : instance->startProcessing());
         }
 
         uapmd_status_t stopProcessing() override {
             if (!instance)
                 return -1;
-            return static_cast<uapmd_status_t>(instance->stopProcessing());
+            return static_cast<uapmd_status_t>(instancing ? instancing->stopProcessing() : instance->stopProcessing());
         }
 
         uapmd_status_t processAudio(AudioProcessContext &process) override {
             if (bypassed_)
                 return 0;
 
+            in_process_audio_.store(true, std::memory_order_seq_cst);
+            struct ProcessAudioScope {
+                std::atomic<bool>& flag;
+                ~ProcessAudioScope() { flag.store(false, std::memory_order_release); }
+            } processAudioScope{in_process_audio_};
+            // Treated like bypass until reconfigure() is done.
+            if (reconfiguring_.load(std::memory_order_seq_cst))
+                return 0;
+
+            if (sleep_tracker_.beginBlock(process)) {
+                SilenceSleepTracker::skipBlock(process);
+                return 0;
+            }
+
+            const auto contextDataType = process.audioDataType();
             const bool replacing = instance && instance->requiresReplacingProcess();
             if (replacing) {
                 process.copyInputsToOutputs();
                 process.enableReplacingIO();
             }
+            // With replacing I/O the inputs are the outputs by now.
+            process.convertAudioInputs(contextDataType, plugin_data_type_);
 
             // FIXME: define error codes
             uapmd_status_t status = 0;
@@ -183,9 +236,42 @@ namespace uapmd_plugin_hosting {
 
             if (replacing)
                 process.disableReplacingIO();
+            else
+                process.convertAudioInputs(plugin_data_type_, contextDataType);
+            process.convertAudioOutputs(plugin_data_type_, contextDataType);
+            if (status == 0 && instance)
+                sleep_tracker_.endBlock(process, instance->tailLengthInSeconds());
             return status;
         }
 
+        uapmd_status_t reconfigure(uint32_t sampleRate, uint32_t bufferSizeInFrames) override {
+            if (!instance || !instancing)
+                return -1;
+            auto configuration = instancing->configurationRequest();
+            configuration.sampleRate = sampleRate;
+            configuration.bufferSizeInSamples = bufferSizeInFrames;
+
+            sleep_tracker_.requestWake();
+            remidy::StatusCode code;
+            if (instance->supportsLiveReconfiguration())
+                code = instance->configure(configuration);
+            else {
+                // Stop, configure and restart between two blocks, while
+                // processAudio() stays out of the instance.
+                reconfiguring_.store(true, std::memory_order_seq_cst);
+                while (in_process_audio_.load(std::memory_order_seq_cst))
+                    std::this_thread::yield();
+                instancing->stopProcessing();
+                code = instance->configure(configuration);
+                if (code == remidy::StatusCode::OK)
+                    code = instancing->startProcessing();
+                reconfiguring_.store(false, std::memory_order_seq_cst);
+            }
+            if (code == remidy::StatusCode::OK)
+                instancing->configurationRequest() = configuration;
+            return static_cast<uapmd_status_t>(code);
+        }
+
 #ifdef __EMSCRIPTEN__
         bool trySendWebClapInputEvents(const uapmd_ump_t* events, size_t sizeInBytes) {
             if (auto* webclap = dynamic_cast<remidy::PluginInstanceWebCLAP*>(instance))
@@ -202,6 +288,10 @@ namespace uapmd_plugin_hosting {
             return instance ? instance->tailLengthInSeconds() : 0.0;
         }
 
+        bool sleepsWhenSilent() const override { return sleep_tracker_.enabled(); }
+        void sleepsWhenSilent(bool value) override { sleep_tracker_.enabled(value); }
+        bool sleeping() const override { return sleep_tracker_.sleeping(); }
+
         std::vector<ParameterMetadata> parameterMetadataList() override {
             std::vector<ParameterMetadata> ret{};
             auto pl = instance->parameters();
@@ -279,6 +369,7 @@ namespace uapmd_plugin_hosting {
         void loadPreset(int32_t presetIndex) override {
             const auto previousLatency = instance->latencyInSamples();
             const auto previousTail = instance->tailLengthInSeconds();
+            sleep_tracker_.requestWake();
             instance->presets()->loadPreset(presetIndex);
             notifyTimingInfoChangeIfNeeded(*instance, previousLatency, previousTail);
         }
@@ -286,7 +377,9 @@ namespace uapmd_plugin_hosting {
         void loadPreset(int32_t presetIndex, std::function<void(std::string error, void* callbackContext)> completed) override {
             const auto previousLatency = instance->latencyInSamples();
             const auto previousTail = instance->tailLengthInSeconds();
+            sleep_tracker_.requestWake();
             instance->presets()->loadPreset(presetIndex, [this, previousLatency, previousTail, completed = std::move(completed)](std::string error, void* callbackContext) mutable {
+                sleep_tracker_.requestWake();
                 if (error.empty())
                     notifyTimingInfoChangeIfNeeded(*instance, previousLatency, previousTail);
                 if (error.empty())
@@ -302,6 +395,7 @@ namespace uapmd_plugin_hosting {
         void loadStateSync(std::vector<uint8_t> &state) override {
             const auto previousLatency = instance->latencyInSamples();
             const auto previousTail = instance->tailLengthInSeconds();
+            sleep_tracker_.requestWake();
             instance->states()->setState(state, remidy::PluginStateSupport::StateContextType::Project, false);
             notifyTimingInfoChangeIfNeeded(*instance, previousLatency, previousTail);
         }
@@ -321,6 +415,7 @@ namespace uapmd_plugin_hosting {
                 includeUiState,
                 callbackContext,
                 [this, previousLatency, previousTail, completed = std::move(completed)](std::string error, void* callbackContext) mutable {
+                    sleep_tracker_.requestWake();
                     if (error.empty())
                         notifyTimingInfoChangeIfNeeded(*instance, previousLatency, previousTail);
                     if (completed)
@@ -337,11 +432,13 @@ namespace uapmd_plugin_hosting {
         void setParameterValue(int32_t index, double value) override {
             const auto previousLatency = instance->latencyInSamples();
             const auto previousTail = instance->tailLengthInSeconds();
+            sleep_tracker_.requestWake();
             instance->parameters()->setParameter(index, value);
             notifyTimingInfoChangeIfNeeded(*instance, previousLatency, previousTail);
         }
 
         void enqueueParameterValueRT(int32_t index, double value, uapmd_timestamp_t timestamp) override {
+            sleep_tracker_.requestWake();
             instance->parameters()->enqueueParameterRT(index, value, timestamp);
         }
 
@@ -352,6 +449,7 @@ namespace uapmd_plugin_hosting {
         void setPerNoteControllerValue(uint8_t note, uint8_t index, double value) override {
             const auto previousLatency = instance->latencyInSamples();
             const auto previousTail = instance->tailLengthInSeconds();
+            sleep_tracker_.requestWake();
             instance->parameters()->setPerNoteController({.note = note }, index, value);
             notifyTimingInfoChangeIfNeeded(*instance, previousLatency, previousTail);
         }
@@ -367,6 +465,7 @@ namespace uapmd_plugin_hosting {
         }
 
         void enqueuePerNoteControllerValueRT(uint8_t note, uint8_t index, double value, uapmd_timestamp_t timestamp) override {
+            sleep_tracker_.requestWake();
             instance->parameters()->enqueuePerNoteControllerRT({.note = note }, index, value, timestamp);
         }
 
@@ -375,6 +474,9 @@ namespace uapmd_plugin_hosting {
         }
 
         remidy::PluginInstance* rawInstance() const { return instance; }
+        const std::shared_ptr<uapmd_plugin_hosting::PluginInstancing>& pluginInstancing() const { return instancing; }
+        const std::vector<uint8_t>& defaultState() const { return default_state_; }
+        void defaultState(std::vector<uint8_t> state) { default_state_ = std::move(state); }
 
         bool hasUISupport() override {
             auto ui = ensureUISupport();
@@ -480,18 +582,25 @@ namespace uapmd_plugin_hosting {
             std::function<void(remidy::PluginTimingInfoChange)> listener) override {
             if (!instance)
                 return 0;
-            return instance->timingInfoChangeEvent().addListener(std::move(listener));
+            const auto listenerId = instance->timingInfoChangeEvent().addListener(std::move(listener));
+            timing_listener_ids_.push_back(listenerId);
+            return listenerId;
         }
 
         void removeTimingInfoChangeListener(remidy::EventListenerId listenerId) override {
             if (instance)
                 instance->timingInfoChangeEvent().removeListener(listenerId);
+            std::erase(timing_listener_ids_, listenerId);
         }
 
         bool requiresReplacingProcess() const override {
             return instance && instance->requiresReplacingProcess();
         }
 
+        bool supportsProcessingOffAudioThread() const override {
+            return instance && instance->supportsProcessingOffAudioThread();
+        }
+
         AudioPluginInstanceExtension* extension(std::string_view extensionId) override {
             if (!instance)
                 return nullptr;
@@ -540,6 +649,8 @@ uapmd_plugin_hosting::RemidyAudioPluginHost::RemidyAudioPluginHost() {
 }
 
 uapmd_plugin_hosting::RemidyAudioPluginHost::~RemidyAudioPluginHost() {
+    callbacks_alive_->store(false, std::memory_order_release);
+    idle_instances_.clear();
 #if _WIN32
     if (comInitialized)
         CoUninitialize();
@@ -559,11 +670,14 @@ void uapmd_plugin_hosting::RemidyAudioPluginHost::savePluginCatalogToFile(std::f
 
 std::filesystem::path empty_path{""};
 void uapmd_plugin_hosting::RemidyAudioPluginHost::performPluginScanning(bool rescan) {
+    // Idle instances refer to catalog entries that are about to go away.
+    idle_instances_.clear();
     scanning->catalog().clear();
     scanning->performPluginScanning(false, uapmd_plugin_hosting::ScanMode::InProcess, rescan);
 }
 
 void uapmd_plugin_hosting::RemidyAudioPluginHost::reloadPluginCatalogFromCache() {
+    idle_instances_.clear();
     auto& cacheFile = scanning->pluginListCacheFile();
     if (cacheFile.empty()) {
         scanning->catalog().clear();
@@ -575,6 +689,57 @@ void uapmd_plugin_hosting::RemidyAudioPluginHost::reloadPluginCatalogFromCache()
     scanning->performPluginScanning(true, uapmd_plugin_hosting::ScanMode::InProcess, false);
 }
 
+namespace {
+    std::vector<uint8_t> captureDefaultState(remidy::PluginInstance* instance) {
+        auto states = instance ? instance->states() : nullptr;
+        if (!states)
+            return {};
+        return states->getState(remidy::PluginStateSupport::StateContextType::Project, false);
+    }
+}
+
+std::shared_ptr<uapmd_plugin_hosting::PluginInstancing> uapmd_plugin_hosting::RemidyAudioPluginHost::createInstancing(
+        uint32_t sampleRate,
+        uint32_t bufferSize,
+        std::optional<uint32_t> mainInputChannels,
+        std::optional<uint32_t> mainOutputChannels,
+        bool offlineMode,
+        std::string &formatName,
+        std::string &pluginId) {
+    auto formats = scanning->formats();
+    auto format = std::ranges::find_if(formats, [&formatName](auto f) { return f->name() == formatName; });
+    if (format == formats.end())
+        return nullptr;
+    auto plugins = scanning->catalog().getPlugins();
+    auto entry = std::ranges::find_if(plugins, [&formatName,&pluginId](auto e) {
+        return e->format() == formatName && e->pluginId() == pluginId;
+    });
+    if (entry == plugins.end())
+        return nullptr;
+    auto instancing = std::make_shared<PluginInstancing>(*scanning, *format, *entry);
+    auto& configuration = instancing->configurationRequest();
+    configuration.sampleRate = sampleRate;
+    configuration.bufferSizeInSamples = bufferSize;
+    configuration.offlineMode = offlineMode;
+    configuration.dataType = dataTypeForFormat(formatName);
+    configuration.mainInputChannels = mainInputChannels;
+    configuration.mainOutputChannels = mainOutputChannels;
+    return instancing;
+}
+
+int32_t uapmd_plugin_hosting::RemidyAudioPluginHost::registerInstance(
+        const std::shared_ptr<PluginInstancing>& instancing,
+        remidy::PluginInstance* instance,
+        std::vector<uint8_t> defaultState) {
+    auto instanceId = instanceIdSerial++;
+    auto api = std::make_unique<RemidyAudioPluginInstance>(instancing, instance, [this, instanceId] {
+        plugin_state_change_event_.notify(instanceId);
+    });
+    api->defaultState(std::move(defaultState));
+    instances[instanceId] = std::move(api);
+    return instanceId;
+}
+
 void uapmd_plugin_hosting::RemidyAudioPluginHost::createPluginInstance(uint32_t sampleRate,
                                                         uint32_t bufferSize,
                                                         std::optional<uint32_t> mainInputChannels,
@@ -583,31 +748,29 @@ void uapmd_plugin_hosting::RemidyAudioPluginHost::createPluginInstance(uint32_t
                                                         std::string &formatName,
                                                         std::string &pluginId,
                                                         std::function<void(int32_t instanceId, std::string error)>&& callback) {
-    auto format = *(scanning->formats() | std::views::filter([formatName](auto f) { return f->name() == formatName; })).begin();
-    auto plugins = scanning->catalog().getPlugins();
-    auto entry = std::ranges::find_if(plugins, [&formatName,&pluginId](auto e) {
-        return e->format() == formatName && e->pluginId() == pluginId;
-    });
-    if (entry == plugins.end())
+    std::vector<uint8_t> defaultState{};
+    if (auto idle = takeIdleInstance(sampleRate, bufferSize, mainInputChannels, mainOutputChannels, offlineMode,
+                                     formatName, pluginId, defaultState)) {
+        int32_t instanceId{-1};
+        idle->withInstance([&](remidy::PluginInstance* instance) {
+            instanceId = registerInstance(idle, instance, std::move(defaultState));
+        });
+        callback(instanceId, instanceId < 0 ? "Pooled plugin instance is unavailable" : "");
+        return;
+    }
+
+    auto instancing = createInstancing(sampleRate, bufferSize, mainInputChannels, mainOutputChannels, offlineMode,
+                                       formatName, pluginId);
+    if (!instancing)
         callback(-1, "Plugin not found");
     else {
-        auto instancing = std::make_shared<PluginInstancing>(*scanning, format, *entry);
-        auto& configuration = instancing->configurationRequest();
-        configuration.sampleRate = sampleRate;
-        configuration.bufferSizeInSamples = bufferSize;
-        configuration.offlineMode = offlineMode;
-        configuration.mainInputChannels = mainInputChannels;
-        configuration.mainOutputChannels = mainOutputChannels;
         auto cb = std::move(callback);
         instancing->makeAlive([this,instancing,cb](std::string error) {
             if (error.empty())
                 instancing->withInstance([this,instancing,cb](remidy::PluginInstance* instance) {
-                    auto instanceId = instanceIdSerial++;
-                    auto api = std::make_unique<RemidyAudioPluginInstance>(instancing, instance, [this, instanceId] {
-                        plugin_state_change_event_.notify(instanceId);
-                    });
-                    instances[instanceId] = std::move(api);
-                    cb(instanceId, "");
+                    // Only needed to put the instance back into the pool later.
+                    auto defaultState = max_idle_instances_ > 0 ? captureDefaultState(instance) : std::vector<uint8_t>{};
+                    cb(registerInstance(instancing, instance, std::move(defaultState)), "");
                 });
             else {
                 cb(-1, error);
@@ -616,9 +779,158 @@ void uapmd_plugin_hosting::RemidyAudioPluginHost::createPluginInstance(uint32_t
     }
 }
 
+void uapmd_plugin_hosting::RemidyAudioPluginHost::registerPluginFormat(remidy::PluginFormat* format,
+                                                                     std::vector<remidy::PluginCatalogEntry> entries) {
+    if (!format)
+        return;
+    scanning->addFormat(format);
+    for (auto& entry : entries)
+        scanning->catalog().add(std::move(entry));
+}
+
 void uapmd_plugin_hosting::RemidyAudioPluginHost::deletePluginInstance(int32_t instanceId) {
-    instances.erase(instanceId);
+    auto it = instances.find(instanceId);
+    if (it == instances.end())
+        return;
+    IdleInstance idle{};
+    auto* api = dynamic_cast<RemidyAudioPluginInstance*>(it->second.get());
+    if (max_idle_instances_ > 0 && api && api->rawInstance() && !api->defaultState().empty())
+        idle = {api->pluginInstancing(), api->formatName(), api->pluginId(), api->defaultState()};
+    // Takes down the UI and the listeners of the session along with it.
+    instances.erase(it);
+    if (!idle.instancing)
+        return;
+
+    // Stopping drops voices and tails; the default state takes back whatever
+    // the session changed. It stays stopped until takeIdleInstance().
+    if (idle.instancing->stopProcessing() != remidy::StatusCode::OK)
+        return;
+    idle.instancing->withInstance([&](remidy::PluginInstance* instance) {
+        instance->states()->setState(idle.defaultState, remidy::PluginStateSupport::StateContextType::Project, false);
+    });
+    keepIdleInstance(std::move(idle));
+}
+
+std::shared_ptr<uapmd_plugin_hosting::PluginInstancing> uapmd_plugin_hosting::RemidyAudioPluginHost::takeIdleInstance(
+        uint32_t sampleRate,
+        uint32_t bufferSize,
+        std::optional<uint32_t> mainInputChannels,
+        std::optional<uint32_t> mainOutputChannels,
+        bool offlineMode,
+        std::string &formatName,
+        std::string &pluginId,
+        std::vector<uint8_t>& defaultState) {
+    auto it = std::ranges::find_if(idle_instances_, [&](const IdleInstance& idle) {
+        const auto& configuration = idle.instancing->configurationRequest();
+        return idle.format == formatName && idle.pluginId == pluginId &&
+               configuration.offlineMode == offlineMode &&
+               configuration.mainInputChannels == mainInputChannels &&
+               configuration.mainOutputChannels == mainOutputChannels;
+    });
+    if (it == idle_instances_.end())
+        return nullptr;
+    auto idle = std::move(*it);
+    idle_instances_.erase(it);
+
+    auto& configuration = idle.instancing->configurationRequest();
+    // An instance that fell back to 32-bit is asked again; that is cheap
+    // next to instantiating.
+    const auto dataType = dataTypeForFormat(formatName);
+    if (configuration.sampleRate != sampleRate || configuration.bufferSizeInSamples != bufferSize ||
+        configuration.dataType != dataType) {
+        auto updated = configuration;
+        updated.sampleRate = sampleRate;
+        updated.bufferSizeInSamples = bufferSize;
+        updated.dataType = dataType;
+        bool configured{false};
+        idle.instancing->withInstance([&](remidy::PluginInstance* instance) {
+            configured = instance->configure(updated) == remidy::StatusCode::OK;
+        });
+        // Instantiate afresh instead.
+        if (!configured)
+            return nullptr;
+        configuration = updated;
+    }
+    if (idle.instancing->startProcessing() != remidy::StatusCode::OK)
+        return nullptr;
+    defaultState = std::move(idle.defaultState);
+    return idle.instancing;
+}
+
+void uapmd_plugin_hosting::RemidyAudioPluginHost::keepIdleInstance(IdleInstance&& idle) {
+    idle_instances_.push_front(std::move(idle));
+    while (idle_instances_.size() > max_idle_instances_)
+        idle_instances_.pop_back();
+}
+
+uint32_t uapmd_plugin_hosting::RemidyAudioPluginHost::instancePoolCapacity() {
+    return max_idle_instances_;
+}
+
+void uapmd_plugin_hosting::RemidyAudioPluginHost::instancePoolCapacity(uint32_t maxIdleInstances) {
+    max_idle_instances_ = maxIdleInstances;
+    while (idle_instances_.size() > max_idle_instances_)
+        idle_instances_.pop_back();
+}
+
+void uapmd_plugin_hosting::RemidyAudioPluginHost::prewarmPluginInstances(uint32_t sampleRate,
+                                                          uint32_t bufferSize,
+                                                          std::optional<uint32_t> mainInputChannels,
+                                                          std::optional<uint32_t> mainOutputChannels,
+                                                          bool offlineMode,
+                                                          std::string &formatName,
+                                                          std::string &pluginId,
+                                                          uint32_t count) {
+    // One instance per task, so that the main thread gets to run in between
+    // (VST3 and CLAP instantiate there anyway).
+    for (uint32_t i = 0; i < count; i++)
+        remidy::EventLoop::enqueueTaskOnMainThread(
+            [this, alive = callbacks_alive_, sampleRate, bufferSize, mainInputChannels, mainOutputChannels,
+             offlineMode, formatName, pluginId, count]() mutable {
+                if (!alive->load(std::memory_order_acquire))
+                    return;
+                const auto warm = std::ranges::count_if(idle_instances_, [&](const IdleInstance& idle) {
+                    return idle.format == formatName && idle.pluginId == pluginId;
+                });
+                if (warm >= count || idle_instances_.size() >= max_idle_instances_)
+                    return;
+                auto instancing = createInstancing(sampleRate, bufferSize, mainInputChannels, mainOutputChannels,
+                                                   offlineMode, formatName, pluginId);
+                if (!instancing)
+                    return;
+                instancing->makeAlive([this, alive, instancing, formatName, pluginId](std::string error) {
+                    if (!error.empty() || !alive->load(std::memory_order_acquire))
+                        return;
+                    // makeAlive() starts processing; parked instances are stopped.
+                    if (instancing->stopProcessing() != remidy::StatusCode::OK)
+                        return;
+                    instancing->withInstance([&](remidy::PluginInstance* instance) {
+                        keepIdleInstance({instancing, formatName, pluginId, captureDefaultState(instance)});
+                    });
+                });
+            });
 }
+
+void uapmd_plugin_hosting::RemidyAudioPluginHost::clearInstancePool() {
+    idle_instances_.clear();
+}
+
+remidy::AudioContentType uapmd_plugin_hosting::RemidyAudioPluginHost::processingDataType() {
+    return processing_data_type_;
+}
+
+void uapmd_plugin_hosting::RemidyAudioPluginHost::processingDataType(remidy::AudioContentType dataType) {
+    processing_data_type_ = dataType;
+}
+
+remidy::AudioContentType uapmd_plugin_hosting::RemidyAudioPluginHost::dataTypeForFormat(const std::string& format) const {
+    // LV2 audio ports are float-only, and the remaining formats are driven in
+    // float too; processAudio() converts around them.
+    if (format == "VST3" || format == "CLAP")
+        return processing_data_type_;
+    return remidy::AudioContentType::Float32;
+}
+
 std::vector<int32_t> uapmd_plugin_hosting::RemidyAudioPluginHost::instanceIds() {
     std::vector<int32_t> ret;
     for (auto& i : instances)
@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 #include <atomic>
+#include <list>
 #include <memory>
 
 #include "remidy/remidy.hpp"
@@ -12,10 +13,46 @@ namespace uapmd_plugin_hosting {
         std::unique_ptr<uapmd_plugin_hosting::PluginScanTool> scanning;
         std::map<int32_t,std::unique_ptr<uapmd_plugin_hosting::AudioPluginInstanceAPI>> instances{};
         remidy::ParameterEventBase<void, int32_t> plugin_state_change_event_{};
+
+        // An instance kept for reuse, already reset to `defaultState` and
+        // stopped; takeIdleInstance() starts it again.
+        struct IdleInstance {
+            std::shared_ptr<PluginInstancing> instancing{};
+            std::string format{};
+            std::string pluginId{};
+            std::vector<uint8_t> defaultState{};
+        };
+        // Most recently deleted or prewarmed first. Main thread only.
+        std::list<IdleInstance> idle_instances_{};
+        uint32_t max_idle_instances_{0};
+        remidy::AudioContentType processing_data_type_{remidy::AudioContentType::Float32};
+        // Cleared on destruction so that queued prewarm tasks do nothing.
+        std::shared_ptr<std::atomic<bool>> callbacks_alive_{std::make_shared<std::atomic<bool>>(true)};
 #if _WIN32
         bool comInitialized{false};
 #endif
 
+        std::shared_ptr<PluginInstancing> createInstancing(uint32_t sampleRate,
+                                                           uint32_t bufferSize,
+                                                           std::optional<uint32_t> mainInputChannels,
+                                                           std::optional<uint32_t> mainOutputChannels,
+                                                           bool offlineMode,
+                                                           std::string &format,
+                                                           std::string &pluginId);
+        int32_t registerInstance(const std::shared_ptr<PluginInstancing>& instancing,
+                                 remidy::PluginInstance* instance,
+                                 std::vector<uint8_t> defaultState);
+        std::shared_ptr<PluginInstancing> takeIdleInstance(uint32_t sampleRate,
+                                                           uint32_t bufferSize,
+                                                           std::optional<uint32_t> mainInputChannels,
+                                                           std::optional<uint32_t> mainOutputChannels,
+                                                           bool offlineMode,
+                                                           std::string &format,
+                                                           std::string &pluginId,
+                                                           std::vector<uint8_t>& defaultState);
+        void keepIdleInstance(IdleInstance&& idle);
+        remidy::AudioContentType dataTypeForFormat(const std::string& format) const;
+
     public:
         RemidyAudioPluginHost();
         ~RemidyAudioPluginHost() override;
@@ -33,6 +70,20 @@ namespace uapmd_plugin_hosting {
                                   std::string &pluginId,
                                   std::function<void(int32_t instanceId, std::string error)>&& callback) override;
         void deletePluginInstance(int32_t instanceId) override;
+        void registerPluginFormat(remidy::PluginFormat* format, std::vector<remidy::PluginCatalogEntry> entries) override;
+        uint32_t instancePoolCapacity() override;
+        void instancePoolCapacity(uint32_t maxIdleInstances) override;
+        void prewarmPluginInstances(uint32_t sampleRate,
+                                    uint32_t bufferSize,
+                                    std::optional<uint32_t> mainInputChannels,
+                                    std::optional<uint32_t> mainOutputChannels,
+                                    bool offlineMode,
+                                    std::string &format,
+                                    std::string &pluginId,
+                                    uint32_t count) override;
+        void clearInstancePool() override;
+        remidy::AudioContentType processingDataType() override;
+        void processingDataType(remidy::AudioContentType dataType) override;
         std::vector<int32_t> instanceIds() override;
         remidy::EventListenerId addPluginStateChangeListener(std::function<void(int32_t)> listener) override;
         void removePluginStateChangeListener(remidy::EventListenerId listenerId) override;
@@ -0,0 +1,67 @@
+#include "uapmd-plugin-hosting/uapmd-plugin-hosting.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace uapmd_plugin_hosting {
+
+    void SilenceSleepTracker::enabled(bool value) {
+        enabled_.store(value, std::memory_order_release);
+        if (!value)
+            requestWake();
+    }
+
+    void SilenceSleepTracker::reset() {
+        sleeping_.store(false, std::memory_order_release);
+        quiet_input_frames_ = 0;
+        quiet_output_frames_ = 0;
+    }
+
+    bool SilenceSleepTracker::beginBlock(remidy::AudioProcessContext& process) {
+        // Formats that report silent outputs set their flags in process().
+        for (int32_t bus = 0; bus < process.audioOutBusCount(); ++bus)
+            process.outputSilenceFlags(bus, 0);
+        if (!enabled()) {
+            // Unknown rather than stale, for formats that read them.
+            for (int32_t bus = 0; bus < process.audioInBusCount(); ++bus)
+                process.inputSilenceFlags(bus, 0);
+            reset();
+            return false;
+        }
+        const bool inputSilent = process.detectInputSilence(kSilenceThreshold);
+        input_quiet_ = inputSilent && process.eventIn().position() == 0;
+
+        const bool playing = process.masterContext().isPlaying();
+        const bool transportChanged = playing != was_playing_;
+        was_playing_ = playing;
+        const bool wake = wake_requested_.exchange(false, std::memory_order_acq_rel);
+
+        if (!input_quiet_ || wake || transportChanged) {
+            reset();
+            return false;
+        }
+        return sleeping();
+    }
+
+    void SilenceSleepTracker::endBlock(remidy::AudioProcessContext& process, double tailLengthInSeconds) {
+        if (!enabled() || !input_quiet_ || process.eventOut().position() > 0 || !std::isfinite(tailLengthInSeconds)) {
+            reset();
+            return;
+        }
+        const auto frames = static_cast<int64_t>(std::max(process.frameCount(), 0));
+        const auto sampleRate = static_cast<double>(process.masterContext().sampleRate());
+        quiet_input_frames_ += frames;
+        quiet_output_frames_ = process.detectOutputSilence(kSilenceThreshold) ? quiet_output_frames_ + frames : 0;
+        if (static_cast<double>(quiet_input_frames_) >= std::max(tailLengthInSeconds, 0.0) * sampleRate &&
+            static_cast<double>(quiet_output_frames_) >= kDecayHoldSeconds * sampleRate)
+            sleeping_.store(true, std::memory_order_release);
+    }
+
+    void SilenceSleepTracker::skipBlock(remidy::AudioProcessContext& process) {
+        process.clearAudioOutputs();
+        for (int32_t bus = 0; bus < process.audioOutBusCount(); ++bus) {
+            const auto channels = static_cast<uint32_t>(process.outputChannelCount(bus));
+            process.outputSilenceFlags(bus, channels >= 64 ? ~uint64_t{0} : (uint64_t{1} << channels) - 1);
+        }
+    }
+
+}
@@ -26,6 +26,7 @@ void uapmd_plugin_hosting::PluginInstancing::setupInstance(remidy::PluginUIThrea
                 if (code != StatusCode::OK)
                     error = std::format("  {}: {} : startProcessing() failed. Error code {}", format->name(), displayName, (int32_t) code);
                 else {
+                    processing = true;
                     instancing_state = PluginInstancingState::Ready;
                     callback("");
                     return;
@@ -72,7 +73,7 @@ uapmd_plugin_hosting::PluginInstancing::~PluginInstancing() {
     }
     if (!instance)
         return;
-    if (instancing_state == PluginInstancingState::Ready) {
+    if (instancing_state == PluginInstancingState::Ready && processing) {
         instancing_state = PluginInstancingState::Terminating;
         auto code = instance->stopProcessing();
         if (code != StatusCode::OK)
@@ -92,6 +93,28 @@ uapmd_plugin_hosting::PluginInstancing::~PluginInstancing() {
     instancing_state = PluginInstancingState::Terminated;
 }
 
+remidy::StatusCode uapmd_plugin_hosting::PluginInstancing::stopProcessing() {
+    if (instancing_state != PluginInstancingState::Ready || !instance)
+        return StatusCode::ALREADY_INVALID_STATE;
+    if (!processing)
+        return StatusCode::OK;
+    auto code = instance->stopProcessing();
+    if (code == StatusCode::OK)
+        processing = false;
+    return code;
+}
+
+remidy::StatusCode uapmd_plugin_hosting::PluginInstancing::startProcessing() {
+    if (instancing_state != PluginInstancingState::Ready || !instance)
+        return StatusCode::ALREADY_INVALID_STATE;
+    if (processing)
+        return StatusCode::OK;
+    auto code = instance->startProcessing();
+    if (code == StatusCode::OK)
+        processing = true;
+    return code;
+}
+
 void uapmd_plugin_hosting::PluginInstancing::makeAlive(std::function<void(std::string error)> callback) {
     if (scanner.shouldCreateInstanceOnUIThread(format, entry)) {
         EventLoop::runTaskOnMainThread([this,callback] {